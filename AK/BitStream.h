@@ -214,6 +214,9 @@ public:
         return m_bit_buffer & lsb_mask<T>(min(count, m_bit_count));
     }
 
+    /// Returns how many bits can be peeked without refilling the buffer from the underlying stream.
+    ALWAYS_INLINE size_t buffered_bit_count() const { return m_bit_count; }
+
     ALWAYS_INLINE void discard_previously_peeked_bits(u8 count)
     {
         // We allow "retrieving" more bits than we can provide, but we need to make sure that we don't underflow the current bit counter.
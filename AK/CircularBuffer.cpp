@@ -228,6 +228,34 @@ ErrorOr<size_t> CircularBuffer::copy_from_seekback(size_t distance, size_t lengt
     if (distance > m_seekback_limit)
         return Error::from_string_literal("Tried a seekback copy beyond the seekback limit");
 
+    // Fast path: Neither the source nor the destination wrap around, so we can copy straight through the buffer.
+    auto write_offset = m_reading_head + m_used_space;
+    if (write_offset >= capacity())
+        write_offset -= capacity();
+    auto read_offset = write_offset >= distance ? write_offset - distance : write_offset + capacity() - distance;
+    if (distance > 0 && length <= empty_space() && write_offset + length <= capacity() && read_offset + length <= capacity()) {
+        u8* destination = m_buffer.data() + write_offset;
+        u8 const* source = m_buffer.data() + read_offset;
+
+        if (read_offset > write_offset || distance >= length) {
+            __builtin_memmove(destination, source, length);
+        } else if (distance >= sizeof(u64)) {
+            // The source overlaps with what we are writing, but each 8-byte chunk only reads bytes that are already in place.
+            size_t i = 0;
+            for (; i + sizeof(u64) <= length; i += sizeof(u64))
+                __builtin_memcpy(destination + i, source + i, sizeof(u64));
+            for (; i < length; ++i)
+                destination[i] = source[i];
+        } else {
+            for (size_t i = 0; i < length; ++i)
+                destination[i] = source[i];
+        }
+
+        m_used_space += length;
+        m_seekback_limit = min(m_seekback_limit + length, capacity());
+        return length;
+    }
+
     auto remaining_length = length;
     while (remaining_length > 0) {
         if (empty_space() == 0)
@@ -5,8 +5,12 @@
  */
 
 #include <AK/IntrusiveList.h>
+#include <AK/QuickSort.h>
+#include <AK/ScopeGuard.h>
 #include <Kernel/Debug.h>
 #include <Kernel/FileSystem/BlockBasedFileSystem.h>
+#include <Kernel/Library/KBuffer.h>
+#include <Kernel/Memory/MemoryManager.h>
 #include <Kernel/Tasks/Process.h>
 
 namespace Kernel {
@@ -18,24 +22,33 @@ struct CacheEntry {
     bool has_data { false };
 };
 
-class DiskCache {
+static bool is_under_memory_pressure()
+{
+    // Stop growing (and start giving memory back) once less than an eighth of physical memory is left uncommitted.
+    auto memory_info = MM.get_system_memory_info();
+    return memory_info.physical_pages_uncommitted < memory_info.physical_pages / 8;
+}
+
+struct DiskCacheChunk {
+    NonnullOwnPtr<KBuffer> block_data;
+    NonnullOwnPtr<KBuffer> entries;
+
+    CacheEntry* entry_at(size_t index) { return &((CacheEntry*)entries->data())[index]; }
+};
+
+// A single shard of the disk cache. Each shard has its own lock, LRU list and hash table,
+// and grows in chunks of blocks on demand up to a fixed number of chunks.
+class DiskCacheShard {
 public:
-    static constexpr size_t EntryCount = 10000;
-    explicit DiskCache(BlockBasedFileSystem& fs, NonnullOwnPtr<KBuffer> cached_block_data, NonnullOwnPtr<KBuffer> entries_buffer)
-        : m_fs(fs)
-        , m_cached_block_data(move(cached_block_data))
-        , m_entries(move(entries_buffer))
-    {
-        for (size_t i = 0; i < EntryCount; ++i) {
-            entries()[i].data = m_cached_block_data->data() + i * m_fs->block_size();
-            m_clean_list.append(entries()[i]);
-        }
-    }
+    static constexpr size_t EntriesPerChunk = 256;
+    static constexpr size_t MinimumChunkCount = 3;
+    static constexpr size_t MaximumChunkCount = 64;
 
-    ~DiskCache() = default;
+    Mutex& lock() { return m_lock; }
 
     bool is_dirty() const { return !m_dirty_list.is_empty(); }
     bool entry_is_dirty(CacheEntry const& entry) const { return m_dirty_list.contains(entry); }
+    size_t entry_count() const { return m_chunks.size() * EntriesPerChunk; }
 
     void mark_all_clean()
     {
@@ -48,17 +61,13 @@ public:
         m_dirty_list.prepend(entry);
     }
 
-    void mark_clean(CacheEntry& entry)
-    {
-        m_clean_list.prepend(entry);
-    }
-
-    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index) const
+    CacheEntry* get(BlockBasedFileSystem::BlockIndex block_index)
     {
+        VERIFY(m_lock.is_locked());
         auto it = m_hash.find(block_index);
         if (it == m_hash.end())
             return nullptr;
-        auto& entry = const_cast<CacheEntry&>(*it->value);
+        auto& entry = *it->value;
         VERIFY(entry.block_index == block_index);
         if (!entry_is_dirty(entry) && (m_clean_list.first() != &entry)) {
             // Cache hit! Promote the entry to the front of the list.
@@ -67,34 +76,83 @@ public:
         return &entry;
     }
 
-    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem::BlockIndex block_index) const
+    ErrorOr<CacheEntry*> ensure(BlockBasedFileSystem& fs, BlockBasedFileSystem::BlockIndex block_index)
     {
+        VERIFY(m_lock.is_locked());
         if (auto* entry = get(block_index))
             return entry;
 
-        if (m_clean_list.is_empty()) {
-            // Not a single clean entry! Flush writes and try again.
-            // NOTE: We want to make sure we only call FileBackedFileSystem flush here,
-            //       not some FileBackedFileSystem subclass flush!
-            m_fs->flush_writes_impl();
-            return ensure(block_index);
+        if (m_free_list.is_empty() && m_chunks.size() < MaximumChunkCount && !is_under_memory_pressure()) {
+            // We're out of unused entries but are still allowed to grow, so allocate another chunk
+            // rather than evicting something. Failing to grow is not fatal, we'll just evict instead.
+            (void)grow(fs.block_size());
+        }
+
+        CacheEntry* new_entry = m_free_list.first();
+        if (!new_entry) {
+            if (m_clean_list.is_empty()) {
+                // Not a single clean entry! Flush this shard's writes and try again.
+                flush_dirty_entries(fs);
+                mark_all_clean();
+            }
+            VERIFY(m_clean_list.last());
+            new_entry = m_clean_list.last();
+            remove_from_hash(*new_entry);
+            ++m_statistics.evictions;
         }
+        m_clean_list.prepend(*new_entry);
 
-        VERIFY(m_clean_list.last());
-        auto& new_entry = *m_clean_list.last();
-        m_clean_list.prepend(new_entry);
+        TRY(m_hash.try_set(block_index, new_entry));
 
-        m_hash.remove(new_entry.block_index);
-        TRY(m_hash.try_set(block_index, &new_entry));
+        new_entry->block_index = block_index;
+        new_entry->has_data = false;
 
-        new_entry.block_index = block_index;
-        new_entry.has_data = false;
+        return new_entry;
+    }
 
-        return &new_entry;
+    ErrorOr<void> grow(u64 block_size)
+    {
+        auto block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, EntriesPerChunk * block_size));
+        auto entries = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, EntriesPerChunk * sizeof(CacheEntry)));
+        TRY(m_chunks.try_append({ move(block_data), move(entries) }));
+
+        auto& chunk = m_chunks.last();
+        for (size_t i = 0; i < EntriesPerChunk; ++i) {
+            auto* entry = chunk.entry_at(i);
+            entry->data = chunk.block_data->data() + i * block_size;
+            m_free_list.append(*entry);
+        }
+        return {};
     }
 
-    CacheEntry const* entries() const { return (CacheEntry const*)m_entries->data(); }
-    CacheEntry* entries() { return (CacheEntry*)m_entries->data(); }
+    // Releases chunks (most recently allocated first) that don't contain any dirty blocks, keeping the initial chunks around.
+    size_t shrink()
+    {
+        VERIFY(m_lock.is_locked());
+        size_t released_entry_count = 0;
+        while (m_chunks.size() > MinimumChunkCount) {
+            auto& chunk = m_chunks.last();
+            bool chunk_has_dirty_entries = false;
+            for (size_t i = 0; i < EntriesPerChunk; ++i) {
+                if (entry_is_dirty(*chunk.entry_at(i))) {
+                    chunk_has_dirty_entries = true;
+                    break;
+                }
+            }
+            if (chunk_has_dirty_entries)
+                break;
+
+            for (size_t i = 0; i < EntriesPerChunk; ++i) {
+                auto& entry = *chunk.entry_at(i);
+                // An entry is hashed as soon as get() hands it out, before it has any data.
+                remove_from_hash(entry);
+                entry.list_node.remove();
+            }
+            m_chunks.take_last();
+            released_entry_count += EntriesPerChunk;
+        }
+        return released_entry_count;
+    }
 
     template<typename Callback>
     void for_each_dirty_entry(Callback callback)
@@ -103,16 +161,92 @@ public:
             callback(entry);
     }
 
+    BlockBasedFileSystem::DiskCacheStatistics& statistics() { return m_statistics; }
+
+private:
+    void remove_from_hash(CacheEntry& entry)
+    {
+        // Only unlink the entry if it actually owns the mapping, an entry that never got any data
+        // may still carry the index of a block that is now cached elsewhere.
+        auto it = m_hash.find(entry.block_index);
+        if (it != m_hash.end() && it->value == &entry)
+            m_hash.remove(it);
+    }
+
+    void flush_dirty_entries(BlockBasedFileSystem& fs)
+    {
+        for_each_dirty_entry([&](CacheEntry& entry) {
+            auto base_offset = entry.block_index.value() * fs.block_size();
+            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+            [[maybe_unused]] auto rc = fs.file_description().write(base_offset, entry_data_buffer, fs.block_size());
+            ++m_statistics.written_blocks;
+        });
+    }
+
+    Mutex m_lock { "DiskCacheShard"sv };
+    BlockBasedFileSystem::DiskCacheStatistics m_statistics;
+
+    // NOTE: m_chunks must be declared before the lists because their entries are allocated from it.
+    // We need to ensure that the destructors of the lists are called before the chunks are destroyed.
+    Vector<DiskCacheChunk> m_chunks;
+    IntrusiveList<&CacheEntry::list_node> m_free_list;
+    IntrusiveList<&CacheEntry::list_node> m_dirty_list;
+    IntrusiveList<&CacheEntry::list_node> m_clean_list;
+    HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+};
+
+class DiskCache {
+public:
+    static constexpr size_t ShardCount = 16;
+    static constexpr size_t MaximumReadAheadBlockCount = 32;
+    static constexpr size_t MaximumWriteBackClusterBlockCount = 32;
+
+    // The cache never holds fewer blocks than the 10000 the old fixed-size cache had.
+    static_assert(ShardCount * DiskCacheShard::MinimumChunkCount * DiskCacheShard::EntriesPerChunk >= 10000);
+
+    static ErrorOr<NonnullOwnPtr<DiskCache>> try_create(BlockBasedFileSystem& fs)
+    {
+        auto cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(fs)));
+        for (auto& shard : cache->m_shards) {
+            for (size_t i = 0; i < DiskCacheShard::MinimumChunkCount; ++i)
+                TRY(shard.grow(fs.block_size()));
+        }
+        return cache;
+    }
+
+    ~DiskCache() = default;
+
+    DiskCacheShard& shard_for(BlockBasedFileSystem::BlockIndex block_index) { return m_shards[block_index.value() % ShardCount]; }
+
+    template<typename Callback>
+    void for_each_shard(Callback callback)
+    {
+        for (auto& shard : m_shards)
+            callback(shard);
+    }
+
+    // Returns how many blocks to read ahead when missing on the given block. This only kicks in once we
+    // see misses on consecutive blocks, and the window doubles for as long as the access stays sequential.
+    size_t read_ahead_block_count_for(BlockBasedFileSystem::BlockIndex block_index)
+    {
+        size_t window = 0;
+        if (block_index.value() == m_next_sequential_block.load(AK::MemoryOrder::memory_order_relaxed))
+            window = clamp<size_t>(m_read_ahead_window.load(AK::MemoryOrder::memory_order_relaxed) * 2, 4, MaximumReadAheadBlockCount);
+        m_read_ahead_window.store(window, AK::MemoryOrder::memory_order_relaxed);
+        m_next_sequential_block.store(block_index.value() + max<size_t>(window, 1), AK::MemoryOrder::memory_order_relaxed);
+        return window;
+    }
+
 private:
-    mutable NonnullRefPtr<BlockBasedFileSystem> m_fs;
-    NonnullOwnPtr<KBuffer> m_cached_block_data;
-
-    // NOTE: m_entries must be declared before m_dirty_list and m_clean_list because their entries are allocated from it.
-    // We need to ensure that the destructors of m_dirty_list and m_clean_list are called before m_entries is destroyed.
-    NonnullOwnPtr<KBuffer> m_entries;
-    mutable IntrusiveList<&CacheEntry::list_node> m_dirty_list;
-    mutable IntrusiveList<&CacheEntry::list_node> m_clean_list;
-    mutable HashMap<BlockBasedFileSystem::BlockIndex, CacheEntry*> m_hash;
+    explicit DiskCache(BlockBasedFileSystem& fs)
+        : m_fs(fs)
+    {
+    }
+
+    NonnullRefPtr<BlockBasedFileSystem> m_fs;
+    Array<DiskCacheShard, ShardCount> m_shards;
+    Atomic<u64> m_next_sequential_block { NumericLimits<u64>::max() };
+    Atomic<size_t> m_read_ahead_window { 0 };
 };
 
 BlockBasedFileSystem::BlockBasedFileSystem(OpenFileDescription& file_description)
@@ -136,9 +270,7 @@ ErrorOr<void> BlockBasedFileSystem::initialize_while_locked()
     VERIFY(m_lock.is_locked());
     VERIFY(!is_initialized_while_locked());
     VERIFY(block_size() != 0);
-    auto cached_block_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache blocks"sv, DiskCache::EntryCount * block_size()));
-    auto entries_data = TRY(KBuffer::try_create_with_size("BlockBasedFS: Cache entries"sv, DiskCache::EntryCount * sizeof(CacheEntry)));
-    auto disk_cache = TRY(adopt_nonnull_own_or_enomem(new (nothrow) DiskCache(*this, move(cached_block_data), move(entries_data))));
+    auto disk_cache = TRY(DiskCache::try_create(*this));
 
     m_cache.with_exclusive([&](auto& cache) {
         cache = move(disk_cache);
@@ -159,7 +291,7 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
 
     TRY(data.read(buffered_data.bytes()));
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return m_cache.with_shared([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -168,19 +300,55 @@ ErrorOr<void> BlockBasedFileSystem::write_block(BlockIndex index, UserOrKernelBu
             return {};
         }
 
-        auto entry = TRY(cache->ensure(index));
-        if (count < block_size()) {
+        auto& shard = cache->shard_for(index);
+        MutexLocker locker(shard.lock());
+        auto entry = TRY(shard.ensure(*this, index));
+        if (count < block_size() && !entry->has_data) {
             // Fill the cache first.
-            TRY(read_block(index, nullptr, block_size()));
+            TRY(read_entry_from_disk(*entry));
         }
         memcpy(entry->data + offset, buffered_data.data(), count);
 
-        cache->mark_dirty(*entry);
+        shard.mark_dirty(*entry);
         entry->has_data = true;
         return {};
     });
 }
 
+ErrorOr<void> BlockBasedFileSystem::read_entry_from_disk(CacheEntry& entry) const
+{
+    auto base_offset = entry.block_index.value() * block_size();
+    auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
+    auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
+    VERIFY(nread == block_size());
+    entry.has_data = true;
+    return {};
+}
+
+ErrorOr<void> BlockBasedFileSystem::read_ahead(DiskCache& cache, BlockIndex index, size_t count) const
+{
+    // Read a run of blocks with a single request, then hand them out to the shards.
+    // Blocks that are already cached are left alone, as they might be dirty.
+    auto read_ahead_buffer = TRY(KBuffer::try_create_with_size("BlockBasedFS: Read-ahead"sv, count * block_size()));
+    auto buffer = UserOrKernelBuffer::for_kernel_buffer(read_ahead_buffer->data());
+    auto nread = TRY(file_description().read(buffer, index.value() * block_size(), count * block_size()));
+    auto blocks_read = nread / block_size();
+
+    for (size_t i = 0; i < blocks_read; ++i) {
+        BlockIndex block_index { index.value() + i };
+        auto& shard = cache.shard_for(block_index);
+        MutexLocker locker(shard.lock());
+        if (shard.get(block_index))
+            continue;
+        auto* entry = TRY(shard.ensure(*const_cast<BlockBasedFileSystem*>(this), block_index));
+        memcpy(entry->data, read_ahead_buffer->data() + i * block_size(), block_size());
+        entry->has_data = true;
+        if (i != 0)
+            ++shard.statistics().read_ahead_blocks;
+    }
+    return {};
+}
+
 ErrorOr<void> BlockBasedFileSystem::raw_read(BlockIndex index, UserOrKernelBuffer& buffer)
 {
     auto base_offset = index.value() * m_logical_block_size;
@@ -233,7 +401,7 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
     VERIFY(offset + count <= block_size());
     dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}", index);
 
-    return m_cache.with_exclusive([&](auto& cache) -> ErrorOr<void> {
+    return m_cache.with_shared([&](auto& cache) -> ErrorOr<void> {
         if (!allow_cache) {
             const_cast<BlockBasedFileSystem*>(this)->flush_specific_block_if_needed(index);
             u64 base_offset = index.value() * block_size() + offset;
@@ -242,14 +410,28 @@ ErrorOr<void> BlockBasedFileSystem::read_block(BlockIndex index, UserOrKernelBuf
             return {};
         }
 
-        auto* entry = TRY(cache->ensure(index));
-        if (!entry->has_data) {
-            auto base_offset = index.value() * block_size();
-            auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
-            auto nread = TRY(file_description().read(entry_data_buffer, base_offset, block_size()));
-            VERIFY(nread == block_size());
-            entry->has_data = true;
+        auto& shard = cache->shard_for(index);
+        {
+            MutexLocker locker(shard.lock());
+            if (auto* entry = shard.get(index); entry && entry->has_data) {
+                ++shard.statistics().hits;
+                if (buffer)
+                    TRY(buffer->write(entry->data + offset, count));
+                return {};
+            }
+            ++shard.statistics().misses;
+        }
+
+        if (auto read_ahead_count = cache->read_ahead_block_count_for(index); read_ahead_count > 1) {
+            // Read-ahead is only an optimization, so if it fails we fall back to reading the single block below.
+            if (auto result = read_ahead(*cache, index, read_ahead_count); result.is_error())
+                dbgln_if(BBFS_DEBUG, "BlockBasedFileSystem::read_block {}: read-ahead failed: {}", index, result.error());
         }
+
+        MutexLocker locker(shard.lock());
+        auto* entry = TRY(shard.ensure(*const_cast<BlockBasedFileSystem*>(this), index));
+        if (!entry->has_data)
+            TRY(read_entry_from_disk(*entry));
         if (buffer)
             TRY(buffer->write(entry->data + offset, count));
         return {};
@@ -274,13 +456,15 @@ ErrorOr<void> BlockBasedFileSystem::read_blocks(BlockIndex index, unsigned count
 
 void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 {
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
+    m_cache.with_shared([&](auto& cache) {
+        auto& shard = cache->shard_for(index);
+        MutexLocker locker(shard.lock());
+        if (!shard.is_dirty())
             return;
-        auto* entry = cache->get(index);
+        auto* entry = shard.get(index);
         if (!entry)
             return;
-        if (!cache->entry_is_dirty(*entry))
+        if (!shard.entry_is_dirty(*entry))
             return;
         size_t base_offset = entry->block_index.value() * block_size();
         auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry->data);
@@ -291,23 +475,120 @@ void BlockBasedFileSystem::flush_specific_block_if_needed(BlockIndex index)
 void BlockBasedFileSystem::flush_writes_impl()
 {
     size_t count = 0;
-    m_cache.with_exclusive([&](auto& cache) {
-        if (!cache->is_dirty())
+    size_t cluster_count = 0;
+    m_cache.with_shared([&](auto& cache) {
+        if (!cache)
             return;
-        cache->for_each_dirty_entry([&](CacheEntry& entry) {
+        // Take all shard locks in a fixed order, so the whole cache is flushed as one consistent snapshot.
+        cache->for_each_shard([](auto& shard) { shard.lock().lock(); });
+        ScopeGuard unlock_shards([&] {
+            cache->for_each_shard([](auto& shard) { shard.lock().unlock(); });
+        });
+
+        Vector<CacheEntry*> dirty_entries;
+        bool can_cluster = true;
+        cache->for_each_shard([&](auto& shard) {
+            shard.for_each_dirty_entry([&](CacheEntry& entry) {
+                if (can_cluster && dirty_entries.try_append(&entry).is_error())
+                    can_cluster = false;
+            });
+        });
+        if (dirty_entries.is_empty())
+            return;
+
+        auto write_entry = [&](CacheEntry& entry) {
             auto base_offset = entry.block_index.value() * block_size();
             auto entry_data_buffer = UserOrKernelBuffer::for_kernel_buffer(entry.data);
             [[maybe_unused]] auto rc = file_description().write(base_offset, entry_data_buffer, block_size());
             ++count;
-        });
-        cache->mark_all_clean();
-        dbgln("{}: Flushed {} blocks to disk", class_name(), count);
+        };
+
+        OwnPtr<KBuffer> cluster_buffer;
+        if (can_cluster) {
+            auto cluster_buffer_or_error = KBuffer::try_create_with_size("BlockBasedFS: Write-back cluster"sv, DiskCache::MaximumWriteBackClusterBlockCount * block_size());
+            if (!cluster_buffer_or_error.is_error())
+                cluster_buffer = cluster_buffer_or_error.release_value();
+        }
+
+        if (!cluster_buffer) {
+            // We couldn't allocate what we need to coalesce writes, so just write each block on its own.
+            cache->for_each_shard([&](auto& shard) { shard.for_each_dirty_entry(write_entry); });
+        } else {
+            // Coalesce runs of adjacent dirty blocks into a single write.
+            quick_sort(dirty_entries, [](auto* a, auto* b) { return a->block_index < b->block_index; });
+            for (size_t i = 0; i < dirty_entries.size();) {
+                size_t run_length = 1;
+                while (i + run_length < dirty_entries.size()
+                    && run_length < DiskCache::MaximumWriteBackClusterBlockCount
+                    && dirty_entries[i + run_length]->block_index.value() == dirty_entries[i]->block_index.value() + run_length)
+                    ++run_length;
+
+                if (run_length == 1) {
+                    write_entry(*dirty_entries[i]);
+                } else {
+                    for (size_t j = 0; j < run_length; ++j)
+                        memcpy(cluster_buffer->data() + j * block_size(), dirty_entries[i + j]->data, block_size());
+                    auto base_offset = dirty_entries[i]->block_index.value() * block_size();
+                    auto cluster_data_buffer = UserOrKernelBuffer::for_kernel_buffer(cluster_buffer->data());
+                    [[maybe_unused]] auto rc = file_description().write(base_offset, cluster_data_buffer, run_length * block_size());
+                    count += run_length;
+                    ++cluster_count;
+                }
+                i += run_length;
+            }
+        }
+
+        cache->for_each_shard([&](auto& shard) { shard.mark_all_clean(); });
+        auto& statistics = cache->shard_for(0).statistics();
+        statistics.written_blocks += count;
+        statistics.write_back_clusters += cluster_count;
+        dbgln_if(BBFS_DEBUG, "{}: Flushed {} blocks to disk ({} clustered writes)", class_name(), count, cluster_count);
     });
 }
 
 void BlockBasedFileSystem::flush_writes()
 {
     flush_writes_impl();
+
+    if (is_under_memory_pressure())
+        release_cached_memory();
+}
+
+void BlockBasedFileSystem::release_cached_memory()
+{
+    // Give back whatever clean parts of the cache we can.
+    size_t released_entry_count = 0;
+    m_cache.with_shared([&](auto& cache) {
+        if (!cache)
+            return;
+        cache->for_each_shard([&](auto& shard) {
+            MutexLocker locker(shard.lock());
+            released_entry_count += shard.shrink();
+        });
+    });
+    if (released_entry_count)
+        dbgln("{}: Released {} cached blocks due to memory pressure", class_name(), released_entry_count);
+}
+
+BlockBasedFileSystem::DiskCacheStatistics BlockBasedFileSystem::disk_cache_statistics() const
+{
+    DiskCacheStatistics statistics;
+    m_cache.with_shared([&](auto& cache) {
+        if (!cache)
+            return;
+        cache->for_each_shard([&](auto& shard) {
+            MutexLocker locker(shard.lock());
+            auto const& shard_statistics = shard.statistics();
+            statistics.hits += shard_statistics.hits;
+            statistics.misses += shard_statistics.misses;
+            statistics.read_ahead_blocks += shard_statistics.read_ahead_blocks;
+            statistics.evictions += shard_statistics.evictions;
+            statistics.written_blocks += shard_statistics.written_blocks;
+            statistics.write_back_clusters += shard_statistics.write_back_clusters;
+            statistics.cached_block_capacity += shard.entry_count();
+        });
+    });
+    return statistics;
 }
 
 }
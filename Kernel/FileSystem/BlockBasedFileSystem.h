@@ -11,6 +11,8 @@
 
 namespace Kernel {
 
+struct CacheEntry;
+
 class BlockBasedFileSystem : public FileBackedFileSystem {
 public:
     AK_TYPEDEF_DISTINCT_ORDERED_ID(u64, BlockIndex);
@@ -21,6 +23,18 @@ public:
 
     virtual void flush_writes() override;
     void flush_writes_impl();
+    virtual void release_cached_memory() override;
+
+    struct DiskCacheStatistics {
+        u64 hits { 0 };
+        u64 misses { 0 };
+        u64 read_ahead_blocks { 0 };
+        u64 evictions { 0 };
+        u64 written_blocks { 0 };
+        u64 write_back_clusters { 0 };
+        u64 cached_block_capacity { 0 };
+    };
+    DiskCacheStatistics disk_cache_statistics() const;
 
 protected:
     explicit BlockBasedFileSystem(OpenFileDescription&);
@@ -44,7 +58,11 @@ protected:
     void remove_disk_cache_before_last_unmount();
 
 private:
+    virtual bool is_block_based() const override { return true; }
+
     void flush_specific_block_if_needed(BlockIndex index);
+    ErrorOr<void> read_entry_from_disk(CacheEntry&) const;
+    ErrorOr<void> read_ahead(DiskCache&, BlockIndex, size_t count) const;
 
     mutable MutexProtected<OwnPtr<DiskCache>> m_cache;
 };
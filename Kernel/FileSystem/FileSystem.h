@@ -52,11 +52,14 @@ public:
     };
 
     virtual void flush_writes() { }
+    // Called when the system is running low on memory, after writes have been flushed.
+    virtual void release_cached_memory() { }
 
     u64 block_size() const { return m_block_size; }
     size_t fragment_size() const { return m_fragment_size; }
 
     virtual bool is_file_backed() const { return false; }
+    virtual bool is_block_based() const { return false; }
 
     // Converts file types that are used internally by the filesystem to DT_* types
     virtual u8 internal_file_type_to_directory_entry_type(DirectoryEntryView const& entry) const { return entry.file_type; }
@@ -5,6 +5,7 @@
  */
 
 #include <AK/JsonObjectSerializer.h>
+#include <Kernel/FileSystem/BlockBasedFileSystem.h>
 #include <Kernel/FileSystem/FileBackedFileSystem.h>
 #include <Kernel/FileSystem/SysFS/Subsystems/Kernel/DiskUsage.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
@@ -46,6 +47,17 @@ ErrorOr<void> SysFSDiskUsage::try_generate(KBufferBuilder& builder)
             TRY(fs_object.add("source"sv, "none"));
         }
 
+        if (fs.is_block_based()) {
+            auto statistics = static_cast<BlockBasedFileSystem const&>(fs).disk_cache_statistics();
+            TRY(fs_object.add("cache_hits"sv, statistics.hits));
+            TRY(fs_object.add("cache_misses"sv, statistics.misses));
+            TRY(fs_object.add("cache_read_ahead_blocks"sv, statistics.read_ahead_blocks));
+            TRY(fs_object.add("cache_evictions"sv, statistics.evictions));
+            TRY(fs_object.add("cache_written_blocks"sv, statistics.written_blocks));
+            TRY(fs_object.add("cache_write_back_clusters"sv, statistics.write_back_clusters));
+            TRY(fs_object.add("cache_capacity_blocks"sv, statistics.cached_block_capacity));
+        }
+
         TRY(fs_object.finish());
         return {};
     }));
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/JsonObjectSerializer.h>
+#include <Kernel/Arch/Processor.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/SchedulerStatistics.h>
+#include <Kernel/Sections.h>
+#include <Kernel/Tasks/Scheduler.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSSchedulerStatistics::SysFSSchedulerStatistics(SysFSDirectory const& parent_directory)
+    : SysFSGlobalInformation(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<SysFSSchedulerStatistics> SysFSSchedulerStatistics::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_ref_if_nonnull(new (nothrow) SysFSSchedulerStatistics(parent_directory)).release_nonnull();
+}
+
+ErrorOr<void> SysFSSchedulerStatistics::try_generate(KBufferBuilder& builder)
+{
+    auto array = TRY(JsonArraySerializer<>::try_create(builder));
+    for (u32 processor_id = 0; processor_id < Processor::count(); ++processor_id) {
+        auto statistics = Scheduler::get_statistics(processor_id);
+        auto obj = TRY(array.add_object());
+        TRY(obj.add("processor"sv, processor_id));
+        TRY(obj.add("ready_threads"sv, statistics.ready_threads));
+        TRY(obj.add("enqueued"sv, statistics.enqueued));
+        TRY(obj.add("picked_local"sv, statistics.picked_local));
+        TRY(obj.add("picked_stolen"sv, statistics.picked_stolen));
+        TRY(obj.add("picked_idle"sv, statistics.picked_idle));
+        TRY(obj.add("scheduler_lock_contended"sv, statistics.scheduler_lock_contended));
+        TRY(obj.add("scheduler_lock_contended_cycles"sv, statistics.scheduler_lock_contended_cycles));
+        TRY(obj.finish());
+    }
+    TRY(array.finish());
+    return {};
+}
+
+}
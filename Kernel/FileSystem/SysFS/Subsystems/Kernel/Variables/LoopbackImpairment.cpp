@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Variables/LoopbackImpairment.h>
+#include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSLoopbackImpairment::SysFSLoopbackImpairment(SysFSDirectory const& parent_directory)
+    : SysFSSystemStringVariable(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<SysFSLoopbackImpairment> SysFSLoopbackImpairment::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_ref_if_nonnull(new (nothrow) SysFSLoopbackImpairment(parent_directory)).release_nonnull();
+}
+
+ErrorOr<NonnullOwnPtr<KString>> SysFSLoopbackImpairment::value() const
+{
+    auto impairment = LoopbackAdapter::impairment();
+    return KString::formatted("delay_ms={} loss_permille={}", impairment.delay_ms, impairment.loss_permille);
+}
+
+void SysFSLoopbackImpairment::set_value(NonnullOwnPtr<KString> new_value)
+{
+    auto impairment = LoopbackAdapter::impairment();
+    for (auto setting : new_value->view().split_view(' ')) {
+        auto separator = setting.find('=');
+        if (!separator.has_value())
+            continue;
+        auto key = setting.substring_view(0, separator.value());
+        auto value = setting.substring_view(separator.value() + 1).to_uint();
+        if (!value.has_value())
+            continue;
+        if (key == "delay_ms"sv)
+            impairment.delay_ms = value.value();
+        else if (key == "loss_permille"sv)
+            impairment.loss_permille = value.value();
+    }
+    LoopbackAdapter::set_impairment(impairment);
+}
+
+mode_t SysFSLoopbackImpairment::permissions() const
+{
+    return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+}
+
+}
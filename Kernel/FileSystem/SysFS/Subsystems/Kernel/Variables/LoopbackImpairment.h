@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/RefPtr.h>
+#include <AK/Types.h>
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Variables/StringVariable.h>
+#include <Kernel/Library/UserOrKernelBuffer.h>
+
+namespace Kernel {
+
+// Artificial delay and loss on the loopback adapter, for testing the network stack.
+// The value has the form "delay_ms=<milliseconds> loss_permille=<packets per thousand>".
+class SysFSLoopbackImpairment final : public SysFSSystemStringVariable {
+public:
+    virtual StringView name() const override { return "loopback_impairment"sv; }
+    static NonnullRefPtr<SysFSLoopbackImpairment> must_create(SysFSDirectory const&);
+
+private:
+    virtual ErrorOr<NonnullOwnPtr<KString>> value() const override;
+    virtual void set_value(NonnullOwnPtr<KString> new_value) override;
+
+    explicit SysFSLoopbackImpairment(SysFSDirectory const&);
+
+    virtual mode_t permissions() const override;
+};
+
+}
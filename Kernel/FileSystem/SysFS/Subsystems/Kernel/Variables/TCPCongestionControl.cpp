@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/FileSystem/SysFS/Subsystems/Kernel/Variables/TCPCongestionControl.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+#include <Kernel/Sections.h>
+
+namespace Kernel {
+
+UNMAP_AFTER_INIT SysFSTCPCongestionControl::SysFSTCPCongestionControl(SysFSDirectory const& parent_directory)
+    : SysFSSystemStringVariable(parent_directory)
+{
+}
+
+UNMAP_AFTER_INIT NonnullRefPtr<SysFSTCPCongestionControl> SysFSTCPCongestionControl::must_create(SysFSDirectory const& parent_directory)
+{
+    return adopt_ref_if_nonnull(new (nothrow) SysFSTCPCongestionControl(parent_directory)).release_nonnull();
+}
+
+ErrorOr<NonnullOwnPtr<KString>> SysFSTCPCongestionControl::value() const
+{
+    return KString::try_create(TCPCongestionControl::name(TCPCongestionControl::default_algorithm()));
+}
+
+void SysFSTCPCongestionControl::set_value(NonnullOwnPtr<KString> new_value)
+{
+    auto algorithm = TCPCongestionControl::algorithm_from_name(new_value->view());
+    if (!algorithm.has_value()) {
+        dmesgln("SysFSTCPCongestionControl: Unknown congestion control algorithm '{}'", new_value->view());
+        return;
+    }
+    // NOTE: This only affects sockets created from now on.
+    TCPCongestionControl::set_default_algorithm(algorithm.value());
+}
+
+mode_t SysFSTCPCongestionControl::permissions() const
+{
+    return S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+}
+
+}
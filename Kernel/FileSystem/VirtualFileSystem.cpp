@@ -145,6 +145,18 @@ void VirtualFileSystem::sync_filesystems()
         fs->flush_writes();
 }
 
+void VirtualFileSystem::release_filesystem_caches()
+{
+    Vector<NonnullRefPtr<FileSystem>, 32> file_systems;
+    m_file_systems_list.with([&](auto const& list) {
+        for (auto& fs : list)
+            file_systems.append(fs);
+    });
+
+    for (auto& fs : file_systems)
+        fs->release_cached_memory();
+}
+
 void VirtualFileSystem::lock_all_filesystems()
 {
     Vector<NonnullRefPtr<FileSystem>, 32> file_systems;
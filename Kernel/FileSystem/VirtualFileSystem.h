@@ -87,6 +87,7 @@ public:
     InodeIdentifier root_inode_id() const;
 
     void sync_filesystems();
+    void release_filesystem_caches();
     void lock_all_filesystems();
 
     static void sync();
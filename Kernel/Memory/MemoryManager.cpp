@@ -25,6 +25,7 @@
 #include <Kernel/Prekernel/Prekernel.h>
 #include <Kernel/Sections.h>
 #include <Kernel/Tasks/Process.h>
+#include <Kernel/Tasks/SyncTask.h>
 
 extern u8 start_of_kernel_image[];
 extern u8 end_of_kernel_image[];
@@ -893,6 +894,7 @@ ErrorOr<CommittedPhysicalPageSet> MemoryManager::commit_physical_pages(size_t pa
         return CommittedPhysicalPageSet { {}, page_count };
     });
     if (result.is_error()) {
+        SyncTask::notify_memory_pressure();
         Process::for_each_ignoring_jails([&](Process const& process) {
             size_t amount_resident = 0;
             size_t amount_shared = 0;
@@ -993,11 +995,13 @@ NonnullRefPtr<PhysicalPage> MemoryManager::allocate_committed_physical_page(Badg
 
 ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(ShouldZeroFill should_zero_fill, bool* did_purge)
 {
-    return m_global_data.with([&](auto&) -> ErrorOr<NonnullRefPtr<PhysicalPage>> {
+    bool ran_out_of_free_pages = false;
+    auto page_or_error = m_global_data.with([&](auto&) -> ErrorOr<NonnullRefPtr<PhysicalPage>> {
         auto page = find_free_physical_page(false);
         bool purged_pages = false;
 
         if (!page) {
+            ran_out_of_free_pages = true;
             // We didn't have a single free physical page. Let's try to free something up!
             // First, we look for a purgeable VMObject in the volatile state.
             for_each_vmobject([&](auto& vmobject) {
@@ -1046,6 +1050,11 @@ ErrorOr<NonnullRefPtr<PhysicalPage>> MemoryManager::allocate_physical_page(Shoul
             *did_purge = purged_pages;
         return page.release_nonnull();
     });
+
+    // Let file systems give back their caches before we have to scrape the bottom of the barrel again.
+    if (ran_out_of_free_pages)
+        SyncTask::notify_memory_pressure();
+    return page_or_error;
 }
 
 ErrorOr<Vector<NonnullRefPtr<PhysicalPage>>> MemoryManager::allocate_contiguous_physical_pages(size_t size)
@@ -4,12 +4,18 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <AK/Singleton.h>
 #include <Kernel/Net/LoopbackAdapter.h>
+#include <Kernel/Security/Random.h>
+#include <Kernel/Time/TimeManagement.h>
+#include <Kernel/Time/TimerQueue.h>
 
 namespace Kernel {
 
 static bool s_loopback_initialized = false;
+static Atomic<u32> s_impairment_delay_ms { 0 };
+static Atomic<u32> s_impairment_loss_permille { 0 };
 
 ErrorOr<NonnullRefPtr<LoopbackAdapter>> LoopbackAdapter::try_create()
 {
@@ -28,10 +34,53 @@ LoopbackAdapter::LoopbackAdapter(NonnullOwnPtr<KString> interface_name)
 
 LoopbackAdapter::~LoopbackAdapter() = default;
 
+LoopbackAdapter::Impairment LoopbackAdapter::impairment()
+{
+    return { s_impairment_delay_ms.load(), s_impairment_loss_permille.load() };
+}
+
+void LoopbackAdapter::set_impairment(Impairment impairment)
+{
+    s_impairment_delay_ms.store(impairment.delay_ms);
+    s_impairment_loss_permille.store(min(impairment.loss_permille, 1000u));
+}
+
 void LoopbackAdapter::send_raw(ReadonlyBytes payload)
 {
-    dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
-    did_receive(payload);
+    auto impairment = LoopbackAdapter::impairment();
+    if (impairment.loss_permille > 0 && get_fast_random<u32>() % 1000 < impairment.loss_permille) {
+        dbgln("LoopbackAdapter: Dropping {} byte(s) on purpose.", payload.size());
+        return;
+    }
+
+    if (impairment.delay_ms == 0) {
+        dbgln("LoopbackAdapter: Sending {} byte(s) to myself.", payload.size());
+        did_receive(payload);
+        return;
+    }
+
+    auto packet = acquire_packet_buffer(payload.size());
+    if (!packet) {
+        dbgln("LoopbackAdapter: Discarding delayed packet because we're out of memory");
+        return;
+    }
+    memcpy(packet->buffer->data(), payload.data(), payload.size());
+
+    auto timer_or_error = try_make_ref_counted<Timer>();
+    if (timer_or_error.is_error()) {
+        release_packet_buffer(*packet);
+        return;
+    }
+    auto deadline = TimeManagement::the().current_time(CLOCK_MONOTONIC_COARSE) + Duration::from_milliseconds(impairment.delay_ms);
+    bool timer_was_added = TimerQueue::the().add_timer_without_id(timer_or_error.release_value(), CLOCK_MONOTONIC_COARSE, deadline, [adapter = NonnullRefPtr(*this), packet = NonnullRefPtr(*packet)]() {
+        dbgln("LoopbackAdapter: Sending {} byte(s) to myself after a delay.", packet->buffer->size());
+        adapter->did_receive(packet->bytes());
+        adapter->release_packet_buffer(*packet);
+    });
+    if (!timer_was_added) {
+        did_receive(packet->bytes());
+        release_packet_buffer(*packet);
+    }
 }
 
 }
@@ -16,6 +16,15 @@ private:
 
 public:
     static ErrorOr<NonnullRefPtr<LoopbackAdapter>> try_create();
+
+    // Artificial impairments for testing the behavior of the network stack on bad links.
+    struct Impairment {
+        u32 delay_ms { 0 };
+        u32 loss_permille { 0 };
+    };
+    static Impairment impairment();
+    static void set_impairment(Impairment);
+
     virtual ~LoopbackAdapter() override;
 
     virtual ErrorOr<void> initialize(Badge<NetworkingManagement>) override { VERIFY_NOT_REACHED(); }
@@ -33,7 +33,7 @@ static void handle_tcp(IPv4Packet const&, UnixDateTime const& packet_timestamp);
 static void send_delayed_tcp_ack(TCPSocket& socket);
 static void send_tcp_rst(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, RefPtr<NetworkAdapter> adapter);
 static void flush_delayed_tcp_acks();
-static void retransmit_tcp_packets();
+static Duration retransmit_tcp_packets();
 
 static Thread* network_task = nullptr;
 static HashTable<NonnullRefPtr<TCPSocket>>* delayed_ack_sockets;
@@ -98,10 +98,10 @@ void NetworkTask_main(void*)
 
     for (;;) {
         flush_delayed_tcp_acks();
-        retransmit_tcp_packets();
+        auto time_until_next_retransmit = retransmit_tcp_packets();
         size_t packet_size = dequeue_packet(buffer, buffer_size, packet_timestamp);
         if (!packet_size) {
-            auto timeout_time = Duration::from_milliseconds(500);
+            auto timeout_time = time_until_next_retransmit;
             auto timeout = Thread::BlockTimeout { false, &timeout_time };
             [[maybe_unused]] auto result = packet_wait_queue.wait_on(timeout, "NetworkTask"sv);
             continue;
@@ -458,6 +458,7 @@ void handle_tcp(IPv4Packet const& ipv4_packet, UnixDateTime const& packet_timest
             dbgln_if(TCP_DEBUG, "handle_tcp: created new client socket with tuple {}", client->tuple().to_string());
             client->set_sequence_number(1000);
             client->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            client->apply_syn_options(tcp_packet);
             [[maybe_unused]] auto rc2 = client->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             client->set_state(TCPSocket::State::SynReceived);
             return;
@@ -471,11 +472,13 @@ void handle_tcp(IPv4Packet const& ipv4_packet, UnixDateTime const& packet_timest
         switch (tcp_packet.flags()) {
         case TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->apply_syn_options(tcp_packet);
             (void)socket->send_tcp_packet(TCPFlags::SYN | TCPFlags::ACK);
             socket->set_state(TCPSocket::State::SynReceived);
             return;
         case TCPFlags::ACK | TCPFlags::SYN:
             socket->set_ack_number(tcp_packet.sequence_number() + payload_size + 1);
+            socket->apply_syn_options(tcp_packet);
             (void)socket->send_ack(true);
             socket->set_state(TCPSocket::State::Established);
             socket->set_setup_state(Socket::SetupState::Completed);
@@ -619,6 +622,12 @@ void handle_tcp(IPv4Packet const& ipv4_packet, UnixDateTime const& packet_timest
         }
 
         if (tcp_packet.sequence_number() != socket->ack_number()) {
+            if (!tcp_packet.has_fin() && socket->queue_out_of_order_segment(ipv4_packet, tcp_packet, payload_size, packet_timestamp)) {
+                dbgln_if(TCP_DEBUG, "Queued out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
+                // RFC 5681, 4.2: Out-of-order segments should be acknowledged immediately.
+                [[maybe_unused]] auto result = socket->send_ack(true);
+                return;
+            }
             dbgln_if(TCP_DEBUG, "Discarding out of order packet: seq {} vs. ack {}", tcp_packet.sequence_number(), socket->ack_number());
             if (socket->duplicate_acks() < TCPSocket::maximum_duplicate_acks) {
                 dbgln_if(TCP_DEBUG, "Sending ACK with same ack number to trigger fast retransmission");
@@ -646,13 +655,19 @@ void handle_tcp(IPv4Packet const& ipv4_packet, UnixDateTime const& packet_timest
                 socket->set_ack_number(tcp_packet.sequence_number() + payload_size);
                 dbgln_if(TCP_DEBUG, "Got packet with ack_no={}, seq_no={}, payload_size={}, acking it with new ack_no={}, seq_no={}",
                     tcp_packet.ack_number(), tcp_packet.sequence_number(), payload_size, socket->ack_number(), socket->sequence_number());
-                send_delayed_tcp_ack(*socket);
+                if (socket->has_out_of_order_segments()) {
+                    socket->deliver_out_of_order_segments();
+                    // RFC 5681, 4.2: Segments that fill in a hole should be acknowledged immediately.
+                    [[maybe_unused]] auto result = socket->send_ack(true);
+                } else {
+                    send_delayed_tcp_ack(*socket);
+                }
             }
         }
     }
 }
 
-void retransmit_tcp_packets()
+Duration retransmit_tcp_packets()
 {
     // We must keep the sockets alive until after we've unlocked the hash table
     // in case retransmit_packets() realizes that it wants to close the socket.
@@ -663,10 +678,15 @@ void retransmit_tcp_packets()
         (void)sockets.try_append(socket);
     });
 
+    // Wake up at least every 500ms, but earlier if a retransmission timer is about to expire.
+    auto now = kgettimeofday();
+    auto next_wakeup = now + Duration::from_milliseconds(500);
     for (auto& socket : sockets) {
         MutexLocker socket_locker(socket->mutex());
         socket->retransmit_packets();
+        next_wakeup = min(next_wakeup, socket->retransmit_deadline());
     }
+    return max(next_wakeup - now, Duration::from_milliseconds(10));
 }
 
 }
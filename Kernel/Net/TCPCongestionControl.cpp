@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <Kernel/Net/TCP.h>
+#include <Kernel/Net/TCPCongestionControl.h>
+
+namespace Kernel {
+
+static Atomic<TCPCongestionControl::Algorithm> s_default_algorithm { TCPCongestionControl::Algorithm::NewReno };
+
+ErrorOr<NonnullOwnPtr<TCPCongestionControl>> TCPCongestionControl::try_create(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPNewReno));
+    case Algorithm::Cubic:
+        return TRY(adopt_nonnull_own_or_enomem(new (nothrow) TCPCubic));
+    }
+    VERIFY_NOT_REACHED();
+}
+
+TCPCongestionControl::Algorithm TCPCongestionControl::default_algorithm()
+{
+    return s_default_algorithm.load();
+}
+
+void TCPCongestionControl::set_default_algorithm(Algorithm algorithm)
+{
+    s_default_algorithm.store(algorithm);
+}
+
+Optional<TCPCongestionControl::Algorithm> TCPCongestionControl::algorithm_from_name(StringView name)
+{
+    if (name == "newreno"sv)
+        return Algorithm::NewReno;
+    if (name == "cubic"sv)
+        return Algorithm::Cubic;
+    return {};
+}
+
+StringView TCPCongestionControl::name(Algorithm algorithm)
+{
+    switch (algorithm) {
+    case Algorithm::NewReno:
+        return "newreno"sv;
+    case Algorithm::Cubic:
+        return "cubic"sv;
+    }
+    VERIFY_NOT_REACHED();
+}
+
+TCPCongestionControl::TCPCongestionControl()
+{
+    m_congestion_window = initial_window();
+}
+
+u32 TCPCongestionControl::initial_window() const
+{
+    // RFC 6928, 2: IW = min (10*MSS, max (2*MSS, 14600))
+    return min(10 * m_maximum_segment_size, max(2 * m_maximum_segment_size, 14600u));
+}
+
+void TCPCongestionControl::set_maximum_segment_size(u32 maximum_segment_size)
+{
+    VERIFY(maximum_segment_size > 0);
+    bool is_initial_window = m_congestion_window == initial_window();
+    m_maximum_segment_size = maximum_segment_size;
+    if (is_initial_window)
+        m_congestion_window = initial_window();
+}
+
+void TCPCongestionControl::on_ack(u32 bytes_acked, u32 ack_number, UnixDateTime now, Duration smoothed_rtt)
+{
+    if (m_in_recovery) {
+        if (tcp_sequence_before(ack_number, m_recovery_point)) {
+            // RFC 6582, 3.2 (step 3): Partial acknowledgment, deflate the window by the amount of
+            // new data acknowledged and add back one MSS for the retransmitted segment.
+            m_congestion_window -= min(m_congestion_window, bytes_acked);
+            m_congestion_window = max(m_congestion_window + m_maximum_segment_size, m_maximum_segment_size);
+            return;
+        }
+        // RFC 6582, 3.2 (step 3): Full acknowledgment, deflate the window.
+        m_in_recovery = false;
+        m_congestion_window = max(m_slow_start_threshold, m_maximum_segment_size);
+        return;
+    }
+
+    if (m_congestion_window < m_slow_start_threshold) {
+        // RFC 3465, 2.2: Appropriate byte counting with L = 2*SMSS.
+        m_congestion_window += min(bytes_acked, 2 * m_maximum_segment_size);
+        return;
+    }
+
+    increase_window_in_congestion_avoidance(bytes_acked, now, smoothed_rtt);
+}
+
+void TCPCongestionControl::on_duplicate_ack()
+{
+    // RFC 6582, 3.2 (step 4): Artificially inflate the window for each additional duplicate ACK.
+    if (m_in_recovery)
+        m_congestion_window += m_maximum_segment_size;
+}
+
+void TCPCongestionControl::on_enter_recovery(u32 bytes_in_flight, u32 recovery_point)
+{
+    if (m_in_recovery)
+        return;
+    m_in_recovery = true;
+    m_recovery_point = recovery_point;
+    m_slow_start_threshold = slow_start_threshold_after_loss(bytes_in_flight);
+    m_congestion_window = m_slow_start_threshold + 3 * m_maximum_segment_size;
+}
+
+void TCPCongestionControl::on_retransmit_timeout(u32 bytes_in_flight)
+{
+    // RFC 5681, 3.1: Upon a timeout cwnd MUST be set to no more than the loss window.
+    m_in_recovery = false;
+    m_slow_start_threshold = slow_start_threshold_after_loss(bytes_in_flight);
+    m_congestion_window = m_maximum_segment_size;
+}
+
+void TCPNewReno::increase_window_in_congestion_avoidance(u32 bytes_acked, UnixDateTime, Duration)
+{
+    // RFC 5681, 3.1: Increase cwnd by one SMSS per round trip, using byte counting.
+    m_bytes_acked_in_congestion_avoidance += bytes_acked;
+    if (m_bytes_acked_in_congestion_avoidance >= m_congestion_window) {
+        m_bytes_acked_in_congestion_avoidance -= m_congestion_window;
+        m_congestion_window += m_maximum_segment_size;
+    }
+}
+
+u32 TCPNewReno::slow_start_threshold_after_loss(u32 bytes_in_flight)
+{
+    // RFC 5681, 3.1 (equation 4)
+    m_bytes_acked_in_congestion_avoidance = 0;
+    return max(bytes_in_flight / 2, 2 * m_maximum_segment_size);
+}
+
+// C = 0.4 and beta_cubic = 0.7, expressed as fractions of 10.
+static constexpr u64 cubic_c_tenths = 4;
+static constexpr u64 cubic_beta_tenths = 7;
+
+// The largest time offset we evaluate the cubic function at, roughly 17 minutes. This keeps its cube within an i64.
+static constexpr i64 cubic_maximum_time_offset_ms = 1 << 20;
+
+static u64 integer_cube_root(u64 value)
+{
+    u64 low = 0;
+    u64 high = 1 << 21;
+    while (low < high) {
+        u64 middle = (low + high + 1) / 2;
+        if (middle * middle * middle <= value)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    return low;
+}
+
+void TCPCubic::increase_window_in_congestion_avoidance(u32 bytes_acked, UnixDateTime now, Duration smoothed_rtt)
+{
+    u64 const mss = m_maximum_segment_size;
+
+    if (!m_epoch_start.has_value()) {
+        // RFC 9438, 4.2: Start a new congestion avoidance epoch.
+        m_epoch_start = now;
+        m_reno_friendly_window = m_congestion_window;
+        if (m_congestion_window < m_window_max) {
+            // K = cubic_root((W_max - cwnd_epoch) / C), in segments and seconds.
+            u64 distance = min<u64>(m_window_max - m_congestion_window, NumericLimits<u32>::max() / 4);
+            m_time_to_origin_point_ms = static_cast<i64>(integer_cube_root(distance * 10'000'000'000ull / (cubic_c_tenths * mss)));
+            m_origin_point = m_window_max;
+        } else {
+            m_time_to_origin_point_ms = 0;
+            m_origin_point = m_congestion_window;
+        }
+    }
+
+    // RFC 9438, 4.2: Evaluate W_cubic(t + RTT) to get the target window.
+    i64 elapsed_ms = (now - m_epoch_start.value()).to_milliseconds();
+    i64 rtt_ms = max<i64>(smoothed_rtt.to_milliseconds(), 1);
+    i64 offset_ms = clamp(elapsed_ms + rtt_ms - m_time_to_origin_point_ms, -cubic_maximum_time_offset_ms, cubic_maximum_time_offset_ms);
+    i64 cube = offset_ms * offset_ms * offset_ms;
+    i64 cubic_term = (cube / 1'000'000) * static_cast<i64>(cubic_c_tenths * mss) / 10'000;
+    i64 target = clamp<i64>(static_cast<i64>(m_origin_point) + cubic_term, m_congestion_window, m_congestion_window + m_congestion_window / 2);
+
+    // RFC 9438, 4.3: The Reno-friendly region, with alpha_cubic = 3 * (1 - beta) / (1 + beta).
+    u64 alpha_thousandths = 3000 * (10 - cubic_beta_tenths) / (10 + cubic_beta_tenths);
+    u64 reno_increment = alpha_thousandths * bytes_acked * mss / (1000 * max<u64>(m_reno_friendly_window, 1));
+    m_reno_friendly_window = static_cast<u32>(min<u64>(m_reno_friendly_window + reno_increment, NumericLimits<u32>::max()));
+
+    if (m_reno_friendly_window > target) {
+        m_congestion_window = m_reno_friendly_window;
+        return;
+    }
+
+    // RFC 9438, 4.4: Concave and convex regions.
+    u64 increment = static_cast<u64>(target - m_congestion_window) * bytes_acked / m_congestion_window;
+    m_congestion_window = static_cast<u32>(min<u64>(m_congestion_window + increment, NumericLimits<u32>::max()));
+}
+
+u32 TCPCubic::slow_start_threshold_after_loss(u32)
+{
+    // RFC 9438, 4.6 and 4.7: Multiplicative decrease with fast convergence.
+    u64 window = m_congestion_window;
+    if (window < m_last_window_max)
+        m_window_max = static_cast<u32>(window * (10 + cubic_beta_tenths) / 20);
+    else
+        m_window_max = static_cast<u32>(window);
+    m_last_window_max = static_cast<u32>(window);
+    m_epoch_start.clear();
+    return max(static_cast<u32>(window * cubic_beta_tenths / 10), 2 * m_maximum_segment_size);
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace Kernel {
+
+// The congestion window bookkeeping shared by all algorithms (slow start, fast recovery
+// and the reaction to a retransmission timeout) follows RFC 5681 and RFC 6582. Subclasses
+// decide how the window grows during congestion avoidance and how much it shrinks on loss.
+class TCPCongestionControl {
+public:
+    enum class Algorithm {
+        NewReno,
+        Cubic,
+    };
+
+    static ErrorOr<NonnullOwnPtr<TCPCongestionControl>> try_create(Algorithm);
+
+    static Algorithm default_algorithm();
+    static void set_default_algorithm(Algorithm);
+    static Optional<Algorithm> algorithm_from_name(StringView);
+    static StringView name(Algorithm);
+
+    virtual ~TCPCongestionControl() = default;
+
+    virtual Algorithm algorithm() const = 0;
+
+    u32 maximum_segment_size() const { return m_maximum_segment_size; }
+    void set_maximum_segment_size(u32);
+
+    u32 congestion_window() const { return m_congestion_window; }
+    u32 slow_start_threshold() const { return m_slow_start_threshold; }
+    bool is_in_recovery() const { return m_in_recovery; }
+
+    void on_ack(u32 bytes_acked, u32 ack_number, UnixDateTime now, Duration smoothed_rtt);
+    void on_duplicate_ack();
+    void on_enter_recovery(u32 bytes_in_flight, u32 recovery_point);
+    void on_retransmit_timeout(u32 bytes_in_flight);
+
+protected:
+    TCPCongestionControl();
+
+    virtual void increase_window_in_congestion_avoidance(u32 bytes_acked, UnixDateTime now, Duration smoothed_rtt) = 0;
+    virtual u32 slow_start_threshold_after_loss(u32 bytes_in_flight) = 0;
+
+    u32 m_maximum_segment_size { 536 };
+    u32 m_congestion_window { 0 };
+    u32 m_slow_start_threshold { NumericLimits<u32>::max() };
+
+private:
+    u32 initial_window() const;
+
+    bool m_in_recovery { false };
+    u32 m_recovery_point { 0 };
+};
+
+class TCPNewReno final : public TCPCongestionControl {
+public:
+    virtual Algorithm algorithm() const override { return Algorithm::NewReno; }
+
+private:
+    virtual void increase_window_in_congestion_avoidance(u32 bytes_acked, UnixDateTime now, Duration smoothed_rtt) override;
+    virtual u32 slow_start_threshold_after_loss(u32 bytes_in_flight) override;
+
+    u32 m_bytes_acked_in_congestion_avoidance { 0 };
+};
+
+// RFC 9438. Everything is done in fixed-point arithmetic since we can't use the FPU in the kernel.
+class TCPCubic final : public TCPCongestionControl {
+public:
+    virtual Algorithm algorithm() const override { return Algorithm::Cubic; }
+
+private:
+    virtual void increase_window_in_congestion_avoidance(u32 bytes_acked, UnixDateTime now, Duration smoothed_rtt) override;
+    virtual u32 slow_start_threshold_after_loss(u32 bytes_in_flight) override;
+
+    Optional<UnixDateTime> m_epoch_start;
+    u32 m_window_max { 0 };
+    u32 m_last_window_max { 0 };
+    u32 m_origin_point { 0 };
+    u32 m_reno_friendly_window { 0 };
+    i64 m_time_to_origin_point_ms { 0 };
+};
+
+}
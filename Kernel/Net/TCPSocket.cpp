@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/AnyOf.h>
 #include <AK/Singleton.h>
 #include <AK/Time.h>
 #include <Kernel/Debug.h>
@@ -130,7 +131,7 @@ ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create_client(IPv4Address const
             return EEXIST;
 
         auto receive_buffer = TRY(try_create_receive_buffer());
-        auto client = TRY(TCPSocket::try_create(protocol(), move(receive_buffer)));
+        auto client = TRY(TCPSocket::try_create(protocol(), move(receive_buffer), m_congestion_control->algorithm()));
 
         client->set_setup_state(SetupState::InProgress);
         client->set_local_address(new_local_address);
@@ -162,10 +163,11 @@ void TCPSocket::release_for_accept(NonnullRefPtr<TCPSocket> socket)
     [[maybe_unused]] auto rc = queue_connection_from(move(socket));
 }
 
-TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer)
+TCPSocket::TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl> congestion_control)
     : IPv4Socket(SOCK_STREAM, protocol, move(receive_buffer), move(scratch_buffer))
+    , m_congestion_control(move(congestion_control))
 {
-    m_last_retransmit_time = kgettimeofday();
+    m_retransmit_timer_start = kgettimeofday();
 }
 
 TCPSocket::~TCPSocket()
@@ -176,10 +178,16 @@ TCPSocket::~TCPSocket()
 }
 
 ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer)
+{
+    return try_create(protocol, move(receive_buffer), TCPCongestionControl::default_algorithm());
+}
+
+ErrorOr<NonnullRefPtr<TCPSocket>> TCPSocket::try_create(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, TCPCongestionControl::Algorithm congestion_control_algorithm)
 {
     // Note: Scratch buffer is only used for SOCK_STREAM sockets.
     auto scratch_buffer = TRY(KBuffer::try_create_with_size("TCPSocket: Scratch buffer"sv, 65536));
-    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer)));
+    auto congestion_control = TRY(TCPCongestionControl::try_create(congestion_control_algorithm));
+    return adopt_nonnull_ref_or_enomem(new (nothrow) TCPSocket(protocol, move(receive_buffer), move(scratch_buffer), move(congestion_control)));
 }
 
 ErrorOr<size_t> TCPSocket::protocol_size(ReadonlyBytes raw_ipv4_packet)
@@ -206,12 +214,161 @@ ErrorOr<size_t> TCPSocket::protocol_send(UserOrKernelBuffer const& data, size_t
     RoutingDecision routing_decision = route_to(peer_address(), local_address(), adapter);
     if (routing_decision.is_zero())
         return set_so_error(EHOSTUNREACH);
-    size_t mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-    data_length = min(data_length, mss);
+    size_t mss = min<size_t>(routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket), m_peer_maximum_segment_size);
+    size_t available_window = available_send_window();
+    if (available_window == 0)
+        return set_so_error(EAGAIN);
+    data_length = min(data_length, min(mss, available_window));
     TRY(send_tcp_packet(TCPFlags::PSH | TCPFlags::ACK, &data, data_length, &routing_decision));
     return data_length;
 }
 
+void TCPSocket::did_consume_receive_buffer()
+{
+    if (m_state != State::Established)
+        return;
+
+    // RFC 1122, 4.2.3.3: To avoid the silly window syndrome, only announce a larger window
+    // once it has grown by at least min(MSS, receive buffer size / 2).
+    size_t window_size = receive_buffer_space_for_writing();
+    size_t threshold = min<size_t>(m_peer_maximum_segment_size, receive_buffer_size / 2);
+    if (window_size < m_last_window_size_sent + threshold)
+        return;
+    [[maybe_unused]] auto result = send_ack(true);
+}
+
+static constexpr u8 receive_window_scale_for(size_t buffer_size)
+{
+    u8 shift = 0;
+    while ((buffer_size >> shift) > NumericLimits<u16>::max() && shift < maximum_tcp_window_scale)
+        ++shift;
+    return shift;
+}
+
+void TCPSocket::apply_syn_options(TCPPacket const& packet)
+{
+    VERIFY(packet.has_syn());
+
+    Optional<u16> maximum_segment_size;
+    Optional<u8> window_scale;
+    bool sack_permitted = false;
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        switch (kind) {
+        case TCPOptionKind::MSS:
+            if (data.size() == sizeof(u16))
+                maximum_segment_size = (data[0] << 8) | data[1];
+            break;
+        case TCPOptionKind::WindowScale:
+            if (data.size() == sizeof(u8))
+                window_scale = data[0];
+            break;
+        case TCPOptionKind::SACKPermitted:
+            sack_permitted = true;
+            break;
+        default:
+            break;
+        }
+    });
+
+    if (maximum_segment_size.has_value() && maximum_segment_size.value() > 0)
+        m_peer_maximum_segment_size = maximum_segment_size.value();
+    m_congestion_control->set_maximum_segment_size(m_peer_maximum_segment_size);
+
+    // RFC 7323, 2.2: Window scaling is only enabled if both sides sent the option on their SYN.
+    m_window_scaling_enabled = window_scale.has_value();
+    if (m_window_scaling_enabled) {
+        // RFC 7323, 2.3: A shift count larger than 14 must be treated as 14.
+        m_send_window_scale = min(window_scale.value(), maximum_tcp_window_scale);
+        m_receive_window_scale = receive_window_scale_for(receive_buffer_size);
+    } else {
+        m_send_window_scale = 0;
+        m_receive_window_scale = 0;
+    }
+
+    m_sack_permitted = sack_permitted;
+
+    // RFC 7323, 2.2: The window field in a SYN segment is never scaled.
+    m_send_window_size = packet.window_size();
+    m_send_window_update_sequence_number = packet.sequence_number();
+    m_send_window_update_ack_number = packet.ack_number();
+
+    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) SYN options: mss={}, send_window_scale={}, receive_window_scale={}, sack_permitted={}",
+        this, m_peer_maximum_segment_size, m_send_window_scale, m_receive_window_scale, m_sack_permitted);
+}
+
+u32 TCPSocket::available_send_window() const
+{
+    return m_unacked_packets.with_shared([&](auto const& unacked_packets) -> u32 {
+        // With nothing in flight we always allow a segment, which also serves to probe a zero window.
+        if (unacked_packets.size == 0)
+            return max(min(m_send_window_size, m_congestion_control->congestion_window()), 1u);
+
+        // The peer's window limits everything that is outstanding, while the congestion
+        // window only limits what we believe to still be in the network.
+        u32 receive_window_space = m_send_window_size > unacked_packets.size ? m_send_window_size - unacked_packets.size : 0;
+        u32 congestion_window = m_congestion_control->congestion_window();
+        u32 congestion_window_space = congestion_window > unacked_packets.pipe() ? congestion_window - unacked_packets.pipe() : 0;
+        return min(receive_window_space, congestion_window_space);
+    });
+}
+
+u16 TCPSocket::advertised_window_size(bool is_syn) const
+{
+    size_t window_size = receive_buffer_space_for_writing();
+    // RFC 7323, 2.2: The window field in a SYN segment is never scaled.
+    if (!is_syn)
+        window_size >>= m_receive_window_scale;
+    return min<size_t>(window_size, NumericLimits<u16>::max());
+}
+
+size_t TCPSocket::write_sack_option(Bytes options) const
+{
+    struct Range {
+        u32 left_edge;
+        u32 right_edge;
+    };
+    Vector<Range, maximum_out_of_order_segments> ranges;
+    for (auto const& segment : m_out_of_order_segments) {
+        u32 end = segment.sequence_number + segment.payload_size;
+        if (!ranges.is_empty() && tcp_sequence_before_or_equal(segment.sequence_number, ranges.last().right_edge)) {
+            if (tcp_sequence_before(ranges.last().right_edge, end))
+                ranges.last().right_edge = end;
+            continue;
+        }
+        ranges.unchecked_append({ segment.sequence_number, end });
+    }
+    if (ranges.is_empty())
+        return 0;
+
+    // RFC 2018, 4: The first block must contain the most recently received segment.
+    size_t first_index = 0;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        if (tcp_sequence_before_or_equal(ranges[i].left_edge, m_last_out_of_order_sequence_number)
+            && tcp_sequence_before(m_last_out_of_order_sequence_number, ranges[i].right_edge)) {
+            first_index = i;
+            break;
+        }
+    }
+
+    size_t block_count = min(ranges.size(), maximum_tcp_sack_blocks);
+    size_t option_size = 2 + block_count * sizeof(TCPSACKBlock);
+    VERIFY(options.size() >= option_size + 2);
+
+    options[0] = to_underlying(TCPOptionKind::NoOperation);
+    options[1] = to_underlying(TCPOptionKind::NoOperation);
+    options[2] = to_underlying(TCPOptionKind::SACK);
+    options[3] = option_size;
+    auto* blocks = reinterpret_cast<TCPSACKBlock*>(options.offset_pointer(4));
+    blocks[0] = { ranges[first_index].left_edge, ranges[first_index].right_edge };
+    size_t written_blocks = 1;
+    for (size_t i = 0; i < ranges.size() && written_blocks < block_count; ++i) {
+        if (i == first_index)
+            continue;
+        blocks[written_blocks++] = { ranges[i].left_edge, ranges[i].right_edge };
+    }
+    return option_size + 2;
+}
+
 ErrorOr<void> TCPSocket::send_ack(bool allow_duplicate)
 {
     if (!allow_duplicate && m_last_ack_number_sent == m_ack_number)
@@ -228,8 +385,38 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
 
     auto ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
 
-    bool const has_mss_option = flags == TCPFlags::SYN;
-    const size_t options_size = has_mss_option ? sizeof(TCPOptionMSS) : 0;
+    bool const is_syn = flags & TCPFlags::SYN;
+    u8 options[maximum_tcp_options_size];
+    size_t options_size = 0;
+    auto append_option = [&](auto const& option) {
+        VERIFY(options_size + sizeof(option) <= sizeof(options));
+        memcpy(options + options_size, &option, sizeof(option));
+        options_size += sizeof(option);
+    };
+    auto append_padding = [&](size_t count) {
+        VERIFY(options_size + count <= sizeof(options));
+        memset(options + options_size, to_underlying(TCPOptionKind::NoOperation), count);
+        options_size += count;
+    };
+
+    if (is_syn) {
+        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
+        append_option(TCPOptionMSS { mss });
+        // RFC 7323, 1.3 and RFC 2018, 2: A SYN|ACK may only carry these options if the peer's SYN did.
+        bool const is_syn_ack = flags & TCPFlags::ACK;
+        if (!is_syn_ack || m_window_scaling_enabled) {
+            append_padding(1);
+            append_option(TCPOptionWindowScale { receive_window_scale_for(receive_buffer_size) });
+        }
+        if (!is_syn_ack || m_sack_permitted) {
+            append_padding(2);
+            append_option(TCPOptionSACKPermitted {});
+        }
+    } else if ((flags & TCPFlags::ACK) && m_sack_permitted && !m_out_of_order_segments.is_empty()) {
+        options_size = write_sack_option({ options, sizeof(options) });
+    }
+    VERIFY(options_size % sizeof(u32) == 0);
+
     const size_t tcp_header_size = sizeof(TCPPacket) + options_size;
     const size_t buffer_size = ipv4_payload_offset + tcp_header_size + payload_size;
     auto packet = routing_decision.adapter->acquire_packet_buffer(buffer_size);
@@ -243,8 +430,11 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     VERIFY(local_port());
     tcp_packet.set_source_port(local_port());
     tcp_packet.set_destination_port(peer_port());
-    tcp_packet.set_window_size(NumericLimits<u16>::max());
-    tcp_packet.set_sequence_number(m_sequence_number);
+    auto window_size = advertised_window_size(is_syn);
+    tcp_packet.set_window_size(window_size);
+    m_last_window_size_sent = is_syn ? window_size : static_cast<u32>(window_size) << m_receive_window_scale;
+    u32 const sequence_number = m_sequence_number;
+    tcp_packet.set_sequence_number(sequence_number);
     tcp_packet.set_data_offset(tcp_header_size / sizeof(u32));
     tcp_packet.set_flags(flags);
 
@@ -267,11 +457,9 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
         m_sequence_number += payload_size;
     }
 
-    if (has_mss_option) {
-        u16 mss = routing_decision.adapter->mtu() - sizeof(IPv4Packet) - sizeof(TCPPacket);
-        TCPOptionMSS mss_option { mss };
-        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + sizeof(mss_option));
-        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), &mss_option, sizeof(mss_option));
+    if (options_size > 0) {
+        VERIFY(packet->buffer->size() >= ipv4_payload_offset + sizeof(TCPPacket) + options_size);
+        memcpy(packet->buffer->data() + ipv4_payload_offset + sizeof(TCPPacket), options, options_size);
     }
 
     tcp_packet.set_checksum(compute_tcp_checksum(local_address(), peer_address(), tcp_packet, payload_size));
@@ -280,7 +468,11 @@ ErrorOr<void> TCPSocket::send_tcp_packet(u16 flags, UserOrKernelBuffer const* pa
     if (expect_ack) {
         bool append_failed { false };
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter });
+            auto now = kgettimeofday();
+            // RFC 6298, 5.1: Start the retransmission timer if it isn't running already.
+            if (unacked_packets.packets.is_empty())
+                m_retransmit_timer_start = now;
+            auto result = unacked_packets.packets.try_append({ m_sequence_number, packet, ipv4_payload_offset, *routing_decision.adapter, 0, sequence_number, static_cast<u32>(payload_size), now });
             if (result.is_error()) {
                 dbgln("TCPSocket: Dropped outbound packet because try_append() failed");
                 append_failed = true;
@@ -306,31 +498,91 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 {
     if (packet.has_ack()) {
         u32 ack_number = packet.ack_number();
+        size_t payload_size = size - packet.header_size();
+        auto now = kgettimeofday();
 
         dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet: {}", ack_number);
 
+        // RFC 9293, 3.10.7.4: Only take the window from segments that are newer than the one that last updated it
+        // (SND.WL1 and SND.WL2), so that an old segment arriving late can't shrink the window again.
+        bool window_changed = false;
+        u32 sequence_number = packet.sequence_number();
+        if (packet.has_syn()
+            || tcp_sequence_before(m_send_window_update_sequence_number, sequence_number)
+            || (m_send_window_update_sequence_number == sequence_number && tcp_sequence_before_or_equal(m_send_window_update_ack_number, ack_number))) {
+            // RFC 7323, 2.2: The window field in a SYN segment is never scaled.
+            u32 window_size = packet.has_syn() ? packet.window_size() : static_cast<u32>(packet.window_size()) << m_send_window_scale;
+            window_changed = window_size != m_send_window_size;
+            m_send_window_size = window_size;
+            m_send_window_update_sequence_number = sequence_number;
+            m_send_window_update_ack_number = ack_number;
+        }
+
         int removed = 0;
         m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+            bool is_duplicate_ack = !unacked_packets.packets.is_empty()
+                && unacked_packets.packets.first().sequence_number == ack_number
+                && payload_size == 0 && !packet.has_syn() && !packet.has_fin() && !window_changed;
+
+            u32 bytes_acked = 0;
+            Optional<Duration> rtt_sample;
             while (!unacked_packets.packets.is_empty()) {
-                auto& packet = unacked_packets.packets.first();
-
-                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", packet.ack_number);
-
-                if (packet.ack_number <= ack_number) {
-                    auto old_adapter = packet.adapter.strong_ref();
-                    if (old_adapter)
-                        old_adapter->release_packet_buffer(*packet.buffer);
-                    TCPPacket& tcp_packet = *(TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                    auto payload_size = packet.buffer->buffer->data() + packet.buffer->buffer->size() - (u8*)tcp_packet.payload();
-                    unacked_packets.size -= payload_size;
-                    evaluate_block_conditions();
-                    unacked_packets.packets.take_first();
-                    removed++;
-                } else {
+                auto& unacked_packet = unacked_packets.packets.first();
+
+                dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: iterate: {}", unacked_packet.ack_number);
+
+                if (!tcp_sequence_before_or_equal(unacked_packet.ack_number, ack_number))
                     break;
+
+                // RFC 6298, 3: Karn's algorithm, don't take RTT samples from retransmitted segments.
+                if (unacked_packet.tx_counter == 0)
+                    rtt_sample = now - unacked_packet.sent_time;
+
+                auto old_adapter = unacked_packet.adapter.strong_ref();
+                if (old_adapter)
+                    old_adapter->release_packet_buffer(*unacked_packet.buffer);
+                unacked_packets.size -= unacked_packet.payload_size;
+                if (unacked_packet.sacked)
+                    unacked_packets.sacked_size -= unacked_packet.payload_size;
+                if (unacked_packet.lost)
+                    unacked_packets.lost_size -= unacked_packet.payload_size;
+                bytes_acked += unacked_packet.payload_size;
+                unacked_packets.packets.take_first();
+                removed++;
+            }
+
+            if (m_sack_permitted)
+                process_sack_blocks(packet, unacked_packets);
+
+            if (removed > 0) {
+                m_duplicate_acks_received = 0;
+                m_retransmit_attempts = 0;
+                // RFC 6298, 5.3: Restart the retransmission timer when new data is acknowledged.
+                m_retransmit_timer_start = now;
+                if (rtt_sample.has_value())
+                    update_retransmission_timeout(rtt_sample.value());
+
+                bool was_in_recovery = m_congestion_control->is_in_recovery();
+                m_congestion_control->on_ack(bytes_acked, ack_number, now, m_smoothed_rtt.value_or(initial_retransmission_timeout));
+                // RFC 6582, 3.2 (step 3): A partial acknowledgment means the next segment was lost as well.
+                if (was_in_recovery && m_congestion_control->is_in_recovery() && !unacked_packets.packets.is_empty())
+                    unacked_packets.mark_lost(unacked_packets.packets.first());
+            } else if (is_duplicate_ack) {
+                ++m_duplicate_acks_received;
+                if (m_duplicate_acks_received == duplicate_ack_threshold && !m_congestion_control->is_in_recovery()) {
+                    // RFC 5681, 3.2: Fast retransmit.
+                    dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) entering fast recovery", this);
+                    m_congestion_control->on_enter_recovery(unacked_packets.pipe(), m_sequence_number);
+                    unacked_packets.mark_lost(unacked_packets.packets.first());
+                } else if (!m_sack_permitted) {
+                    m_congestion_control->on_duplicate_ack();
                 }
             }
 
+            if (m_sack_permitted && m_congestion_control->is_in_recovery())
+                mark_lost_packets(unacked_packets);
+            retransmit_lost_packets(unacked_packets);
+
             if (unacked_packets.packets.is_empty()) {
                 m_retransmit_attempts = 0;
                 dequeue_for_retransmit();
@@ -338,12 +590,75 @@ void TCPSocket::receive_tcp_packet(TCPPacket const& packet, u16 size)
 
             dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket: receive_tcp_packet acknowledged {} packets", removed);
         });
+
+        if (removed > 0 || window_changed)
+            evaluate_block_conditions();
     }
 
     m_packets_in++;
     m_bytes_in += packet.header_size() + size;
 }
 
+void TCPSocket::process_sack_blocks(TCPPacket const& packet, UnackedPackets& unacked_packets)
+{
+    packet.for_each_option([&](TCPOptionKind kind, ReadonlyBytes data) {
+        if (kind != TCPOptionKind::SACK)
+            return;
+        for (size_t offset = 0; offset + sizeof(TCPSACKBlock) <= data.size(); offset += sizeof(TCPSACKBlock)) {
+            auto const& block = *reinterpret_cast<TCPSACKBlock const*>(data.offset_pointer(offset));
+            u32 left_edge = block.left_edge;
+            u32 right_edge = block.right_edge;
+            for (auto& unacked_packet : unacked_packets.packets) {
+                if (tcp_sequence_before_or_equal(left_edge, unacked_packet.sequence_number) && tcp_sequence_before_or_equal(unacked_packet.ack_number, right_edge))
+                    unacked_packets.mark_sacked(unacked_packet);
+            }
+        }
+    });
+}
+
+void TCPSocket::mark_lost_packets(UnackedPackets& unacked_packets)
+{
+    // RFC 6675, 4: A segment is deemed lost once enough segments above it have been SACKed.
+    // We count segments rather than bytes, and leave segments that were already retransmitted
+    // to the retransmission timer.
+    size_t sacked_packets_above = 0;
+    for (auto const& unacked_packet : unacked_packets.packets) {
+        if (unacked_packet.sacked)
+            ++sacked_packets_above;
+    }
+    for (auto& unacked_packet : unacked_packets.packets) {
+        if (sacked_packets_above < duplicate_ack_threshold)
+            break;
+        if (unacked_packet.sacked) {
+            --sacked_packets_above;
+            continue;
+        }
+        if (unacked_packet.tx_counter == 0)
+            unacked_packets.mark_lost(unacked_packet);
+    }
+}
+
+void TCPSocket::update_retransmission_timeout(Duration rtt_sample)
+{
+    // RFC 6298, 2.2 and 2.3, with alpha = 1/8 and beta = 1/4.
+    i64 rtt = rtt_sample.to_microseconds();
+    i64 smoothed_rtt;
+    i64 rtt_variance;
+    if (!m_smoothed_rtt.has_value()) {
+        smoothed_rtt = rtt;
+        rtt_variance = rtt / 2;
+    } else {
+        smoothed_rtt = m_smoothed_rtt->to_microseconds();
+        rtt_variance = m_rtt_variance.to_microseconds();
+        i64 deviation = smoothed_rtt > rtt ? smoothed_rtt - rtt : rtt - smoothed_rtt;
+        rtt_variance = (3 * rtt_variance + deviation) / 4;
+        smoothed_rtt = (7 * smoothed_rtt + rtt) / 8;
+    }
+    m_smoothed_rtt = Duration::from_microseconds(smoothed_rtt);
+    m_rtt_variance = Duration::from_microseconds(rtt_variance);
+    m_retransmission_timeout = clamp(Duration::from_microseconds(smoothed_rtt + 4 * rtt_variance), minimum_retransmission_timeout, maximum_retransmission_timeout);
+}
+
 bool TCPSocket::should_delay_next_ack() const
 {
     // FIXME: We don't know the MSS here so make a reasonable guess.
@@ -576,22 +891,25 @@ void TCPSocket::dequeue_for_retransmit()
     });
 }
 
-void TCPSocket::retransmit_packets()
+UnixDateTime TCPSocket::retransmit_deadline() const
 {
-    auto now = kgettimeofday();
-
-    // RFC6298 says we should have at least one second between retransmits. According to
+    // RFC 6298, 5.5: Back off the timer by doubling it after each retransmission. According to
     // RFC1122 we must do exponential backoff - even for SYN packets.
-    i64 retransmit_interval = 1;
-    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts; i++)
-        retransmit_interval *= 2;
+    auto retransmission_timeout = m_retransmission_timeout;
+    for (decltype(m_retransmit_attempts) i = 0; i < m_retransmit_attempts && retransmission_timeout < maximum_retransmission_timeout; i++)
+        retransmission_timeout += retransmission_timeout;
+    return m_retransmit_timer_start + min(retransmission_timeout, maximum_retransmission_timeout);
+}
 
-    if (m_last_retransmit_time > now - Duration::from_seconds(retransmit_interval))
+void TCPSocket::retransmit_packets()
+{
+    auto now = kgettimeofday();
+    if (now < retransmit_deadline())
         return;
 
     dbgln_if(TCP_SOCKET_DEBUG, "TCPSocket({}) handling retransmit", this);
 
-    m_last_retransmit_time = now;
+    m_retransmit_timer_start = now;
     ++m_retransmit_attempts;
 
     if (m_retransmit_attempts > maximum_retransmits) {
@@ -601,47 +919,135 @@ void TCPSocket::retransmit_packets()
         return;
     }
 
+    m_duplicate_acks_received = 0;
+    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
+        if (unacked_packets.packets.is_empty())
+            return;
+
+        // RFC 5681, 3.1: Collapse the congestion window to the loss window.
+        m_congestion_control->on_retransmit_timeout(unacked_packets.pipe());
+
+        // RFC 2018, 8: After a retransmit timeout the receiver may have reneged on its SACKs,
+        // so forget about them and consider everything outstanding as lost.
+        for (auto& unacked_packet : unacked_packets.packets) {
+            unacked_packet.sacked = false;
+            unacked_packet.lost = true;
+        }
+        unacked_packets.sacked_size = 0;
+        unacked_packets.lost_size = unacked_packets.size;
+
+        retransmit_lost_packets(unacked_packets);
+    });
+}
+
+void TCPSocket::retransmit_lost_packets(UnackedPackets& unacked_packets)
+{
+    bool has_lost_packets = any_of(unacked_packets.packets, [](auto const& unacked_packet) { return unacked_packet.lost; });
+    if (!has_lost_packets)
+        return;
+
     auto adapter = bound_interface().with([](auto& bound_device) -> RefPtr<NetworkAdapter> { return bound_device; });
     auto routing_decision = route_to(peer_address(), local_address(), adapter);
     if (routing_decision.is_zero())
         return;
 
-    m_unacked_packets.with_exclusive([&](auto& unacked_packets) {
-        for (auto& packet : unacked_packets.packets) {
-            packet.tx_counter++;
-
-            if constexpr (TCP_SOCKET_DEBUG) {
-                auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
-                dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
-                    local_address(), local_port(),
-                    peer_address(), peer_port(),
-                    (tcp_packet.has_syn() ? "SYN " : ""),
-                    (tcp_packet.has_ack() ? "ACK " : ""),
-                    (tcp_packet.has_fin() ? "FIN " : ""),
-                    (tcp_packet.has_rst() ? "RST " : ""),
-                    tcp_packet.sequence_number(),
-                    tcp_packet.ack_number(),
-                    packet.tx_counter);
-            }
+    u32 congestion_window = m_congestion_control->congestion_window();
+    for (auto& unacked_packet : unacked_packets.packets) {
+        if (!unacked_packet.lost)
+            continue;
+        // RFC 6675, 5: Only retransmit while there is room in the congestion window,
+        // but always allow retransmitting at least one segment.
+        if (unacked_packets.pipe() > 0 && unacked_packets.pipe() + unacked_packet.payload_size > congestion_window)
+            break;
+        unacked_packet.lost = false;
+        unacked_packets.lost_size -= unacked_packet.payload_size;
+        retransmit_packet(unacked_packet, routing_decision);
+    }
+}
 
-            size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
-            if (ipv4_payload_offset != packet.ipv4_payload_offset) {
-                // FIXME: Add support for this. This can happen if after a route change
-                // we ended up on another adapter which doesn't have the same layer 2 type
-                // like the previous adapter.
-                VERIFY_NOT_REACHED();
-            }
+void TCPSocket::retransmit_packet(OutgoingPacket& packet, RoutingDecision const& routing_decision)
+{
+    packet.tx_counter++;
+    m_retransmitted_packets++;
+
+    if constexpr (TCP_SOCKET_DEBUG) {
+        auto& tcp_packet = *(const TCPPacket*)(packet.buffer->buffer->data() + packet.ipv4_payload_offset);
+        dbgln("Sending TCP packet from {}:{} to {}:{} with ({}{}{}{}) seq_no={}, ack_no={}, tx_counter={}",
+            local_address(), local_port(),
+            peer_address(), peer_port(),
+            (tcp_packet.has_syn() ? "SYN " : ""),
+            (tcp_packet.has_ack() ? "ACK " : ""),
+            (tcp_packet.has_fin() ? "FIN " : ""),
+            (tcp_packet.has_rst() ? "RST " : ""),
+            tcp_packet.sequence_number(),
+            tcp_packet.ack_number(),
+            packet.tx_counter);
+    }
+
+    size_t ipv4_payload_offset = routing_decision.adapter->ipv4_payload_offset();
+    if (ipv4_payload_offset != packet.ipv4_payload_offset) {
+        // FIXME: Add support for this. This can happen if after a route change
+        // we ended up on another adapter which doesn't have the same layer 2 type
+        // like the previous adapter.
+        VERIFY_NOT_REACHED();
+    }
+
+    auto packet_buffer = packet.buffer->bytes();
+
+    routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
+        local_address(), routing_decision.next_hop, peer_address(),
+        IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
+    routing_decision.adapter->send_packet(packet_buffer);
+    m_packets_out++;
+    m_bytes_out += packet_buffer.size();
+}
+
+bool TCPSocket::queue_out_of_order_segment(IPv4Packet const& ipv4_packet, TCPPacket const& tcp_packet, size_t payload_size, UnixDateTime const& packet_timestamp)
+{
+    u32 sequence_number = tcp_packet.sequence_number();
+    if (payload_size == 0 || !tcp_sequence_before(m_ack_number, sequence_number))
+        return false;
+    if (m_out_of_order_segments.size() >= maximum_out_of_order_segments)
+        return false;
 
-            auto packet_buffer = packet.buffer->bytes();
+    // Only hold on to data that fits into the window we advertised.
+    if ((sequence_number + payload_size) - m_ack_number > receive_buffer_space_for_writing())
+        return false;
 
-            routing_decision.adapter->fill_in_ipv4_header(*packet.buffer,
-                local_address(), routing_decision.next_hop, peer_address(),
-                IPv4Protocol::TCP, packet_buffer.size() - ipv4_payload_offset, type_of_service(), ttl());
-            routing_decision.adapter->send_packet(packet_buffer);
-            m_packets_out++;
-            m_bytes_out += packet_buffer.size();
+    size_t index = 0;
+    for (; index < m_out_of_order_segments.size(); ++index) {
+        auto const& segment = m_out_of_order_segments[index];
+        if (segment.sequence_number == sequence_number) {
+            m_last_out_of_order_sequence_number = sequence_number;
+            return true;
         }
-    });
+        if (tcp_sequence_before(sequence_number, segment.sequence_number))
+            break;
+    }
+
+    auto packet_or_error = KBuffer::try_create_with_bytes("TCPSocket: Out of order segment"sv, { &ipv4_packet, sizeof(IPv4Packet) + ipv4_packet.payload_size() });
+    if (packet_or_error.is_error())
+        return false;
+    if (m_out_of_order_segments.try_insert(index, { sequence_number, static_cast<u32>(payload_size), packet_or_error.release_value(), packet_timestamp }).is_error())
+        return false;
+    m_last_out_of_order_sequence_number = sequence_number;
+    return true;
+}
+
+void TCPSocket::deliver_out_of_order_segments()
+{
+    while (!m_out_of_order_segments.is_empty()) {
+        if (tcp_sequence_before(m_ack_number, m_out_of_order_segments.first().sequence_number))
+            return;
+        auto segment = m_out_of_order_segments.take_first();
+        // Segments overlapping data we already have are dropped, the peer will retransmit whatever is still missing.
+        if (segment.sequence_number != m_ack_number)
+            continue;
+        auto const& ipv4_packet = *reinterpret_cast<IPv4Packet const*>(segment.packet->data());
+        if (!did_receive(ipv4_packet.source(), peer_port(), segment.packet->bytes(), segment.timestamp))
+            return;
+        m_ack_number += segment.payload_size;
+    }
 }
 
 bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size) const
@@ -652,11 +1058,6 @@ bool TCPSocket::can_write(OpenFileDescription const& file_description, u64 size)
     if (m_state == State::SynSent || m_state == State::SynReceived)
         return false;
 
-    if (!file_description.is_blocking())
-        return true;
-
-    return m_unacked_packets.with_shared([&](auto& unacked_packets) {
-        return unacked_packets.size + size <= m_send_window_size;
-    });
+    return available_send_window() > 0;
 }
 }
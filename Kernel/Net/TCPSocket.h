@@ -13,6 +13,7 @@
 #include <Kernel/Library/LockWeakPtr.h>
 #include <Kernel/Locking/MutexProtected.h>
 #include <Kernel/Net/IPv4Socket.h>
+#include <Kernel/Net/TCPCongestionControl.h>
 
 namespace Kernel {
 
@@ -21,6 +22,7 @@ public:
     static void for_each(Function<void(TCPSocket const&)>);
     static ErrorOr<void> try_for_each(Function<ErrorOr<void>(TCPSocket const&)>);
     static ErrorOr<NonnullRefPtr<TCPSocket>> try_create(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer);
+    static ErrorOr<NonnullRefPtr<TCPSocket>> try_create(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, TCPCongestionControl::Algorithm);
     virtual ~TCPSocket() override;
 
     virtual bool unref() const override;
@@ -139,10 +141,27 @@ public:
     void set_duplicate_acks(u32 acks) { m_duplicate_acks = acks; }
     u32 duplicate_acks() const { return m_duplicate_acks; }
 
+    u32 send_window_size() const { return m_send_window_size; }
+    u32 congestion_window() const { return m_congestion_control->congestion_window(); }
+    u32 slow_start_threshold() const { return m_congestion_control->slow_start_threshold(); }
+    StringView congestion_control_name() const { return TCPCongestionControl::name(m_congestion_control->algorithm()); }
+    Duration retransmission_timeout() const { return m_retransmission_timeout; }
+    Optional<Duration> smoothed_rtt() const { return m_smoothed_rtt; }
+    bool is_sack_permitted() const { return m_sack_permitted; }
+    u32 retransmitted_packets() const { return m_retransmitted_packets; }
+
     ErrorOr<void> send_ack(bool allow_duplicate = false);
     ErrorOr<void> send_tcp_packet(u16 flags, UserOrKernelBuffer const* = nullptr, size_t = 0, RoutingDecision* = nullptr);
     void receive_tcp_packet(TCPPacket const&, u16 size);
 
+    // Applies the MSS, window scale and SACK-permitted options from a SYN segment.
+    void apply_syn_options(TCPPacket const&);
+
+    // Holds on to a segment that arrived ahead of a hole, so it doesn't have to be retransmitted.
+    bool queue_out_of_order_segment(IPv4Packet const&, TCPPacket const&, size_t payload_size, UnixDateTime const& packet_timestamp);
+    bool has_out_of_order_segments() const { return !m_out_of_order_segments.is_empty(); }
+    void deliver_out_of_order_segments();
+
     bool should_delay_next_ack() const;
 
     static MutexProtected<HashMap<IPv4SocketTuple, TCPSocket*>>& sockets_by_tuple();
@@ -157,6 +176,7 @@ public:
     void release_for_accept(NonnullRefPtr<TCPSocket>);
 
     void retransmit_packets();
+    UnixDateTime retransmit_deadline() const;
 
     virtual ErrorOr<void> close() override;
 
@@ -168,10 +188,11 @@ protected:
     void set_direction(Direction direction) { m_direction = direction; }
 
 private:
-    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer);
+    explicit TCPSocket(int protocol, NonnullOwnPtr<DoubleBuffer> receive_buffer, NonnullOwnPtr<KBuffer> scratch_buffer, NonnullOwnPtr<TCPCongestionControl>);
     virtual StringView class_name() const override { return "TCPSocket"sv; }
 
     virtual void shut_down_for_writing() override;
+    virtual void did_consume_receive_buffer() override;
 
     virtual ErrorOr<size_t> protocol_receive(ReadonlyBytes raw_ipv4_packet, UserOrKernelBuffer& buffer, size_t buffer_size, int flags) override;
     virtual ErrorOr<size_t> protocol_send(UserOrKernelBuffer const&, size_t) override;
@@ -185,6 +206,17 @@ private:
     void enqueue_for_retransmit();
     void dequeue_for_retransmit();
 
+    struct OutgoingPacket;
+    struct UnackedPackets;
+    void retransmit_packet(OutgoingPacket&, RoutingDecision const&);
+    void retransmit_lost_packets(UnackedPackets&);
+    void mark_lost_packets(UnackedPackets&);
+    void process_sack_blocks(TCPPacket const&, UnackedPackets&);
+    void update_retransmission_timeout(Duration rtt_sample);
+    u32 available_send_window() const;
+    u16 advertised_window_size(bool is_syn) const;
+    size_t write_sack_option(Bytes) const;
+
     LockWeakPtr<TCPSocket> m_originator;
     HashMap<IPv4SocketTuple, NonnullRefPtr<TCPSocket>> m_pending_release_for_accept;
     Direction m_direction { Direction::Unspecified };
@@ -204,11 +236,41 @@ private:
         size_t ipv4_payload_offset;
         LockWeakPtr<NetworkAdapter> adapter;
         int tx_counter { 0 };
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        UnixDateTime sent_time;
+        bool sacked { false };
+        bool lost { false };
     };
 
     struct UnackedPackets {
         SinglyLinkedList<OutgoingPacket> packets;
         size_t size { 0 };
+        size_t sacked_size { 0 };
+        size_t lost_size { 0 };
+
+        // RFC 6675, 2: The sender's estimate of the number of bytes outstanding in the network.
+        size_t pipe() const { return size - sacked_size - lost_size; }
+
+        void mark_lost(OutgoingPacket& packet)
+        {
+            if (packet.lost || packet.sacked)
+                return;
+            packet.lost = true;
+            lost_size += packet.payload_size;
+        }
+
+        void mark_sacked(OutgoingPacket& packet)
+        {
+            if (packet.sacked)
+                return;
+            if (packet.lost) {
+                packet.lost = false;
+                lost_size -= packet.payload_size;
+            }
+            packet.sacked = true;
+            sacked_size += packet.payload_size;
+        }
     };
 
     MutexProtected<UnackedPackets> m_unacked_packets;
@@ -217,14 +279,52 @@ private:
 
     u32 m_last_ack_number_sent { 0 };
     UnixDateTime m_last_ack_sent_time;
+    u32 m_last_window_size_sent { 0 };
 
     // FIXME: Make this configurable (sysctl)
     static constexpr u32 maximum_retransmits = 5;
-    UnixDateTime m_last_retransmit_time;
+    UnixDateTime m_retransmit_timer_start;
     u32 m_retransmit_attempts { 0 };
-
-    // FIXME: Parse window size TCP option from the peer
+    u32 m_retransmitted_packets { 0 };
+
+    // RFC 6298: Retransmission timer state.
+    static constexpr Duration initial_retransmission_timeout = Duration::from_seconds(1);
+    // NOTE: RFC 6298 asks for a minimum of one second, but like most other stacks we go lower than that.
+    static constexpr Duration minimum_retransmission_timeout = Duration::from_milliseconds(200);
+    static constexpr Duration maximum_retransmission_timeout = Duration::from_seconds(60);
+    Optional<Duration> m_smoothed_rtt;
+    Duration m_rtt_variance;
+    Duration m_retransmission_timeout { initial_retransmission_timeout };
+
+    // RFC 5681, 3.2: Fast retransmit is triggered by the third duplicate ACK.
+    static constexpr u32 duplicate_ack_threshold = 3;
+    u32 m_duplicate_acks_received { 0 };
+
+    // Options negotiated on the SYN segments (RFC 7323 and RFC 2018).
+    static constexpr u16 default_peer_maximum_segment_size = 536;
+    u16 m_peer_maximum_segment_size { default_peer_maximum_segment_size };
+    bool m_window_scaling_enabled { false };
+    u8 m_send_window_scale { 0 };
+    u8 m_receive_window_scale { 0 };
+    bool m_sack_permitted { false };
+
+    // The peer's receive window, as advertised in the newest segment we've seen, and that segment's sequence and
+    // acknowledgment numbers (SND.WL1 and SND.WL2 in RFC 9293).
     u32 m_send_window_size { 64 * KiB };
+    u32 m_send_window_update_sequence_number { 0 };
+    u32 m_send_window_update_ack_number { 0 };
+
+    NonnullOwnPtr<TCPCongestionControl> m_congestion_control;
+
+    struct OutOfOrderSegment {
+        u32 sequence_number { 0 };
+        u32 payload_size { 0 };
+        NonnullOwnPtr<KBuffer> packet;
+        UnixDateTime timestamp;
+    };
+    static constexpr size_t maximum_out_of_order_segments = 128;
+    Vector<OutOfOrderSegment> m_out_of_order_segments;
+    u32 m_last_out_of_order_sequence_number { 0 };
 
     IntrusiveListNode<TCPSocket> m_retransmit_list_node;
 
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <Kernel/Debug.h>
+#include <Kernel/FileSystem/OpenFileDescription.h>
+#include <Kernel/Library/KBuffer.h>
+#include <Kernel/Tasks/Process.h>
+
+namespace Kernel {
+
+// Data is moved through a kernel buffer of this size, so it never has to cross into userspace.
+static constexpr size_t sendfile_chunk_size = 64 * KiB;
+
+// NOTE: The offset is passed by pointer because off_t is 64bit,
+// hence it can't be passed by register on 32bit platforms.
+ErrorOr<FlatPtr> Process::sys$sendfile(int out_fd, int in_fd, Userspace<off_t*> userspace_offset, size_t count)
+{
+    VERIFY_PROCESS_BIG_LOCK_ACQUIRED(this);
+    TRY(require_promise(Pledge::stdio));
+    if (count == 0)
+        return 0;
+    if (count > NumericLimits<ssize_t>::max())
+        return EINVAL;
+
+    auto in_description = TRY(open_file_description(in_fd));
+    if (!in_description->is_readable())
+        return EBADF;
+    if (in_description->is_directory())
+        return EISDIR;
+    // Like on other systems, the source has to be a regular file that we can read at arbitrary offsets.
+    if (!in_description->inode() || !in_description->file().is_seekable())
+        return EINVAL;
+
+    auto out_description = TRY(open_file_description(out_fd));
+    if (!out_description->is_writable())
+        return EBADF;
+
+    Optional<off_t> offset;
+    if (userspace_offset) {
+        offset = TRY(copy_typed_from_user(userspace_offset));
+        if (offset.value() < 0)
+            return EINVAL;
+    }
+
+    dbgln_if(IO_DEBUG, "sys$sendfile({}, {}, {}, {})", out_fd, in_fd, offset.value_or(-1), count);
+
+    auto buffer = TRY(KBuffer::try_create_with_size("sendfile: Transfer buffer"sv, min(count, sendfile_chunk_size)));
+    auto kernel_buffer = UserOrKernelBuffer::for_kernel_buffer(buffer->data());
+
+    size_t total_nsent = 0;
+    ErrorOr<void> result {};
+    while (total_nsent < count) {
+        size_t chunk_size = min(count - total_nsent, buffer->size());
+        auto nread_or_error = offset.has_value()
+            ? in_description->read(kernel_buffer, offset.value() + total_nsent, chunk_size)
+            : in_description->read(kernel_buffer, chunk_size);
+        if (nread_or_error.is_error()) {
+            result = nread_or_error.release_error();
+            break;
+        }
+        auto nread = nread_or_error.release_value();
+        if (nread == 0)
+            break;
+
+        auto nwritten_or_error = do_write(*out_description, kernel_buffer, nread);
+        size_t nwritten = nwritten_or_error.is_error() ? 0 : nwritten_or_error.value();
+        if (!offset.has_value() && nwritten < nread) {
+            // Give back whatever we read from the file but couldn't send.
+            (void)in_description->seek(-static_cast<off_t>(nread - nwritten), SEEK_CUR);
+        }
+        total_nsent += nwritten;
+        if (nwritten_or_error.is_error()) {
+            result = nwritten_or_error.release_error();
+            break;
+        }
+        if (nwritten < nread)
+            break;
+    }
+
+    if (offset.has_value()) {
+        off_t new_offset = offset.value() + total_nsent;
+        TRY(copy_to_user(userspace_offset, &new_offset));
+    }
+
+    if (total_nsent == 0 && result.is_error())
+        return result.release_error();
+    return total_nsent;
+}
+
+}
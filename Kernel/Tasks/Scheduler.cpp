@@ -46,7 +46,24 @@ struct ThreadReadyQueues {
     Array<ThreadReadyQueue, count> queues;
 };
 
-static Singleton<SpinlockProtected<ThreadReadyQueues, LockRank::None>> g_ready_queues;
+// Every processor owns a set of ready queues, so that picking the next thread
+// usually only looks at the local processor's threads, and threads tend to stay
+// on the processor whose caches they warmed up. Processors that run out of work
+// steal runnable threads from their peers.
+// NOTE: The ready queues are protected by g_scheduler_lock.
+struct ProcessorReadyQueues {
+    ThreadReadyQueues ready_queues;
+    Atomic<u32> thread_count { 0 };
+
+    Atomic<u64> enqueued { 0 };
+    Atomic<u64> picked_local { 0 };
+    Atomic<u64> picked_stolen { 0 };
+    Atomic<u64> picked_idle { 0 };
+    Atomic<u64> scheduler_lock_contended { 0 };
+    Atomic<u64> scheduler_lock_contended_cycles { 0 };
+};
+
+static Singleton<Array<ProcessorReadyQueues, MAX_CPU_COUNT>> g_ready_queues;
 
 static SpinlockProtected<TotalTimeScheduled, LockRank::None> g_total_time_scheduled {};
 
@@ -64,99 +81,180 @@ static inline u32 thread_priority_to_priority_index(u32 thread_priority)
     return priority_bucket;
 }
 
-Thread& Scheduler::pull_next_runnable_thread()
+// The affinity mask only has room for the first 32 processors. Threads that may run anywhere
+// may also run on the ones after that, threads pinned to some processors may not.
+static inline bool thread_may_run_on(Thread const& thread, u32 processor_id)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread& {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
-                thread.m_runnable_priority = -1;
-                ready_queue.thread_list.remove(thread);
-                if (ready_queue.thread_list.is_empty())
-                    ready_queues.mask &= ~(1u << priority);
-                // Mark it as active because we are using this thread. This is similar
-                // to comparing it with Processor::current_thread, but when there are
-                // multiple processors there's no easy way to check whether the thread
-                // is actually still needed. This prevents accidental finalization when
-                // a thread is no longer in Running state, but running on another core.
-
-                // We need to mark it active here so that this thread won't be
-                // scheduled on another core if it were to be queued before actually
-                // switching to it.
-                // FIXME: Figure out a better way maybe?
-                thread.set_active(true);
-                return thread;
-            }
-            priority_mask &= ~(1u << priority);
-        }
-
-        auto* idle_thread = Processor::idle_thread();
-        idle_thread->set_active(true);
-        return *idle_thread;
-    });
+    if (processor_id >= sizeof(u32) * 8)
+        return thread.affinity() == THREAD_AFFINITY_DEFAULT;
+    return thread.affinity() & (1u << processor_id);
 }
 
-Thread* Scheduler::peek_next_runnable_thread()
+Thread* Scheduler::find_runnable_thread(ProcessorReadyQueues& processor_queues, u32 processor_id, RemoveFromQueue remove)
 {
-    auto affinity_mask = 1u << Processor::current_id();
-
-    return g_ready_queues->with([&](auto& ready_queues) -> Thread* {
-        auto priority_mask = ready_queues.mask;
-        while (priority_mask != 0) {
-            auto priority = bit_scan_forward(priority_mask);
-            VERIFY(priority > 0);
-            auto& ready_queue = ready_queues.queues[--priority];
-            for (auto& thread : ready_queue.thread_list) {
-                VERIFY(thread.m_runnable_priority == (int)priority);
-                if (thread.is_active())
-                    continue;
-                if (!(thread.affinity() & affinity_mask))
-                    continue;
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
+    if (processor_queues.thread_count.load(AK::MemoryOrder::memory_order_relaxed) == 0)
+        return nullptr;
+
+    auto& ready_queues = processor_queues.ready_queues;
+    auto priority_mask = ready_queues.mask;
+    while (priority_mask != 0) {
+        auto priority = bit_scan_forward(priority_mask);
+        VERIFY(priority > 0);
+        auto& ready_queue = ready_queues.queues[--priority];
+        for (auto& thread : ready_queue.thread_list) {
+            VERIFY(thread.m_runnable_priority == (int)priority);
+            if (thread.is_active())
+                continue;
+            if (!thread_may_run_on(thread, processor_id))
+                continue;
+            if (remove == RemoveFromQueue::No)
                 return &thread;
-            }
-            priority_mask &= ~(1u << priority);
+            thread.m_runnable_priority = -1;
+            thread.m_ready_queue_processor = -1;
+            ready_queue.thread_list.remove(thread);
+            processor_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+            if (ready_queue.thread_list.is_empty())
+                ready_queues.mask &= ~(1u << priority);
+            // Mark it as active because we are using this thread. This is similar
+            // to comparing it with Processor::current_thread, but when there are
+            // multiple processors there's no easy way to check whether the thread
+            // is actually still needed. This prevents accidental finalization when
+            // a thread is no longer in Running state, but running on another core.
+
+            // We need to mark it active here so that this thread won't be
+            // scheduled on another core if it were to be queued before actually
+            // switching to it.
+            // FIXME: Figure out a better way maybe?
+            thread.set_active(true);
+            return &thread;
         }
+        priority_mask &= ~(1u << priority);
+    }
+    return nullptr;
+}
 
-        // Unlike in pull_next_runnable_thread() we don't want to fall back to
-        // the idle thread. We just want to see if we have any other thread ready
-        // to be scheduled.
+Thread* Scheduler::find_stealable_thread(u32 processor_id, RemoveFromQueue remove)
+{
+    auto processor_count = Processor::count();
+
+    // Start with the processor that has the most work queued up, and fall back
+    // to visiting the others in order in case none of its threads can run here.
+    u32 busiest_processor = processor_id;
+    u32 busiest_thread_count = 0;
+    for (u32 i = 0; i < processor_count; ++i) {
+        if (i == processor_id)
+            continue;
+        auto thread_count = g_ready_queues->at(i).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (thread_count > busiest_thread_count) {
+            busiest_processor = i;
+            busiest_thread_count = thread_count;
+        }
+    }
+    if (busiest_thread_count == 0)
         return nullptr;
-    });
+
+    if (auto* thread = find_runnable_thread(g_ready_queues->at(busiest_processor), processor_id, remove))
+        return thread;
+
+    for (u32 offset = 1; offset < processor_count; ++offset) {
+        auto victim = (processor_id + offset) % processor_count;
+        if (victim == busiest_processor)
+            continue;
+        if (auto* thread = find_runnable_thread(g_ready_queues->at(victim), processor_id, remove))
+            return thread;
+    }
+    return nullptr;
+}
+
+static u32 ready_queue_processor_for(Thread const& thread)
+{
+    auto processor_count = Processor::count();
+
+    // Keep the thread on the processor it last ran on so its caches stay warm,
+    // unless its affinity no longer allows it to run there.
+    auto last_processor = thread.cpu();
+    if (last_processor < processor_count && thread_may_run_on(thread, last_processor))
+        return last_processor;
+
+    // Otherwise place it on the least loaded processor it is allowed to run on.
+    Optional<u32> best_processor;
+    u32 best_thread_count = NumericLimits<u32>::max();
+    for (u32 i = 0; i < processor_count; ++i) {
+        if (!thread_may_run_on(thread, i))
+            continue;
+        auto thread_count = g_ready_queues->at(i).thread_count.load(AK::MemoryOrder::memory_order_relaxed);
+        if (thread_count < best_thread_count) {
+            best_processor = i;
+            best_thread_count = thread_count;
+        }
+    }
+    return best_processor.value_or(Processor::current_id());
+}
+
+Thread& Scheduler::pull_next_runnable_thread()
+{
+    auto processor_id = Processor::current_id();
+    auto& processor_queues = g_ready_queues->at(processor_id);
+
+    if (auto* thread = find_runnable_thread(processor_queues, processor_id, RemoveFromQueue::Yes)) {
+        processor_queues.picked_local.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return *thread;
+    }
+
+    if (auto* thread = find_stealable_thread(processor_id, RemoveFromQueue::Yes)) {
+        processor_queues.picked_stolen.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        return *thread;
+    }
+
+    processor_queues.picked_idle.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    auto* idle_thread = Processor::idle_thread();
+    idle_thread->set_active(true);
+    return *idle_thread;
+}
+
+Thread* Scheduler::peek_next_runnable_thread()
+{
+    auto processor_id = Processor::current_id();
+
+    // Unlike in pull_next_runnable_thread() we don't want to fall back to
+    // the idle thread. We just want to see if we have any other thread ready
+    // to be scheduled.
+    SpinlockLocker lock(g_scheduler_lock);
+    if (auto* thread = find_runnable_thread(g_ready_queues->at(processor_id), processor_id, RemoveFromQueue::No))
+        return thread;
+    return find_stealable_thread(processor_id, RemoveFromQueue::No);
 }
 
 bool Scheduler::dequeue_runnable_thread(Thread& thread, bool check_affinity)
 {
+    VERIFY(g_scheduler_lock.is_locked_by_current_processor());
     if (thread.is_idle_thread())
         return true;
 
-    return g_ready_queues->with([&](auto& ready_queues) {
-        auto priority = thread.m_runnable_priority;
-        if (priority < 0) {
-            VERIFY(!thread.m_ready_queue_node.is_in_list());
-            return false;
-        }
-
-        if (check_affinity && !(thread.affinity() & (1 << Processor::current_id())))
-            return false;
+    auto processor_id = thread.m_ready_queue_processor;
+    if (processor_id < 0) {
+        VERIFY(thread.m_runnable_priority < 0);
+        VERIFY(!thread.m_ready_queue_node.is_in_list());
+        return false;
+    }
 
-        VERIFY(ready_queues.mask & (1u << priority));
-        auto& ready_queue = ready_queues.queues[priority];
-        thread.m_runnable_priority = -1;
-        ready_queue.thread_list.remove(thread);
-        if (ready_queue.thread_list.is_empty())
-            ready_queues.mask &= ~(1u << priority);
-        return true;
-    });
+    if (check_affinity && !thread_may_run_on(thread, Processor::current_id()))
+        return false;
+
+    auto& processor_queues = g_ready_queues->at(processor_id);
+    auto& ready_queues = processor_queues.ready_queues;
+    auto priority = thread.m_runnable_priority;
+    VERIFY(priority >= 0);
+    VERIFY(ready_queues.mask & (1u << priority));
+    auto& ready_queue = ready_queues.queues[priority];
+    thread.m_runnable_priority = -1;
+    thread.m_ready_queue_processor = -1;
+    ready_queue.thread_list.remove(thread);
+    processor_queues.thread_count.fetch_sub(1, AK::MemoryOrder::memory_order_relaxed);
+    if (ready_queue.thread_list.is_empty())
+        ready_queues.mask &= ~(1u << priority);
+    return true;
 }
 
 void Scheduler::enqueue_runnable_thread(Thread& thread)
@@ -165,17 +263,22 @@ void Scheduler::enqueue_runnable_thread(Thread& thread)
     if (thread.is_idle_thread())
         return;
     auto priority = thread_priority_to_priority_index(thread.priority());
-
-    g_ready_queues->with([&](auto& ready_queues) {
-        VERIFY(thread.m_runnable_priority < 0);
-        thread.m_runnable_priority = (int)priority;
-        VERIFY(!thread.m_ready_queue_node.is_in_list());
-        auto& ready_queue = ready_queues.queues[priority];
-        bool was_empty = ready_queue.thread_list.is_empty();
-        ready_queue.thread_list.append(thread);
-        if (was_empty)
-            ready_queues.mask |= (1u << priority);
-    });
+    auto processor_id = ready_queue_processor_for(thread);
+
+    auto& processor_queues = g_ready_queues->at(processor_id);
+    auto& ready_queues = processor_queues.ready_queues;
+    VERIFY(thread.m_runnable_priority < 0);
+    VERIFY(thread.m_ready_queue_processor < 0);
+    thread.m_runnable_priority = (int)priority;
+    thread.m_ready_queue_processor = (int)processor_id;
+    VERIFY(!thread.m_ready_queue_node.is_in_list());
+    auto& ready_queue = ready_queues.queues[priority];
+    bool was_empty = ready_queue.thread_list.is_empty();
+    ready_queue.thread_list.append(thread);
+    processor_queues.thread_count.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    processor_queues.enqueued.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+    if (was_empty)
+        ready_queues.mask |= (1u << priority);
 }
 
 UNMAP_AFTER_INIT void Scheduler::start()
@@ -217,7 +320,14 @@ void Scheduler::pick_next()
             Processor::set_current_in_scheduler(false);
         });
 
+    bool scheduler_lock_contended = g_scheduler_lock.is_locked() && !g_scheduler_lock.is_locked_by_current_processor();
+    auto lock_start = scheduler_lock_contended ? Processor::read_cpu_counter() : 0;
     SpinlockLocker lock(g_scheduler_lock);
+    if (scheduler_lock_contended) {
+        auto& processor_queues = g_ready_queues->at(Processor::current_id());
+        processor_queues.scheduler_lock_contended.fetch_add(1, AK::MemoryOrder::memory_order_relaxed);
+        processor_queues.scheduler_lock_contended_cycles.fetch_add(Processor::read_cpu_counter() - lock_start, AK::MemoryOrder::memory_order_relaxed);
+    }
 
     if constexpr (SCHEDULER_RUNNABLE_DEBUG) {
         dump_thread_list();
@@ -503,6 +613,22 @@ TotalTimeScheduled Scheduler::get_total_time_scheduled()
     return g_total_time_scheduled.with([&](auto& total_time_scheduled) { return total_time_scheduled; });
 }
 
+SchedulerStatistics Scheduler::get_statistics(u32 processor_id)
+{
+    if (processor_id >= Processor::count())
+        return {};
+    auto& processor_queues = g_ready_queues->at(processor_id);
+    return {
+        .ready_threads = processor_queues.thread_count.load(AK::MemoryOrder::memory_order_relaxed),
+        .enqueued = processor_queues.enqueued.load(AK::MemoryOrder::memory_order_relaxed),
+        .picked_local = processor_queues.picked_local.load(AK::MemoryOrder::memory_order_relaxed),
+        .picked_stolen = processor_queues.picked_stolen.load(AK::MemoryOrder::memory_order_relaxed),
+        .picked_idle = processor_queues.picked_idle.load(AK::MemoryOrder::memory_order_relaxed),
+        .scheduler_lock_contended = processor_queues.scheduler_lock_contended.load(AK::MemoryOrder::memory_order_relaxed),
+        .scheduler_lock_contended_cycles = processor_queues.scheduler_lock_contended_cycles.load(AK::MemoryOrder::memory_order_relaxed),
+    };
+}
+
 void dump_thread_list(bool with_stack_traces)
 {
     dbgln("Scheduler thread list for processor {}:", Processor::current_id());
@@ -18,6 +18,7 @@
 namespace Kernel {
 
 struct RegisterState;
+struct ProcessorReadyQueues;
 
 extern Thread* g_finalizer;
 extern WaitQueue* g_finalizer_wait_queue;
@@ -29,6 +30,16 @@ struct TotalTimeScheduled {
     u64 total_kernel { 0 };
 };
 
+struct SchedulerStatistics {
+    u32 ready_threads { 0 };
+    u64 enqueued { 0 };
+    u64 picked_local { 0 };
+    u64 picked_stolen { 0 };
+    u64 picked_idle { 0 };
+    u64 scheduler_lock_contended { 0 };
+    u64 scheduler_lock_contended_cycles { 0 };
+};
+
 class Scheduler {
 public:
     static void initialize();
@@ -55,6 +66,16 @@ public:
     static bool is_initialized();
     static TotalTimeScheduled get_total_time_scheduled();
     static void add_time_scheduled(u64, bool);
+    static SchedulerStatistics get_statistics(u32 processor_id);
+
+private:
+    enum class RemoveFromQueue {
+        No,
+        Yes,
+    };
+
+    static Thread* find_runnable_thread(ProcessorReadyQueues&, u32 processor_id, RemoveFromQueue);
+    static Thread* find_stealable_thread(u32 processor_id, RemoveFromQueue);
 };
 
 }
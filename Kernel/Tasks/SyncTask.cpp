@@ -4,23 +4,43 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Atomic.h>
 #include <Kernel/FileSystem/VirtualFileSystem.h>
 #include <Kernel/Sections.h>
 #include <Kernel/Tasks/Process.h>
 #include <Kernel/Tasks/SyncTask.h>
+#include <Kernel/Tasks/WaitQueue.h>
 #include <Kernel/Time/TimeManagement.h>
 
 namespace Kernel {
 
+static constexpr StringView sync_task_name = "VFS Sync Task"sv;
+
+READONLY_AFTER_INIT static WaitQueue* s_sync_task_wait_queue;
+static Atomic<bool> s_sync_task_has_memory_pressure { false };
+
 UNMAP_AFTER_INIT void SyncTask::spawn()
 {
-    MUST(Process::create_kernel_process(KString::must_create("VFS Sync Task"sv), [] {
+    s_sync_task_wait_queue = new WaitQueue;
+    MUST(Process::create_kernel_process(KString::must_create(sync_task_name), [] {
         dbgln("VFS SyncTask is running");
         for (;;) {
             VirtualFileSystem::sync();
-            (void)Thread::current()->sleep(Duration::from_seconds(1));
+            if (s_sync_task_has_memory_pressure.exchange(false, AK::MemoryOrder::memory_order_acq_rel))
+                VirtualFileSystem::the().release_filesystem_caches();
+            auto timeout = Duration::from_seconds(1);
+            (void)s_sync_task_wait_queue->wait_on(Thread::BlockTimeout(false, &timeout), sync_task_name);
         }
     }));
 }
 
+void SyncTask::notify_memory_pressure()
+{
+    // The memory manager may run out of memory before we're up, there's nothing to release yet anyway.
+    if (!s_sync_task_wait_queue)
+        return;
+    if (!s_sync_task_has_memory_pressure.exchange(true, AK::MemoryOrder::memory_order_acq_rel))
+        s_sync_task_wait_queue->wake_all();
+}
+
 }
@@ -10,5 +10,8 @@ namespace Kernel {
 class SyncTask {
 public:
     static void spawn();
+
+    // Wakes the sync task up to flush file systems and release their caches.
+    static void notify_memory_pressure();
 };
 }
@@ -1089,6 +1089,7 @@ private:
 
     IntrusiveListNode<Thread> m_process_thread_list_node;
     int m_runnable_priority { -1 };
+    int m_ready_queue_processor { -1 };
 
     friend class WaitQueue;
 
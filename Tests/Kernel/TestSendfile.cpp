@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Time.h>
+#include <LibCore/System.h>
+#include <LibTest/TestCase.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static u8 byte_at(size_t offset)
+{
+    return static_cast<u8>(offset * 31 + (offset >> 8));
+}
+
+static int create_file_with_pattern(size_t size)
+{
+    char pattern[] = "/tmp/sendfile.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, sizeof(pattern) - 1 }));
+
+    auto data = MUST(ByteBuffer::create_uninitialized(64 * KiB));
+    size_t written = 0;
+    while (written < size) {
+        size_t chunk_size = min(data.size(), size - written);
+        for (size_t i = 0; i < chunk_size; ++i)
+            data[i] = byte_at(written + i);
+        MUST(Core::System::write(fd, data.span().trim(chunk_size)));
+        written += chunk_size;
+    }
+    MUST(Core::System::lseek(fd, 0, SEEK_SET));
+    return fd;
+}
+
+static int create_empty_file()
+{
+    char pattern[] = "/tmp/sendfile-out.XXXXXX";
+    auto fd = MUST(Core::System::mkstemp(pattern));
+    MUST(Core::System::unlink({ pattern, sizeof(pattern) - 1 }));
+    return fd;
+}
+
+static bool file_contains_pattern(int fd, size_t pattern_offset, size_t size)
+{
+    auto data = MUST(ByteBuffer::create_uninitialized(size));
+    if (pread(fd, data.data(), size, 0) != static_cast<ssize_t>(size))
+        return false;
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != byte_at(pattern_offset + i))
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE(sendfile_with_offset)
+{
+    auto in_fd = create_file_with_pattern(256 * KiB);
+    auto out_fd = create_empty_file();
+
+    off_t offset = 1000;
+    EXPECT_EQ(sendfile(out_fd, in_fd, &offset, 150 * KiB), static_cast<ssize_t>(150 * KiB));
+    EXPECT_EQ(offset, static_cast<off_t>(1000 + 150 * KiB));
+
+    // The file position of the input must not change when an offset is given.
+    EXPECT_EQ(lseek(in_fd, 0, SEEK_CUR), 0);
+    EXPECT(file_contains_pattern(out_fd, 1000, 150 * KiB));
+
+    close(in_fd);
+    close(out_fd);
+}
+
+TEST_CASE(sendfile_without_offset)
+{
+    auto in_fd = create_file_with_pattern(100 * KiB);
+    auto out_fd = create_empty_file();
+
+    EXPECT_EQ(lseek(in_fd, 500, SEEK_SET), 500);
+    EXPECT_EQ(sendfile(out_fd, in_fd, nullptr, 20 * KiB), static_cast<ssize_t>(20 * KiB));
+    EXPECT_EQ(lseek(in_fd, 0, SEEK_CUR), static_cast<off_t>(500 + 20 * KiB));
+    EXPECT(file_contains_pattern(out_fd, 500, 20 * KiB));
+
+    // Asking for more than what is left stops at the end of the file.
+    EXPECT_EQ(sendfile(out_fd, in_fd, nullptr, 1 * MiB), static_cast<ssize_t>(100 * KiB - 500 - 20 * KiB));
+    EXPECT_EQ(sendfile(out_fd, in_fd, nullptr, 1 * MiB), 0);
+    EXPECT(file_contains_pattern(out_fd, 500, 100 * KiB - 500));
+
+    close(in_fd);
+    close(out_fd);
+}
+
+TEST_CASE(sendfile_errors)
+{
+    auto in_fd = create_file_with_pattern(4 * KiB);
+    auto out_fd = create_empty_file();
+
+    int pipe_fds[2];
+    EXPECT_EQ(pipe(pipe_fds), 0);
+
+    // The input has to be seekable.
+    EXPECT_EQ(sendfile(out_fd, pipe_fds[0], nullptr, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    off_t offset = -1;
+    EXPECT_EQ(sendfile(out_fd, in_fd, &offset, 1), -1);
+    EXPECT_EQ(errno, EINVAL);
+
+    EXPECT_EQ(sendfile(-1, in_fd, nullptr, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    // The input has to be readable.
+    EXPECT_EQ(sendfile(out_fd, pipe_fds[1], nullptr, 1), -1);
+    EXPECT_EQ(errno, EBADF);
+
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(in_fd);
+    close(out_fd);
+}
+
+static void* drain_connection(void* argument)
+{
+    int listen_fd = *static_cast<int*>(argument);
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0)
+        return nullptr;
+    u8 buffer[64 * KiB];
+    while (read(fd, buffer, sizeof(buffer)) > 0)
+        ;
+    close(fd);
+    return nullptr;
+}
+
+enum class TransferMethod {
+    ReadWrite,
+    Sendfile,
+};
+
+// Pushes the whole file through a loopback TCP connection and returns the elapsed time.
+static Duration transfer_file_over_loopback(int in_fd, size_t size, TransferMethod method)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    VERIFY(listen_fd >= 0);
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    VERIFY(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    VERIFY(listen(listen_fd, 1) == 0);
+    socklen_t address_length = sizeof(address);
+    VERIFY(getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_length) == 0);
+
+    pthread_t receiver_thread;
+    VERIFY(pthread_create(&receiver_thread, nullptr, drain_connection, &listen_fd) == 0);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    VERIFY(fd >= 0);
+    VERIFY(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+
+    timespec start {};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t sent_size = 0;
+    if (method == TransferMethod::Sendfile) {
+        off_t offset = 0;
+        while (sent_size < size) {
+            auto nsent = sendfile(fd, in_fd, &offset, size - sent_size);
+            if (nsent <= 0)
+                break;
+            sent_size += nsent;
+        }
+    } else {
+        u8 buffer[64 * KiB];
+        while (sent_size < size) {
+            auto nread = pread(in_fd, buffer, sizeof(buffer), sent_size);
+            if (nread <= 0)
+                break;
+            ssize_t written = 0;
+            while (written < nread) {
+                auto nwritten = write(fd, buffer + written, nread - written);
+                if (nwritten <= 0)
+                    break;
+                written += nwritten;
+            }
+            if (written != nread)
+                break;
+            sent_size += nread;
+        }
+    }
+    close(fd);
+    pthread_join(receiver_thread, nullptr);
+
+    timespec end {};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    close(listen_fd);
+    EXPECT_EQ(sent_size, size);
+    return Duration::from_timespec(end) - Duration::from_timespec(start);
+}
+
+BENCHMARK_CASE(sendfile_versus_read_write_over_loopback)
+{
+    static constexpr size_t file_size = 64 * MiB;
+    auto in_fd = create_file_with_pattern(file_size);
+
+    for (auto method : { TransferMethod::ReadWrite, TransferMethod::Sendfile }) {
+        auto elapsed_ms = max<i64>(transfer_file_over_loopback(in_fd, file_size, method).to_milliseconds(), 1);
+        outln("{}: {} KiB in {} ms ({} KiB/s)", method == TransferMethod::Sendfile ? "sendfile"sv : "read/write"sv, file_size / KiB, elapsed_ms, file_size / KiB * 1000 / elapsed_ms);
+    }
+
+    close(in_fd);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/ByteBuffer.h>
+#include <AK/Time.h>
+#include <LibTest/TestCase.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static constexpr char const* loopback_impairment_path = "/sys/kernel/conf/loopback_impairment";
+
+static bool set_loopback_impairment(char const* value)
+{
+    int fd = open(loopback_impairment_path, O_WRONLY);
+    if (fd < 0)
+        return false;
+    auto rc = write(fd, value, strlen(value));
+    close(fd);
+    return rc == static_cast<ssize_t>(strlen(value));
+}
+
+struct Receiver {
+    int listen_fd { -1 };
+    size_t expected_size { 0 };
+    u8 checksum { 0 };
+    size_t received_size { 0 };
+};
+
+static void* receive_everything(void* argument)
+{
+    auto& receiver = *static_cast<Receiver*>(argument);
+    int fd = accept(receiver.listen_fd, nullptr, nullptr);
+    if (fd < 0)
+        return nullptr;
+    u8 buffer[16 * KiB];
+    while (receiver.received_size < receiver.expected_size) {
+        auto nread = read(fd, buffer, sizeof(buffer));
+        if (nread <= 0)
+            break;
+        for (ssize_t i = 0; i < nread; ++i)
+            receiver.checksum ^= buffer[i] + (receiver.received_size + i);
+        receiver.received_size += nread;
+    }
+    close(fd);
+    return nullptr;
+}
+
+// Sends `size` bytes to ourselves over 127.0.0.1 and returns the elapsed time, or an empty Optional on failure.
+static Optional<Duration> transfer_over_loopback(size_t size)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT(listen_fd >= 0);
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    EXPECT_EQ(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    EXPECT_EQ(listen(listen_fd, 1), 0);
+    socklen_t address_length = sizeof(address);
+    EXPECT_EQ(getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_length), 0);
+
+    Receiver receiver { listen_fd, size };
+    pthread_t receiver_thread;
+    EXPECT_EQ(pthread_create(&receiver_thread, nullptr, receive_everything, &receiver), 0);
+
+    timespec start {};
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT(fd >= 0);
+    EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+    auto data = MUST(ByteBuffer::create_uninitialized(64 * KiB));
+    u8 expected_checksum = 0;
+    size_t sent_size = 0;
+    while (sent_size < size) {
+        size_t chunk_size = min(data.size(), size - sent_size);
+        for (size_t i = 0; i < chunk_size; ++i) {
+            data[i] = static_cast<u8>((sent_size + i) * 31);
+            expected_checksum ^= data[i] + (sent_size + i);
+        }
+        size_t written = 0;
+        while (written < chunk_size) {
+            auto nwritten = write(fd, data.data() + written, chunk_size - written);
+            if (nwritten <= 0)
+                break;
+            written += nwritten;
+        }
+        if (written != chunk_size)
+            break;
+        sent_size += chunk_size;
+    }
+
+    pthread_join(receiver_thread, nullptr);
+    close(fd);
+    close(listen_fd);
+
+    timespec end {};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    EXPECT_EQ(sent_size, size);
+    EXPECT_EQ(receiver.received_size, size);
+    EXPECT_EQ(receiver.checksum, expected_checksum);
+    if (receiver.received_size != size || receiver.checksum != expected_checksum)
+        return {};
+    return Duration::from_timespec(end) - Duration::from_timespec(start);
+}
+
+TEST_CASE(tcp_loopback_transfer)
+{
+    EXPECT(transfer_over_loopback(4 * MiB).has_value());
+}
+
+TEST_CASE(tcp_loopback_transfer_with_loss)
+{
+    if (!set_loopback_impairment("delay_ms=0 loss_permille=20")) {
+        warnln("Skipping, can't write to {} (needs root)", loopback_impairment_path);
+        return;
+    }
+    auto elapsed = transfer_over_loopback(1 * MiB);
+    set_loopback_impairment("delay_ms=0 loss_permille=0");
+    EXPECT(elapsed.has_value());
+}
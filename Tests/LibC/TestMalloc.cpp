@@ -6,9 +6,14 @@
 
 #include <LibTest/TestCase.h>
 
+#include <AK/Array.h>
+#include <AK/Time.h>
 #include <errno.h>
 #include <mallocdefs.h>
+#include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 TEST_CASE(malloc_limits)
 {
@@ -38,3 +43,79 @@ TEST_CASE(malloc_limits)
         return Test::Crash::Failure::DidNotCrash;
     });
 }
+
+static constexpr size_t pointers_per_thread = 4096;
+
+static void* allocate_pointers(void* argument)
+{
+    auto& pointers = *static_cast<Array<void*, pointers_per_thread>*>(argument);
+    for (size_t i = 0; i < pointers.size(); ++i) {
+        pointers[i] = malloc(size_classes[i % num_size_classes]);
+        memset(pointers[i], 0xaa, size_classes[i % num_size_classes]);
+    }
+    return nullptr;
+}
+
+static void* free_pointers(void* argument)
+{
+    auto& pointers = *static_cast<Array<void*, pointers_per_thread>*>(argument);
+    for (auto* pointer : pointers)
+        free(pointer);
+    return nullptr;
+}
+
+TEST_CASE(malloc_cross_thread_free)
+{
+    Array<void*, pointers_per_thread> pointers {};
+
+    for (size_t round = 0; round < 4; ++round) {
+        pthread_t allocating_thread;
+        EXPECT_EQ(pthread_create(&allocating_thread, nullptr, allocate_pointers, &pointers), 0);
+        EXPECT_EQ(pthread_join(allocating_thread, nullptr), 0);
+
+        pthread_t freeing_thread;
+        EXPECT_EQ(pthread_create(&freeing_thread, nullptr, free_pointers, &pointers), 0);
+        EXPECT_EQ(pthread_join(freeing_thread, nullptr), 0);
+    }
+
+    // Chunks freed by other threads must be reusable from this one.
+    allocate_pointers(&pointers);
+    for (size_t i = 0; i < pointers.size(); ++i)
+        EXPECT_EQ(malloc_size(pointers[i]), static_cast<size_t>(size_classes[i % num_size_classes]));
+    free_pointers(&pointers);
+}
+
+static constexpr size_t malloc_free_pairs_per_thread = 1'000'000;
+
+static void* malloc_free_loop(void*)
+{
+    Array<void*, 16> live_pointers {};
+    for (size_t i = 0; i < malloc_free_pairs_per_thread; ++i) {
+        auto& slot = live_pointers[i % live_pointers.size()];
+        free(slot);
+        slot = malloc(size_classes[i % 6]);
+    }
+    for (auto* pointer : live_pointers)
+        free(pointer);
+    return nullptr;
+}
+
+BENCHMARK_CASE(malloc_free_throughput)
+{
+    for (size_t thread_count = 1; thread_count <= 16; thread_count *= 2) {
+        Array<pthread_t, 16> threads {};
+
+        timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < thread_count; ++i)
+            EXPECT_EQ(pthread_create(&threads[i], nullptr, malloc_free_loop, nullptr), 0);
+        for (size_t i = 0; i < thread_count; ++i)
+            EXPECT_EQ(pthread_join(threads[i], nullptr), 0);
+        timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        auto elapsed_microseconds = max<i64>(1, (Duration::from_timespec(end) - Duration::from_timespec(start)).to_microseconds());
+        auto pairs_per_second = thread_count * malloc_free_pairs_per_thread * 1'000'000 / elapsed_microseconds;
+        outln("{:2} threads: {} malloc/free pairs per second", thread_count, pairs_per_second);
+    }
+}
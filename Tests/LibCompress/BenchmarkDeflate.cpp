@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "Corpus.h"
+#include <AK/Random.h>
+#include <LibCompress/Deflate.h>
+#include <LibTest/TestCase.h>
+
+// Every case works on this many bytes, so the reported times translate directly into throughput.
+static constexpr size_t corpus_size = 4 * MiB;
+
+static auto const text = make_corpus(corpus_size);
+
+static ByteBuffer make_random_data()
+{
+    auto data = ByteBuffer::create_uninitialized(corpus_size).release_value();
+    fill_with_random(data);
+    return data;
+}
+
+static auto const random_data = make_random_data();
+
+static auto const text_compressed_fast = Compress::DeflateCompressor::compress_all(text, Compress::DeflateCompressor::CompressionLevel::FAST).release_value();
+static auto const text_compressed_good = Compress::DeflateCompressor::compress_all(text, Compress::DeflateCompressor::CompressionLevel::GOOD).release_value();
+static auto const random_data_compressed = Compress::DeflateCompressor::compress_all(random_data, Compress::DeflateCompressor::CompressionLevel::FAST).release_value();
+
+static void compress(Compress::DeflateCompressor::CompressionLevel level, size_t thread_count)
+{
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all_in_parallel(text, level, thread_count));
+    EXPECT(compressed.size() < corpus_size);
+}
+
+static void decompress(ByteBuffer const& compressed)
+{
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT_EQ(uncompressed.size(), corpus_size);
+}
+
+BENCHMARK_CASE(compress_fast)
+{
+    compress(Compress::DeflateCompressor::CompressionLevel::FAST, 1);
+}
+
+BENCHMARK_CASE(compress_good)
+{
+    compress(Compress::DeflateCompressor::CompressionLevel::GOOD, 1);
+}
+
+BENCHMARK_CASE(compress_great)
+{
+    compress(Compress::DeflateCompressor::CompressionLevel::GREAT, 1);
+}
+
+BENCHMARK_CASE(compress_good_4_threads)
+{
+    compress(Compress::DeflateCompressor::CompressionLevel::GOOD, 4);
+}
+
+BENCHMARK_CASE(compress_great_4_threads)
+{
+    compress(Compress::DeflateCompressor::CompressionLevel::GREAT, 4);
+}
+
+BENCHMARK_CASE(decompress_text_fast)
+{
+    decompress(text_compressed_fast);
+}
+
+BENCHMARK_CASE(decompress_text_good)
+{
+    decompress(text_compressed_good);
+}
+
+BENCHMARK_CASE(decompress_random)
+{
+    decompress(random_data_compressed);
+}
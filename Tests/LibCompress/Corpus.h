@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/ByteBuffer.h>
+#include <AK/StringView.h>
+
+// Deterministic text-like data, so that compression ratios are comparable between runs.
+inline ByteBuffer make_corpus(size_t size)
+{
+    static constexpr StringView words[] = {
+        "the "sv, "quick "sv, "brown "sv, "fox "sv, "jumps "sv, "over "sv, "lazy "sv, "dog "sv, "deflate "sv, "stream "sv,
+        "block "sv, "window "sv, "huffman "sv, "symbol "sv, "length "sv, "distance "sv, "literal "sv, "serenity "sv, "\n"sv, ", "sv
+    };
+    auto corpus = ByteBuffer::create_uninitialized(size).release_value();
+    u32 state = 0x12345678;
+    size_t offset = 0;
+    while (offset < size) {
+        state = state * 1103515245 + 12345;
+        auto word = words[(state >> 16) % array_size(words)];
+        if ((state >> 8) % 97 == 0) {
+            // Sprinkle in some bytes that don't compress well.
+            corpus[offset++] = static_cast<u8>(state >> 24);
+            continue;
+        }
+        offset += word.bytes().copy_trimmed_to(corpus.bytes().slice(offset));
+    }
+    return corpus;
+}
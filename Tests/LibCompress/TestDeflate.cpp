@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include "Corpus.h"
 #include <LibTest/TestCase.h>
 
 #include <AK/Array.h>
@@ -112,6 +113,21 @@ TEST_CASE(deflate_decompress_zeroes)
     EXPECT(uncompressed == decompressed.value().bytes());
 }
 
+TEST_CASE(deflate_decompress_longest_codes)
+{
+    // A dynamic block in which 'Z' has a 15-bit code. One of them ends exactly where the decoder's 64-bit bit buffer
+    // runs out, which must not leave stale bits behind.
+    Array<u8, 46> const compressed {
+        0x05, 0xE0, 0x49, 0x92, 0x24, 0x49, 0x92, 0x6D, 0xDB, 0x8E, 0x6D, 0xED,
+        0x83, 0xC4, 0xA2, 0xE6, 0x91, 0xF7, 0x0D, 0xE0, 0xCF, 0x7F, 0x20, 0x7F,
+        0xED, 0xDB, 0xF9, 0xFF, 0xB9, 0xFE, 0x7F, 0xFF, 0xBF, 0xF9, 0xFF, 0xFD,
+        0xFF, 0xFE, 0x7F, 0xFF, 0xBF, 0xBE, 0xB9, 0x77, 0xFF, 0x7F
+    };
+
+    auto const decompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT_EQ(StringView { decompressed.bytes() }, "CFCDAZADBZZCAZZZZBFCADED"sv);
+}
+
 TEST_CASE(deflate_round_trip_store)
 {
     auto original = ByteBuffer::create_uninitialized(1024).release_value();
@@ -148,3 +164,63 @@ TEST_CASE(deflate_compress_literals)
     Array<u8, 0x13> test { 0, 0, 0, 0, 0x72, 0, 0, 0xee, 0, 0, 0, 0x26, 0, 0, 0, 0x28, 0, 0, 0x72 };
     auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(test, Compress::DeflateCompressor::CompressionLevel::GOOD));
 }
+
+TEST_CASE(deflate_round_trip_all_levels)
+{
+    auto original = make_corpus(Compress::DeflateCompressor::block_size * 3 + 123);
+    for (auto level : { Compress::DeflateCompressor::CompressionLevel::STORE, Compress::DeflateCompressor::CompressionLevel::FAST, Compress::DeflateCompressor::CompressionLevel::GOOD, Compress::DeflateCompressor::CompressionLevel::GREAT }) {
+        auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, level));
+        auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+        EXPECT(uncompressed == original);
+    }
+}
+
+TEST_CASE(deflate_back_references_across_blocks)
+{
+    // Every block repeats the tail of the previous one, which is only cheap if matches can reach back into it.
+    auto pattern = ByteBuffer::create_uninitialized(16 * KiB).release_value();
+    fill_with_random(pattern);
+    auto original = ByteBuffer::create_uninitialized(Compress::DeflateCompressor::block_size * 5).release_value();
+    for (size_t offset = 0; offset < original.size(); offset += pattern.size())
+        pattern.bytes().copy_trimmed_to(original.bytes().slice(offset));
+
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::GOOD));
+    EXPECT(compressed.size() < pattern.size() + 8 * KiB);
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+}
+
+TEST_CASE(deflate_round_trip_parallel)
+{
+    auto original = make_corpus(Compress::DeflateCompressor::parallel_chunk_size * 5 + 4321);
+    auto serial = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original));
+    auto parallel = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all_in_parallel(original, Compress::DeflateCompressor::CompressionLevel::GOOD, 4));
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(parallel));
+    EXPECT(uncompressed == original);
+
+    // Since every chunk starts out with the tail of the previous one, splitting should barely affect the ratio.
+    EXPECT(parallel.size() < serial.size() + serial.size() / 50);
+
+    // Inputs smaller than a chunk and empty inputs take the serial path.
+    auto small = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all_in_parallel(original.bytes().trim(1000), Compress::DeflateCompressor::CompressionLevel::GOOD, 4));
+    EXPECT(TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(small)) == original.bytes().trim(1000));
+    auto empty = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all_in_parallel({}, Compress::DeflateCompressor::CompressionLevel::GOOD, 4));
+    EXPECT(TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(empty)).is_empty());
+}
+
+TEST_CASE(deflate_round_trip_skewed_frequencies)
+{
+    // Byte n occurs about twice as often as byte n + 1, which gives the rare bytes codes that are longer than the primary decode table.
+    auto original = TRY_OR_FAIL(ByteBuffer::create_uninitialized(256 * KiB));
+    u32 state = 1;
+    for (auto& byte : original.bytes()) {
+        state = state * 1103515245 + 12345;
+        byte = min(__builtin_ctz(state | 0x8000'0000), 15);
+    }
+    for (size_t i = 0; i < original.size(); i += 4096)
+        original[i] = static_cast<u8>(i / 4096 + 16);
+
+    auto compressed = TRY_OR_FAIL(Compress::DeflateCompressor::compress_all(original, Compress::DeflateCompressor::CompressionLevel::FAST));
+    auto uncompressed = TRY_OR_FAIL(Compress::DeflateDecompressor::decompress_all(compressed));
+    EXPECT(uncompressed == original);
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Random.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Checksum/Adler32.h>
 #include <LibCrypto/Cipher/AES.h>
@@ -306,6 +307,39 @@ TEST_CASE(test_AES_CTR_256bit_encrypt_36bytes_with_high_counter)
     test_aes_ctr_encrypt(AS_BB(key), AS_BB(ivec), AS_BB(in), AS_BB(out));
 }
 
+TEST_CASE(test_AES_CTR_long_input_matches_block_by_block)
+{
+    // Long enough for several runs of interleaved blocks, with a tail and a carry out of the low 64 counter bits.
+    auto in = ByteBuffer::create_uninitialized(1000).release_value();
+    fill_with_random(in);
+    u8 ivec[] { 0, 0, 0, 0, 0, 0, 0, 0x2a, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf0 };
+
+    for (size_t key_bits : { 128, 192, 256 }) {
+        auto key = ByteBuffer::create_uninitialized(key_bits / 8).release_value();
+        fill_with_random(key);
+
+        Crypto::Cipher::AESCipher::CTRMode cipher(key, key_bits, Crypto::Cipher::Intent::Encryption);
+        auto out = ByteBuffer::create_zeroed(in.size()).release_value();
+        auto out_span = out.bytes();
+        cipher.encrypt(in, out_span, AS_BB(ivec));
+
+        Crypto::Cipher::AESCipher block_cipher(key, key_bits);
+        auto expected = ByteBuffer::copy(in).release_value();
+        u8 counter[16];
+        memcpy(counter, ivec, sizeof(counter));
+        for (size_t offset = 0; offset < expected.size(); offset += 16) {
+            Crypto::Cipher::AESCipherBlock block(counter, sizeof(counter));
+            block_cipher.encrypt_block(block, block);
+            for (size_t i = 0; i < min<size_t>(16, expected.size() - offset); ++i)
+                expected[offset + i] ^= block.bytes()[i];
+            for (size_t i = sizeof(counter); i > 0 && ++counter[i - 1] == 0; --i)
+                ;
+        }
+
+        EXPECT_EQ(out, expected);
+    }
+}
+
 static auto test_aes_ctr_decrypt = [](auto key, auto ivec, auto in, auto out_expected) {
     // nonce is already included in ivec.
     Crypto::Cipher::AESCipher::CTRMode cipher(key, 8 * key.size(), Crypto::Cipher::Intent::Decryption);
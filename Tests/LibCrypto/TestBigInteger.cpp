@@ -23,6 +23,15 @@ static Crypto::UnsignedBigInteger bigint_fibonacci(size_t n)
     return num1;
 }
 
+// Multiplying by a single word at a time never leaves the schoolbook path, so this is an independent reference for Karatsuba.
+static Crypto::UnsignedBigInteger bigint_multiply_word_by_word(Crypto::UnsignedBigInteger const& left, Crypto::UnsignedBigInteger const& right)
+{
+    Crypto::UnsignedBigInteger result(0);
+    for (size_t i = 0; i < right.length(); ++i)
+        result = result.plus(left.multiplied_by(Crypto::UnsignedBigInteger(right.words()[i])).shift_left(i * Crypto::UnsignedBigInteger::BITS_IN_WORD));
+    return result;
+}
+
 static Crypto::SignedBigInteger bigint_signed_fibonacci(size_t n)
 {
     Crypto::SignedBigInteger num1(0);
@@ -201,6 +210,28 @@ TEST_CASE(test_unsigned_bigint_multiplication_with_big_numbers2)
     EXPECT_EQ(result.words(), expected_result);
 }
 
+TEST_CASE(test_unsigned_bigint_karatsuba_multiplication)
+{
+    auto all_ones = Crypto::UnsignedBigInteger(1).shift_left(100 * Crypto::UnsignedBigInteger::BITS_IN_WORD).minus(1);
+    struct {
+        Crypto::UnsignedBigInteger left;
+        Crypto::UnsignedBigInteger right;
+    } multiplication_tests[] = {
+        { bigint_fibonacci(1500), bigint_fibonacci(1510) },
+        { bigint_fibonacci(2000), bigint_fibonacci(2100) },
+        { bigint_fibonacci(10000), bigint_fibonacci(9000) },
+        { bigint_fibonacci(10000), bigint_fibonacci(1600) },
+        { bigint_fibonacci(1600), bigint_fibonacci(10000) },
+        { all_ones, all_ones },
+        { all_ones, bigint_fibonacci(4000) },
+    };
+
+    for (auto& test_case : multiplication_tests) {
+        auto expected = bigint_multiply_word_by_word(test_case.left, test_case.right);
+        EXPECT_EQ(test_case.left.multiplied_by(test_case.right), expected);
+    }
+}
+
 TEST_CASE(test_unsigned_bigint_simple_division)
 {
     Crypto::UnsignedBigInteger num1(27194);
@@ -331,6 +362,27 @@ TEST_CASE(test_bigint_modular_power_extra_tests)
     }
 }
 
+TEST_CASE(test_bigint_modular_power_fixed_sizes)
+{
+    // These sizes go through the fixed-size Montgomery code, so check them against the classical algorithm.
+    for (size_t bits : { 512, 1024, 1536, 2048, 3072, 4096 }) {
+        for (size_t leading_zeros : { 0, 5 }) {
+            auto modulo = Crypto::UnsignedBigInteger(1).shift_left(bits - 1 - leading_zeros).plus(bigint_fibonacci(bits));
+            if (!modulo.is_odd())
+                modulo = modulo.plus(1);
+            auto base = bigint_fibonacci(bits + 7);
+            auto exponent = bigint_fibonacci(50);
+
+            Crypto::UnsignedBigInteger ep { exponent };
+            Crypto::UnsignedBigInteger base_copy { base };
+            Crypto::UnsignedBigInteger temp_1, temp_2, temp_3, temp_4, temp_multiply, temp_quotient, temp_remainder, expected;
+            Crypto::UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(ep, base_copy, modulo, temp_1, temp_2, temp_3, temp_4, temp_multiply, temp_quotient, temp_remainder, expected);
+
+            EXPECT_EQ(Crypto::NumberTheory::ModularPower(base, exponent, modulo), expected);
+        }
+    }
+}
+
 TEST_CASE(test_bigint_primality_test)
 {
     struct {
@@ -4,6 +4,9 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
+#include <AK/Random.h>
 #include <LibCrypto/Authentication/GHash.h>
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/Hash/MD5.h>
@@ -108,6 +111,10 @@ TEST_CASE(test_SHA1_hash_empty_string)
     };
     auto digest = Crypto::Hash::SHA1::hash(""sv);
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+
+    // Empty inputs may not point anywhere.
+    digest = Crypto::Hash::SHA1::hash(nullptr, 0);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
 TEST_CASE(test_SHA1_hash_long_string)
@@ -151,6 +158,44 @@ TEST_CASE(test_SHA1_hash_split_into_blocks)
     EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
 }
 
+TEST_CASE(test_SHA1_hash_million_characters)
+{
+    u8 result[] {
+        0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e, 0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+    };
+    auto data = MUST(ByteBuffer::create_uninitialized(1'000'000));
+    data.bytes().fill('a');
+    auto digest = Crypto::Hash::SHA1::hash(data);
+    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+}
+
+TEST_CASE(test_SHA1_hash_uneven_updates)
+{
+    u8 data[1000];
+    fill_with_random(data);
+    auto expected = Crypto::Hash::SHA1::hash(data, sizeof(data));
+
+    for (size_t chunk_size : { 1, 7, 63, 64, 65, 200 }) {
+        Crypto::Hash::SHA1 sha;
+        for (size_t offset = 0; offset < sizeof(data); offset += chunk_size)
+            sha.update(data + offset, min(chunk_size, sizeof(data) - offset));
+        auto digest = sha.digest();
+        EXPECT(memcmp(expected.data, digest.data, Crypto::Hash::SHA1::digest_size()) == 0);
+    }
+}
+
+// Runs the test with every SHA256 implementation the CPU supports.
+static void for_each_sha256_implementation(Function<void()> const& test)
+{
+    using Implementation = Crypto::Hash::SHA256::Implementation;
+    for (auto implementation : { Implementation::Scalar, Implementation::AVX2, Implementation::SHANI }) {
+        if (!Crypto::Hash::SHA256::force_implementation(implementation))
+            continue;
+        test();
+    }
+    Crypto::Hash::SHA256::force_implementation({});
+}
+
 TEST_CASE(test_SHA256_name)
 {
     Crypto::Hash::SHA256 sha;
@@ -159,29 +204,147 @@ TEST_CASE(test_SHA256_name)
 
 TEST_CASE(test_SHA256_hash_string)
 {
-    u8 result[] {
-        0x9a, 0xcd, 0x50, 0xf9, 0xa2, 0xaf, 0x37, 0xe4, 0x71, 0xf7, 0x61, 0xc3, 0xfe, 0x7b, 0x8d, 0xea, 0x56, 0x17, 0xe5, 0x1d, 0xac, 0x80, 0x2f, 0xe6, 0xc1, 0x77, 0xb7, 0x4a, 0xbf, 0x0a, 0xbb, 0x5a
-    };
-    auto digest = Crypto::Hash::SHA256::hash("Well hello friends"sv);
-    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    for_each_sha256_implementation([&] {
+        u8 result[] {
+            0x9a, 0xcd, 0x50, 0xf9, 0xa2, 0xaf, 0x37, 0xe4, 0x71, 0xf7, 0x61, 0xc3, 0xfe, 0x7b, 0x8d, 0xea, 0x56, 0x17, 0xe5, 0x1d, 0xac, 0x80, 0x2f, 0xe6, 0xc1, 0x77, 0xb7, 0x4a, 0xbf, 0x0a, 0xbb, 0x5a
+        };
+        auto digest = Crypto::Hash::SHA256::hash("Well hello friends"sv);
+        EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    });
 }
 
 TEST_CASE(test_SHA256_hash_empty_string)
 {
-    u8 result[] {
-        0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
-    };
-    auto digest = Crypto::Hash::SHA256::hash(""sv);
-    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    for_each_sha256_implementation([&] {
+        u8 result[] {
+            0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55
+        };
+        auto digest = Crypto::Hash::SHA256::hash(""sv);
+        EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+
+        // Empty inputs may not point anywhere.
+        digest = Crypto::Hash::SHA256::hash(nullptr, 0);
+        EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+
+        Array<ReadonlyBytes, 1> messages { ReadonlyBytes {} };
+        Array<Crypto::Hash::SHA256::DigestType, 1> digests;
+        Crypto::Hash::SHA256::hash_many(messages, digests);
+        EXPECT(memcmp(result, digests[0].data, Crypto::Hash::SHA256::digest_size()) == 0);
+    });
 }
 
 TEST_CASE(test_SHA256_hash_split_into_blocks)
 {
-    u8 result[] {
-        0x1b, 0x90, 0x74, 0xf9, 0x9b, 0xf3, 0x56, 0x20, 0xd3, 0xf6, 0xbf, 0x7d, 0x72, 0x53, 0xb3, 0x3c, 0xd1, 0x1b, 0x7d, 0xd8, 0xa9, 0xa0, 0x4e, 0x55, 0xf5, 0x72, 0x43, 0x94, 0xaf, 0x27, 0x6c, 0x5c
+    for_each_sha256_implementation([&] {
+        u8 result[] {
+            0x1b, 0x90, 0x74, 0xf9, 0x9b, 0xf3, 0x56, 0x20, 0xd3, 0xf6, 0xbf, 0x7d, 0x72, 0x53, 0xb3, 0x3c, 0xd1, 0x1b, 0x7d, 0xd8, 0xa9, 0xa0, 0x4e, 0x55, 0xf5, 0x72, 0x43, 0x94, 0xaf, 0x27, 0x6c, 0x5c
+        };
+        auto digest = Crypto::Hash::SHA256::hash("0123456789012345678901234567890123456789012345678901234567890123abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcd"sv);
+        EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    });
+}
+
+TEST_CASE(test_SHA256_hash_million_characters)
+{
+    for_each_sha256_implementation([&] {
+        u8 result[] {
+            0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+        };
+        auto data = MUST(ByteBuffer::create_uninitialized(1'000'000));
+        data.bytes().fill('a');
+        auto digest = Crypto::Hash::SHA256::hash(data);
+        EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    });
+}
+
+TEST_CASE(test_SHA256_hash_uneven_updates)
+{
+    for_each_sha256_implementation([&] {
+        u8 data[1000];
+        fill_with_random(data);
+        auto expected = Crypto::Hash::SHA256::hash(data, sizeof(data));
+
+        for (size_t chunk_size : { 1, 7, 63, 64, 65, 200 }) {
+            Crypto::Hash::SHA256 sha;
+            for (size_t offset = 0; offset < sizeof(data); offset += chunk_size)
+                sha.update(data + offset, min(chunk_size, sizeof(data) - offset));
+            auto digest = sha.digest();
+            EXPECT(memcmp(expected.data, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+        }
+    });
+}
+
+TEST_CASE(test_SHA256_hash_many)
+{
+    for_each_sha256_implementation([&] {
+        u8 data[1000];
+        fill_with_random(data);
+
+        // Different lengths make the messages finish at different times, and cover one and two padding blocks.
+        Vector<ReadonlyBytes> messages;
+        for (size_t length : { 0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 300, 1000, 3, 64, 17, 999, 100, 5, 0, 64 })
+            messages.append({ data, length });
+
+        Vector<Crypto::Hash::SHA256::DigestType> digests;
+        digests.resize(messages.size());
+        Crypto::Hash::SHA256::hash_many(messages, digests);
+
+        for (size_t i = 0; i < messages.size(); ++i) {
+            auto expected = Crypto::Hash::SHA256::hash(messages[i].data(), messages[i].size());
+            EXPECT(memcmp(expected.data, digests[i].data, Crypto::Hash::SHA256::digest_size()) == 0);
+        }
+    });
+}
+
+TEST_CASE(test_SHA256_hash_many_known_answers)
+{
+    // The AVX2 code is only used by hash_many(), so run the known answers from above through it as well.
+    auto million_characters = MUST(ByteBuffer::create_uninitialized(1'000'000));
+    million_characters.bytes().fill('a');
+
+    Vector<ReadonlyBytes> messages {
+        "Well hello friends"sv.bytes(),
+        ""sv.bytes(),
+        "0123456789012345678901234567890123456789012345678901234567890123abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcd"sv.bytes(),
+        million_characters.bytes(),
+    };
+    u8 const results[][32] {
+        { 0x9a, 0xcd, 0x50, 0xf9, 0xa2, 0xaf, 0x37, 0xe4, 0x71, 0xf7, 0x61, 0xc3, 0xfe, 0x7b, 0x8d, 0xea, 0x56, 0x17, 0xe5, 0x1d, 0xac, 0x80, 0x2f, 0xe6, 0xc1, 0x77, 0xb7, 0x4a, 0xbf, 0x0a, 0xbb, 0x5a },
+        { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24, 0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 },
+        { 0x1b, 0x90, 0x74, 0xf9, 0x9b, 0xf3, 0x56, 0x20, 0xd3, 0xf6, 0xbf, 0x7d, 0x72, 0x53, 0xb3, 0x3c, 0xd1, 0x1b, 0x7d, 0xd8, 0xa9, 0xa0, 0x4e, 0x55, 0xf5, 0x72, 0x43, 0x94, 0xaf, 0x27, 0x6c, 0x5c },
+        { 0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0 },
+    };
+
+    for_each_sha256_implementation([&] {
+        Vector<Crypto::Hash::SHA256::DigestType> digests;
+        digests.resize(messages.size());
+        Crypto::Hash::SHA256::hash_many(messages, digests);
+
+        for (size_t i = 0; i < messages.size(); ++i)
+            EXPECT(memcmp(results[i], digests[i].data, Crypto::Hash::SHA256::digest_size()) == 0);
+    });
+}
+
+TEST_CASE(test_SHA2_peek_keeps_state)
+{
+    u8 data[200];
+    fill_with_random(data);
+
+    // Peeking at 60 bytes needs two padding blocks, which must not leak into the hash of the whole message.
+    auto check = [&]<typename Hash>() {
+        auto expected = Hash::hash(data, sizeof(data));
+        Hash hash;
+        hash.update(data, 60);
+        auto partial = hash.peek();
+        auto expected_partial = Hash::hash(data, 60);
+        EXPECT(memcmp(expected_partial.data, partial.data, Hash::digest_size()) == 0);
+        hash.update(data + 60, sizeof(data) - 60);
+        auto digest = hash.digest();
+        EXPECT(memcmp(expected.data, digest.data, Hash::digest_size()) == 0);
     };
-    auto digest = Crypto::Hash::SHA256::hash("0123456789012345678901234567890123456789012345678901234567890123abcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcdefghijabcd"sv);
-    EXPECT(memcmp(result, digest.data, Crypto::Hash::SHA256::digest_size()) == 0);
+    check.operator()<Crypto::Hash::SHA256>();
+    check.operator()<Crypto::Hash::SHA384>();
+    check.operator()<Crypto::Hash::SHA512>();
 }
 
 TEST_CASE(test_SHA384_name)
@@ -268,3 +431,52 @@ TEST_CASE(test_ghash_galois_field_multiply2)
     Crypto::Authentication::galois_multiply(z, x, y);
     EXPECT(memcmp(result, z, 4 * sizeof(u32)) == 0);
 }
+
+static Crypto::Authentication::GHashDigest ghash_one_block_at_a_time(ReadonlyBytes key, ReadonlyBytes aad, ReadonlyBytes cipher)
+{
+    u32 h[4];
+    u32 tag[4] { 0, 0, 0, 0 };
+    for (size_t i = 0; i < 4; ++i)
+        h[i] = AK::convert_between_host_and_big_endian(ByteReader::load32(key.offset(i * 4)));
+
+    auto absorb = [&](ReadonlyBytes data) {
+        for (size_t offset = 0; offset < data.size(); offset += 16) {
+            u8 block[16] {};
+            data.slice(offset, min<size_t>(16, data.size() - offset)).copy_to(block);
+            for (size_t i = 0; i < 4; ++i)
+                tag[i] ^= AK::convert_between_host_and_big_endian(ByteReader::load32(block + i * 4));
+            Crypto::Authentication::galois_multiply(tag, h, tag);
+        }
+    };
+    absorb(aad);
+    absorb(cipher);
+
+    u8 lengths[16];
+    ByteReader::store(lengths, AK::convert_between_host_and_big_endian(8 * (u64)aad.size()));
+    ByteReader::store(lengths + 8, AK::convert_between_host_and_big_endian(8 * (u64)cipher.size()));
+    absorb({ lengths, sizeof(lengths) });
+
+    Crypto::Authentication::GHashDigest digest;
+    for (size_t i = 0; i < 4; ++i)
+        ByteReader::store(digest.data + i * 4, AK::convert_between_host_and_big_endian(tag[i]));
+    return digest;
+}
+
+TEST_CASE(test_ghash_matches_one_block_at_a_time)
+{
+    u8 key[16];
+    fill_with_random(key);
+    auto data = ByteBuffer::create_uninitialized(1100).release_value();
+    fill_with_random(data);
+
+    Crypto::Authentication::GHash ghash(ReadonlyBytes { key, sizeof(key) });
+    for (size_t aad_size : { 0, 5, 16, 20, 64, 77 }) {
+        for (size_t cipher_size : { 0, 15, 16, 63, 64, 65, 200, 1000 }) {
+            auto aad = data.bytes().slice(0, aad_size);
+            auto cipher = data.bytes().slice(100, cipher_size);
+            auto expected = ghash_one_block_at_a_time({ key, sizeof(key) }, aad, cipher);
+            auto actual = ghash.process(aad, cipher);
+            EXPECT(memcmp(expected.data, actual.data, sizeof(expected.data)) == 0);
+        }
+    }
+}
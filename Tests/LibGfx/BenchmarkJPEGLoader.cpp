@@ -4,9 +4,12 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <LibCore/DirIterator.h>
 #include <LibCore/File.h>
+#include <LibCore/MappedFile.h>
 #include <LibGfx/ImageFormats/JPEGLoader.h>
 #include <LibTest/TestCase.h>
+#include <stdlib.h>
 
 #ifdef AK_OS_SERENITY
 #    define TEST_INPUT(x) ("/usr/Tests/LibGfx/test-inputs/" x)
@@ -18,7 +21,6 @@
 //        https://github.com/llvm/llvm-project/commit/fd86789962964a98157e8159c3d95cdc241942e3
 // clang-format off
 auto small_image = Core::File::open(TEST_INPUT("rgb24.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
-auto big_image = Core::File::open(TEST_INPUT("big_image.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto rgb_image = Core::File::open(TEST_INPUT("rgb_components.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 auto several_scans = Core::File::open(TEST_INPUT("several_scans.jpg"sv), Core::File::OpenMode::Read).release_value()->read_until_eof().release_value();
 // clang-format on
@@ -29,12 +31,6 @@ BENCHMARK_CASE(small_image)
     MUST(plugin_decoder->frame(0));
 }
 
-BENCHMARK_CASE(big_image)
-{
-    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(big_image));
-    MUST(plugin_decoder->frame(0));
-}
-
 BENCHMARK_CASE(rgb_image)
 {
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(rgb_image));
@@ -46,3 +42,23 @@ BENCHMARK_CASE(several_scans)
     auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(several_scans));
     MUST(plugin_decoder->frame(0));
 }
+
+// Decodes every JPEG in the directory given by JPEG_BENCHMARK_DIRECTORY, which is meant to be pointed at a folder of
+// large photos. Without it, the test inputs are used.
+BENCHMARK_CASE(photo_directory)
+{
+    auto const* directory = getenv("JPEG_BENCHMARK_DIRECTORY");
+    if (!directory)
+        directory = TEST_INPUT("");
+
+    Core::DirIterator iterator { directory, Core::DirIterator::SkipDots };
+    while (iterator.has_next()) {
+        auto path = iterator.next_full_path();
+        if (!path.ends_with(".jpg"sv, CaseSensitivity::CaseInsensitive) && !path.ends_with(".jpeg"sv, CaseSensitivity::CaseInsensitive))
+            continue;
+
+        auto file = MUST(Core::MappedFile::map(path));
+        auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+        MUST(plugin_decoder->frame(0));
+    }
+}
@@ -6,6 +6,7 @@
  */
 
 #include <AK/DeprecatedString.h>
+#include <AK/ScopeGuard.h>
 #include <LibCore/MappedFile.h>
 #include <LibGfx/ImageFormats/BMPLoader.h>
 #include <LibGfx/ImageFormats/GIFLoader.h>
@@ -16,6 +17,7 @@
 #include <LibGfx/ImageFormats/PGMLoader.h>
 #include <LibGfx/ImageFormats/PNGLoader.h>
 #include <LibGfx/ImageFormats/PPMLoader.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
 #include <LibGfx/ImageFormats/TGALoader.h>
 #include <LibGfx/ImageFormats/WebPLoader.h>
 #include <LibTest/TestCase.h>
@@ -178,6 +180,55 @@ TEST_CASE(test_jpeg_sof2_12bits)
     EXPECT_EQ(frame.image->size(), Gfx::IntSize(320, 240));
 }
 
+TEST_CASE(test_jpeg_ycbcr_420)
+{
+    // Stripes of 8 pixels, so both halves of each subsampled chroma block are used.
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("ycbcr_420.jpg"sv)));
+    EXPECT(Gfx::JPEGImageDecoderPlugin::sniff(file->bytes()));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    MUST(plugin_decoder->initialize());
+
+    auto frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(40, 24));
+    EXPECT_EQ(frame.image->get_pixel(3, 8), Gfx::Color(254, 0, 0));
+    EXPECT_EQ(frame.image->get_pixel(11, 8), Gfx::Color(0, 255, 1));
+    EXPECT_EQ(frame.image->get_pixel(19, 8), Gfx::Color(0, 0, 254));
+    EXPECT_EQ(frame.image->get_pixel(27, 8), Gfx::Color(255, 255, 0));
+    EXPECT_EQ(frame.image->get_pixel(35, 8), Gfx::Color(255, 255, 255));
+    EXPECT_EQ(frame.image->get_pixel(3, 20), Gfx::Color(128, 63, 31));
+    EXPECT_EQ(frame.image->get_pixel(37, 20), Gfx::Color(128, 63, 31));
+}
+
+TEST_CASE(test_jpeg_adobe_cmyk)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("cmyk.jpg"sv)));
+    EXPECT(Gfx::JPEGImageDecoderPlugin::sniff(file->bytes()));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    MUST(plugin_decoder->initialize());
+
+    auto frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(32, 16));
+    EXPECT_EQ(frame.image->get_pixel(3, 8), Gfx::Color(255, 0, 0));
+    EXPECT_EQ(frame.image->get_pixel(11, 8), Gfx::Color(0, 191, 0));
+    EXPECT_EQ(frame.image->get_pixel(19, 8), Gfx::Color(0, 0, 127));
+    EXPECT_EQ(frame.image->get_pixel(27, 8), Gfx::Color(63, 63, 63));
+}
+
+TEST_CASE(test_jpeg_adobe_ycck)
+{
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("ycck.jpg"sv)));
+    EXPECT(Gfx::JPEGImageDecoderPlugin::sniff(file->bytes()));
+    auto plugin_decoder = MUST(Gfx::JPEGImageDecoderPlugin::create(file->bytes()));
+    MUST(plugin_decoder->initialize());
+
+    auto frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(32, 16));
+    EXPECT_EQ(frame.image->get_pixel(3, 8), Gfx::Color(1, 255, 255));
+    EXPECT_EQ(frame.image->get_pixel(11, 8), Gfx::Color(200, 0, 199));
+    EXPECT_EQ(frame.image->get_pixel(19, 8), Gfx::Color(128, 128, 0));
+    EXPECT_EQ(frame.image->get_pixel(27, 8), Gfx::Color(31, 31, 31));
+}
+
 TEST_CASE(test_pbm)
 {
     auto file = MUST(Core::MappedFile::map(TEST_INPUT("buggie-raw.pbm"sv)));
@@ -573,6 +624,25 @@ TEST_CASE(test_webp_extended_lossless)
     EXPECT_EQ(frame.image->get_pixel(359, 73), Gfx::Color(0, 0, 0, 128));
 }
 
+TEST_CASE(test_webp_simple_lossless_predictor_top_right_of_rightmost_column)
+{
+    // Every pixel outside of the first row and column uses the TR predictor. For the rightmost column, the TR pixel is
+    // the leftmost pixel of the current row, which is greener than the leftmost pixel of the row above in this file.
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("top-right-predictor.webp"sv)));
+    EXPECT(Gfx::WebPImageDecoderPlugin::sniff(file->bytes()));
+    auto plugin_decoder = MUST(Gfx::WebPImageDecoderPlugin::create(file->bytes()));
+    MUST(plugin_decoder->initialize());
+
+    EXPECT_EQ(plugin_decoder->size(), Gfx::IntSize(4, 2));
+
+    auto frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->get_pixel(3, 0), Gfx::Color(0, 0x40, 0, 255));
+    EXPECT_EQ(frame.image->get_pixel(0, 1), Gfx::Color(0, 0x80, 0, 255));
+    EXPECT_EQ(frame.image->get_pixel(1, 1), Gfx::Color(0, 0x40, 0, 255));
+    EXPECT_EQ(frame.image->get_pixel(2, 1), Gfx::Color(0, 0x40, 0, 255));
+    EXPECT_EQ(frame.image->get_pixel(3, 1), Gfx::Color(0, 0x80, 0, 255));
+}
+
 TEST_CASE(test_webp_simple_lossless_color_index_transform)
 {
     // In addition to testing the index transform, this file also tests handling of explicity setting max_symbol.
@@ -654,6 +724,33 @@ TEST_CASE(test_webp_simple_lossless_color_index_transform_pixel_bundling_odd_wid
     }
 }
 
+TEST_CASE(test_webp_simple_lossless_color_index_transform_pixel_bundling_last_row)
+{
+    // 4x256 pixels with a 2-color palette, so each bundled pixel holds 8 pixels but each row only 4.
+    // The bitmap is exactly one page large, so writing the unused half of the last bundled pixel used to write past its end.
+    auto file = MUST(Core::MappedFile::map(TEST_INPUT("bundled-color-indexing.webp"sv)));
+    auto plugin_decoder = MUST(Gfx::WebPImageDecoderPlugin::create(file->bytes()));
+    MUST(plugin_decoder->initialize());
+
+    EXPECT_EQ(plugin_decoder->size(), Gfx::IntSize(4, 256));
+
+    auto frame = MUST(plugin_decoder->frame(0));
+    EXPECT_EQ(frame.image->size(), Gfx::IntSize(4, 256));
+
+    EXPECT_EQ(frame.image->get_pixel(0, 0), Gfx::Color::Blue);
+    EXPECT_EQ(frame.image->get_pixel(1, 0), Gfx::Color::Red);
+    EXPECT_EQ(frame.image->get_pixel(2, 0), Gfx::Color::Blue);
+    EXPECT_EQ(frame.image->get_pixel(3, 0), Gfx::Color::Red);
+
+    EXPECT_EQ(frame.image->get_pixel(0, 1), Gfx::Color::Red);
+    EXPECT_EQ(frame.image->get_pixel(1, 1), Gfx::Color::Blue);
+
+    EXPECT_EQ(frame.image->get_pixel(0, 255), Gfx::Color::Red);
+    EXPECT_EQ(frame.image->get_pixel(1, 255), Gfx::Color::Blue);
+    EXPECT_EQ(frame.image->get_pixel(2, 255), Gfx::Color::Red);
+    EXPECT_EQ(frame.image->get_pixel(3, 255), Gfx::Color::Blue);
+}
+
 TEST_CASE(test_webp_extended_lossless_animated)
 {
     auto file = MUST(Core::MappedFile::map(TEST_INPUT("extended-lossless-animated.webp"sv)));
@@ -678,3 +775,48 @@ TEST_CASE(test_webp_extended_lossless_animated)
         EXPECT_EQ(frame.image->get_pixel(500, 0), (frame_index == 2 || frame_index == 6) ? Gfx::Color::Black : Gfx::Color(255, 255, 255, 0));
     }
 }
+
+static NonnullRefPtr<Gfx::Bitmap> decode_with_thread_count(StringView path, size_t thread_count)
+{
+    Gfx::set_image_decoding_thread_count(thread_count);
+    ScopeGuard reset_thread_count = [] { Gfx::set_image_decoding_thread_count(1); };
+
+    auto file = MUST(Core::MappedFile::map(path));
+    auto decoder = Gfx::ImageDecoder::try_create_for_raw_bytes(file->bytes());
+    VERIFY(decoder);
+    return *MUST(decoder->frame(0)).image;
+}
+
+static void expect_same_image_with_several_threads(StringView path)
+{
+    auto single_threaded = decode_with_thread_count(path, 1);
+    auto multi_threaded = decode_with_thread_count(path, 4);
+    EXPECT_EQ(multi_threaded->size(), single_threaded->size());
+    EXPECT(multi_threaded->visually_equals(*single_threaded));
+}
+
+TEST_CASE(test_jpeg_restart_intervals_on_several_threads)
+{
+    expect_same_image_with_several_threads(TEST_INPUT("restart_interval.jpg"sv));
+}
+
+TEST_CASE(test_jpeg_restart_interval_marker_count_mismatch_on_several_threads)
+{
+    // There's a stray restart marker after the last interval, so the intervals have to be decoded in order.
+    expect_same_image_with_several_threads(TEST_INPUT("restart_interval_trailing_marker.jpg"sv));
+}
+
+TEST_CASE(test_jpeg_without_restart_intervals_on_several_threads)
+{
+    expect_same_image_with_several_threads(TEST_INPUT("several_scans.jpg"sv));
+}
+
+TEST_CASE(test_png_on_several_threads)
+{
+    expect_same_image_with_several_threads(TEST_INPUT("gradient.png"sv));
+}
+
+TEST_CASE(test_webp_lossless_on_several_threads)
+{
+    expect_same_image_with_several_threads(TEST_INPUT("simple-vp8l.webp"sv));
+}
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ScopeGuard.h>
 #include <LibJS/AST.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
@@ -137,3 +138,121 @@ TEST_CASE(catch_exception)
                             "if (hitCatch !== true) throw new Exception('failed');\n"
                             "if (hitFinally !== true) throw new Exception('failed');");
 }
+
+TEST_CASE(cached_property_lookups_follow_prototype_changes)
+{
+    EXPECT_NO_EXCEPTION_ALL("function Base() {}\n"
+                            "Base.prototype.value = 1;\n"
+                            "function Derived() { this.own = 0; }\n"
+                            "Derived.prototype = new Base();\n"
+                            "function get(o) { return o.value; }\n"
+                            "for (let i = 0; i < 3; ++i) if (get(new Derived()) !== 1) throw new Exception('failed');\n"
+                            "Base.prototype.value = 2;\n"
+                            "if (get(new Derived()) !== 2) throw new Exception('failed');\n"
+                            "Derived.prototype.value = 3;\n"
+                            "if (get(new Derived()) !== 3) throw new Exception('failed');\n"
+                            "delete Derived.prototype.value;\n"
+                            "if (get(new Derived()) !== 2) throw new Exception('failed');\n"
+                            "Object.defineProperty(Base.prototype, 'value', { get() { return this.own + 4; } });\n"
+                            "if (get(new Derived()) !== 4) throw new Exception('failed');");
+}
+
+TEST_CASE(cached_property_lookups_are_polymorphic)
+{
+    EXPECT_NO_EXCEPTION_ALL("const objects = [{ a: 1 }, { b: 0, a: 2 }, { c: 0, d: 0, a: 3 }, { e: 0, a: 4 }, { f: 0, a: 5 }, Object.create({ a: 6 })];\n"
+                            "function get(o) { return o.a; }\n"
+                            "for (let i = 0; i < 3; ++i) {\n"
+                            "    for (let j = 0; j < objects.length; ++j)\n"
+                            "        if (get(objects[j]) !== j + 1) throw new Exception('failed');\n"
+                            "}");
+}
+
+TEST_CASE(cached_property_stores)
+{
+    EXPECT_NO_EXCEPTION_ALL("function set(o, v) { o.x = v; }\n"
+                            "const objects = [{}, {}, {}];\n"
+                            "for (let i = 0; i < objects.length; ++i) set(objects[i], i);\n"
+                            "for (let i = 0; i < objects.length; ++i) { if (objects[i].x !== i) throw new Exception('failed'); }\n"
+                            "const sealed = Object.preventExtensions({});\n"
+                            "set(sealed, 1);\n"
+                            "if (sealed.x !== undefined) throw new Exception('failed');\n"
+                            "const prototype = {};\n"
+                            "const before = Object.create(prototype);\n"
+                            "set(before, 1);\n"
+                            "Object.defineProperty(prototype, 'x', { set(v) { this.y = v; } });\n"
+                            "const after = Object.create(prototype);\n"
+                            "set(after, 2);\n"
+                            "if (after.y !== 2 || Object.hasOwn(after, 'x')) throw new Exception('failed');");
+}
+
+#define EXPECT_NO_EXCEPTION_WITH_JIT(source)                      \
+    JS::Bytecode::Interpreter::set_jit_enabled(true);             \
+    JS::Bytecode::Interpreter::set_jit_threshold(0);              \
+    ScopeGuard disable_jit = [] {                                 \
+        JS::Bytecode::Interpreter::set_jit_enabled(false);        \
+    };                                                            \
+    SETUP_AND_PARSE("(() => {\n" source "\n})()")                 \
+    EXPECT_NO_EXCEPTION(executable)                               \
+    EXPECT(executable->native_executable || !ARCH(X86_64));
+
+TEST_CASE(jit_int32_arithmetic)
+{
+    EXPECT_NO_EXCEPTION_WITH_JIT("function check(actual, expected) { if (!Object.is(actual, expected)) throw new Exception('failed'); }\n"
+                                 "let sum = 0;\n"
+                                 "for (let i = 0; i < 1000; ++i) sum += i;\n"
+                                 "check(sum, 499500);\n"
+                                 "check(2147483647 + 1, 2147483648);\n"
+                                 "check(-2147483648 - 1, -2147483649);\n"
+                                 "check(65536 * 65536, 4294967296);\n"
+                                 "check(-1 * 0, -0);\n"
+                                 "check(0 * -5, -0);\n"
+                                 "let i = 2147483647; i++; check(i, 2147483648);\n"
+                                 "let j = -2147483648; j--; check(j, -2147483649);\n"
+                                 "check(-1 >>> 0, 4294967295);\n"
+                                 "check(-8 >> 1, -4);\n"
+                                 "check(1 << 33, 2);\n"
+                                 "check(0xf0 & 0x3c | 0x100 ^ 0x1, 0x131);\n"
+                                 "check(1 < 2 && 2 <= 2 && 3 > 2 && 3 >= 3, true);\n"
+                                 "check(1 == 1 && 1 === 1 && 1 != 2 && 1 !== 2, true);\n"
+                                 "check(1.5 + 1, 2.5);\n"
+                                 "check('1' + 1, '11');\n"
+                                 "check('2' * 3, 6);\n"
+                                 "check(1 == '1', true);\n"
+                                 "check(1 === '1', false);");
+}
+
+TEST_CASE(jit_conditional_jumps)
+{
+    EXPECT_NO_EXCEPTION_WITH_JIT("const truthy = [true, 1, -1, 0.5, 'a', {}, [], Symbol(), 1n];\n"
+                                 "const falsy = [false, 0, -0, NaN, '', null, undefined, 0n];\n"
+                                 "for (const value of truthy) { if (!value) throw new Exception('failed'); }\n"
+                                 "for (const value of falsy) { if (value) throw new Exception('failed'); }\n"
+                                 "let count = 0;\n"
+                                 "for (const value of [null, undefined, 0, false]) count += (value ?? 1);\n"
+                                 "if (count !== 2) throw new Exception('failed');\n"
+                                 "function defaulted(x = 5) { return x; }\n"
+                                 "if (defaulted() !== 5 || defaulted(null) !== null) throw new Exception('failed');");
+}
+
+TEST_CASE(jit_exceptions_and_generators)
+{
+    EXPECT_NO_EXCEPTION_WITH_JIT("let caught = 0;\n"
+                                 "let finalized = 0;\n"
+                                 "for (let i = 0; i < 10; ++i) {\n"
+                                 "    try {\n"
+                                 "        if (i % 2) throw i;\n"
+                                 "    } catch (e) {\n"
+                                 "        caught += e;\n"
+                                 "    } finally {\n"
+                                 "        ++finalized;\n"
+                                 "    }\n"
+                                 "}\n"
+                                 "if (caught !== 25 || finalized !== 10) throw new Exception('failed');\n"
+                                 "function* counter(limit) { for (let i = 0; i < limit; ++i) yield i; }\n"
+                                 "let total = 0;\n"
+                                 "for (const value of counter(5)) total += value;\n"
+                                 "if (total !== 10) throw new Exception('failed');\n"
+                                 "function returnsFromFinally(state) { try { return 1; } finally { ++state.finalized; } }\n"
+                                 "const state = { finalized: 0 };\n"
+                                 "if (returnsFromFinally(state) !== 1 || state.finalized !== 1) throw new Exception('failed');");
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Heap/GCStatistics.h>
+#include <LibTest/TestCase.h>
+
+static JS::GCPhaseTimes pause_of(i64 microseconds)
+{
+    return { Duration::zero(), Duration::from_microseconds(microseconds), Duration::zero(), Duration::zero() };
+}
+
+// Returns the upper bound of the histogram bucket that a pause of the given length ends up in.
+static i64 bucket_upper_bound(i64 microseconds)
+{
+    // Percentiles are capped at the longest pause, so add a much longer one to see the actual bucket.
+    JS::GCStatistics statistics;
+    statistics.did_collect(pause_of(microseconds));
+    statistics.did_collect(pause_of(NumericLimits<i64>::max() / 2));
+    return statistics.pause_time_percentile(50).to_microseconds();
+}
+
+TEST_CASE(no_collections)
+{
+    JS::GCStatistics statistics;
+    EXPECT_EQ(statistics.collection_count(), 0u);
+    EXPECT_EQ(statistics.longest_pause(), Duration::zero());
+    EXPECT_EQ(statistics.pause_time_percentile(50), Duration::zero());
+    EXPECT_EQ(statistics.pause_time_percentile(100), Duration::zero());
+}
+
+TEST_CASE(phase_times_add_up)
+{
+    JS::GCStatistics statistics;
+    statistics.did_collect({ Duration::from_microseconds(1), Duration::from_microseconds(20), Duration::from_microseconds(300), Duration::from_microseconds(4000) });
+    statistics.did_collect({ Duration::from_microseconds(2), Duration::from_microseconds(40), Duration::from_microseconds(600), Duration::from_microseconds(8000) });
+
+    EXPECT_EQ(statistics.collection_count(), 2u);
+    EXPECT_EQ(statistics.total_phase_times().gather_roots, Duration::from_microseconds(3));
+    EXPECT_EQ(statistics.total_phase_times().mark, Duration::from_microseconds(60));
+    EXPECT_EQ(statistics.total_phase_times().finalize, Duration::from_microseconds(900));
+    EXPECT_EQ(statistics.total_phase_times().sweep, Duration::from_microseconds(12000));
+    EXPECT_EQ(statistics.total_pause_time(), Duration::from_microseconds(12963));
+    EXPECT_EQ(statistics.longest_pause(), Duration::from_microseconds(8642));
+}
+
+TEST_CASE(short_pauses_get_a_bucket_each)
+{
+    for (i64 microseconds = 0; microseconds < 16; ++microseconds)
+        EXPECT_EQ(bucket_upper_bound(microseconds), microseconds);
+}
+
+TEST_CASE(longer_pauses_share_buckets)
+{
+    // From 16 us on, every power of two is split into 8 buckets of equal width.
+    EXPECT_EQ(bucket_upper_bound(16), 17);
+    EXPECT_EQ(bucket_upper_bound(17), 17);
+    EXPECT_EQ(bucket_upper_bound(18), 19);
+    EXPECT_EQ(bucket_upper_bound(31), 31);
+    EXPECT_EQ(bucket_upper_bound(32), 35);
+    EXPECT_EQ(bucket_upper_bound(960), 1023);
+    EXPECT_EQ(bucket_upper_bound(1023), 1023);
+    EXPECT_EQ(bucket_upper_bound(1024), 1151);
+}
+
+TEST_CASE(bucket_bounds_are_within_an_eighth)
+{
+    for (i64 microseconds = 8; microseconds < (1ll << 36); microseconds = microseconds * 3 / 2 + 1) {
+        auto upper_bound = bucket_upper_bound(microseconds);
+        EXPECT(upper_bound >= microseconds);
+        EXPECT(upper_bound <= microseconds + microseconds / 8);
+    }
+}
+
+TEST_CASE(very_long_pauses_go_into_the_last_bucket)
+{
+    // The last bucket has no real upper bound, so its pauses are reported as the longest one.
+    JS::GCStatistics statistics;
+    statistics.did_collect(pause_of(1ll << 36));
+    statistics.did_collect(pause_of(1ll << 40));
+    EXPECT_EQ(statistics.pause_time_percentile(0), Duration::from_microseconds(1ll << 40));
+    EXPECT_EQ(statistics.pause_time_percentile(50), Duration::from_microseconds(1ll << 40));
+}
+
+TEST_CASE(percentiles)
+{
+    JS::GCStatistics statistics;
+    for (i64 microseconds = 1; microseconds <= 100; ++microseconds)
+        statistics.did_collect(pause_of(microseconds));
+
+    EXPECT_EQ(statistics.collection_count(), 100u);
+    EXPECT_EQ(statistics.longest_pause(), Duration::from_microseconds(100));
+
+    // Every percentile is reported as the upper bound of the bucket it falls into, but never above the longest pause.
+    EXPECT_EQ(statistics.pause_time_percentile(0).to_microseconds(), 1);
+    EXPECT_EQ(statistics.pause_time_percentile(1).to_microseconds(), 1);
+    EXPECT_EQ(statistics.pause_time_percentile(50).to_microseconds(), 51);
+    EXPECT_EQ(statistics.pause_time_percentile(90).to_microseconds(), 95);
+    EXPECT_EQ(statistics.pause_time_percentile(99).to_microseconds(), 100);
+    EXPECT_EQ(statistics.pause_time_percentile(100).to_microseconds(), 100);
+}
+
+TEST_CASE(negative_pauses_count_as_zero)
+{
+    JS::GCStatistics statistics;
+    statistics.did_collect(pause_of(-5));
+    statistics.did_collect(pause_of(10));
+    EXPECT_EQ(statistics.pause_time_percentile(50).to_microseconds(), 0);
+}
@@ -33,6 +33,7 @@
 
 static DeprecatedString s_current_test = "";
 static bool s_use_bytecode = false;
+static bool s_use_jit = false;
 static bool s_enable_bytecode_optimizations = false;
 static bool s_parse_only = false;
 static DeprecatedString s_harness_file_directory;
@@ -602,6 +603,7 @@ int main(int argc, char** argv)
     args_parser.set_general_help("LibJS test262 runner for streaming tests");
     args_parser.add_option(s_harness_file_directory, "Directory containing the harness files", "harness-location", 'l', "harness-files");
     args_parser.add_option(s_use_bytecode, "Use the bytecode interpreter", "use-bytecode", 'b');
+    args_parser.add_option(s_use_jit, "Compile the bytecode to native code before running it (implies -b)", "use-jit", 0);
     args_parser.add_option(s_enable_bytecode_optimizations, "Enable the bytecode optimization passes", "enable-bytecode-optimizations", 'e');
     args_parser.add_option(s_parse_only, "Only parse the files", "parse-only", 'p');
     args_parser.add_option(timeout, "Seconds before test should timeout", "timeout", 't', "seconds");
@@ -627,6 +629,12 @@ int main(int argc, char** argv)
         return exit_wrong_arguments;
     }
 
+    if (s_use_jit) {
+        s_use_bytecode = true;
+        JS::Bytecode::Interpreter::set_jit_enabled(true);
+        JS::Bytecode::Interpreter::set_jit_threshold(0);
+    }
+
     AK::set_debug_enabled(enable_debug_printing);
 
     // The piping stuff is based on https://stackoverflow.com/a/956269.
@@ -1135,3 +1135,199 @@ TEST_CASE(inversion_state_in_char_class)
         EXPECT_EQ(result.capture_group_matches.first()[1].view.to_deprecated_string(), "}"sv);
     }
 }
+
+TEST_CASE(pike_vm_matches_like_backtracking)
+{
+    struct _test {
+        StringView pattern;
+        StringView subject;
+        ECMAScriptFlags flags { ECMAScriptFlags::Global };
+    };
+
+    constexpr _test tests[] {
+        { "(a|b)*c"sv, "xxababcabc"sv },
+        { "(a|ab)(c|bcd)(d*)"sv, "abcd"sv },
+        { "a*?b"sv, "aaab"sv },
+        { "(a+)+b"sv, "aaaaab aab"sv },
+        { "(a*)*b"sv, "b"sv },
+        { "(?:x(y)|x(z))+"sv, "xyxzxy"sv },
+        { "(?<year>\\d{4})-(?<month>\\d{2})"sv, "on 2023-04-01"sv },
+        { "\\bfoo\\b"sv, "foobar foo barfoo"sv },
+        { "^abc$"sv, "abc"sv },
+        { "^abc$"sv, "abc\nabc"sv, combine_flags(ECMAScriptFlags::Global, ECMAScriptFlags::Multiline) },
+        { "a{2,3}"sv, "aaaaaaa"sv },
+        { "(ab){2}"sv, "abababab"sv },
+        { "[a-c]+|xyz"sv, "--xyzabcc"sv },
+        { "hello|hell|he"sv, "she said hell"sv },
+        { "(|a)+"sv, "aaa"sv },
+        { ".*"sv, "abc"sv },
+        { "x*"sv, "axxb"sv },
+        { "foo"sv, "FOO foo"sv, combine_flags(ECMAScriptFlags::Global, ECMAScriptFlags::Insensitive) },
+        { "b+"sv, "abbbc"sv, ECMAScriptFlags::Sticky },
+        { "abc"sv, "xxabc"sv, {} },
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern, test.flags);
+        EXPECT_EQ(re.parser_result.error, regex::Error::NoError);
+        EXPECT(re.pike_vm);
+
+        auto result = re.match(test.subject);
+        re.pike_vm = nullptr;
+        re.start_offset = 0;
+        auto expected = re.match(test.subject);
+
+        EXPECT_EQ(result.success, expected.success);
+        EXPECT_EQ(result.matches.size(), expected.matches.size());
+        if (result.matches.size() != expected.matches.size())
+            continue;
+
+        for (size_t i = 0; i < result.matches.size(); ++i) {
+            EXPECT_EQ(result.matches[i].view.to_deprecated_string(), expected.matches[i].view.to_deprecated_string());
+            EXPECT_EQ(result.matches[i].global_offset, expected.matches[i].global_offset);
+
+            auto& groups = result.capture_group_matches[i];
+            auto& expected_groups = expected.capture_group_matches[i];
+            EXPECT_EQ(groups.size(), expected_groups.size());
+            if (groups.size() != expected_groups.size())
+                continue;
+            for (size_t j = 0; j < groups.size(); ++j) {
+                EXPECT_EQ(groups[j].view.is_null(), expected_groups[j].view.is_null());
+                EXPECT_EQ(groups[j].view.to_deprecated_string(), expected_groups[j].view.to_deprecated_string());
+                EXPECT_EQ(groups[j].capture_group_name, expected_groups[j].capture_group_name);
+            }
+        }
+    }
+}
+
+TEST_CASE(pike_vm_empty_loop_iteration)
+{
+    // An iteration that matches the empty string doesn't count, so the group keeps what the first iteration matched.
+    Regex<ECMA262> re("(a*)+b"sv);
+    EXPECT(re.pike_vm);
+    auto result = re.match("aab"sv);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.capture_group_matches.first()[0].view.to_deprecated_string(), "aa"sv);
+}
+
+TEST_CASE(pike_vm_is_not_used_for_backreferences_and_lookaround)
+{
+    Array patterns {
+        "(a)\\1"sv,
+        "a(?=b)"sv,
+        "(?<!a)b"sv,
+    };
+    for (auto& pattern : patterns) {
+        Regex<ECMA262> re(pattern);
+        EXPECT(!re.pike_vm);
+    }
+}
+
+TEST_CASE(pike_vm_nested_quantifiers_in_linear_time)
+{
+    // This takes exponential time with a backtracking matcher.
+    Regex<ECMA262> re("^(a|a)*b"sv);
+    EXPECT(re.pike_vm);
+    auto result = re.match(DeprecatedString::repeated('a', 10000));
+    EXPECT_EQ(result.success, false);
+}
+
+TEST_CASE(literal_prefilter_extraction)
+{
+    struct _test {
+        StringView pattern;
+        StringView required_literal;
+        bool required_literal_is_prefix;
+        StringView first_characters;
+    };
+
+    constexpr _test tests[] {
+        { "ERROR"sv, "ERROR"sv, true, ""sv },
+        { "^ERROR: (.*)"sv, "ERROR: "sv, true, ""sv },
+        { "\\d+ms"sv, "ms"sv, false, ""sv },
+        { "user(\\d+)@example\\.com"sv, "@example.com"sv, false, "u"sv },
+        { "ERROR|WARN"sv, {}, false, "WE"sv },
+        { "(foo|bar)baz"sv, "baz"sv, false, "bf"sv },
+        { "a*b"sv, "b"sv, false, "ab"sv },
+    };
+
+    for (auto& test : tests) {
+        Regex<ECMA262> re(test.pattern);
+        EXPECT(re.literal_prefilter.has_value());
+        if (!re.literal_prefilter.has_value())
+            continue;
+        auto& prefilter = re.literal_prefilter.value();
+        EXPECT_EQ(prefilter.required_literal.view(), test.required_literal);
+        EXPECT_EQ(prefilter.required_literal_is_prefix, test.required_literal_is_prefix);
+        EXPECT_EQ(StringView(prefilter.first_characters.data(), prefilter.first_characters.size()), test.first_characters);
+    }
+
+    Array patterns_without_prefilter {
+        "a?"sv,
+        "\\w+"sv,
+        "(?=ab)a"sv,
+        "[ab]c|d"sv,
+    };
+    for (auto& pattern : patterns_without_prefilter) {
+        Regex<ECMA262> re(pattern);
+        EXPECT(!re.literal_prefilter.has_value());
+    }
+}
+
+TEST_CASE(literal_prefilter_matches_like_without_prefilter)
+{
+    struct _test {
+        StringView pattern;
+        StringView subject;
+        ECMAScriptFlags flags { ECMAScriptFlags::Global };
+    };
+
+    constexpr _test tests[] {
+        { "ERROR"sv, "INFO ok\nERROR bad\nWARN meh\nERROR worse"sv },
+        { "ERROR|WARN"sv, "INFO ok\nERROR bad\nWARN meh\nERROR worse"sv },
+        { "^(ERROR|WARN)"sv, "INFO ok\nERROR bad\nWARN meh"sv, combine_flags(ECMAScriptFlags::Global, ECMAScriptFlags::Multiline) },
+        { "\\b(a|b)(abc|x){1,3}"sv, "bbcbcccbb  bxbAcx"sv },
+        { "(\\d+)ms"sv, "took 12ms, then 3ms"sv },
+        { "error"sv, "ERROR Error error"sv, combine_flags(ECMAScriptFlags::Global, ECMAScriptFlags::Insensitive) },
+        { "ab"sv, "xxabab"sv, ECMAScriptFlags::Sticky },
+        { "ab"sv, "abxab"sv, {} },
+        { "b"sv, "a\xf0\x9f\x98\x80 b"sv, combine_flags(ECMAScriptFlags::Global, ECMAScriptFlags::Unicode) },
+    };
+
+    for (auto& test : tests) {
+        for (auto use_pike_vm : { true, false }) {
+            Regex<ECMA262> re(test.pattern, test.flags);
+            EXPECT_EQ(re.parser_result.error, regex::Error::NoError);
+            EXPECT(re.literal_prefilter.has_value());
+            if (!use_pike_vm)
+                re.pike_vm = nullptr;
+
+            auto result = re.match(test.subject);
+            re.literal_prefilter = {};
+            re.start_offset = 0;
+            auto expected = re.match(test.subject);
+
+            EXPECT_EQ(result.success, expected.success);
+            EXPECT_EQ(result.matches.size(), expected.matches.size());
+            if (result.matches.size() != expected.matches.size())
+                continue;
+            for (size_t i = 0; i < result.matches.size(); ++i) {
+                EXPECT_EQ(result.matches[i].view.to_deprecated_string(), expected.matches[i].view.to_deprecated_string());
+                EXPECT_EQ(result.matches[i].global_offset, expected.matches[i].global_offset);
+            }
+        }
+    }
+}
+
+TEST_CASE(literal_prefilter_skips_lines_without_literal)
+{
+    Regex<PosixExtended> re("fail(ed|ure)"sv);
+    EXPECT(re.literal_prefilter.has_value());
+
+    EXPECT_EQ(re.match("everything is fine"sv, PosixFlags::Global).success, false);
+    auto result = re.match("job failed, retry failure"sv, PosixFlags::Global);
+    EXPECT_EQ(result.success, true);
+    EXPECT_EQ(result.matches.size(), 2u);
+    EXPECT_EQ(result.matches[0].view, "failed"sv);
+    EXPECT_EQ(result.matches[1].view, "failure"sv);
+}
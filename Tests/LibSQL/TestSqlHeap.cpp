@@ -12,9 +12,9 @@
 
 static constexpr auto db_path = "/tmp/test.db"sv;
 
-static NonnullRefPtr<SQL::Heap> create_heap()
+static NonnullRefPtr<SQL::Heap> create_heap(u32 block_size = SQL::Block::DEFAULT_SIZE)
 {
-    auto heap = MUST(SQL::Heap::try_create(db_path));
+    auto heap = MUST(SQL::Heap::try_create(db_path, block_size));
     MUST(heap->open());
     return heap;
 }
@@ -191,3 +191,117 @@ TEST_CASE(heap_free_storage)
     auto new_heap_size = MUST(heap->file_size_in_bytes());
     EXPECT(new_heap_size <= heap_size);
 }
+
+TEST_CASE(heap_with_larger_block_size)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+
+    StringBuilder builder;
+    MUST(builder.try_append_repeated('x', SQL::Block::DATA_SIZE * 10));
+    auto long_string = builder.string_view();
+    SQL::Block::Index storage_block_id = 0;
+
+    {
+        auto heap = create_heap(8 * KiB);
+        EXPECT_EQ(heap->block_size(), 8 * KiB);
+        storage_block_id = heap->request_new_block_index();
+        TRY_OR_FAIL(heap->write_storage(storage_block_id, long_string.bytes()));
+        MUST(heap->flush());
+
+        // The zero block plus two blocks for the storage.
+        EXPECT_EQ(MUST(heap->file_size_in_bytes()), 3 * 8 * KiB);
+    }
+
+    // The block size stored in the file wins over the one that is requested.
+    {
+        auto heap = create_heap();
+        EXPECT_EQ(heap->block_size(), 8 * KiB);
+        auto stored_long_string = TRY_OR_FAIL(heap->read_storage(storage_block_id));
+        EXPECT_EQ(long_string.bytes(), stored_long_string.bytes());
+    }
+}
+
+TEST_CASE(heap_buffer_pool_writes_back_evicted_pages)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+    static constexpr size_t storage_count = 64;
+
+    Vector<SQL::Block::Index> storage_block_ids;
+    auto expect_storage = [&](SQL::Heap& heap, size_t index) {
+        auto expected = DeprecatedString::formatted("storage #{}", index);
+        auto stored = TRY_OR_FAIL(heap.read_storage(storage_block_ids[index]));
+        EXPECT_EQ(StringView { stored }, expected.view());
+    };
+
+    {
+        auto heap = create_heap();
+        MUST(heap->set_buffer_pool_capacity(SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY));
+        for (size_t i = 0; i < storage_count; ++i) {
+            storage_block_ids.append(heap->request_new_block_index());
+            auto storage = DeprecatedString::formatted("storage #{}", i);
+            TRY_OR_FAIL(heap->write_storage(storage_block_ids.last(), storage.bytes()));
+        }
+
+        // Without a flush, the pool had to write back dirty pages to make room.
+        EXPECT(heap->statistics().evictions > 0);
+        EXPECT(heap->statistics().page_writes > 0);
+
+        for (size_t i = 0; i < storage_count; ++i)
+            expect_storage(*heap, i);
+    }
+
+    // Everything that was still in the pool is written when the heap goes away.
+    {
+        auto heap = create_heap();
+        for (size_t i = 0; i < storage_count; ++i)
+            expect_storage(*heap, i);
+
+        // A second pass over the same blocks is served from the pool.
+        heap->reset_statistics();
+        for (size_t i = 0; i < storage_count; ++i)
+            expect_storage(*heap, i);
+        EXPECT_EQ(heap->statistics().page_reads, 0u);
+        EXPECT_EQ(heap->statistics().buffer_pool_hits, storage_count);
+    }
+}
+
+TEST_CASE(heap_buffer_pool_recovers_from_failed_reads)
+{
+    ScopeGuard guard([]() { MUST(Core::System::unlink(db_path)); });
+    static constexpr size_t storage_count = 16;
+
+    Vector<SQL::Block::Index> storage_block_ids;
+    auto expect_storage = [&](SQL::Heap& heap, size_t index) {
+        auto expected = DeprecatedString::formatted("storage #{}", index);
+        auto stored = TRY_OR_FAIL(heap.read_storage(storage_block_ids[index]));
+        EXPECT_EQ(StringView { stored }, expected.view());
+    };
+
+    auto heap = create_heap();
+    MUST(heap->set_buffer_pool_capacity(SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY));
+    for (size_t i = 0; i < storage_count; ++i) {
+        storage_block_ids.append(heap->request_new_block_index());
+        auto storage = DeprecatedString::formatted("storage #{}", i);
+        TRY_OR_FAIL(heap->write_storage(storage_block_ids.last(), storage.bytes()));
+    }
+    TRY_OR_FAIL(heap->flush());
+
+    // Fill the pool with the first storages, then cut the last block off the file so that reading it back fails
+    // after a page has already been evicted to make room for it.
+    for (size_t i = 0; i < SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY; ++i)
+        expect_storage(*heap, i);
+    auto file_size = MUST(Core::System::stat(db_path)).st_size;
+    auto fd = MUST(Core::System::open(db_path, O_RDWR));
+    MUST(Core::System::ftruncate(fd, file_size - SQL::Block::DEFAULT_SIZE));
+    MUST(Core::System::close(fd));
+    EXPECT(heap->read_storage(storage_block_ids.last()).is_error());
+
+    // The frame that failed to load must not take the mapping of another block with it when it gets reused, so a
+    // set of pages that fits in the pool stays there once it has been loaded.
+    for (size_t i = 0; i < SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY - 1; ++i)
+        expect_storage(*heap, i);
+    heap->reset_statistics();
+    for (size_t i = 0; i < SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY - 1; ++i)
+        expect_storage(*heap, i);
+    EXPECT_EQ(heap->statistics().page_reads, 0u);
+}
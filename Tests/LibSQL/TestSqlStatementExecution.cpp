@@ -9,6 +9,8 @@
 
 #include <AK/QuickSort.h>
 #include <AK/ScopeGuard.h>
+#include <AK/Time.h>
+#include <LibSQL/AST/Cursor.h>
 #include <LibSQL/AST/Parser.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Result.h>
@@ -1060,4 +1062,321 @@ TEST_CASE(update_all_rows)
     }
 }
 
+void create_indexed_table(NonnullRefPtr<SQL::Database> database, size_t row_count)
+{
+    create_table(database);
+    for (size_t count = 0; count < row_count; ++count) {
+        auto result = execute(database, DeprecatedString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+        EXPECT_EQ(result.size(), 1u);
+    }
+
+    auto result = execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable (IntColumn);");
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Create);
+}
+
+Vector<i32> select_int_column(NonnullRefPtr<SQL::Database> database, StringView where_clause)
+{
+    auto result = execute(database, DeprecatedString::formatted("SELECT IntColumn FROM TestSchema.TestTable WHERE {};", where_clause));
+
+    Vector<i32> values;
+    for (auto& row : result)
+        values.append(row.row[0].to_int<i32>().value());
+    quick_sort(values);
+    return values;
+}
+
+DeprecatedString explain(NonnullRefPtr<SQL::Database> database, StringView sql)
+{
+    auto result = execute(database, DeprecatedString::formatted("EXPLAIN QUERY PLAN {}", sql));
+    EXPECT_EQ(result.command(), SQL::SQLCommand::Explain);
+    EXPECT_EQ(result.size(), 1u);
+    return result[0].row[0].to_deprecated_string();
+}
+
+TEST_CASE(create_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 10);
+
+    auto table = MUST(database->get_table("TESTSCHEMA", "TESTTABLE"));
+    EXPECT_EQ(table->indexes().size(), 1u);
+    EXPECT_EQ(table->indexes()[0]->name(), "INTINDEX");
+
+    auto result = try_execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable (IntColumn);");
+    EXPECT(result.is_error());
+    EXPECT(result.release_error().error() == SQL::SQLErrorCode::IndexExists);
+
+    execute(database, "CREATE INDEX IF NOT EXISTS TestSchema.IntIndex ON TestTable (IntColumn);");
+    EXPECT_EQ(table->indexes().size(), 1u);
+
+    result = try_execute(database, "CREATE INDEX TestSchema.OtherIndex ON TestTable (NoColumn);");
+    EXPECT(result.is_error());
+    EXPECT(result.release_error().error() == SQL::SQLErrorCode::ColumnDoesNotExist);
+    EXPECT_EQ(table->indexes().size(), 1u);
+}
+
+TEST_CASE(select_using_index)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 50);
+
+    auto expect_values = [&](StringView where_clause, Vector<i32> const& expected) {
+        auto values = select_int_column(database, where_clause);
+        EXPECT_EQ(values, expected);
+    };
+
+    expect_values("IntColumn = 17"sv, { 17 });
+    expect_values("17 = IntColumn"sv, { 17 });
+    expect_values("IntColumn = 100"sv, {});
+    expect_values("IntColumn < 3"sv, { 0, 1, 2 });
+    expect_values("IntColumn <= 2"sv, { 0, 1, 2 });
+    expect_values("IntColumn > 46"sv, { 47, 48, 49 });
+    expect_values("IntColumn >= 47"sv, { 47, 48, 49 });
+    expect_values("3 > IntColumn"sv, { 0, 1, 2 });
+    expect_values("(IntColumn > 10) AND (IntColumn < 14)"sv, { 11, 12, 13 });
+    expect_values("(IntColumn >= 10) AND (IntColumn <= 14) AND (TextColumn <> 'T12')"sv, { 10, 11, 13, 14 });
+    expect_values("(IntColumn = 5) AND (TextColumn = 'T5')"sv, { 5 });
+    expect_values("(IntColumn = 5) AND (TextColumn = 'T6')"sv, {});
+    expect_values("(IntColumn = 5) OR (IntColumn = 6)"sv, { 5, 6 });
+}
+
+TEST_CASE(explain_query_plan)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 10);
+
+    EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable;"sv), "SCAN TESTSCHEMA.TESTTABLE");
+    EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable WHERE TextColumn = 'T1';"sv), "SCAN TESTSCHEMA.TESTTABLE");
+    EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable WHERE (IntColumn = 1) OR (IntColumn = 2);"sv), "SCAN TESTSCHEMA.TESTTABLE");
+    EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable WHERE IntColumn = 1;"sv), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+    EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable WHERE (IntColumn > 1) AND (IntColumn < 5);"sv), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN>? AND INTCOLUMN<?)");
+    EXPECT_EQ(explain(database, "UPDATE TestSchema.TestTable SET TextColumn = 'x' WHERE IntColumn = 1;"sv), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+    EXPECT_EQ(explain(database, "DELETE FROM TestSchema.TestTable WHERE IntColumn >= 1;"sv), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN>=?)");
+
+    auto result = try_execute(database, "EXPLAIN INSERT INTO TestSchema.TestTable VALUES ( 'T', 1 );");
+    EXPECT(result.is_error());
+}
+
+TEST_CASE(index_maintenance)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    {
+        auto database = SQL::Database::construct(db_name);
+        MUST(database->open());
+        create_indexed_table(database, 20);
+
+        execute(database, "UPDATE TestSchema.TestTable SET IntColumn = 100 WHERE IntColumn = 3;");
+        EXPECT_EQ(select_int_column(database, "IntColumn = 3"sv), Vector<i32> {});
+        EXPECT_EQ(select_int_column(database, "IntColumn = 100"sv), Vector<i32> { 100 });
+
+        execute(database, "DELETE FROM TestSchema.TestTable WHERE (IntColumn > 7) AND (IntColumn < 11);");
+        EXPECT_EQ(select_int_column(database, "(IntColumn >= 6) AND (IntColumn <= 12)"sv), (Vector<i32> { 6, 7, 11, 12 }));
+
+        execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T9', 9 );");
+        execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T3', 3 );");
+        execute(database, "INSERT INTO TestSchema.TestTable VALUES ( 'T4', 4 );");
+        EXPECT_EQ(select_int_column(database, "(IntColumn >= 2) AND (IntColumn <= 9)"sv), (Vector<i32> { 2, 3, 4, 4, 5, 6, 7, 9 }));
+
+        execute(database, "DELETE FROM TestSchema.TestTable WHERE IntColumn = 4;");
+        EXPECT_EQ(select_int_column(database, "IntColumn = 4"sv), Vector<i32> {});
+        MUST(database->commit());
+    }
+    {
+        auto database = SQL::Database::construct(db_name);
+        MUST(database->open());
+
+        auto table = MUST(database->get_table("TESTSCHEMA", "TESTTABLE"));
+        EXPECT_EQ(table->indexes().size(), 1u);
+
+        EXPECT_EQ(explain(database, "SELECT * FROM TestSchema.TestTable WHERE IntColumn = 1;"sv), "SEARCH TESTSCHEMA.TESTTABLE USING INDEX INTINDEX (INTCOLUMN=?)");
+        EXPECT_EQ(select_int_column(database, "IntColumn < 10"sv), (Vector<i32> { 0, 1, 2, 3, 5, 6, 7, 9 }));
+        EXPECT_EQ(select_int_column(database, "IntColumn >= 0"sv), select_int_column(database, "TextColumn <> ''"sv));
+
+        auto result = execute(database, "SELECT * FROM TestSchema.TestTable;");
+        EXPECT_EQ(result.size(), 18u);
+    }
+}
+
+NonnullOwnPtr<SQL::AST::Cursor> open_cursor(NonnullRefPtr<SQL::Database> database, DeprecatedString const& sql)
+{
+    auto parser = SQL::AST::Parser(SQL::AST::Lexer(sql));
+    auto statement = parser.next_statement();
+    EXPECT(!parser.has_errors());
+
+    auto cursor = SQL::AST::Cursor::open(move(database), move(statement));
+    if (cursor.is_error()) {
+        outln("{}", cursor.release_error().error_string());
+        VERIFY_NOT_REACHED();
+    }
+    return cursor.release_value();
+}
+
+TEST_CASE(cursor_batches)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 100);
+
+    auto cursor = open_cursor(database, "SELECT IntColumn FROM TestSchema.TestTable ORDER BY IntColumn;");
+    EXPECT_EQ(cursor->command(), SQL::SQLCommand::Select);
+    EXPECT_EQ(cursor->column_names(), Vector<DeprecatedString> { "INTCOLUMN" });
+
+    i32 expected = 0;
+    for (auto batch_size : { 1u, 32u, 64u, 64u }) {
+        auto rows = MUST(cursor->next_batch(batch_size));
+        EXPECT(rows.size() <= batch_size);
+        for (auto& row : rows)
+            EXPECT_EQ(row[0].to_int<i32>().value(), expected++);
+    }
+    EXPECT_EQ(expected, 100);
+    EXPECT_EQ(cursor->rows_read(), 100u);
+    EXPECT(!MUST(cursor->has_next()));
+    EXPECT(cursor->is_exhausted());
+}
+
+TEST_CASE(cursor_limit_stops_scan)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 200);
+
+    struct Reads {
+        size_t rows { 0 };
+        size_t blocks { 0 };
+    };
+    auto read_all = [&](DeprecatedString const& sql) {
+        database->heap().reset_statistics();
+        auto cursor = open_cursor(database, sql);
+        auto rows = MUST(cursor->next_batch(1000));
+        auto const& statistics = database->heap().statistics();
+        return Reads { rows.size(), statistics.page_reads + statistics.buffer_pool_hits };
+    };
+
+    auto all = read_all("SELECT * FROM TestSchema.TestTable;");
+    auto limited = read_all("SELECT * FROM TestSchema.TestTable LIMIT 5;");
+    EXPECT_EQ(all.rows, 200u);
+    EXPECT_EQ(limited.rows, 5u);
+    EXPECT(limited.blocks * 10 < all.blocks);
+
+    auto top = read_all("SELECT * FROM TestSchema.TestTable ORDER BY IntColumn LIMIT 5 OFFSET 10;");
+    EXPECT_EQ(top.rows, 5u);
+}
+
+TEST_CASE(cursor_survives_changes_to_table)
+{
+    ScopeGuard guard([]() { unlink(db_name); });
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_indexed_table(database, 20);
+
+    auto read_int_column = [](SQL::AST::Cursor& cursor) {
+        Vector<i32> values;
+        for (auto row = MUST(cursor.next()); row.has_value(); row = MUST(cursor.next()))
+            values.append((*row)[0].to_int<i32>().value());
+        return values;
+    };
+
+    {
+        auto cursor = open_cursor(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE IntColumn >= 10;");
+        auto first_rows = MUST(cursor->next_batch(3));
+        EXPECT_EQ(first_rows.size(), 3u);
+        EXPECT_EQ(first_rows[0][0].to_int<i32>().value(), 10);
+
+        execute(database, "DELETE FROM TestSchema.TestTable WHERE IntColumn = 14;");
+        for (auto count = 0; count < 10; ++count)
+            execute(database, DeprecatedString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'New', {} );", 100 + count));
+
+        auto values = read_int_column(*cursor);
+        EXPECT_EQ(values, (Vector<i32> { 13, 15, 16, 17, 18, 19, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109 }));
+    }
+    {
+        auto cursor = open_cursor(database, "SELECT IntColumn FROM TestSchema.TestTable WHERE TextColumn <> 'New';");
+        auto first_rows = MUST(cursor->next_batch(2));
+        EXPECT_EQ(first_rows.size(), 2u);
+
+        auto next_value = MUST(cursor->next());
+        EXPECT(next_value.has_value());
+        execute(database, DeprecatedString::formatted("DELETE FROM TestSchema.TestTable WHERE IntColumn = {};", (*next_value)[0].to_int<i32>().value() - 1));
+
+        auto values = read_int_column(*cursor);
+        EXPECT_EQ(values.size() + 3, 18u);
+    }
+}
+
+BENCHMARK_CASE(select_page_reads_per_query)
+{
+    static constexpr size_t row_count = 1000;
+    static constexpr size_t query_count = 20;
+    ScopeGuard guard([]() { unlink(db_name); });
+
+    for (u32 block_size : { 1u * KiB, 4u * KiB, 16u * KiB }) {
+        unlink(db_name);
+        {
+            auto database = SQL::Database::construct(db_name, block_size);
+            MUST(database->open());
+            create_table(database);
+            for (size_t count = 0; count < row_count; ++count)
+                execute(database, DeprecatedString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+            MUST(database->commit());
+        }
+
+        for (auto capacity : { SQL::Heap::MINIMUM_BUFFER_POOL_CAPACITY, SQL::Heap::DEFAULT_BUFFER_POOL_CAPACITY }) {
+            auto database = SQL::Database::construct(db_name);
+            MUST(database->open());
+            MUST(database->heap().set_buffer_pool_capacity(capacity));
+
+            size_t first_query_page_reads = 0;
+            database->heap().reset_statistics();
+            for (size_t query = 0; query < query_count; ++query) {
+                auto result = execute(database, DeprecatedString::formatted("SELECT * FROM TestSchema.TestTable WHERE IntColumn = {};", query * 47));
+                EXPECT_EQ(result.size(), 1u);
+                if (query == 0)
+                    first_query_page_reads = database->heap().statistics().page_reads;
+            }
+
+            auto const& statistics = database->heap().statistics();
+            outln("{} byte blocks, pool of {} blocks: {} page reads for the first query, then {} per query ({} buffer pool hits per query)",
+                database->heap().block_size(), capacity, first_query_page_reads,
+                (statistics.page_reads - first_query_page_reads) / (query_count - 1), statistics.buffer_pool_hits / query_count);
+        }
+    }
+}
+
+BENCHMARK_CASE(indexed_lookup_versus_full_scan)
+{
+    static constexpr size_t row_count = 2000;
+    static constexpr size_t query_count = 20;
+    ScopeGuard guard([]() { unlink(db_name); });
+
+    auto database = SQL::Database::construct(db_name);
+    MUST(database->open());
+    create_table(database);
+    for (size_t count = 0; count < row_count; ++count)
+        execute(database, DeprecatedString::formatted("INSERT INTO TestSchema.TestTable VALUES ( 'T{}', {} );", count, count));
+
+    auto run_queries = [&](StringView description) {
+        database->heap().reset_statistics();
+        auto start = MonotonicTime::now();
+        for (size_t query = 0; query < query_count; ++query) {
+            auto result = execute(database, DeprecatedString::formatted("SELECT * FROM TestSchema.TestTable WHERE IntColumn = {};", query * 97));
+            EXPECT_EQ(result.size(), 1u);
+        }
+        auto elapsed = MonotonicTime::now() - start;
+        outln("{}: {} us and {} page reads per query", description,
+            elapsed.to_microseconds() / static_cast<i64>(query_count), database->heap().statistics().page_reads / query_count);
+    };
+
+    run_queries("Full scan"sv);
+    execute(database, "CREATE INDEX TestSchema.IntIndex ON TestTable (IntColumn);");
+    run_queries("Index lookup"sv);
+}
+
 }
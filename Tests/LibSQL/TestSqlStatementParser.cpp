@@ -783,3 +783,51 @@ TEST_CASE(describe_table)
     validate("DESCRIBE TABLE TableName;"sv, {}, "TABLENAME"sv);
     validate("DESCRIBE TABLE SchemaName.TableName;"sv, "SCHEMANAME"sv, "TABLENAME"sv);
 }
+
+TEST_CASE(create_index)
+{
+    EXPECT(parse("CREATE INDEX"sv).is_error());
+    EXPECT(parse("CREATE INDEX index_name;"sv).is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name;"sv).is_error());
+    EXPECT(parse("CREATE INDEX index_name ON table_name ();"sv).is_error());
+    EXPECT(parse("CREATE INDEX IF EXISTS index_name ON table_name (column_name);"sv).is_error());
+
+    auto validate = [](StringView sql, StringView expected_schema, StringView expected_index, StringView expected_table, Vector<StringView> expected_columns, bool expected_is_error_if_index_exists = true) {
+        auto statement = TRY_OR_FAIL(parse(sql));
+        EXPECT(is<SQL::AST::CreateIndex>(*statement));
+
+        auto const& index = static_cast<SQL::AST::CreateIndex const&>(*statement);
+        EXPECT_EQ(index.schema_name(), expected_schema);
+        EXPECT_EQ(index.index_name(), expected_index);
+        EXPECT_EQ(index.table_name(), expected_table);
+        EXPECT_EQ(index.is_error_if_index_exists(), expected_is_error_if_index_exists);
+
+        EXPECT_EQ(index.column_names().size(), expected_columns.size());
+        for (size_t i = 0; i < min(index.column_names().size(), expected_columns.size()); ++i)
+            EXPECT_EQ(index.column_names()[i], expected_columns[i]);
+    };
+
+    validate("CREATE INDEX index_name ON table_name (column_name);"sv, {}, "INDEX_NAME"sv, "TABLE_NAME"sv, { "COLUMN_NAME"sv });
+    validate("CREATE INDEX schema_name.index_name ON table_name (column1, column2);"sv, "SCHEMA_NAME"sv, "INDEX_NAME"sv, "TABLE_NAME"sv, { "COLUMN1"sv, "COLUMN2"sv });
+    validate("CREATE INDEX IF NOT EXISTS index_name ON table_name (column_name);"sv, {}, "INDEX_NAME"sv, "TABLE_NAME"sv, { "COLUMN_NAME"sv }, false);
+}
+
+TEST_CASE(explain)
+{
+    EXPECT(parse("EXPLAIN"sv).is_error());
+    EXPECT(parse("EXPLAIN QUERY;"sv).is_error());
+    EXPECT(parse("EXPLAIN QUERY PLAN;"sv).is_error());
+
+    auto validate = [](StringView sql, auto is_expected_statement) {
+        auto statement = TRY_OR_FAIL(parse(sql));
+        EXPECT(is<SQL::AST::Explain>(*statement));
+
+        auto const& explain = static_cast<SQL::AST::Explain const&>(*statement);
+        EXPECT(is_expected_statement(*explain.statement()));
+    };
+
+    validate("EXPLAIN SELECT * FROM table_name;"sv, [](auto const& statement) { return is<SQL::AST::Select>(statement); });
+    validate("EXPLAIN QUERY PLAN SELECT * FROM table_name WHERE column_name = 1;"sv, [](auto const& statement) { return is<SQL::AST::Select>(statement); });
+    validate("EXPLAIN QUERY PLAN UPDATE table_name SET column_name = 1;"sv, [](auto const& statement) { return is<SQL::AST::Update>(statement); });
+    validate("EXPLAIN DELETE FROM table_name WHERE column_name = 1;"sv, [](auto const& statement) { return is<SQL::AST::Delete>(statement); });
+}
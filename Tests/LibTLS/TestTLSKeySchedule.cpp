@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Hex.h>
+#include <LibTLS/KeySchedule.h>
+#include <LibTest/TestCase.h>
+
+// The "Simple 1-RTT Handshake" trace of RFC 8448, which uses TLS_AES_128_GCM_SHA256 with X25519.
+
+using namespace TLS::KeySchedule;
+
+static constexpr auto sha256 = HashKind::SHA256;
+
+static ByteBuffer hex(StringView string)
+{
+    return MUST(decode_hex(string));
+}
+
+static ByteBuffer const& early()
+{
+    static auto secret = hex("33ad0a1c607ec03b09e6cd9893680ce210adf300aa1f2660e1b22e10f170f92a"sv);
+    return secret;
+}
+
+static ByteBuffer const& handshake_secret()
+{
+    static auto secret = hex("1dc826e93606aa6fdc0aadc12f741b01046aa6b99f691ed221a9f0ca043fbeac"sv);
+    return secret;
+}
+
+static ByteBuffer const& server_handshake_traffic_secret()
+{
+    static auto secret = hex("b67b7d690cc16c4e75e54213cb2d37b4e9c912bcded9105d42befd59d391ad38"sv);
+    return secret;
+}
+
+static ByteBuffer const& master_secret()
+{
+    static auto secret = hex("18df06843d13a08bf2a449844c5f8a478001bc4d4c627984d5a41da8d0402919"sv);
+    return secret;
+}
+
+TEST_CASE(early_secret_without_psk)
+{
+    auto secret = TRY_OR_FAIL(early_secret(sha256, {}));
+    EXPECT_EQ(secret, early());
+}
+
+TEST_CASE(handshake_secret_from_ecdhe)
+{
+    auto derived = TRY_OR_FAIL(derived_secret(sha256, early()));
+    EXPECT_EQ(derived, hex("6f2615a108c702c5678f54fc9dbab69716c076189c48250cebeac3576c3611ba"sv));
+
+    auto shared_secret = hex("8bd4054fb55b9d63fdfbacf9f04b9f0d35e6d63f537563efd46272900f89492d"sv);
+    auto secret = TRY_OR_FAIL(hkdf_extract(sha256, derived, shared_secret));
+    EXPECT_EQ(secret, handshake_secret());
+}
+
+TEST_CASE(handshake_traffic_secrets)
+{
+    // Transcript-Hash(ClientHello, ServerHello)
+    auto transcript_hash = hex("860c06edc07858ee8e78f0e7428c58edd6b43f2ca3e6e95f02ed063cf0e1cad8"sv);
+
+    auto client = TRY_OR_FAIL(derive_secret(sha256, handshake_secret(), "c hs traffic"sv, transcript_hash));
+    EXPECT_EQ(client, hex("b3eddb126e067f35a780b3abf45e2d8f3b1a950738f52e9600746a0e27a55a21"sv));
+
+    auto server = TRY_OR_FAIL(derive_secret(sha256, handshake_secret(), "s hs traffic"sv, transcript_hash));
+    EXPECT_EQ(server, server_handshake_traffic_secret());
+}
+
+TEST_CASE(master_secret_from_handshake_secret)
+{
+    auto derived = TRY_OR_FAIL(derived_secret(sha256, handshake_secret()));
+    EXPECT_EQ(derived, hex("43de77e0c77713859a944db9db2590b53190a65b3ee2e4f12dd7a0bb7ce254b4"sv));
+
+    auto zeros = MUST(ByteBuffer::create_zeroed(32));
+    auto secret = TRY_OR_FAIL(hkdf_extract(sha256, derived, zeros));
+    EXPECT_EQ(secret, master_secret());
+}
+
+TEST_CASE(traffic_key_and_iv)
+{
+    auto key = TRY_OR_FAIL(hkdf_expand_label(sha256, server_handshake_traffic_secret(), "key"sv, {}, 16));
+    EXPECT_EQ(key, hex("3fce516009c21727d0f2e4e86ee403bc"sv));
+
+    auto iv = TRY_OR_FAIL(hkdf_expand_label(sha256, server_handshake_traffic_secret(), "iv"sv, {}, 12));
+    EXPECT_EQ(iv, hex("5d313eb2671276ee13000b30"sv));
+}
+
+TEST_CASE(server_finished)
+{
+    auto finished_key = TRY_OR_FAIL(hkdf_expand_label(sha256, server_handshake_traffic_secret(), "finished"sv, {}, 32));
+    EXPECT_EQ(finished_key, hex("008d3b66f816ea559f96b537e885c31fc068bf492c652f01f288a1d8cdc19fc8"sv));
+
+    // Transcript-Hash(ClientHello, ..., CertificateVerify)
+    auto transcript_hash = hex("edb7725fa7a3473b031ec8ef65a2485493900138a2b91291407d7951a06110ed"sv);
+    auto verify_data = TRY_OR_FAIL(finished_verify_data(sha256, server_handshake_traffic_secret(), transcript_hash));
+    EXPECT_EQ(verify_data, hex("9b9b141d906337fbd2cbdce71df4deda4ab42c309572cb7fffee5454b78f0718"sv));
+}
+
+TEST_CASE(resumption_psk)
+{
+    // Transcript-Hash(ClientHello, ..., client Finished)
+    auto transcript_hash = hex("209145a96ee8e2a122ff810047cc952684658d6049e86429426db87c54ad143d"sv);
+    auto resumption_master_secret = TRY_OR_FAIL(derive_secret(sha256, master_secret(), "res master"sv, transcript_hash));
+    EXPECT_EQ(resumption_master_secret, hex("7df235f2031d2a051287d02b0241b0bfdaf86cc856231f2d5aba46c434ec196c"sv));
+
+    // The ticket nonce of the NewSessionTicket is 0x0000.
+    u8 const ticket_nonce[] = { 0, 0 };
+    auto psk = TRY_OR_FAIL(hkdf_expand_label(sha256, resumption_master_secret, "resumption"sv, { ticket_nonce, sizeof(ticket_nonce) }, 32));
+    EXPECT_EQ(psk, hex("4ecd0eb6ec3b4d87f5d6028f922ca4c5851a277fd41311c9e62d2c9492e1c4f3"sv));
+}
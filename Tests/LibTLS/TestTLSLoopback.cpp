@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "LoopbackServer.h"
+#include <LibCore/EventLoop.h>
+#include <LibTLS/SessionCache.h>
+#include <LibTLS/TLSv12.h>
+#include <LibTest/TestCase.h>
+
+static constexpr auto test_message = "Hello, friends!"sv;
+
+static Vector<Certificate> test_root_certificates()
+{
+    auto pem = MUST(ByteBuffer::copy(LoopbackTLS::ca_certificate_pem.bytes()));
+    return MUST(DefaultRootCACertificates::parse_pem_root_certificate_authorities(pem));
+}
+
+static TLS::Options test_options()
+{
+    TLS::Options options;
+    options.set_root_certificates(test_root_certificates());
+    return options;
+}
+
+// Connects to the server, has it echo a message and closes the connection again.
+static ErrorOr<void> exchange_message(LoopbackTLS::Server& server, TLS::Options options = test_options())
+{
+    Core::EventLoop loop;
+    auto tls = TRY(TLS::TLSv12::connect("localhost", server.port(), move(options)));
+
+    ByteBuffer received;
+    tls->on_ready_to_read = [&] {
+        u8 buffer[4 * KiB];
+        auto read_bytes = tls->read_some(buffer);
+        if (read_bytes.is_error() || read_bytes.value().is_empty()) {
+            loop.quit(1);
+            return;
+        }
+        received.append(read_bytes.value());
+        if (received.size() >= test_message.length())
+            loop.quit(0);
+    };
+
+    TRY(tls->write_until_depleted(test_message.bytes()));
+    if (loop.exec() != 0)
+        return Error::from_string_literal("The server did not echo the message");
+    if (received.bytes() != test_message.bytes())
+        return Error::from_string_literal("The server echoed something else");
+
+    tls->close();
+    // Let the socket handle whatever it deferred before it goes away.
+    loop.pump(Core::EventLoop::WaitMode::PollForEvents);
+    return {};
+}
+
+static Vector<LoopbackTLS::Connection> run_connections(LoopbackTLS::ServerOptions server_options, size_t count, TLS::Options (*make_options)() = test_options)
+{
+    TLS::SessionCache::the().clear();
+    auto server = MUST(LoopbackTLS::Server::create(move(server_options)));
+    for (size_t i = 0; i < count; ++i) {
+        if (auto result = exchange_message(*server, make_options()); result.is_error()) {
+            FAIL(DeprecatedString::formatted("Connection {} failed: {}", i, result.error()));
+            break;
+        }
+    }
+    auto connections = server->finish();
+    EXPECT_EQ(connections.size(), count);
+    for (auto& connection : connections) {
+        if (!connection.error.is_empty())
+            FAIL(DeprecatedString::formatted("Server error: {}", connection.error));
+        EXPECT(connection.handshake_finished);
+        EXPECT_EQ(connection.application_data.bytes(), test_message.bytes());
+    }
+    return connections;
+}
+
+static void test_cipher_suite(TLS::ProtocolVersion version, TLS::CipherSuite suite)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.max_version = version;
+    server_options.cipher_suites = { suite };
+    auto connections = run_connections(move(server_options), 1);
+    if (connections.size() != 1)
+        return;
+    EXPECT(connections[0].version == version);
+    EXPECT(connections[0].cipher == suite);
+    EXPECT(!connections[0].resumed);
+}
+
+TEST_CASE(tls12_aes_128_gcm)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_2, TLS::CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256);
+}
+
+TEST_CASE(tls12_aes_256_gcm)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_2, TLS::CipherSuite::TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384);
+}
+
+TEST_CASE(tls12_chacha20_poly1305)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_2, TLS::CipherSuite::TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
+}
+
+TEST_CASE(tls13_aes_128_gcm)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_3, TLS::CipherSuite::TLS_AES_128_GCM_SHA256);
+}
+
+TEST_CASE(tls13_aes_256_gcm)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_3, TLS::CipherSuite::TLS_AES_256_GCM_SHA384);
+}
+
+TEST_CASE(tls13_chacha20_poly1305)
+{
+    test_cipher_suite(TLS::ProtocolVersion::VERSION_1_3, TLS::CipherSuite::TLS_CHACHA20_POLY1305_SHA256);
+}
+
+TEST_CASE(close_notify_is_a_warning)
+{
+    for (auto version : { TLS::ProtocolVersion::VERSION_1_2, TLS::ProtocolVersion::VERSION_1_3 }) {
+        LoopbackTLS::ServerOptions server_options;
+        server_options.max_version = version;
+        auto connections = run_connections(move(server_options), 1);
+        if (connections.size() == 1)
+            EXPECT(connections[0].close_notify_level == TLS::AlertLevel::WARNING);
+    }
+}
+
+TEST_CASE(client_flight_is_sent_at_once)
+{
+    for (auto version : { TLS::ProtocolVersion::VERSION_1_2, TLS::ProtocolVersion::VERSION_1_3 }) {
+        LoopbackTLS::ServerOptions server_options;
+        server_options.max_version = version;
+        auto connections = run_connections(move(server_options), 1);
+        if (connections.size() == 1)
+            EXPECT(connections[0].client_flight_in_one_read);
+    }
+}
+
+TEST_CASE(reject_bad_server_finished)
+{
+    for (auto version : { TLS::ProtocolVersion::VERSION_1_2, TLS::ProtocolVersion::VERSION_1_3 }) {
+        TLS::SessionCache::the().clear();
+        LoopbackTLS::ServerOptions server_options;
+        server_options.max_version = version;
+        server_options.corrupt_finished = true;
+        auto server = MUST(LoopbackTLS::Server::create(move(server_options)));
+        EXPECT(exchange_message(*server).is_error());
+        auto connections = server->finish();
+        EXPECT_EQ(connections.size(), 1u);
+        if (connections.size() == 1)
+            EXPECT(connections[0].application_data.is_empty());
+    }
+}
+
+TEST_CASE(reject_downgrade_from_tls13)
+{
+    TLS::SessionCache::the().clear();
+    LoopbackTLS::ServerOptions server_options;
+    server_options.max_version = TLS::ProtocolVersion::VERSION_1_2;
+    server_options.send_downgrade_sentinel = true;
+    auto server = MUST(LoopbackTLS::Server::create(move(server_options)));
+    EXPECT(exchange_message(*server).is_error());
+
+    // A client that only speaks TLS 1.2 itself has no reason to care.
+    auto options = test_options();
+    options.set_max_version(TLS::ProtocolVersion::VERSION_1_2);
+    TRY_OR_FAIL(exchange_message(*server, move(options)));
+    server->finish();
+}
+
+TEST_CASE(tls13_hello_retry_request)
+{
+    // The client sends its key share for X25519, the server asks for P-256 instead.
+    LoopbackTLS::ServerOptions server_options;
+    server_options.key_share_groups = { TLS::SupportedGroup::SECP256R1 };
+    auto connections = run_connections(move(server_options), 1);
+    if (connections.size() == 1) {
+        EXPECT(connections[0].hello_retry_requested);
+        EXPECT(connections[0].version == TLS::ProtocolVersion::VERSION_1_3);
+    }
+}
+
+TEST_CASE(tls13_certificate_request)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.request_client_certificate = true;
+    run_connections(move(server_options), 1);
+}
+
+TEST_CASE(tls13_key_update)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.send_key_update = true;
+    auto connections = run_connections(move(server_options), 1);
+    if (connections.size() == 1)
+        EXPECT(connections[0].client_updated_keys);
+}
+
+static void test_resumption(LoopbackTLS::ServerOptions server_options)
+{
+    auto connections = run_connections(move(server_options), 3);
+    if (connections.size() != 3)
+        return;
+    EXPECT(!connections[0].resumed);
+    EXPECT(connections[1].resumed);
+    EXPECT(connections[2].resumed);
+    EXPECT(connections[1].cipher == connections[0].cipher);
+}
+
+TEST_CASE(tls12_resumption_with_session_id)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.max_version = TLS::ProtocolVersion::VERSION_1_2;
+    server_options.issue_session_tickets = false;
+    test_resumption(move(server_options));
+}
+
+TEST_CASE(tls12_resumption_with_session_ticket)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.max_version = TLS::ProtocolVersion::VERSION_1_2;
+    server_options.issue_session_ids = false;
+    test_resumption(move(server_options));
+}
+
+TEST_CASE(tls13_resumption_with_psk)
+{
+    test_resumption({});
+}
+
+TEST_CASE(no_resumption_when_disabled)
+{
+    auto connections = run_connections({}, 2, [] {
+        auto options = test_options();
+        options.set_resume_sessions(false);
+        return options;
+    });
+    for (auto& connection : connections)
+        EXPECT(!connection.resumed);
+}
+
+// A resumed session skips the certificate checks, so it must not outlive the settings it was checked under.
+TEST_CASE(no_resumption_with_stricter_validation)
+{
+    Vector<TLS::Options (*)()> lenient_options {
+        [] {
+            TLS::Options options;
+            options.set_validate_certificates(false);
+            return options;
+        },
+        [] {
+            TLS::Options options;
+            options.set_allow_self_signed_certificates(true);
+            options.set_root_certificates(test_root_certificates());
+            return options;
+        },
+        test_options,
+    };
+
+    for (auto version : { TLS::ProtocolVersion::VERSION_1_2, TLS::ProtocolVersion::VERSION_1_3 }) {
+        for (auto make_options : lenient_options) {
+            TLS::SessionCache::the().clear();
+            LoopbackTLS::ServerOptions server_options;
+            server_options.max_version = version;
+            auto server = MUST(LoopbackTLS::Server::create(move(server_options)));
+            TRY_OR_FAIL(exchange_message(*server, make_options()));
+            // The default root certificates don't include the test CA.
+            EXPECT(exchange_message(*server, TLS::Options {}).is_error());
+            auto connections = server->finish();
+            EXPECT_EQ(connections.size(), 2u);
+            for (auto& connection : connections)
+                EXPECT(!connection.resumed);
+        }
+    }
+}
+
+// Handshake latency, with the server on the same machine this is about all the CPU time a handshake costs.
+
+static void measure_handshakes(TLS::ProtocolVersion version, bool resume)
+{
+    LoopbackTLS::ServerOptions server_options;
+    server_options.max_version = version;
+    auto connections = run_connections(move(server_options), 50, resume ? test_options : [] {
+        auto options = test_options();
+        options.set_resume_sessions(false);
+        return options;
+    });
+    for (size_t i = 1; i < connections.size(); ++i)
+        EXPECT_EQ(connections[i].resumed, resume);
+}
+
+BENCHMARK_CASE(tls12_full_handshakes)
+{
+    measure_handshakes(TLS::ProtocolVersion::VERSION_1_2, false);
+}
+
+BENCHMARK_CASE(tls12_resumed_handshakes)
+{
+    measure_handshakes(TLS::ProtocolVersion::VERSION_1_2, true);
+}
+
+BENCHMARK_CASE(tls13_full_handshakes)
+{
+    measure_handshakes(TLS::ProtocolVersion::VERSION_1_3, false);
+}
+
+BENCHMARK_CASE(tls13_resumed_handshakes)
+{
+    measure_handshakes(TLS::ProtocolVersion::VERSION_1_3, true);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibCore/EventLoop.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/BackgroundAction.h>
+#include <LibThreading/Mutex.h>
+#include <unistd.h>
+
+// Workers may still be handing actions back to the event loop after their callbacks ran, so it outlives every test.
+static Core::EventLoop& event_loop()
+{
+    static auto* event_loop = new Core::EventLoop;
+    return *event_loop;
+}
+
+TEST_CASE(actions_run_one_at_a_time_in_order)
+{
+    auto& loop = event_loop();
+
+    static constexpr int action_count = 16;
+    Threading::Mutex mutex;
+    Vector<int> order;
+    Atomic<int> running { 0 };
+    Atomic<int> most_running_at_once { 0 };
+    int completed = 0;
+
+    for (int i = 0; i < action_count; ++i) {
+        (void)Threading::BackgroundAction<int>::construct(
+            [&, i](auto&) -> ErrorOr<int> {
+                auto now_running = ++running;
+                if (now_running > most_running_at_once)
+                    most_running_at_once = now_running;
+                usleep(1000);
+                {
+                    Threading::MutexLocker locker(mutex);
+                    order.append(i);
+                }
+                --running;
+                return i;
+            },
+            [&](int) -> ErrorOr<void> {
+                ++completed;
+                return {};
+            });
+    }
+    loop.spin_until([&] { return completed == action_count; });
+
+    EXPECT_EQ(most_running_at_once.load(), 1);
+    EXPECT_EQ(order.size(), static_cast<size_t>(action_count));
+    for (int i = 0; i < action_count; ++i)
+        EXPECT_EQ(order[i], i);
+}
+
+TEST_CASE(actions_can_run_on_the_thread_pool)
+{
+    auto& loop = event_loop();
+
+    static constexpr int action_count = 16;
+    Atomic<int> sum { 0 };
+    int completed = 0;
+
+    for (int i = 0; i < action_count; ++i) {
+        (void)Threading::BackgroundAction<int>::construct(
+            [&, i](auto&) -> ErrorOr<int> {
+                sum += i;
+                return i;
+            },
+            [&](int) -> ErrorOr<void> {
+                ++completed;
+                return {};
+            },
+            OptionalNone {}, Threading::BackgroundActionExecutor::ThreadPool);
+    }
+    loop.spin_until([&] { return completed == action_count; });
+
+    EXPECT_EQ(sum.load(), action_count * (action_count - 1) / 2);
+}
+
+TEST_CASE(canceled_actions_do_not_run)
+{
+    auto& loop = event_loop();
+
+    Atomic<bool> blocker_may_finish { false };
+    Atomic<bool> canceled_action_ran { false };
+    bool got_error = false;
+    bool done = false;
+
+    // Keep the background thread busy so that the next action is still queued when it gets canceled.
+    (void)Threading::BackgroundAction<int>::construct(
+        [&](auto&) -> ErrorOr<int> {
+            while (!blocker_may_finish)
+                usleep(100);
+            return 0;
+        },
+        nullptr);
+
+    auto action = Threading::BackgroundAction<int>::construct(
+        [&](auto&) -> ErrorOr<int> {
+            canceled_action_ran = true;
+            return 0;
+        },
+        nullptr,
+        [&](Error) {
+            got_error = true;
+        });
+    action->cancel();
+    blocker_may_finish = true;
+
+    (void)Threading::BackgroundAction<int>::construct(
+        [](auto&) -> ErrorOr<int> { return 0; },
+        [&](int) -> ErrorOr<void> {
+            done = true;
+            return {};
+        });
+    loop.spin_until([&] { return done; });
+
+    EXPECT(!canceled_action_ran);
+    EXPECT(got_error);
+}
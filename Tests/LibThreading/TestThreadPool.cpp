@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <LibTest/TestCase.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/ThreadPool.h>
+#include <time.h>
+#include <unistd.h>
+
+using Priority = Threading::ThreadPool::Priority;
+
+// Occupies the only worker of a pool until the returned flag is set, so that tasks submitted meanwhile stay queued.
+static NonnullOwnPtr<Atomic<bool>> block_worker(Threading::ThreadPool& pool)
+{
+    auto release = make<Atomic<bool>>(false);
+    Atomic<bool> started { false };
+    MUST(pool.submit([&started, &release = *release] {
+        started = true;
+        while (!release)
+            usleep(1000);
+    }));
+    while (!started)
+        usleep(1000);
+    return release;
+}
+
+TEST_CASE(all_tasks_run)
+{
+    auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(4));
+    Atomic<size_t> count { 0 };
+    for (size_t i = 0; i < 1000; ++i)
+        TRY_OR_FAIL(pool->submit([&count] { ++count; }));
+    pool->wait_until_idle();
+    EXPECT_EQ(count.load(), 1000u);
+}
+
+TEST_CASE(tasks_can_submit_tasks)
+{
+    auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(4));
+    Atomic<size_t> count { 0 };
+    for (size_t i = 0; i < 10; ++i) {
+        TRY_OR_FAIL(pool->submit([&pool, &count] {
+            for (size_t j = 0; j < 100; ++j)
+                MUST(pool->submit([&count] { ++count; }));
+        }));
+    }
+    pool->wait_until_idle();
+    EXPECT_EQ(count.load(), 1000u);
+}
+
+TEST_CASE(higher_priority_tasks_start_first)
+{
+    auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(1));
+    auto release = block_worker(*pool);
+
+    Threading::Mutex mutex;
+    Vector<Priority> order;
+    for (auto priority : { Priority::Low, Priority::Normal, Priority::High, Priority::Normal }) {
+        TRY_OR_FAIL(pool->submit([&, priority] {
+            Threading::MutexLocker locker(mutex);
+            order.append(priority);
+        },
+            priority));
+    }
+
+    *release = true;
+    pool->wait_until_idle();
+    EXPECT_EQ(order, (Vector<Priority> { Priority::High, Priority::Normal, Priority::Normal, Priority::Low }));
+}
+
+TEST_CASE(canceled_tasks_do_not_run)
+{
+    auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(1));
+    auto release = block_worker(*pool);
+
+    Atomic<bool> did_run { false };
+    auto task = TRY_OR_FAIL(pool->submit([&did_run] { did_run = true; }));
+    EXPECT(task->cancel());
+    EXPECT(task->is_canceled());
+
+    *release = true;
+    pool->wait_until_idle();
+    EXPECT(!did_run);
+    EXPECT(!task->is_finished());
+}
+
+TEST_CASE(finished_tasks_cannot_be_canceled)
+{
+    auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(1));
+    auto task = TRY_OR_FAIL(pool->submit([] {}));
+    pool->wait_until_idle();
+    EXPECT(task->is_finished());
+    EXPECT(!task->cancel());
+}
+
+TEST_CASE(destroying_the_pool_runs_queued_tasks)
+{
+    Atomic<size_t> count { 0 };
+    {
+        auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(2));
+        for (size_t i = 0; i < 100; ++i)
+            TRY_OR_FAIL(pool->submit([&count] { ++count; }));
+    }
+    EXPECT_EQ(count.load(), 100u);
+}
+
+static i64 nanoseconds_since(timespec const& start)
+{
+    timespec end {};
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return max<i64>((Duration::from_timespec(end) - Duration::from_timespec(start)).to_nanoseconds(), 1);
+}
+
+BENCHMARK_CASE(task_dispatch_overhead)
+{
+    static constexpr size_t task_count = 100'000;
+
+    for (size_t thread_count : { 1, 2, 4 }) {
+        auto pool = TRY_OR_FAIL(Threading::ThreadPool::try_create(thread_count));
+        Atomic<size_t> count { 0 };
+
+        timespec start {};
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < task_count; ++i)
+            TRY_OR_FAIL(pool->submit([&count] { ++count; }));
+        pool->wait_until_idle();
+        auto from_outside_ns = nanoseconds_since(start);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        TRY_OR_FAIL(pool->submit([&pool, &count] {
+            for (size_t i = 0; i < task_count; ++i)
+                MUST(pool->submit([&count] { ++count; }));
+        }));
+        pool->wait_until_idle();
+        auto from_worker_ns = nanoseconds_since(start);
+
+        EXPECT_EQ(count.load(), 2 * task_count);
+        outln("{} threads: {} ns per task submitted from outside, {} ns per task submitted from a worker",
+            thread_count, from_outside_ns / task_count, from_worker_ns / task_count);
+    }
+}
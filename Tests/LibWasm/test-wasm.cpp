@@ -47,6 +47,7 @@ public:
         : JS::Object(ConstructWithPrototypeTag::Tag, prototype)
     {
         m_machine.enable_instruction_count_limit();
+        m_machine.enable_guard_pages_for_memories();
     }
 
     static Wasm::AbstractMachine& machine() { return m_machine; }
@@ -394,6 +394,9 @@ void BrowserWindow::build_menus()
     debug_menu.add_action(GUI::Action::create("Collect &Garbage", { Mod_Ctrl | Mod_Shift, Key_G }, g_icon_bag.trash_can, [this](auto&) {
         active_tab().view().debug_request("collect-garbage");
     }));
+    debug_menu.add_action(GUI::Action::create("Dump GC Stat"Dump GC &Statistics"istics", [this](auto&) {
+        active_tab().view().debug_request("dump-gc-statistics");
+    }));
     debug_menu.add_action(GUI::Action::create("Clear &Cache", { Mod_Ctrl | Mod_Shift, Key_C }, g_icon_bag.clear_cache, [this](auto&) {
         active_tab().view().debug_request("clear-cache");
     }));
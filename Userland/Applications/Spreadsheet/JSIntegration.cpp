@@ -96,6 +96,7 @@ SheetGlobalObject::SheetGlobalObject(JS::Realm& realm, Sheet& sheet)
     : JS::GlobalObject(realm)
     , m_sheet(sheet)
 {
+    m_may_interfere_with_property_lookup_caching = true;
 }
 
 JS::ThrowCompletionOr<bool> SheetGlobalObject::internal_has_property(JS::PropertyKey const& name) const
@@ -7,10 +7,12 @@
 
 #include <AK/Array.h>
 #include <AK/Assertions.h>
+#include <AK/Atomic.h>
 #include <AK/BinaryHeap.h>
 #include <AK/BinarySearch.h>
 #include <AK/BitStream.h>
 #include <AK/MemoryStream.h>
+#include <LibThreading/WorkerThread.h>
 #include <string.h>
 
 #include <LibCompress/Deflate.h>
@@ -51,8 +53,6 @@ CanonicalCode const& CanonicalCode::fixed_distance_codes()
 
 ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
 {
-    // FIXME: I can't quite follow the algorithm here, but it seems to work.
-
     CanonicalCode code;
 
     auto non_zero_symbols = 0;
@@ -65,9 +65,11 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
     }
 
     if (non_zero_symbols == 1) { // special case - only 1 symbol
-        code.m_prefix_table[0] = PrefixTableEntry { static_cast<u16>(last_non_zero), 1u };
-        code.m_prefix_table[1] = code.m_prefix_table[0];
-        code.m_max_prefixed_code_length = 1;
+        TRY(code.m_decode_table.try_resize(2));
+        code.m_decode_table[0] = DecodeEntry { .symbol = static_cast<u16>(last_non_zero), .code_length = 1 };
+        code.m_decode_table[1] = code.m_decode_table[0];
+        code.m_primary_bits = 1;
+        code.m_max_code_length = 1;
 
         if (code.m_bit_codes.size() < static_cast<size_t>(last_non_zero + 1)) {
             TRY(code.m_bit_codes.try_resize(last_non_zero + 1));
@@ -79,16 +81,9 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
         return code;
     }
 
-    struct PrefixCode {
-        u16 symbol_code { 0 };
-        u16 symbol_value { 0 };
-        u16 code_length { 0 };
-    };
-    Array<PrefixCode, 1 << CanonicalCode::max_allowed_prefixed_code_length> prefix_codes;
-    size_t number_of_prefix_codes = 0;
-
+    // Assign the codes as described in RFC 1951, 3.2.2.
     auto next_code = 0;
-    for (size_t code_length = 1; code_length <= 15; ++code_length) {
+    for (size_t code_length = 1; code_length <= max_code_length; ++code_length) {
         next_code <<= 1;
         auto start_bit = 1 << code_length;
 
@@ -99,70 +94,97 @@ ErrorOr<CanonicalCode> CanonicalCode::from_bytes(ReadonlyBytes bytes)
             if (next_code > start_bit)
                 return Error::from_string_literal("Failed to decode code lengths");
 
-            if (code_length <= CanonicalCode::max_allowed_prefixed_code_length) {
-                auto& prefix_code = prefix_codes[number_of_prefix_codes++];
-                prefix_code.symbol_code = next_code;
-                prefix_code.symbol_value = symbol;
-                prefix_code.code_length = code_length;
-
-                code.m_max_prefixed_code_length = code_length;
-            } else {
-                code.m_symbol_codes.append(start_bit | next_code);
-                code.m_symbol_values.append(symbol);
-            }
-
             if (code.m_bit_codes.size() < symbol + 1) {
                 TRY(code.m_bit_codes.try_resize(symbol + 1));
                 TRY(code.m_bit_code_lengths.try_resize(symbol + 1));
             }
             code.m_bit_codes[symbol] = fast_reverse16(start_bit | next_code, code_length); // DEFLATE writes huffman encoded symbols as lsb-first
             code.m_bit_code_lengths[symbol] = code_length;
+            code.m_max_code_length = code_length;
 
             next_code++;
         }
     }
 
-    if (next_code != (1 << 15))
+    if (next_code != (1 << max_code_length))
         return Error::from_string_literal("Failed to decode code lengths");
 
-    for (auto [symbol_code, symbol_value, code_length] : prefix_codes) {
-        if (code_length == 0 || code_length > CanonicalCode::max_allowed_prefixed_code_length)
-            break;
+    // Since the codes are stored lsb-first, the next bits of the stream can be used directly as an index into the decode table.
+    // A code of length L shows up in every 2^L'th entry of the primary table, and codes that are longer than the primary table
+    // continue in a subtable that is sized for the longest code sharing that prefix.
+    code.m_primary_bits = min(code.m_max_code_length, max_primary_bits);
+    auto const primary_size = 1u << code.m_primary_bits;
+    auto const primary_mask = primary_size - 1;
+
+    Array<u8, 1 << max_primary_bits> subtable_bits {};
+    for (size_t symbol = 0; symbol < code.m_bit_codes.size(); ++symbol) {
+        auto length = code.m_bit_code_lengths[symbol];
+        if (length > code.m_primary_bits) {
+            auto& bits = subtable_bits[code.m_bit_codes[symbol] & primary_mask];
+            bits = max<u8>(bits, length - code.m_primary_bits);
+        }
+    }
 
-        auto shift = code.m_max_prefixed_code_length - code_length;
-        symbol_code <<= shift;
+    size_t table_size = primary_size;
+    for (size_t prefix = 0; prefix < primary_size; ++prefix) {
+        if (subtable_bits[prefix] != 0)
+            table_size += 1u << subtable_bits[prefix];
+    }
+    TRY(code.m_decode_table.try_resize(table_size));
 
-        for (size_t j = 0; j < (1u << shift); ++j) {
-            auto index = fast_reverse16(symbol_code + j, code.m_max_prefixed_code_length);
-            code.m_prefix_table[index] = PrefixTableEntry { symbol_value, code_length };
-        }
+    size_t subtable_offset = primary_size;
+    for (size_t prefix = 0; prefix < primary_size; ++prefix) {
+        if (subtable_bits[prefix] == 0)
+            continue;
+        code.m_decode_table[prefix] = DecodeEntry { .symbol = static_cast<u16>(subtable_offset), .code_length = static_cast<u8>(code.m_primary_bits), .subtable_bits = subtable_bits[prefix] };
+        subtable_offset += 1u << subtable_bits[prefix];
     }
 
-    return code;
-}
+    for (size_t symbol = 0; symbol < code.m_bit_codes.size(); ++symbol) {
+        size_t length = code.m_bit_code_lengths[symbol];
+        if (length == 0)
+            continue;
+        size_t bit_code = code.m_bit_codes[symbol];
+        DecodeEntry const entry { .symbol = static_cast<u16>(symbol), .code_length = static_cast<u8>(length) };
 
-ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
-{
-    auto prefix = TRY(stream.peek_bits<size_t>(m_max_prefixed_code_length));
+        if (length <= code.m_primary_bits) {
+            for (size_t index = bit_code; index < primary_size; index += 1u << length)
+                code.m_decode_table[index] = entry;
+            continue;
+        }
 
-    if (auto [symbol_value, code_length] = m_prefix_table[prefix]; code_length != 0) {
-        stream.discard_previously_peeked_bits(code_length);
-        return symbol_value;
+        auto const& subtable = code.m_decode_table[bit_code & primary_mask];
+        auto subtable_length = length - code.m_primary_bits;
+        for (size_t index = bit_code >> code.m_primary_bits; index < (1u << subtable.subtable_bits); index += 1u << subtable_length)
+            code.m_decode_table[subtable.symbol + index] = entry;
     }
 
-    auto code_bits = TRY(stream.read_bits<u16>(m_max_prefixed_code_length));
-    code_bits = fast_reverse16(code_bits, m_max_prefixed_code_length);
-    code_bits |= 1 << m_max_prefixed_code_length;
+    // Let a lookup in the primary table return two literals at once if the second one is short enough to be covered by it as well.
+    for (size_t index = 0; index < primary_size; ++index) {
+        auto& entry = code.m_decode_table[index];
+        if (entry.subtable_bits != 0 || entry.symbol >= 256 || entry.code_length == code.m_primary_bits)
+            continue;
 
-    for (size_t i = m_max_prefixed_code_length; i < 16; ++i) {
-        size_t index;
-        if (binary_search(m_symbol_codes.span(), code_bits, &index))
-            return m_symbol_values[index];
+        auto const& next_entry = code.m_decode_table[index >> entry.code_length];
+        if (next_entry.subtable_bits != 0 || next_entry.symbol >= 256 || entry.code_length + next_entry.code_length > code.m_primary_bits)
+            continue;
 
-        code_bits = code_bits << 1 | TRY(stream.read_bit());
+        entry.second_symbol = next_entry.symbol;
+        entry.total_length = entry.code_length + next_entry.code_length;
     }
 
-    return Error::from_string_literal("Symbol exceeds maximum symbol number");
+    return code;
+}
+
+ErrorOr<u32> CanonicalCode::read_symbol(LittleEndianInputBitStream& stream) const
+{
+    auto bits = TRY(stream.peek_bits<u64>(m_max_code_length));
+    auto const& entry = decode_entry(bits);
+    if (entry.code_length == 0)
+        return Error::from_string_literal("Symbol exceeds maximum symbol number");
+
+    stream.discard_previously_peeked_bits(entry.code_length);
+    return entry.symbol;
 }
 
 ErrorOr<void> CanonicalCode::write_symbol(LittleEndianOutputBitStream& stream, u32 symbol) const
@@ -185,6 +207,111 @@ ErrorOr<bool> DeflateDecompressor::CompressedBlock::try_read_more()
     if (m_eof == true)
         return false;
 
+    if (TRY(read_symbols_quickly()) > 0)
+        return true;
+    if (m_eof == true)
+        return false;
+
+    return read_symbol_carefully();
+}
+
+// Decodes symbols for as long as the bit buffer is guaranteed to hold a complete back reference and the output buffer has
+// space for one, which lets us skip all the bounds checks that read_symbol_carefully() has to do.
+// Returns the number of bytes that were written to the output buffer.
+ErrorOr<size_t> DeflateDecompressor::CompressedBlock::read_symbols_quickly()
+{
+    auto& input_stream = *m_decompressor.m_input_stream;
+    auto& output_buffer = m_decompressor.m_output_buffer;
+
+    // Literals are collected here first, so we don't have to write them to the circular buffer one by one.
+    Array<u8, 256> literals;
+    size_t literal_count = 0;
+    size_t total_written = 0;
+
+    // The space that is left in the output buffer once the staged literals have been written out.
+    size_t output_space = output_buffer.empty_space();
+
+    auto flush_literals = [&] {
+        auto written = output_buffer.write(literals.span().trim(literal_count));
+        VERIFY(written == literal_count);
+        total_written += written;
+        literal_count = 0;
+    };
+
+    while (!m_eof) {
+        auto bits = TRY(input_stream.peek_bits<u64>(NumericLimits<u64>::digits()));
+        auto bit_count = input_stream.buffered_bit_count();
+        if (bit_count < max_back_reference_bit_length)
+            break;
+
+        size_t consumed_bits = 0;
+        while (output_space >= max_back_reference_length) {
+            if (literal_count + 2 > literals.size())
+                flush_literals();
+
+            auto const& entry = m_literal_codes.decode_entry(bits);
+            if (entry.total_length != 0) {
+                literals[literal_count++] = entry.symbol;
+                literals[literal_count++] = entry.second_symbol;
+                output_space -= 2;
+                bits >>= entry.total_length;
+                consumed_bits += entry.total_length;
+            } else if (entry.symbol < 256) {
+                literals[literal_count++] = entry.symbol;
+                output_space -= 1;
+                bits >>= entry.code_length;
+                consumed_bits += entry.code_length;
+            } else if (entry.symbol == 256) {
+                consumed_bits += entry.code_length;
+                m_eof = true;
+                break;
+            } else {
+                if (bit_count - consumed_bits <= max_back_reference_bit_length)
+                    break;
+                if (entry.symbol >= 286)
+                    return Error::from_string_literal("Invalid deflate literal/length symbol");
+                if (!m_distance_codes.has_value())
+                    return Error::from_string_literal("Distance codes have not been initialized");
+
+                auto const& length_symbol = packed_length_symbols[entry.symbol - 257];
+                bits >>= entry.code_length;
+                size_t length = length_symbol.base_length + (bits & ((1u << length_symbol.extra_bits) - 1));
+                bits >>= length_symbol.extra_bits;
+
+                auto const& distance_entry = m_distance_codes->decode_entry(bits);
+                if (distance_entry.symbol >= 30)
+                    return Error::from_string_literal("Invalid deflate distance symbol");
+                auto const& distance_symbol = packed_distances[distance_entry.symbol];
+                bits >>= distance_entry.code_length;
+                size_t distance = distance_symbol.base_distance + (bits & ((1u << distance_symbol.extra_bits) - 1));
+                bits >>= distance_symbol.extra_bits;
+
+                consumed_bits += entry.code_length + length_symbol.extra_bits + distance_entry.code_length + distance_symbol.extra_bits;
+
+                flush_literals();
+                auto copied_length = TRY(output_buffer.copy_from_seekback(distance, length));
+                VERIFY(copied_length == length);
+                output_space -= length;
+                total_written += length;
+            }
+
+            // Always leave at least one bit in the buffer: Discarding all 64 of them would shift the bit buffer by its
+            // whole width, which doesn't clear it.
+            if (bit_count - consumed_bits <= CanonicalCode::max_code_length)
+                break;
+        }
+
+        if (consumed_bits == 0)
+            break;
+        input_stream.discard_previously_peeked_bits(consumed_bits);
+    }
+
+    flush_literals();
+    return total_written;
+}
+
+ErrorOr<bool> DeflateDecompressor::CompressedBlock::read_symbol_carefully()
+{
     auto const symbol = TRY(m_literal_codes.read_symbol(*m_decompressor.m_input_stream));
 
     if (symbol >= 286)
@@ -373,16 +500,18 @@ ErrorOr<ByteBuffer> DeflateDecompressor::decompress_all(ReadonlyBytes bytes)
     FixedMemoryStream memory_stream { bytes };
     LittleEndianInputBitStream bit_stream { MaybeOwned<Stream>(memory_stream) };
     auto deflate_stream = TRY(DeflateDecompressor::construct(MaybeOwned<LittleEndianInputBitStream>(bit_stream)));
-    AllocatingMemoryStream output_stream;
 
-    auto buffer = TRY(ByteBuffer::create_uninitialized(4096));
+    // Decompress straight into the result and grow it geometrically, so every byte is only copied a handful of times.
+    ByteBuffer output_buffer;
     while (!deflate_stream->is_eof()) {
-        auto const slice = TRY(deflate_stream->read_some(buffer));
-        TRY(output_stream.write_until_depleted(slice));
+        if (output_buffer.capacity() - output_buffer.size() < 4 * KiB)
+            TRY(output_buffer.try_ensure_capacity(max(output_buffer.capacity() * 2, 64 * KiB)));
+
+        auto const old_size = output_buffer.size();
+        auto const slice = TRY(deflate_stream->read_some(TRY(output_buffer.get_bytes_for_writing(output_buffer.capacity() - old_size))));
+        TRY(output_buffer.try_resize(old_size + slice.size()));
     }
 
-    auto output_buffer = TRY(ByteBuffer::create_uninitialized(output_stream.used_buffer_size()));
-    TRY(output_stream.read_until_filled(output_buffer));
     return output_buffer;
 }
 
@@ -498,6 +627,10 @@ DeflateCompressor::DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>
 {
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
+    for (auto& slot : m_hash_head)
+        slot = empty_slot;
+    for (auto& slot : m_hash_prev)
+        slot = empty_slot;
 }
 
 DeflateCompressor::~DeflateCompressor()
@@ -582,21 +715,27 @@ size_t DeflateCompressor::find_back_match(size_t start, u16 hash, size_t previou
     if (previous_match_length >= m_compression_constants.good_match_length)
         max_chain_length /= 4; // we already have a pretty good much, so do a shorter search
 
+    auto const start_position = stream_position(start);
     auto candidate = m_hash_head[hash];
+    size_t previous_distance = 0;
     auto match_found = false;
     while (max_chain_length--) {
         if (candidate == empty_slot)
             break; // no remaining candidates
 
-        VERIFY(candidate < start);
-        if (start - candidate > window_size)
+        size_t distance = static_cast<u32>(start_position - candidate);
+        if (distance > window_size)
             break; // outside the window
+        if (distance <= previous_distance)
+            break; // the slot was reused by a more recent position, so the rest of the chain is gone
 
-        auto match_length = compare_match_candidate(start, candidate, previous_match_length, maximum_match_length);
+        previous_distance = distance;
+        auto candidate_index = start - distance;
+        auto match_length = compare_match_candidate(start, candidate_index, previous_match_length, maximum_match_length);
 
         if (match_length != 0) {
             match_found = true;
-            match_position = candidate;
+            match_position = candidate_index;
             previous_match_length = match_length;
 
             if (match_length == maximum_match_length)
@@ -687,44 +826,89 @@ void DeflateCompressor::generate_huffman_lengths(Array<u8, Size>& lengths, Array
     }
 }
 
+ALWAYS_INLINE void DeflateCompressor::insert_hash(size_t window_index, u16 hash)
+{
+    auto position = stream_position(window_index);
+    m_hash_prev[position % window_size] = m_hash_head[hash];
+    m_hash_head[hash] = position;
+}
+
+ALWAYS_INLINE void DeflateCompressor::emit_literal(u16 literal)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = 0;
+    m_symbol_buffer[index].literal = literal;
+    m_symbol_frequencies[literal]++;
+}
+
+ALWAYS_INLINE void DeflateCompressor::emit_back_reference(u16 distance, u16 length)
+{
+    VERIFY(m_pending_symbol_size <= block_size + 1);
+    auto index = m_pending_symbol_size++;
+    m_symbol_buffer[index].distance = distance;
+    m_symbol_buffer[index].length = length;
+    m_symbol_frequencies[length_to_symbol[length]]++;
+    m_distance_frequencies[distance_to_base(distance)]++;
+}
+
 void DeflateCompressor::lz77_compress_block()
 {
-    for (auto& slot : m_hash_head) { // initialize chained hash table
-        slot = empty_slot;
-    }
+    VERIFY(m_compression_constants.great_match_length <= max_match_length);
 
-    auto insert_hash = [&](auto pos, auto hash) {
-        auto window_pos = pos % window_size;
-        m_hash_prev[window_pos] = m_hash_head[hash];
-        m_hash_head[hash] = window_pos;
-    };
+    // Like zlib, the fastest level takes the first match it finds, while the others check whether
+    // the match starting at the next byte is longer before committing to one.
+    if (m_compression_level == CompressionLevel::FAST)
+        lz77_compress_block_greedy();
+    else
+        lz77_compress_block_lazy();
+}
 
-    auto emit_literal = [&](auto literal) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = 0;
-        m_symbol_buffer[index].literal = literal;
-        m_symbol_frequencies[literal]++;
-    };
+void DeflateCompressor::lz77_compress_block_greedy()
+{
+    // our block starts at window_size and is m_pending_block_size in length
+    auto block_end = window_size + m_pending_block_size;
+    auto hashable_end = block_end - min_match_length + 1;
+    size_t current_position = window_size;
+    while (current_position < hashable_end) {
+        auto hash = hash_sequence(&m_rolling_window[current_position]);
+        size_t match_position;
+        auto match_length = find_back_match(current_position, hash, 0,
+            min(m_compression_constants.great_match_length, block_end - current_position), match_position);
 
-    auto emit_back_reference = [&](auto distance, auto length) {
-        VERIFY(m_pending_symbol_size <= block_size + 1);
-        auto index = m_pending_symbol_size++;
-        m_symbol_buffer[index].distance = distance;
-        m_symbol_buffer[index].length = length;
-        m_symbol_frequencies[length_to_symbol[length]]++;
-        m_distance_frequencies[distance_to_base(distance)]++;
-    };
+        insert_hash(current_position, hash);
+
+        if (match_length == 0) {
+            emit_literal(m_rolling_window[current_position++]);
+            continue;
+        }
+
+        emit_back_reference(current_position - match_position, match_length);
+
+        // Only short matches are worth adding to the hash chains byte by byte, long ones are skipped over entirely
+        if (match_length <= m_compression_constants.max_lazy_length) {
+            for (size_t j = current_position + 1; j < min(current_position + match_length, hashable_end); j++)
+                insert_hash(j, hash_sequence(&m_rolling_window[j]));
+        }
+        current_position += match_length;
+    }
+
+    // output remaining literals
+    while (current_position < block_end) {
+        emit_literal(m_rolling_window[current_position++]);
+    }
+}
 
+void DeflateCompressor::lz77_compress_block_lazy()
+{
     size_t previous_match_length = 0;
     size_t previous_match_position = 0;
 
-    VERIFY(m_compression_constants.great_match_length <= max_match_length);
-
-    // our block starts at block_size and is m_pending_block_size in length
-    auto block_end = block_size + m_pending_block_size;
+    // our block starts at window_size and is m_pending_block_size in length
+    auto block_end = window_size + m_pending_block_size;
+    auto hashable_end = block_end - min_match_length + 1;
     size_t current_position;
-    for (current_position = block_size; current_position < block_end - min_match_length + 1; current_position++) {
+    for (current_position = window_size; current_position < hashable_end; current_position++) {
         auto hash = hash_sequence(&m_rolling_window[current_position]);
         size_t match_position;
         auto match_length = find_back_match(current_position, hash, previous_match_length,
@@ -737,7 +921,7 @@ void DeflateCompressor::lz77_compress_block()
             emit_back_reference((current_position - 1) - previous_match_position, previous_match_length);
 
             // skip all the bytes that are included in this match
-            for (size_t j = current_position + 1; j < min(current_position - 1 + previous_match_length, block_end - min_match_length + 1); j++) {
+            for (size_t j = current_position + 1; j < min(current_position - 1 + previous_match_length, hashable_end); j++) {
                 insert_hash(j, hash_sequence(&m_rolling_window[j]));
             }
             current_position = (current_position - 1) + previous_match_length - 1;
@@ -1034,14 +1218,15 @@ ErrorOr<void> DeflateCompressor::flush()
     if (m_finished)
         TRY(m_output_stream->align_to_byte_boundary());
 
+    // keep the last window_size bytes around, so the next block can refer back to them
+    memmove(m_rolling_window, m_rolling_window + m_pending_block_size, window_size);
+    m_block_position += m_pending_block_size;
+
     // reset all block specific members
     m_pending_block_size = 0;
     m_pending_symbol_size = 0;
     m_symbol_frequencies.fill(0);
     m_distance_frequencies.fill(0);
-    // On the final block this copy will potentially produce an invalid search window, but since its the final block we dont care
-    pending_block().copy_trimmed_to({ m_rolling_window, block_size });
-
     return {};
 }
 
@@ -1054,6 +1239,37 @@ ErrorOr<void> DeflateCompressor::final_flush()
     return {};
 }
 
+void DeflateCompressor::set_dictionary(ReadonlyBytes dictionary)
+{
+    VERIFY(m_block_position == 0 && m_pending_block_size == 0);
+    dictionary = dictionary.slice_from_end(min(dictionary.size(), window_size));
+
+    dictionary.copy_to({ m_rolling_window + window_size - dictionary.size(), dictionary.size() });
+    m_block_position = dictionary.size();
+
+    if (dictionary.size() < min_match_length)
+        return;
+    for (size_t i = window_size - dictionary.size(); i <= window_size - min_match_length; i++)
+        insert_hash(i, hash_sequence(&m_rolling_window[i]));
+}
+
+// Ends the stream on a byte boundary without marking its last block as final, so that another deflate stream can be appended to it.
+ErrorOr<void> DeflateCompressor::finish_with_sync_flush()
+{
+    VERIFY(!m_finished);
+    if (m_pending_block_size != 0)
+        TRY(flush());
+
+    // An empty uncompressed block takes care of the alignment, just like zlib's Z_SYNC_FLUSH.
+    TRY(m_output_stream->write_bits(0b000u, 3));
+    TRY(m_output_stream->align_to_byte_boundary());
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0));
+    TRY(m_output_stream->write_value<LittleEndian<u16>>(0xffff));
+    TRY(m_output_stream->flush_buffer_to_stream());
+    m_finished = true;
+    return {};
+}
+
 ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, CompressionLevel compression_level)
 {
     auto output_stream = TRY(try_make<AllocatingMemoryStream>());
@@ -1068,4 +1284,74 @@ ErrorOr<ByteBuffer> DeflateCompressor::compress_all(ReadonlyBytes bytes, Compres
     return buffer;
 }
 
+ErrorOr<ByteBuffer> DeflateCompressor::compress_all_in_parallel(ReadonlyBytes bytes, CompressionLevel compression_level, size_t thread_count)
+{
+    VERIFY(thread_count > 0);
+    auto chunk_count = ceil_div(bytes.size(), parallel_chunk_size);
+    if (thread_count == 1 || chunk_count <= 1)
+        return compress_all(bytes, compression_level);
+
+    // This works like pigz: every chunk gets its own compressor, primed with the window_size bytes in front of it so back
+    // references can still cross chunk boundaries. All but the last chunk end on a byte boundary without a final block,
+    // so the compressed chunks can simply be concatenated.
+    Vector<ByteBuffer> compressed_chunks;
+    TRY(compressed_chunks.try_resize(chunk_count));
+    Atomic<size_t> next_chunk_index { 0 };
+
+    auto compress_chunks = [&]() -> ErrorOr<void> {
+        while (true) {
+            auto chunk_index = next_chunk_index.fetch_add(1);
+            if (chunk_index >= chunk_count)
+                return {};
+
+            auto chunk_start = chunk_index * parallel_chunk_size;
+            auto chunk = bytes.slice(chunk_start, min(parallel_chunk_size, bytes.size() - chunk_start));
+
+            auto output_stream = TRY(try_make<AllocatingMemoryStream>());
+            auto deflate_stream = TRY(DeflateCompressor::construct(MaybeOwned<Stream>(*output_stream), compression_level));
+            deflate_stream->set_dictionary(bytes.trim(chunk_start));
+            TRY(deflate_stream->write_until_depleted(chunk));
+            if (chunk_index == chunk_count - 1)
+                TRY(deflate_stream->final_flush());
+            else
+                TRY(deflate_stream->finish_with_sync_flush());
+
+            auto buffer = TRY(ByteBuffer::create_uninitialized(output_stream->used_buffer_size()));
+            TRY(output_stream->read_until_filled(buffer));
+            compressed_chunks[chunk_index] = move(buffer);
+        }
+    };
+
+    auto worker_count = min(thread_count, chunk_count) - 1;
+    Vector<NonnullOwnPtr<Threading::WorkerThread<Error>>> worker_threads;
+    TRY(worker_threads.try_ensure_capacity(worker_count));
+    for (size_t i = 0; i < worker_count; i++) {
+        auto worker_thread = TRY(Threading::WorkerThread<Error>::create("Deflate Worker"sv));
+        worker_thread->start_task([&compress_chunks]() { return compress_chunks(); });
+        worker_threads.unchecked_append(move(worker_thread));
+    }
+
+    // Help out on this thread as well.
+    auto result = compress_chunks();
+
+    for (auto& worker_thread : worker_threads) {
+        auto task_result = worker_thread->wait_until_task_is_finished();
+        if (!result.is_error() && task_result.is_error())
+            result = move(task_result);
+    }
+    TRY(result);
+
+    size_t total_size = 0;
+    for (auto const& compressed_chunk : compressed_chunks)
+        total_size += compressed_chunk.size();
+
+    auto buffer = TRY(ByteBuffer::create_uninitialized(total_size));
+    size_t offset = 0;
+    for (auto const& compressed_chunk : compressed_chunks) {
+        compressed_chunk.bytes().copy_to(buffer.bytes().slice(offset));
+        offset += compressed_chunk.size();
+    }
+    return buffer;
+}
+
 }
@@ -12,6 +12,7 @@
 #include <AK/Endian.h>
 #include <AK/Forward.h>
 #include <AK/MaybeOwned.h>
+#include <AK/NumericLimits.h>
 #include <AK/Stream.h>
 #include <AK/Vector.h>
 #include <LibCompress/DeflateTables.h>
@@ -29,20 +30,33 @@ public:
 
     static ErrorOr<CanonicalCode> from_bytes(ReadonlyBytes);
 
-private:
-    static constexpr size_t max_allowed_prefixed_code_length = 8;
+    static constexpr size_t max_code_length = 15;
 
-    struct PrefixTableEntry {
-        u16 symbol_value { 0 };
-        u16 code_length { 0 };
+    struct DecodeEntry {
+        u16 symbol { 0 }; // the offset of the subtable, if subtable_bits is non-zero
+        u8 code_length { 0 };
+        u8 subtable_bits { 0 };
+        u16 second_symbol { 0 }; // a second literal (< 256) whose code fits into the same primary table lookup
+        u8 total_length { 0 };   // the code length of both literals, or 0 if there is no second literal
     };
 
-    // Decompression - indexed by code
-    Vector<u16, 286> m_symbol_codes;
-    Vector<u16, 286> m_symbol_values;
+    // Looks up the symbol whose code starts at the lowest bit of `bits`, which needs to hold at least max_code_length bits.
+    ALWAYS_INLINE DecodeEntry const& decode_entry(u64 bits) const
+    {
+        auto const& entry = m_decode_table[bits & ((1u << m_primary_bits) - 1)];
+        if (entry.subtable_bits == 0)
+            return entry;
+        return m_decode_table[entry.symbol + ((bits >> m_primary_bits) & ((1u << entry.subtable_bits) - 1))];
+    }
+
+private:
+    static constexpr size_t max_primary_bits = 10;
 
-    Array<PrefixTableEntry, 1 << max_allowed_prefixed_code_length> m_prefix_table {};
-    size_t m_max_prefixed_code_length { 0 };
+    // Decompression - the first 1 << m_primary_bits entries are indexed by the next bits in the stream,
+    // codes longer than that continue in a subtable.
+    Vector<DecodeEntry> m_decode_table;
+    size_t m_primary_bits { 0 };
+    size_t m_max_code_length { 0 };
 
     // Compression - indexed by symbol
     // Deflate uses a maximum of 288 symbols (maximum of 32 for distances),
@@ -60,6 +74,9 @@ private:
         ErrorOr<bool> try_read_more();
 
     private:
+        ErrorOr<size_t> read_symbols_quickly();
+        ErrorOr<bool> read_symbol_carefully();
+
         bool m_eof { false };
 
         DeflateDecompressor& m_decompressor;
@@ -107,6 +124,8 @@ private:
     ErrorOr<void> decode_codes(CanonicalCode& literal_code, Optional<CanonicalCode>& distance_code);
 
     static constexpr u16 max_back_reference_length = 258;
+    // The most bits a back reference can take up: a length code, its extra bits, a distance code and its extra bits.
+    static constexpr size_t max_back_reference_bit_length = CanonicalCode::max_code_length + 5 + CanonicalCode::max_code_length + 13;
 
     bool m_read_final_bock { false };
 
@@ -122,14 +141,16 @@ private:
 
 class DeflateCompressor final : public Stream {
 public:
-    static constexpr size_t block_size = 32 * KiB - 1; // TODO: this can theoretically be increased to 64 KiB - 2
-    static constexpr size_t window_size = block_size * 2;
+    static constexpr size_t block_size = 64 * KiB - 2; // its symbols plus the end of block marker must still fit the u16 symbol frequencies
+    static constexpr size_t window_size = 32 * KiB;    // back references can't reach further than this
+    static constexpr size_t rolling_window_size = window_size + block_size;
     static constexpr size_t hash_bits = 15;
     static constexpr size_t max_huffman_literals = 288;
     static constexpr size_t max_huffman_distances = 32;
     static constexpr size_t min_match_length = 4;   // matches smaller than these are not worth the size of the back reference
     static constexpr size_t max_match_length = 258; // matches longer than these cannot be encoded using huffman codes
-    static constexpr u16 empty_slot = UINT16_MAX;
+    static constexpr u32 empty_slot = NumericLimits<u32>::max();
+    static constexpr size_t parallel_chunk_size = 256 * KiB;
 
     struct CompressionConstants {
         size_t good_match_length;  // Once we find a match of at least this length (a good enough match) we reduce max_chain to lower processing time
@@ -167,16 +188,29 @@ public:
 
     static ErrorOr<ByteBuffer> compress_all(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD);
 
+    // Splits the input into chunks of parallel_chunk_size bytes and compresses them on thread_count threads.
+    // The result is a single deflate stream that any decompressor can read.
+    static ErrorOr<ByteBuffer> compress_all_in_parallel(ReadonlyBytes bytes, CompressionLevel = CompressionLevel::GOOD, size_t thread_count = 4);
+
 private:
     DeflateCompressor(NonnullOwnPtr<LittleEndianOutputBitStream>, CompressionLevel = CompressionLevel::GOOD);
 
-    Bytes pending_block() { return { m_rolling_window + block_size, block_size }; }
+    Bytes pending_block() { return { m_rolling_window + window_size, block_size }; }
 
     // LZ77 Compression
     static u16 hash_sequence(u8 const* bytes);
+    u32 stream_position(size_t window_index) const { return m_block_position + static_cast<u32>(window_index) - static_cast<u32>(window_size); }
+    void insert_hash(size_t window_index, u16 hash);
+    void emit_literal(u16 literal);
+    void emit_back_reference(u16 distance, u16 length);
     size_t compare_match_candidate(size_t start, size_t candidate, size_t prev_match_length, size_t max_match_length);
     size_t find_back_match(size_t start, u16 hash, size_t previous_match_length, size_t max_match_length, size_t& match_position);
     void lz77_compress_block();
+    void lz77_compress_block_greedy();
+    void lz77_compress_block_lazy();
+
+    void set_dictionary(ReadonlyBytes);
+    ErrorOr<void> finish_with_sync_flush();
 
     // Huffman Coding
     struct code_length_symbol {
@@ -202,8 +236,10 @@ private:
     CompressionConstants m_compression_constants;
     NonnullOwnPtr<LittleEndianOutputBitStream> m_output_stream;
 
-    u8 m_rolling_window[window_size];
+    // The last window_size bytes of already compressed data, followed by the pending block.
+    u8 m_rolling_window[rolling_window_size];
     size_t m_pending_block_size { 0 };
+    u32 m_block_position { 0 }; // position of the pending block in the uncompressed stream (modulo 2^32)
 
     struct [[gnu::packed]] {
         u16 distance; // back reference length
@@ -216,9 +252,9 @@ private:
     Array<u16, max_huffman_literals> m_symbol_frequencies;    // there are 286 valid symbol values (symbols 286-287 never occur)
     Array<u16, max_huffman_distances> m_distance_frequencies; // there are 30 valid distance values (distances 30-31 never occur)
 
-    // LZ77 Chained hash table
-    u16 m_hash_head[1 << hash_bits];
-    u16 m_hash_prev[window_size];
+    // LZ77 Chained hash table, holding stream positions so that chains carry over from one block to the next
+    u32 m_hash_head[1 << hash_bits];
+    u32 m_hash_prev[window_size];
 };
 
 }
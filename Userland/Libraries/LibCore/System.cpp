@@ -7,6 +7,7 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
 #include <AK/DeprecatedString.h>
 #include <AK/FixedArray.h>
 #include <AK/ScopedValueRollback.h>
@@ -32,6 +33,10 @@
 #    include <sys/ptrace.h>
 #endif
 
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+#    include <sys/sendfile.h>
+#endif
+
 #if defined(AK_OS_LINUX) && !defined(MFD_CLOEXEC)
 #    include <linux/memfd.h>
 #    include <sys/syscall.h>
@@ -350,6 +355,30 @@ ErrorOr<int> accept4(int sockfd, sockaddr* address, socklen_t* address_length, i
 }
 #endif
 
+ErrorOr<size_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count)
+{
+#if defined(AK_OS_SERENITY) || defined(AK_OS_LINUX)
+    auto rc = ::sendfile(out_fd, in_fd, offset, count);
+    if (rc < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    return static_cast<size_t>(rc);
+#else
+    // Other systems either don't have sendfile() or give it a different signature, copy through a buffer instead.
+    Array<u8, 64 * KiB> buffer;
+    auto nread = offset ? ::pread(in_fd, buffer.data(), min(count, buffer.size()), *offset) : ::read(in_fd, buffer.data(), min(count, buffer.size()));
+    if (nread < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    auto nwritten = ::write(out_fd, buffer.data(), nread);
+    if (nwritten < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    if (offset)
+        *offset += nwritten;
+    else if (nwritten < nread && ::lseek(in_fd, nwritten - nread, SEEK_CUR) < 0)
+        return Error::from_syscall("sendfile"sv, -errno);
+    return static_cast<size_t>(nwritten);
+#endif
+}
+
 ErrorOr<void> sigaction(int signal, struct sigaction const* action, struct sigaction* old_action)
 {
     if (::sigaction(signal, action, old_action) < 0)
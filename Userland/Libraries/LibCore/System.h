@@ -107,6 +107,8 @@ ErrorOr<Optional<struct spwd>> getspnam(StringView name);
 ErrorOr<int> accept4(int sockfd, struct sockaddr*, socklen_t*, int flags);
 #endif
 
+ErrorOr<size_t> sendfile(int out_fd, int in_fd, off_t* offset, size_t count);
+
 ErrorOr<void> sigaction(int signal, struct sigaction const* action, struct sigaction* old_action);
 #if defined(AK_OS_SOLARIS)
 ErrorOr<SIG_TYP> signal(int signal, SIG_TYP handler);
@@ -6,6 +6,9 @@
  */
 
 #include "UnsignedBigIntegerAlgorithms.h"
+#include <AK/Array.h>
+#include <AK/BigIntBase.h>
+#include <AK/BuiltinWrappers.h>
 
 namespace Crypto {
 
@@ -26,7 +29,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
     while (!(ep < 1)) {
         if (ep.words()[0] % 2 == 1) {
             // exp = (exp * base) % m;
-            multiply_without_allocation(exp, base, temp_1, temp_2, temp_3, temp_multiply);
+            multiply_without_allocation(exp, base, temp_1, temp_multiply);
             divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
             exp.set_to(temp_remainder);
         }
@@ -36,7 +39,7 @@ void UnsignedBigIntegerAlgorithms::destructive_modular_power_without_allocation(
         ep.set_to(temp_quotient);
 
         // base = (base * base) % m;
-        multiply_without_allocation(base, base, temp_1, temp_2, temp_3, temp_multiply);
+        multiply_without_allocation(base, base, temp_1, temp_multiply);
         divide_without_allocation(temp_multiply, m, temp_1, temp_2, temp_3, temp_4, temp_quotient, temp_remainder);
         base.set_to(temp_remainder);
 
@@ -178,6 +181,192 @@ void UnsignedBigIntegerAlgorithms::almost_montgomery_multiplication_without_allo
     result.resize_with_leading_zeros(num_words);
 }
 
+using AK::Detail::DoubleWord;
+using AK::Detail::NativeWord;
+using AK::Detail::word_size;
+
+// The fixed-size Montgomery code below works on the platform's native words instead of UnsignedBigInteger::Word,
+// which quarters the number of word multiplications on 64-bit targets.
+template<size_t limb_count>
+using Limbs = Array<NativeWord, limb_count>;
+
+/**
+ * Compute -(1/value) % 2^word_size.
+ * This needs an odd input value. Every Newton iteration doubles the number of correct bits,
+ * and an odd value is its own inverse modulo 8.
+ */
+static NativeWord negated_native_inverse(NativeWord value)
+{
+    VERIFY(value & 1);
+
+    NativeWord inverse = value;
+    for (size_t correct_bits = 3; correct_bits < word_size; correct_bits *= 2)
+        inverse *= 2 - value * inverse;
+    return -inverse;
+}
+
+template<size_t limb_count>
+static void load_limbs(UnsignedBigInteger const& number, Limbs<limb_count>& limbs)
+{
+    constexpr size_t words_per_limb = sizeof(NativeWord) / sizeof(UnsignedBigInteger::Word);
+    auto const& words = number.words();
+    limbs.fill(0);
+    for (size_t i = 0; i < min(words.size(), limb_count * words_per_limb); ++i)
+        limbs[i / words_per_limb] |= static_cast<NativeWord>(words[i]) << (i % words_per_limb * UnsignedBigInteger::BITS_IN_WORD);
+}
+
+template<size_t limb_count>
+static bool is_less_than(NativeWord const* left, Limbs<limb_count> const& right)
+{
+    for (size_t i = limb_count; i-- > 0;) {
+        if (left[i] != right[i])
+            return left[i] < right[i];
+    }
+    return false;
+}
+
+template<size_t limb_count>
+static void subtract_modulo(NativeWord const* value, Limbs<limb_count> const& modulo, Limbs<limb_count>& result)
+{
+    bool borrow = false;
+    for (size_t i = 0; i < limb_count; ++i)
+        result[i] = AK::Detail::sub_words(value[i], modulo[i], borrow);
+}
+
+/**
+ * Computes result = x * y * 2^(-limb_count * word_size) % modulo, fully reduced.
+ * Requires x < 2^(limb_count * word_size) and y < modulo; result may alias x or y.
+ * This is the same algorithm as almost_montgomery_multiplication_without_allocation(), but with the size
+ * known at compile time, so there are no bounds checks, allocations or variable-length loops in the way.
+ */
+template<size_t limb_count>
+static void fixed_size_montgomery_multiplication(Limbs<limb_count> const& x, Limbs<limb_count> const& y, Limbs<limb_count> const& modulo, NativeWord k, Limbs<limb_count>& result)
+{
+    NativeWord z[limb_count + 2] {};
+    for (size_t i = 0; i < limb_count; ++i) {
+        // z += x * y_i
+        DoubleWord carry = 0;
+        for (size_t j = 0; j < limb_count; ++j) {
+            carry += static_cast<DoubleWord>(x[j]) * y[i] + z[j];
+            z[j] = static_cast<NativeWord>(carry);
+            carry >>= word_size;
+        }
+        carry += z[limb_count];
+        z[limb_count] = static_cast<NativeWord>(carry);
+        z[limb_count + 1] = static_cast<NativeWord>(carry >> word_size);
+
+        // z = (z + modulo * (z_0 * k)) / 2^word_size, the bottom word cancels out by construction of k.
+        NativeWord t = z[0] * k;
+        carry = (static_cast<DoubleWord>(modulo[0]) * t + z[0]) >> word_size;
+        for (size_t j = 1; j < limb_count; ++j) {
+            carry += static_cast<DoubleWord>(modulo[j]) * t + z[j];
+            z[j - 1] = static_cast<NativeWord>(carry);
+            carry >>= word_size;
+        }
+        carry += z[limb_count];
+        z[limb_count - 1] = static_cast<NativeWord>(carry);
+        z[limb_count] = z[limb_count + 1] + static_cast<NativeWord>(carry >> word_size);
+    }
+
+    // With y < modulo, z < 2 * modulo, so a single subtraction is enough to fully reduce it.
+    if (z[limb_count] != 0 || !is_less_than(z, modulo)) {
+        subtract_modulo(z, modulo, result);
+        return;
+    }
+    for (size_t i = 0; i < limb_count; ++i)
+        result[i] = z[i];
+}
+
+/**
+ * Computes value = 2 * value % modulo, assuming value < modulo.
+ */
+template<size_t limb_count>
+static void fixed_size_double_modulo(Limbs<limb_count>& value, Limbs<limb_count> const& modulo)
+{
+    NativeWord overflow = value[limb_count - 1] >> (word_size - 1);
+    for (size_t i = limb_count - 1; i > 0; --i)
+        value[i] = (value[i] << 1) | (value[i - 1] >> (word_size - 1));
+    value[0] <<= 1;
+
+    if (overflow != 0 || !is_less_than(value.data(), modulo))
+        subtract_modulo(value.data(), modulo, value);
+}
+
+/**
+ * Computes base ^ exponent % modulo for a modulo of exactly `bits` bits (rounded up to whole words), with the
+ * same 4-bit window as montgomery_modular_power_with_minimal_allocations(). base must be below 2^bits.
+ */
+template<size_t bits>
+static UnsignedBigInteger fixed_size_montgomery_modular_power(UnsignedBigInteger const& base, UnsignedBigInteger const& exponent, UnsignedBigInteger const& modulo)
+{
+    static_assert(bits % word_size == 0);
+    constexpr size_t limb_count = bits / word_size;
+    constexpr size_t window_size = 4;
+
+    Limbs<limb_count> m;
+    Limbs<limb_count> x;
+    load_limbs(modulo, m);
+    load_limbs(base, x);
+    NativeWord k = negated_native_inverse(m[0]);
+
+    // rr = 2^(2 * bits) % modulo, computed without a division:
+    // Double the highest power of two below the modulo up to 2^(bits + odd_part), where bits = odd_part * 2^squarings,
+    // then let Montgomery squarings (a -> a^2 / 2^bits) double the exponent the rest of the way.
+    constexpr size_t squarings = count_trailing_zeroes(bits);
+    constexpr size_t odd_part = bits >> squarings;
+    size_t modulo_bits = modulo.one_based_index_of_highest_set_bit();
+    Limbs<limb_count> rr {};
+    rr[(modulo_bits - 1) / word_size] = static_cast<NativeWord>(1) << ((modulo_bits - 1) % word_size);
+    for (size_t i = modulo_bits - 1; i < bits + odd_part; ++i)
+        fixed_size_double_modulo(rr, m);
+    for (size_t i = 0; i < squarings; ++i)
+        fixed_size_montgomery_multiplication(rr, rr, m, k, rr);
+
+    Limbs<limb_count> one {};
+    one[0] = 1;
+
+    // powers[i] = x^i, in Montgomery form.
+    Limbs<limb_count> powers[1 << window_size];
+    fixed_size_montgomery_multiplication(one, rr, m, k, powers[0]);
+    fixed_size_montgomery_multiplication(x, rr, m, k, powers[1]);
+    for (size_t i = 2; i < (1 << window_size); ++i)
+        fixed_size_montgomery_multiplication(powers[i - 1], powers[1], m, k, powers[i]);
+
+    // Leading zero windows would only square and multiply one by itself, so skip straight to the first set window.
+    // Note: This only depends on the bit length of the exponent.
+    Limbs<limb_count> z = powers[0];
+    bool seen_set_window = false;
+    ssize_t exponent_length = exponent.trimmed_length();
+    for (ssize_t word_in_exponent = exponent_length - 1; word_in_exponent >= 0; --word_in_exponent) {
+        UnsignedBigInteger::Word exponent_word = exponent.words()[word_in_exponent];
+        for (size_t bit_in_word = 0; bit_in_word < UnsignedBigInteger::BITS_IN_WORD; bit_in_word += window_size) {
+            auto power_index = exponent_word >> (UnsignedBigInteger::BITS_IN_WORD - window_size);
+            exponent_word <<= window_size;
+            if (!seen_set_window) {
+                if (power_index == 0)
+                    continue;
+                seen_set_window = true;
+                z = powers[power_index];
+                continue;
+            }
+            for (size_t i = 0; i < window_size; ++i)
+                fixed_size_montgomery_multiplication(z, z, m, k, z);
+            fixed_size_montgomery_multiplication(z, powers[power_index], m, k, z);
+        }
+    }
+
+    fixed_size_montgomery_multiplication(z, one, m, k, z);
+
+    constexpr size_t words_per_limb = sizeof(NativeWord) / sizeof(UnsignedBigInteger::Word);
+    Vector<UnsignedBigInteger::Word, STARTING_WORD_SIZE> words;
+    words.resize(limb_count * words_per_limb);
+    for (size_t i = 0; i < words.size(); ++i)
+        words[i] = static_cast<UnsignedBigInteger::Word>(z[i / words_per_limb] >> (i % words_per_limb * UnsignedBigInteger::BITS_IN_WORD));
+    UnsignedBigInteger result { move(words) };
+    result.clamp_to_trimmed_length();
+    return result;
+}
+
 /**
  * Complexity: still O(N^3) with N the number of words in the largest word, but less complex than the classical mod power.
  * Note: the montgomery multiplications requires an inverse modulo over 2^32, which is only defined for odd numbers.
@@ -202,14 +391,6 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
     constexpr size_t window_size = 4;
 
     size_t num_words = modulo.trimmed_length();
-    UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
-
-    one.set_to(1);
-
-    // rr = ( 2 ^ (2 * modulo.length() * BITS_IN_WORD) ) % modulo
-    shift_left_by_n_words(one, 2 * num_words, x);
-    divide_without_allocation(x, modulo, temp_z, one, z, zz, temp_extra, rr);
-    rr.resize_with_leading_zeros(num_words);
 
     // x = base [% modulo, if x doesn't already fit in modulo's words]
     x.set_to(base);
@@ -217,6 +398,40 @@ void UnsignedBigIntegerAlgorithms::montgomery_modular_power_with_minimal_allocat
         divide_without_allocation(base, modulo, temp_z, one, z, zz, temp_extra, x);
     x.resize_with_leading_zeros(num_words);
 
+    // The common RSA and DH modulus sizes get a version of this algorithm that is specialized for their size.
+    switch (num_words * UnsignedBigInteger::BITS_IN_WORD) {
+    case 512:
+        result = fixed_size_montgomery_modular_power<512>(x, exponent, modulo);
+        return;
+    case 1024:
+        result = fixed_size_montgomery_modular_power<1024>(x, exponent, modulo);
+        return;
+    case 1536:
+        result = fixed_size_montgomery_modular_power<1536>(x, exponent, modulo);
+        return;
+    case 2048:
+        result = fixed_size_montgomery_modular_power<2048>(x, exponent, modulo);
+        return;
+    case 3072:
+        result = fixed_size_montgomery_modular_power<3072>(x, exponent, modulo);
+        return;
+    case 4096:
+        result = fixed_size_montgomery_modular_power<4096>(x, exponent, modulo);
+        return;
+    default:
+        break;
+    }
+
+    UnsignedBigInteger::Word k = inverse_wrapped(modulo.m_words[0]);
+
+    one.set_to(1);
+
+    // rr = ( 2 ^ (2 * modulo.length() * BITS_IN_WORD) ) % modulo
+    // Note: result isn't needed until the very end, so it can hold the dividend for now.
+    shift_left_by_n_words(one, 2 * num_words, result);
+    divide_without_allocation(result, modulo, temp_z, one, z, zz, temp_extra, rr);
+    rr.resize_with_leading_zeros(num_words);
+
     one.set_to(1);
     one.resize_with_leading_zeros(num_words);
 
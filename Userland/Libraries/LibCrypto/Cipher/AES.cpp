@@ -4,10 +4,17 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/ByteReader.h>
+#include <AK/Endian.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Cipher/AES.h>
 #include <LibCrypto/Cipher/AESTables.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto {
 namespace Cipher {
 
@@ -24,6 +31,97 @@ constexpr void swap_keys(u32* keys, size_t i, size_t j)
     keys[j] = temp;
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+// The kernel doesn't preserve SIMD state for itself, so this is userspace only.
+static bool has_aes_ni()
+{
+    static bool const s_has_aes_ni = [] {
+        u32 eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        return (ecx & bit_AES) != 0 && (ecx & bit_SSSE3) != 0;
+    }();
+    return s_has_aes_ni;
+}
+
+[[gnu::target("aes")]] static void aes_ni_encrypt_block(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    auto const* round_keys = reinterpret_cast<__m128i const*>(key.round_key_bytes());
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), _mm_loadu_si128(round_keys));
+    for (size_t i = 1; i < key.rounds(); ++i)
+        state = _mm_aesenc_si128(state, _mm_loadu_si128(round_keys + i));
+    state = _mm_aesenclast_si128(state, _mm_loadu_si128(round_keys + key.rounds()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// Decryption keys are already in the order and form (with InvMixColumns applied) that AESDEC expects.
+[[gnu::target("aes")]] static void aes_ni_decrypt_block(AESCipherKey const& key, u8 const* in, u8* out)
+{
+    auto const* round_keys = reinterpret_cast<__m128i const*>(key.round_key_bytes());
+    auto state = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(in)), _mm_loadu_si128(round_keys));
+    for (size_t i = 1; i < key.rounds(); ++i)
+        state = _mm_aesdec_si128(state, _mm_loadu_si128(round_keys + i));
+    state = _mm_aesdeclast_si128(state, _mm_loadu_si128(round_keys + key.rounds()));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), state);
+}
+
+// AESENC takes several cycles to complete but can start every cycle, so work on several independent blocks at once.
+[[gnu::target("aes,ssse3")]] static void aes_ni_encrypt_counter_blocks(AESCipherKey const& key, Bytes counter, ReadonlyBytes const* in, Bytes out)
+{
+    static constexpr size_t interleaved_block_count = 8;
+
+    auto rounds = key.rounds();
+    auto const* round_key_bytes = reinterpret_cast<__m128i const*>(key.round_key_bytes());
+    __m128i round_keys[15];
+    for (size_t i = 0; i <= rounds; ++i)
+        round_keys[i] = _mm_loadu_si128(round_key_bytes + i);
+
+    // The counter is a 128-bit big endian number, keep it in two native halves and byte swap it into each block.
+    auto const byte_swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    u64 counter_high = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.data()));
+    u64 counter_low = AK::convert_between_host_and_big_endian(ByteReader::load64(counter.data() + 8));
+
+    auto block_count = out.size() / 16;
+    auto const* in_blocks = in ? reinterpret_cast<__m128i const*>(in->data()) : nullptr;
+    auto* out_blocks = reinterpret_cast<__m128i*>(out.data());
+
+    size_t i = 0;
+    for (; i + interleaved_block_count <= block_count; i += interleaved_block_count) {
+        __m128i blocks[interleaved_block_count];
+        for (size_t j = 0; j < interleaved_block_count; ++j) {
+            blocks[j] = _mm_xor_si128(_mm_shuffle_epi8(_mm_set_epi64x(counter_high, counter_low), byte_swap), round_keys[0]);
+            if (++counter_low == 0)
+                ++counter_high;
+        }
+        for (size_t round = 1; round < rounds; ++round) {
+            for (size_t j = 0; j < interleaved_block_count; ++j)
+                blocks[j] = _mm_aesenc_si128(blocks[j], round_keys[round]);
+        }
+        for (size_t j = 0; j < interleaved_block_count; ++j) {
+            blocks[j] = _mm_aesenclast_si128(blocks[j], round_keys[rounds]);
+            if (in_blocks)
+                blocks[j] = _mm_xor_si128(blocks[j], _mm_loadu_si128(in_blocks + i + j));
+            _mm_storeu_si128(out_blocks + i + j, blocks[j]);
+        }
+    }
+
+    for (; i < block_count; ++i) {
+        auto block = _mm_xor_si128(_mm_shuffle_epi8(_mm_set_epi64x(counter_high, counter_low), byte_swap), round_keys[0]);
+        if (++counter_low == 0)
+            ++counter_high;
+        for (size_t round = 1; round < rounds; ++round)
+            block = _mm_aesenc_si128(block, round_keys[round]);
+        block = _mm_aesenclast_si128(block, round_keys[rounds]);
+        if (in_blocks)
+            block = _mm_xor_si128(block, _mm_loadu_si128(in_blocks + i));
+        _mm_storeu_si128(out_blocks + i, block);
+    }
+
+    ByteReader::store(counter.data(), AK::convert_between_host_and_big_endian(counter_high));
+    ByteReader::store(counter.data() + 8, AK::convert_between_host_and_big_endian(counter_low));
+}
+#endif
+
 #ifndef KERNEL
 DeprecatedString AESCipherBlock::to_deprecated_string() const
 {
@@ -84,6 +182,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
                 break;
             round_key += 4;
         }
+        update_round_key_bytes();
         return;
     }
 
@@ -112,6 +211,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
 
             round_key += 6;
         }
+        update_round_key_bytes();
         return;
     }
 
@@ -149,6 +249,7 @@ void AESCipherKey::expand_encrypt_key(ReadonlyBytes user_key, size_t bits)
 
             round_key += 8;
         }
+        update_round_key_bytes();
         return;
     }
 }
@@ -195,10 +296,25 @@ void AESCipherKey::expand_decrypt_key(ReadonlyBytes user_key, size_t bits)
                 AESTables::Decode3[AESTables::Encode1[(round_key[3]      ) & 0xff] & 0xff] ;
         // clang-format on
     }
+
+    update_round_key_bytes();
+}
+
+void AESCipherKey::update_round_key_bytes()
+{
+    for (size_t i = 0; i < (rounds() + 1) * 4; ++i)
+        ByteReader::store(m_rd_key_bytes + i * 4, AK::convert_between_host_and_big_endian(m_rd_keys[i]));
 }
 
 void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        aes_ni_encrypt_block(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -288,6 +404,13 @@ void AESCipher::encrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 
 void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
 {
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        aes_ni_decrypt_block(key(), in.bytes().data(), out.bytes().data());
+        return;
+    }
+#endif
+
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     size_t r { 0 };
 
@@ -375,6 +498,22 @@ void AESCipher::decrypt_block(AESCipherBlock const& in, AESCipherBlock& out)
     // clang-format on
 }
 
+size_t AESCipher::encrypt_counter_blocks(Bytes counter, ReadonlyBytes const* in, Bytes out)
+{
+    VERIFY(counter.size() == AESCipherBlock::block_size());
+    VERIFY(out.size() % AESCipherBlock::block_size() == 0);
+    VERIFY(!in || in->size() == out.size());
+
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_aes_ni()) {
+        aes_ni_encrypt_counter_blocks(key(), counter, in, out);
+        return out.size();
+    }
+#endif
+
+    return 0;
+}
+
 void AESCipherBlock::overwrite(ReadonlyBytes bytes)
 {
     auto data = bytes.data();
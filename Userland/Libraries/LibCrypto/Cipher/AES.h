@@ -73,6 +73,9 @@ struct AESCipherKey : public CipherKey {
         return (u32 const*)m_rd_keys;
     }
 
+    // The round keys in the byte order that the AES-NI instructions expect.
+    u8 const* round_key_bytes() const { return m_rd_key_bytes; }
+
     AESCipherKey(ReadonlyBytes user_key, size_t key_bits, Intent intent)
         : m_bits(key_bits)
     {
@@ -94,8 +97,11 @@ protected:
     }
 
 private:
+    void update_round_key_bytes();
+
     static constexpr size_t MAX_ROUND_COUNT = 14;
     u32 m_rd_keys[(MAX_ROUND_COUNT + 1) * 4] { 0 };
+    u8 m_rd_key_bytes[(MAX_ROUND_COUNT + 1) * 16] { 0 };
     size_t m_rounds;
     size_t m_bits;
 };
@@ -120,6 +126,11 @@ public:
     virtual void encrypt_block(BlockType const& in, BlockType& out) override;
     virtual void decrypt_block(BlockType const& in, BlockType& out) override;
 
+    // Encrypts out.size() / block_size() consecutive counter blocks, starting at `counter`, and XORs them with `in`
+    // into `out` (or just writes them to `out` if there is no input). `counter` is advanced past the last block.
+    // Returns the number of bytes written, which is 0 if there is no faster way than encrypting block by block.
+    size_t encrypt_counter_blocks(Bytes counter, ReadonlyBytes const* in, Bytes out);
+
 #ifndef KERNEL
     virtual DeprecatedString class_name() const override
     {
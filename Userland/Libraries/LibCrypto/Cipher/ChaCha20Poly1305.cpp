@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Authentication/Poly1305.h>
+#include <LibCrypto/Cipher/ChaCha20.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
+
+namespace Crypto::Cipher {
+
+ChaCha20Poly1305::ChaCha20Poly1305(ReadonlyBytes key)
+{
+    VERIFY(key.size() == KeySize);
+    key.copy_to({ m_key, KeySize });
+}
+
+// https://datatracker.ietf.org/doc/html/rfc8439#section-2.8
+void ChaCha20Poly1305::compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag)
+{
+    // The one-time Poly1305 key is the first 32 bytes of the key stream for block 0.
+    u8 one_time_key[32] {};
+    Bytes one_time_key_bytes { one_time_key, sizeof(one_time_key) };
+    ChaCha20 { { m_key, KeySize }, nonce, 0 }.encrypt(one_time_key_bytes, one_time_key_bytes);
+
+    static constexpr u8 zeros[16] {};
+    auto padding_for = [](size_t length) { return ReadonlyBytes { zeros, (16 - length % 16) % 16 }; };
+
+    Authentication::Poly1305 mac { one_time_key_bytes };
+    mac.update(aad);
+    mac.update(padding_for(aad.size()));
+    mac.update(ciphertext);
+    mac.update(padding_for(ciphertext.size()));
+
+    LittleEndian<u64> lengths[2] { aad.size(), ciphertext.size() };
+    mac.update({ lengths, sizeof(lengths) });
+
+    // FIXME: Poly1305 should not need to allocate its digest.
+    MUST(mac.digest()).bytes().copy_to(tag);
+    secure_zero(one_time_key, sizeof(one_time_key));
+}
+
+void ChaCha20Poly1305::encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag)
+{
+    VERIFY(nonce.size() == NonceSize);
+    VERIFY(out.size() >= in.size());
+    VERIFY(tag.size() == TagSize);
+
+    auto ciphertext = out.trim(in.size());
+    ChaCha20 { { m_key, KeySize }, nonce, 1 }.encrypt(in, ciphertext);
+    compute_tag(ciphertext, nonce, aad, tag);
+}
+
+VerificationConsistency ChaCha20Poly1305::decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag)
+{
+    VERIFY(nonce.size() == NonceSize);
+    VERIFY(out.size() >= in.size());
+
+    if (tag.size() != TagSize)
+        return VerificationConsistency::Inconsistent;
+
+    u8 expected_tag[TagSize];
+    compute_tag(in, nonce, aad, { expected_tag, TagSize });
+    if (!timing_safe_compare(expected_tag, tag.data(), TagSize))
+        return VerificationConsistency::Inconsistent;
+
+    auto plaintext = out.trim(in.size());
+    ChaCha20 { { m_key, KeySize }, nonce, 1 }.decrypt(in, plaintext);
+    return VerificationConsistency::Consistent;
+}
+
+}
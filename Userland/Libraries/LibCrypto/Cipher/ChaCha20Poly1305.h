@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <LibCrypto/Verification.h>
+
+namespace Crypto::Cipher {
+
+// The AEAD_CHACHA20_POLY1305 construction from RFC 8439 section 2.8.
+class ChaCha20Poly1305 {
+public:
+    static constexpr size_t KeySize = 32;
+    static constexpr size_t NonceSize = 12;
+    static constexpr size_t TagSize = 16;
+
+    explicit ChaCha20Poly1305(ReadonlyBytes key);
+
+    // `out` has to be at least as large as `in`, `tag` has to be TagSize bytes.
+    void encrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag);
+    VerificationConsistency decrypt(ReadonlyBytes in, Bytes out, ReadonlyBytes nonce, ReadonlyBytes aad, ReadonlyBytes tag);
+
+private:
+    void compute_tag(ReadonlyBytes ciphertext, ReadonlyBytes nonce, ReadonlyBytes aad, Bytes tag);
+
+    u8 m_key[KeySize];
+};
+
+}
@@ -171,6 +171,18 @@ protected:
         size_t offset { 0 };
         auto block_size = cipher.block_size();
 
+        // Some ciphers can encrypt a run of counter blocks much faster than one block at a time.
+        if constexpr (IsSame<IncrementFunctionType, IncrementInplace> && requires { cipher.encrypt_counter_blocks(iv, in, out); }) {
+            auto whole_blocks_length = length - length % block_size;
+            if (in) {
+                auto in_blocks = in->slice(0, whole_blocks_length);
+                offset = cipher.encrypt_counter_blocks(iv, &in_blocks, out.slice(0, whole_blocks_length));
+            } else {
+                offset = cipher.encrypt_counter_blocks(iv, nullptr, out.slice(0, whole_blocks_length));
+            }
+            length -= offset;
+        }
+
         while (length > 0) {
             m_cipher_block.overwrite(iv.slice(0, block_size));
 
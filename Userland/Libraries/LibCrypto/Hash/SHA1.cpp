@@ -10,6 +10,11 @@
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA1.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 
 static constexpr auto ROTATE_LEFT(u32 value, size_t bits)
@@ -67,20 +72,112 @@ inline void SHA1::transform(u8 const* data)
     secure_zero(blocks, 16 * sizeof(u32));
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+// The kernel doesn't preserve SIMD state for itself, so this is userspace only.
+static bool has_sha_ni()
+{
+    static bool const s_has_sha_ni = [] {
+        u32 eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_SSE4_1) == 0)
+            return false;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        return (ebx & bit_SHA) != 0;
+    }();
+    return s_has_sha_ni;
+}
+
+// Runs rounds 4 * i to 4 * i + 3 and then the ones after them, while working towards the message words of later rounds.
+// Every group of rounds adds the rotated E of the previous group, so `e` and `next_e` swap places for the next group.
+template<size_t i>
+[[gnu::target("sha,sse4.1")]] ALWAYS_INLINE static void sha_ni_sha1_rounds_from(__m128i& abcd, __m128i& e, __m128i& next_e, __m128i (&words)[4])
+{
+    auto& current = words[i % 4];
+    if constexpr (i == 0)
+        e = _mm_add_epi32(e, current);
+    else
+        e = _mm_sha1nexte_epu32(e, current);
+    next_e = abcd;
+    if constexpr (i >= 3 && i < 19)
+        words[(i + 1) % 4] = _mm_sha1msg2_epu32(words[(i + 1) % 4], current);
+    abcd = _mm_sha1rnds4_epu32(abcd, e, i / 5);
+    if constexpr (i >= 1 && i < 17)
+        words[(i + 3) % 4] = _mm_sha1msg1_epu32(words[(i + 3) % 4], current);
+    if constexpr (i >= 2 && i < 18)
+        words[(i + 2) % 4] = _mm_xor_si128(words[(i + 2) % 4], current);
+
+    if constexpr (i < 19)
+        sha_ni_sha1_rounds_from<i + 1>(abcd, next_e, e, words);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha_ni_sha1_transform_blocks(u32* state, u8 const* data, size_t block_count)
+{
+    // This also reverses the order of the words, the instructions want A (and E) in the highest lane.
+    auto const byte_swap_mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    auto abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(state)), 0x1b);
+    auto e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    __m128i e1;
+
+    for (; block_count > 0; --block_count, data += SHA1::BlockSize) {
+        auto abcd_before = abcd;
+        auto e_before = e0;
+
+        __m128i words[4];
+        for (size_t i = 0; i < 4; ++i)
+            words[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i * 16)), byte_swap_mask);
+
+        sha_ni_sha1_rounds_from<0>(abcd, e0, e1, words);
+
+        e0 = _mm_sha1nexte_epu32(e0, e_before);
+        abcd = _mm_add_epi32(abcd, abcd_before);
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = _mm_extract_epi32(e0, 3);
+}
+#endif
+
+void SHA1::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (has_sha_ni()) {
+        sha_ni_sha1_transform_blocks(m_state, data, block_count);
+        return;
+    }
+#endif
+    for (; block_count > 0; --block_count, data += BlockSize)
+        transform(data);
+}
+
 void SHA1::update(u8 const* message, size_t length)
 {
-    while (length > 0) {
+    // Empty inputs may well come with a null pointer, which memcpy() must not be given.
+    if (length == 0)
+        return;
+
+    if (m_data_length > 0) {
         size_t copy_bytes = AK::min(length, BlockSize - m_data_length);
         __builtin_memcpy(m_data_buffer + m_data_length, message, copy_bytes);
         message += copy_bytes;
         length -= copy_bytes;
         m_data_length += copy_bytes;
-        if (m_data_length == BlockSize) {
-            transform(m_data_buffer);
-            m_bit_length += BlockSize * 8;
-            m_data_length = 0;
-        }
+        if (m_data_length < BlockSize)
+            return;
+        transform_blocks(m_data_buffer, 1);
+        m_bit_length += BlockSize * 8;
+        m_data_length = 0;
     }
+
+    // Whole blocks don't need to go through the buffer.
+    auto block_count = length / BlockSize;
+    transform_blocks(message, block_count);
+    m_bit_length += block_count * BlockSize * 8;
+    message += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    __builtin_memcpy(m_data_buffer, message, length);
+    m_data_length = length;
 }
 
 SHA1::DigestType SHA1::digest()
@@ -111,7 +208,7 @@ SHA1::DigestType SHA1::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +225,7 @@ SHA1::DigestType SHA1::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     for (i = 0; i < 4; ++i) {
         digest.data[i + 0] = (m_state[0] >> (24 - i * 8)) & 0x000000ff;
@@ -5,9 +5,16 @@
  * SPDX-License-Identifier: BSD-2-Clause
  */
 
+#include <AK/Array.h>
+#include <AK/Atomic.h>
 #include <AK/Types.h>
 #include <LibCrypto/Hash/SHA2.h>
 
+#if ARCH(X86_64) && !defined(KERNEL)
+#    include <cpuid.h>
+#    include <immintrin.h>
+#endif
+
 namespace Crypto::Hash {
 constexpr static auto ROTRIGHT(u32 a, size_t b) { return (a >> b) | (a << (32 - b)); }
 constexpr static auto CH(u32 x, u32 y, u32 z) { return (x & y) ^ (z & ~x); }
@@ -66,38 +73,374 @@ inline void SHA256::transform(u8 const* data)
     m_state[7] += h;
 }
 
+#if ARCH(X86_64) && !defined(KERNEL)
+// The kernel doesn't preserve SIMD state for itself, so this is userspace only.
+static bool has_sha_ni()
+{
+    static bool const s_has_sha_ni = [] {
+        u32 eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_SSE4_1) == 0)
+            return false;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        return (ebx & bit_SHA) != 0;
+    }();
+    return s_has_sha_ni;
+}
+
+[[gnu::target("xsave")]] static bool os_saves_ymm_registers()
+{
+    return (_xgetbv(0) & 0x6) == 0x6;
+}
+
+static bool has_avx2()
+{
+    static bool const s_has_avx2 = [] {
+        u32 eax, ebx, ecx, edx;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0 || (ecx & bit_OSXSAVE) == 0 || !os_saves_ymm_registers())
+            return false;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) == 0)
+            return false;
+        return (ebx & bit_AVX2) != 0;
+    }();
+    return s_has_avx2;
+}
+
+// Runs rounds 4 * i to 4 * i + 3 and then the ones after them, while working towards the message words of later rounds.
+// SHA256RNDS2 wants the state as ABEF and CDGH, and only does two rounds at once.
+template<size_t i>
+[[gnu::target("sha,sse4.1")]] ALWAYS_INLINE static void sha_ni_sha256_rounds_from(__m128i& abef, __m128i& cdgh, __m128i (&words)[4])
+{
+    auto& current = words[i % 4];
+    auto message = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&SHA256Constants::RoundConstants[i * 4])));
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+    if constexpr (i >= 3 && i < 15)
+        words[(i + 1) % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(words[(i + 1) % 4], _mm_alignr_epi8(current, words[(i + 3) % 4], 4)), current);
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(message, 0x0e));
+    if constexpr (i >= 1 && i < 13)
+        words[(i + 3) % 4] = _mm_sha256msg1_epu32(words[(i + 3) % 4], current);
+
+    if constexpr (i < 15)
+        sha_ni_sha256_rounds_from<i + 1>(abef, cdgh, words);
+}
+
+[[gnu::target("sha,sse4.1")]] static void sha_ni_sha256_transform_blocks(u32* state, u8 const* data, size_t block_count)
+{
+    auto const byte_swap_mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    auto dcba = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0]));
+    auto hgfe = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4]));
+    auto cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    auto efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+    auto cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+    for (; block_count > 0; --block_count, data += SHA256::BlockSize) {
+        auto abef_before = abef;
+        auto cdgh_before = cdgh;
+
+        __m128i words[4];
+        for (size_t i = 0; i < 4; ++i)
+            words[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i * 16)), byte_swap_mask);
+
+        sha_ni_sha256_rounds_from<0>(abef, cdgh, words);
+
+        abef = _mm_add_epi32(abef, abef_before);
+        cdgh = _mm_add_epi32(cdgh, cdgh_before);
+    }
+
+    auto feba = _mm_shuffle_epi32(abef, 0x1b);
+    auto dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xf0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+// The multi-buffer code keeps the same word of eight independent states in the lanes of one register.
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i ROTRIGHT(__m256i a, int b) { return _mm256_or_si256(_mm256_srli_epi32(a, b), _mm256_slli_epi32(a, 32 - b)); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i CH(__m256i x, __m256i y, __m256i z) { return _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z)); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i MAJ(__m256i x, __m256i y, __m256i z) { return _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_or_si256(x, y))); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i EP0(__m256i x) { return _mm256_xor_si256(_mm256_xor_si256(ROTRIGHT(x, 2), ROTRIGHT(x, 13)), ROTRIGHT(x, 22)); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i EP1(__m256i x) { return _mm256_xor_si256(_mm256_xor_si256(ROTRIGHT(x, 6), ROTRIGHT(x, 11)), ROTRIGHT(x, 25)); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i SIGN0(__m256i x) { return _mm256_xor_si256(_mm256_xor_si256(ROTRIGHT(x, 7), ROTRIGHT(x, 18)), _mm256_srli_epi32(x, 3)); }
+[[gnu::target("avx2")]] ALWAYS_INLINE static __m256i SIGN1(__m256i x) { return _mm256_xor_si256(_mm256_xor_si256(ROTRIGHT(x, 17), ROTRIGHT(x, 19)), _mm256_srli_epi32(x, 10)); }
+
+// Turns eight rows of eight words into eight columns.
+[[gnu::target("avx2")]] ALWAYS_INLINE static void transpose_8x8(__m256i* rows)
+{
+    __m256i pairs[8];
+    for (size_t i = 0; i < 8; i += 2) {
+        pairs[i] = _mm256_unpacklo_epi32(rows[i], rows[i + 1]);
+        pairs[i + 1] = _mm256_unpackhi_epi32(rows[i], rows[i + 1]);
+    }
+    __m256i quads[8];
+    for (size_t i = 0; i < 8; i += 4) {
+        quads[i] = _mm256_unpacklo_epi64(pairs[i], pairs[i + 2]);
+        quads[i + 1] = _mm256_unpackhi_epi64(pairs[i], pairs[i + 2]);
+        quads[i + 2] = _mm256_unpacklo_epi64(pairs[i + 1], pairs[i + 3]);
+        quads[i + 3] = _mm256_unpackhi_epi64(pairs[i + 1], pairs[i + 3]);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        rows[i] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x20);
+        rows[i + 4] = _mm256_permute2x128_si256(quads[i], quads[i + 4], 0x31);
+    }
+}
+
+// Runs one block through each of eight SHA-256 states. `state` holds word `i` of all eight states at `state[i * 8]`.
+[[gnu::target("avx2")]] static void avx2_sha256_transform_8_blocks(u32* state, Array<u8 const*, 8> const& blocks)
+{
+    auto const byte_swap_mask = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // Only the last 16 message words are needed at any time.
+    __m256i m[16];
+    for (size_t half = 0; half < 2; ++half) {
+        for (size_t lane = 0; lane < 8; ++lane)
+            m[half * 8 + lane] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(blocks[lane] + half * 32));
+        transpose_8x8(&m[half * 8]);
+        for (size_t i = half * 8; i < half * 8 + 8; ++i)
+            m[i] = _mm256_shuffle_epi8(m[i], byte_swap_mask);
+    }
+
+    __m256i vars[8];
+    for (size_t i = 0; i < 8; ++i)
+        vars[i] = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&state[i * 8]));
+    auto a = vars[0], b = vars[1], c = vars[2], d = vars[3], e = vars[4], f = vars[5], g = vars[6], h = vars[7];
+
+    for (size_t i = 0; i < 64; ++i) {
+        auto& word = m[i % 16];
+        if (i >= 16)
+            word = _mm256_add_epi32(_mm256_add_epi32(SIGN1(m[(i - 2) % 16]), m[(i - 7) % 16]), _mm256_add_epi32(SIGN0(m[(i - 15) % 16]), word));
+
+        auto temp0 = _mm256_add_epi32(_mm256_add_epi32(h, EP1(e)), _mm256_add_epi32(CH(e, f, g), _mm256_add_epi32(_mm256_set1_epi32(SHA256Constants::RoundConstants[i]), word)));
+        auto temp1 = _mm256_add_epi32(EP0(a), MAJ(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi32(d, temp0);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi32(temp0, temp1);
+    }
+
+    __m256i results[8] { a, b, c, d, e, f, g, h };
+    for (size_t i = 0; i < 8; ++i)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&state[i * 8]), _mm256_add_epi32(vars[i], results[i]));
+}
+
+// Hashes up to eight messages at a time, and starts on the next message as soon as one of them is done.
+static void avx2_sha256_hash_many(ReadonlySpan<ReadonlyBytes> messages, Span<SHA256::DigestType> digests)
+{
+    static constexpr auto BlockSize = SHA256::BlockSize;
+    static constexpr u8 idle_block[BlockSize] {};
+
+    struct Lane {
+        size_t message_index { 0 };
+        size_t full_block_count { 0 };
+        size_t block_count { 0 };
+        size_t next_block { 0 };
+        // The rest of the message, followed by padding and the message length.
+        u8 tail[2 * BlockSize];
+    };
+
+    Array<Lane, 8> lanes;
+    u32 state[8 * 8];
+    size_t next_message = 0;
+    size_t active_lane_count = 0;
+
+    auto start_message = [&](size_t lane_index) {
+        auto& lane = lanes[lane_index];
+        auto message = messages[next_message];
+        lane.message_index = next_message++;
+        lane.full_block_count = message.size() / BlockSize;
+        lane.next_block = 0;
+
+        auto tail_length = message.size() % BlockSize;
+        auto tail_block_count = tail_length < BlockSize - 8 ? 1 : 2;
+        lane.block_count = lane.full_block_count + tail_block_count;
+        if (tail_length > 0)
+            __builtin_memcpy(lane.tail, message.data() + lane.full_block_count * BlockSize, tail_length);
+        lane.tail[tail_length] = 0x80;
+        __builtin_memset(lane.tail + tail_length + 1, 0, tail_block_count * BlockSize - tail_length - 1);
+        u64 bit_length = message.size() * 8;
+        for (size_t i = 0; i < 8; ++i)
+            lane.tail[tail_block_count * BlockSize - 1 - i] = bit_length >> (i * 8);
+
+        for (size_t i = 0; i < 8; ++i)
+            state[i * 8 + lane_index] = SHA256Constants::InitializationHashes[i];
+    };
+
+    for (size_t i = 0; i < lanes.size() && next_message < messages.size(); ++i, ++active_lane_count)
+        start_message(i);
+
+    while (active_lane_count > 0) {
+        Array<u8 const*, 8> blocks;
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            auto& lane = lanes[i];
+            if (lane.next_block == lane.block_count)
+                blocks[i] = idle_block;
+            else if (lane.next_block < lane.full_block_count)
+                blocks[i] = messages[lane.message_index].data() + lane.next_block * BlockSize;
+            else
+                blocks[i] = lane.tail + (lane.next_block - lane.full_block_count) * BlockSize;
+        }
+
+        avx2_sha256_transform_8_blocks(state, blocks);
+
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            auto& lane = lanes[i];
+            if (lane.next_block == lane.block_count || ++lane.next_block < lane.block_count)
+                continue;
+
+            auto& digest = digests[lane.message_index];
+            for (size_t word = 0; word < 8; ++word) {
+                for (size_t byte = 0; byte < 4; ++byte)
+                    digest.data[word * 4 + byte] = state[word * 8 + i] >> (24 - byte * 8);
+            }
+
+            if (next_message < messages.size())
+                start_message(i);
+            else
+                --active_lane_count;
+        }
+    }
+}
+#endif
+
+// Tests may force an implementation while other threads are hashing.
+static constexpr u8 no_forced_implementation = 0xff;
+static Atomic<u8, AK::MemoryOrder::memory_order_relaxed> s_forced_sha256_implementation { no_forced_implementation };
+
+static Optional<SHA256::Implementation> forced_sha256_implementation()
+{
+    auto implementation = s_forced_sha256_implementation.load();
+    if (implementation == no_forced_implementation)
+        return {};
+    return static_cast<SHA256::Implementation>(implementation);
+}
+
+static bool is_supported(SHA256::Implementation implementation)
+{
+    switch (implementation) {
+    case SHA256::Implementation::Scalar:
+        return true;
+#if ARCH(X86_64) && !defined(KERNEL)
+    case SHA256::Implementation::AVX2:
+        return has_avx2();
+    case SHA256::Implementation::SHANI:
+        return has_sha_ni();
+#else
+    case SHA256::Implementation::AVX2:
+    case SHA256::Implementation::SHANI:
+        return false;
+#endif
+    }
+    VERIFY_NOT_REACHED();
+}
+
+bool SHA256::force_implementation(Optional<Implementation> implementation)
+{
+    if (implementation.has_value() && !is_supported(*implementation))
+        return false;
+    s_forced_sha256_implementation.store(implementation.has_value() ? to_underlying(*implementation) : no_forced_implementation);
+    return true;
+}
+
+#if ARCH(X86_64) && !defined(KERNEL)
+static bool use_sha_ni()
+{
+    if (auto implementation = forced_sha256_implementation(); implementation.has_value())
+        return implementation == SHA256::Implementation::SHANI;
+    return has_sha_ni();
+}
+
+static bool use_avx2_for_hash_many()
+{
+    if (auto implementation = forced_sha256_implementation(); implementation.has_value())
+        return implementation == SHA256::Implementation::AVX2;
+    // A single SHA-NI stream is still faster than eight AVX2 ones.
+    return !has_sha_ni() && has_avx2();
+}
+#endif
+
+void SHA256::transform_blocks(u8 const* data, size_t block_count)
+{
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (use_sha_ni()) {
+        sha_ni_sha256_transform_blocks(m_state, data, block_count);
+        return;
+    }
+#endif
+    for (; block_count > 0; --block_count, data += BlockSize)
+        transform(data);
+}
+
+// Whole blocks are passed to the callback straight from the input, only the rest goes through the buffer.
 template<size_t BlockSize, typename Callback>
 void update_buffer(u8* buffer, u8 const* input, size_t length, size_t& data_length, Callback callback)
 {
-    while (length > 0) {
+    // Empty inputs may well come with a null pointer, which memcpy() must not be given.
+    if (length == 0)
+        return;
+
+    if (data_length > 0) {
         size_t copy_bytes = AK::min(length, BlockSize - data_length);
         __builtin_memcpy(buffer + data_length, input, copy_bytes);
         input += copy_bytes;
         length -= copy_bytes;
         data_length += copy_bytes;
-        if (data_length == BlockSize) {
-            callback();
-            data_length = 0;
-        }
+        if (data_length < BlockSize)
+            return;
+        callback(buffer, 1);
+        data_length = 0;
     }
+
+    auto block_count = length / BlockSize;
+    if (block_count > 0)
+        callback(input, block_count);
+    input += block_count * BlockSize;
+    length -= block_count * BlockSize;
+
+    __builtin_memcpy(buffer, input, length);
+    data_length = length;
 }
 
 void SHA256::update(u8 const* message, size_t length)
 {
-    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&]() {
-        transform(m_data_buffer);
-        m_bit_length += BlockSize * 8;
+    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&](u8 const* blocks, size_t block_count) {
+        transform_blocks(blocks, block_count);
+        m_bit_length += block_count * BlockSize * 8;
     });
 }
 
+void SHA256::hash_many(ReadonlySpan<ReadonlyBytes> messages, Span<DigestType> digests)
+{
+    VERIFY(messages.size() == digests.size());
+
+#if ARCH(X86_64) && !defined(KERNEL)
+    if (use_avx2_for_hash_many()) {
+        avx2_sha256_hash_many(messages, digests);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < messages.size(); ++i)
+        digests[i] = hash(messages[i].data(), messages[i].size());
+}
+
 SHA256::DigestType SHA256::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA256::DigestType SHA256::peek()
+{
+    // Padding clobbers the buffered data and the state, so finish a copy to keep this hash going.
+    auto copy = *this;
+    return copy.finish();
+}
+
+SHA256::DigestType SHA256::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
@@ -111,7 +454,7 @@ SHA256::DigestType SHA256::peek()
         m_data_buffer[i++] = 0x80;
         while (i < BlockSize)
             m_data_buffer[i++] = 0x00;
-        transform(m_data_buffer);
+        transform_blocks(m_data_buffer, 1);
 
         // Then start another block with BlockSize - 8 bytes of zeros
         __builtin_memset(m_data_buffer, 0, FinalBlockDataSize);
@@ -128,7 +471,7 @@ SHA256::DigestType SHA256::peek()
     m_data_buffer[BlockSize - 7] = m_bit_length >> 48;
     m_data_buffer[BlockSize - 8] = m_bit_length >> 56;
 
-    transform(m_data_buffer);
+    transform_blocks(m_data_buffer, 1);
 
     // SHA uses big-endian and we assume little-endian
     // FIXME: looks like a thing for AK::NetworkOrdered,
@@ -190,20 +533,28 @@ inline void SHA384::transform(u8 const* data)
 
 void SHA384::update(u8 const* message, size_t length)
 {
-    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&]() {
-        transform(m_data_buffer);
-        m_bit_length += BlockSize * 8;
+    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&](u8 const* blocks, size_t block_count) {
+        for (size_t i = 0; i < block_count; ++i)
+            transform(blocks + i * BlockSize);
+        m_bit_length += block_count * BlockSize * 8;
     });
 }
 
 SHA384::DigestType SHA384::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA384::DigestType SHA384::peek()
+{
+    // Padding clobbers the buffered data and the state, so finish a copy to keep this hash going.
+    auto copy = *this;
+    return copy.finish();
+}
+
+SHA384::DigestType SHA384::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
@@ -302,20 +653,28 @@ inline void SHA512::transform(u8 const* data)
 
 void SHA512::update(u8 const* message, size_t length)
 {
-    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&]() {
-        transform(m_data_buffer);
-        m_bit_length += BlockSize * 8;
+    update_buffer<BlockSize>(m_data_buffer, message, length, m_data_length, [&](u8 const* blocks, size_t block_count) {
+        for (size_t i = 0; i < block_count; ++i)
+            transform(blocks + i * BlockSize);
+        m_bit_length += block_count * BlockSize * 8;
     });
 }
 
 SHA512::DigestType SHA512::digest()
 {
-    auto digest = peek();
+    auto digest = finish();
     reset();
     return digest;
 }
 
 SHA512::DigestType SHA512::peek()
+{
+    // Padding clobbers the buffered data and the state, so finish a copy to keep this hash going.
+    auto copy = *this;
+    return copy.finish();
+}
+
+SHA512::DigestType SHA512::finish()
 {
     DigestType digest;
     size_t i = m_data_length;
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <AK/Optional.h>
 #include <AK/StringBuilder.h>
 #include <LibCrypto/Hash/HashFunction.h>
 
@@ -99,6 +100,22 @@ public:
     static DigestType hash(ByteBuffer const& buffer) { return hash(buffer.data(), buffer.size()); }
     static DigestType hash(StringView buffer) { return hash((u8 const*)buffer.characters_without_null_termination(), buffer.length()); }
 
+    // Hashes every message into the digest at the same index. This is faster than hashing them one by one when
+    // there are many small messages, as several of them can be hashed in parallel.
+    static void hash_many(ReadonlySpan<ReadonlyBytes> messages, Span<DigestType> digests);
+
+    // The ways of processing blocks. By default, the fastest one the CPU supports is picked.
+    enum class Implementation : u8 {
+        Scalar,
+        // Only used by hash_many(), single messages are hashed with the scalar code.
+        AVX2,
+        SHANI,
+    };
+
+    // Only meant for tests that want to cover every implementation.
+    // Makes SHA256 use the given implementation, or pick one again if it's empty. Returns false if the CPU doesn't support it.
+    static bool force_implementation(Optional<Implementation>);
+
 #ifndef KERNEL
     virtual DeprecatedString class_name() const override
     {
@@ -116,6 +133,8 @@ public:
 
 private:
     inline void transform(u8 const*);
+    void transform_blocks(u8 const*, size_t block_count);
+    DigestType finish();
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
@@ -168,6 +187,7 @@ public:
 
 private:
     inline void transform(u8 const*);
+    DigestType finish();
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
@@ -220,6 +240,7 @@ public:
 
 private:
     inline void transform(u8 const*);
+    DigestType finish();
 
     u8 m_data_buffer[BlockSize] {};
     size_t m_data_length { 0 };
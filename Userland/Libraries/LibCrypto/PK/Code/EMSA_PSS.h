@@ -7,6 +7,7 @@
 #pragma once
 
 #include <AK/Array.h>
+#include <AK/Endian.h>
 #include <AK/Format.h>
 #include <AK/Memory.h>
 #include <AK/Random.h>
@@ -86,80 +87,76 @@ public:
         out[DB.size() + hash_fn.DigestSize] = 0xbc;
     }
 
+    // https://datatracker.ietf.org/doc/html/rfc8017#section-9.1.2
     virtual VerificationConsistency verify(ReadonlyBytes msg, ReadonlyBytes emsg, size_t em_bits) override
     {
         auto& hash_fn = this->hasher();
         hash_fn.update(msg);
         auto message_hash = hash_fn.digest();
 
-        if (emsg.size() < HashFunction::DigestSize + SaltLength + 2)
+        constexpr auto hash_length = HashFunction::DigestSize;
+        auto em_length = (em_bits + 7) / 8;
+        if (emsg.size() != em_length || em_length < hash_length + SaltLength + 2)
             return VerificationConsistency::Inconsistent;
 
-        if (emsg[emsg.size() - 1] != 0xbc)
+        if (emsg[em_length - 1] != 0xbc)
             return VerificationConsistency::Inconsistent;
 
-        auto mask_length = emsg.size() - HashFunction::DigestSize - 1;
+        auto mask_length = em_length - hash_length - 1;
         auto masked_DB = emsg.slice(0, mask_length);
-        auto H = emsg.slice(mask_length, HashFunction::DigestSize);
+        auto H = emsg.slice(mask_length, hash_length);
 
-        auto length_to_check = 8 * emsg.size() - em_bits;
-        auto octet = masked_DB[0];
-        for (size_t i = 0; i < length_to_check; ++i)
-            if ((octet >> (8 - i)) & 0x01)
-                return VerificationConsistency::Inconsistent;
-
-        Vector<u8, 256> DB_mask;
-        DB_mask.resize(mask_length);
-        Bytes DB_mask_buffer { DB_mask };
-        MGF1(H, mask_length, DB_mask_buffer);
+        // The leftmost 8 * em_length - em_bits bits of the masked DB have to be zero.
+        auto unused_bits = 8 * em_length - em_bits;
+        u8 used_bits_mask = 0xff >> unused_bits;
+        if (masked_DB[0] & ~used_bits_mask)
+            return VerificationConsistency::Inconsistent;
 
         Vector<u8, 256> DB;
         DB.resize(mask_length);
+        MGF1(H, mask_length, DB);
 
         for (size_t i = 0; i < mask_length; ++i)
-            DB[i] = masked_DB[i] ^ DB_mask[i];
+            DB[i] ^= masked_DB[i];
+        DB[0] &= used_bits_mask;
 
-        DB[0] &= 0xff >> (8 - length_to_check);
-
-        auto check_octets = emsg.size() - HashFunction::DigestSize - SaltLength - 2;
-        for (size_t i = 0; i < check_octets; ++i) {
+        auto padding_length = em_length - hash_length - SaltLength - 2;
+        for (size_t i = 0; i < padding_length; ++i) {
             if (DB[i])
                 return VerificationConsistency::Inconsistent;
         }
 
-        if (DB[check_octets + 1] != 0x01)
+        if (DB[padding_length] != 0x01)
             return VerificationConsistency::Inconsistent;
 
-        auto* salt = DB.span().offset(mask_length - SaltLength);
-        u8 m_prime[8 + HashFunction::DigestSize + SaltLength] { 0 };
-
+        auto salt = DB.span().slice(mask_length - SaltLength);
+        u8 m_prime[8 + hash_length + SaltLength] { 0 };
         auto m_prime_buffer = Bytes { m_prime, sizeof(m_prime) };
 
-        m_prime_buffer.overwrite(8, message_hash.data, HashFunction::DigestSize);
-        m_prime_buffer.overwrite(8 + HashFunction::DigestSize, salt, SaltLength);
+        m_prime_buffer.overwrite(8, message_hash.data, hash_length);
+        m_prime_buffer.overwrite(8 + hash_length, salt.data(), SaltLength);
 
         hash_fn.update(m_prime_buffer);
         auto H_prime = hash_fn.digest();
 
-        if (!timing_safe_compare(message_hash.data, H_prime.data, HashFunction::DigestSize))
+        if (!timing_safe_compare(H.data(), H_prime.data, hash_length))
             return VerificationConsistency::Inconsistent;
 
         return VerificationConsistency::Consistent;
     }
 
+    // https://datatracker.ietf.org/doc/html/rfc8017#appendix-B.2.1
     void MGF1(ReadonlyBytes seed, size_t length, Bytes out)
     {
         auto& hash_fn = this->hasher();
-        ByteBuffer T;
-        for (size_t counter = 0; counter < length / HashFunction::DigestSize - 1; ++counter) {
+        for (u32 counter = 0; counter * HashFunction::DigestSize < length; ++counter) {
             hash_fn.update(seed);
-            hash_fn.update((u8*)&counter, 4);
-            if (auto result = T.try_append(hash_fn.digest().data, HashFunction::DigestSize); result.is_error()) {
-                dbgln("EMSA_PSS: MGF1 digest failed: {}", result.error());
-                return;
-            }
+            auto big_endian_counter = AK::convert_between_host_and_big_endian(counter);
+            hash_fn.update((u8 const*)&big_endian_counter, sizeof(big_endian_counter));
+            auto digest = hash_fn.digest();
+            auto offset = counter * HashFunction::DigestSize;
+            out.overwrite(offset, digest.data, min(HashFunction::DigestSize, length - offset));
         }
-        out.overwrite(0, T.data(), length);
     }
 
 private:
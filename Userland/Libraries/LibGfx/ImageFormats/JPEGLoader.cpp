@@ -13,10 +13,14 @@
 #include <AK/Math.h>
 #include <AK/MemoryStream.h>
 #include <AK/NumericLimits.h>
+#include <AK/SIMD.h>
+#include <AK/SIMDExtras.h>
+#include <AK/SIMDMath.h>
 #include <AK/String.h>
 #include <AK/Try.h>
 #include <AK/Vector.h>
 #include <LibGfx/ImageFormats/JPEGLoader.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
 
 // These names are defined in B.1.1.3 - Marker assignments
 
@@ -80,6 +84,10 @@
 
 namespace Gfx {
 
+using AK::SIMD::f32x4;
+using AK::SIMD::i32x4;
+using AK::SIMD::u32x4;
+
 constexpr static u8 zigzag_map[64] {
     0, 1, 8, 16, 9, 2, 3, 10,
     17, 24, 32, 25, 18, 11, 4, 5,
@@ -98,25 +106,13 @@ using Marker = u16;
  * block of component data. In interleaved scans, number of non-interleaved data
  * units of a component C is Ch * Cv, where Ch and Cv represent the horizontal &
  * vertical subsampling factors of the component, respectively. A MacroBlock is
- * an 8x8 block of RGB values before encoding, and 8x8 block of YCbCr values when
- * we're done decoding the huffman stream.
+ * an 8x8 block of DCT coefficients for each component when we're done decoding
+ * the huffman stream, and an 8x8 block of samples after the IDCT.
  */
 struct Macroblock {
-    union {
-        i16 y[64] = { 0 };
-        i16 r[64];
-    };
-
-    union {
-        i16 cb[64] = { 0 };
-        i16 g[64];
-    };
-
-    union {
-        i16 cr[64] = { 0 };
-        i16 b[64];
-    };
-
+    i16 y[64] = { 0 };
+    i16 cb[64] = { 0 };
+    i16 cr[64] = { 0 };
     i16 k[64] = { 0 };
 };
 
@@ -312,6 +308,33 @@ public:
         return m_saved_marker;
     }
 
+    // Reads the entropy-coded data of a scan, without the fill bytes in front of markers. Restart markers are kept
+    // in the data, the marker that ends the scan is saved for the next call to read_u16().
+    ErrorOr<Vector<u8>> read_entropy_coded_data()
+    {
+        Vector<u8> data;
+        while (true) {
+            u8 const byte = TRY(read_u8());
+            if (byte != 0xFF) {
+                TRY(data.try_append(byte));
+                continue;
+            }
+
+            u8 next_byte = 0xFF;
+            while (next_byte == 0xFF)
+                next_byte = TRY(read_u8());
+
+            Marker const marker = 0xFF00 | next_byte;
+            if (next_byte != 0x00 && (marker < JPEG_RST0 || marker > JPEG_RST7)) {
+                m_saved_marker = marker;
+                return data;
+            }
+
+            TRY(data.try_append(0xFF));
+            TRY(data.try_append(next_byte));
+        }
+    }
+
     u64 byte_offset() const
     {
         return m_byte_offset;
@@ -481,6 +504,17 @@ struct Scan {
     {
     }
 
+    // A scan with the same parameters, which reads from another stream.
+    Scan(Scan const& other, HuffmanStream stream)
+        : components(other.components)
+        , spectral_selection_start(other.spectral_selection_start)
+        , spectral_selection_end(other.spectral_selection_end)
+        , successive_approximation_high(other.successive_approximation_high)
+        , successive_approximation_low(other.successive_approximation_low)
+        , huffman_stream(stream)
+    {
+    }
+
     // B.2.3 - Scan header syntax
     Vector<ScanComponent, 4> components;
 
@@ -493,6 +527,12 @@ struct Scan {
 
     u64 end_of_bands_run_count { 0 };
 
+    // DC coefficients are coded as the difference to the previous block of the same component.
+    Array<i16, 4> previous_dc_values {};
+
+    // The number of MCUs decoded so far, restart intervals are counted in those.
+    u32 decoded_mcu_count { 0 };
+
     // See the note on Figure B.4 - Scan header syntax
     bool are_components_interleaved() const
     {
@@ -543,7 +583,6 @@ struct JPEGLoadingContext {
     u16 dc_restart_interval { 0 };
     HashMap<u8, HuffmanTable> dc_tables;
     HashMap<u8, HuffmanTable> ac_tables;
-    Array<i16, 4> previous_dc_values {};
     MacroblockMeta mblock_meta;
     JPEGStream stream;
 
@@ -580,7 +619,7 @@ static ErrorOr<void> refine_coefficient(Scan& scan, auto& coefficient)
     return {};
 }
 
-static ErrorOr<void> add_dc(JPEGLoadingContext& context, Macroblock& macroblock, ScanComponent const& scan_component)
+static ErrorOr<void> add_dc(JPEGLoadingContext const& context, Scan& scan, Macroblock& macroblock, ScanComponent const& scan_component)
 {
     auto maybe_table = context.dc_tables.get(scan_component.dc_destination_id);
     if (!maybe_table.has_value()) {
@@ -589,7 +628,6 @@ static ErrorOr<void> add_dc(JPEGLoadingContext& context, Macroblock& macroblock,
     }
 
     auto& dc_table = maybe_table.value();
-    auto& scan = *context.current_scan;
 
     auto* select_component = get_component(macroblock, scan_component.component.index);
     auto& coefficient = select_component[0];
@@ -617,7 +655,7 @@ static ErrorOr<void> add_dc(JPEGLoadingContext& context, Macroblock& macroblock,
     if (dc_length != 0 && dc_diff < (1 << (dc_length - 1)))
         dc_diff -= (1 << dc_length) - 1;
 
-    auto& previous_dc = context.previous_dc_values[scan_component.component.index];
+    auto& previous_dc = scan.previous_dc_values[scan_component.component.index];
     previous_dc += dc_diff;
     coefficient = previous_dc << scan.successive_approximation_low;
 
@@ -654,7 +692,7 @@ static bool is_progressive(StartOfFrame::FrameType frame_type)
         || frame_type == StartOfFrame::FrameType::Differential_Progressive_DCT_Arithmetic;
 }
 
-static ErrorOr<void> add_ac(JPEGLoadingContext& context, Macroblock& macroblock, ScanComponent const& scan_component)
+static ErrorOr<void> add_ac(JPEGLoadingContext const& context, Scan& scan, Macroblock& macroblock, ScanComponent const& scan_component)
 {
     auto maybe_table = context.ac_tables.get(scan_component.ac_destination_id);
     if (!maybe_table.has_value()) {
@@ -665,8 +703,6 @@ static ErrorOr<void> add_ac(JPEGLoadingContext& context, Macroblock& macroblock,
     auto& ac_table = maybe_table.value();
     auto* select_component = get_component(macroblock, scan_component.component.index);
 
-    auto& scan = *context.current_scan;
-
     // Compute the AC coefficients.
 
     // 0th coefficient is the dc, which is already handled
@@ -759,6 +795,54 @@ static ErrorOr<void> add_ac(JPEGLoadingContext& context, Macroblock& macroblock,
     return {};
 }
 
+static bool is_dct_based(StartOfFrame::FrameType frame_type)
+{
+    return frame_type == StartOfFrame::FrameType::Baseline_DCT
+        || frame_type == StartOfFrame::FrameType::Extended_Sequential_DCT
+        || frame_type == StartOfFrame::FrameType::Progressive_DCT
+        || frame_type == StartOfFrame::FrameType::Differential_Sequential_DCT
+        || frame_type == StartOfFrame::FrameType::Differential_Progressive_DCT
+        || frame_type == StartOfFrame::FrameType::Progressive_DCT_Arithmetic
+        || frame_type == StartOfFrame::FrameType::Differential_Sequential_DCT_Arithmetic
+        || frame_type == StartOfFrame::FrameType::Differential_Progressive_DCT_Arithmetic;
+}
+
+static void reset_decoder(JPEGLoadingContext const& context, Scan& scan)
+{
+    // G.1.2.2 - Progressive encoding of AC coefficients with Huffman coding
+    scan.end_of_bands_run_count = 0;
+
+    // E.2.4 Control procedure for decoding a restart interval
+    if (is_dct_based(context.frame.type)) {
+        scan.previous_dc_values = {};
+        return;
+    }
+
+    VERIFY_NOT_REACHED();
+}
+
+static ErrorOr<void> start_next_mcu(JPEGLoadingContext const& context, Scan& scan)
+{
+    // B.2.1 - High-level syntax: Every restart interval but the first one begins with a restart marker.
+    if (context.dc_restart_interval > 0 && scan.decoded_mcu_count > 0 && scan.decoded_mcu_count % context.dc_restart_interval == 0) {
+        reset_decoder(context, scan);
+
+        // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
+        //  the 0th bit of the next byte.
+        TRY(scan.huffman_stream.advance_to_byte_boundary());
+
+        // Skip the restart marker (RSTn).
+        auto const marker = 0xFF00 | TRY(scan.huffman_stream.read_bits(8));
+        if (marker < JPEG_RST0 || marker > JPEG_RST7) {
+            dbgln_if(JPEG_DEBUG, "Expected a restart marker after MCU {}, found {:x}!", scan.decoded_mcu_count, marker);
+            return Error::from_string_literal("Restart marker not found");
+        }
+    }
+
+    ++scan.decoded_mcu_count;
+    return {};
+}
+
 /**
  * Build the macroblocks possible by reading single (MCU) subsampled pair of CbCr.
  * Depending on the sampling factors, we may not see triples of y, cb, cr in that
@@ -774,14 +858,18 @@ static ErrorOr<void> add_ac(JPEGLoadingContext& context, Macroblock& macroblock,
  * macroblocks that share the chrominance data. Next two iterations (assuming that
  * we are dealing with three components) will fill up the blocks with chroma data.
  */
-static ErrorOr<void> build_macroblocks(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
+static ErrorOr<void> build_macroblocks(JPEGLoadingContext const& context, Scan& scan, Vector<Macroblock>& macroblocks, u32 hcursor, u32 vcursor)
 {
-    for (auto const& scan_component : context.current_scan->components) {
+    // A.2.3 - Interleaved order: The MCU holds the blocks of every component.
+    if (scan.are_components_interleaved())
+        TRY(start_next_mcu(context, scan));
+
+    for (auto const& scan_component : scan.components) {
         for (u8 vfactor_i = 0; vfactor_i < scan_component.component.vsample_factor; vfactor_i++) {
             for (u8 hfactor_i = 0; hfactor_i < scan_component.component.hsample_factor; hfactor_i++) {
                 // A.2.3 - Interleaved order
                 u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                if (!context.current_scan->are_components_interleaved()) {
+                if (!scan.are_components_interleaved()) {
                     macroblock_index = vcursor * context.mblock_meta.hpadded_count + (hfactor_i + (hcursor * scan_component.component.vsample_factor) + (vfactor_i * scan_component.component.hsample_factor));
 
                     // A.2.4 Completion of partial MCU
@@ -794,18 +882,21 @@ static ErrorOr<void> build_macroblocks(JPEGLoadingContext& context, Vector<Macro
                     // Vertically
                     if (macroblock_index >= context.mblock_meta.hpadded_count * context.mblock_meta.vcount)
                         continue;
+
+                    // A.2.2 - Non-interleaved order: Every block is an MCU of its own.
+                    TRY(start_next_mcu(context, scan));
                 }
 
                 Macroblock& block = macroblocks[macroblock_index];
 
-                if (context.current_scan->spectral_selection_start == 0)
-                    TRY(add_dc(context, block, scan_component));
-                if (context.current_scan->spectral_selection_end != 0)
-                    TRY(add_ac(context, block, scan_component));
+                if (scan.spectral_selection_start == 0)
+                    TRY(add_dc(context, scan, block, scan_component));
+                if (scan.spectral_selection_end != 0)
+                    TRY(add_ac(context, scan, block, scan_component));
 
                 // G.1.2.2 - Progressive encoding of AC coefficients with Huffman coding
-                if (context.current_scan->end_of_bands_run_count > 0) {
-                    --context.current_scan->end_of_bands_run_count;
+                if (scan.end_of_bands_run_count > 0) {
+                    --scan.end_of_bands_run_count;
                     continue;
                 }
             }
@@ -815,54 +906,22 @@ static ErrorOr<void> build_macroblocks(JPEGLoadingContext& context, Vector<Macro
     return {};
 }
 
-static bool is_dct_based(StartOfFrame::FrameType frame_type)
-{
-    return frame_type == StartOfFrame::FrameType::Baseline_DCT
-        || frame_type == StartOfFrame::FrameType::Extended_Sequential_DCT
-        || frame_type == StartOfFrame::FrameType::Progressive_DCT
-        || frame_type == StartOfFrame::FrameType::Differential_Sequential_DCT
-        || frame_type == StartOfFrame::FrameType::Differential_Progressive_DCT
-        || frame_type == StartOfFrame::FrameType::Progressive_DCT_Arithmetic
-        || frame_type == StartOfFrame::FrameType::Differential_Sequential_DCT_Arithmetic
-        || frame_type == StartOfFrame::FrameType::Differential_Progressive_DCT_Arithmetic;
-}
-
-static void reset_decoder(JPEGLoadingContext& context)
-{
-    // G.1.2.2 - Progressive encoding of AC coefficients with Huffman coding
-    context.current_scan->end_of_bands_run_count = 0;
-
-    // E.2.4 Control procedure for decoding a restart interval
-    if (is_dct_based(context.frame.type)) {
-        context.previous_dc_values = {};
-        return;
-    }
-
-    VERIFY_NOT_REACHED();
-}
+static ErrorOr<void> convert_mcu_row(JPEGLoadingContext&, Span<Macroblock> mcu_row, u32 vcursor);
 
 static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
 {
+    // When there is only room for a single row of MCUs, each row is turned into pixels as soon as it is decoded and
+    // the macroblocks are reused for the next one, see can_decode_row_by_row().
+    bool const decode_row_by_row = macroblocks.size() < context.mblock_meta.padded_total;
+
     for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
+        if (decode_row_by_row)
+            macroblocks.span().fill({});
+
         for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
             u32 i = vcursor * context.mblock_meta.hpadded_count + hcursor;
 
-            auto& huffman_stream = context.current_scan->huffman_stream;
-
-            if (context.dc_restart_interval > 0) {
-                if (i != 0 && i % (context.dc_restart_interval * context.vsample_factor * context.hsample_factor) == 0) {
-                    reset_decoder(context);
-
-                    // Restart markers are stored in byte boundaries. Advance the huffman stream cursor to
-                    //  the 0th bit of the next byte.
-                    TRY(huffman_stream.advance_to_byte_boundary());
-
-                    // Skip the restart marker (RSTn).
-                    TRY(huffman_stream.discard_bits(8));
-                }
-            }
-
-            if (auto result = build_macroblocks(context, macroblocks, hcursor, vcursor); result.is_error()) {
+            if (auto result = build_macroblocks(context, *context.current_scan, macroblocks, hcursor, decode_row_by_row ? 0 : vcursor); result.is_error()) {
                 if constexpr (JPEG_DEBUG) {
                     dbgln("Failed to build Macroblock {}: {}", i, result.error());
                     dbgln("Huffman stream byte offset {}", context.stream.byte_offset());
@@ -870,10 +929,96 @@ static ErrorOr<void> decode_huffman_stream(JPEGLoadingContext& context, Vector<M
                 return result.release_error();
             }
         }
+
+        if (decode_row_by_row)
+            TRY(convert_mcu_row(context, macroblocks, vcursor));
+    }
+    return {};
+}
+
+static bool can_decode_row_by_row(JPEGLoadingContext const& context)
+{
+    // Progressive images refine the coefficients over several scans, so we need to keep all of them until the end.
+    if (is_progressive(context.frame.type))
+        return false;
+
+    // Each component of a sequential image is in exactly one scan. If the current scan has all of them, it's the only one.
+    auto const& scan = *context.current_scan;
+    if (scan.components.size() != context.components.size())
+        return false;
+
+    // A non-interleaved scan of a subsampled component walks over its macroblocks in their own order, which
+    // build_macroblocks() only knows how to handle with the whole image at hand.
+    return scan.are_components_interleaved() || (context.hsample_factor == 1 && context.vsample_factor == 1);
+}
+
+static bool can_decode_restart_intervals_in_parallel(JPEGLoadingContext const& context)
+{
+    // The decoder starts over at every restart interval, so they can be decoded independently of each other.
+    // This is only done for images with a single scan, where all intervals cover a distinct part of the image.
+    return image_decoding_thread_count() > 1 && context.dc_restart_interval > 0 && can_decode_row_by_row(context);
+}
+
+// Decodes the MCUs in [first_mcu, end_mcu) from entropy-coded data that starts at the first of them.
+static ErrorOr<void> decode_mcus(JPEGLoadingContext const& context, ReadonlyBytes data, Vector<Macroblock>& macroblocks, u32 first_mcu, u32 end_mcu)
+{
+    u32 const mcus_per_row = ceil_div(context.mblock_meta.hcount, static_cast<u32>(context.hsample_factor));
+
+    auto memory_stream = TRY(try_make<FixedMemoryStream>(data));
+    auto stream = TRY(JPEGStream::create(move(memory_stream)));
+    Scan scan(*context.current_scan, HuffmanStream { stream });
+    scan.decoded_mcu_count = first_mcu;
+
+    for (u32 mcu = first_mcu; mcu < end_mcu; ++mcu) {
+        u32 const hcursor = (mcu % mcus_per_row) * context.hsample_factor;
+        u32 const vcursor = (mcu / mcus_per_row) * context.vsample_factor;
+        TRY(build_macroblocks(context, scan, macroblocks, hcursor, vcursor));
     }
     return {};
 }
 
+static ErrorOr<void> decode_restart_intervals_in_parallel(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
+{
+    VERIFY(macroblocks.size() == context.mblock_meta.padded_total);
+
+    u32 const mcus_per_row = ceil_div(context.mblock_meta.hcount, static_cast<u32>(context.hsample_factor));
+    u32 const mcu_count = mcus_per_row * ceil_div(context.mblock_meta.vcount, static_cast<u32>(context.vsample_factor));
+    u32 const interval_count = ceil_div(mcu_count, static_cast<u32>(context.dc_restart_interval));
+
+    auto data = TRY(context.stream.read_entropy_coded_data());
+
+    // Every interval but the first one starts at a restart marker, which are the only markers left in the data.
+    Vector<size_t> interval_offsets;
+    TRY(interval_offsets.try_append(0));
+    for (size_t i = 0; i + 1 < data.size(); ++i) {
+        if (data[i] == 0xFF && data[i + 1] != 0x00)
+            TRY(interval_offsets.try_append(i));
+    }
+
+    // HuffmanStream reads a few bytes past the end of the last interval, an EOI marker makes it see zeroes there.
+    TRY(data.try_append(0xFF));
+    TRY(data.try_append(JPEG_EOI & 0xFF));
+
+    // Without a marker at every interval we can't tell where the intervals start, so decode them in order and
+    // leave it to start_next_mcu() to deal with the stray or missing markers, just like on a single thread.
+    if (interval_offsets.size() != interval_count) {
+        dbgln_if(JPEG_DEBUG, "Expected {} restart intervals, found {}, decoding them sequentially", interval_count, interval_offsets.size());
+        return decode_mcus(context, data, macroblocks, 0, mcu_count);
+    }
+
+    // Hand out a few groups of intervals per thread, so threads that finish early can pick up more work.
+    static constexpr u32 tasks_per_thread = 4;
+    u32 const intervals_per_task = ceil_div(interval_count, static_cast<u32>(image_decoding_thread_count() * tasks_per_thread));
+    u32 const task_count = ceil_div(interval_count, intervals_per_task);
+
+    return decode_in_parallel(task_count, [&](size_t task_index) -> ErrorOr<void> {
+        u32 const first_interval = task_index * intervals_per_task;
+        u32 const first_mcu = first_interval * context.dc_restart_interval;
+        u32 const end_mcu = min(first_mcu + intervals_per_task * context.dc_restart_interval, mcu_count);
+        return decode_mcus(context, data.span().slice(interval_offsets[first_interval]), macroblocks, first_mcu, end_mcu);
+    });
+}
+
 static bool is_frame_marker(Marker const marker)
 {
     // B.1.1.3 - Marker assignments
@@ -1389,37 +1534,7 @@ static ErrorOr<void> skip_segment(JPEGStream& stream)
     return {};
 }
 
-static ErrorOr<void> dequantize(JPEGLoadingContext& context, Vector<Macroblock>& macroblocks)
-{
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 i = 0; i < context.components.size(); i++) {
-                auto const& component = context.components[i];
-
-                if (!context.quantization_tables[component.quantization_table_id].has_value()) {
-                    dbgln_if(JPEG_DEBUG, "Unknown quantization table id: {}!", component.quantization_table_id);
-                    return Error::from_string_literal("Unknown quantization table id");
-                }
-
-                auto const& table = context.quantization_tables[component.quantization_table_id].value();
-
-                for (u32 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u32 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[macroblock_index];
-                        auto* block_component = get_component(block, i);
-                        for (u32 k = 0; k < 64; k++)
-                            block_component[k] *= table[k];
-                    }
-                }
-            }
-        }
-    }
-
-    return {};
-}
-
-static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+static void dequantize_and_inverse_dct(JPEGLoadingContext const& context, i16* block_component, Array<u16, 64> const& quantization_table)
 {
     static float const m0 = 2.0f * AK::cos(1.0f / 16.0f * 2.0f * AK::Pi<float>);
     static float const m1 = 2.0f * AK::cos(2.0f / 16.0f * 2.0f * AK::Pi<float>);
@@ -1436,317 +1551,130 @@ static void inverse_dct(JPEGLoadingContext const& context, Vector<Macroblock>& m
     static float const s6 = AK::cos(6.0f / 16.0f * AK::Pi<float>) / 2.0f;
     static float const s7 = AK::cos(7.0f / 16.0f * AK::Pi<float>) / 2.0f;
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
-                auto& component = context.components[component_i];
-                for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
-                    for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
-                        u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hfactor_i + hcursor);
-                        Macroblock& block = macroblocks[macroblock_index];
-                        auto* block_component = get_component(block, component_i);
-                        for (u32 k = 0; k < 8; ++k) {
-                            float const g0 = block_component[0 * 8 + k] * s0;
-                            float const g1 = block_component[4 * 8 + k] * s4;
-                            float const g2 = block_component[2 * 8 + k] * s2;
-                            float const g3 = block_component[6 * 8 + k] * s6;
-                            float const g4 = block_component[5 * 8 + k] * s5;
-                            float const g5 = block_component[1 * 8 + k] * s1;
-                            float const g6 = block_component[7 * 8 + k] * s7;
-                            float const g7 = block_component[3 * 8 + k] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[0 * 8 + k] = b0 + b7;
-                            block_component[1 * 8 + k] = b1 + b6;
-                            block_component[2 * 8 + k] = b2 + b5;
-                            block_component[3 * 8 + k] = b3 + b4;
-                            block_component[4 * 8 + k] = b3 - b4;
-                            block_component[5 * 8 + k] = b2 - b5;
-                            block_component[6 * 8 + k] = b1 - b6;
-                            block_component[7 * 8 + k] = b0 - b7;
-                        }
-                        for (u32 l = 0; l < 8; ++l) {
-                            float const g0 = block_component[l * 8 + 0] * s0;
-                            float const g1 = block_component[l * 8 + 4] * s4;
-                            float const g2 = block_component[l * 8 + 2] * s2;
-                            float const g3 = block_component[l * 8 + 6] * s6;
-                            float const g4 = block_component[l * 8 + 5] * s5;
-                            float const g5 = block_component[l * 8 + 1] * s1;
-                            float const g6 = block_component[l * 8 + 7] * s7;
-                            float const g7 = block_component[l * 8 + 3] * s3;
-
-                            float const f0 = g0;
-                            float const f1 = g1;
-                            float const f2 = g2;
-                            float const f3 = g3;
-                            float const f4 = g4 - g7;
-                            float const f5 = g5 + g6;
-                            float const f6 = g5 - g6;
-                            float const f7 = g4 + g7;
-
-                            float const e0 = f0;
-                            float const e1 = f1;
-                            float const e2 = f2 - f3;
-                            float const e3 = f2 + f3;
-                            float const e4 = f4;
-                            float const e5 = f5 - f7;
-                            float const e6 = f6;
-                            float const e7 = f5 + f7;
-                            float const e8 = f4 + f6;
-
-                            float const d0 = e0;
-                            float const d1 = e1;
-                            float const d2 = e2 * m1;
-                            float const d3 = e3;
-                            float const d4 = e4 * m2;
-                            float const d5 = e5 * m3;
-                            float const d6 = e6 * m4;
-                            float const d7 = e7;
-                            float const d8 = e8 * m5;
-
-                            float const c0 = d0 + d1;
-                            float const c1 = d0 - d1;
-                            float const c2 = d2 - d3;
-                            float const c3 = d3;
-                            float const c4 = d4 + d8;
-                            float const c5 = d5 + d7;
-                            float const c6 = d6 - d8;
-                            float const c7 = d7;
-                            float const c8 = c5 - c6;
-
-                            float const b0 = c0 + c3;
-                            float const b1 = c1 + c2;
-                            float const b2 = c1 - c2;
-                            float const b3 = c0 - c3;
-                            float const b4 = c4 - c8;
-                            float const b5 = c8;
-                            float const b6 = c6 - c7;
-                            float const b7 = c7;
-
-                            block_component[l * 8 + 0] = b0 + b7;
-                            block_component[l * 8 + 1] = b1 + b6;
-                            block_component[l * 8 + 2] = b2 + b5;
-                            block_component[l * 8 + 3] = b3 + b4;
-                            block_component[l * 8 + 4] = b3 - b4;
-                            block_component[l * 8 + 5] = b2 - b5;
-                            block_component[l * 8 + 6] = b1 - b6;
-                            block_component[l * 8 + 7] = b0 - b7;
-                        }
-                    }
-                }
-            }
-        }
-    }
+    // Transforms four columns (or rows) at once, `v[i]` holds their i-th coefficients.
+    auto const inverse_dct_8x4 = [&](Array<f32x4, 8>& v) {
+        f32x4 const g0 = v[0] * s0;
+        f32x4 const g1 = v[4] * s4;
+        f32x4 const g2 = v[2] * s2;
+        f32x4 const g3 = v[6] * s6;
+        f32x4 const g4 = v[5] * s5;
+        f32x4 const g5 = v[1] * s1;
+        f32x4 const g6 = v[7] * s7;
+        f32x4 const g7 = v[3] * s3;
+
+        f32x4 const f0 = g0;
+        f32x4 const f1 = g1;
+        f32x4 const f2 = g2;
+        f32x4 const f3 = g3;
+        f32x4 const f4 = g4 - g7;
+        f32x4 const f5 = g5 + g6;
+        f32x4 const f6 = g5 - g6;
+        f32x4 const f7 = g4 + g7;
+
+        f32x4 const e0 = f0;
+        f32x4 const e1 = f1;
+        f32x4 const e2 = f2 - f3;
+        f32x4 const e3 = f2 + f3;
+        f32x4 const e4 = f4;
+        f32x4 const e5 = f5 - f7;
+        f32x4 const e6 = f6;
+        f32x4 const e7 = f5 + f7;
+        f32x4 const e8 = f4 + f6;
+
+        f32x4 const d0 = e0;
+        f32x4 const d1 = e1;
+        f32x4 const d2 = e2 * m1;
+        f32x4 const d3 = e3;
+        f32x4 const d4 = e4 * m2;
+        f32x4 const d5 = e5 * m3;
+        f32x4 const d6 = e6 * m4;
+        f32x4 const d7 = e7;
+        f32x4 const d8 = e8 * m5;
+
+        f32x4 const c0 = d0 + d1;
+        f32x4 const c1 = d0 - d1;
+        f32x4 const c2 = d2 - d3;
+        f32x4 const c3 = d3;
+        f32x4 const c4 = d4 + d8;
+        f32x4 const c5 = d5 + d7;
+        f32x4 const c6 = d6 - d8;
+        f32x4 const c7 = d7;
+        f32x4 const c8 = c5 - c6;
+
+        f32x4 const b0 = c0 + c3;
+        f32x4 const b1 = c1 + c2;
+        f32x4 const b2 = c1 - c2;
+        f32x4 const b3 = c0 - c3;
+        f32x4 const b4 = c4 - c8;
+        f32x4 const b5 = c8;
+        f32x4 const b6 = c6 - c7;
+        f32x4 const b7 = c7;
+
+        v[0] = b0 + b7;
+        v[1] = b1 + b6;
+        v[2] = b2 + b5;
+        v[3] = b3 + b4;
+        v[4] = b3 - b4;
+        v[5] = b2 - b5;
+        v[6] = b1 - b6;
+        v[7] = b0 - b7;
+    };
 
-    // F.2.1.5 - Inverse DCT (IDCT)
-    auto const level_shift = 1 << (context.frame.precision - 1);
-    auto const max_value = (1 << context.frame.precision) - 1;
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
-                for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-
-                            // FIXME: This just truncate all coefficients, it's an easy way to support (read hack)
-                            //        12 bits JPEGs without rewriting all color transformations.
-                            auto const clamp_to_8_bits = [&](u16 color) -> u8 {
-                                if (context.frame.precision == 8)
-                                    return static_cast<u8>(color);
-                                return static_cast<u8>(color >> 4);
-                            };
-
-                            macroblocks[mb_index].r[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].r[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].g[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].g[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].b[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].b[i * 8 + j] + level_shift, 0, max_value));
-                            macroblocks[mb_index].k[i * 8 + j] = clamp_to_8_bits(clamp(macroblocks[mb_index].k[i * 8 + j] + level_shift, 0, max_value));
-                        }
-                    }
-                }
-            }
+    // Rows are contiguous in memory, so loading four values of a row gives us the coefficients of four columns.
+    // The result is stored transposed, so that the same holds for the rows in the second pass.
+    Array<float, 64> transposed;
+    for (u32 k = 0; k < 8; k += 4) {
+        Array<f32x4, 8> columns;
+        for (u32 i = 0; i < 8; ++i) {
+            auto const* coefficients = &block_component[i * 8 + k];
+            auto const* quantization = &quantization_table[i * 8 + k];
+            columns[i] = f32x4 { static_cast<float>(coefficients[0]), static_cast<float>(coefficients[1]), static_cast<float>(coefficients[2]), static_cast<float>(coefficients[3]) }
+                * f32x4 { static_cast<float>(quantization[0]), static_cast<float>(quantization[1]), static_cast<float>(quantization[2]), static_cast<float>(quantization[3]) };
         }
-    }
-}
 
-static void ycbcr_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
-{
-    // Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
-    // See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
-    // 7 - Conversion to and from RGB
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            const u32 chroma_block_index = vcursor * context.mblock_meta.hpadded_count + hcursor;
-            Macroblock const& chroma = macroblocks[chroma_block_index];
-            // Overflows are intentional.
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 macroblock_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    auto* y = macroblocks[macroblock_index].y;
-                    auto* cb = macroblocks[macroblock_index].cb;
-                    auto* cr = macroblocks[macroblock_index].cr;
-                    for (u8 i = 7; i < 8; --i) {
-                        for (u8 j = 7; j < 8; --j) {
-                            const u8 pixel = i * 8 + j;
-                            const u32 chroma_pxrow = (i / context.vsample_factor) + 4 * vfactor_i;
-                            const u32 chroma_pxcol = (j / context.hsample_factor) + 4 * hfactor_i;
-                            const u32 chroma_pixel = chroma_pxrow * 8 + chroma_pxcol;
-                            int r = y[pixel] + 1.402f * (chroma.cr[chroma_pixel] - 128);
-                            int g = y[pixel] - 0.3441f * (chroma.cb[chroma_pixel] - 128) - 0.7141f * (chroma.cr[chroma_pixel] - 128);
-                            int b = y[pixel] + 1.772f * (chroma.cb[chroma_pixel] - 128);
-                            y[pixel] = clamp(r, 0, 255);
-                            cb[pixel] = clamp(g, 0, 255);
-                            cr[pixel] = clamp(b, 0, 255);
-                        }
-                    }
-                }
-            }
-        }
-    }
-}
+        inverse_dct_8x4(columns);
 
-static void invert_colors_for_adobe_images(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
-{
-    if (!context.color_transform.has_value())
-        return;
-
-    // From libjpeg-turbo's libjpeg.txt:
-    // https://github.com/libjpeg-turbo/libjpeg-turbo/blob/main/libjpeg.txt
-    // CAUTION: it appears that Adobe Photoshop writes inverted data in CMYK JPEG
-    // files: 0 represents 100% ink coverage, rather than 0% ink as you'd expect.
-    // This is arguably a bug in Photoshop, but if you need to work with Photoshop
-    // CMYK files, you will have to deal with it in your application.
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
-                for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-                            macroblocks[mb_index].r[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].r[i * 8 + j];
-                            macroblocks[mb_index].g[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].g[i * 8 + j];
-                            macroblocks[mb_index].b[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].b[i * 8 + j];
-                            macroblocks[mb_index].k[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].k[i * 8 + j];
-                        }
-                    }
-                }
-            }
-        }
+        for (u32 i = 0; i < 8; ++i)
+            AK::SIMD::store4(columns[i], &transposed[(k + 0) * 8 + i], &transposed[(k + 1) * 8 + i], &transposed[(k + 2) * 8 + i], &transposed[(k + 3) * 8 + i]);
     }
-}
-
-static void cmyk_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
-{
-    invert_colors_for_adobe_images(context, macroblocks);
 
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 vfactor_i = context.vsample_factor - 1; vfactor_i < context.vsample_factor; --vfactor_i) {
-                for (u8 hfactor_i = context.hsample_factor - 1; hfactor_i < context.hsample_factor; --hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    auto* c = macroblocks[mb_index].y;
-                    auto* m = macroblocks[mb_index].cb;
-                    auto* y = macroblocks[mb_index].cr;
-                    auto* k = macroblocks[mb_index].k;
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-                            u8 const pixel = i * 8 + j;
-
-                            static constexpr auto max_value = NumericLimits<u8>::max();
-
-                            auto const black_component = max_value - k[pixel];
-                            int const r = ((max_value - c[pixel]) * black_component) / max_value;
-                            int const g = ((max_value - m[pixel]) * black_component) / max_value;
-                            int const b = ((max_value - y[pixel]) * black_component) / max_value;
-
-                            c[pixel] = clamp(r, 0, max_value);
-                            m[pixel] = clamp(g, 0, max_value);
-                            y[pixel] = clamp(b, 0, max_value);
-                        }
-                    }
-                }
-            }
+    // F.2.1.5 - Inverse DCT (IDCT)
+    // Half a unit is added to the level shift to round the results to the nearest sample value.
+    auto const level_shift = static_cast<float>(1 << (context.frame.precision - 1)) + 0.5f;
+    auto const max_value = static_cast<float>((1 << context.frame.precision) - 1);
+    for (u32 l = 0; l < 8; l += 4) {
+        Array<f32x4, 8> rows;
+        for (u32 i = 0; i < 8; ++i) {
+            auto const* coefficients = &transposed[i * 8 + l];
+            rows[i] = f32x4 { coefficients[0], coefficients[1], coefficients[2], coefficients[3] };
         }
-    }
-}
 
-static void ycck_to_rgb(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
-{
-    // 7 - Conversions between colour encodings
-    // YCCK is obtained from CMYK by converting the CMY channels to YCC channel.
+        inverse_dct_8x4(rows);
 
-    // To convert back into RGB, we only need the 3 first components, which are baseline YCbCr
-    ycbcr_to_rgb(context, macroblocks);
+        for (u32 i = 0; i < 8; ++i) {
+            auto samples = AK::SIMD::to_i32x4(AK::SIMD::clamp(rows[i] + level_shift, 0.0f, max_value));
 
-    // RGB to CMYK, as mentioned in https://www.smcm.iqfr.csic.es/docs/intel/ipp/ipp_manual/IPPI/ippi_ch15/functn_YCCKToCMYK_JPEG.htm#functn_YCCKToCMYK_JPEG
-    for (u32 vcursor = 0; vcursor < context.mblock_meta.vcount; vcursor += context.vsample_factor) {
-        for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
-            for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
-                for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
-                    u32 mb_index = (vcursor + vfactor_i) * context.mblock_meta.hpadded_count + (hcursor + hfactor_i);
-                    for (u8 i = 0; i < 8; ++i) {
-                        for (u8 j = 0; j < 8; ++j) {
-                            macroblocks[mb_index].r[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].r[i * 8 + j];
-                            macroblocks[mb_index].g[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].g[i * 8 + j];
-                            macroblocks[mb_index].b[i * 8 + j] = NumericLimits<u8>::max() - macroblocks[mb_index].b[i * 8 + j];
-                        }
-                    }
-                }
-            }
+            // FIXME: This just truncate all samples, it's an easy way to support (read hack)
+            //        12 bits JPEGs without rewriting all color transformations.
+            if (context.frame.precision == 12)
+                samples >>= 4;
+
+            AK::SIMD::store4(samples, &block_component[(l + 0) * 8 + i], &block_component[(l + 1) * 8 + i], &block_component[(l + 2) * 8 + i], &block_component[(l + 3) * 8 + i]);
         }
     }
-
-    cmyk_to_rgb(context, macroblocks);
 }
 
-static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, Vector<Macroblock>& macroblocks)
+// How the decoded components are turned into RGB, see determine_color_conversion().
+enum class ColorConversion {
+    Grayscale,
+    None,
+    YCbCrToRGB,
+    CMYKToRGB,
+    InvertedCMYKToRGB,
+    YCCKToRGB,
+};
+
+static ErrorOr<ColorConversion> determine_color_conversion(JPEGLoadingContext const& context)
 {
     if (context.color_transform.has_value()) {
         // https://www.itu.int/rec/dologin_pub.asp?lang=e&id=T-REC-T.872-201206-I!!PDF-E&type=items
@@ -1754,58 +1682,192 @@ static ErrorOr<void> handle_color_transform(JPEGLoadingContext const& context, V
 
         switch (*context.color_transform) {
         case ColorTransform::CmykOrRgb:
-            if (context.components.size() == 4) {
-                cmyk_to_rgb(context, macroblocks);
-            } else if (context.components.size() == 3) {
-                // Note: components.size() == 3 means that we have an RGB image, so no color transformation is needed.
-            } else {
-                return Error::from_string_literal("Wrong number of components for CMYK or RGB, aborting.");
-            }
-            break;
+            // From libjpeg-turbo's libjpeg.txt:
+            // https://github.com/libjpeg-turbo/libjpeg-turbo/blob/main/libjpeg.txt
+            // CAUTION: it appears that Adobe Photoshop writes inverted data in CMYK JPEG
+            // files: 0 represents 100% ink coverage, rather than 0% ink as you'd expect.
+            // This is arguably a bug in Photoshop, but if you need to work with Photoshop
+            // CMYK files, you will have to deal with it in your application.
+            if (context.components.size() == 4)
+                return ColorConversion::InvertedCMYKToRGB;
+            // Note: components.size() == 3 means that we have an RGB image, so no color transformation is needed.
+            if (context.components.size() == 3)
+                return ColorConversion::None;
+            return Error::from_string_literal("Wrong number of components for CMYK or RGB, aborting.");
         case ColorTransform::YCbCr:
-            ycbcr_to_rgb(context, macroblocks);
-            break;
+            // A single component only has the Y value (luminosity), which is assigned to R, G and B.
+            if (context.components.size() == 1)
+                return ColorConversion::Grayscale;
+            return ColorConversion::YCbCrToRGB;
         case ColorTransform::YCCK:
-            ycck_to_rgb(context, macroblocks);
-            break;
+            if (context.components.size() != 4)
+                return Error::from_string_literal("Wrong number of components for YCCK, aborting.");
+            return ColorConversion::YCCKToRGB;
         }
-
-        return {};
+        VERIFY_NOT_REACHED();
     }
 
     // No App14 segment is present, assuming :
     //      - 1 components means grayscale
     //      - 3 components means YCbCr
     //      - 4 components means CMYK
-    if (context.components.size() == 4)
-        cmyk_to_rgb(context, macroblocks);
-    if (context.components.size() == 3)
-        ycbcr_to_rgb(context, macroblocks);
+    switch (context.components.size()) {
+    case 1:
+        return ColorConversion::Grayscale;
+    case 3:
+        return ColorConversion::YCbCrToRGB;
+    case 4:
+        return ColorConversion::CMYKToRGB;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
 
-    if (context.components.size() == 1) {
-        // With Cb and Cr being equal to zero, this function assign the Y
-        // value (luminosity) to R, G and B. Providing a proper conversion
-        // from grayscale to RGB.
-        ycbcr_to_rgb(context, macroblocks);
+// The samples of a component for a row of 8 pixels, 4 pixels per vector.
+using SampleRow = Array<i32x4, 2>;
+
+// Returns the samples of a component for the given row of the luma block at (vfactor_i, hfactor_i) of an MCU.
+static SampleRow sample_row(JPEGLoadingContext const& context, Span<Macroblock> mcu_row, u32 component_i, u32 hcursor, u8 vfactor_i, u8 hfactor_i, u8 row)
+{
+    auto const& component = context.components[component_i];
+    auto const hpadded_count = context.mblock_meta.hpadded_count;
+
+    if (component.hsample_factor == context.hsample_factor && component.vsample_factor == context.vsample_factor) {
+        auto const* samples = get_component(mcu_row[vfactor_i * hpadded_count + hcursor + hfactor_i], component_i) + row * 8;
+        return { i32x4 { samples[0], samples[1], samples[2], samples[3] }, i32x4 { samples[4], samples[5], samples[6], samples[7] } };
     }
 
-    return {};
+    // Subsampled components only have a single block per MCU, stored with the top left luma block. They are upsampled
+    // by repeating each sample for every pixel it covers. validate_luma_and_modify_context() only lets through factors of 1 and 2.
+    VERIFY(context.hsample_factor == 1 || context.hsample_factor == 2);
+    VERIFY(context.vsample_factor == 1 || context.vsample_factor == 2);
+    auto const* samples = get_component(mcu_row[hcursor], component_i) + ((vfactor_i * 8 + row) / context.vsample_factor) * 8;
+    if (context.hsample_factor == 1)
+        return { i32x4 { samples[0], samples[1], samples[2], samples[3] }, i32x4 { samples[4], samples[5], samples[6], samples[7] } };
+
+    samples += hfactor_i * 4;
+    return { i32x4 { samples[0], samples[0], samples[1], samples[1] }, i32x4 { samples[2], samples[2], samples[3], samples[3] } };
 }
 
-static ErrorOr<void> compose_bitmap(JPEGLoadingContext& context, Vector<Macroblock> const& macroblocks)
+static u32x4 to_bgrx8888(i32x4 r, i32x4 g, i32x4 b)
 {
-    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
+    return (AK::SIMD::to_u32x4(r) << 16) | (AK::SIMD::to_u32x4(g) << 8) | AK::SIMD::to_u32x4(b) | 0xff000000;
+}
+
+static void ycbcr_to_rgb(i32x4 y, i32x4 cb, i32x4 cr, i32x4& r, i32x4& g, i32x4& b)
+{
+    // Conversion from YCbCr to RGB isn't specified in the first JPEG specification but in the JFIF extension:
+    // See: https://www.itu.int/rec/dologin_pub.asp?lang=f&id=T-REC-T.871-201105-I!!PDF-E&type=items
+    // 7 - Conversion to and from RGB
+    auto const luma = AK::SIMD::to_f32x4(y);
+    auto const blue_difference = AK::SIMD::to_f32x4(cb - 128);
+    auto const red_difference = AK::SIMD::to_f32x4(cr - 128);
+    r = AK::SIMD::to_i32x4(AK::SIMD::clamp(luma + 1.402f * red_difference, 0.0f, 255.0f));
+    g = AK::SIMD::to_i32x4(AK::SIMD::clamp(luma - 0.3441f * blue_difference - 0.7141f * red_difference, 0.0f, 255.0f));
+    b = AK::SIMD::to_i32x4(AK::SIMD::clamp(luma + 1.772f * blue_difference, 0.0f, 255.0f));
+}
+
+static u32x4 convert_to_bgrx8888(ColorConversion conversion, Array<i32x4, 4> const& components)
+{
+    static constexpr auto max_value = NumericLimits<u8>::max();
+
+    switch (conversion) {
+    case ColorConversion::Grayscale:
+        return to_bgrx8888(components[0], components[0], components[0]);
+    case ColorConversion::None:
+        return to_bgrx8888(components[0], components[1], components[2]);
+    case ColorConversion::YCbCrToRGB: {
+        i32x4 r, g, b;
+        ycbcr_to_rgb(components[0], components[1], components[2], r, g, b);
+        return to_bgrx8888(r, g, b);
+    }
+    case ColorConversion::CMYKToRGB: {
+        auto const black_component = max_value - components[3];
+        return to_bgrx8888(
+            ((max_value - components[0]) * black_component) / max_value,
+            ((max_value - components[1]) * black_component) / max_value,
+            ((max_value - components[2]) * black_component) / max_value);
+    }
+    case ColorConversion::InvertedCMYKToRGB:
+        // The inverted components are the amount of each color that's left, instead of the amount of ink.
+        return to_bgrx8888(
+            (components[0] * components[3]) / max_value,
+            (components[1] * components[3]) / max_value,
+            (components[2] * components[3]) / max_value);
+    case ColorConversion::YCCKToRGB: {
+        // 7 - Conversions between colour encodings
+        // YCCK is obtained from CMYK by converting the CMY channels to YCC channel.
+        // To convert back into RGB, we go through the inverted CMY values given by the 3 first components, which are baseline
+        // YCbCr, and use them like the ones of Adobe CMYK images.
+        // See https://www.smcm.iqfr.csic.es/docs/intel/ipp/ipp_manual/IPPI/ippi_ch15/functn_YCCKToCMYK_JPEG.htm#functn_YCCKToCMYK_JPEG
+        i32x4 r, g, b;
+        ycbcr_to_rgb(components[0], components[1], components[2], r, g, b);
+        return to_bgrx8888(
+            ((max_value - r) * components[3]) / max_value,
+            ((max_value - g) * components[3]) / max_value,
+            ((max_value - b) * components[3]) / max_value);
+    }
+    }
+    VERIFY_NOT_REACHED();
+}
+
+/**
+ * Turns a row of MCUs into pixels of the bitmap. `mcu_row` holds the macroblocks of that row, i.e. `vsample_factor`
+ * rows of `hpadded_count` macroblocks, and `vcursor` is the index of its first row in the image.
+ * Each MCU goes through dequantization, IDCT, upsampling and color conversion while its macroblocks are still in cache.
+ */
+static ErrorOr<void> convert_mcu_row(JPEGLoadingContext& context, Span<Macroblock> mcu_row, u32 vcursor)
+{
+    auto const conversion = TRY(determine_color_conversion(context));
 
-    for (u32 y = context.frame.height - 1; y < context.frame.height; y--) {
-        const u32 block_row = y / 8;
-        const u32 pixel_row = y % 8;
-        for (u32 x = 0; x < context.frame.width; x++) {
-            const u32 block_column = x / 8;
-            auto& block = macroblocks[block_row * context.mblock_meta.hpadded_count + block_column];
-            const u32 pixel_column = x % 8;
-            const u32 pixel_index = pixel_row * 8 + pixel_column;
-            const Color color { (u8)block.y[pixel_index], (u8)block.cb[pixel_index], (u8)block.cr[pixel_index] };
-            context.bitmap->set_pixel(x, y, color);
+    Array<Array<u16, 64> const*, 4> quantization_tables {};
+    for (u32 i = 0; i < context.components.size(); i++) {
+        auto const& component = context.components[i];
+
+        if (!context.quantization_tables[component.quantization_table_id].has_value()) {
+            dbgln_if(JPEG_DEBUG, "Unknown quantization table id: {}!", component.quantization_table_id);
+            return Error::from_string_literal("Unknown quantization table id");
+        }
+
+        quantization_tables[i] = &context.quantization_tables[component.quantization_table_id].value();
+    }
+
+    auto const hpadded_count = context.mblock_meta.hpadded_count;
+    for (u32 hcursor = 0; hcursor < context.mblock_meta.hcount; hcursor += context.hsample_factor) {
+        for (u32 component_i = 0; component_i < context.components.size(); component_i++) {
+            auto const& component = context.components[component_i];
+            for (u8 vfactor_i = 0; vfactor_i < component.vsample_factor; vfactor_i++) {
+                for (u8 hfactor_i = 0; hfactor_i < component.hsample_factor; hfactor_i++) {
+                    // Macroblocks that only pad the image to a whole number of MCUs are never displayed.
+                    if (vcursor + vfactor_i >= context.mblock_meta.vcount || hcursor + hfactor_i >= context.mblock_meta.hcount)
+                        continue;
+
+                    auto& block = mcu_row[vfactor_i * hpadded_count + hcursor + hfactor_i];
+                    dequantize_and_inverse_dct(context, get_component(block, component_i), *quantization_tables[component_i]);
+                }
+            }
+        }
+
+        for (u8 vfactor_i = 0; vfactor_i < context.vsample_factor; ++vfactor_i) {
+            for (u8 hfactor_i = 0; hfactor_i < context.hsample_factor; ++hfactor_i) {
+                u32 const x = (hcursor + hfactor_i) * 8;
+                u32 const y = (vcursor + vfactor_i) * 8;
+                if (x >= context.frame.width || y >= context.frame.height)
+                    continue;
+
+                auto const pixel_count = min(8u, context.frame.width - x);
+                for (u8 row = 0; row < 8 && y + row < context.frame.height; ++row) {
+                    Array<SampleRow, 4> samples {};
+                    for (u32 component_i = 0; component_i < context.components.size(); component_i++)
+                        samples[component_i] = sample_row(context, mcu_row, component_i, hcursor, vfactor_i, hfactor_i, row);
+
+                    Array<u32x4, 2> pixels;
+                    for (u32 half = 0; half < 2; ++half)
+                        pixels[half] = convert_to_bgrx8888(conversion, { samples[0][half], samples[1][half], samples[2][half], samples[3][half] });
+
+                    __builtin_memcpy(context.bitmap->scanline(y + row) + x, pixels.data(), pixel_count * sizeof(u32));
+                }
+            }
         }
     }
 
@@ -1932,14 +1994,13 @@ static ErrorOr<void> decode_header(JPEGLoadingContext& context)
     return {};
 }
 
-static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& context)
+static ErrorOr<void> decode_scans(JPEGLoadingContext& context)
 {
     // B.6 - Summary
     // See: Figure B.16 – Flow of compressed data syntax
     // This function handles the "Multi-scan" loop.
 
     Vector<Macroblock> macroblocks;
-    TRY(macroblocks.try_resize(context.mblock_meta.padded_total));
 
     Marker marker = TRY(read_marker_at_cursor(context.stream));
     while (true) {
@@ -1947,9 +2008,34 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
             TRY(handle_miscellaneous_or_table(context.stream, context, marker));
         } else if (marker == JPEG_SOS) {
             TRY(read_start_of_scan(context.stream, context));
-            TRY(decode_huffman_stream(context, macroblocks));
+            bool const decode_intervals_in_parallel = can_decode_restart_intervals_in_parallel(context);
+            if (macroblocks.is_empty()) {
+                // If possible, only keep a single row of MCUs in memory instead of the whole image.
+                auto const mcu_row_size = context.mblock_meta.hpadded_count * context.vsample_factor;
+                bool const keep_single_row = can_decode_row_by_row(context) && !decode_intervals_in_parallel;
+                TRY(macroblocks.try_resize(keep_single_row ? mcu_row_size : context.mblock_meta.padded_total));
+            }
+            if (decode_intervals_in_parallel)
+                TRY(decode_restart_intervals_in_parallel(context, macroblocks));
+            else
+                TRY(decode_huffman_stream(context, macroblocks));
         } else if (marker == JPEG_EOI) {
-            return macroblocks;
+            // Rows that were decoded one by one already made it to the bitmap.
+            if (macroblocks.size() == context.mblock_meta.padded_total) {
+                auto const mcu_row_size = context.mblock_meta.hpadded_count * context.vsample_factor;
+                auto const mcu_row_count = ceil_div(context.mblock_meta.vcount, static_cast<u32>(context.vsample_factor));
+
+                // Each row of MCUs covers vsample_factor * 8 rows of pixels.
+                IntSize const mcu_rows_size { context.frame.width * context.vsample_factor * 8, static_cast<int>(mcu_row_count) };
+                TRY(decode_rows_in_parallel(mcu_rows_size, [&](int first_row, int end_row) -> ErrorOr<void> {
+                    for (int row = first_row; row < end_row; ++row) {
+                        u32 const vcursor = row * context.vsample_factor;
+                        TRY(convert_mcu_row(context, macroblocks.span().slice(vcursor * context.mblock_meta.hpadded_count, mcu_row_size), vcursor));
+                    }
+                    return {};
+                }));
+            }
+            return {};
         } else {
             dbgln_if(JPEG_DEBUG, "Unexpected marker {:x}!", marker);
             return Error::from_string_literal("Unexpected marker");
@@ -1962,11 +2048,8 @@ static ErrorOr<Vector<Macroblock>> construct_macroblocks(JPEGLoadingContext& con
 static ErrorOr<void> decode_jpeg(JPEGLoadingContext& context)
 {
     TRY(decode_header(context));
-    auto macroblocks = TRY(construct_macroblocks(context));
-    TRY(dequantize(context, macroblocks));
-    inverse_dct(context, macroblocks);
-    TRY(handle_color_transform(context, macroblocks));
-    TRY(compose_bitmap(context, macroblocks));
+    context.bitmap = TRY(Bitmap::create(BitmapFormat::BGRx8888, { context.frame.width, context.frame.height }));
+    TRY(decode_scans(context));
     return {};
 }
 
@@ -11,6 +11,7 @@
 #include <LibCompress/Zlib.h>
 #include <LibGfx/ImageFormats/PNGLoader.h>
 #include <LibGfx/ImageFormats/PNGShared.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
 #include <LibGfx/Painter.h>
 
 namespace Gfx {
@@ -346,9 +347,9 @@ static void unfilter_scanline(PNG::FilterType filter, Bytes scanline_data, Reado
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* gray_values = reinterpret_cast<T const*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -361,9 +362,9 @@ ALWAYS_INLINE static void unpack_grayscale_without_alpha(PNGLoadingContext& cont
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* tuples = reinterpret_cast<Tuple<T> const*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -376,9 +377,9 @@ ALWAYS_INLINE static void unpack_grayscale_with_alpha(PNGLoadingContext& context
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context)
+ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& context, int first_row, int end_row)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* triplets = reinterpret_cast<Triplet<T> const*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -391,9 +392,9 @@ ALWAYS_INLINE static void unpack_triplets_without_alpha(PNGLoadingContext& conte
 }
 
 template<typename T>
-ALWAYS_INLINE static void unpack_triplets_with_transparency_value(PNGLoadingContext& context, Triplet<T> transparency_value)
+ALWAYS_INLINE static void unpack_triplets_with_transparency_value(PNGLoadingContext& context, int first_row, int end_row, Triplet<T> transparency_value)
 {
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* triplets = reinterpret_cast<Triplet<T> const*>(context.scanlines[y].data.data());
         for (int i = 0; i < context.width; ++i) {
             auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -408,60 +409,19 @@ ALWAYS_INLINE static void unpack_triplets_with_transparency_value(PNGLoadingCont
     }
 }
 
-NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
+NEVER_INLINE FLATTEN static ErrorOr<void> unpack_scanlines(PNGLoadingContext& context, int first_row, int end_row)
 {
-    // First unfilter the scanlines:
-
-    // FIXME: Instead of creating a separate buffer for the scanlines that need to be
-    //        mutated, the mutation could be done in place (if the data was non-const).
-    size_t bytes_per_scanline = context.scanlines[0].data.size();
-    size_t bytes_needed_for_all_unfiltered_scanlines = 0;
-    for (int y = 0; y < context.height; ++y) {
-        if (context.scanlines[y].filter != PNG::FilterType::None) {
-            bytes_needed_for_all_unfiltered_scanlines += bytes_per_scanline;
-        }
-    }
-    context.unfiltered_data = TRY(ByteBuffer::create_uninitialized(bytes_needed_for_all_unfiltered_scanlines));
-
-    // From section 6.3 of http://www.libpng.org/pub/png/spec/1.2/PNG-Filters.html
-    // "bpp is defined as the number of bytes per complete pixel, rounding up to one.
-    // For example, for color type 2 with a bit depth of 16, bpp is equal to 6
-    // (three samples, two bytes per sample); for color type 0 with a bit depth of 2,
-    // bpp is equal to 1 (rounding up); for color type 4 with a bit depth of 16, bpp
-    // is equal to 4 (two-byte grayscale sample, plus two-byte alpha sample)."
-    u8 bytes_per_complete_pixel = (context.bit_depth + 7) / 8 * context.channels;
-
-    u8 dummy_scanline_bytes[bytes_per_scanline];
-    memset(dummy_scanline_bytes, 0, sizeof(dummy_scanline_bytes));
-    auto previous_scanlines_data = ReadonlyBytes { dummy_scanline_bytes, sizeof(dummy_scanline_bytes) };
-
-    for (int y = 0, data_start = 0; y < context.height; ++y) {
-        if (context.scanlines[y].filter != PNG::FilterType::None) {
-            auto scanline_data_slice = context.unfiltered_data.bytes().slice(data_start, bytes_per_scanline);
-
-            // Copy the current values over and set the scanline's data to the to-be-mutated slice
-            context.scanlines[y].data.copy_to(scanline_data_slice);
-            context.scanlines[y].data = scanline_data_slice;
-
-            unfilter_scanline(context.scanlines[y].filter, scanline_data_slice, previous_scanlines_data, bytes_per_complete_pixel);
-
-            data_start += bytes_per_scanline;
-        }
-        previous_scanlines_data = context.scanlines[y].data;
-    }
-
-    // Now unpack the scanlines to RGBA:
     switch (context.color_type) {
     case PNG::ColorType::Greyscale:
         if (context.bit_depth == 8) {
-            unpack_grayscale_without_alpha<u8>(context);
+            unpack_grayscale_without_alpha<u8>(context, first_row, end_row);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_without_alpha<u16>(context);
+            unpack_grayscale_without_alpha<u16>(context, first_row, end_row);
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto bit_depth_squared = context.bit_depth * context.bit_depth;
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* gray_values = context.scanlines[y].data.data();
                 for (int x = 0; x < context.width; ++x) {
                     auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (x % pixels_per_byte));
@@ -479,9 +439,9 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case PNG::ColorType::GreyscaleWithAlpha:
         if (context.bit_depth == 8) {
-            unpack_grayscale_with_alpha<u8>(context);
+            unpack_grayscale_with_alpha<u8>(context, first_row, end_row);
         } else if (context.bit_depth == 16) {
-            unpack_grayscale_with_alpha<u16>(context);
+            unpack_grayscale_with_alpha<u16>(context, first_row, end_row);
         } else {
             VERIFY_NOT_REACHED();
         }
@@ -489,31 +449,31 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
     case PNG::ColorType::Truecolor:
         if (context.palette_transparency_data.size() == 6) {
             if (context.bit_depth == 8) {
-                unpack_triplets_with_transparency_value<u8>(context, Triplet<u8> { context.palette_transparency_data[0], context.palette_transparency_data[2], context.palette_transparency_data[4] });
+                unpack_triplets_with_transparency_value<u8>(context, first_row, end_row, Triplet<u8> { context.palette_transparency_data[0], context.palette_transparency_data[2], context.palette_transparency_data[4] });
             } else if (context.bit_depth == 16) {
                 u16 tr = context.palette_transparency_data[0] | context.palette_transparency_data[1] << 8;
                 u16 tg = context.palette_transparency_data[2] | context.palette_transparency_data[3] << 8;
                 u16 tb = context.palette_transparency_data[4] | context.palette_transparency_data[5] << 8;
-                unpack_triplets_with_transparency_value<u16>(context, Triplet<u16> { tr, tg, tb });
+                unpack_triplets_with_transparency_value<u16>(context, first_row, end_row, Triplet<u16> { tr, tg, tb });
             } else {
                 VERIFY_NOT_REACHED();
             }
         } else {
             if (context.bit_depth == 8)
-                unpack_triplets_without_alpha<u8>(context);
+                unpack_triplets_without_alpha<u8>(context, first_row, end_row);
             else if (context.bit_depth == 16)
-                unpack_triplets_without_alpha<u16>(context);
+                unpack_triplets_without_alpha<u16>(context, first_row, end_row);
             else
                 VERIFY_NOT_REACHED();
         }
         break;
     case PNG::ColorType::TruecolorWithAlpha:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 memcpy(context.bitmap->scanline(y), context.scanlines[y].data.data(), context.scanlines[y].data.size());
             }
         } else if (context.bit_depth == 16) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* quartets = reinterpret_cast<Quartet<u16> const*>(context.scanlines[y].data.data());
                 for (int i = 0; i < context.width; ++i) {
                     auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -529,7 +489,7 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         break;
     case PNG::ColorType::IndexedColor:
         if (context.bit_depth == 8) {
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* palette_index = context.scanlines[y].data.data();
                 for (int i = 0; i < context.width; ++i) {
                     auto& pixel = (Pixel&)context.bitmap->scanline(y)[i];
@@ -548,7 +508,7 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
         } else if (context.bit_depth == 1 || context.bit_depth == 2 || context.bit_depth == 4) {
             auto pixels_per_byte = 8 / context.bit_depth;
             auto mask = (1 << context.bit_depth) - 1;
-            for (int y = 0; y < context.height; ++y) {
+            for (int y = first_row; y < end_row; ++y) {
                 auto* palette_indices = context.scanlines[y].data.data();
                 for (int i = 0; i < context.width; ++i) {
                     auto bit_offset = (8 - context.bit_depth) - (context.bit_depth * (i % pixels_per_byte));
@@ -576,7 +536,7 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
     }
 
     // Swap r and b values:
-    for (int y = 0; y < context.height; ++y) {
+    for (int y = first_row; y < end_row; ++y) {
         auto* pixels = (Pixel*)context.bitmap->scanline(y);
         for (int i = 0; i < context.bitmap->width(); ++i) {
             auto& x = pixels[i];
@@ -587,6 +547,55 @@ NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
     return {};
 }
 
+NEVER_INLINE FLATTEN static ErrorOr<void> unfilter(PNGLoadingContext& context)
+{
+    // First unfilter the scanlines:
+
+    // FIXME: Instead of creating a separate buffer for the scanlines that need to be
+    //        mutated, the mutation could be done in place (if the data was non-const).
+    size_t bytes_per_scanline = context.scanlines[0].data.size();
+    size_t bytes_needed_for_all_unfiltered_scanlines = 0;
+    for (int y = 0; y < context.height; ++y) {
+        if (context.scanlines[y].filter != PNG::FilterType::None) {
+            bytes_needed_for_all_unfiltered_scanlines += bytes_per_scanline;
+        }
+    }
+    context.unfiltered_data = TRY(ByteBuffer::create_uninitialized(bytes_needed_for_all_unfiltered_scanlines));
+
+    // From section 6.3 of http://www.libpng.org/pub/png/spec/1.2/PNG-Filters.html
+    // "bpp is defined as the number of bytes per complete pixel, rounding up to one.
+    // For example, for color type 2 with a bit depth of 16, bpp is equal to 6
+    // (three samples, two bytes per sample); for color type 0 with a bit depth of 2,
+    // bpp is equal to 1 (rounding up); for color type 4 with a bit depth of 16, bpp
+    // is equal to 4 (two-byte grayscale sample, plus two-byte alpha sample)."
+    u8 bytes_per_complete_pixel = (context.bit_depth + 7) / 8 * context.channels;
+
+    u8 dummy_scanline_bytes[bytes_per_scanline];
+    memset(dummy_scanline_bytes, 0, sizeof(dummy_scanline_bytes));
+    auto previous_scanlines_data = ReadonlyBytes { dummy_scanline_bytes, sizeof(dummy_scanline_bytes) };
+
+    for (int y = 0, data_start = 0; y < context.height; ++y) {
+        if (context.scanlines[y].filter != PNG::FilterType::None) {
+            auto scanline_data_slice = context.unfiltered_data.bytes().slice(data_start, bytes_per_scanline);
+
+            // Copy the current values over and set the scanline's data to the to-be-mutated slice
+            context.scanlines[y].data.copy_to(scanline_data_slice);
+            context.scanlines[y].data = scanline_data_slice;
+
+            unfilter_scanline(context.scanlines[y].filter, scanline_data_slice, previous_scanlines_data, bytes_per_complete_pixel);
+
+            data_start += bytes_per_scanline;
+        }
+        previous_scanlines_data = context.scanlines[y].data;
+    }
+
+    // Now unpack the scanlines to RGBA. Unlike unfiltering, this doesn't depend on the previous scanline, so bands of
+    // rows can be unpacked on separate threads.
+    return decode_rows_in_parallel({ context.width, context.height }, [&](int first_row, int end_row) {
+        return unpack_scanlines(context, first_row, end_row);
+    });
+}
+
 static bool decode_png_header(PNGLoadingContext& context)
 {
     if (context.state >= PNGLoadingContext::HeaderDecoded)
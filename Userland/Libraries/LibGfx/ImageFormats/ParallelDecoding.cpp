@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Atomic.h>
+#include <AK/Vector.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/ThreadPool.h>
+
+namespace Gfx {
+
+static Atomic<size_t> s_thread_count { 1 };
+
+// Bands smaller than this aren't worth handing to another thread.
+static constexpr size_t minimum_pixels_per_band = 64 * 1024;
+
+void set_image_decoding_thread_count(size_t thread_count)
+{
+    VERIFY(thread_count > 0);
+    s_thread_count = thread_count;
+}
+
+size_t image_decoding_thread_count()
+{
+    return s_thread_count;
+}
+
+ErrorOr<void> decode_in_parallel(size_t task_count, Function<ErrorOr<void>(size_t task_index)> const& task)
+{
+    auto helper_count = min(image_decoding_thread_count(), task_count);
+    if (helper_count <= 1) {
+        for (size_t i = 0; i < task_count; ++i)
+            TRY(task(i));
+        return {};
+    }
+    // The current thread runs tasks as well.
+    --helper_count;
+
+    Atomic<size_t> next_task_index { 0 };
+    auto run_tasks = [&]() -> ErrorOr<void> {
+        while (true) {
+            auto task_index = next_task_index.fetch_add(1);
+            if (task_index >= task_count)
+                return {};
+            TRY(task(task_index));
+        }
+    };
+
+    // Protects the helper bookkeeping below.
+    Threading::Mutex mutex;
+    Threading::ConditionVariable helper_finished { mutex };
+    size_t running_helper_count = 0;
+    Optional<Error> helper_error;
+
+    auto run_helper = [&] {
+        auto result = run_tasks();
+        Threading::MutexLocker locker(mutex);
+        if (result.is_error() && !helper_error.has_value())
+            helper_error = result.release_error();
+        --running_helper_count;
+        helper_finished.signal();
+    };
+
+    Vector<NonnullRefPtr<Threading::ThreadPool::Task>> helpers;
+    TRY(helpers.try_ensure_capacity(helper_count));
+    for (size_t i = 0; i < helper_count; ++i) {
+        {
+            Threading::MutexLocker locker(mutex);
+            ++running_helper_count;
+        }
+        auto helper = Threading::ThreadPool::the().submit([&] { run_helper(); }, Threading::ThreadPool::Priority::High);
+        if (helper.is_error()) {
+            // Not being able to get help isn't fatal, this thread works through the remaining tasks on its own.
+            Threading::MutexLocker locker(mutex);
+            --running_helper_count;
+            break;
+        }
+        helpers.unchecked_append(helper.release_value());
+    }
+
+    auto result = run_tasks();
+
+    // All tasks have been handed out by now, so helpers that haven't started have nothing left to do. They might
+    // never start if the pool is busy, e.g. when the image is being decoded on one of its workers.
+    for (auto& helper : helpers) {
+        if (helper->cancel()) {
+            Threading::MutexLocker locker(mutex);
+            --running_helper_count;
+        }
+    }
+
+    Threading::MutexLocker locker(mutex);
+    while (running_helper_count > 0)
+        helper_finished.wait();
+    if (!result.is_error() && helper_error.has_value())
+        result = helper_error.release_value();
+    return result;
+}
+
+ErrorOr<void> decode_rows_in_parallel(IntSize size, Function<ErrorOr<void>(int first_row, int end_row)> const& task)
+{
+    if (size.is_empty())
+        return {};
+
+    auto pixel_count = static_cast<size_t>(size.width()) * size.height();
+    auto band_count = min(image_decoding_thread_count(), pixel_count / minimum_pixels_per_band);
+    band_count = min(band_count, static_cast<size_t>(size.height()));
+    if (band_count <= 1)
+        return task(0, size.height());
+
+    auto rows_per_band = ceil_div(size.height(), static_cast<int>(band_count));
+    band_count = ceil_div(size.height(), rows_per_band);
+    return decode_in_parallel(band_count, [&](size_t band) {
+        int first_row = band * rows_per_band;
+        return task(first_row, min(first_row + rows_per_band, size.height()));
+    });
+}
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Error.h>
+#include <AK/Function.h>
+#include <LibGfx/Size.h>
+
+namespace Gfx {
+
+// Image decoders split work that doesn't depend on earlier results (color conversion, independently coded parts of a
+// stream, ...) into tasks that run on up to this many threads, including the decoding thread.
+// This defaults to 1: on Serenity, spawning threads needs the "thread" pledge, so processes have to opt in.
+void set_image_decoding_thread_count(size_t);
+size_t image_decoding_thread_count();
+
+// Runs `task` for every index in [0, task_count) and returns the first error any of them returned.
+// Tasks run in no particular order, so they must only touch data no other task touches.
+ErrorOr<void> decode_in_parallel(size_t task_count, Function<ErrorOr<void>(size_t task_index)> const& task);
+
+// Splits the rows of an image of the given size into bands and runs `task` once per band with its [first_row, end_row).
+// Small images are handled in a single band on the calling thread, since starting threads would cost more than it saves.
+ErrorOr<void> decode_rows_in_parallel(IntSize, Function<ErrorOr<void>(int first_row, int end_row)> const& task);
+
+}
@@ -11,6 +11,7 @@
 #include <AK/MemoryStream.h>
 #include <AK/Vector.h>
 #include <LibCompress/Deflate.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
 #include <LibGfx/ImageFormats/WebPLoaderLossless.h>
 
 // Lossless format: https://developers.google.com/speed/webp/docs/webp_lossless_bitstream_specification
@@ -626,7 +627,7 @@ ErrorOr<NonnullRefPtr<Bitmap>> PredictorTransform::transform(NonnullRefPtr<Bitma
 
         ARGB32 TL = bitmap_previous_scanline[0];
         ARGB32 T = bitmap_previous_scanline[1];
-        ARGB32 TR = 2 < bitmap.width() ? bitmap_previous_scanline[2] : bitmap_previous_scanline[0];
+        ARGB32 TR = 2 < bitmap.width() ? bitmap_previous_scanline[2] : bitmap_scanline[0];
 
         ARGB32 L = bitmap_scanline[0];
 
@@ -649,7 +650,7 @@ ErrorOr<NonnullRefPtr<Bitmap>> PredictorTransform::transform(NonnullRefPtr<Bitma
             // "Addressing the TR-pixel for pixels on the rightmost column is exceptional.
             //  The pixels on the rightmost column are predicted by using the modes [0..13] just like pixels not on the border,
             //  but the leftmost pixel on the same row as the current pixel is instead used as the TR-pixel."
-            TR = x + 2 < bitmap.width() ? bitmap_previous_scanline[x + 2] : bitmap_previous_scanline[0];
+            TR = x + 2 < bitmap.width() ? bitmap_previous_scanline[x + 2] : bitmap_scanline[0];
 
             L = bitmap_scanline[x];
         }
@@ -767,17 +768,20 @@ ErrorOr<NonnullRefPtr<Bitmap>> ColorTransform::transform(NonnullRefPtr<Bitmap> b
 {
     Bitmap& bitmap = *bitmap_ref;
 
-    for (int y = 0; y < bitmap.height(); ++y) {
-        ARGB32* bitmap_scanline = bitmap.scanline(y);
+    TRY(decode_rows_in_parallel(bitmap.size(), [&](int first_row, int end_row) -> ErrorOr<void> {
+        for (int y = first_row; y < end_row; ++y) {
+            ARGB32* bitmap_scanline = bitmap.scanline(y);
 
-        int color_y = y >> m_size_bits;
-        ARGB32* color_scanline = m_color_bitmap->scanline(color_y);
+            int color_y = y >> m_size_bits;
+            ARGB32* color_scanline = m_color_bitmap->scanline(color_y);
 
-        for (int x = 0; x < bitmap.width(); ++x) {
-            int color_x = x >> m_size_bits;
-            bitmap_scanline[x] = inverse_transform(bitmap_scanline[x], color_scanline[color_x]);
+            for (int x = 0; x < bitmap.width(); ++x) {
+                int color_x = x >> m_size_bits;
+                bitmap_scanline[x] = inverse_transform(bitmap_scanline[x], color_scanline[color_x]);
+            }
         }
-    }
+        return {};
+    }));
     return bitmap_ref;
 }
 
@@ -815,12 +819,17 @@ public:
 
 ErrorOr<NonnullRefPtr<Bitmap>> SubtractGreenTransform::transform(NonnullRefPtr<Bitmap> bitmap)
 {
-    for (ARGB32& pixel : *bitmap) {
-        Color color = Color::from_argb(pixel);
-        u8 red = (color.red() + color.green()) & 0xff;
-        u8 blue = (color.blue() + color.green()) & 0xff;
-        pixel = Color(red, color.green(), blue, color.alpha()).value();
-    }
+    TRY(decode_rows_in_parallel(bitmap->size(), [&](int first_row, int end_row) -> ErrorOr<void> {
+        for (int y = first_row; y < end_row; ++y) {
+            for (ARGB32& pixel : Span<ARGB32> { bitmap->scanline(y), static_cast<size_t>(bitmap->width()) }) {
+                Color color = Color::from_argb(pixel);
+                u8 red = (color.red() + color.green()) & 0xff;
+                u8 blue = (color.blue() + color.green()) & 0xff;
+                pixel = Color(red, color.green(), blue, color.alpha()).value();
+            }
+        }
+        return {};
+    }));
     return bitmap;
 }
 
@@ -891,13 +900,18 @@ ErrorOr<NonnullRefPtr<Bitmap>> ColorIndexingTransform::transform(NonnullRefPtr<B
     // FIXME: If this is the last transform, consider returning an Indexed8 bitmap here?
 
     if (pixels_per_pixel() == 1) {
-        for (ARGB32& pixel : *bitmap) {
-            // "The inverse transform for the image is simply replacing the pixel values (which are indices to the color table)
-            //  with the actual color table values. The indexing is done based on the green component of the ARGB color. [...]
-            //  If the index is equal or larger than color_table_size, the argb color value should be set to 0x00000000 (transparent black)."
-            u8 index = Color::from_argb(pixel).green();
-            pixel = index < m_palette_bitmap->width() ? m_palette_bitmap->scanline(0)[index] : 0;
-        }
+        TRY(decode_rows_in_parallel(bitmap->size(), [&](int first_row, int end_row) -> ErrorOr<void> {
+            for (int y = first_row; y < end_row; ++y) {
+                for (ARGB32& pixel : Span<ARGB32> { bitmap->scanline(y), static_cast<size_t>(bitmap->width()) }) {
+                    // "The inverse transform for the image is simply replacing the pixel values (which are indices to the color table)
+                    //  with the actual color table values. The indexing is done based on the green component of the ARGB color. [...]
+                    //  If the index is equal or larger than color_table_size, the argb color value should be set to 0x00000000 (transparent black)."
+                    u8 index = Color::from_argb(pixel).green();
+                    pixel = index < m_palette_bitmap->width() ? m_palette_bitmap->scanline(0)[index] : 0;
+                }
+            }
+            return {};
+        }));
         return bitmap;
     }
 
@@ -908,20 +922,24 @@ ErrorOr<NonnullRefPtr<Bitmap>> ColorIndexingTransform::transform(NonnullRefPtr<B
 
     unsigned bits_per_pixel = 8 / pixels_per_pixel();
     unsigned pixel_mask = (1 << bits_per_pixel) - 1;
-    for (int y = 0; y < bitmap->height(); ++y) {
-        ARGB32* bitmap_scanline = bitmap->scanline(y);
-        ARGB32* new_bitmap_scanline = new_bitmap->scanline(y);
-
-        for (int x = 0, new_x = 0; x < bitmap->width(); ++x, new_x += pixels_per_pixel()) {
-            u8 indexes = Color::from_argb(bitmap_scanline[x]).green();
-
-            for (int i = 0; i < pixels_per_pixel(); ++i) {
-                u8 index = indexes & pixel_mask;
-                new_bitmap_scanline[new_x + i] = index < m_palette_bitmap->width() ? m_palette_bitmap->scanline(0)[index] : 0;
-                indexes >>= bits_per_pixel;
+    TRY(decode_rows_in_parallel(unbundled_size, [&](int first_row, int end_row) -> ErrorOr<void> {
+        for (int y = first_row; y < end_row; ++y) {
+            ARGB32* bitmap_scanline = bitmap->scanline(y);
+            ARGB32* new_bitmap_scanline = new_bitmap->scanline(y);
+
+            for (int x = 0, new_x = 0; x < bitmap->width(); ++x, new_x += pixels_per_pixel()) {
+                u8 indexes = Color::from_argb(bitmap_scanline[x]).green();
+
+                // The last input pixel of a row can encode more pixels than are left in the output row.
+                for (int i = 0; i < pixels_per_pixel() && new_x + i < m_original_width; ++i) {
+                    u8 index = indexes & pixel_mask;
+                    new_bitmap_scanline[new_x + i] = index < m_palette_bitmap->width() ? m_palette_bitmap->scanline(0)[index] : 0;
+                    indexes >>= bits_per_pixel;
+                }
             }
         }
-    }
+        return {};
+    }));
 
     return new_bitmap;
 }
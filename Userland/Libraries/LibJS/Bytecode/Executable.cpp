@@ -5,9 +5,12 @@
  */
 
 #include <LibJS/Bytecode/Executable.h>
+#include <LibJS/JIT/NativeExecutable.h>
 
 namespace JS::Bytecode {
 
+Executable::~Executable() = default;
+
 void Executable::dump() const
 {
     dbgln("\033[33;1mJS::Bytecode::Executable\033[0m ({})", name);
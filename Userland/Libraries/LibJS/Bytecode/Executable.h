@@ -8,13 +8,17 @@
 
 #include <AK/DeprecatedFlyString.h>
 #include <AK/NonnullOwnPtr.h>
+#include <AK/OwnPtr.h>
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/IdentifierTable.h>
 #include <LibJS/Bytecode/StringTable.h>
+#include <LibJS/Forward.h>
 
 namespace JS::Bytecode {
 
 struct Executable {
+    ~Executable();
+
     DeprecatedFlyString name;
     Vector<NonnullOwnPtr<BasicBlock>> basic_blocks;
     NonnullOwnPtr<StringTable> string_table;
@@ -22,6 +26,11 @@ struct Executable {
     size_t number_of_registers { 0 };
     bool is_strict_mode { false };
 
+    // Tier-up state for the baseline JIT. Calls and taken jumps both make an executable hotter.
+    mutable u32 hotness { 0 };
+    mutable bool did_try_jit_compilation { false };
+    mutable OwnPtr<JIT::NativeExecutable> native_executable;
+
     DeprecatedString const& get_string(StringTableIndex index) const { return string_table->get(index); }
     DeprecatedFlyString const& get_identifier(IdentifierTableIndex index) const { return identifier_table->get(index); }
 
@@ -60,7 +60,10 @@ CodeGenerationErrorOr<NonnullOwnPtr<Executable>> Generator::generate(ASTNode con
         .string_table = move(generator.m_string_table),
         .identifier_table = move(generator.m_identifier_table),
         .number_of_registers = generator.m_next_register,
-        .is_strict_mode = is_strict_mode });
+        .is_strict_mode = is_strict_mode,
+        .hotness = 0,
+        .did_try_jit_compilation = false,
+        .native_executable = nullptr });
 }
 
 void Generator::grow(size_t additional_size)
@@ -11,6 +11,7 @@
 #include <LibJS/Bytecode/Interpreter.h>
 #include <LibJS/Bytecode/Op.h>
 #include <LibJS/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
 #include <LibJS/Runtime/GlobalEnvironment.h>
 #include <LibJS/Runtime/GlobalObject.h>
 #include <LibJS/Runtime/Realm.h>
@@ -20,6 +21,9 @@ namespace JS::Bytecode {
 static Interpreter* s_current;
 bool g_dump_bytecode = false;
 
+bool Interpreter::s_jit_enabled = false;
+u32 Interpreter::s_jit_threshold = 50;
+
 Interpreter* Interpreter::current()
 {
     return s_current;
@@ -39,6 +43,52 @@ Interpreter::~Interpreter()
     s_current = nullptr;
 }
 
+ALWAYS_INLINE Interpreter::ExitReason Interpreter::execute_instruction_impl(Instruction const& instruction)
+{
+    auto ran_or_error = instruction.execute(*this);
+    if (ran_or_error.is_error()) {
+        auto exception_value = *ran_or_error.throw_completion().value();
+        m_saved_exception = make_handle(exception_value);
+        if (unwind_contexts().is_empty())
+            return ExitReason::Exception;
+        auto& unwind_context = unwind_contexts().last();
+        if (unwind_context.executable != m_current_executable)
+            return ExitReason::Exception;
+        if (unwind_context.handler) {
+            vm().running_execution_context().lexical_environment = unwind_context.lexical_environment;
+            vm().running_execution_context().variable_environment = unwind_context.variable_environment;
+            m_current_block = unwind_context.handler;
+            unwind_context.handler = nullptr;
+
+            accumulator() = exception_value;
+            m_saved_exception = {};
+            return ExitReason::Jump;
+        }
+        if (unwind_context.finalizer) {
+            m_current_block = unwind_context.finalizer;
+            return ExitReason::Jump;
+        }
+        // An unwind context with no handler or finalizer? We have nowhere to jump, and continuing on will make us crash on the next `Call` to a non-native function if there's an exception! So let's crash here instead.
+        // If you run into this, you probably forgot to remove the current unwind_context somewhere.
+        VERIFY_NOT_REACHED();
+    }
+    if (m_pending_jump.has_value()) {
+        m_current_block = m_pending_jump.release_value();
+        return ExitReason::Jump;
+    }
+    if (!m_return_value.is_empty()) {
+        // Note: A `yield` statement will not go through a finally statement,
+        //       hence we need to set a flag to not do so,
+        //       but we generate a Yield Operation in the case of returns in
+        //       generators as well, so we need to check if it will actually
+        //       continue or is a `return` in disguise
+        if (instruction.type() == Instruction::Type::Yield && static_cast<Op::Yield const&>(instruction).continuation().has_value())
+            return ExitReason::Yield;
+        return ExitReason::Return;
+    }
+    return ExitReason::None;
+}
+
 Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& executable, BasicBlock const* entry_point, RegisterWindow* in_frame)
 {
     dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter will run unit {:p}", &executable);
@@ -71,67 +121,35 @@ Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& e
 
     registers().resize(executable.number_of_registers);
 
+    tier_up_if_hot(executable);
+
     for (;;) {
-        Bytecode::InstructionStreamIterator pc(m_current_block->instruction_stream());
-        TemporaryChange temp_change { m_pc, &pc };
-
-        // FIXME: This is getting kinda spaghetti-y
-        bool will_jump = false;
-        bool will_return = false;
-        bool will_yield = false;
-        while (!pc.at_end()) {
-            auto& instruction = *pc;
-            auto ran_or_error = instruction.execute(*this);
-            if (ran_or_error.is_error()) {
-                auto exception_value = *ran_or_error.throw_completion().value();
-                m_saved_exception = make_handle(exception_value);
-                if (unwind_contexts().is_empty())
+        auto exit_reason = ExitReason::None;
+        bool did_reach_end_of_block = false;
+
+        if (auto const* native_executable = executable.native_executable.ptr()) {
+            TemporaryChange temp_change { m_pc, static_cast<InstructionStreamIterator*>(nullptr) };
+            exit_reason = native_executable->run(*this, registers().data(), m_current_block);
+            did_reach_end_of_block = exit_reason == ExitReason::None;
+        } else {
+            Bytecode::InstructionStreamIterator pc(m_current_block->instruction_stream());
+            TemporaryChange temp_change { m_pc, &pc };
+
+            while (!pc.at_end()) {
+                exit_reason = execute_instruction_impl(*pc);
+                if (exit_reason != ExitReason::None)
                     break;
-                auto& unwind_context = unwind_contexts().last();
-                if (unwind_context.executable != m_current_executable)
-                    break;
-                if (unwind_context.handler) {
-                    vm().running_execution_context().lexical_environment = unwind_context.lexical_environment;
-                    vm().running_execution_context().variable_environment = unwind_context.variable_environment;
-                    m_current_block = unwind_context.handler;
-                    unwind_context.handler = nullptr;
-
-                    accumulator() = exception_value;
-                    m_saved_exception = {};
-                    will_jump = true;
-                    break;
-                }
-                if (unwind_context.finalizer) {
-                    m_current_block = unwind_context.finalizer;
-                    will_jump = true;
-                    break;
-                }
-                // An unwind context with no handler or finalizer? We have nowhere to jump, and continuing on will make us crash on the next `Call` to a non-native function if there's an exception! So let's crash here instead.
-                // If you run into this, you probably forgot to remove the current unwind_context somewhere.
-                VERIFY_NOT_REACHED();
+                ++pc;
             }
-            if (m_pending_jump.has_value()) {
-                m_current_block = m_pending_jump.release_value();
-                will_jump = true;
-                break;
-            }
-            if (!m_return_value.is_empty()) {
-                will_return = true;
-                // Note: A `yield` statement will not go through a finally statement,
-                //       hence we need to set a flag to not do so,
-                //       but we generate a Yield Operation in the case of returns in
-                //       generators as well, so we need to check if it will actually
-                //       continue or is a `return` in disguise
-                will_yield = instruction.type() == Instruction::Type::Yield && static_cast<Op::Yield const&>(instruction).continuation().has_value();
-                break;
-            }
-            ++pc;
+            did_reach_end_of_block = pc.at_end();
         }
 
-        if (will_jump)
+        if (exit_reason == ExitReason::Jump) {
+            tier_up_if_hot(executable);
             continue;
+        }
 
-        if (!unwind_contexts().is_empty() && !will_yield) {
+        if (!unwind_contexts().is_empty() && exit_reason != ExitReason::Yield) {
             auto& unwind_context = unwind_contexts().last();
             if (unwind_context.executable == m_current_executable && unwind_context.finalizer) {
                 m_saved_return_value = make_handle(m_return_value);
@@ -142,13 +160,13 @@ Interpreter::ValueAndFrame Interpreter::run_and_return_frame(Executable const& e
             }
         }
 
-        if (pc.at_end())
+        if (did_reach_end_of_block)
             break;
 
         if (!m_saved_exception.is_null())
             break;
 
-        if (will_return)
+        if (exit_reason == ExitReason::Return || exit_reason == ExitReason::Yield)
             break;
     }
 
@@ -245,6 +263,23 @@ ThrowCompletionOr<void> Interpreter::continue_pending_unwind(Label const& resume
     return {};
 }
 
+Interpreter::ExitReason Interpreter::execute_instruction(Instruction const& instruction)
+{
+    return execute_instruction_impl(instruction);
+}
+
+void Interpreter::tier_up_if_hot(Executable const& executable)
+{
+    if (!s_jit_enabled || executable.did_try_jit_compilation)
+        return;
+    if (++executable.hotness < s_jit_threshold)
+        return;
+
+    executable.did_try_jit_compilation = true;
+    executable.native_executable = JIT::Compiler::compile(executable);
+    dbgln_if(JS_BYTECODE_DEBUG, "Bytecode::Interpreter compiled unit {:p} to {} bytes of native code", &executable, executable.native_executable ? executable.native_executable->size() : 0);
+}
+
 VM::InterpreterExecutionScope Interpreter::ast_interpreter_scope()
 {
     if (!m_ast_interpreter)
@@ -93,7 +93,28 @@ public:
 
     VM::InterpreterExecutionScope ast_interpreter_scope();
 
+    // What the run loop has to do after an instruction has been executed.
+    enum class ExitReason : u32 {
+        None,      // Carry on with the next instruction.
+        Jump,      // Continue at the (already updated) current block.
+        Return,    // Leave the executable, or run the pending finalizer first.
+        Yield,     // Leave the executable without running any finalizers.
+        Exception, // Leave the executable with m_saved_exception set.
+    };
+
+    // Executes a single instruction of the current executable, and deals with exceptions and pending jumps.
+    // This is also how JIT-compiled code runs the instructions it doesn't have a fast path for.
+    ExitReason execute_instruction(Instruction const&);
+
+    // The baseline JIT is off unless explicitly enabled. Executables are compiled once they get hot enough.
+    static bool jit_enabled() { return s_jit_enabled; }
+    static void set_jit_enabled(bool enabled) { s_jit_enabled = enabled; }
+    static void set_jit_threshold(u32 threshold) { s_jit_threshold = threshold; }
+
 private:
+    ExitReason execute_instruction_impl(Instruction const&);
+    void tier_up_if_hot(Executable const&);
+
     RegisterWindow& window()
     {
         return m_register_windows.last().visit([](auto& x) -> RegisterWindow& { return *x; });
@@ -106,6 +127,9 @@ private:
 
     MarkedVector<Value>& registers() { return window().registers; }
 
+    static bool s_jit_enabled;
+    static u32 s_jit_threshold;
+
     static AK::Array<OwnPtr<PassManager>, static_cast<UnderlyingType<Interpreter::OptimizationLevel>>(Interpreter::OptimizationLevel::__Count)> s_optimization_pipelines;
 
     VM& m_vm;
@@ -493,7 +493,14 @@ ThrowCompletionOr<void> GetById::execute_impl(Bytecode::Interpreter& interpreter
 {
     auto& vm = interpreter.vm();
     auto object = TRY(interpreter.accumulator().to_object(vm));
-    interpreter.accumulator() = TRY(object->get(interpreter.current_executable().get_identifier(m_property)));
+    if (auto value = TRY(m_cache.get(vm, *object)); value.has_value()) {
+        interpreter.accumulator() = *value;
+        return {};
+    }
+
+    auto const& name = interpreter.current_executable().get_identifier(m_property);
+    interpreter.accumulator() = TRY(object->get(name));
+    m_cache.update_after_get(vm, *object, name);
     return {};
 }
 
@@ -501,9 +508,18 @@ ThrowCompletionOr<void> PutById::execute_impl(Bytecode::Interpreter& interpreter
 {
     auto& vm = interpreter.vm();
     auto object = TRY(interpreter.reg(m_base).to_object(vm));
-    PropertyKey name = interpreter.current_executable().get_identifier(m_property);
+    auto const& name = interpreter.current_executable().get_identifier(m_property);
     auto value = interpreter.accumulator();
-    return put_by_property_key(object, value, name, interpreter, m_kind);
+    if (m_kind != PropertyKind::KeyValue)
+        return put_by_property_key(object, value, name, interpreter, m_kind);
+
+    if (m_cache.put(vm, *object, value))
+        return {};
+
+    auto& old_shape = object->shape();
+    TRY(put_by_property_key(object, value, name, interpreter, m_kind));
+    m_cache.update_after_put(vm, *object, old_shape, name);
+    return {};
 }
 
 ThrowCompletionOr<void> DeleteById::execute_impl(Bytecode::Interpreter& interpreter) const
@@ -871,9 +887,44 @@ void Yield::replace_references_impl(BasicBlock const& from, BasicBlock const& to
         m_continuation_label = Label { to };
 }
 
+// Arrays index their elements like ordinary objects do, so an element that is present in simple storage can be read
+// and overwritten directly.
+static Array* array_for_fast_indexed_access(Value base, Value property)
+{
+    if (!base.is_object() || !property.is_int32() || property.as_i32() < 0)
+        return nullptr;
+    auto& object = base.as_object();
+    if (!is<Array>(object))
+        return nullptr;
+    return static_cast<Array*>(&object);
+}
+
+// Appending to an array would have to look for setters up the prototype chain, unless that chain is the untouched
+// Array.prototype -> Object.prototype with no indexed properties on either.
+static bool can_append_to_array_without_side_effects(VM& vm, Array& array)
+{
+    if (!array.length_is_writable() || !MUST(array.is_extensible()))
+        return false;
+    auto& intrinsics = vm.current_realm()->intrinsics();
+    auto array_prototype = intrinsics.array_prototype();
+    auto object_prototype = intrinsics.object_prototype();
+    return array.shape().prototype() == array_prototype.ptr()
+        && array_prototype->shape().prototype() == object_prototype.ptr()
+        && array_prototype->indexed_properties().is_empty()
+        && object_prototype->indexed_properties().is_empty();
+}
+
 ThrowCompletionOr<void> GetByValue::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
+    if (auto* array = array_for_fast_indexed_access(interpreter.reg(m_base), interpreter.accumulator())) {
+        auto value = array->indexed_properties().get_from_simple_storage(interpreter.accumulator().as_i32());
+        if (!value.is_empty()) {
+            interpreter.accumulator() = value;
+            return {};
+        }
+    }
+
     auto object = TRY(interpreter.reg(m_base).to_object(vm));
 
     auto property_key = TRY(interpreter.accumulator().to_property_key(vm));
@@ -885,6 +936,19 @@ ThrowCompletionOr<void> GetByValue::execute_impl(Bytecode::Interpreter& interpre
 ThrowCompletionOr<void> PutByValue::execute_impl(Bytecode::Interpreter& interpreter) const
 {
     auto& vm = interpreter.vm();
+    if (m_kind == PropertyKind::KeyValue) {
+        if (auto* array = array_for_fast_indexed_access(interpreter.reg(m_base), interpreter.reg(m_property))) {
+            u32 index = interpreter.reg(m_property).as_i32();
+            auto& indexed_properties = array->indexed_properties();
+            if (indexed_properties.set_existing_element_in_simple_storage(index, interpreter.accumulator()))
+                return {};
+            if (index == indexed_properties.array_like_size() && can_append_to_array_without_side_effects(vm, *array)) {
+                indexed_properties.append(interpreter.accumulator());
+                return {};
+            }
+        }
+    }
+
     auto object = TRY(interpreter.reg(m_base).to_object(vm));
 
     auto property_key = TRY(interpreter.reg(m_property).to_property_key(vm));
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/Bytecode/PropertyLookupCache.h>
+#include <LibJS/Runtime/AbstractOperations.h>
+#include <LibJS/Runtime/Accessor.h>
+#include <LibJS/Runtime/Object.h>
+#include <LibJS/Runtime/VM.h>
+
+namespace JS::Bytecode {
+
+PropertyLookupCacheStatistics g_property_lookup_cache_statistics;
+
+// The length of an array isn't stored in its shape, and an array can have the same shape as an ordinary object.
+static bool is_cacheable_property_name(VM& vm, DeprecatedFlyString const& name)
+{
+    return name != vm.names.length.as_string();
+}
+
+PropertyLookupCache::Entry const* PropertyLookupCache::find(VM& vm, Object const& object) const
+{
+    if (object.may_interfere_with_property_lookup_caching())
+        return nullptr;
+
+    for (auto const& entry : m_entries) {
+        if (entry.shape.ptr() != &object.shape())
+            continue;
+        if (entry.kind != Entry::Kind::OwnProperty && entry.prototype_chain_generation != vm.prototype_chain_generation())
+            return nullptr;
+        return &entry;
+    }
+    return nullptr;
+}
+
+PropertyLookupCache::Entry& PropertyLookupCache::entry_to_replace(Shape const& shape)
+{
+    // An entry for the same shape is stale, since its prototype chain must have changed.
+    for (auto& entry : m_entries) {
+        if (entry.shape.ptr() == &shape)
+            return entry;
+    }
+
+    for (auto& entry : m_entries) {
+        if (!entry.shape)
+            return entry;
+    }
+
+    auto& entry = m_entries[m_next_entry_to_replace];
+    m_next_entry_to_replace = (m_next_entry_to_replace + 1) % max_entries;
+    return entry;
+}
+
+ThrowCompletionOr<Optional<Value>> PropertyLookupCache::get(VM& vm, Object& object) const
+{
+    auto const* entry = find(vm, object);
+    if (!entry) {
+        ++g_property_lookup_cache_statistics.get_misses;
+        return Optional<Value> {};
+    }
+    ++g_property_lookup_cache_statistics.get_hits;
+
+    auto const& holder = entry->kind == Entry::Kind::PrototypeProperty ? *entry->prototype : object;
+    auto value = holder.get_direct(entry->property_offset);
+    if (!value.is_accessor())
+        return value;
+
+    auto* getter = value.as_accessor().getter();
+    if (!getter)
+        return js_undefined();
+    return TRY(call(vm, *getter, &object));
+}
+
+void PropertyLookupCache::update_after_get(VM& vm, Object& object, DeprecatedFlyString const& name)
+{
+    if (!is_cacheable_property_name(vm, name))
+        return;
+
+    // Unique shapes are changed in place, so they can't identify the properties of an object.
+    auto& shape = object.shape();
+    if (shape.is_unique() || object.may_interfere_with_property_lookup_caching())
+        return;
+
+    StringOrSymbol key { name };
+    if (auto metadata = shape.lookup(key); metadata.has_value()) {
+        entry_to_replace(shape) = {
+            .kind = Entry::Kind::OwnProperty,
+            .shape = shape.make_weak_ptr<Shape>(),
+            .prototype = nullptr,
+            .new_shape = {},
+            .property_offset = metadata->offset,
+            .prototype_chain_generation = 0,
+        };
+        return;
+    }
+
+    for (auto* prototype = shape.prototype(); prototype; prototype = prototype->shape().prototype()) {
+        if (prototype->may_interfere_with_property_lookup_caching())
+            return;
+
+        auto metadata = prototype->shape().lookup(key);
+        if (!metadata.has_value())
+            continue;
+
+        // Giving any of the prototypes before this one the same property would shadow it.
+        for (auto* object_in_chain = shape.prototype();; object_in_chain = object_in_chain->shape().prototype()) {
+            object_in_chain->set_used_by_cached_prototype_chain_lookup();
+            if (object_in_chain == prototype)
+                break;
+        }
+
+        entry_to_replace(shape) = {
+            .kind = Entry::Kind::PrototypeProperty,
+            .shape = shape.make_weak_ptr<Shape>(),
+            .prototype = prototype,
+            .new_shape = {},
+            .property_offset = metadata->offset,
+            .prototype_chain_generation = vm.prototype_chain_generation(),
+        };
+        return;
+    }
+}
+
+bool PropertyLookupCache::put(VM& vm, Object& object, Value value) const
+{
+    auto const* entry = find(vm, object);
+
+    bool stored = false;
+    if (entry && entry->kind == Entry::Kind::OwnProperty) {
+        object.put_direct(entry->property_offset, value);
+        stored = true;
+    } else if (entry && entry->kind == Entry::Kind::PutTransition) {
+        if (auto* new_shape = entry->new_shape.ptr())
+            stored = object.add_property_with_cached_transition(*new_shape, value);
+    }
+
+    if (stored)
+        ++g_property_lookup_cache_statistics.put_hits;
+    else
+        ++g_property_lookup_cache_statistics.put_misses;
+    return stored;
+}
+
+void PropertyLookupCache::update_after_put(VM& vm, Object& object, Shape& old_shape, DeprecatedFlyString const& name)
+{
+    if (!is_cacheable_property_name(vm, name))
+        return;
+
+    auto& shape = object.shape();
+    if (old_shape.is_unique() || shape.is_unique() || object.may_interfere_with_property_lookup_caching())
+        return;
+
+    StringOrSymbol key { name };
+    if (&shape == &old_shape) {
+        auto metadata = shape.lookup(key);
+        if (!metadata.has_value() || !metadata->attributes.is_writable() || object.get_direct(metadata->offset).is_accessor())
+            return;
+
+        entry_to_replace(shape) = {
+            .kind = Entry::Kind::OwnProperty,
+            .shape = shape.make_weak_ptr<Shape>(),
+            .prototype = nullptr,
+            .new_shape = {},
+            .property_offset = metadata->offset,
+            .prototype_chain_generation = 0,
+        };
+        return;
+    }
+
+    // Otherwise the property must have been added, moving the object to a put transition of its old shape.
+    if (old_shape.lookup(key).has_value() || shape.prototype() != old_shape.prototype() || shape.property_count() != old_shape.property_count() + 1)
+        return;
+    auto metadata = shape.lookup(key);
+    if (!metadata.has_value() || metadata->offset != old_shape.property_count() || metadata->attributes != default_attributes)
+        return;
+
+    // A setter or a read-only property on the prototype chain would have kept the property from being added.
+    for (auto* prototype = shape.prototype(); prototype; prototype = prototype->shape().prototype()) {
+        if (prototype->may_interfere_with_property_lookup_caching())
+            return;
+        auto prototype_metadata = prototype->shape().lookup(key);
+        if (prototype_metadata.has_value() && (!prototype_metadata->attributes.is_writable() || prototype->get_direct(prototype_metadata->offset).is_accessor()))
+            return;
+    }
+    for (auto* prototype = shape.prototype(); prototype; prototype = prototype->shape().prototype())
+        prototype->set_used_by_cached_prototype_chain_lookup();
+
+    entry_to_replace(old_shape) = {
+        .kind = Entry::Kind::PutTransition,
+        .shape = old_shape.make_weak_ptr<Shape>(),
+        .prototype = nullptr,
+        .new_shape = shape.make_weak_ptr<Shape>(),
+        .property_offset = metadata->offset,
+        .prototype_chain_generation = vm.prototype_chain_generation(),
+    };
+}
+
+}
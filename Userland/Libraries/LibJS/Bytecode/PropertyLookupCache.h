@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/DeprecatedFlyString.h>
+#include <AK/Optional.h>
+#include <AK/WeakPtr.h>
+#include <LibJS/Forward.h>
+#include <LibJS/Runtime/Completion.h>
+#include <LibJS/Runtime/Shape.h>
+#include <LibJS/Runtime/Value.h>
+
+namespace JS::Bytecode {
+
+struct PropertyLookupCacheStatistics {
+    u64 get_hits { 0 };
+    u64 get_misses { 0 };
+    u64 put_hits { 0 };
+    u64 put_misses { 0 };
+};
+
+extern PropertyLookupCacheStatistics g_property_lookup_cache_statistics;
+
+// Remembers where a GetById or PutById instruction found its property for the last few shapes
+// of base objects it saw. Since entries are keyed on the shape, adding, removing or reconfiguring
+// a property of the base object moves it to a shape that misses the cache. Entries that went
+// through the prototype chain are also dropped whenever one of those prototypes changes.
+class PropertyLookupCache {
+public:
+    static constexpr size_t max_entries = 4;
+
+    // Returns an empty Optional if the property has to be looked up the slow way.
+    ThrowCompletionOr<Optional<Value>> get(VM&, Object&) const;
+    void update_after_get(VM&, Object&, DeprecatedFlyString const& name);
+
+    // Returns false if the property has to be stored the slow way.
+    bool put(VM&, Object&, Value) const;
+    void update_after_put(VM&, Object&, Shape& old_shape, DeprecatedFlyString const& name);
+
+private:
+    struct Entry {
+        enum class Kind {
+            OwnProperty,
+            PrototypeProperty,
+            PutTransition,
+        };
+
+        Kind kind { Kind::OwnProperty };
+        WeakPtr<Shape> shape;
+
+        // For PrototypeProperty, the prototype that has the property.
+        Object* prototype { nullptr };
+
+        // For PutTransition, the shape the object transitions to when the property is added.
+        WeakPtr<Shape> new_shape;
+
+        u32 property_offset { 0 };
+
+        // The VM's prototype chain generation when an entry that depends on the prototype chain was created.
+        u64 prototype_chain_generation { 0 };
+    };
+
+    Entry const* find(VM&, Object const&) const;
+    Entry& entry_to_replace(Shape const&);
+
+    AK::Array<Entry, max_entries> m_entries;
+    size_t m_next_entry_to_replace { 0 };
+};
+
+}
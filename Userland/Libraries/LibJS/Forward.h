@@ -304,4 +304,8 @@ class Interpreter;
 class Register;
 }
 
+namespace JIT {
+class NativeExecutable;
+}
+
 }
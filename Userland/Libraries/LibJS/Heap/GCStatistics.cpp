@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/BuiltinWrappers.h>
+#include <AK/StringBuilder.h>
+#include <LibJS/Heap/GCStatistics.h>
+#include <math.h>
+
+namespace JS {
+
+size_t GCStatistics::bucket_for_microseconds(u64 microseconds)
+{
+    // Values below sub_bucket_count get a bucket each, after that every power of two is split into sub_bucket_count buckets.
+    if (microseconds < sub_bucket_count)
+        return microseconds;
+    size_t exponent = (sizeof(u64) * 8 - 1) - count_leading_zeroes(microseconds);
+    if (exponent >= max_exponent)
+        return bucket_count - 1;
+    size_t sub_bucket = (microseconds >> (exponent - sub_bucket_bits)) & (sub_bucket_count - 1);
+    return sub_bucket_count + (exponent - sub_bucket_bits) * sub_bucket_count + sub_bucket;
+}
+
+u64 GCStatistics::largest_microseconds_in_bucket(size_t bucket)
+{
+    if (bucket < sub_bucket_count)
+        return bucket;
+    size_t exponent = (bucket - sub_bucket_count) / sub_bucket_count + sub_bucket_bits;
+    u64 sub_bucket = (bucket - sub_bucket_count) % sub_bucket_count;
+    u64 smallest = (sub_bucket_count + sub_bucket) << (exponent - sub_bucket_bits);
+    return smallest + (1ull << (exponent - sub_bucket_bits)) - 1;
+}
+
+void GCStatistics::did_collect(GCPhaseTimes const& phase_times)
+{
+    auto pause = phase_times.total();
+
+    ++m_collection_count;
+    m_longest_pause = max(m_longest_pause, pause);
+    m_total_phase_times.gather_roots += phase_times.gather_roots;
+    m_total_phase_times.mark += phase_times.mark;
+    m_total_phase_times.finalize += phase_times.finalize;
+    m_total_phase_times.sweep += phase_times.sweep;
+
+    auto microseconds = max<i64>(pause.to_microseconds(), 0);
+    ++m_pause_time_histogram[bucket_for_microseconds(static_cast<u64>(microseconds))];
+}
+
+Duration GCStatistics::pause_time_percentile(double percentile) const
+{
+    if (m_collection_count == 0)
+        return {};
+
+    auto wanted = static_cast<size_t>(ceil(percentile / 100.0 * static_cast<double>(m_collection_count)));
+    wanted = clamp<size_t>(wanted, 1, m_collection_count);
+
+    size_t seen = 0;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        seen += m_pause_time_histogram[bucket];
+        if (seen >= wanted) {
+            // The last bucket has no real upper bound, report its pauses as the longest one.
+            if (bucket == bucket_count - 1)
+                return m_longest_pause;
+            auto upper_bound = Duration::from_microseconds(static_cast<i64>(largest_microseconds_in_bucket(bucket)));
+            return min(upper_bound, m_longest_pause);
+        }
+    }
+    return m_longest_pause;
+}
+
+ErrorOr<String> GCStatistics::to_string() const
+{
+    StringBuilder builder;
+    TRY(builder.try_append("Garbage collection statistics\n"sv));
+    TRY(builder.try_append("=============================================\n"sv));
+    TRY(builder.try_appendff("    Collections: {}\n", m_collection_count));
+    TRY(builder.try_appendff("     Total time: {} ms (roots {} ms, mark {} ms, finalize {} ms, sweep {} ms)\n",
+        total_pause_time().to_milliseconds(),
+        m_total_phase_times.gather_roots.to_milliseconds(),
+        m_total_phase_times.mark.to_milliseconds(),
+        m_total_phase_times.finalize.to_milliseconds(),
+        m_total_phase_times.sweep.to_milliseconds()));
+    TRY(builder.try_appendff("   Pause p50/p90/p99/max: {} / {} / {} / {} us\n",
+        pause_time_percentile(50).to_microseconds(),
+        pause_time_percentile(90).to_microseconds(),
+        pause_time_percentile(99).to_microseconds(),
+        m_longest_pause.to_microseconds()));
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+        if (m_pause_time_histogram[bucket] == 0)
+            continue;
+        TRY(builder.try_appendff("   <= {:>10} us: {}\n", largest_microseconds_in_bucket(bucket), m_pause_time_histogram[bucket]));
+    }
+    TRY(builder.try_append("============================================="sv));
+    return builder.to_string();
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Error.h>
+#include <AK/String.h>
+#include <AK/Time.h>
+#include <AK/Types.h>
+
+namespace JS {
+
+struct GCPhaseTimes {
+    Duration gather_roots;
+    Duration mark;
+    Duration finalize;
+    Duration sweep;
+
+    Duration total() const { return gather_roots + mark + finalize + sweep; }
+};
+
+// Keeps track of how long garbage collections pause the program.
+// Pause times go into a log-linear histogram with 8 buckets per power of two, so percentiles
+// are accurate to within 12.5% without having to remember every single pause.
+class GCStatistics {
+public:
+    void did_collect(GCPhaseTimes const&);
+
+    size_t collection_count() const { return m_collection_count; }
+    Duration total_pause_time() const { return m_total_phase_times.total(); }
+    Duration longest_pause() const { return m_longest_pause; }
+    GCPhaseTimes const& total_phase_times() const { return m_total_phase_times; }
+
+    // Returns the pause time (an upper bound for it) that the given percentage of collections stayed under.
+    Duration pause_time_percentile(double percentile) const;
+
+    ErrorOr<String> to_string() const;
+
+private:
+    static constexpr size_t sub_bucket_bits = 3;
+    static constexpr size_t sub_bucket_count = 1 << sub_bucket_bits;
+    // Enough for pauses of up to 2^36 microseconds (~19 hours); anything longer goes into the last bucket.
+    static constexpr size_t max_exponent = 36;
+    static constexpr size_t bucket_count = sub_bucket_count + (max_exponent - sub_bucket_bits) * sub_bucket_count;
+
+    static size_t bucket_for_microseconds(u64);
+    static u64 largest_microseconds_in_bucket(size_t);
+
+    size_t m_collection_count { 0 };
+    Duration m_longest_pause;
+    GCPhaseTimes m_total_phase_times;
+    AK::Array<u32, bucket_count> m_pause_time_histogram {};
+};
+
+}
@@ -18,6 +18,7 @@
 #include <LibJS/Heap/BlockAllocator.h>
 #include <LibJS/Heap/Cell.h>
 #include <LibJS/Heap/CellAllocator.h>
+#include <LibJS/Heap/GCStatistics.h>
 #include <LibJS/Heap/Handle.h>
 #include <LibJS/Heap/MarkedVector.h>
 #include <LibJS/Runtime/WeakContainer.h>
@@ -78,6 +79,8 @@ public:
 
     void uproot_cell(Cell* cell);
 
+    GCStatistics const& statistics() const { return m_statistics; }
+
 private:
     static bool cell_must_survive_garbage_collection(Cell const&);
 
@@ -121,6 +124,8 @@ private:
     bool m_should_gc_when_deferral_ends { false };
 
     bool m_collecting_garbage { false };
+
+    GCStatistics m_statistics;
 };
 
 }
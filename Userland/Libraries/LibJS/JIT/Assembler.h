@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/NumericLimits.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
+#include <AK/Vector.h>
+
+namespace JS::JIT {
+
+// A tiny x86-64 assembler that knows just enough instructions for the baseline JIT.
+// Memory operands are always of the form [base + disp32].
+class Assembler {
+public:
+    enum class Reg : u8 {
+        RAX = 0,
+        RCX = 1,
+        RDX = 2,
+        RBX = 3,
+        RSP = 4,
+        RBP = 5,
+        RSI = 6,
+        RDI = 7,
+        R8 = 8,
+        R9 = 9,
+        R10 = 10,
+        R11 = 11,
+        R12 = 12,
+        R13 = 13,
+        R14 = 14,
+        R15 = 15,
+    };
+
+    enum class Condition : u8 {
+        Overflow = 0x0,
+        EqualTo = 0x4,
+        NotEqualTo = 0x5,
+        Sign = 0x8,
+        LessThan = 0xc,
+        GreaterThanOrEqualTo = 0xd,
+        LessThanOrEqualTo = 0xe,
+        GreaterThan = 0xf,
+    };
+
+    class Label {
+    public:
+        bool is_bound() const { return m_offset.has_value(); }
+        size_t offset() const { return m_offset.value(); }
+
+    private:
+        friend class Assembler;
+
+        Optional<size_t> m_offset;
+        Vector<size_t> m_jump_slots;
+    };
+
+    explicit Assembler(Vector<u8>& output)
+        : m_output(output)
+    {
+    }
+
+    size_t offset() const { return m_output.size(); }
+
+    void link(Label& label)
+    {
+        VERIFY(!label.is_bound());
+        label.m_offset = offset();
+        for (auto slot : label.m_jump_slots)
+            patch_rel32(slot, offset());
+        label.m_jump_slots.clear();
+    }
+
+    void mov(Reg dst, Reg src)
+    {
+        emit_rex(true, src, dst);
+        emit8(0x89);
+        emit_modrm_direct(src, dst);
+    }
+
+    void mov(Reg dst, u64 imm)
+    {
+        emit_rex(true, Reg::RAX, dst);
+        emit8(0xb8 | encode(dst));
+        emit64(imm);
+    }
+
+    // dst = [base + displacement]
+    void load(Reg dst, Reg base, i32 displacement)
+    {
+        emit_rex(true, dst, base);
+        emit8(0x8b);
+        emit_modrm_indirect(dst, base, displacement);
+    }
+
+    // [base + displacement] = src
+    void store(Reg base, i32 displacement, Reg src)
+    {
+        emit_rex(true, src, base);
+        emit8(0x89);
+        emit_modrm_indirect(src, base, displacement);
+    }
+
+    // 32-bit arithmetic. Writing the 32-bit register clears its upper half.
+    void add32(Reg dst, Reg src) { emit_alu32(0x01, dst, src); }
+    void sub32(Reg dst, Reg src) { emit_alu32(0x29, dst, src); }
+    void and32(Reg dst, Reg src) { emit_alu32(0x21, dst, src); }
+    void or32(Reg dst, Reg src) { emit_alu32(0x09, dst, src); }
+    void xor32(Reg dst, Reg src) { emit_alu32(0x31, dst, src); }
+    void cmp32(Reg lhs, Reg rhs) { emit_alu32(0x39, lhs, rhs); }
+    void test32(Reg lhs, Reg rhs) { emit_alu32(0x85, lhs, rhs); }
+
+    void imul32(Reg dst, Reg src)
+    {
+        emit_rex(false, dst, src);
+        emit8(0x0f);
+        emit8(0xaf);
+        emit_modrm_direct(dst, src);
+    }
+
+    void add32(Reg dst, i32 imm) { emit_alu32_imm(0, dst, imm); }
+    void and32(Reg dst, i32 imm) { emit_alu32_imm(4, dst, imm); }
+    void sub32(Reg dst, i32 imm) { emit_alu32_imm(5, dst, imm); }
+    void cmp32(Reg dst, i32 imm) { emit_alu32_imm(7, dst, imm); }
+
+    // Shifts by the low five bits of CL, just like the ECMAScript shift operators.
+    void shl32_by_cl(Reg dst) { emit_shift32_by_cl(4, dst); }
+    void shr32_by_cl(Reg dst) { emit_shift32_by_cl(5, dst); }
+    void sar32_by_cl(Reg dst) { emit_shift32_by_cl(7, dst); }
+
+    void or64(Reg dst, Reg src)
+    {
+        emit_rex(true, src, dst);
+        emit8(0x09);
+        emit_modrm_direct(src, dst);
+    }
+
+    void shr64(Reg dst, u8 imm)
+    {
+        emit_rex(true, Reg::RAX, dst);
+        emit8(0xc1);
+        emit_modrm_direct(5, dst);
+        emit8(imm);
+    }
+
+    // dst = condition ? 1 : 0, zero-extended to 64 bits.
+    void set(Condition condition, Reg dst)
+    {
+        // Always emit a REX prefix so that encodings 4-7 mean SPL-DIL, not AH-BH.
+        emit8(0x40 | (is_extended(dst) ? 1 : 0));
+        emit8(0x0f);
+        emit8(0x90 | to_underlying(condition));
+        emit_modrm_direct(0, dst);
+
+        emit8(0x40 | (is_extended(dst) ? 5 : 0));
+        emit8(0x0f);
+        emit8(0xb6);
+        emit_modrm_direct(dst, dst);
+    }
+
+    void jump(Label& label)
+    {
+        emit8(0xe9);
+        emit_rel32_to(label);
+    }
+
+    void jump_if(Condition condition, Label& label)
+    {
+        emit8(0x0f);
+        emit8(0x80 | to_underlying(condition));
+        emit_rel32_to(label);
+    }
+
+    void jump(Reg target)
+    {
+        emit_rex(false, Reg::RAX, target);
+        emit8(0xff);
+        emit_modrm_direct(4, target);
+    }
+
+    void call(Reg target)
+    {
+        emit_rex(false, Reg::RAX, target);
+        emit8(0xff);
+        emit_modrm_direct(2, target);
+    }
+
+    void push(Reg reg)
+    {
+        if (is_extended(reg))
+            emit8(0x41);
+        emit8(0x50 | encode(reg));
+    }
+
+    void pop(Reg reg)
+    {
+        if (is_extended(reg))
+            emit8(0x41);
+        emit8(0x58 | encode(reg));
+    }
+
+    void ret() { emit8(0xc3); }
+
+private:
+    static bool is_extended(Reg reg) { return to_underlying(reg) >= 8; }
+    static u8 encode(Reg reg) { return to_underlying(reg) & 7; }
+
+    void emit8(u8 value) { m_output.append(value); }
+
+    void emit32(u32 value)
+    {
+        for (size_t i = 0; i < 4; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    void emit64(u64 value)
+    {
+        for (size_t i = 0; i < 8; ++i)
+            emit8((value >> (i * 8)) & 0xff);
+    }
+
+    // Emits a REX prefix if one is needed. `reg` ends up in ModRM.reg, `rm` in ModRM.rm (or the base).
+    void emit_rex(bool wide, Reg reg, Reg rm)
+    {
+        u8 rex = 0x40;
+        if (wide)
+            rex |= 0x08;
+        if (is_extended(reg))
+            rex |= 0x04;
+        if (is_extended(rm))
+            rex |= 0x01;
+        if (rex != 0x40)
+            emit8(rex);
+    }
+
+    void emit_modrm_direct(Reg reg, Reg rm) { emit_modrm_direct(encode(reg), rm); }
+    void emit_modrm_direct(u8 reg_or_extension, Reg rm) { emit8(0xc0 | (reg_or_extension << 3) | encode(rm)); }
+
+    void emit_modrm_indirect(Reg reg, Reg base, i32 displacement)
+    {
+        emit8(0x80 | (encode(reg) << 3) | encode(base));
+        // RSP and R12 can only be used as a base through a SIB byte.
+        if (encode(base) == encode(Reg::RSP))
+            emit8(0x24);
+        emit32(static_cast<u32>(displacement));
+    }
+
+    void emit_alu32(u8 opcode, Reg dst, Reg src)
+    {
+        emit_rex(false, src, dst);
+        emit8(opcode);
+        emit_modrm_direct(src, dst);
+    }
+
+    void emit_alu32_imm(u8 extension, Reg dst, i32 imm)
+    {
+        emit_rex(false, Reg::RAX, dst);
+        emit8(0x81);
+        emit_modrm_direct(extension, dst);
+        emit32(static_cast<u32>(imm));
+    }
+
+    void emit_shift32_by_cl(u8 extension, Reg dst)
+    {
+        emit_rex(false, Reg::RAX, dst);
+        emit8(0xd3);
+        emit_modrm_direct(extension, dst);
+    }
+
+    void emit_rel32_to(Label& label)
+    {
+        auto slot = offset();
+        emit32(0);
+        if (label.is_bound())
+            patch_rel32(slot, label.offset());
+        else
+            label.m_jump_slots.append(slot);
+    }
+
+    void patch_rel32(size_t slot, size_t target)
+    {
+        auto relative = static_cast<i64>(target) - static_cast<i64>(slot + 4);
+        VERIFY(relative >= NumericLimits<i32>::min() && relative <= NumericLimits<i32>::max());
+        for (size_t i = 0; i < 4; ++i)
+            m_output[slot + i] = (static_cast<u32>(relative) >> (i * 8)) & 0xff;
+    }
+
+    Vector<u8>& m_output;
+};
+
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Platform.h>
+#include <LibJS/Bytecode/Instruction.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/JIT/Compiler.h>
+
+namespace JS::JIT {
+
+using Reg = Assembler::Reg;
+using Condition = Assembler::Condition;
+
+// These live in callee-saved registers for the whole time we're running native code.
+static constexpr auto INTERPRETER = Reg::RBX;
+static constexpr auto REGISTER_FILE = Reg::R12;
+static constexpr auto CURRENT_BLOCK = Reg::R13;
+
+// Scratch register for tag checks; never holds a value across instructions.
+static constexpr auto SCRATCH = Reg::R11;
+
+static constexpr auto ARG0 = Reg::RDI;
+static constexpr auto ARG1 = Reg::RSI;
+static constexpr auto RETURN_VALUE = Reg::RAX;
+
+static u32 execute_generic_instruction(Bytecode::Interpreter& interpreter, Bytecode::Instruction const& instruction)
+{
+    return to_underlying(interpreter.execute_instruction(instruction));
+}
+
+static u32 value_to_boolean(Value const* value)
+{
+    return value->to_boolean();
+}
+
+template<typename Function>
+static u64 function_address(Function* function)
+{
+    return reinterpret_cast<FlatPtr>(function);
+}
+
+Compiler::Compiler(Bytecode::Executable const& bytecode_executable)
+    : m_bytecode_executable(bytecode_executable)
+{
+}
+
+OwnPtr<NativeExecutable> Compiler::compile(Bytecode::Executable const& bytecode_executable)
+{
+#if ARCH(X86_64)
+    Compiler compiler { bytecode_executable };
+    return compiler.compile_executable();
+#else
+    (void)bytecode_executable;
+    return nullptr;
+#endif
+}
+
+OwnPtr<NativeExecutable> Compiler::compile_executable()
+{
+    m_block_labels.resize(m_bytecode_executable.basic_blocks.size());
+    for (size_t i = 0; i < m_bytecode_executable.basic_blocks.size(); ++i)
+        m_block_indices.set(m_bytecode_executable.basic_blocks[i].ptr(), i);
+
+    // Prologue: Save the callee-saved registers we use (which also keeps the stack 16-byte aligned for calls),
+    // stash the arguments and jump to the requested block.
+    m_assembler.push(Reg::RBP);
+    m_assembler.mov(Reg::RBP, Reg::RSP);
+    m_assembler.push(INTERPRETER);
+    m_assembler.push(REGISTER_FILE);
+    m_assembler.push(CURRENT_BLOCK);
+    m_assembler.push(Reg::R14);
+    m_assembler.mov(INTERPRETER, Reg::RDI);
+    m_assembler.mov(REGISTER_FILE, Reg::RSI);
+    m_assembler.mov(CURRENT_BLOCK, Reg::RDX);
+    m_assembler.jump(Reg::RCX);
+
+    // Epilogue: The exit reason has already been put into the return value register.
+    m_assembler.link(m_exit);
+    m_assembler.pop(Reg::R14);
+    m_assembler.pop(CURRENT_BLOCK);
+    m_assembler.pop(REGISTER_FILE);
+    m_assembler.pop(INTERPRETER);
+    m_assembler.pop(Reg::RBP);
+    m_assembler.ret();
+
+    HashMap<Bytecode::BasicBlock const*, size_t> block_offsets;
+    for (size_t i = 0; i < m_bytecode_executable.basic_blocks.size(); ++i) {
+        auto& block = *m_bytecode_executable.basic_blocks[i];
+        m_assembler.link(m_block_labels[i]);
+        block_offsets.set(&block, m_assembler.offset());
+        compile_block(block);
+    }
+
+    return NativeExecutable::create(m_output.span(), move(block_offsets));
+}
+
+void Compiler::compile_block(Bytecode::BasicBlock const& block)
+{
+    Bytecode::InstructionStreamIterator it(block.instruction_stream());
+    while (!it.at_end()) {
+        compile_instruction(*it);
+        ++it;
+    }
+
+    // Falling off the end of a block ends the executable, just like in the interpreter.
+    m_assembler.mov(RETURN_VALUE, to_underlying(Bytecode::Interpreter::ExitReason::None));
+    m_assembler.jump(m_exit);
+}
+
+void Compiler::compile_instruction(Bytecode::Instruction const& instruction)
+{
+    using Type = Bytecode::Instruction::Type;
+
+    switch (instruction.type()) {
+    case Type::Load:
+        compile_load(static_cast<Bytecode::Op::Load const&>(instruction));
+        return;
+    case Type::LoadImmediate:
+        compile_load_immediate(static_cast<Bytecode::Op::LoadImmediate const&>(instruction));
+        return;
+    case Type::Store:
+        compile_store(static_cast<Bytecode::Op::Store const&>(instruction));
+        return;
+#define __JIT_INT32_BINARY_OP(OpTitleCase)                                                                       \
+    case Type::OpTitleCase:                                                                                      \
+        compile_int32_binary_op(instruction, static_cast<Bytecode::Op::OpTitleCase const&>(instruction).lhs()); \
+        return;
+        __JIT_INT32_BINARY_OP(Add)
+        __JIT_INT32_BINARY_OP(Sub)
+        __JIT_INT32_BINARY_OP(Mul)
+        __JIT_INT32_BINARY_OP(BitwiseAnd)
+        __JIT_INT32_BINARY_OP(BitwiseOr)
+        __JIT_INT32_BINARY_OP(BitwiseXor)
+        __JIT_INT32_BINARY_OP(LeftShift)
+        __JIT_INT32_BINARY_OP(RightShift)
+        __JIT_INT32_BINARY_OP(UnsignedRightShift)
+        __JIT_INT32_BINARY_OP(LessThan)
+        __JIT_INT32_BINARY_OP(LessThanEquals)
+        __JIT_INT32_BINARY_OP(GreaterThan)
+        __JIT_INT32_BINARY_OP(GreaterThanEquals)
+        __JIT_INT32_BINARY_OP(LooselyEquals)
+        __JIT_INT32_BINARY_OP(LooselyInequals)
+        __JIT_INT32_BINARY_OP(StrictlyEquals)
+        __JIT_INT32_BINARY_OP(StrictlyInequals)
+#undef __JIT_INT32_BINARY_OP
+    case Type::Increment:
+    case Type::Decrement:
+        compile_increment_or_decrement(instruction);
+        return;
+    case Type::Jump:
+        compile_jump(static_cast<Bytecode::Op::Jump const&>(instruction));
+        return;
+    case Type::JumpConditional:
+        compile_jump_conditional(static_cast<Bytecode::Op::JumpConditional const&>(instruction));
+        return;
+    case Type::JumpNullish:
+        compile_jump_nullish(static_cast<Bytecode::Op::JumpNullish const&>(instruction));
+        return;
+    case Type::JumpUndefined:
+        compile_jump_undefined(static_cast<Bytecode::Op::JumpUndefined const&>(instruction));
+        return;
+    default:
+        compile_generic(instruction);
+        return;
+    }
+}
+
+void Compiler::load_register(Reg dst, Bytecode::Register src)
+{
+    m_assembler.load(dst, REGISTER_FILE, src.index() * sizeof(Value));
+}
+
+void Compiler::store_register(Bytecode::Register dst, Reg src)
+{
+    m_assembler.store(REGISTER_FILE, dst.index() * sizeof(Value), src);
+}
+
+void Compiler::extract_tag(Reg dst, Reg value)
+{
+    m_assembler.mov(dst, value);
+    m_assembler.shr64(dst, TAG_SHIFT);
+}
+
+void Compiler::branch_if_not_int32(Reg value, Assembler::Label& label)
+{
+    extract_tag(SCRATCH, value);
+    m_assembler.cmp32(SCRATCH, INT32_TAG);
+    m_assembler.jump_if(Condition::NotEqualTo, label);
+}
+
+// Turns a zero-extended 32-bit payload into a Value with the given tag.
+void Compiler::box(Reg value, u64 tag)
+{
+    m_assembler.mov(SCRATCH, tag << TAG_SHIFT);
+    m_assembler.or64(value, SCRATCH);
+}
+
+void Compiler::jump_to_block(Bytecode::Label const& target)
+{
+    auto index = m_block_indices.get(&target.block());
+    VERIFY(index.has_value());
+
+    // Keep the interpreter's idea of the current block up to date, so that anything that looks at it
+    // (and the interpreter loop, once we exit) sees the same state as without the JIT.
+    m_assembler.mov(RETURN_VALUE, reinterpret_cast<FlatPtr>(&target.block()));
+    m_assembler.store(CURRENT_BLOCK, 0, RETURN_VALUE);
+    m_assembler.jump(m_block_labels[index.value()]);
+}
+
+void Compiler::compile_load(Bytecode::Op::Load const& op)
+{
+    load_register(Reg::RAX, op.src());
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_load_immediate(Bytecode::Op::LoadImmediate const& op)
+{
+    m_assembler.mov(Reg::RAX, op.value().encoded());
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+}
+
+void Compiler::compile_store(Bytecode::Op::Store const& op)
+{
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    store_register(op.dst(), Reg::RAX);
+}
+
+void Compiler::compile_int32_binary_op(Bytecode::Instruction const& instruction, Bytecode::Register lhs)
+{
+    using Type = Bytecode::Instruction::Type;
+
+    Assembler::Label slow_case;
+    Assembler::Label done;
+
+    load_register(Reg::RAX, lhs);
+    load_register(Reg::RDX, Bytecode::Register::accumulator());
+    branch_if_not_int32(Reg::RAX, slow_case);
+    branch_if_not_int32(Reg::RDX, slow_case);
+
+    auto compile_comparison = [&](Condition condition) {
+        m_assembler.cmp32(Reg::RAX, Reg::RDX);
+        m_assembler.set(condition, Reg::RAX);
+        box(Reg::RAX, BOOLEAN_TAG);
+    };
+
+    switch (instruction.type()) {
+    case Type::Add:
+        m_assembler.add32(Reg::RAX, Reg::RDX);
+        m_assembler.jump_if(Condition::Overflow, slow_case);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::Sub:
+        m_assembler.sub32(Reg::RAX, Reg::RDX);
+        m_assembler.jump_if(Condition::Overflow, slow_case);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::Mul:
+        m_assembler.imul32(Reg::RAX, Reg::RDX);
+        m_assembler.jump_if(Condition::Overflow, slow_case);
+        // A zero result might have to be -0, which isn't an Int32.
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::EqualTo, slow_case);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::BitwiseAnd:
+        m_assembler.and32(Reg::RAX, Reg::RDX);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::BitwiseOr:
+        m_assembler.or32(Reg::RAX, Reg::RDX);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::BitwiseXor:
+        m_assembler.xor32(Reg::RAX, Reg::RDX);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::LeftShift:
+        m_assembler.mov(Reg::RCX, Reg::RDX);
+        m_assembler.shl32_by_cl(Reg::RAX);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::RightShift:
+        m_assembler.mov(Reg::RCX, Reg::RDX);
+        m_assembler.sar32_by_cl(Reg::RAX);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::UnsignedRightShift:
+        m_assembler.mov(Reg::RCX, Reg::RDX);
+        m_assembler.shr32_by_cl(Reg::RAX);
+        // Results above INT32_MAX have to be stored as doubles.
+        m_assembler.test32(Reg::RAX, Reg::RAX);
+        m_assembler.jump_if(Condition::Sign, slow_case);
+        box(Reg::RAX, INT32_TAG);
+        break;
+    case Type::LessThan:
+        compile_comparison(Condition::LessThan);
+        break;
+    case Type::LessThanEquals:
+        compile_comparison(Condition::LessThanOrEqualTo);
+        break;
+    case Type::GreaterThan:
+        compile_comparison(Condition::GreaterThan);
+        break;
+    case Type::GreaterThanEquals:
+        compile_comparison(Condition::GreaterThanOrEqualTo);
+        break;
+    case Type::LooselyEquals:
+    case Type::StrictlyEquals:
+        compile_comparison(Condition::EqualTo);
+        break;
+    case Type::LooselyInequals:
+    case Type::StrictlyInequals:
+        compile_comparison(Condition::NotEqualTo);
+        break;
+    default:
+        VERIFY_NOT_REACHED();
+    }
+
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+    m_assembler.jump(done);
+
+    m_assembler.link(slow_case);
+    compile_generic(instruction);
+
+    m_assembler.link(done);
+}
+
+void Compiler::compile_increment_or_decrement(Bytecode::Instruction const& instruction)
+{
+    Assembler::Label slow_case;
+    Assembler::Label done;
+
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    branch_if_not_int32(Reg::RAX, slow_case);
+    if (instruction.type() == Bytecode::Instruction::Type::Increment)
+        m_assembler.add32(Reg::RAX, 1);
+    else
+        m_assembler.sub32(Reg::RAX, 1);
+    m_assembler.jump_if(Condition::Overflow, slow_case);
+    box(Reg::RAX, INT32_TAG);
+    store_register(Bytecode::Register::accumulator(), Reg::RAX);
+    m_assembler.jump(done);
+
+    m_assembler.link(slow_case);
+    compile_generic(instruction);
+
+    m_assembler.link(done);
+}
+
+void Compiler::compile_jump(Bytecode::Op::Jump const& op)
+{
+    jump_to_block(*op.true_target());
+}
+
+void Compiler::compile_jump_conditional(Bytecode::Op::JumpConditional const& op)
+{
+    Assembler::Label test_payload;
+    Assembler::Label is_false;
+
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+
+    // Booleans and Int32s are falsy exactly when their payload is zero.
+    extract_tag(SCRATCH, Reg::RAX);
+    m_assembler.cmp32(SCRATCH, BOOLEAN_TAG);
+    m_assembler.jump_if(Condition::EqualTo, test_payload);
+    m_assembler.cmp32(SCRATCH, INT32_TAG);
+    m_assembler.jump_if(Condition::EqualTo, test_payload);
+
+    // Everything else goes through Value::to_boolean(), which leaves 0 or 1 in the return value register.
+    m_assembler.mov(ARG0, REGISTER_FILE);
+    m_assembler.mov(Reg::RAX, function_address(&value_to_boolean));
+    m_assembler.call(Reg::RAX);
+
+    m_assembler.link(test_payload);
+    m_assembler.test32(Reg::RAX, Reg::RAX);
+    m_assembler.jump_if(Condition::EqualTo, is_false);
+    jump_to_block(*op.true_target());
+
+    m_assembler.link(is_false);
+    jump_to_block(*op.false_target());
+}
+
+void Compiler::compile_jump_nullish(Bytecode::Op::JumpNullish const& op)
+{
+    Assembler::Label is_not_nullish;
+
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    extract_tag(SCRATCH, Reg::RAX);
+    m_assembler.and32(SCRATCH, IS_NULLISH_EXTRACT_PATTERN);
+    m_assembler.cmp32(SCRATCH, IS_NULLISH_PATTERN);
+    m_assembler.jump_if(Condition::NotEqualTo, is_not_nullish);
+    jump_to_block(*op.true_target());
+
+    m_assembler.link(is_not_nullish);
+    jump_to_block(*op.false_target());
+}
+
+void Compiler::compile_jump_undefined(Bytecode::Op::JumpUndefined const& op)
+{
+    Assembler::Label is_not_undefined;
+
+    load_register(Reg::RAX, Bytecode::Register::accumulator());
+    extract_tag(SCRATCH, Reg::RAX);
+    m_assembler.cmp32(SCRATCH, UNDEFINED_TAG);
+    m_assembler.jump_if(Condition::NotEqualTo, is_not_undefined);
+    jump_to_block(*op.true_target());
+
+    m_assembler.link(is_not_undefined);
+    jump_to_block(*op.false_target());
+}
+
+// Runs the instruction through the interpreter and leaves native code if the interpreter loop has to deal
+// with the outcome (an exception, a jump it scheduled, or a return).
+void Compiler::compile_generic(Bytecode::Instruction const& instruction)
+{
+    m_assembler.mov(ARG0, INTERPRETER);
+    m_assembler.mov(ARG1, reinterpret_cast<FlatPtr>(&instruction));
+    m_assembler.mov(Reg::RAX, function_address(&execute_generic_instruction));
+    m_assembler.call(Reg::RAX);
+    m_assembler.test32(RETURN_VALUE, RETURN_VALUE);
+    m_assembler.jump_if(Condition::NotEqualTo, m_exit);
+}
+
+}
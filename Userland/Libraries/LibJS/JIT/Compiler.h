@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibJS/Bytecode/Executable.h>
+#include <LibJS/Bytecode/Op.h>
+#include <LibJS/JIT/Assembler.h>
+#include <LibJS/JIT/NativeExecutable.h>
+
+namespace JS::JIT {
+
+// A baseline compiler that translates bytecode to x86-64 machine code one instruction at a time.
+// Loads, stores, jumps and Int32 arithmetic and comparisons get inline fast paths; everything else
+// (including the slow paths) calls back into the instruction's regular execute_impl().
+class Compiler {
+public:
+    // Returns nullptr if the executable can't be compiled on this platform.
+    static OwnPtr<NativeExecutable> compile(Bytecode::Executable const&);
+
+private:
+    explicit Compiler(Bytecode::Executable const&);
+
+    OwnPtr<NativeExecutable> compile_executable();
+    void compile_block(Bytecode::BasicBlock const&);
+    void compile_instruction(Bytecode::Instruction const&);
+
+    void compile_load(Bytecode::Op::Load const&);
+    void compile_load_immediate(Bytecode::Op::LoadImmediate const&);
+    void compile_store(Bytecode::Op::Store const&);
+    void compile_int32_binary_op(Bytecode::Instruction const&, Bytecode::Register lhs);
+    void compile_increment_or_decrement(Bytecode::Instruction const&);
+    void compile_jump(Bytecode::Op::Jump const&);
+    void compile_jump_conditional(Bytecode::Op::JumpConditional const&);
+    void compile_jump_nullish(Bytecode::Op::JumpNullish const&);
+    void compile_jump_undefined(Bytecode::Op::JumpUndefined const&);
+    void compile_generic(Bytecode::Instruction const&);
+
+    void load_register(Assembler::Reg dst, Bytecode::Register);
+    void store_register(Bytecode::Register, Assembler::Reg src);
+    void extract_tag(Assembler::Reg dst, Assembler::Reg value);
+    void branch_if_not_int32(Assembler::Reg value, Assembler::Label&);
+    void box(Assembler::Reg value, u64 tag);
+    void jump_to_block(Bytecode::Label const&);
+
+    Bytecode::Executable const& m_bytecode_executable;
+    Vector<u8> m_output;
+    Assembler m_assembler { m_output };
+    Assembler::Label m_exit;
+    Vector<Assembler::Label> m_block_labels;
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_indices;
+};
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibJS/JIT/NativeExecutable.h>
+#include <sys/mman.h>
+
+namespace JS::JIT {
+
+// The generated code is entered at its prologue at offset 0 with the interpreter, the register file,
+// a pointer to the interpreter's current block and the address of the block to start running.
+using EntryPoint = u32 (*)(Bytecode::Interpreter*, Value* registers, Bytecode::BasicBlock const** current_block, void const* block_address);
+
+OwnPtr<NativeExecutable> NativeExecutable::create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+{
+    auto* memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        dbgln("JIT: Failed to allocate {} bytes for native code: {}", code.size(), strerror(errno));
+        return nullptr;
+    }
+    memcpy(memory, code.data(), code.size());
+
+    // NOTE: On SerenityOS this only works for programs on a mount that allows anonymous executable memory.
+    //       If it fails, we simply keep interpreting.
+    if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) < 0) {
+        dbgln("JIT: Failed to make native code executable: {}", strerror(errno));
+        munmap(memory, code.size());
+        return nullptr;
+    }
+
+    return adopt_own(*new NativeExecutable(memory, code.size(), move(block_offsets)));
+}
+
+NativeExecutable::NativeExecutable(void* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets)
+    : m_code(code)
+    , m_size(size)
+    , m_block_offsets(move(block_offsets))
+{
+}
+
+NativeExecutable::~NativeExecutable()
+{
+    munmap(m_code, m_size);
+}
+
+Bytecode::Interpreter::ExitReason NativeExecutable::run(Bytecode::Interpreter& interpreter, Value* registers, Bytecode::BasicBlock const*& current_block) const
+{
+    auto offset = m_block_offsets.get(current_block);
+    VERIFY(offset.has_value());
+
+    auto entry_point = reinterpret_cast<EntryPoint>(m_code);
+    auto exit_reason = entry_point(&interpreter, registers, &current_block, static_cast<u8 const*>(m_code) + offset.value());
+    return static_cast<Bytecode::Interpreter::ExitReason>(exit_reason);
+}
+
+}
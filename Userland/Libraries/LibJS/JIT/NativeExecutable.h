@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/OwnPtr.h>
+#include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Forward.h>
+
+namespace JS::JIT {
+
+// Machine code for a whole Bytecode::Executable, with one entry point per basic block.
+// The code runs until an instruction wants the interpreter loop to take over (see Interpreter::ExitReason)
+// or until it falls off the end of a basic block.
+class NativeExecutable {
+    AK_MAKE_NONCOPYABLE(NativeExecutable);
+    AK_MAKE_NONMOVABLE(NativeExecutable);
+
+public:
+    static OwnPtr<NativeExecutable> create(ReadonlyBytes code, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+    ~NativeExecutable();
+
+    Bytecode::Interpreter::ExitReason run(Bytecode::Interpreter&, Value* registers, Bytecode::BasicBlock const*& current_block) const;
+
+    size_t size() const { return m_size; }
+
+private:
+    NativeExecutable(void* code, size_t size, HashMap<Bytecode::BasicBlock const*, size_t> block_offsets);
+
+    void* m_code { nullptr };
+    size_t m_size { 0 };
+    HashMap<Bytecode::BasicBlock const*, size_t> m_block_offsets;
+};
+
+}
@@ -64,6 +64,8 @@ protected:
     explicit Array(Object& prototype);
 
 private:
+    virtual bool is_array_exotic_object() const final { return true; }
+
     ThrowCompletionOr<bool> set_length(PropertyDescriptor const&);
 
     bool m_length_writable { true };
@@ -74,6 +76,9 @@ enum class Holes {
     ReadThroughHoles,
 };
 
+template<>
+inline bool Object::fast_is<Array>() const { return is_array_exotic_object(); }
+
 ThrowCompletionOr<MarkedVector<Value>> sort_indexed_properties(VM&, Object const&, size_t length, Function<ThrowCompletionOr<double>(Value, Value)> const& sort_compare, Holes holes);
 ThrowCompletionOr<double> compare_array_elements(VM&, Value x, Value y, FunctionObject* comparefn);
 
@@ -28,6 +28,20 @@ namespace JS {
 
 static HashTable<NonnullGCPtr<Object>> s_array_join_seen_objects;
 
+// Searching an array of packed numbers can't have side effects, so we can look at the elements directly instead of
+// going through [[HasProperty]] and [[Get]] for each of them. This must be called after everything that could have
+// run user code, as that might have changed the array.
+static Optional<ReadonlySpan<Value>> packed_number_elements_for_search(Object const& object, size_t length)
+{
+    if (!is<Array>(object))
+        return {};
+    auto elements = object.indexed_properties().packed_elements();
+    // Indices past the end of the storage would have to be looked up on the prototype chain.
+    if (length == 0 || elements.size() < length)
+        return {};
+    return elements.trim(length);
+}
+
 ArrayPrototype::ArrayPrototype(Realm& realm)
     : Array(realm.intrinsics().object_prototype())
 {
@@ -903,6 +917,13 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::includes)
             from_index = from_argument;
     }
     auto value_to_find = vm.argument(0);
+    if (auto elements = packed_number_elements_for_search(this_object, length); elements.has_value()) {
+        for (u64 i = from_index; i < length; ++i) {
+            if (same_value_zero(elements->at(i), value_to_find))
+                return Value(true);
+        }
+        return Value(false);
+    }
     for (u64 i = from_index; i < length; ++i) {
         auto element = TRY(this_object->get(i));
         if (same_value_zero(element, value_to_find))
@@ -956,6 +977,14 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::index_of)
         k = max(length + n, 0);
     }
 
+    if (auto elements = packed_number_elements_for_search(object, length); elements.has_value()) {
+        for (; k < length; ++k) {
+            if (is_strictly_equal(search_element, elements->at(k)))
+                return Value(k);
+        }
+        return Value(-1);
+    }
+
     // 10. Repeat, while k < len,
     for (; k < length; ++k) {
         auto property_key = PropertyKey { k };
@@ -1067,6 +1096,14 @@ JS_DEFINE_NATIVE_FUNCTION(ArrayPrototype::last_index_of)
         k = (double)length + n;
     }
 
+    if (auto elements = packed_number_elements_for_search(object, length); elements.has_value()) {
+        for (; k >= 0; --k) {
+            if (is_strictly_equal(search_element, elements->at(k)))
+                return Value((size_t)k);
+        }
+        return Value(-1);
+    }
+
     // 8. Repeat, while k ≥ 0,
     for (; k >= 0; --k) {
         auto property_key = PropertyKey { k };
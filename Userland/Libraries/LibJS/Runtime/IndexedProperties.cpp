@@ -17,6 +17,13 @@ SimpleIndexedPropertyStorage::SimpleIndexedPropertyStorage(Vector<Value>&& initi
     : m_array_size(initial_values.size())
     , m_packed_elements(move(initial_values))
 {
+    for (auto value : m_packed_elements) {
+        if (value.is_empty()) {
+            m_element_kind = ElementKind::Generic;
+            break;
+        }
+        update_element_kind(value);
+    }
 }
 
 bool SimpleIndexedPropertyStorage::has_index(u32 index) const
@@ -49,9 +56,13 @@ void SimpleIndexedPropertyStorage::put(u32 index, Value value, PropertyAttribute
     VERIFY(attributes == default_attributes);
 
     if (index >= m_array_size) {
+        // Anything but an append leaves holes behind.
+        if (index > m_array_size)
+            m_element_kind = ElementKind::Generic;
         m_array_size = index + 1;
         grow_storage_if_needed();
     }
+    update_element_kind(value);
     m_packed_elements[index] = value;
 }
 
@@ -59,6 +70,7 @@ void SimpleIndexedPropertyStorage::remove(u32 index)
 {
     VERIFY(index < m_array_size);
     m_packed_elements[index] = {};
+    m_element_kind = ElementKind::Generic;
 }
 
 ValueAndAttributes SimpleIndexedPropertyStorage::take_first()
@@ -77,6 +89,8 @@ ValueAndAttributes SimpleIndexedPropertyStorage::take_last()
 
 bool SimpleIndexedPropertyStorage::set_array_like_size(size_t new_size)
 {
+    if (new_size > m_array_size)
+        m_element_kind = ElementKind::Generic;
     m_array_size = new_size;
     m_packed_elements.resize_and_keep_capacity(new_size);
     return true;
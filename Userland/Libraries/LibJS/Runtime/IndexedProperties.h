@@ -21,6 +21,16 @@ class IndexedProperties;
 class IndexedPropertyIterator;
 class GenericIndexedPropertyStorage;
 
+// What a SimpleIndexedPropertyStorage is known to contain. Kinds only ever move towards Generic.
+enum class ElementKind : u8 {
+    // No holes, and every element is an Int32.
+    PackedInt32,
+    // No holes, and every element is a Number.
+    PackedDouble,
+    // Anything, including holes.
+    Generic,
+};
+
 class IndexedPropertyStorage {
 public:
     virtual ~IndexedPropertyStorage() = default;
@@ -60,13 +70,31 @@ public:
     virtual bool is_simple_storage() const override { return true; }
     Vector<Value> const& elements() const { return m_packed_elements; }
 
+    ElementKind element_kind() const { return m_element_kind; }
+
+    // Overwrites an existing element without going through put(), for callers that have already checked the index.
+    void set_existing_element(u32 index, Value value)
+    {
+        VERIFY(index < m_array_size && !m_packed_elements[index].is_empty());
+        update_element_kind(value);
+        m_packed_elements[index] = value;
+    }
+
 private:
     friend GenericIndexedPropertyStorage;
 
     void grow_storage_if_needed();
 
+    void update_element_kind(Value value)
+    {
+        if (m_element_kind == ElementKind::Generic || value.is_int32())
+            return;
+        m_element_kind = value.is_number() ? ElementKind::PackedDouble : ElementKind::Generic;
+    }
+
     size_t m_array_size { 0 };
     Vector<Value> m_packed_elements;
+    ElementKind m_element_kind { ElementKind::PackedInt32 };
 };
 
 class GenericIndexedPropertyStorage final : public IndexedPropertyStorage {
@@ -138,6 +166,48 @@ public:
 
     size_t real_size() const;
 
+    // Returns Generic unless the elements live in simple storage.
+    ElementKind element_kind() const
+    {
+        if (!m_storage)
+            return ElementKind::PackedInt32;
+        if (!m_storage->is_simple_storage())
+            return ElementKind::Generic;
+        return static_cast<SimpleIndexedPropertyStorage const&>(*m_storage).element_kind();
+    }
+
+    // The elements of a packed storage, i.e. one whose kind is PackedInt32 or PackedDouble. Empty otherwise.
+    ReadonlySpan<Value> packed_elements() const
+    {
+        if (element_kind() == ElementKind::Generic || !m_storage)
+            return {};
+        auto const& storage = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage);
+        return storage.elements().span().trim(storage.array_like_size());
+    }
+
+    // Fast paths for the bytecode interpreter. These only deal with elements that are already present in simple
+    // storage and return an empty value / false if the caller has to go the long way round.
+    Value get_from_simple_storage(u32 index) const
+    {
+        if (!m_storage || !m_storage->is_simple_storage())
+            return {};
+        auto const& storage = static_cast<SimpleIndexedPropertyStorage const&>(*m_storage);
+        if (index >= storage.array_like_size())
+            return {};
+        return storage.elements()[index];
+    }
+
+    bool set_existing_element_in_simple_storage(u32 index, Value value)
+    {
+        if (!m_storage || !m_storage->is_simple_storage())
+            return false;
+        auto& storage = static_cast<SimpleIndexedPropertyStorage&>(*m_storage);
+        if (index >= storage.array_like_size() || storage.elements()[index].is_empty())
+            return false;
+        storage.set_existing_element(index, value);
+        return true;
+    }
+
     Vector<u32> indices() const;
 
     template<typename Callback>
@@ -1128,6 +1128,9 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
     auto metadata = shape().lookup(property_key_string_or_symbol);
 
     if (!metadata.has_value()) {
+        if (m_used_by_cached_prototype_chain_lookup)
+            vm().invalidate_prototype_chain_lookups();
+
         if (!m_shape->is_unique() && shape().property_count() > 100) {
             // If you add more than 100 properties to an object, let's stop doing
             // transitions to avoid filling up the heap with shapes.
@@ -1143,6 +1146,9 @@ void Object::storage_set(PropertyKey const& property_key, ValueAndAttributes con
         return;
     }
 
+    if (m_used_by_cached_prototype_chain_lookup && (attributes != metadata->attributes || value.is_accessor() != m_storage[metadata->offset].is_accessor()))
+        vm().invalidate_prototype_chain_lookups();
+
     if (attributes != metadata->attributes) {
         if (m_shape->is_unique())
             m_shape->reconfigure_property_in_unique_shape(property_key_string_or_symbol, attributes);
@@ -1169,6 +1175,9 @@ void Object::storage_delete(PropertyKey const& property_key)
     auto metadata = shape().lookup(property_key.to_string_or_symbol());
     VERIFY(metadata.has_value());
 
+    if (m_used_by_cached_prototype_chain_lookup)
+        vm().invalidate_prototype_chain_lookups();
+
     ensure_shape_is_unique();
 
     shape().remove_property_from_unique_shape(property_key.to_string_or_symbol(), metadata->offset);
@@ -1179,6 +1188,8 @@ void Object::set_prototype(Object* new_prototype)
 {
     if (prototype() == new_prototype)
         return;
+    if (m_used_by_cached_prototype_chain_lookup)
+        vm().invalidate_prototype_chain_lookups();
     auto& shape = this->shape();
     if (shape.is_unique())
         shape.set_prototype_without_transition(new_prototype);
@@ -1186,6 +1197,23 @@ void Object::set_prototype(Object* new_prototype)
         m_shape = shape.create_prototype_transition(new_prototype);
 }
 
+bool Object::add_property_with_cached_transition(Shape& new_shape, Value value)
+{
+    // Preventing extensions doesn't change the shape of an object, so this has to be checked separately.
+    if (!m_is_extensible)
+        return false;
+
+    VERIFY(!new_shape.is_unique());
+    VERIFY(new_shape.property_count() == m_storage.size() + 1);
+
+    if (m_used_by_cached_prototype_chain_lookup)
+        vm().invalidate_prototype_chain_lookups();
+
+    set_shape(new_shape);
+    m_storage.append(value);
+    return true;
+}
+
 void Object::define_native_accessor(Realm& realm, PropertyKey const& property_key, SafeFunction<ThrowCompletionOr<Value>(VM&)> getter, SafeFunction<ThrowCompletionOr<Value>(VM&)> setter, PropertyAttributes attribute)
 {
     FunctionObject* getter_function = nullptr;
@@ -1351,6 +1379,10 @@ void Object::visit_edges(Cell::Visitor& visitor)
     for (auto& value : m_storage)
         visitor.visit(value);
 
+    // Packed number elements can't point at cells, so big numeric arrays don't have to be scanned.
+    if (m_indexed_properties.element_kind() != ElementKind::Generic)
+        return;
+
     m_indexed_properties.for_each_value([&visitor](auto& value) {
         visitor.visit(value);
     });
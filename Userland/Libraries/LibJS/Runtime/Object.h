@@ -157,6 +157,7 @@ public:
     void define_native_function(Realm&, PropertyKey const&, SafeFunction<ThrowCompletionOr<Value>(VM&)>, i32 length, PropertyAttributes attributes);
     void define_native_accessor(Realm&, PropertyKey const&, SafeFunction<ThrowCompletionOr<Value>(VM&)> getter, SafeFunction<ThrowCompletionOr<Value>(VM&)> setter, PropertyAttributes attributes);
 
+    virtual bool is_array_exotic_object() const { return false; }
     virtual bool is_function() const { return false; }
     virtual bool is_typed_array() const { return false; }
     virtual bool is_string_object() const { return false; }
@@ -174,6 +175,18 @@ public:
     virtual void visit_edges(Cell::Visitor&) override;
 
     Value get_direct(size_t index) const { return m_storage[index]; }
+    void put_direct(size_t index, Value value) { m_storage[index] = value; }
+
+    // The bytecode interpreter caches where it found named properties, keyed on the shape of the objects it looked at.
+    // Objects whose named properties aren't all stored in their shape can't take part in that.
+    bool may_interfere_with_property_lookup_caching() const { return m_may_interfere_with_property_lookup_caching || m_has_intrinsic_accessors; }
+
+    // Changing the properties or the prototype of an object that a cached lookup went through invalidates all such lookups.
+    void set_used_by_cached_prototype_chain_lookup() { m_used_by_cached_prototype_chain_lookup = true; }
+
+    // Adds a property by switching to a put transition of the current shape that was looked up earlier.
+    // Returns false if the object isn't extensible.
+    bool add_property_with_cached_transition(Shape& new_shape, Value);
 
     IndexedProperties const& indexed_properties() const { return m_indexed_properties; }
     IndexedProperties& indexed_properties() { return m_indexed_properties; }
@@ -206,6 +219,9 @@ protected:
     // [[ParameterMap]]
     bool m_has_parameter_map { false };
 
+    // Set by exotic objects that override how named properties are looked up.
+    bool m_may_interfere_with_property_lookup_caching { false };
+
 private:
     void set_shape(Shape& shape) { m_shape = &shape; }
 
@@ -215,6 +231,8 @@ private:
     // True if this object has lazily allocated intrinsic properties.
     bool m_has_intrinsic_accessors { false };
 
+    bool m_used_by_cached_prototype_chain_lookup { false };
+
     GCPtr<Shape> m_shape;
     Vector<Value> m_storage;
     IndexedProperties m_indexed_properties;
@@ -25,6 +25,7 @@ ProxyObject::ProxyObject(Object& target, Object& handler, Object& prototype)
     , m_target(target)
     , m_handler(handler)
 {
+    m_may_interfere_with_property_lookup_caching = true;
 }
 
 static Value property_key_to_value(VM& vm, PropertyKey const& property_key)
@@ -65,6 +65,7 @@ protected:
         : Object(ConstructWithPrototypeTag::Tag, prototype)
         , m_intrinsic_constructor(intrinsic_constructor)
     {
+        m_may_interfere_with_property_lookup_caching = true;
     }
 
     u32 m_array_length { 0 };
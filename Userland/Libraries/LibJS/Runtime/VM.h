@@ -193,6 +193,10 @@ public:
     u32 execution_generation() const { return m_execution_generation; }
     void finish_execution_generation() { ++m_execution_generation; }
 
+    // Cached property lookups that went through a prototype are only valid until a prototype used by one of them changes.
+    u64 prototype_chain_generation() const { return m_prototype_chain_generation; }
+    void invalidate_prototype_chain_lookups() { ++m_prototype_chain_generation; }
+
     ThrowCompletionOr<Reference> resolve_binding(DeprecatedFlyString const&, Environment* = nullptr);
     ThrowCompletionOr<Reference> get_identifier_reference(Environment*, DeprecatedFlyString, bool strict, size_t hops = 0);
 
@@ -329,6 +333,7 @@ private:
     WellKnownSymbols m_well_known_symbols;
 
     u32 m_execution_generation { 0 };
+    u64 m_prototype_chain_generation { 0 };
 
     OwnPtr<CustomData> m_custom_data;
 };
@@ -0,0 +1,134 @@
+describe("packed number elements", () => {
+    test("int32 elements stay intact when doubles and other values are stored", () => {
+        const a = [1, 2, 3];
+        a[1] = 2.5;
+        expect(a).toEqual([1, 2.5, 3]);
+        a[2] = "foo";
+        expect(a).toEqual([1, 2.5, "foo"]);
+        a[0] = {};
+        expect(a[1]).toBe(2.5);
+        expect(typeof a[0]).toBe("object");
+    });
+
+    test("objects stored into a numeric array survive garbage collection", () => {
+        const a = [];
+        for (let i = 0; i < 100; ++i) a[i] = i;
+        a[50] = { value: "foo" };
+        gc();
+        expect(a[50].value).toBe("foo");
+        expect(a[99]).toBe(99);
+    });
+
+    test("holes are looked up on the prototype chain", () => {
+        const a = [1, 2, 3];
+        delete a[1];
+        Object.setPrototypeOf(a, [4, 5, 6]);
+        expect(a[1]).toBe(5);
+        expect(a.indexOf(5)).toBe(1);
+        expect(a.includes(5)).toBeTrue();
+    });
+
+    test("growing the length leaves holes behind", () => {
+        const a = [1, 2, 3];
+        a.length = 5;
+        expect(a.includes(undefined)).toBeTrue();
+        expect(a.indexOf(undefined)).toBe(-1);
+        expect(3 in a).toBeFalse();
+    });
+});
+
+describe("appending elements", () => {
+    test("setters on Array.prototype are called", () => {
+        let setterValue;
+        Object.defineProperty(Array.prototype, 3, {
+            set(value) {
+                setterValue = value;
+            },
+            configurable: true,
+        });
+        try {
+            const a = [1, 2, 3];
+            a[3] = 4;
+            expect(setterValue).toBe(4);
+            expect(a).toHaveLength(3);
+        } finally {
+            delete Array.prototype[3];
+        }
+    });
+
+    test("setters on Object.prototype are called", () => {
+        let setterValue;
+        Object.defineProperty(Object.prototype, 0, {
+            set(value) {
+                setterValue = value;
+            },
+            configurable: true,
+        });
+        try {
+            const a = [];
+            a[0] = "foo";
+            expect(setterValue).toBe("foo");
+            expect(a).toHaveLength(0);
+        } finally {
+            delete Object.prototype[0];
+        }
+    });
+
+    test("non-extensible arrays and arrays with non-writable length don't grow", () => {
+        const a = [1, 2];
+        Object.preventExtensions(a);
+        a[2] = 3;
+        expect(a).toEqual([1, 2]);
+
+        const b = [1, 2];
+        Object.defineProperty(b, "length", { writable: false });
+        b[2] = 3;
+        expect(b).toEqual([1, 2]);
+    });
+
+    test("frozen arrays aren't written to", () => {
+        const a = Object.freeze([1, 2, 3]);
+        a[0] = 5;
+        expect(a[0]).toBe(1);
+    });
+});
+
+describe("searching packed number elements", () => {
+    test("indexOf, lastIndexOf and includes", () => {
+        const a = [1, 2, 3, 2, 1];
+        expect(a.indexOf(2)).toBe(1);
+        expect(a.indexOf(2, 2)).toBe(3);
+        expect(a.indexOf(2, -1)).toBe(-1);
+        expect(a.lastIndexOf(2)).toBe(3);
+        expect(a.lastIndexOf(2, 2)).toBe(1);
+        expect(a.includes(3)).toBeTrue();
+        expect(a.includes(3, 3)).toBeFalse();
+        expect(a.indexOf("2")).toBe(-1);
+        expect(a.includes("2")).toBeFalse();
+    });
+
+    test("NaN and negative zero", () => {
+        const a = [1.5, NaN, -0];
+        expect(a.indexOf(NaN)).toBe(-1);
+        expect(a.lastIndexOf(NaN)).toBe(-1);
+        expect(a.includes(NaN)).toBeTrue();
+        expect(a.indexOf(0)).toBe(2);
+        expect(a.includes(+0)).toBeTrue();
+    });
+
+    test("array shrinking while converting fromIndex", () => {
+        const a = [1, 2, 3];
+        Array.prototype[2] = 3;
+        try {
+            const fromIndex = {
+                valueOf() {
+                    a.length = 1;
+                    return 0;
+                },
+            };
+            expect(a.indexOf(3, fromIndex)).toBe(2);
+        } finally {
+            delete Array.prototype[2];
+        }
+    });
+});
@@ -59,6 +59,8 @@ Regex<Parser>::Regex(Regex&& regex)
     : pattern_value(move(regex.pattern_value))
     , parser_result(move(regex.parser_result))
     , matcher(move(regex.matcher))
+    , pike_vm(move(regex.pike_vm))
+    , literal_prefilter(move(regex.literal_prefilter))
     , start_offset(regex.start_offset)
 {
     if (matcher)
@@ -71,6 +73,8 @@ Regex<Parser>& Regex<Parser>::operator=(Regex&& regex)
     pattern_value = move(regex.pattern_value);
     parser_result = move(regex.parser_result);
     matcher = move(regex.matcher);
+    pike_vm = move(regex.pike_vm);
+    literal_prefilter = move(regex.literal_prefilter);
     if (matcher)
         matcher->reset_pattern({}, this);
     start_offset = regex.start_offset;
@@ -185,6 +189,11 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
 
     auto single_match_only = input.regex_options.has_flag_set(AllFlags::SingleMatch);
 
+    // The prefilter compares characters exactly, so it can't say anything about case insensitive matches.
+    LiteralPrefilter const* prefilter = nullptr;
+    if (m_pattern->literal_prefilter.has_value() && !input.regex_options.has_flag_set(AllFlags::Insensitive))
+        prefilter = &m_pattern->literal_prefilter.value();
+
     for (auto const& view : views) {
         if (lines_to_skip != 0) {
             ++input.line;
@@ -231,7 +240,18 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             }
         }
 
-        for (; view_index <= view_length; ++view_index) {
+        // Don't bother running the pattern if a literal that every match needs isn't even there.
+        auto may_match = !prefilter || prefilter->may_match(view, view_index);
+        auto can_skip_to_candidates = prefilter && prefilter->can_skip_to_candidates() && continue_search && !view.unicode();
+
+        for (; may_match && view_index <= view_length; ++view_index) {
+            if (can_skip_to_candidates) {
+                auto candidate = prefilter->next_candidate(view, view_index);
+                if (!candidate.has_value())
+                    break;
+                view_index = candidate.value();
+            }
+
             if (view_index == view_length && input.regex_options.has_flag_set(AllFlags::Multiline))
                 break;
 
@@ -253,7 +273,25 @@ RegexResult Matcher<Parser>::match(Vector<RegexStringView> const& views, Optiona
             state.instruction_position = 0;
             state.repetition_marks.clear();
 
-            auto success = execute(input, state, operations);
+            bool success;
+            if (auto& pike_vm = m_pattern->pike_vm) {
+                // The Pike VM looks at all the remaining start positions at once, so there's no point in coming
+                // back here if it didn't find anything.
+                auto last_start_position = continue_search ? view_length : view_index;
+                if (input.regex_options.has_flag_set(AllFlags::Multiline) && last_start_position == view_length)
+                    --last_start_position;
+                if (match_length_minimum)
+                    last_start_position = min(last_start_position, view_length - match_length_minimum);
+
+                auto match_start = pike_vm->match(m_pattern->parser_result.bytecode, input, state, last_start_position, can_skip_to_candidates ? prefilter : nullptr, operations);
+                if (!match_start.has_value())
+                    break;
+                view_index = match_start.value();
+                success = true;
+            } else {
+                success = execute(input, state, operations);
+            }
+
             if (success) {
                 succeeded = true;
 
@@ -10,6 +10,8 @@
 #include "RegexMatch.h"
 #include "RegexOptions.h"
 #include "RegexParser.h"
+#include "RegexPikeVM.h"
+#include "RegexPrefilter.h"
 
 #include <AK/Forward.h>
 #include <AK/GenericLexer.h>
@@ -85,6 +87,8 @@ public:
     DeprecatedString pattern_value;
     regex::Parser::Result parser_result;
     OwnPtr<Matcher<Parser>> matcher { nullptr };
+    OwnPtr<PikeVM> pike_vm { nullptr }; // Set if the pattern can be matched in linear time, see RegexPikeVM.h.
+    Optional<LiteralPrefilter> literal_prefilter;
     mutable size_t start_offset { 0 };
 
     static regex::Parser::Result parse_pattern(StringView pattern, typename ParserTraits<Parser>::OptionsType regex_options = {});
@@ -231,6 +235,7 @@ public:
 private:
     void run_optimization_passes();
     void attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&);
+    void extract_literal_prefilter();
 };
 
 // free standing functions for match, search and has_match
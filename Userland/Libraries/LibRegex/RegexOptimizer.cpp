@@ -29,6 +29,14 @@ void Regex<Parser>::run_optimization_passes()
     attempt_rewrite_loops_as_atomic_groups(split_basic_blocks(parser_result.bytecode));
 
     parser_result.bytecode.flatten();
+
+    if (parser_result.error == Error::NoError) {
+        // Patterns that never need to look back at what they matched before can be run without backtracking.
+        pike_vm = PikeVM::try_create(parser_result.bytecode);
+
+        // Find literals that have to be in the input for there to be a match, so we can skip looking everywhere else.
+        extract_literal_prefilter();
+    }
 }
 
 template<typename Parser>
@@ -641,6 +649,209 @@ void Regex<Parser>::attempt_rewrite_loops_as_atomic_groups(BasicBlockList const&
     }
 }
 
+// Returns the characters a Compare matches if it only matches a fixed ASCII string, and nothing otherwise.
+static Optional<StringView> ascii_literal_of(OpCode_Compare const& compare, StringBuilder& builder)
+{
+    if (compare.arguments_count() != 1)
+        return {};
+
+    auto& bytecode = compare.bytecode();
+    auto offset = compare.state().instruction_position + 3;
+    builder.clear();
+
+    switch (static_cast<CharacterCompareType>(bytecode.at(offset++))) {
+    case CharacterCompareType::Char:
+        if (!is_ascii(bytecode.at(offset)))
+            return {};
+        builder.append(static_cast<char>(bytecode.at(offset)));
+        break;
+    case CharacterCompareType::String: {
+        auto length = bytecode.at(offset++);
+        if (length == 0)
+            return {};
+        for (size_t i = 0; i < length; ++i) {
+            if (!is_ascii(bytecode.at(offset + i)))
+                return {};
+            builder.append(static_cast<char>(bytecode.at(offset + i)));
+        }
+        break;
+    }
+    default:
+        return {};
+    }
+
+    return builder.string_view();
+}
+
+template<typename Parser>
+void Regex<Parser>::extract_literal_prefilter()
+{
+    auto& bytecode = parser_result.bytecode;
+    auto bytecode_size = bytecode.size();
+    LiteralPrefilter prefilter;
+    StringBuilder literal_builder;
+
+    // Look for the longest string of literals on the path every match has to take, i.e. ones that no jump skips over.
+    {
+        StringBuilder current_literal;
+        bool current_literal_is_prefix = false;
+        bool has_seen_jump = false;
+        bool has_seen_consuming_opcode = false;
+        size_t furthest_jump_target = 0;
+
+        auto end_current_literal = [&] {
+            if (current_literal.length() > prefilter.required_literal.length()) {
+                prefilter.required_literal = current_literal.to_deprecated_string();
+                prefilter.required_literal_is_prefix = current_literal_is_prefix;
+            }
+            current_literal.clear();
+        };
+
+        MatchState state;
+        while (state.instruction_position < bytecode_size) {
+            auto& opcode = bytecode.get_opcode(state);
+            auto next_position = state.instruction_position + opcode.size();
+
+            switch (opcode.opcode_id()) {
+            case OpCodeId::Compare: {
+                auto literal = ascii_literal_of(static_cast<OpCode_Compare const&>(opcode), literal_builder);
+                if (!literal.has_value() || furthest_jump_target > state.instruction_position) {
+                    end_current_literal();
+                } else {
+                    if (current_literal.is_empty())
+                        current_literal_is_prefix = !has_seen_jump && !has_seen_consuming_opcode;
+                    current_literal.append(literal.value());
+                }
+                has_seen_consuming_opcode = true;
+                break;
+            }
+            case OpCodeId::Jump:
+                end_current_literal();
+                has_seen_jump = true;
+                furthest_jump_target = max(furthest_jump_target, next_position + static_cast<OpCode_Jump const&>(opcode).offset());
+                break;
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkReplaceJump:
+                end_current_literal();
+                has_seen_jump = true;
+                furthest_jump_target = max(furthest_jump_target, next_position + static_cast<OpCode_ForkJump const&>(opcode).offset());
+                break;
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay:
+                end_current_literal();
+                has_seen_jump = true;
+                furthest_jump_target = max(furthest_jump_target, next_position + static_cast<OpCode_ForkStay const&>(opcode).offset());
+                break;
+            case OpCodeId::JumpNonEmpty:
+                end_current_literal();
+                has_seen_jump = true;
+                furthest_jump_target = max(furthest_jump_target, next_position + static_cast<OpCode_JumpNonEmpty const&>(opcode).offset());
+                break;
+            case OpCodeId::Repeat:
+                end_current_literal();
+                has_seen_jump = true;
+                break;
+            case OpCodeId::SaveLeftCaptureGroup:
+            case OpCodeId::SaveRightCaptureGroup:
+            case OpCodeId::SaveRightNamedCaptureGroup:
+            case OpCodeId::ClearCaptureGroup:
+            case OpCodeId::Checkpoint:
+            case OpCodeId::ResetRepeat:
+            case OpCodeId::CheckBegin:
+            case OpCodeId::CheckEnd:
+            case OpCodeId::CheckBoundary:
+                // These don't consume anything, the literals around them still have to be next to each other.
+                break;
+            default:
+                // Lookaround can look at text outside of the match, don't try to reason about it.
+                return;
+            }
+
+            state.instruction_position = next_position;
+        }
+        end_current_literal();
+    }
+
+    // Otherwise, collect the characters the alternatives at the start of the pattern begin with, e.g. "E" and "W" for
+    // "ERROR|WARNING".
+    if (!prefilter.required_literal_is_prefix) {
+        auto collect_first_characters = [&]() -> bool {
+            Vector<size_t> positions_to_visit { 0 };
+            HashTable<size_t> visited_positions;
+            MatchState state;
+            while (!positions_to_visit.is_empty()) {
+                auto position = positions_to_visit.take_last();
+                if (visited_positions.set(position) != HashSetResult::InsertedNewEntry)
+                    continue;
+                if (position >= bytecode_size) {
+                    // The pattern can match the empty string.
+                    return false;
+                }
+
+                state.instruction_position = position;
+                auto& opcode = bytecode.get_opcode(state);
+                auto next_position = position + opcode.size();
+
+                switch (opcode.opcode_id()) {
+                case OpCodeId::Compare: {
+                    auto literal = ascii_literal_of(static_cast<OpCode_Compare const&>(opcode), literal_builder);
+                    if (!literal.has_value())
+                        return false;
+                    auto first_character = literal.value()[0];
+                    if (prefilter.first_characters.contains_slow(first_character))
+                        break;
+                    if (prefilter.first_characters.size() == LiteralPrefilter::max_first_characters)
+                        return false;
+                    prefilter.first_characters.append(first_character);
+                    break;
+                }
+                case OpCodeId::Jump:
+                    positions_to_visit.append(next_position + static_cast<OpCode_Jump const&>(opcode).offset());
+                    break;
+                case OpCodeId::ForkJump:
+                case OpCodeId::ForkReplaceJump:
+                    positions_to_visit.append(next_position + static_cast<OpCode_ForkJump const&>(opcode).offset());
+                    positions_to_visit.append(next_position);
+                    break;
+                case OpCodeId::ForkStay:
+                case OpCodeId::ForkReplaceStay:
+                    positions_to_visit.append(next_position + static_cast<OpCode_ForkStay const&>(opcode).offset());
+                    positions_to_visit.append(next_position);
+                    break;
+                case OpCodeId::JumpNonEmpty:
+                    positions_to_visit.append(next_position + static_cast<OpCode_JumpNonEmpty const&>(opcode).offset());
+                    positions_to_visit.append(next_position);
+                    break;
+                case OpCodeId::Repeat:
+                    positions_to_visit.append(position - static_cast<OpCode_Repeat const&>(opcode).offset());
+                    positions_to_visit.append(next_position);
+                    break;
+                case OpCodeId::SaveLeftCaptureGroup:
+                case OpCodeId::SaveRightCaptureGroup:
+                case OpCodeId::SaveRightNamedCaptureGroup:
+                case OpCodeId::ClearCaptureGroup:
+                case OpCodeId::Checkpoint:
+                case OpCodeId::ResetRepeat:
+                case OpCodeId::CheckBegin:
+                case OpCodeId::CheckEnd:
+                case OpCodeId::CheckBoundary:
+                    positions_to_visit.append(next_position);
+                    break;
+                default:
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        if (!collect_first_characters())
+            prefilter.first_characters.clear();
+    }
+
+    if (!prefilter.is_empty())
+        literal_prefilter = move(prefilter);
+}
+
 void Optimizer::append_alternation(ByteCode& target, ByteCode&& left, ByteCode&& right)
 {
     Array<ByteCode, 2> alternatives;
@@ -0,0 +1,493 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/HashMap.h>
+#include <AK/NumericLimits.h>
+#include <LibRegex/RegexPikeVM.h>
+
+namespace regex {
+
+// Counted repetitions are unrolled, stop before the program gets big enough to make every step slow.
+static constexpr size_t max_program_size = 10000;
+
+static constexpr size_t unset_position = NumericLimits<size_t>::max();
+
+class PikeVM::Compiler {
+public:
+    Compiler(ByteCode const& bytecode)
+        : m_bytecode(bytecode)
+    {
+    }
+
+    OwnPtr<PikeVM> compile()
+    {
+        Vector<Fixup> unresolved_fixups;
+        if (!compile_range(0, m_bytecode.size(), unresolved_fixups) || !unresolved_fixups.is_empty())
+            return nullptr;
+
+        m_program.append({ .kind = Instruction::Kind::Match });
+        return adopt_own(*new PikeVM(move(m_program), move(m_group_names)));
+    }
+
+private:
+    struct Fixup {
+        size_t instruction;
+        size_t target_position;
+        bool is_checkpoint { false };
+    };
+
+    static bool can_be_simulated(OpCode_Compare const& compare)
+    {
+        auto& bytecode = compare.bytecode();
+        auto offset = compare.state().instruction_position + 3;
+        for (size_t i = 0; i < compare.arguments_count(); ++i) {
+            switch (static_cast<CharacterCompareType>(bytecode.at(offset++))) {
+            case CharacterCompareType::Reference:
+                // Backreferences depend on what the thread has captured so far.
+                return false;
+            case CharacterCompareType::String: {
+                // A zero-length match would have to continue without advancing to the next position.
+                auto length = bytecode.at(offset++);
+                if (length == 0)
+                    return false;
+                offset += length;
+                break;
+            }
+            case CharacterCompareType::LookupTable:
+                offset += bytecode.at(offset) + 1;
+                break;
+            case CharacterCompareType::Inverse:
+            case CharacterCompareType::TemporaryInverse:
+            case CharacterCompareType::AnyChar:
+            case CharacterCompareType::And:
+            case CharacterCompareType::Or:
+            case CharacterCompareType::EndAndOr:
+                break;
+            default:
+                ++offset;
+                break;
+            }
+        }
+        return true;
+    }
+
+    void set_group_name(size_t group, StringView name)
+    {
+        if (group >= m_group_names.size())
+            m_group_names.resize(group + 1);
+        m_group_names[group] = name;
+    }
+
+    // Appends the instructions for [begin, end) of the bytecode to the program. Jumps that leave the range are
+    // handed to the caller through `unresolved_fixups`, a jump to `end` continues with whatever follows the range.
+    bool compile_range(size_t begin, size_t end, Vector<Fixup>& unresolved_fixups)
+    {
+        HashMap<size_t, size_t> instruction_indices;
+        Vector<Fixup> fixups;
+
+        auto append = [&](Instruction instruction) {
+            m_program.append(instruction);
+            return m_program.size() - 1;
+        };
+
+        MatchState state;
+        state.instruction_position = begin;
+        while (state.instruction_position < end) {
+            if (m_program.size() > max_program_size)
+                return false;
+
+            auto position = state.instruction_position;
+            instruction_indices.set(position, m_program.size());
+
+            auto& opcode = m_bytecode.get_opcode(state);
+            auto next_position = position + opcode.size();
+
+            switch (opcode.opcode_id()) {
+            case OpCodeId::Compare:
+                if (!can_be_simulated(to<OpCode_Compare>(opcode)))
+                    return false;
+                append({ .kind = Instruction::Kind::Compare, .bytecode_position = position });
+                break;
+            case OpCodeId::CheckBegin:
+            case OpCodeId::CheckEnd:
+            case OpCodeId::CheckBoundary:
+                append({ .kind = Instruction::Kind::Assertion, .bytecode_position = position });
+                break;
+            case OpCodeId::Jump: {
+                auto index = append({ .kind = Instruction::Kind::Jump });
+                fixups.append({ index, next_position + to<OpCode_Jump>(opcode).offset() });
+                break;
+            }
+            case OpCodeId::ForkJump:
+            case OpCodeId::ForkReplaceJump: {
+                // Replacing forks only drop alternatives that can't lead to a match, all of them can be kept here.
+                auto index = append({ .kind = Instruction::Kind::Fork, .is_fork = true, .prefer_target = true });
+                fixups.append({ index, next_position + to<OpCode_ForkJump>(opcode).offset() });
+                break;
+            }
+            case OpCodeId::ForkStay:
+            case OpCodeId::ForkReplaceStay: {
+                auto index = append({ .kind = Instruction::Kind::Fork, .is_fork = true, .prefer_target = false });
+                fixups.append({ index, next_position + to<OpCode_ForkStay>(opcode).offset() });
+                break;
+            }
+            case OpCodeId::JumpNonEmpty: {
+                auto& jump = to<OpCode_JumpNonEmpty>(opcode);
+                auto form = jump.form();
+                auto index = append({
+                    .kind = Instruction::Kind::JumpNonEmpty,
+                    .is_fork = form != OpCodeId::Jump,
+                    .prefer_target = form == OpCodeId::ForkJump || form == OpCodeId::ForkReplaceJump,
+                });
+                fixups.append({ index, next_position + jump.offset() });
+                fixups.append({ index, next_position + jump.checkpoint(), true });
+                break;
+            }
+            case OpCodeId::Checkpoint:
+                append({ .kind = Instruction::Kind::Checkpoint });
+                break;
+            case OpCodeId::SaveLeftCaptureGroup:
+                append({ .kind = Instruction::Kind::SaveLeftCaptureGroup, .group = to<OpCode_SaveLeftCaptureGroup>(opcode).id() });
+                break;
+            case OpCodeId::SaveRightCaptureGroup:
+                append({ .kind = Instruction::Kind::SaveRightCaptureGroup, .group = to<OpCode_SaveRightCaptureGroup>(opcode).id() });
+                break;
+            case OpCodeId::SaveRightNamedCaptureGroup: {
+                auto& save = to<OpCode_SaveRightNamedCaptureGroup>(opcode);
+                set_group_name(save.id(), save.name());
+                append({ .kind = Instruction::Kind::SaveRightCaptureGroup, .group = save.id() });
+                break;
+            }
+            case OpCodeId::ClearCaptureGroup:
+                append({ .kind = Instruction::Kind::ClearCaptureGroup, .group = to<OpCode_ClearCaptureGroup>(opcode).id() });
+                break;
+            case OpCodeId::Repeat: {
+                // REPEAT jumps back to the start of the repeated block until it has been run `count` times,
+                // unroll the block instead so that the count doesn't have to be tracked per thread.
+                auto& repeat = to<OpCode_Repeat>(opcode);
+                auto count = repeat.count();
+                if (count == 0 || repeat.offset() > position - begin)
+                    return false;
+                auto block_start = position - repeat.offset();
+                for (size_t i = 1; i < count; ++i) {
+                    if (!compile_range(block_start, position, fixups))
+                        return false;
+                }
+                break;
+            }
+            case OpCodeId::ResetRepeat:
+                // Nothing to reset once repetitions are unrolled.
+                break;
+            default:
+                // Lookaround and explicit exits need the backtracking matcher.
+                return false;
+            }
+
+            state.instruction_position = next_position;
+        }
+
+        auto end_index = m_program.size();
+        for (auto& fixup : fixups) {
+            size_t index;
+            if (fixup.target_position == end) {
+                index = end_index;
+            } else if (fixup.target_position >= begin && fixup.target_position < end) {
+                auto it = instruction_indices.find(fixup.target_position);
+                if (it == instruction_indices.end())
+                    return false;
+                index = it->value;
+            } else {
+                unresolved_fixups.append(fixup);
+                continue;
+            }
+
+            auto& instruction = m_program[fixup.instruction];
+            if (fixup.is_checkpoint)
+                instruction.checkpoint = index;
+            else
+                instruction.target = index;
+        }
+        return true;
+    }
+
+    ByteCode const& m_bytecode;
+    Vector<Instruction> m_program;
+    Vector<StringView> m_group_names;
+};
+
+OwnPtr<PikeVM> PikeVM::try_create(ByteCode const& bytecode)
+{
+    return Compiler(bytecode).compile();
+}
+
+namespace {
+
+struct Thread {
+    size_t instruction { 0 };
+    size_t start_position { 0 };
+    // The position a multi-character comparison will be done consuming at; the thread can't continue before then.
+    size_t resume_position { 0 };
+    // For each capture group: the position of its left paren, and the start and end of the last completed capture.
+    Vector<size_t, 12> captures;
+};
+
+}
+
+Optional<size_t> PikeVM::match(ByteCode const& bytecode, MatchInput const& input, MatchState& state, size_t last_start_position, LiteralPrefilter const* prefilter, size_t& operations) const
+{
+    auto const& view = input.view;
+    auto view_length = view.length();
+
+    Vector<Thread> current_threads;
+    Vector<Thread> next_threads;
+
+    // Instructions visited by threads at the position being stepped to, to only keep the highest priority thread.
+    Vector<size_t> visited_generation;
+    visited_generation.resize(m_program.size());
+    size_t generation = 0;
+
+    struct PendingThread {
+        Thread thread;
+        // The checkpoints passed since the thread arrived at this position, i.e. the loops whose current iteration
+        // hasn't consumed anything yet.
+        Vector<size_t, 4> checkpoints;
+    };
+    Vector<PendingThread> pending_threads;
+
+    MatchState scratch_state;
+
+    auto run_opcode_at = [&](size_t bytecode_position, size_t position, size_t position_in_code_units) {
+        scratch_state.instruction_position = bytecode_position;
+        scratch_state.string_position = position;
+        scratch_state.string_position_in_code_units = position_in_code_units;
+        auto& opcode = bytecode.get_opcode(scratch_state);
+        return opcode.execute(input, scratch_state);
+    };
+
+    // Follows everything that doesn't consume input from the thread's instruction, and adds the threads that end up
+    // waiting for input (or at the end of the program) to `threads` in priority order.
+    auto add_thread = [&](Vector<Thread>& threads, Thread thread, size_t position, size_t position_in_code_units) {
+        pending_threads.append({ move(thread), {} });
+        while (!pending_threads.is_empty()) {
+            auto pending = pending_threads.take_last();
+            auto& pc = pending.thread.instruction;
+            for (;;) {
+                if (visited_generation[pc] == generation)
+                    break;
+                visited_generation[pc] = generation;
+                ++operations;
+
+                auto& instruction = m_program[pc];
+                bool stop = false;
+                switch (instruction.kind) {
+                case Instruction::Kind::Compare:
+                case Instruction::Kind::Match:
+                    threads.append(move(pending.thread));
+                    stop = true;
+                    break;
+                case Instruction::Kind::Assertion:
+                    if (run_opcode_at(instruction.bytecode_position, position, position_in_code_units) != ExecutionResult::Continue)
+                        stop = true;
+                    else
+                        ++pc;
+                    break;
+                case Instruction::Kind::Jump:
+                    pc = instruction.target;
+                    break;
+                case Instruction::Kind::JumpNonEmpty:
+                    // An iteration that hasn't consumed anything leaves the loop.
+                    if (pending.checkpoints.contains_slow(instruction.checkpoint)) {
+                        ++pc;
+                        break;
+                    }
+                    if (!instruction.is_fork) {
+                        pc = instruction.target;
+                        break;
+                    }
+                    [[fallthrough]];
+                case Instruction::Kind::Fork: {
+                    auto preferred = instruction.prefer_target ? instruction.target : pc + 1;
+                    auto other = instruction.prefer_target ? pc + 1 : instruction.target;
+                    pending_threads.append({ pending.thread, pending.checkpoints });
+                    pending_threads.last().thread.instruction = other;
+                    pc = preferred;
+                    break;
+                }
+                case Instruction::Kind::Checkpoint:
+                    pending.checkpoints.append(pc);
+                    ++pc;
+                    break;
+                case Instruction::Kind::SaveLeftCaptureGroup:
+                    pending.thread.captures[instruction.group * 3] = position;
+                    ++pc;
+                    break;
+                case Instruction::Kind::SaveRightCaptureGroup: {
+                    auto* captures = pending.thread.captures.data() + instruction.group * 3;
+                    captures[1] = captures[0];
+                    captures[2] = position;
+                    ++pc;
+                    break;
+                }
+                case Instruction::Kind::ClearCaptureGroup: {
+                    auto* captures = pending.thread.captures.data() + instruction.group * 3;
+                    captures[0] = captures[1] = captures[2] = unset_position;
+                    ++pc;
+                    break;
+                }
+                }
+                if (stop)
+                    break;
+            }
+        }
+    };
+
+    auto advance_in_code_units = [&](size_t position_in_code_units) {
+        if (!view.unicode())
+            return position_in_code_units + 1;
+        if (position_in_code_units < view.length_in_code_units())
+            return position_in_code_units + view.length_of_code_point(view[position_in_code_units]);
+        return position_in_code_units;
+    };
+
+    auto group_count = m_group_names.size();
+    for (auto& instruction : m_program) {
+        if (instruction.kind == Instruction::Kind::SaveLeftCaptureGroup)
+            group_count = max(group_count, instruction.group + 1);
+    }
+
+    auto new_thread = [&](size_t position) {
+        Thread thread;
+        thread.start_position = position;
+        thread.resume_position = position;
+        thread.captures.resize(group_count * 3);
+        for (auto& capture : thread.captures)
+            capture = unset_position;
+        return thread;
+    };
+
+    size_t position = state.string_position;
+    size_t position_in_code_units = state.string_position_in_code_units;
+
+    // The next position the prefilter thinks a match could start at, looked up as we go.
+    Optional<size_t> next_candidate = position;
+    auto is_candidate = [&](size_t candidate_position) {
+        if (!prefilter)
+            return true;
+        if (next_candidate.has_value() && next_candidate.value() < candidate_position)
+            next_candidate = prefilter->next_candidate(view, candidate_position);
+        return next_candidate == candidate_position;
+    };
+
+    Optional<Thread> best_match;
+    size_t best_match_end = 0;
+    size_t best_match_end_in_code_units = 0;
+
+    ++generation;
+    add_thread(current_threads, new_thread(position), position, position_in_code_units);
+
+    for (;;) {
+        auto next_position = position + 1;
+        auto next_position_in_code_units = advance_in_code_units(position_in_code_units);
+        ++generation;
+
+        for (auto& thread : current_threads) {
+            if (thread.resume_position > position) {
+                if (thread.resume_position == next_position)
+                    add_thread(next_threads, move(thread), next_position, next_position_in_code_units);
+                else
+                    next_threads.append(move(thread));
+                continue;
+            }
+
+            auto& instruction = m_program[thread.instruction];
+            if (instruction.kind == Instruction::Kind::Match) {
+                // Everything after this thread has a lower priority, and can't produce a better match.
+                best_match = move(thread);
+                best_match_end = position;
+                best_match_end_in_code_units = position_in_code_units;
+                break;
+            }
+
+            ++operations;
+            if (run_opcode_at(instruction.bytecode_position, position, position_in_code_units) != ExecutionResult::Continue)
+                continue;
+
+            ++thread.instruction;
+            if (scratch_state.string_position == next_position) {
+                add_thread(next_threads, move(thread), next_position, next_position_in_code_units);
+            } else {
+                thread.resume_position = scratch_state.string_position;
+                next_threads.append(move(thread));
+            }
+        }
+
+        if (position >= view_length)
+            break;
+
+        if (!best_match.has_value() && next_position <= last_start_position && is_candidate(next_position))
+            add_thread(next_threads, new_thread(next_position), next_position, next_position_in_code_units);
+
+        if (prefilter && next_threads.is_empty() && !best_match.has_value()) {
+            // Nothing is running, go straight to where the next match could start.
+            // Prefilters are only used when positions and code units are the same thing.
+            is_candidate(next_position + 1);
+            if (!next_candidate.has_value() || next_candidate.value() > last_start_position)
+                break;
+            next_position = next_candidate.value();
+            next_position_in_code_units = next_position;
+            // Threads that died at the position we skipped have marked instructions as visited.
+            ++generation;
+            add_thread(next_threads, new_thread(next_position), next_position, next_position_in_code_units);
+        }
+
+        if (next_threads.is_empty() && (best_match.has_value() || next_position > last_start_position))
+            break;
+
+        swap(current_threads, next_threads);
+        next_threads.clear_with_capacity();
+        position = next_position;
+        position_in_code_units = next_position_in_code_units;
+    }
+
+    if (!best_match.has_value())
+        return {};
+
+    state.string_position = best_match_end;
+    state.string_position_in_code_units = best_match_end_in_code_units;
+
+    while (state.capture_group_matches.size() <= input.match_index)
+        state.capture_group_matches.empend();
+    auto& groups = state.capture_group_matches[input.match_index];
+    groups.clear_with_capacity();
+    groups.resize(group_count);
+
+    auto& captures = best_match->captures;
+    for (size_t group = 0; group < group_count; ++group) {
+        auto start_position = captures[group * 3 + 1];
+        auto end_position = captures[group * 3 + 2];
+        if (start_position == unset_position || end_position == unset_position)
+            continue;
+
+        auto capture_view = view.substring_view(start_position, end_position - start_position);
+        auto name = group < m_group_names.size() ? m_group_names[group] : StringView {};
+        auto& match = groups[group];
+        if (input.regex_options & AllFlags::StringCopyMatches) {
+            if (name.is_empty())
+                match = { capture_view.to_deprecated_string(), input.line, start_position, input.global_offset + start_position };
+            else
+                match = { capture_view.to_deprecated_string(), name, input.line, start_position, input.global_offset + start_position };
+        } else {
+            if (name.is_empty())
+                match = { capture_view, input.line, start_position, input.global_offset + start_position };
+            else
+                match = { capture_view, name, input.line, start_position, input.global_offset + start_position };
+        }
+    }
+
+    return best_match->start_position;
+}
+
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexByteCode.h"
+#include "RegexMatch.h"
+#include "RegexPrefilter.h"
+
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/StringView.h>
+#include <AK/Types.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Runs a pattern by simulating all of its alternatives in lockstep over the input (a "Pike VM"), instead of trying
+// them one after another like Matcher::execute() does. Every position of the input is looked at only once per
+// instruction, so matching takes time linear in the length of the input no matter how much the pattern would
+// have to backtrack.
+// Threads are kept ordered by the priority the backtracking matcher would have tried them in, and a thread is
+// dropped as soon as a higher priority thread has reached the same instruction at the same position; so the match
+// (and its capture groups) is the same one the backtracking matcher would have found.
+// Only patterns whose outcome doesn't depend on anything but the current instruction and position can be run this
+// way, i.e. ones without backreferences or lookaround.
+class PikeVM {
+public:
+    // Returns null if the bytecode uses something that can't be simulated.
+    static OwnPtr<PikeVM> try_create(ByteCode const&);
+
+    // Looks for the leftmost match starting somewhere in [state.string_position, last_start_position].
+    // On success, returns the start of the match, leaves its end in `state` and fills in the capture groups for
+    // input.match_index.
+    // If a prefilter is given, new threads are only started at the candidate positions it finds.
+    Optional<size_t> match(ByteCode const&, MatchInput const&, MatchState&, size_t last_start_position, LiteralPrefilter const*, size_t& operations) const;
+
+private:
+    struct Instruction {
+        enum class Kind : u8 {
+            Compare,
+            Assertion,
+            Jump,
+            Fork,
+            JumpNonEmpty,
+            Checkpoint,
+            SaveLeftCaptureGroup,
+            SaveRightCaptureGroup,
+            ClearCaptureGroup,
+            Match,
+        };
+
+        Kind kind;
+        bool is_fork { false };
+        bool prefer_target { false };
+        size_t bytecode_position { 0 };
+        size_t target { 0 };
+        size_t checkpoint { 0 };
+        size_t group { 0 };
+    };
+
+    class Compiler;
+
+    PikeVM(Vector<Instruction> program, Vector<StringView> group_names)
+        : m_program(move(program))
+        , m_group_names(move(group_names))
+    {
+    }
+
+    Vector<Instruction> m_program;
+    Vector<StringView> m_group_names; // Empty for unnamed groups.
+};
+
+}
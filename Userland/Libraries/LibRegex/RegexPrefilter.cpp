@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Array.h>
+#include <AK/MemMem.h>
+#include <LibRegex/RegexPrefilter.h>
+#include <string.h>
+
+namespace regex {
+
+template<typename CodeUnit>
+static Optional<size_t> find_character(ReadonlySpan<CodeUnit> code_units, size_t position, char character)
+{
+    if constexpr (sizeof(CodeUnit) == 1) {
+        if (position >= code_units.size())
+            return {};
+        auto const* found = static_cast<CodeUnit const*>(memchr(code_units.data() + position, character, code_units.size() - position));
+        if (!found)
+            return {};
+        return found - code_units.data();
+    } else {
+        for (size_t i = position; i < code_units.size(); ++i) {
+            if (code_units[i] == static_cast<CodeUnit>(character))
+                return i;
+        }
+        return {};
+    }
+}
+
+template<typename CodeUnit>
+static Optional<size_t> find_any_character(ReadonlySpan<CodeUnit> code_units, size_t position, ReadonlySpan<char> characters)
+{
+    if (characters.size() == 1)
+        return find_character(code_units, position, characters[0]);
+
+    Array<bool, 128> is_first_character {};
+    for (auto character : characters)
+        is_first_character[character] = true;
+
+    for (size_t i = position; i < code_units.size(); ++i) {
+        auto code_unit = code_units[i];
+        if (code_unit < 128 && is_first_character[code_unit])
+            return i;
+    }
+    return {};
+}
+
+template<typename CodeUnit>
+static Optional<size_t> find_literal(ReadonlySpan<CodeUnit> code_units, size_t position, StringView literal)
+{
+    if (position > code_units.size() || literal.length() > code_units.size() - position)
+        return {};
+
+    if constexpr (sizeof(CodeUnit) == 1) {
+        auto offset = AK::memmem_optional(code_units.data() + position, code_units.size() - position, literal.characters_without_null_termination(), literal.length());
+        if (!offset.has_value())
+            return {};
+        return position + offset.value();
+    } else {
+        auto last_start = code_units.size() - literal.length();
+        while (position <= last_start) {
+            auto start = find_character(code_units.slice(0, last_start + 1), position, literal[0]);
+            if (!start.has_value())
+                return {};
+
+            size_t i = 1;
+            while (i < literal.length() && code_units[start.value() + i] == static_cast<CodeUnit>(literal[i]))
+                ++i;
+            if (i == literal.length())
+                return start;
+            position = start.value() + 1;
+        }
+        return {};
+    }
+}
+
+template<typename Callback>
+static auto visit_code_units(RegexStringView const& view, Callback callback)
+{
+    return view.visit(
+        [&](StringView view) { return callback(view.bytes()); },
+        [&](Utf8View const& view) { return callback(view.as_string().bytes()); },
+        [&](Utf16View const& view) { return callback(ReadonlySpan<u16> { view.data(), view.length_in_code_units() }); },
+        [&](Utf32View const& view) { return callback(ReadonlySpan<u32> { view.code_points(), view.length() }); });
+}
+
+bool LiteralPrefilter::may_match(RegexStringView const& view, size_t position) const
+{
+    if (required_literal.is_empty())
+        return true;
+
+    // Unicode positions count code points, look at the whole view rather than converting them.
+    if (view.unicode())
+        position = 0;
+
+    return visit_code_units(view, [&](auto code_units) {
+        return find_literal(code_units, position, required_literal).has_value();
+    });
+}
+
+Optional<size_t> LiteralPrefilter::next_candidate(RegexStringView const& view, size_t position) const
+{
+    VERIFY(!view.unicode());
+
+    return visit_code_units(view, [&](auto code_units) -> Optional<size_t> {
+        if (required_literal_is_prefix)
+            return find_literal(code_units, position, required_literal);
+        if (!first_characters.is_empty())
+            return find_any_character(code_units, position, first_characters.span());
+        if (position < code_units.size())
+            return position;
+        return {};
+    });
+}
+
+}
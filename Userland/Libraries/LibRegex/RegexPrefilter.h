@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "RegexMatch.h"
+
+#include <AK/DeprecatedString.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+
+namespace regex {
+
+// Literal characters a pattern can't match without, see Regex::extract_literal_prefilter().
+// Matcher uses these to skip over input that can't contain a match with memchr()/memmem() style scans, instead of
+// running the pattern at every position.
+// Only ASCII characters are collected, they look the same in every encoding a RegexStringView can have.
+// None of this holds for case insensitive matches.
+struct LiteralPrefilter {
+    // Every match contains this string.
+    DeprecatedString required_literal;
+    // Whether every match starts with `required_literal`.
+    bool required_literal_is_prefix { false };
+    // If not empty, every match starts with one of these characters.
+    // Larger sets would rule out too few positions to be worth looking for.
+    static constexpr size_t max_first_characters = 4;
+    Vector<char, max_first_characters> first_characters;
+
+    bool is_empty() const { return required_literal.is_empty() && first_characters.is_empty(); }
+    bool can_skip_to_candidates() const { return required_literal_is_prefix || !first_characters.is_empty(); }
+
+    // Returns false if the view can't contain a match that starts at or after `position`.
+    bool may_match(RegexStringView const&, size_t position) const;
+
+    // Returns the first position at or after `position` that a match could start at, if any.
+    // Positions are in code units, so this is only useful for views that aren't matched in unicode mode.
+    Optional<size_t> next_candidate(RegexStringView const&, size_t position) const;
+};
+
+}
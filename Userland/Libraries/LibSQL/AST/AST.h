@@ -765,6 +765,15 @@ public:
     {
         return Result { SQLCommand::Unknown, SQLErrorCode::NotYetImplemented };
     }
+
+    virtual ResultOr<Vector<DeprecatedString>> describe_query_plan(ExecutionContext&) const
+    {
+        return Result { SQLCommand::Explain, SQLErrorCode::NotYetImplemented, "EXPLAIN is only supported for SELECT, UPDATE and DELETE statements"sv };
+    }
+
+    // Statements that can produce their rows one at a time override this. By default, the
+    // statement is executed up front and the rows of its ResultSet are handed out afterwards.
+    virtual ResultOr<OperatorTree> create_operator_tree(ExecutionContext&) const;
 };
 
 class ErrorStatement final : public Statement {
@@ -831,6 +840,33 @@ private:
     bool m_is_error_if_table_exists;
 };
 
+class CreateIndex : public Statement {
+public:
+    CreateIndex(DeprecatedString schema_name, DeprecatedString index_name, DeprecatedString table_name, Vector<DeprecatedString> column_names, bool is_error_if_index_exists)
+        : m_schema_name(move(schema_name))
+        , m_index_name(move(index_name))
+        , m_table_name(move(table_name))
+        , m_column_names(move(column_names))
+        , m_is_error_if_index_exists(is_error_if_index_exists)
+    {
+    }
+
+    DeprecatedString const& schema_name() const { return m_schema_name; }
+    DeprecatedString const& index_name() const { return m_index_name; }
+    DeprecatedString const& table_name() const { return m_table_name; }
+    Vector<DeprecatedString> const& column_names() const { return m_column_names; }
+    bool is_error_if_index_exists() const { return m_is_error_if_index_exists; }
+
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    DeprecatedString m_schema_name;
+    DeprecatedString m_index_name;
+    DeprecatedString m_table_name;
+    Vector<DeprecatedString> m_column_names;
+    bool m_is_error_if_index_exists;
+};
+
 class AlterTable : public Statement {
 public:
     DeprecatedString const& schema_name() const { return m_schema_name; }
@@ -1023,6 +1059,7 @@ public:
     RefPtr<ReturningClause> const& returning_clause() const { return m_returning_clause; }
 
     virtual ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    virtual ResultOr<Vector<DeprecatedString>> describe_query_plan(ExecutionContext&) const override;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1050,6 +1087,7 @@ public:
     RefPtr<ReturningClause> const& returning_clause() const { return m_returning_clause; }
 
     virtual ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    virtual ResultOr<Vector<DeprecatedString>> describe_query_plan(ExecutionContext&) const override;
 
 private:
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
@@ -1081,8 +1119,12 @@ public:
     Vector<NonnullRefPtr<OrderingTerm>> const& ordering_term_list() const { return m_ordering_term_list; }
     RefPtr<LimitClause> const& limit_clause() const { return m_limit_clause; }
     ResultOr<ResultSet> execute(ExecutionContext&) const override;
+    ResultOr<Vector<DeprecatedString>> describe_query_plan(ExecutionContext&) const override;
+    ResultOr<OperatorTree> create_operator_tree(ExecutionContext&) const override;
 
 private:
+    ResultOr<Vector<NonnullRefPtr<TableDef>>> tables(ExecutionContext&) const;
+
     RefPtr<CommonTableExpressionList> m_common_table_expression_list;
     bool m_select_all;
     Vector<NonnullRefPtr<ResultColumn>> m_result_column_list;
@@ -1107,4 +1149,18 @@ private:
     NonnullRefPtr<QualifiedTableName> m_qualified_table_name;
 };
 
+class Explain : public Statement {
+public:
+    explicit Explain(NonnullRefPtr<Statement> statement)
+        : m_statement(move(statement))
+    {
+    }
+
+    NonnullRefPtr<Statement> const& statement() const { return m_statement; }
+    ResultOr<ResultSet> execute(ExecutionContext&) const override;
+
+private:
+    NonnullRefPtr<Statement> m_statement;
+};
+
 }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/Cursor.h>
+#include <LibSQL/Database.h>
+
+namespace SQL::AST {
+
+ResultOr<NonnullOwnPtr<Cursor>> Cursor::open(NonnullRefPtr<Database> database, NonnullRefPtr<Statement const> statement, Vector<Value> placeholder_values)
+{
+    auto cursor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) Cursor(move(database), move(statement), move(placeholder_values))));
+
+    auto operator_tree = TRY(cursor->m_statement->create_operator_tree(cursor->m_context));
+    cursor->m_command = operator_tree.command;
+    cursor->m_column_names = move(operator_tree.column_names);
+    cursor->m_root = move(operator_tree.root);
+
+    return cursor;
+}
+
+Cursor::Cursor(NonnullRefPtr<Database> database, NonnullRefPtr<Statement const> statement, Vector<Value> placeholder_values)
+    : m_statement(move(statement))
+    , m_placeholder_values(move(placeholder_values))
+    , m_context { move(database), m_statement.ptr(), m_placeholder_values.span(), nullptr }
+{
+}
+
+ResultOr<bool> Cursor::has_next()
+{
+    if (!m_next_row.has_value() && !m_is_exhausted) {
+        auto row = TRY(m_root->next(m_context));
+        if (row.has_value())
+            m_next_row = move(row->row);
+        else
+            m_is_exhausted = true;
+    }
+    return m_next_row.has_value();
+}
+
+ResultOr<Optional<Tuple>> Cursor::next()
+{
+    if (!TRY(has_next()))
+        return Optional<Tuple> {};
+
+    ++m_rows_read;
+    return m_next_row.release_value();
+}
+
+ResultOr<Vector<Tuple>> Cursor::next_batch(size_t maximum_rows)
+{
+    Vector<Tuple> rows;
+    while (rows.size() < maximum_rows) {
+        auto row = TRY(next());
+        if (!row.has_value())
+            break;
+        TRY(rows.try_append(row.release_value()));
+    }
+    return rows;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operators.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Result.h>
+#include <LibSQL/Tuple.h>
+#include <LibSQL/Value.h>
+
+namespace SQL::AST {
+
+/**
+ * A Cursor executes a statement and hands out its result rows as they are
+ * produced, instead of collecting all of them in a ResultSet first. It owns
+ * everything the statement needs while it runs, so its rows can be read a
+ * batch at a time, across turns of the event loop.
+ */
+class Cursor {
+    AK_MAKE_NONCOPYABLE(Cursor);
+    AK_MAKE_NONMOVABLE(Cursor);
+
+public:
+    static ResultOr<NonnullOwnPtr<Cursor>> open(NonnullRefPtr<Database>, NonnullRefPtr<Statement const>, Vector<Value> placeholder_values = {});
+
+    SQLCommand command() const { return m_command; }
+    Vector<DeprecatedString> const& column_names() const { return m_column_names; }
+    size_t rows_read() const { return m_rows_read; }
+    bool is_exhausted() const { return m_is_exhausted; }
+
+    ResultOr<bool> has_next();
+    ResultOr<Optional<Tuple>> next();
+    ResultOr<Vector<Tuple>> next_batch(size_t maximum_rows);
+
+private:
+    Cursor(NonnullRefPtr<Database>, NonnullRefPtr<Statement const>, Vector<Value> placeholder_values);
+
+    NonnullRefPtr<Statement const> m_statement;
+    Vector<Value> m_placeholder_values;
+    ExecutionContext m_context;
+
+    SQLCommand m_command { SQLCommand::Unknown };
+    Vector<DeprecatedString> m_column_names;
+    OwnPtr<Operator> m_root;
+
+    Optional<Tuple> m_next_row;
+    size_t m_rows_read { 0 };
+    bool m_is_exhausted { false };
+};
+
+}
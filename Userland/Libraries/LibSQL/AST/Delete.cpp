@@ -5,12 +5,20 @@
  */
 
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/QueryPlan.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
 
 namespace SQL::AST {
 
+ResultOr<Vector<DeprecatedString>> Delete::describe_query_plan(ExecutionContext& context) const
+{
+    auto table_def = TRY(context.database->get_table(m_qualified_table_name->schema_name(), m_qualified_table_name->table_name()));
+    auto plan = TRY(QueryPlan::create(context, { table_def }, where_clause()));
+    return plan.explain();
+}
+
 ResultOr<ResultSet> Delete::execute(ExecutionContext& context) const
 {
     auto const& schema_name = m_qualified_table_name->schema_name();
@@ -19,14 +27,10 @@ ResultOr<ResultSet> Delete::execute(ExecutionContext& context) const
 
     ResultSet result { SQLCommand::Delete };
 
-    for (auto& table_row : TRY(context.database->select_all(*table_def))) {
-        context.current_row = &table_row;
-
-        if (auto const& where_clause = this->where_clause()) {
-            auto where_result = TRY(where_clause->evaluate(context)).to_bool();
-            if (!where_result.has_value() || !where_result.value())
-                continue;
-        }
+    auto plan = TRY(QueryPlan::create(context, { table_def }, where_clause()));
+    for (auto& table_row : TRY(plan.table_accesses().first().fetch_rows(context))) {
+        if (!TRY(plan.matches_remaining_conditions(context, table_row)))
+            continue;
 
         TRY(context.database->remove(table_row));
 
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/AST/Operators.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+ResultOr<Optional<ResultRow>> ResultSetOperator::next(ExecutionContext&)
+{
+    if (m_next_row >= m_result.size())
+        return Optional<ResultRow> {};
+    return move(m_result[m_next_row++]);
+}
+
+ResultOr<Optional<ResultRow>> SingleRowOperator::next(ExecutionContext&)
+{
+    if (m_is_done)
+        return Optional<ResultRow> {};
+
+    m_is_done = true;
+    return ResultRow {};
+}
+
+ResultOr<Optional<ResultRow>> TableScanOperator::next(ExecutionContext& context)
+{
+    if (!m_cursor)
+        m_cursor = TRY(m_table_access.open_cursor(context));
+
+    for (auto row = m_cursor->next(); row.has_value(); row = m_cursor->next()) {
+        if (TRY(m_table_access.matches_filter(context, *row)))
+            return ResultRow { row.release_value(), {} };
+    }
+    return Optional<ResultRow> {};
+}
+
+ResultOr<Optional<ResultRow>> CartesianProductOperator::next(ExecutionContext& context)
+{
+    if (!m_inner_rows.has_value())
+        m_inner_rows = TRY(m_inner.fetch_rows(context));
+
+    while (!m_outer_row.has_value() || m_next_inner_row >= m_inner_rows->size()) {
+        if (m_inner_rows->is_empty())
+            return Optional<ResultRow> {};
+
+        auto outer_row = TRY(m_outer->next(context));
+        if (!outer_row.has_value())
+            return Optional<ResultRow> {};
+
+        m_outer_row = move(outer_row->row);
+        m_next_inner_row = 0;
+    }
+
+    auto const& inner_row = (*m_inner_rows)[m_next_inner_row++];
+    if (!m_descriptor) {
+        m_descriptor = adopt_ref(*new TupleDescriptor);
+        m_descriptor->extend(*m_outer_row->descriptor());
+        m_descriptor->extend(*inner_row.descriptor());
+    }
+
+    Tuple row(*m_descriptor);
+    for (size_t ix = 0; ix < m_outer_row->size(); ++ix)
+        row[ix] = (*m_outer_row)[ix];
+    for (size_t ix = 0; ix < inner_row.size(); ++ix)
+        row[m_outer_row->size() + ix] = inner_row[ix];
+    return ResultRow { move(row), {} };
+}
+
+ResultOr<Optional<ResultRow>> FilterOperator::next(ExecutionContext& context)
+{
+    while (true) {
+        auto row = TRY(m_input->next(context));
+        if (!row.has_value() || TRY(m_plan.matches_remaining_conditions(context, row->row)))
+            return row;
+    }
+}
+
+ProjectOperator::ProjectOperator(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<ResultColumn const>> columns, Vector<NonnullRefPtr<OrderingTerm>> ordering_terms)
+    : m_input(move(input))
+    , m_columns(move(columns))
+    , m_ordering_terms(move(ordering_terms))
+    , m_row_descriptor(adopt_ref(*new TupleDescriptor))
+    , m_sort_descriptor(adopt_ref(*new TupleDescriptor))
+{
+    for (auto const& term : m_ordering_terms)
+        m_sort_descriptor->append(TupleElementDescriptor { .order = term->order() });
+}
+
+ResultOr<Optional<ResultRow>> ProjectOperator::next(ExecutionContext& context)
+{
+    auto input_row = TRY(m_input->next(context));
+    if (!input_row.has_value())
+        return Optional<ResultRow> {};
+
+    context.current_row = &input_row->row;
+
+    // The descriptor of the result rows is filled in from the values of the first row.
+    Tuple row(m_row_descriptor);
+    row.clear();
+    for (auto const& column : m_columns)
+        row.append(TRY(column->expression()->evaluate(context)));
+
+    Tuple sort_key(m_sort_descriptor);
+    sort_key.clear();
+    for (auto const& term : m_ordering_terms)
+        sort_key.append(TRY(term->expression()->evaluate(context)));
+
+    context.current_row = nullptr;
+    return ResultRow { move(row), move(sort_key) };
+}
+
+ResultOr<Optional<ResultRow>> SortOperator::next(ExecutionContext& context)
+{
+    if (!m_is_sorted) {
+        for (auto row = TRY(m_input->next(context)); row.has_value(); row = TRY(m_input->next(context))) {
+            m_rows.insert_row(row->row, row->sort_key);
+            if (m_maximum_rows.has_value() && m_rows.size() > *m_maximum_rows)
+                m_rows.take_last();
+        }
+        m_is_sorted = true;
+    }
+
+    if (m_next_row >= m_rows.size())
+        return Optional<ResultRow> {};
+    return move(m_rows[m_next_row++]);
+}
+
+ResultOr<Optional<ResultRow>> LimitOperator::next(ExecutionContext& context)
+{
+    for (; m_offset > 0; --m_offset) {
+        if (!TRY(m_input->next(context)).has_value())
+            return Optional<ResultRow> {};
+    }
+
+    if (m_rows_produced >= m_limit)
+        return Optional<ResultRow> {};
+
+    auto row = TRY(m_input->next(context));
+    if (row.has_value())
+        ++m_rows_produced;
+    return row;
+}
+
+}
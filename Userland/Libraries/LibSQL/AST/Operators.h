@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/ResultSet.h>
+#include <LibSQL/RowCursor.h>
+
+namespace SQL::AST {
+
+/**
+ * Operators produce the result rows of a statement one at a time. Each one
+ * pulls rows from the operator below it only when it needs them, so a query
+ * does no more work than it takes to produce the rows that are read. The
+ * exception is sorting, since the first sorted row isn't known until all of
+ * the rows are.
+ */
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns the next row, or an empty Optional once all rows have been produced.
+    virtual ResultOr<Optional<ResultRow>> next(ExecutionContext&) = 0;
+};
+
+struct OperatorTree {
+    SQLCommand command { SQLCommand::Unknown };
+    Vector<DeprecatedString> column_names;
+    NonnullOwnPtr<Operator> root;
+};
+
+// Produces the rows of a ResultSet that was computed up front.
+class ResultSetOperator final : public Operator {
+public:
+    explicit ResultSetOperator(ResultSet result)
+        : m_result(move(result))
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    ResultSet m_result;
+    size_t m_next_row { 0 };
+};
+
+// Produces a single row without any columns, the source of a SELECT without a FROM clause.
+class SingleRowOperator final : public Operator {
+public:
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    bool m_is_done { false };
+};
+
+// Reads the rows of a table the way the query plan chose, and keeps those that match the conditions pushed down to it.
+class TableScanOperator final : public Operator {
+public:
+    explicit TableScanOperator(QueryPlan::TableAccess table_access)
+        : m_table_access(move(table_access))
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    QueryPlan::TableAccess m_table_access;
+    OwnPtr<RowCursor> m_cursor;
+};
+
+// Combines every row of the outer operator with every row of the inner table. The
+// outer rows are streamed, the rows of the inner table are read once and kept.
+class CartesianProductOperator final : public Operator {
+public:
+    CartesianProductOperator(NonnullOwnPtr<Operator> outer, QueryPlan::TableAccess inner)
+        : m_outer(move(outer))
+        , m_inner(move(inner))
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_outer;
+    QueryPlan::TableAccess m_inner;
+    Optional<Vector<Row>> m_inner_rows;
+    Optional<Tuple> m_outer_row;
+    size_t m_next_inner_row { 0 };
+    RefPtr<TupleDescriptor> m_descriptor;
+};
+
+// Keeps the rows that match the conditions the query plan couldn't push down to a single table.
+class FilterOperator final : public Operator {
+public:
+    FilterOperator(NonnullOwnPtr<Operator> input, QueryPlan plan)
+        : m_input(move(input))
+        , m_plan(move(plan))
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    QueryPlan m_plan;
+};
+
+// Evaluates the result columns, and the sort key if there is an ORDER BY clause, for every row.
+class ProjectOperator final : public Operator {
+public:
+    ProjectOperator(NonnullOwnPtr<Operator> input, Vector<NonnullRefPtr<ResultColumn const>> columns, Vector<NonnullRefPtr<OrderingTerm>> ordering_terms);
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    Vector<NonnullRefPtr<ResultColumn const>> m_columns;
+    Vector<NonnullRefPtr<OrderingTerm>> m_ordering_terms;
+    NonnullRefPtr<TupleDescriptor> m_row_descriptor;
+    NonnullRefPtr<TupleDescriptor> m_sort_descriptor;
+};
+
+// Reads all rows and produces them in the order of their sort keys. When only the
+// first rows are wanted, the others are dropped as soon as they fall out of that range.
+class SortOperator final : public Operator {
+public:
+    SortOperator(NonnullOwnPtr<Operator> input, Optional<size_t> maximum_rows)
+        : m_input(move(input))
+        , m_rows(SQLCommand::Select)
+        , m_maximum_rows(maximum_rows)
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    ResultSet m_rows;
+    Optional<size_t> m_maximum_rows;
+    bool m_is_sorted { false };
+    size_t m_next_row { 0 };
+};
+
+// Skips the first `offset` rows and stops reading its input after `limit` rows.
+class LimitOperator final : public Operator {
+public:
+    LimitOperator(NonnullOwnPtr<Operator> input, size_t offset, size_t limit)
+        : m_input(move(input))
+        , m_offset(offset)
+        , m_limit(limit)
+    {
+    }
+
+    ResultOr<Optional<ResultRow>> next(ExecutionContext&) override;
+
+private:
+    NonnullOwnPtr<Operator> m_input;
+    size_t m_offset { 0 };
+    size_t m_limit { 0 };
+    size_t m_rows_produced { 0 };
+};
+
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/GenericShorthands.h>
+#include <AK/QuickSort.h>
+#include <AK/StdLibExtras.h>
+#include <AK/StringBuilder.h>
+#include <AK/TypeCasts.h>
+#include <LibSQL/AST/QueryPlan.h>
+#include <LibSQL/Meta.h>
+
+namespace SQL::AST {
+
+// We don't keep statistics on the contents of tables, so we fall back on the
+// classic System R guesses for the fraction of rows a condition lets through.
+static constexpr double equality_selectivity = 0.1;
+static constexpr double open_range_selectivity = 1.0 / 3;
+static constexpr double closed_range_selectivity = 0.25;
+
+// Costs are relative to a full scan of the table, which costs 1. Fetching a
+// row through an index is a bit more expensive than reading it during a scan,
+// since the index entries pointing at it have to be read as well.
+static constexpr double full_scan_cost = 1.0;
+static constexpr double index_lookup_cost_factor = 1.2;
+
+static NonnullRefPtr<Expression> unwrap_parentheses(NonnullRefPtr<Expression> expression)
+{
+    // A parenthesized expression is parsed as a chain of one expression.
+    while (is<ChainedExpression>(*expression)) {
+        auto const& chain = static_cast<ChainedExpression const&>(*expression);
+        if (chain.expressions().size() != 1)
+            break;
+        expression = chain.expressions()[0];
+    }
+    return expression;
+}
+
+static void split_into_conditions(NonnullRefPtr<Expression> expression, Vector<NonnullRefPtr<Expression>>& conditions)
+{
+    expression = unwrap_parentheses(move(expression));
+    if (is<BinaryOperatorExpression>(*expression)) {
+        auto const& binary_expression = static_cast<BinaryOperatorExpression const&>(*expression);
+        if (binary_expression.type() == BinaryOperator::And) {
+            split_into_conditions(binary_expression.lhs(), conditions);
+            split_into_conditions(binary_expression.rhs(), conditions);
+            return;
+        }
+    }
+    conditions.append(move(expression));
+}
+
+// Collects the columns an expression refers to. Returns false for expressions
+// we can't look into, like sub-selects, which are never pushed down.
+static bool collect_column_references(Expression const& expression, Vector<ColumnNameExpression const*>& columns)
+{
+    if (is<NumericLiteral>(expression) || is<StringLiteral>(expression) || is<BlobLiteral>(expression)
+        || is<BooleanLiteral>(expression) || is<NullLiteral>(expression) || is<Placeholder>(expression))
+        return true;
+
+    if (is<ColumnNameExpression>(expression)) {
+        columns.append(static_cast<ColumnNameExpression const*>(&expression));
+        return true;
+    }
+
+    if (is<ChainedExpression>(expression)) {
+        for (auto const& element : static_cast<ChainedExpression const&>(expression).expressions()) {
+            if (!collect_column_references(element, columns))
+                return false;
+        }
+        return true;
+    }
+
+    if (is<InSelectionExpression>(expression) || is<InTableExpression>(expression))
+        return false;
+
+    if (is<InChainedExpression>(expression)) {
+        auto const& in_expression = static_cast<InChainedExpression const&>(expression);
+        return collect_column_references(in_expression.expression(), columns)
+            && collect_column_references(in_expression.expression_chain(), columns);
+    }
+
+    if (is<BetweenExpression>(expression)) {
+        auto const& between_expression = static_cast<BetweenExpression const&>(expression);
+        return collect_column_references(between_expression.expression(), columns)
+            && collect_column_references(between_expression.lhs(), columns)
+            && collect_column_references(between_expression.rhs(), columns);
+    }
+
+    if (is<MatchExpression>(expression)) {
+        auto const& match_expression = static_cast<MatchExpression const&>(expression);
+        if (match_expression.escape() && !collect_column_references(*match_expression.escape(), columns))
+            return false;
+    }
+
+    if (is<NestedExpression>(expression))
+        return collect_column_references(static_cast<NestedExpression const&>(expression).expression(), columns);
+
+    if (is<NestedDoubleExpression>(expression)) {
+        auto const& nested_expression = static_cast<NestedDoubleExpression const&>(expression);
+        return collect_column_references(nested_expression.lhs(), columns)
+            && collect_column_references(nested_expression.rhs(), columns);
+    }
+
+    return false;
+}
+
+static bool has_column(TableDef const& table, DeprecatedString const& column_name)
+{
+    return table.columns().first_matching([&](auto const& column) { return column->name() == column_name; }).has_value();
+}
+
+// Returns the table a condition can be pushed down to, which is the one table
+// all of its columns belong to. Conditions with ambiguous column names are
+// left alone, so that the ambiguity is reported against the combined row.
+static Optional<size_t> table_for_condition(Expression const& condition, Vector<QueryPlan::TableAccess> const& table_accesses)
+{
+    Vector<ColumnNameExpression const*> columns;
+    if (!collect_column_references(condition, columns) || columns.is_empty())
+        return {};
+
+    Optional<size_t> table_index;
+    for (auto const* column : columns) {
+        Optional<size_t> column_table_index;
+        for (size_t ix = 0; ix < table_accesses.size(); ++ix) {
+            auto const& table = table_accesses[ix].table();
+            if (column->table_name().is_empty() ? !has_column(table, column->column_name()) : column->table_name() != table.name())
+                continue;
+            if (column_table_index.has_value())
+                return {};
+            column_table_index = ix;
+        }
+
+        if (!column_table_index.has_value() || (table_index.has_value() && table_index != column_table_index))
+            return {};
+        table_index = column_table_index;
+    }
+    return table_index;
+}
+
+static ResultOr<bool> evaluate_conditions(ExecutionContext& context, Vector<NonnullRefPtr<Expression>> const& conditions)
+{
+    for (auto const& condition : conditions) {
+        auto result = TRY(condition->evaluate(context)).to_bool();
+        if (!result.has_value() || !result.value())
+            return false;
+    }
+    return true;
+}
+
+struct ComparisonWithConstant {
+    DeprecatedString column_name;
+    BinaryOperator op;
+    Value value;
+};
+
+static Optional<ComparisonWithConstant> as_comparison_with_constant(ExecutionContext& context, Expression const& condition)
+{
+    if (!is<BinaryOperatorExpression>(condition))
+        return {};
+    auto const& comparison = static_cast<BinaryOperatorExpression const&>(condition);
+
+    auto op = comparison.type();
+    if (!first_is_one_of(op, BinaryOperator::Equals, BinaryOperator::LessThan, BinaryOperator::LessThanEquals, BinaryOperator::GreaterThan, BinaryOperator::GreaterThanEquals))
+        return {};
+
+    auto column = unwrap_parentheses(comparison.lhs());
+    auto constant = unwrap_parentheses(comparison.rhs());
+    if (!is<ColumnNameExpression>(*column)) {
+        swap(column, constant);
+        switch (op) {
+        case BinaryOperator::LessThan:
+            op = BinaryOperator::GreaterThan;
+            break;
+        case BinaryOperator::LessThanEquals:
+            op = BinaryOperator::GreaterThanEquals;
+            break;
+        case BinaryOperator::GreaterThan:
+            op = BinaryOperator::LessThan;
+            break;
+        case BinaryOperator::GreaterThanEquals:
+            op = BinaryOperator::LessThanEquals;
+            break;
+        default:
+            break;
+        }
+    }
+    if (!is<ColumnNameExpression>(*column))
+        return {};
+
+    Vector<ColumnNameExpression const*> columns;
+    if (!collect_column_references(*constant, columns) || !columns.is_empty())
+        return {};
+
+    // If the constant can't be evaluated, the condition stays a filter and reports the error.
+    auto* current_row = exchange(context.current_row, nullptr);
+    auto value = constant->evaluate(context);
+    context.current_row = current_row;
+    if (value.is_error() || value.value().is_null())
+        return {};
+
+    return ComparisonWithConstant { static_cast<ColumnNameExpression const&>(*column).column_name(), op, value.release_value() };
+}
+
+// Index entries only compare exactly against values of their own type. A float
+// compared with an integer column would be rounded, so that isn't answered by an index.
+static bool can_compare_with_index_key(Value const& value, SQLType column_type)
+{
+    return value.type() == column_type || (column_type == SQLType::Float && value.type() == SQLType::Integer);
+}
+
+ResultOr<QueryPlan> QueryPlan::create(ExecutionContext& context, Vector<NonnullRefPtr<TableDef>> tables, RefPtr<Expression> const& where_clause)
+{
+    QueryPlan plan;
+    TRY(plan.m_table_accesses.try_ensure_capacity(tables.size()));
+    for (auto& table : tables)
+        plan.m_table_accesses.unchecked_append(TableAccess { move(table) });
+
+    Vector<NonnullRefPtr<Expression>> conditions;
+    if (where_clause)
+        split_into_conditions(*where_clause, conditions);
+
+    for (auto& condition : conditions) {
+        if (auto table_index = table_for_condition(condition, plan.m_table_accesses); table_index.has_value())
+            TRY(plan.m_table_accesses[*table_index].m_filter.try_append(move(condition)));
+        else
+            TRY(plan.m_remaining_conditions.try_append(move(condition)));
+    }
+
+    for (auto& table_access : plan.m_table_accesses)
+        plan.choose_index(context, table_access);
+
+    return plan;
+}
+
+void QueryPlan::choose_index(ExecutionContext& context, TableAccess& table_access)
+{
+    Vector<Optional<ComparisonWithConstant>> comparisons;
+    for (auto const& condition : table_access.m_filter)
+        comparisons.append(as_comparison_with_constant(context, condition));
+
+    struct Candidate {
+        NonnullRefPtr<IndexDef> index;
+        IndexRange range;
+        Vector<size_t> answered_conditions;
+        Vector<DeprecatedString> descriptions;
+        double cost { full_scan_cost };
+    };
+    Optional<Candidate> best_candidate;
+
+    for (auto const& index : table_access.table().indexes()) {
+        Candidate candidate { index, {}, {}, {}, full_scan_cost };
+        Vector<Value> equal_values;
+        Optional<size_t> lower_bound;
+        Optional<size_t> upper_bound;
+        double selectivity = 1.0;
+
+        // Equality conditions can be used on a prefix of the key, followed by a range on the next key part.
+        for (auto const& part : index->key_definition()) {
+            auto is_usable = [&](size_t ix) {
+                return comparisons[ix].has_value() && comparisons[ix]->column_name == part->name() && can_compare_with_index_key(comparisons[ix]->value, part->type());
+            };
+
+            Optional<size_t> equality;
+            for (size_t ix = 0; ix < comparisons.size() && !equality.has_value(); ++ix) {
+                if (is_usable(ix) && comparisons[ix]->op == BinaryOperator::Equals)
+                    equality = ix;
+            }
+            if (equality.has_value()) {
+                equal_values.append(comparisons[*equality]->value);
+                candidate.answered_conditions.append(*equality);
+                candidate.descriptions.append(DeprecatedString::formatted("{}=?", part->name()));
+                selectivity *= equality_selectivity;
+                continue;
+            }
+
+            for (size_t ix = 0; ix < comparisons.size(); ++ix) {
+                if (!is_usable(ix))
+                    continue;
+                auto const& comparison = *comparisons[ix];
+                auto is_lower_bound = first_is_one_of(comparison.op, BinaryOperator::GreaterThan, BinaryOperator::GreaterThanEquals);
+                auto& bound = is_lower_bound ? lower_bound : upper_bound;
+
+                // Of several bounds on the same side, only the tightest one matters.
+                if (bound.has_value()) {
+                    auto difference = comparison.value.compare(comparisons[*bound]->value);
+                    if (is_lower_bound ? difference < 0 : difference > 0)
+                        continue;
+                    if (difference == 0 && first_is_one_of(comparison.op, BinaryOperator::GreaterThanEquals, BinaryOperator::LessThanEquals))
+                        continue;
+                }
+                bound = ix;
+                candidate.answered_conditions.append(ix);
+            }
+            for (auto bound : { lower_bound, upper_bound }) {
+                if (bound.has_value())
+                    candidate.descriptions.append(DeprecatedString::formatted("{}{}?", part->name(), BinaryOperator_name(comparisons[*bound]->op)));
+            }
+            if (lower_bound.has_value() && upper_bound.has_value())
+                selectivity *= closed_range_selectivity;
+            else if (lower_bound.has_value() || upper_bound.has_value())
+                selectivity *= open_range_selectivity;
+            break;
+        }
+
+        if (candidate.answered_conditions.is_empty())
+            continue;
+
+        auto make_key = [&](Optional<size_t> const& bound) {
+            Key key(context.database->index_key_descriptor(index, equal_values.size() + (bound.has_value() ? 1 : 0)));
+            for (size_t ix = 0; ix < equal_values.size(); ++ix)
+                key[ix] = equal_values[ix];
+            if (bound.has_value())
+                key[equal_values.size()] = comparisons[*bound]->value;
+            return key;
+        };
+        if (lower_bound.has_value() || !equal_values.is_empty()) {
+            candidate.range.lower = make_key(lower_bound);
+            candidate.range.lower_inclusive = !lower_bound.has_value() || comparisons[*lower_bound]->op == BinaryOperator::GreaterThanEquals;
+        }
+        if (upper_bound.has_value() || !equal_values.is_empty()) {
+            candidate.range.upper = make_key(upper_bound);
+            candidate.range.upper_inclusive = !upper_bound.has_value() || comparisons[*upper_bound]->op == BinaryOperator::LessThanEquals;
+        }
+
+        candidate.cost = selectivity * index_lookup_cost_factor;
+        if (!best_candidate.has_value() || candidate.cost < best_candidate->cost)
+            best_candidate = move(candidate);
+    }
+
+    if (!best_candidate.has_value() || best_candidate->cost >= full_scan_cost)
+        return;
+
+    dbgln_if(SQL_DEBUG, "Using index {} on {} with estimated cost {}", best_candidate->index->name(), table_access.table().name(), best_candidate->cost);
+    table_access.m_index = best_candidate->index;
+    table_access.m_range = move(best_candidate->range);
+    table_access.m_index_conditions = move(best_candidate->descriptions);
+    table_access.m_estimated_cost = best_candidate->cost;
+
+    // The index answers these conditions exactly, so they don't have to be checked again.
+    auto& answered_conditions = best_candidate->answered_conditions;
+    quick_sort(answered_conditions, [](auto a, auto b) { return a > b; });
+    for (auto ix : answered_conditions)
+        table_access.m_filter.remove(ix);
+}
+
+ResultOr<NonnullOwnPtr<RowCursor>> QueryPlan::TableAccess::open_cursor(ExecutionContext& context) const
+{
+    if (m_index)
+        return TRY(context.database->open_cursor(*m_table, *m_index, m_range));
+    return TRY(context.database->open_cursor(*m_table));
+}
+
+ResultOr<bool> QueryPlan::TableAccess::matches_filter(ExecutionContext& context, Row& row) const
+{
+    if (m_filter.is_empty())
+        return true;
+
+    context.current_row = &row;
+    return evaluate_conditions(context, m_filter);
+}
+
+ResultOr<Vector<Row>> QueryPlan::TableAccess::fetch_rows(ExecutionContext& context) const
+{
+    auto cursor = TRY(open_cursor(context));
+
+    Vector<Row> rows;
+    for (auto row = cursor->next(); row.has_value(); row = cursor->next()) {
+        if (TRY(matches_filter(context, *row)))
+            TRY(rows.try_append(row.release_value()));
+    }
+    return rows;
+}
+
+DeprecatedString QueryPlan::TableAccess::to_deprecated_string() const
+{
+    auto table_name = DeprecatedString::formatted("{}.{}", m_table->parent()->name(), m_table->name());
+    if (!m_index)
+        return DeprecatedString::formatted("SCAN {}", table_name);
+
+    StringBuilder builder;
+    builder.join(" AND "sv, m_index_conditions);
+    return DeprecatedString::formatted("SEARCH {} USING INDEX {} ({})", table_name, m_index->name(), builder.string_view());
+}
+
+ResultOr<bool> QueryPlan::matches_remaining_conditions(ExecutionContext& context, Tuple& row) const
+{
+    context.current_row = &row;
+    return evaluate_conditions(context, m_remaining_conditions);
+}
+
+Vector<DeprecatedString> QueryPlan::explain() const
+{
+    Vector<DeprecatedString> lines;
+    for (auto const& table_access : m_table_accesses)
+        lines.append(table_access.to_deprecated_string());
+    return lines;
+}
+
+}
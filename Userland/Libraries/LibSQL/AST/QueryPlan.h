@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/DeprecatedString.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/RefPtr.h>
+#include <AK/Vector.h>
+#include <LibSQL/AST/AST.h>
+#include <LibSQL/Database.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Row.h>
+
+namespace SQL::AST {
+
+/**
+ * A QueryPlan decides how the rows a statement works on are fetched. The
+ * WHERE clause is split into its AND-ed conditions. Every condition that
+ * only refers to the columns of one table is pushed down to that table,
+ * and is checked as soon as the table's rows are read. Conditions
+ * comparing an indexed column with a constant can be answered by one of
+ * the table's indexes, which turns the table scan into a point lookup or
+ * a range scan. Whatever is left is checked against the combined rows of
+ * all tables.
+ */
+class QueryPlan {
+public:
+    class TableAccess {
+    public:
+        TableDef& table() const { return *m_table; }
+        RefPtr<IndexDef> const& index() const { return m_index; }
+        double estimated_cost() const { return m_estimated_cost; }
+
+        ResultOr<NonnullOwnPtr<RowCursor>> open_cursor(ExecutionContext&) const;
+        ResultOr<bool> matches_filter(ExecutionContext&, Row&) const;
+        ResultOr<Vector<Row>> fetch_rows(ExecutionContext&) const;
+        DeprecatedString to_deprecated_string() const;
+
+    private:
+        friend QueryPlan;
+
+        explicit TableAccess(NonnullRefPtr<TableDef> table)
+            : m_table(move(table))
+        {
+        }
+
+        NonnullRefPtr<TableDef> m_table;
+        RefPtr<IndexDef> m_index;
+        IndexRange m_range;
+        Vector<DeprecatedString> m_index_conditions;
+        Vector<NonnullRefPtr<Expression>> m_filter;
+        double m_estimated_cost { 1.0 };
+    };
+
+    static ResultOr<QueryPlan> create(ExecutionContext&, Vector<NonnullRefPtr<TableDef>> tables, RefPtr<Expression> const& where_clause);
+
+    Vector<TableAccess> const& table_accesses() const { return m_table_accesses; }
+    ResultOr<bool> matches_remaining_conditions(ExecutionContext&, Tuple&) const;
+    Vector<DeprecatedString> explain() const;
+
+private:
+    QueryPlan() = default;
+
+    void choose_index(ExecutionContext&, TableAccess&);
+
+    Vector<TableAccess> m_table_accesses;
+    Vector<NonnullRefPtr<Expression>> m_remaining_conditions;
+};
+
+}
@@ -6,6 +6,8 @@
 
 #include <AK/NumericLimits.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operators.h>
+#include <LibSQL/AST/QueryPlan.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
@@ -37,7 +39,28 @@ static DeprecatedString result_column_name(ResultColumn const& column, size_t co
     return fallback_column_name();
 }
 
-ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+ResultOr<Vector<NonnullRefPtr<TableDef>>> Select::tables(ExecutionContext& context) const
+{
+    Vector<NonnullRefPtr<TableDef>> tables;
+    TRY(tables.try_ensure_capacity(table_or_subquery_list().size()));
+
+    for (auto& table_descriptor : table_or_subquery_list()) {
+        if (!table_descriptor->is_table())
+            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
+
+        tables.unchecked_append(TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name())));
+    }
+
+    return tables;
+}
+
+ResultOr<Vector<DeprecatedString>> Select::describe_query_plan(ExecutionContext& context) const
+{
+    auto plan = TRY(QueryPlan::create(context, TRY(tables(context)), where_clause()));
+    return plan.explain();
+}
+
+ResultOr<OperatorTree> Select::create_operator_tree(ExecutionContext& context) const
 {
     Vector<NonnullRefPtr<ResultColumn const>> columns;
     Vector<DeprecatedString> column_names;
@@ -45,12 +68,9 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
     auto const& result_column_list = this->result_column_list();
     VERIFY(!result_column_list.is_empty());
 
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor->is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
-        auto table_def = TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name()));
+    auto tables = TRY(this->tables(context));
 
+    for (auto& table_def : tables) {
         if (result_column_list.size() == 1 && result_column_list[0]->type() == ResultType::All) {
             TRY(columns.try_ensure_capacity(columns.size() + table_def->columns().size()));
             TRY(column_names.try_ensure_capacity(column_names.size() + table_def->columns().size()));
@@ -83,84 +103,15 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
         }
     }
 
-    ResultSet result { SQLCommand::Select, move(column_names) };
-
-    auto descriptor = adopt_ref(*new TupleDescriptor);
-    Tuple tuple(descriptor);
-    Vector<Tuple> rows;
-    descriptor->empend("__unity__"sv);
-    tuple.append(Value { true });
-    rows.append(tuple);
-
-    for (auto& table_descriptor : table_or_subquery_list()) {
-        if (!table_descriptor->is_table())
-            return Result { SQLCommand::Select, SQLErrorCode::NotYetImplemented, "Sub-selects are not yet implemented"sv };
-
-        auto table_def = TRY(context.database->get_table(table_descriptor->schema_name(), table_descriptor->table_name()));
-        if (table_def->num_columns() == 0)
-            continue;
-
-        auto old_descriptor_size = descriptor->size();
-        descriptor->extend(table_def->to_tuple_descriptor());
-
-        while (!rows.is_empty() && (rows.first().size() == old_descriptor_size)) {
-            auto cartesian_row = rows.take_first();
-            auto table_rows = TRY(context.database->select_all(*table_def));
-
-            for (auto& table_row : table_rows) {
-                auto new_row = cartesian_row;
-                new_row.extend(table_row);
-                rows.append(new_row);
-            }
-        }
-    }
-
-    bool has_ordering { false };
-    auto sort_descriptor = adopt_ref(*new TupleDescriptor);
-    for (auto& term : m_ordering_term_list) {
-        sort_descriptor->append(TupleElementDescriptor { .order = term->order() });
-        has_ordering = true;
-    }
-    Tuple sort_key(sort_descriptor);
-
-    for (auto& row : rows) {
-        context.current_row = &row;
-
-        if (where_clause()) {
-            auto where_result = TRY(where_clause()->evaluate(context)).to_bool();
-            if (!where_result.has_value() || !where_result.value())
-                continue;
-        }
-
-        tuple.clear();
-
-        for (auto& col : columns) {
-            auto value = TRY(col->expression()->evaluate(context));
-            tuple.append(value);
-        }
-
-        if (has_ordering) {
-            sort_key.clear();
-            for (auto& term : m_ordering_term_list) {
-                auto value = TRY(term->expression()->evaluate(context));
-                sort_key.append(value);
-            }
-        }
-
-        result.insert_row(tuple, sort_key);
-    }
+    Optional<size_t> limit_value;
+    size_t offset_value = 0;
 
     if (m_limit_clause != nullptr) {
-        size_t limit_value = NumericLimits<size_t>::max();
-        size_t offset_value = 0;
-
         auto limit = TRY(m_limit_clause->limit_expression()->evaluate(context));
         if (!limit.is_null()) {
-            auto limit_value_maybe = limit.to_int<size_t>();
-            if (!limit_value_maybe.has_value())
+            limit_value = limit.to_int<size_t>();
+            if (!limit_value.has_value())
                 return Result { SQLCommand::Select, SQLErrorCode::SyntaxError, "LIMIT clause must evaluate to an integer value"sv };
-
-            limit_value = limit_value_maybe.value();
         }
 
         if (m_limit_clause->offset_expression() != nullptr) {
@@ -173,10 +124,49 @@ ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
                 offset_value = offset_value_maybe.value();
             }
         }
+    }
+
+    // Conditions on a single table are checked while its rows are read, before they take part in the Cartesian product.
+    auto plan = TRY(QueryPlan::create(context, move(tables), where_clause()));
 
-        result.limit(offset_value, limit_value);
+    OwnPtr<Operator> root;
+    for (auto const& table_access : plan.table_accesses()) {
+        if (table_access.table().num_columns() == 0)
+            continue;
+
+        if (!root)
+            root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) TableScanOperator(table_access)));
+        else
+            root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) CartesianProductOperator(root.release_nonnull(), table_access)));
+    }
+    if (!root)
+        root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SingleRowOperator));
+
+    root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) FilterOperator(root.release_nonnull(), move(plan))));
+    root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ProjectOperator(root.release_nonnull(), move(columns), m_ordering_term_list)));
+
+    // Only the rows up to the end of the LIMIT have to be kept while sorting.
+    if (!m_ordering_term_list.is_empty()) {
+        Optional<size_t> maximum_rows;
+        if (limit_value.has_value())
+            maximum_rows = offset_value + *limit_value;
+        root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) SortOperator(root.release_nonnull(), maximum_rows)));
     }
 
+    if (limit_value.has_value() || offset_value > 0)
+        root = TRY(adopt_nonnull_own_or_enomem(new (nothrow) LimitOperator(root.release_nonnull(), offset_value, limit_value.value_or(NumericLimits<size_t>::max()))));
+
+    return OperatorTree { SQLCommand::Select, move(column_names), root.release_nonnull() };
+}
+
+ResultOr<ResultSet> Select::execute(ExecutionContext& context) const
+{
+    auto operator_tree = TRY(create_operator_tree(context));
+    ResultSet result { operator_tree.command, move(operator_tree.column_names) };
+
+    for (auto row = TRY(operator_tree.root->next(context)); row.has_value(); row = TRY(operator_tree.root->next(context)))
+        TRY(result.try_append(row.release_value()));
+
     return result;
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Operators.h>
 #include <LibSQL/Database.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Row.h>
@@ -22,4 +23,14 @@ ResultOr<ResultSet> Statement::execute(AK::NonnullRefPtr<Database> database, Rea
     return result;
 }
 
+ResultOr<OperatorTree> Statement::create_operator_tree(ExecutionContext& context) const
+{
+    auto result = TRY(execute(context));
+    TRY(context.database->commit());
+
+    auto command = result.command();
+    auto column_names = result.column_names();
+    return OperatorTree { command, move(column_names), TRY(adopt_nonnull_own_or_enomem(new (nothrow) ResultSetOperator(move(result)))) };
+}
+
 }
@@ -98,6 +98,27 @@ BTreeIterator BTree::find(Key const& key)
     return end();
 }
 
+BTreeIterator BTree::lower_bound(Key const& key)
+{
+    if (!m_root)
+        initialize_root();
+
+    // Keys in a node's left subtree sort before the node's key itself, so the deepest
+    // candidate we pass on the way down is the first key that is not less than `key`.
+    auto candidate = end();
+    for (auto* node = m_root.ptr(); node && node->size() > 0;) {
+        auto ix = 0u;
+        while (ix < node->size() && (*node)[ix] < key)
+            ix++;
+        if (ix < node->size())
+            candidate = BTreeIterator(node, (int)ix);
+        if (node->is_leaf())
+            break;
+        node = node->down_node(ix);
+    }
+    return candidate;
+}
+
 void BTree::list_tree()
 {
     if (!m_root)
@@ -15,8 +15,8 @@
 
 namespace SQL {
 
-Database::Database(DeprecatedString name)
-    : m_heap(Heap::construct(move(name)))
+Database::Database(DeprecatedString name, u32 block_size)
+    : m_heap(Heap::construct(move(name), block_size))
     , m_serializer(m_heap)
 {
 }
@@ -40,6 +40,11 @@ ResultOr<void> Database::open()
         m_heap->set_table_columns_root(m_table_columns->root());
     };
 
+    m_indexes = BTree::construct(m_serializer, IndexDef::index_def()->to_tuple_descriptor(), m_heap->indexes_root());
+    m_indexes->on_new_root = [&]() {
+        m_heap->set_indexes_root(m_indexes->root());
+    };
+
     m_open = true;
 
     auto ensure_schema_exists = [&](auto schema_name) -> ResultOr<NonnullRefPtr<SchemaDef>> {
@@ -165,15 +170,144 @@ ResultOr<NonnullRefPtr<TableDef>> Database::get_table(DeprecatedString const& sc
     for (auto it = m_table_columns->find(column_key); !it.is_end() && ((*it)["table_hash"].to_int<u32>() == table_hash); ++it)
         table_def->append_column(*it);
 
+    auto index_key = IndexDef::make_key(table_def);
+    for (auto it = m_indexes->find(index_key); !it.is_end() && ((*it)["table_hash"].to_int<u32>() == table_hash); ++it) {
+        auto index_def = IndexDef::construct(table_def.ptr(), (*it)["index_name"].to_deprecated_string(), (*it)["unique"].to_int<u32>() == 1u, (*it).block_index());
+
+        auto index_hash = index_def->hash();
+        auto part_key = ColumnDef::make_key(index_def);
+        for (auto part_it = m_table_columns->find(part_key); !part_it.is_end() && ((*part_it)["table_hash"].to_int<u32>() == index_hash); ++part_it)
+            index_def->append_column(*part_it);
+
+        table_def->append_index(index_def);
+    }
+
     return table_def;
 }
 
-ErrorOr<Vector<Row>> Database::select_all(TableDef& table)
+ResultOr<void> Database::add_index(IndexDef& index)
 {
+    VERIFY(is_open());
+    auto& table = verify_cast<TableDef>(*index.parent());
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
+
+    if (!m_indexes->insert(index.key()))
+        return Result { SQLCommand::Unknown, SQLErrorCode::IndexExists, index.name() };
+
+    for (auto& part : index.key_definition()) {
+        if (!m_table_columns->insert(part->key()))
+            VERIFY_NOT_REACHED();
+    }
+
+    table.append_index(index);
+
+    auto tree = index_tree(index);
+    for (auto& row : TRY(select_all(table))) {
+        if (auto key = make_index_key(tree, index, row); key.has_value())
+            tree->insert(key.release_value());
+    }
+
+    return {};
+}
+
+NonnullRefPtr<TupleDescriptor> Database::index_key_descriptor(IndexDef const& index, size_t key_parts)
+{
+    VERIFY(key_parts <= index.size());
+    auto descriptor = index.to_tuple_descriptor();
+    descriptor->shrink(key_parts);
+    return descriptor;
+}
+
+NonnullRefPtr<BTree> Database::index_tree(IndexDef& index)
+{
+    auto index_hash = index.hash();
+    if (auto it = m_index_trees.find(index_hash); it != m_index_trees.end())
+        return it->value;
+
+    // Rows with equal key values are told apart by their block index, which is
+    // the last part of every entry. This keeps all entries unique, so a single
+    // row's entry can be found again when the row changes or goes away.
+    auto descriptor = index.to_tuple_descriptor();
+    descriptor->append({ "", "", "block_index", SQLType::Integer, Order::Ascending });
+
+    auto tree = BTree::construct(m_serializer, descriptor, index.block_index());
+    tree->on_new_root = [this, &index, tree = tree.ptr()]() {
+        index.set_block_index(tree->root());
+        VERIFY(m_indexes->update_key_pointer(index.key()));
+    };
+    m_index_trees.set(index_hash, tree);
+    return tree;
+}
+
+Optional<Key> Database::make_index_key(BTree const& tree, IndexDef const& index, Row const& row) const
+{
+    Key key(tree.descriptor());
+    for (size_t ix = 0; ix < index.size(); ++ix) {
+        auto const& value = row[index.key_definition()[ix]->name()];
+        // NULLs don't have a place in the sort order, and never satisfy the
+        // comparisons an index is used for. Such rows are left out.
+        if (value.is_null())
+            return {};
+        key[ix] = value;
+    }
+    key[index.size()] = row.block_index();
+    key.set_block_index(row.block_index());
+    return key;
+}
+
+void Database::update_index_entries(TableDef& table, Row const* old_row, Row const* new_row)
+{
+    for (auto& index : table.indexes()) {
+        auto tree = index_tree(index);
+        auto old_key = old_row ? make_index_key(tree, index, *old_row) : Optional<Key> {};
+        auto new_key = new_row ? make_index_key(tree, index, *new_row) : Optional<Key> {};
+        if (old_key.has_value() && new_key.has_value() && *old_key == *new_key)
+            continue;
+
+        // The B-Tree can't delete keys, so a stale entry is kept with a null pointer instead.
+        // Range scans skip such entries, and inserting the same key again revives it.
+        if (old_key.has_value()) {
+            old_key->set_block_index(0);
+            tree->update_key_pointer(*old_key);
+        }
+        if (new_key.has_value() && !tree->update_key_pointer(*new_key)) {
+            tree->insert(*new_key);
+            ++m_index_generation;
+        }
+    }
+}
+
+ErrorOr<NonnullOwnPtr<RowCursor>> Database::open_cursor(TableDef& table)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    auto cursor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) RowCursor(*this, table)));
+    m_open_cursors.append(*cursor);
+    return cursor;
+}
+
+ErrorOr<NonnullOwnPtr<RowCursor>> Database::open_cursor(TableDef& table, IndexDef& index, IndexRange range)
+{
+    VERIFY(m_table_cache.get(table.key().hash()).has_value());
+    auto cursor = TRY(adopt_nonnull_own_or_enomem(new (nothrow) RowCursor(*this, table, index_tree(index), move(range))));
+    m_open_cursors.append(*cursor);
+    return cursor;
+}
+
+ErrorOr<Vector<Row>> Database::select_all(TableDef& table)
+{
+    auto cursor = TRY(open_cursor(table));
+    Vector<Row> ret;
+    for (auto row = cursor->next(); row.has_value(); row = cursor->next())
+        TRY(ret.try_append(row.release_value()));
+    return ret;
+}
+
+ErrorOr<Vector<Row>> Database::select_range(TableDef& table, IndexDef& index, IndexRange const& range)
+{
+    auto cursor = TRY(open_cursor(table, index, range));
     Vector<Row> ret;
-    for (auto block_index = table.block_index(); block_index; block_index = ret.last().next_block_index())
-        ret.append(m_serializer.deserialize_block<Row>(block_index, table, block_index));
+    for (auto row = cursor->next(); row.has_value(); row = cursor->next())
+        TRY(ret.try_append(row.release_value()));
     return ret;
 }
 
@@ -200,9 +334,8 @@ ErrorOr<void> Database::insert(Row& row)
 
     row.set_block_index(m_heap->request_new_block_index());
     row.set_next_block_index(row.table().block_index());
-    TRY(update(row));
-
-    // TODO update indexes defined on table.
+    write_row(row);
+    update_index_entries(row.table(), nullptr, &row);
 
     auto table_key = row.table().key();
     table_key.set_block_index(row.block_index());
@@ -216,6 +349,14 @@ ErrorOr<void> Database::remove(Row& row)
     auto& table = row.table();
     VERIFY(m_table_cache.get(table.key().hash()).has_value());
 
+    // Rows can be removed in any order, so the row may have been read before an
+    // earlier removal relinked the chain around it. Its stored link is the truth.
+    auto stored_row = m_serializer.deserialize_block<Row>(row.block_index(), table, row.block_index());
+    row.set_next_block_index(stored_row.next_block_index());
+
+    update_index_entries(table, &row, nullptr);
+    for (auto& cursor : m_open_cursors)
+        cursor.row_removed(row);
     TRY(m_heap->free_storage(row.block_index()));
 
     if (table.block_index() == row.block_index()) {
@@ -232,7 +373,7 @@ ErrorOr<void> Database::remove(Row& row)
 
         if (current.next_block_index() == row.block_index()) {
             current.set_next_block_index(row.next_block_index());
-            TRY(update(current));
+            write_row(current);
             break;
         }
 
@@ -247,11 +388,33 @@ ErrorOr<void> Database::update(Row& tuple)
     VERIFY(m_table_cache.get(tuple.table().key().hash()).has_value());
     // TODO: implement table constraints such as unique, foreign key, etc.
 
-    m_serializer.reset();
-    m_serializer.serialize_and_write<Tuple>(tuple);
+    if (tuple.table().indexes().is_empty()) {
+        write_row(tuple);
+        return {};
+    }
 
-    // TODO update indexes defined on table.
+    auto old_row = m_serializer.deserialize_block<Row>(tuple.block_index(), tuple.table(), tuple.block_index());
+    write_row(tuple);
+    update_index_entries(tuple.table(), &old_row, &tuple);
     return {};
 }
 
+Row Database::read_row(TableDef& table, Block::Index block_index)
+{
+    auto row = m_serializer.deserialize_block<Row>(block_index, table, block_index);
+
+    // Only the names of the columns are stored with a row, so qualified column names couldn't be resolved against it otherwise.
+    for (auto& element : *row.descriptor()) {
+        element.schema = table.parent()->name();
+        element.table = table.name();
+    }
+    return row;
+}
+
+void Database::write_row(Row& row)
+{
+    m_serializer.reset();
+    m_serializer.serialize_and_write<Tuple>(row);
+}
+
 }
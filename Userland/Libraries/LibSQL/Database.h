@@ -9,12 +9,15 @@
 
 #include <AK/DeprecatedString.h>
 #include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
 #include <AK/RefPtr.h>
 #include <LibCore/Object.h>
 #include <LibSQL/Forward.h>
 #include <LibSQL/Heap.h>
+#include <LibSQL/Key.h>
 #include <LibSQL/Meta.h>
 #include <LibSQL/Result.h>
+#include <LibSQL/RowCursor.h>
 #include <LibSQL/Serializer.h>
 
 namespace SQL {
@@ -34,6 +37,7 @@ public:
     bool is_open() const { return m_open; }
     ErrorOr<void> commit();
     ErrorOr<size_t> file_size_in_bytes() const { return m_heap->file_size_in_bytes(); }
+    Heap& heap() { return *m_heap; }
 
     ResultOr<void> add_schema(SchemaDef const&);
     static Key get_schema_key(DeprecatedString const&);
@@ -43,14 +47,31 @@ public:
     static Key get_table_key(DeprecatedString const&, DeprecatedString const&);
     ResultOr<NonnullRefPtr<TableDef>> get_table(DeprecatedString const&, DeprecatedString const&);
 
+    ResultOr<void> add_index(IndexDef&);
+    NonnullRefPtr<TupleDescriptor> index_key_descriptor(IndexDef const&, size_t key_parts);
+
+    ErrorOr<NonnullOwnPtr<RowCursor>> open_cursor(TableDef&);
+    ErrorOr<NonnullOwnPtr<RowCursor>> open_cursor(TableDef&, IndexDef&, IndexRange);
+
     ErrorOr<Vector<Row>> select_all(TableDef&);
+    ErrorOr<Vector<Row>> select_range(TableDef&, IndexDef&, IndexRange const&);
     ErrorOr<Vector<Row>> match(TableDef&, Key const&);
     ErrorOr<void> insert(Row&);
     ErrorOr<void> remove(Row&);
     ErrorOr<void> update(Row&);
 
 private:
-    explicit Database(DeprecatedString);
+    friend class RowCursor;
+
+    explicit Database(DeprecatedString, u32 block_size = Block::DEFAULT_SIZE);
+
+    Row read_row(TableDef&, Block::Index);
+    u64 index_generation() const { return m_index_generation; }
+
+    NonnullRefPtr<BTree> index_tree(IndexDef&);
+    Optional<Key> make_index_key(BTree const&, IndexDef const&, Row const&) const;
+    void update_index_entries(TableDef&, Row const* old_row, Row const* new_row);
+    void write_row(Row&);
 
     bool m_open { false };
     NonnullRefPtr<Heap> m_heap;
@@ -58,9 +79,16 @@ private:
     RefPtr<BTree> m_schemas;
     RefPtr<BTree> m_tables;
     RefPtr<BTree> m_table_columns;
+    RefPtr<BTree> m_indexes;
 
     HashMap<u32, NonnullRefPtr<SchemaDef>> m_schema_cache;
     HashMap<u32, NonnullRefPtr<TableDef>> m_table_cache;
+    HashMap<u32, NonnullRefPtr<BTree>> m_index_trees;
+
+    RowCursor::List m_open_cursors;
+
+    // Bumped whenever an index gets a new entry, which may reshape its tree under an open cursor.
+    u64 m_index_generation { 0 };
 };
 
 }
@@ -19,12 +19,14 @@ class Heap;
 class Index;
 class IndexNode;
 class IndexDef;
+struct IndexRange;
 class Key;
 class KeyPartDef;
 class Relation;
 class Result;
 class ResultSet;
 class Row;
+class RowCursor;
 class SchemaDef;
 class Serializer;
 class TableDef;
@@ -50,13 +52,16 @@ class ColumnDefinition;
 class ColumnNameExpression;
 class CommonTableExpression;
 class CommonTableExpressionList;
+class CreateIndex;
 class CreateTable;
+class Cursor;
 class Delete;
 class DropColumn;
 class DropTable;
 class ErrorExpression;
 class ErrorStatement;
 class ExistsExpression;
+class Explain;
 class Expression;
 class GroupByClause;
 class InChainedExpression;
@@ -74,9 +79,12 @@ class NestedExpression;
 class NullExpression;
 class NullLiteral;
 class NumericLiteral;
+class Operator;
+struct OperatorTree;
 class OrderingTerm;
 class Parser;
 class QualifiedTableName;
+class QueryPlan;
 class RenameColumn;
 class RenameTable;
 class ResultColumn;
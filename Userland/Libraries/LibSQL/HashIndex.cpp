@@ -132,7 +132,7 @@ bool HashBucket::insert(Key const& key)
         m_hash_index.serializer().deserialize_block_to(block_index(), *this);
     if (find_key_in_bucket(key).has_value())
         return false;
-    if (length() + key.length() > Block::DATA_SIZE) {
+    if (length() + key.length() > m_hash_index.serializer().heap().block_data_size()) {
         dbgln_if(SQL_DEBUG, "Adding key {} would make length exceed block size", key.to_deprecated_string());
         return false;
     }
@@ -245,7 +245,7 @@ HashBucket* HashIndex::get_bucket_for_insert(Key const& key)
     do {
         dbgln_if(SQL_DEBUG, "HashIndex::get_bucket_for_insert({}) bucket {} of {}", key.to_deprecated_string(), key_hash % size(), size());
         auto bucket = get_bucket(key_hash % size());
-        if (bucket->length() + key.length() < Block::DATA_SIZE)
+        if (bucket->length() + key.length() < serializer().heap().block_data_size())
             return bucket;
         dbgln_if(SQL_DEBUG, "Bucket is full (bucket size {}/length {} key length {}). Expanding directory", bucket->size(), bucket->length(), key.length());
 
@@ -284,7 +284,7 @@ HashBucket* HashIndex::get_bucket_for_insert(Key const& key)
             write_directory();
 
             auto bucket_after_redistribution = get_bucket(key_hash % size());
-            if (bucket_after_redistribution->length() + key.length() < Block::DATA_SIZE)
+            if (bucket_after_redistribution->length() + key.length() < serializer().heap().block_data_size())
                 return bucket_after_redistribution;
         }
         expand();
@@ -14,14 +14,16 @@
 
 namespace SQL {
 
-Heap::Heap(DeprecatedString file_name)
+Heap::Heap(DeprecatedString file_name, u32 block_size)
+    : m_block_size(block_size)
 {
+    VERIFY(Block::is_valid_size(block_size));
     set_name(move(file_name));
 }
 
 Heap::~Heap()
 {
-    if (m_file && !m_write_ahead_log.is_empty()) {
+    if (m_file) {
         if (auto maybe_error = flush(); maybe_error.is_error())
             warnln("~Heap({}): {}", name(), maybe_error.error());
     }
@@ -42,14 +44,11 @@ ErrorOr<void> Heap::open()
     } else {
         file_size = stat_buffer.st_size;
     }
-    if (file_size > 0) {
-        m_next_block = file_size / Block::SIZE;
-        m_highest_block_written = m_next_block - 1;
-    }
 
     auto file = TRY(Core::File::open(name(), Core::File::OpenMode::ReadWrite));
     m_file = TRY(Core::InputBufferedFile::create(move(file)));
 
+    auto requested_block_size = m_block_size;
     if (file_size > 0) {
         if (auto error_maybe = read_zero_block(); error_maybe.is_error()) {
             m_file = nullptr;
@@ -63,21 +62,33 @@ ErrorOr<void> Heap::open()
     if (m_version != VERSION) {
         dbgln_if(SQL_DEBUG, "Heap file {} opened has incompatible version {}. Deleting for version {}.", name(), m_version, VERSION);
         m_file = nullptr;
+        m_block_size = requested_block_size;
 
         TRY(Core::System::unlink(name()));
         return open();
     }
 
-    // Perform a heap scan to find all free blocks
+    if (!Block::is_valid_size(m_block_size)) {
+        warnln("{}: Invalid block size {}"sv, name(), m_block_size);
+        m_file = nullptr;
+        return Error::from_string_literal("Heap::open(): Invalid block size");
+    }
+
+    if (file_size > 0) {
+        m_blocks_in_file = file_size / m_block_size;
+        m_next_block = m_blocks_in_file;
+    }
+
+    // Perform a heap scan to find all free blocks. This bypasses the buffer pool, since we only need the block headers.
     // FIXME: this is very inefficient; store free blocks in a persistent heap structure
-    for (Block::Index index = 1; index <= m_highest_block_written; ++index) {
-        auto block_data = TRY(read_raw_block(index));
-        auto size_in_bytes = *reinterpret_cast<u32*>(block_data.data());
+    for (Block::Index index = 1; index < m_blocks_in_file; ++index) {
+        u32 size_in_bytes = 0;
+        TRY(read_raw_block(index, { &size_in_bytes, sizeof(size_in_bytes) }));
         if (size_in_bytes == 0)
             TRY(m_free_block_indices.try_append(index));
     }
 
-    dbgln_if(SQL_DEBUG, "Heap file {} opened; number of blocks = {}; free blocks = {}", name(), m_highest_block_written, m_free_block_indices.size());
+    dbgln_if(SQL_DEBUG, "Heap file {} opened; block size = {}; number of blocks = {}; free blocks = {}", name(), m_block_size, m_blocks_in_file, m_free_block_indices.size());
     return {};
 }
 
@@ -87,12 +98,36 @@ ErrorOr<size_t> Heap::file_size_in_bytes() const
     return TRY(m_file->tell());
 }
 
+ErrorOr<void> Heap::set_buffer_pool_capacity(size_t capacity)
+{
+    capacity = max(capacity, MINIMUM_BUFFER_POOL_CAPACITY);
+    if (capacity < m_pages.size()) {
+        // Write everything back and start over with an empty pool, so we don't have to move pages between frames.
+        for (auto const& page : m_pages) {
+            if (page.pin_count > 0)
+                return Error::from_string_literal("Heap::set_buffer_pool_capacity(): Can't shrink the buffer pool while pages are pinned");
+        }
+        TRY(write_dirty_pages());
+        m_pages.clear();
+        m_page_table.clear();
+        m_clock_hand = 0;
+    }
+    m_buffer_pool_capacity = capacity;
+    return {};
+}
+
 bool Heap::has_block(Block::Index index) const
 {
-    return (index <= m_highest_block_written || m_write_ahead_log.contains(index))
+    return (index < m_blocks_in_file || has_dirty_page(index))
         && !m_free_block_indices.contains_slow(index);
 }
 
+bool Heap::has_dirty_page(Block::Index index) const
+{
+    auto frame = m_page_table.get(index);
+    return frame.has_value() && m_pages[frame.value()].is_dirty;
+}
+
 Block::Index Heap::request_new_block_index()
 {
     if (!m_free_block_indices.is_empty())
@@ -107,10 +142,12 @@ ErrorOr<ByteBuffer> Heap::read_storage(Block::Index index)
     // Reconstruct the data storage from a potential chain of blocks
     ByteBuffer data;
     while (index > 0) {
-        auto block = TRY(read_block(index));
-        dbgln_if(SQL_DEBUG, "  -> {} bytes", block.size_in_bytes());
-        TRY(data.try_append(block.data().bytes().slice(0, block.size_in_bytes())));
-        index = block.next_block();
+        auto page = TRY(pin_page(index));
+        dbgln_if(SQL_DEBUG, "  -> {} bytes", page.size_in_bytes());
+        if (page.size_in_bytes() > block_data_size())
+            return Error::from_string_literal("Heap::read_storage(): Block size in bytes exceeds the block size");
+        TRY(data.try_append(page.data().trim(page.size_in_bytes())));
+        index = page.next_block();
     }
     return data;
 }
@@ -126,19 +163,12 @@ ErrorOr<void> Heap::write_storage(Block::Index index, ReadonlyBytes data)
     u32 offset_in_data = 0;
     Block::Index existing_next_block_index = 0;
     while (remaining_size > 0) {
-        auto block_data_size = AK::min(remaining_size, Block::DATA_SIZE);
+        auto block_data_size = AK::min(remaining_size, this->block_data_size());
         remaining_size -= block_data_size;
 
-        ByteBuffer block_data;
-        if (has_block(index)) {
-            auto existing_block = TRY(read_block(index));
-            block_data = existing_block.data();
-            TRY(block_data.try_resize(block_data_size));
-            existing_next_block_index = existing_block.next_block();
-        } else {
-            block_data = TRY(ByteBuffer::create_uninitialized(block_data_size));
-            existing_next_block_index = 0;
-        }
+        auto block_exists = has_block(index);
+        auto page = TRY(pin_page(index));
+        existing_next_block_index = block_exists ? page.next_block() : 0;
 
         Block::Index next_block_index = existing_next_block_index;
         if (next_block_index == 0 && remaining_size > 0)
@@ -146,8 +176,11 @@ ErrorOr<void> Heap::write_storage(Block::Index index, ReadonlyBytes data)
         else if (remaining_size == 0)
             next_block_index = 0;
 
-        block_data.bytes().overwrite(0, data.offset(offset_in_data), block_data_size);
-        TRY(write_block({ index, block_data_size, next_block_index, move(block_data) }));
+        VERIFY(next_block_index < m_next_block);
+        page.set_header(block_data_size, next_block_index);
+        page.data().overwrite(0, data.offset(offset_in_data), block_data_size);
+        page.data().slice(block_data_size).fill(0);
+        page.mark_dirty();
 
         index = next_block_index;
         offset_in_data += block_data_size;
@@ -160,118 +193,183 @@ ErrorOr<void> Heap::write_storage(Block::Index index, ReadonlyBytes data)
     return {};
 }
 
-ErrorOr<ByteBuffer> Heap::read_raw_block(Block::Index index)
+ErrorOr<void> Heap::free_storage(Block::Index index)
 {
-    VERIFY(m_file);
-    VERIFY(index < m_next_block);
+    dbgln_if(SQL_DEBUG, "{}({})", __FUNCTION__, index);
+    VERIFY(index > 0);
 
-    if (auto wal_entry = m_write_ahead_log.get(index); wal_entry.has_value())
-        return wal_entry.value();
+    while (index > 0) {
+        VERIFY(has_block(index));
+        auto page = TRY(pin_page(index));
+        auto next_block_index = page.next_block();
 
-    TRY(m_file->seek(index * Block::SIZE, SeekMode::SetPosition));
-    auto buffer = TRY(ByteBuffer::create_uninitialized(Block::SIZE));
-    TRY(m_file->read_until_filled(buffer));
-    return buffer;
+        // Zero out freed blocks to facilitate a free block scan upon opening the database later
+        page.bytes().fill(0);
+        page.mark_dirty();
+        TRY(m_free_block_indices.try_append(index));
+
+        index = next_block_index;
+    }
+    return {};
 }
 
-ErrorOr<Block> Heap::read_block(Block::Index index)
+ErrorOr<void> Heap::flush()
 {
-    dbgln_if(SQL_DEBUG, "Read heap block {}", index);
-
-    auto buffer = TRY(read_raw_block(index));
-    auto size_in_bytes = *reinterpret_cast<u32*>(buffer.offset_pointer(0));
-    auto next_block = *reinterpret_cast<Block::Index*>(buffer.offset_pointer(sizeof(u32)));
-    auto data = TRY(buffer.slice(Block::HEADER_SIZE, Block::DATA_SIZE));
+    VERIFY(m_file);
+    TRY(write_dirty_pages());
+    dbgln_if(SQL_DEBUG, "Buffer pool flushed; new number of blocks = {}", m_blocks_in_file);
+    return {};
+}
 
-    return Block { index, size_in_bytes, next_block, move(data) };
+Heap::PinnedPage::PinnedPage(Heap& heap, size_t frame)
+    : m_heap(&heap)
+    , m_frame(frame)
+{
+    ++page().pin_count;
 }
 
-ErrorOr<void> Heap::write_raw_block(Block::Index index, ReadonlyBytes data)
+Heap::PinnedPage::PinnedPage(PinnedPage&& other)
+    : m_heap(exchange(other.m_heap, nullptr))
+    , m_frame(other.m_frame)
 {
-    dbgln_if(SQL_DEBUG, "Write raw block {}", index);
+}
 
-    VERIFY(m_file);
-    VERIFY(data.size() == Block::SIZE);
+Heap::PinnedPage::~PinnedPage()
+{
+    if (!m_heap)
+        return;
+    VERIFY(page().pin_count > 0);
+    --page().pin_count;
+}
 
-    TRY(m_file->seek(index * Block::SIZE, SeekMode::SetPosition));
-    TRY(m_file->write_until_depleted(data));
+u32 Heap::PinnedPage::size_in_bytes() const
+{
+    u32 size_in_bytes = 0;
+    memcpy(&size_in_bytes, bytes().offset_pointer(0), sizeof(size_in_bytes));
+    return size_in_bytes;
+}
 
-    if (index > m_highest_block_written)
-        m_highest_block_written = index;
+Block::Index Heap::PinnedPage::next_block() const
+{
+    Block::Index next_block = 0;
+    memcpy(&next_block, bytes().offset_pointer(sizeof(u32)), sizeof(next_block));
+    return next_block;
+}
 
-    return {};
+void Heap::PinnedPage::set_header(u32 size_in_bytes, Block::Index next_block)
+{
+    bytes().overwrite(0, &size_in_bytes, sizeof(size_in_bytes));
+    bytes().overwrite(sizeof(size_in_bytes), &next_block, sizeof(next_block));
 }
 
-ErrorOr<void> Heap::write_raw_block_to_wal(Block::Index index, ByteBuffer&& data)
+ErrorOr<Heap::PinnedPage> Heap::pin_page(Block::Index index)
 {
-    dbgln_if(SQL_DEBUG, "{}(): adding raw block {} to WAL", __FUNCTION__, index);
+    VERIFY(m_file);
     VERIFY(index < m_next_block);
-    VERIFY(data.size() == Block::SIZE);
 
-    TRY(m_write_ahead_log.try_set(index, move(data)));
+    if (auto frame = m_page_table.get(index); frame.has_value()) {
+        ++m_statistics.buffer_pool_hits;
+        m_pages[frame.value()].is_referenced = true;
+        return PinnedPage { *this, frame.value() };
+    }
 
-    return {};
+    auto frame = TRY(find_frame_for_new_page());
+    auto& page = m_pages[frame];
+
+    // Blocks that were never written to the file start out zeroed.
+    if (index < m_blocks_in_file)
+        TRY(read_raw_block(index, page.data));
+    else
+        page.data.zero_fill();
+
+    // Only claim the block once nothing can fail anymore, otherwise the frame would keep an index it doesn't hold.
+    TRY(m_page_table.try_set(index, frame));
+    page.index = index;
+    page.is_dirty = false;
+    page.is_referenced = true;
+    return PinnedPage { *this, frame };
 }
 
-ErrorOr<void> Heap::write_block(Block const& block)
+// Finds a frame in the buffer pool for a page that is about to be loaded, evicting a page with the clock algorithm
+// if the pool is full. If the victim is dirty, all dirty pages are written back in one go.
+ErrorOr<size_t> Heap::find_frame_for_new_page()
 {
-    VERIFY(block.index() < m_next_block);
-    VERIFY(block.next_block() < m_next_block);
-    VERIFY(block.size_in_bytes() > 0);
-    VERIFY(block.data().size() <= Block::DATA_SIZE);
+    if (m_pages.size() < m_buffer_pool_capacity) {
+        TRY(m_pages.try_append(Page { .data = TRY(ByteBuffer::create_uninitialized(m_block_size)) }));
+        return m_pages.size() - 1;
+    }
 
-    auto size_in_bytes = block.size_in_bytes();
-    auto next_block = block.next_block();
+    // Every unpinned page gets a second chance, so two full turns of the clock are always enough to find a victim.
+    for (size_t step = 0; step < 2 * m_pages.size(); ++step) {
+        auto frame = m_clock_hand;
+        m_clock_hand = (m_clock_hand + 1) % m_pages.size();
+
+        auto& page = m_pages[frame];
+        if (page.pin_count > 0)
+            continue;
+        if (page.is_referenced) {
+            page.is_referenced = false;
+            continue;
+        }
 
-    auto heap_data = TRY(ByteBuffer::create_zeroed(Block::SIZE));
-    heap_data.overwrite(0, &size_in_bytes, sizeof(size_in_bytes));
-    heap_data.overwrite(sizeof(size_in_bytes), &next_block, sizeof(next_block));
+        if (page.is_dirty)
+            TRY(write_dirty_pages());
 
-    block.data().bytes().copy_to(heap_data.bytes().slice(Block::HEADER_SIZE));
+        if (page.index.has_value()) {
+            dbgln_if(SQL_DEBUG, "Evicting block {} from the buffer pool", *page.index);
+            m_page_table.remove(*page.index);
+            page.index.clear();
+            ++m_statistics.evictions;
+        }
+        return frame;
+    }
 
-    return write_raw_block_to_wal(block.index(), move(heap_data));
+    return Error::from_string_literal("Heap: All pages in the buffer pool are pinned");
 }
 
-ErrorOr<void> Heap::free_storage(Block::Index index)
+ErrorOr<void> Heap::write_dirty_pages()
 {
-    dbgln_if(SQL_DEBUG, "{}({})", __FUNCTION__, index);
-    VERIFY(index > 0);
+    Vector<size_t> dirty_frames;
+    for (size_t frame = 0; frame < m_pages.size(); ++frame) {
+        if (m_pages[frame].is_dirty)
+            TRY(dirty_frames.try_append(frame));
+    }
+    quick_sort(dirty_frames, [&](auto a, auto b) { return *m_pages[a].index < *m_pages[b].index; });
 
-    while (index > 0) {
-        auto block = TRY(read_block(index));
-        TRY(free_block(block));
-        index = block.next_block();
+    for (auto frame : dirty_frames) {
+        auto& page = m_pages[frame];
+        dbgln_if(SQL_DEBUG, "Flushing block {}", *page.index);
+        TRY(write_raw_block(*page.index, page.data));
+        page.is_dirty = false;
     }
     return {};
 }
 
-ErrorOr<void> Heap::free_block(Block const& block)
+ErrorOr<void> Heap::read_raw_block(Block::Index index, Bytes buffer)
 {
-    auto index = block.index();
-    dbgln_if(SQL_DEBUG, "{}({})", __FUNCTION__, index);
-
-    VERIFY(index > 0);
-    VERIFY(has_block(index));
-
-    // Zero out freed blocks to facilitate a free block scan upon opening the database later
-    auto zeroed_data = TRY(ByteBuffer::create_zeroed(Block::SIZE));
-    TRY(write_raw_block_to_wal(index, move(zeroed_data)));
+    VERIFY(m_file);
+    VERIFY(buffer.size() <= m_block_size);
 
-    return m_free_block_indices.try_append(index);
+    TRY(m_file->seek(index * m_block_size, SeekMode::SetPosition));
+    TRY(m_file->read_until_filled(buffer));
+    ++m_statistics.page_reads;
+    return {};
 }
 
-ErrorOr<void> Heap::flush()
+ErrorOr<void> Heap::write_raw_block(Block::Index index, ReadonlyBytes data)
 {
+    dbgln_if(SQL_DEBUG, "Write raw block {}", index);
+
     VERIFY(m_file);
-    auto indices = m_write_ahead_log.keys();
-    quick_sort(indices);
-    for (auto index : indices) {
-        dbgln_if(SQL_DEBUG, "Flushing block {}", index);
-        auto& data = m_write_ahead_log.get(index).value();
-        TRY(write_raw_block(index, data));
-    }
-    m_write_ahead_log.clear();
-    dbgln_if(SQL_DEBUG, "WAL flushed; new number of blocks = {}", m_highest_block_written);
+    VERIFY(data.size() == m_block_size);
+
+    TRY(m_file->seek(index * m_block_size, SeekMode::SetPosition));
+    TRY(m_file->write_until_depleted(data));
+    ++m_statistics.page_writes;
+
+    if (index >= m_blocks_in_file)
+        m_blocks_in_file = index + 1;
+
     return {};
 }
 
@@ -281,12 +379,18 @@ constexpr static auto SCHEMAS_ROOT_OFFSET = VERSION_OFFSET + sizeof(u32);
 constexpr static auto TABLES_ROOT_OFFSET = SCHEMAS_ROOT_OFFSET + sizeof(u32);
 constexpr static auto TABLE_COLUMNS_ROOT_OFFSET = TABLES_ROOT_OFFSET + sizeof(u32);
 constexpr static auto USER_VALUES_OFFSET = TABLE_COLUMNS_ROOT_OFFSET + sizeof(u32);
+constexpr static auto BLOCK_SIZE_OFFSET = USER_VALUES_OFFSET + 16 * sizeof(u32);
+constexpr static auto INDEXES_ROOT_OFFSET = BLOCK_SIZE_OFFSET + sizeof(u32);
+constexpr static auto ZERO_BLOCK_HEADER_SIZE = INDEXES_ROOT_OFFSET + sizeof(u32);
+static_assert(ZERO_BLOCK_HEADER_SIZE <= Block::DEFAULT_SIZE);
 
 ErrorOr<void> Heap::read_zero_block()
 {
     dbgln_if(SQL_DEBUG, "Read zero block from {}", name());
 
-    auto block = TRY(read_raw_block(0));
+    // The zero block header has to be read straight from the file, since we don't know the block size yet.
+    auto block = TRY(ByteBuffer::create_uninitialized(ZERO_BLOCK_HEADER_SIZE));
+    TRY(read_raw_block(0, block));
     auto file_id_buffer = TRY(block.slice(0, FILE_ID.length()));
     auto file_id = StringView(file_id_buffer);
     if (file_id != FILE_ID) {
@@ -311,6 +415,12 @@ ErrorOr<void> Heap::read_zero_block()
         if (m_user_values[ix])
             dbgln_if(SQL_DEBUG, "User value {}: {}", ix, m_user_values[ix]);
     }
+
+    memcpy(&m_block_size, block.offset_pointer(BLOCK_SIZE_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Block size: {}", m_block_size);
+
+    memcpy(&m_indexes_root, block.offset_pointer(INDEXES_ROOT_OFFSET), sizeof(u32));
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
     return {};
 }
 
@@ -321,21 +431,27 @@ ErrorOr<void> Heap::update_zero_block()
     dbgln_if(SQL_DEBUG, "Schemas root node: {}", m_schemas_root);
     dbgln_if(SQL_DEBUG, "Tables root node: {}", m_tables_root);
     dbgln_if(SQL_DEBUG, "Table Columns root node: {}", m_table_columns_root);
+    dbgln_if(SQL_DEBUG, "Indexes root node: {}", m_indexes_root);
+    dbgln_if(SQL_DEBUG, "Block size: {}", m_block_size);
     for (auto ix = 0u; ix < m_user_values.size(); ix++) {
         if (m_user_values[ix] > 0)
             dbgln_if(SQL_DEBUG, "User value {}: {}", ix, m_user_values[ix]);
     }
 
-    auto buffer = TRY(ByteBuffer::create_zeroed(Block::SIZE));
-    auto buffer_bytes = buffer.bytes();
+    auto page = TRY(pin_page(0));
+    auto buffer_bytes = page.bytes();
+    buffer_bytes.fill(0);
     buffer_bytes.overwrite(0, FILE_ID.characters_without_null_termination(), FILE_ID.length());
     buffer_bytes.overwrite(VERSION_OFFSET, &m_version, sizeof(u32));
     buffer_bytes.overwrite(SCHEMAS_ROOT_OFFSET, &m_schemas_root, sizeof(u32));
     buffer_bytes.overwrite(TABLES_ROOT_OFFSET, &m_tables_root, sizeof(u32));
     buffer_bytes.overwrite(TABLE_COLUMNS_ROOT_OFFSET, &m_table_columns_root, sizeof(u32));
     buffer_bytes.overwrite(USER_VALUES_OFFSET, m_user_values.data(), m_user_values.size() * sizeof(u32));
+    buffer_bytes.overwrite(BLOCK_SIZE_OFFSET, &m_block_size, sizeof(u32));
+    buffer_bytes.overwrite(INDEXES_ROOT_OFFSET, &m_indexes_root, sizeof(u32));
+    page.mark_dirty();
 
-    return write_raw_block_to_wal(0, move(buffer));
+    return {};
 }
 
 ErrorOr<void> Heap::initialize_zero_block()
@@ -344,6 +460,7 @@ ErrorOr<void> Heap::initialize_zero_block()
     m_schemas_root = 0;
     m_tables_root = 0;
     m_table_columns_root = 0;
+    m_indexes_root = 0;
     m_next_block = 1;
     for (auto& user : m_user_values)
         user = 0u;
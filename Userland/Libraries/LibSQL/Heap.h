@@ -11,6 +11,9 @@
 #include <AK/Debug.h>
 #include <AK/DeprecatedString.h>
 #include <AK/HashMap.h>
+#include <AK/Noncopyable.h>
+#include <AK/Optional.h>
+#include <AK/StdLibExtras.h>
 #include <AK/Vector.h>
 #include <LibCore/File.h>
 #include <LibCore/Object.h>
@@ -18,41 +21,34 @@
 namespace SQL {
 
 /**
- * A Block represents a single discrete chunk of 1024 bytes inside the Heap, and
+ * A Block represents a single discrete chunk of bytes inside the Heap, and
  * acts as the container format for the actual data we are storing. This structure
  * is used for everything except block 0, the zero / super block.
  *
- * If data needs to be stored that is larger than 1016 bytes, Blocks are chained
- * together by setting the next block index and the data is reconstructed by
- * repeatedly reading blocks until the next block index is 0.
+ * Every block starts with the number of data bytes it holds, followed by the index
+ * of the next block. If data needs to be stored that is larger than what fits in
+ * a single block, Blocks are chained together by setting the next block index and
+ * the data is reconstructed by repeatedly reading blocks until the next block index
+ * is 0.
+ *
+ * The size of a block is chosen when a Heap is created and is stored in its zero
+ * block. It is a power of two between DEFAULT_SIZE and MAXIMUM_SIZE.
  */
 class Block {
 public:
     typedef u32 Index;
 
-    static constexpr u32 SIZE = 1024;
+    static constexpr u32 DEFAULT_SIZE = 1024;
+    static constexpr u32 MAXIMUM_SIZE = 64 * KiB;
     static constexpr u32 HEADER_SIZE = sizeof(u32) + sizeof(Index);
-    static constexpr u32 DATA_SIZE = SIZE - HEADER_SIZE;
 
-    Block(Index index, u32 size_in_bytes, Index next_block, ByteBuffer data)
-        : m_index(index)
-        , m_size_in_bytes(size_in_bytes)
-        , m_next_block(next_block)
-        , m_data(move(data))
+    // The amount of data that fits into a block of DEFAULT_SIZE bytes.
+    static constexpr u32 DATA_SIZE = DEFAULT_SIZE - HEADER_SIZE;
+
+    static constexpr bool is_valid_size(u32 size)
     {
-        VERIFY(index > 0);
+        return size >= DEFAULT_SIZE && size <= MAXIMUM_SIZE && is_power_of_two(size);
     }
-
-    Index index() const { return m_index; }
-    u32 size_in_bytes() const { return m_size_in_bytes; }
-    Index next_block() const { return m_next_block; }
-    ByteBuffer const& data() const { return m_data; }
-
-private:
-    Index m_index;
-    u32 m_size_in_bytes;
-    Index m_next_block;
-    ByteBuffer m_data;
 };
 
 /**
@@ -68,13 +64,34 @@ class Heap : public Core::Object {
     C_OBJECT(Heap);
 
 public:
-    static constexpr u32 VERSION = 4;
+    static constexpr u32 VERSION = 6;
+
+    // The number of blocks that are kept in memory by default.
+    static constexpr size_t DEFAULT_BUFFER_POOL_CAPACITY = 1024;
+    static constexpr size_t MINIMUM_BUFFER_POOL_CAPACITY = 8;
+
+    struct Statistics {
+        size_t page_reads { 0 };
+        size_t page_writes { 0 };
+        size_t buffer_pool_hits { 0 };
+        size_t evictions { 0 };
+    };
 
     virtual ~Heap() override;
 
     ErrorOr<void> open();
     ErrorOr<size_t> file_size_in_bytes() const;
 
+    // The block size of an existing heap file takes precedence over the one passed to the constructor.
+    u32 block_size() const { return m_block_size; }
+    u32 block_data_size() const { return m_block_size - Block::HEADER_SIZE; }
+
+    size_t buffer_pool_capacity() const { return m_buffer_pool_capacity; }
+    ErrorOr<void> set_buffer_pool_capacity(size_t);
+
+    Statistics const& statistics() const { return m_statistics; }
+    void reset_statistics() { m_statistics = {}; }
+
     [[nodiscard]] bool has_block(Block::Index) const;
     [[nodiscard]] Block::Index request_new_block_index();
 
@@ -101,6 +118,14 @@ public:
         m_table_columns_root = root;
         update_zero_block().release_value_but_fixme_should_propagate_errors();
     }
+
+    Block::Index indexes_root() const { return m_indexes_root; }
+
+    void set_indexes_root(Block::Index root)
+    {
+        m_indexes_root = root;
+        update_zero_block().release_value_but_fixme_should_propagate_errors();
+    }
     u32 version() const { return m_version; }
 
     u32 user_value(size_t index) const
@@ -121,30 +146,76 @@ public:
     ErrorOr<void> flush();
 
 private:
-    explicit Heap(DeprecatedString);
-
-    ErrorOr<ByteBuffer> read_raw_block(Block::Index);
+    explicit Heap(DeprecatedString, u32 block_size = Block::DEFAULT_SIZE);
+
+    // A Page holds the contents of a single block in the buffer pool. Dirty pages are written back to the file
+    // when they are evicted or when the heap is flushed, and pinned pages are never evicted.
+    struct Page {
+        // Empty while the frame doesn't hold any block, e.g. after reading its block failed.
+        Optional<Block::Index> index {};
+        ByteBuffer data;
+        u32 pin_count { 0 };
+        bool is_dirty { false };
+        bool is_referenced { false };
+    };
+
+    // Keeps a page pinned in the buffer pool for as long as it is alive.
+    class PinnedPage {
+        AK_MAKE_NONCOPYABLE(PinnedPage);
+
+    public:
+        PinnedPage(Heap&, size_t frame);
+        PinnedPage(PinnedPage&&);
+        ~PinnedPage();
+
+        u32 size_in_bytes() const;
+        Block::Index next_block() const;
+        void set_header(u32 size_in_bytes, Block::Index next_block);
+
+        Bytes bytes() { return page().data.bytes(); }
+        ReadonlyBytes bytes() const { return page().data.bytes(); }
+        Bytes data() { return bytes().slice(Block::HEADER_SIZE); }
+        ReadonlyBytes data() const { return bytes().slice(Block::HEADER_SIZE); }
+
+        void mark_dirty() { page().is_dirty = true; }
+
+    private:
+        Page& page() { return m_heap->m_pages[m_frame]; }
+        Page const& page() const { return m_heap->m_pages[m_frame]; }
+
+        Heap* m_heap { nullptr };
+        size_t m_frame { 0 };
+    };
+
+    ErrorOr<PinnedPage> pin_page(Block::Index);
+    ErrorOr<size_t> find_frame_for_new_page();
+    ErrorOr<void> write_dirty_pages();
+    [[nodiscard]] bool has_dirty_page(Block::Index) const;
+
+    ErrorOr<void> read_raw_block(Block::Index, Bytes);
     ErrorOr<void> write_raw_block(Block::Index, ReadonlyBytes);
-    ErrorOr<void> write_raw_block_to_wal(Block::Index, ByteBuffer&&);
-
-    ErrorOr<Block> read_block(Block::Index);
-    ErrorOr<void> write_block(Block const&);
-    ErrorOr<void> free_block(Block const&);
 
     ErrorOr<void> read_zero_block();
     ErrorOr<void> initialize_zero_block();
     ErrorOr<void> update_zero_block();
 
     OwnPtr<Core::InputBufferedFile> m_file;
-    Block::Index m_highest_block_written { 0 };
+    u32 m_block_size { Block::DEFAULT_SIZE };
+    Block::Index m_blocks_in_file { 0 };
     Block::Index m_next_block { 1 };
     Block::Index m_schemas_root { 0 };
     Block::Index m_tables_root { 0 };
     Block::Index m_table_columns_root { 0 };
+    Block::Index m_indexes_root { 0 };
     u32 m_version { VERSION };
     Array<u32, 16> m_user_values { 0 };
-    HashMap<Block::Index, ByteBuffer> m_write_ahead_log;
     Vector<Block::Index> m_free_block_indices;
+
+    Vector<Page> m_pages;
+    HashMap<Block::Index, size_t> m_page_table;
+    size_t m_buffer_pool_capacity { DEFAULT_BUFFER_POOL_CAPACITY };
+    size_t m_clock_hand { 0 };
+    Statistics m_statistics;
 };
 
 }
@@ -19,6 +19,7 @@ namespace SQL {
     S(Create)                     \
     S(Delete)                     \
     S(Describe)                   \
+    S(Explain)                    \
     S(Insert)                     \
     S(Select)                     \
     S(Update)
@@ -50,6 +51,7 @@ constexpr char const* command_tag(SQLCommand command)
     S(DatabaseUnavailable, "Database Unavailable")                                                \
     S(IntegerOperatorTypeMismatch, "Cannot apply '{}' operator to non-numeric operands")          \
     S(IntegerOverflow, "Operation would cause integer overflow")                                  \
+    S(IndexExists, "Index '{}' already exist")                                                    \
     S(InternalError, "{}")                                                                        \
     S(InvalidDatabaseName, "Invalid database name '{}'")                                          \
     S(InvalidNumberOfPlaceholderValues, "Number of values does not match number of placeholders") \
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibSQL/Database.h>
+#include <LibSQL/Meta.h>
+#include <LibSQL/RowCursor.h>
+
+namespace SQL {
+
+RowCursor::RowCursor(Database& database, TableDef& table)
+    : m_database(database)
+    , m_table(table)
+    , m_next_block_index(table.block_index())
+{
+}
+
+RowCursor::RowCursor(Database& database, TableDef& table, NonnullRefPtr<BTree> tree, IndexRange range)
+    : m_database(database)
+    , m_table(table)
+    , m_tree(move(tree))
+    , m_range(move(range))
+{
+}
+
+RowCursor::~RowCursor()
+{
+    if (m_list_node.is_in_list())
+        m_list_node.remove();
+}
+
+Optional<Row> RowCursor::next()
+{
+    if (m_is_exhausted)
+        return {};
+
+    auto row = m_tree ? next_in_range() : next_in_chain();
+    if (!row.has_value())
+        m_is_exhausted = true;
+    return row;
+}
+
+Optional<Row> RowCursor::next_in_chain()
+{
+    if (!m_next_block_index)
+        return {};
+
+    auto row = m_database->read_row(*m_table, m_next_block_index);
+    m_next_block_index = row.next_block_index();
+    return row;
+}
+
+Optional<Row> RowCursor::next_in_range()
+{
+    if (!m_iterator.has_value()) {
+        m_iterator = m_range.lower.has_value() ? m_tree->lower_bound(*m_range.lower) : m_tree->begin();
+        m_index_generation = m_database->index_generation();
+    } else if (m_index_generation != m_database->index_generation()) {
+        // New entries may have split the node the iterator points into. Entries are
+        // unique, so we can find our place again by looking up the last one we returned.
+        m_iterator = m_tree->lower_bound(*m_last_entry);
+        if (!m_iterator->is_end() && (**m_iterator).compare(*m_last_entry) == 0)
+            ++*m_iterator;
+        m_index_generation = m_database->index_generation();
+    }
+
+    for (; !m_iterator->is_end(); ++*m_iterator) {
+        Key entry = **m_iterator;
+        if (m_range.lower.has_value() && !m_range.lower_inclusive && entry.compare(*m_range.lower) == 0)
+            continue;
+        if (m_range.upper.has_value()) {
+            auto comparison = entry.compare(*m_range.upper);
+            if (comparison > 0 || (comparison == 0 && !m_range.upper_inclusive))
+                return {};
+        }
+        if (!entry.block_index())
+            continue;
+
+        ++*m_iterator;
+        auto block_index = entry.block_index();
+        m_last_entry = move(entry);
+        return m_database->read_row(*m_table, block_index);
+    }
+    return {};
+}
+
+void RowCursor::row_removed(Row const& row)
+{
+    // Removed index entries are only marked, so only a scan of the row chain has to step around the row.
+    if (!m_tree && m_next_block_index == row.block_index())
+        m_next_block_index = row.next_block_index();
+}
+
+}
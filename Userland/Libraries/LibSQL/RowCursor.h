@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/IntrusiveList.h>
+#include <AK/Noncopyable.h>
+#include <AK/NonnullRefPtr.h>
+#include <AK/Optional.h>
+#include <AK/RefPtr.h>
+#include <LibSQL/BTree.h>
+#include <LibSQL/Forward.h>
+#include <LibSQL/Key.h>
+#include <LibSQL/Row.h>
+
+namespace SQL {
+
+/**
+ * An IndexRange selects the entries of an index whose key lies between two
+ * bounds. A bound may cover just a prefix of the index key; a missing bound
+ * leaves that end of the range open. A point lookup is a range whose
+ * bounds are the same inclusive key.
+ */
+struct IndexRange {
+    Optional<Key> lower;
+    bool lower_inclusive { true };
+    Optional<Key> upper;
+    bool upper_inclusive { true };
+};
+
+/**
+ * A RowCursor reads the rows of a table one at a time, either by following
+ * the chain of rows of the table or by walking a range of one of its
+ * indexes. The Database keeps its open cursors up to date when rows are
+ * inserted or removed, so a cursor can be read from in between other
+ * statements.
+ */
+class RowCursor {
+    AK_MAKE_NONCOPYABLE(RowCursor);
+    AK_MAKE_NONMOVABLE(RowCursor);
+
+public:
+    ~RowCursor();
+
+    TableDef& table() const { return *m_table; }
+    Optional<Row> next();
+
+private:
+    friend class Database;
+
+    RowCursor(Database&, TableDef&);
+    RowCursor(Database&, TableDef&, NonnullRefPtr<BTree>, IndexRange);
+
+    Optional<Row> next_in_chain();
+    Optional<Row> next_in_range();
+    void row_removed(Row const&);
+
+    NonnullRefPtr<Database> m_database;
+    NonnullRefPtr<TableDef> m_table;
+    bool m_is_exhausted { false };
+
+    Block::Index m_next_block_index { 0 };
+
+    RefPtr<BTree> m_tree;
+    IndexRange m_range;
+    Optional<BTreeIterator> m_iterator;
+    Optional<Key> m_last_entry;
+    u64 m_index_generation { 0 };
+
+    IntrusiveListNode<RowCursor> m_list_node;
+
+public:
+    using List = IntrusiveList<&RowCursor::m_list_node>;
+};
+
+}
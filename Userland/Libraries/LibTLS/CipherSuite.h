@@ -34,6 +34,8 @@ enum class KeyExchangeAlgorithm {
     ECDH_RSA,
     ECDHE_ECDSA,
     ECDH_anon,
+    // TLS 1.3 cipher suites leave the key exchange to the key_share extension, see RFC 8446 section 4.2.8
+    KEY_SHARE,
 };
 
 // Defined in RFC 5246 section 7.4.1.4.1
@@ -68,6 +70,7 @@ enum class CipherAlgorithm {
     AES_128_CCM_8,
     AES_256_CBC,
     AES_256_GCM,
+    CHACHA20_POLY1305,
 };
 
 constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
@@ -80,6 +83,7 @@ constexpr size_t cipher_key_size(CipherAlgorithm algorithm)
         return 128;
     case CipherAlgorithm::AES_256_CBC:
     case CipherAlgorithm::AES_256_GCM:
+    case CipherAlgorithm::CHACHA20_POLY1305:
         return 256;
     case CipherAlgorithm::Invalid:
     default:
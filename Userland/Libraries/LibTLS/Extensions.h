@@ -258,14 +258,18 @@ enum class ECPointFormat : u8 {
 };
 
 // https://www.iana.org/assignments/tls-parameters/tls-parameters.xhtml#tls-parameters-16
-#define __ENUM_SIGNATURE_ALGORITHM         \
-    _ENUM_KEY_VALUE(ANONYMOUS, 0)          \
-    _ENUM_KEY_VALUE(RSA, 1)                \
-    _ENUM_KEY_VALUE(DSA, 2)                \
-    _ENUM_KEY_VALUE(ECDSA, 3)              \
-    _ENUM_KEY_VALUE(ED25519, 7)            \
-    _ENUM_KEY_VALUE(ED448, 8)              \
-    _ENUM_KEY_VALUE(GOSTR34102012_256, 64) \
+// RSA_PSS_RSAE_* are the TLS 1.3 signature schemes 0x0804-0x0806 (RFC 8446 section 4.2.3), they pair with HashAlgorithm::INTRINSIC.
+#define __ENUM_SIGNATURE_ALGORITHM          \
+    _ENUM_KEY_VALUE(ANONYMOUS, 0)           \
+    _ENUM_KEY_VALUE(RSA, 1)                 \
+    _ENUM_KEY_VALUE(DSA, 2)                 \
+    _ENUM_KEY_VALUE(ECDSA, 3)               \
+    _ENUM_KEY_VALUE(RSA_PSS_RSAE_SHA256, 4) \
+    _ENUM_KEY_VALUE(RSA_PSS_RSAE_SHA384, 5) \
+    _ENUM_KEY_VALUE(RSA_PSS_RSAE_SHA512, 6) \
+    _ENUM_KEY_VALUE(ED25519, 7)             \
+    _ENUM_KEY_VALUE(ED448, 8)               \
+    _ENUM_KEY_VALUE(GOSTR34102012_256, 64)  \
     _ENUM_KEY_VALUE(GOSTR34102012_512, 65)
 
 enum class SignatureAlgorithm : u8 {
@@ -7,7 +7,9 @@
 
 #include <AK/Debug.h>
 #include <AK/Endian.h>
+#include <AK/Hex.h>
 #include <AK/Random.h>
+#include <AK/StringBuilder.h>
 
 #include <LibCore/Timer.h>
 #include <LibCrypto/ASN1/DER.h>
@@ -18,7 +20,32 @@ namespace TLS {
 
 ByteBuffer TLSv12::build_hello()
 {
-    fill_with_random(m_context.local_random);
+    bool offer_tls13 = m_context.options.max_version == ProtocolVersion::VERSION_1_3;
+
+    // RFC 8446 section 4.1.2: The ClientHello sent in response to a HelloRetryRequest keeps the random and the session ID.
+    if (!m_context.tls13.hello_retry_requested) {
+        fill_with_random(m_context.local_random);
+
+        if (m_context.options.resume_sessions && !m_context.extensions.SNI.is_empty()) {
+            m_context.offered_session = SessionCache::the().take(session_cache_key());
+            if (m_context.offered_session.has_value() && m_context.offered_session->version == ProtocolVersion::VERSION_1_3 && !offer_tls13)
+                m_context.offered_session.clear();
+        }
+
+        auto& session = m_context.offered_session;
+        if (session.has_value() && session->version == ProtocolVersion::VERSION_1_2 && session->ticket.is_empty()) {
+            VERIFY(session->session_id.size() <= sizeof(m_context.session_id));
+            session->session_id.bytes().copy_to({ m_context.session_id, sizeof(m_context.session_id) });
+            m_context.session_id_size = session->session_id.size();
+        } else if (offer_tls13 || session.has_value()) {
+            // A random session ID makes TLS 1.3 look like a resumed TLS 1.2 session to middleboxes (RFC 8446 appendix D.4),
+            // and is echoed by a TLS 1.2 server that accepts our session ticket (RFC 5077 section 3.4).
+            fill_with_random(m_context.session_id);
+            m_context.session_id_size = sizeof(m_context.session_id);
+        } else {
+            m_context.session_id_size = 0;
+        }
+    }
 
     auto packet_version = (u16)m_context.options.version;
     auto version = (u16)m_context.options.version;
@@ -39,27 +66,14 @@ ByteBuffer TLSv12::build_hello()
     if (m_context.session_id_size)
         builder.append(m_context.session_id, m_context.session_id_size);
 
-    size_t extension_length = 0;
-    size_t alpn_length = 0;
-    size_t alpn_negotiated_length = 0;
-
-    // ALPN
-    if (!m_context.negotiated_alpn.is_null()) {
-        alpn_negotiated_length = m_context.negotiated_alpn.length();
-        alpn_length = alpn_negotiated_length + 1;
-        extension_length += alpn_length + 6;
-    } else if (m_context.alpn.size()) {
-        for (auto& alpn : m_context.alpn) {
-            size_t length = alpn.length();
-            alpn_length += length + 1;
-        }
-        if (alpn_length)
-            extension_length += alpn_length + 6;
-    }
-
     // Ciphers
-    builder.append((u16)(m_context.options.usable_cipher_suites.size() * sizeof(u16)));
-    for (auto suite : m_context.options.usable_cipher_suites)
+    Vector<CipherSuite> cipher_suites;
+    for (auto suite : m_context.options.usable_cipher_suites) {
+        if (offer_tls13 || !is_tls13_cipher_suite(suite))
+            cipher_suites.append(suite);
+    }
+    builder.append((u16)(cipher_suites.size() * sizeof(u16)));
+    for (auto suite : cipher_suites)
         builder.append((u16)suite);
 
     // we don't like compression
@@ -67,32 +81,30 @@ ByteBuffer TLSv12::build_hello()
     builder.append((u8)1);
     builder.append((u8)m_context.options.use_compression);
 
-    // set SNI if we have one, and the user hasn't explicitly asked us to omit it.
-    auto sni_length = 0;
-    if (!m_context.extensions.SNI.is_null() && m_context.options.use_sni)
-        sni_length = m_context.extensions.SNI.length();
-
-    auto elliptic_curves_length = 2 * m_context.options.elliptic_curves.size();
-    auto supported_ec_point_formats_length = m_context.options.supported_ec_point_formats.size();
-    bool supports_elliptic_curves = elliptic_curves_length && supported_ec_point_formats_length;
-
-    // signature_algorithms: 2b extension ID, 2b extension length, 2b vector length, 2xN signatures and hashes
-    extension_length += 2 + 2 + 2 + 2 * m_context.options.supported_signature_algorithms.size();
-
-    if (sni_length)
-        extension_length += sni_length + 9;
-
-    // Only send elliptic_curves and ec_point_formats extensions if both are supported
-    if (supports_elliptic_curves)
-        extension_length += 6 + elliptic_curves_length + 5 + supported_ec_point_formats_length;
+    // The extension lengths are filled in once their contents have been written.
+    auto append_length_placeholder = [&] {
+        auto position = builder.length();
+        builder.append((u16)0);
+        return position;
+    };
+    auto set_length = [&](size_t position) {
+        auto length = builder.length() - position - 2;
+        VERIFY(length <= 0xffff);
+        builder.set(position, length / 0x100);
+        builder.set(position + 1, length % 0x100);
+    };
+    auto start_extension = [&](ExtensionType type) {
+        builder.append((u16)type);
+        return append_length_placeholder();
+    };
+
+    auto extensions_length_position = append_length_placeholder();
 
-    builder.append((u16)extension_length);
-
-    if (sni_length) {
+    // set SNI if we have one, and the user hasn't explicitly asked us to omit it.
+    if (!m_context.extensions.SNI.is_empty() && m_context.options.use_sni) {
+        auto sni_length = m_context.extensions.SNI.length();
         // SNI extension
-        builder.append((u16)ExtensionType::SERVER_NAME);
-        // extension length
-        builder.append((u16)(sni_length + 5));
+        auto extension_position = start_extension(ExtensionType::SERVER_NAME);
         // SNI length
         builder.append((u16)(sni_length + 3));
         // SNI type
@@ -100,41 +112,119 @@ ByteBuffer TLSv12::build_hello()
         // SNI host length + value
         builder.append((u16)sni_length);
         builder.append((u8 const*)m_context.extensions.SNI.characters(), sni_length);
+        set_length(extension_position);
     }
 
     // signature_algorithms extension
-    builder.append((u16)ExtensionType::SIGNATURE_ALGORITHMS);
-    // Extension length
-    builder.append((u16)(2 + 2 * m_context.options.supported_signature_algorithms.size()));
-    // Vector count
-    builder.append((u16)(m_context.options.supported_signature_algorithms.size() * 2));
-    // Entries
-    for (auto& entry : m_context.options.supported_signature_algorithms) {
-        builder.append((u8)entry.hash);
-        builder.append((u8)entry.signature);
-    }
-
-    if (supports_elliptic_curves) {
+    {
+        auto extension_position = start_extension(ExtensionType::SIGNATURE_ALGORITHMS);
+        // Vector count
+        builder.append((u16)(m_context.options.supported_signature_algorithms.size() * 2));
+        // Entries
+        for (auto& entry : m_context.options.supported_signature_algorithms) {
+            builder.append((u8)entry.hash);
+            builder.append((u8)entry.signature);
+        }
+        set_length(extension_position);
+    }
+
+    // Only send elliptic_curves and ec_point_formats extensions if both are supported
+    auto elliptic_curves_length = 2 * m_context.options.elliptic_curves.size();
+    auto supported_ec_point_formats_length = m_context.options.supported_ec_point_formats.size();
+    if (elliptic_curves_length && supported_ec_point_formats_length) {
         // elliptic_curves extension
-        builder.append((u16)ExtensionType::SUPPORTED_GROUPS);
-        builder.append((u16)(2 + elliptic_curves_length));
+        auto extension_position = start_extension(ExtensionType::SUPPORTED_GROUPS);
         builder.append((u16)elliptic_curves_length);
         for (auto& curve : m_context.options.elliptic_curves)
             builder.append((u16)curve);
+        set_length(extension_position);
 
         // ec_point_formats extension
-        builder.append((u16)ExtensionType::EC_POINT_FORMATS);
-        builder.append((u16)(1 + supported_ec_point_formats_length));
+        extension_position = start_extension(ExtensionType::EC_POINT_FORMATS);
         builder.append((u8)supported_ec_point_formats_length);
         for (auto& format : m_context.options.supported_ec_point_formats)
             builder.append((u8)format);
+        set_length(extension_position);
     }
 
-    if (alpn_length) {
+    auto& session = m_context.offered_session;
+
+    // session_ticket extension: Empty to ask for a ticket, or the ticket of the TLS 1.2 session we want to resume.
+    if (m_context.options.resume_sessions) {
+        auto extension_position = start_extension(ExtensionType::SESSION_TICKET);
+        if (session.has_value() && session->version == ProtocolVersion::VERSION_1_2)
+            builder.append(session->ticket.bytes());
+        set_length(extension_position);
+    }
+
+    if (offer_tls13) {
+        // supported_versions extension
+        auto extension_position = start_extension(ExtensionType::SUPPORTED_VERSIONS);
+        builder.append((u8)4);
+        builder.append((u16)ProtocolVersion::VERSION_1_3);
+        builder.append((u16)ProtocolVersion::VERSION_1_2);
+        set_length(extension_position);
+
+        // key_share extension, a single share for our preferred group (or the one the server asked for).
+        auto key_share_result = generate_tls13_key_share();
+        if (key_share_result.is_error()) {
+            dbgln("Failed to generate a key share: {}", key_share_result.error());
+        } else {
+            auto public_key = key_share_result.release_value();
+            extension_position = start_extension(ExtensionType::KEY_SHARE);
+            builder.append((u16)(4 + public_key.size()));
+            builder.append((u16)m_context.tls13.key_share_group);
+            builder.append((u16)public_key.size());
+            builder.append(public_key.bytes());
+            set_length(extension_position);
+        }
+
+        if (!m_context.tls13.cookie.is_empty()) {
+            extension_position = start_extension(ExtensionType::COOKIE);
+            builder.append((u16)m_context.tls13.cookie.size());
+            builder.append(m_context.tls13.cookie.bytes());
+            set_length(extension_position);
+        }
+
+        if (m_context.options.resume_sessions) {
+            // psk_key_exchange_modes extension: We only resume with a fresh (EC)DHE exchange, psk_dhe_ke.
+            extension_position = start_extension(ExtensionType::PSK_KEY_EXCHANGE_MODES);
+            builder.append((u8)1);
+            builder.append((u8)1);
+            set_length(extension_position);
+        }
+    }
+
+    if (!m_context.negotiated_alpn.is_null() || !m_context.alpn.is_empty()) {
         // TODO
         VERIFY_NOT_REACHED();
     }
 
+    // pre_shared_key extension, RFC 8446 section 4.2.11: This MUST be the last extension in the ClientHello.
+    size_t binders_length = 0;
+    m_context.tls13.offered_psk = offer_tls13 && session.has_value() && session->version == ProtocolVersion::VERSION_1_3;
+    if (m_context.tls13.offered_psk) {
+        auto hash_size = Crypto::Hash::Manager { get_hash_kind(session->cipher) }.digest_size();
+        auto ticket_age = static_cast<u32>((MonotonicTime::now_coarse() - session->created_at).to_milliseconds());
+
+        auto extension_position = start_extension(ExtensionType::PRE_SHARED_KEY);
+        // identities
+        builder.append((u16)(2 + session->ticket.size() + 4));
+        builder.append((u16)session->ticket.size());
+        builder.append(session->ticket.bytes());
+        u32 obfuscated_ticket_age = AK::convert_between_host_and_network_endian(ticket_age + session->ticket_age_add);
+        builder.append((u8 const*)&obfuscated_ticket_age, sizeof(obfuscated_ticket_age));
+        // binders, filled in below
+        binders_length = 2 + 1 + hash_size;
+        builder.append((u16)(1 + hash_size));
+        builder.append((u8)hash_size);
+        for (size_t i = 0; i < hash_size; ++i)
+            builder.append((u8)0);
+        set_length(extension_position);
+    }
+
+    set_length(extensions_length_position);
+
     // set the "length" field of the packet
     size_t remaining = builder.length() - start_length;
     size_t payload_position = 6;
@@ -145,6 +235,17 @@ ByteBuffer TLSv12::build_hello()
     builder.set(payload_position + 2, remaining);
 
     auto packet = builder.build();
+    if (binders_length)
+        write_tls13_psk_binder(packet, binders_length);
+
+    if (offer_tls13) {
+        auto client_hello_result = ByteBuffer::copy(packet.bytes().slice(5));
+        if (client_hello_result.is_error())
+            dbgln("Failed to keep the client hello around: {}", client_hello_result.error());
+        else
+            m_context.tls13.client_hello = client_hello_result.release_value();
+    }
+
     update_packet(packet);
 
     return packet;
@@ -178,7 +279,7 @@ ByteBuffer TLSv12::build_handshake_finished()
     auto outbuffer = Bytes { out, verify_data_length };
     ByteBuffer dummy;
 
-    auto digest = m_context.handshake_hash.digest();
+    auto digest = m_context.handshake_hash.peek();
     auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
     pseudorandom_function(outbuffer, m_context.master_key, (u8 const*)"client finished", 15, hashbuf, dummy);
 
@@ -216,10 +317,31 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         return (i8)Error::NeedMoreData;
     }
 
-    // TODO: Compare Hashes
-    dbgln_if(TLS_DEBUG, "FIXME: handle_handshake_finished :: Check message validity");
+    // RFC 5246 section 7.4.9: verify_data = PRF(master_secret, "server finished", Hash(handshake_messages))
+    constexpr u32 verify_data_length = 12;
+    u8 expected_verify_data[verify_data_length];
+    auto digest = m_context.handshake_hash.peek();
+    auto hashbuf = ReadonlyBytes { digest.immutable_data(), m_context.handshake_hash.digest_size() };
+    pseudorandom_function({ expected_verify_data, verify_data_length }, m_context.master_key, (u8 const*)"server finished", 15, hashbuf, {});
+    if (size != verify_data_length || !timing_safe_compare(buffer.offset_pointer(index), expected_verify_data, verify_data_length)) {
+        dbgln("server finished message does not match the handshake");
+        return (i8)Error::NotSafe;
+    }
+
+    if (m_context.resumed_session) {
+        // In an abbreviated handshake the server finishes first, and we still have to send our Finished.
+        write_packets = WritePacketStage::Finished;
+        return index + size;
+    }
+
     m_context.connection_status = ConnectionStatus::Established;
+    finish_handshake();
+
+    return index + size;
+}
 
+void TLSv12::finish_handshake()
+{
     if (m_handshake_timeout_timer) {
         // Disable the handshake timeout timer as handshake has been established.
         m_handshake_timeout_timer->stop();
@@ -227,14 +349,98 @@ ssize_t TLSv12::handle_handshake_finished(ReadonlyBytes buffer, WritePacketStage
         m_handshake_timeout_timer = nullptr;
     }
 
+    if (m_context.negotiated_version == ProtocolVersion::VERSION_1_2)
+        store_session();
+    m_context.offered_session.clear();
+
     if (on_connected)
         on_connected();
+}
 
-    return index + size;
+void TLSv12::store_session()
+{
+    if (!m_context.options.resume_sessions || m_context.extensions.SNI.is_empty())
+        return;
+
+    // Servers without a session cache or tickets hand out no session ID.
+    if (m_context.session_id_size == 0 && m_context.session_ticket.ticket.is_empty())
+        return;
+
+    Session session;
+    if (m_context.resumed_session && m_context.offered_session.has_value()) {
+        session = m_context.offered_session.release_value();
+    } else {
+        auto secret_result = ByteBuffer::copy(m_context.master_key);
+        auto session_id_result = ByteBuffer::copy(ReadonlyBytes { m_context.session_id, m_context.session_id_size });
+        if (secret_result.is_error() || session_id_result.is_error())
+            return;
+        session.version = ProtocolVersion::VERSION_1_2;
+        session.cipher = m_context.cipher;
+        session.secret = secret_result.release_value();
+        session.session_id = session_id_result.release_value();
+        // Servers don't tell how long they keep session IDs around, this is a common default.
+        session.lifetime = Duration::from_seconds(300);
+    }
+
+    if (!m_context.session_ticket.ticket.is_empty()) {
+        session.ticket = move(m_context.session_ticket.ticket);
+        session.lifetime = m_context.session_ticket.lifetime;
+        session.created_at = MonotonicTime::now_coarse();
+    }
+
+    SessionCache::the().add(session_cache_key(), move(session));
+}
+
+// A resumed handshake skips the certificate checks, so a session must only be resumed under the same validation
+// settings it was established with. Otherwise a connection that doesn't validate could hand its session to one that does.
+DeprecatedString TLSv12::session_cache_key() const
+{
+    StringBuilder builder;
+    builder.append(m_context.extensions.SNI);
+    builder.appendff(" validate={} self_signed={}", m_context.options.validate_certificates, m_context.options.allow_self_signed_certificates);
+    if (m_context.options.root_certificates.has_value()) {
+        Crypto::Hash::SHA256 hash;
+        for (auto& certificate : *m_context.options.root_certificates)
+            hash.update(certificate.original_asn1);
+        builder.appendff(" roots={}", encode_hex(hash.digest().bytes()));
+    }
+    return builder.to_deprecated_string();
+}
+
+// https://datatracker.ietf.org/doc/html/rfc5077#section-3.3
+ssize_t TLSv12::handle_new_session_ticket(ReadonlyBytes buffer)
+{
+    if (buffer.size() < 3)
+        return (i8)Error::NeedMoreData;
+
+    size_t size = buffer[0] * 0x10000 + buffer[1] * 0x100 + buffer[2];
+    if (buffer.size() - 3 < size)
+        return (i8)Error::NeedMoreData;
+    if (size < 6)
+        return (i8)Error::BrokenPacket;
+
+    auto lifetime_hint = AK::convert_between_host_and_network_endian(ByteReader::load32(buffer.offset_pointer(3)));
+    auto ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(7)));
+    if (ticket_length + 6u > size)
+        return (i8)Error::BrokenPacket;
+
+    // An empty ticket means the server changed its mind about handing one out.
+    auto ticket_result = ByteBuffer::copy(buffer.slice(9, ticket_length));
+    if (ticket_result.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.session_ticket.ticket = ticket_result.release_value();
+    // A lifetime hint of zero leaves the lifetime to us.
+    m_context.session_ticket.lifetime = Duration::from_seconds(lifetime_hint ? lifetime_hint : 300);
+
+    return size + 3;
 }
 
 ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
 {
+    // Everything after the ServerHello is encrypted in TLS 1.3, and follows a different flow.
+    if (m_context.negotiated_version == ProtocolVersion::VERSION_1_3 && m_context.cipher_spec_set)
+        return handle_tls13_handshake_payload(vbuffer);
+
     if (m_context.connection_status == ConnectionStatus::Established) {
         dbgln_if(TLS_DEBUG, "Renegotiation attempt ignored");
         // FIXME: We should properly say "NoRenegotiation", but that causes a handshake failure
@@ -299,6 +505,16 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
             dbgln("unsupported: DTLS");
             payload_res = (i8)Error::UnexpectedMessage;
             break;
+        case HandshakeType::NEW_SESSION_TICKET:
+            if (m_context.handshake_messages[1] >= 1 || m_context.negotiated_version != ProtocolVersion::VERSION_1_2 || m_context.connection_status < ConnectionStatus::Negotiating) {
+                dbgln("unexpected new session ticket message");
+                payload_res = (i8)Error::UnexpectedMessage;
+                break;
+            }
+            ++m_context.handshake_messages[1];
+            dbgln_if(TLS_DEBUG, "new session ticket");
+            payload_res = handle_new_session_ticket(buffer.slice(1, payload_size));
+            break;
         case HandshakeType::CERTIFICATE:
             if (m_context.handshake_messages[4] >= 1) {
                 dbgln("unexpected certificate message");
@@ -422,74 +638,8 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
 
         // if something went wrong, send an alert about it
         if (payload_res < 0) {
-            switch ((Error)payload_res) {
-            case Error::UnexpectedMessage: {
-                auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
-                write_packet(packet);
-                break;
-            }
-            case Error::CompressionNotSupported: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECOMPRESSION_FAILURE_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::BrokenPacket: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECODE_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotVerified: {
-                auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
-                write_packet(packet);
-                break;
-            }
-            case Error::BadCertificate: {
-                auto packet = build_alert(true, (u8)AlertDescription::BAD_CERTIFICATE);
-                write_packet(packet);
-                break;
-            }
-            case Error::UnsupportedCertificate: {
-                auto packet = build_alert(true, (u8)AlertDescription::UNSUPPORTED_CERTIFICATE);
-                write_packet(packet);
-                break;
-            }
-            case Error::NoCommonCipher: {
-                auto packet = build_alert(true, (u8)AlertDescription::INSUFFICIENT_SECURITY);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotUnderstood:
-            case Error::OutOfMemory: {
-                auto packet = build_alert(true, (u8)AlertDescription::INTERNAL_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NoRenegotiation: {
-                auto packet = build_alert(true, (u8)AlertDescription::NO_RENEGOTIATION_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::DecryptionFailed: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECRYPTION_FAILED_RESERVED);
-                write_packet(packet);
-                break;
-            }
-            case Error::NotSafe: {
-                auto packet = build_alert(true, (u8)AlertDescription::DECRYPT_ERROR);
-                write_packet(packet);
-                break;
-            }
-            case Error::NeedMoreData:
-                // Ignore this, as it's not an "error"
-                dbgln_if(TLS_DEBUG, "More data needed");
-                break;
-            default:
-                dbgln("Unknown TLS::Error with value {}", payload_res);
-                VERIFY_NOT_REACHED();
-                break;
-            }
-            if (payload_res < 0)
-                return payload_res;
+            send_alert_for_error((Error)payload_res);
+            return payload_res;
         }
         switch (write_packets) {
         case WritePacketStage::Initial:
@@ -539,6 +689,25 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
                 write_packet(packet);
             }
             m_context.connection_status = ConnectionStatus::Established;
+            if (m_context.resumed_session)
+                finish_handshake();
+            break;
+        case WritePacketStage::ClientHelloRetry: {
+            dbgln_if(TLS_DEBUG, "> client hello (retry)");
+            auto packet = build_hello();
+            write_packet(packet);
+            break;
+        }
+        case WritePacketStage::TLS13HandshakeSecrets:
+            // RFC 8446 section 5.1: Handshake messages MUST NOT span key changes.
+            if (buffer_length != payload_size + 1) {
+                send_alert_for_error(Error::UnexpectedMessage);
+                return (i8)Error::UnexpectedMessage;
+            }
+            if (!derive_tls13_handshake_secrets()) {
+                send_alert_for_error(Error::UnknownError);
+                return (i8)Error::UnknownError;
+            }
             break;
         }
         payload_size++;
@@ -547,4 +716,76 @@ ssize_t TLSv12::handle_handshake_payload(ReadonlyBytes vbuffer)
     }
     return original_length;
 }
+
+void TLSv12::send_alert_for_error(Error error)
+{
+    switch (error) {
+    case Error::UnexpectedMessage: {
+        auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+        write_packet(packet);
+        break;
+    }
+    case Error::CompressionNotSupported: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECOMPRESSION_FAILURE_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::BrokenPacket: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECODE_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotVerified: {
+        auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
+        write_packet(packet);
+        break;
+    }
+    case Error::BadCertificate: {
+        auto packet = build_alert(true, (u8)AlertDescription::BAD_CERTIFICATE);
+        write_packet(packet);
+        break;
+    }
+    case Error::UnsupportedCertificate: {
+        auto packet = build_alert(true, (u8)AlertDescription::UNSUPPORTED_CERTIFICATE);
+        write_packet(packet);
+        break;
+    }
+    case Error::NoCommonCipher: {
+        auto packet = build_alert(true, (u8)AlertDescription::INSUFFICIENT_SECURITY);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotUnderstood:
+    case Error::OutOfMemory:
+    case Error::UnknownError: {
+        auto packet = build_alert(true, (u8)AlertDescription::INTERNAL_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::NoRenegotiation: {
+        auto packet = build_alert(true, (u8)AlertDescription::NO_RENEGOTIATION_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::DecryptionFailed: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECRYPTION_FAILED_RESERVED);
+        write_packet(packet);
+        break;
+    }
+    case Error::NotSafe: {
+        auto packet = build_alert(true, (u8)AlertDescription::DECRYPT_ERROR);
+        write_packet(packet);
+        break;
+    }
+    case Error::NeedMoreData:
+        // Ignore this, as it's not an "error"
+        dbgln_if(TLS_DEBUG, "More data needed");
+        break;
+    default:
+        dbgln("Unknown TLS::Error with value {}", (i8)error);
+        VERIFY_NOT_REACHED();
+        break;
+    }
+}
+
 }
@@ -21,10 +21,20 @@
 
 namespace TLS {
 
+// RFC 8446 section 4.1.3: A HelloRetryRequest is a ServerHello with this random, SHA-256 of "HelloRetryRequest".
+static constexpr u8 hello_retry_request_random[32] = {
+    0xcf, 0x21, 0xad, 0x74, 0xe5, 0x9a, 0x61, 0x11, 0xbe, 0x1d, 0x8c, 0x02, 0x1e, 0x65, 0xb8, 0x91,
+    0xc2, 0xa2, 0x11, 0x16, 0x7a, 0xbb, 0x8c, 0x5e, 0x07, 0x9e, 0x09, 0xe2, 0xc8, 0xa8, 0x33, 0x9c
+};
+
+// RFC 8446 section 4.1.3: A TLS 1.3 server negotiating TLS 1.2 ends its random with "DOWNGRD" and 0x01.
+static constexpr u8 downgrade_to_tls12_sentinel[8] = { 0x44, 0x4f, 0x57, 0x4e, 0x47, 0x52, 0x44, 0x01 };
+
 ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& write_packets)
 {
     write_packets = WritePacketStage::Initial;
-    if (m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating) {
+    bool is_second_server_hello = m_context.tls13.hello_retry_requested && m_context.connection_status == ConnectionStatus::Negotiating;
+    if (!is_second_server_hello && m_context.connection_status != ConnectionStatus::Disconnected && m_context.connection_status != ConnectionStatus::Renegotiating) {
         dbgln("unexpected hello message");
         return (i8)Error::UnexpectedMessage;
     }
@@ -54,6 +64,7 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
 
     memcpy(m_context.remote_random, buffer.offset_pointer(res), sizeof(m_context.remote_random));
     res += sizeof(m_context.remote_random);
+    bool is_hello_retry_request = memcmp(m_context.remote_random, hello_retry_request_random, sizeof(m_context.remote_random)) == 0;
 
     u8 session_length = buffer[res++];
     if (buffer.size() - res < session_length) {
@@ -61,6 +72,11 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         return (i8)Error::NeedMoreData;
     }
 
+    // The server echoes our session ID when it resumes a TLS 1.2 session, and always in TLS 1.3.
+    bool session_id_echoed = session_length > 0
+        && session_length == m_context.session_id_size
+        && memcmp(m_context.session_id, buffer.offset_pointer(res), session_length) == 0;
+
     if (session_length && session_length <= 32) {
         memcpy(m_context.session_id, buffer.offset_pointer(res), session_length);
         m_context.session_id_size = session_length;
@@ -84,11 +100,17 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln("No supported cipher could be agreed upon");
         return (i8)Error::NoCommonCipher;
     }
+    if (is_second_server_hello && cipher != m_context.cipher) {
+        dbgln("Server changed the cipher suite after a HelloRetryRequest");
+        return (i8)Error::NotSafe;
+    }
     m_context.cipher = cipher;
     dbgln_if(TLS_DEBUG, "Cipher: {}", enum_to_string(cipher));
 
     // Simplification: We only support handshake hash functions via HMAC
-    m_context.handshake_hash.initialize(hmac_hash());
+    // After a HelloRetryRequest the transcript hash has already been set up.
+    if (!is_second_server_hello)
+        m_context.handshake_hash.initialize(hmac_hash());
 
     // Compression method
     if (buffer.size() - res < 1)
@@ -110,6 +132,8 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
         dbgln_if(TLS_DEBUG, "Extensions bytes total: {}", extensions_bytes_total);
     }
 
+    Optional<u16> selected_identity;
+
     while (buffer.size() - res >= 4) {
         auto extension_type = (ExtensionType)AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
         res += 2;
@@ -187,12 +211,83 @@ ssize_t TLSv12::handle_server_hello(ReadonlyBytes buffer, WritePacketStage& writ
             // uncompressed points. Therefore, this extension can be safely ignored as it should always inform us
             // that the server supports uncompressed points.
             res += extension_length;
+        } else if (extension_type == ExtensionType::SUPPORTED_VERSIONS) {
+            // RFC 8446 section 4.2.1: The server selects a single version with this extension, which has to be TLS 1.3.
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            auto selected_version = static_cast<ProtocolVersion>(AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res))));
+            if (selected_version != ProtocolVersion::VERSION_1_3 || !supports_version(selected_version))
+                return (i8)Error::NotSafe;
+            m_context.negotiated_version = selected_version;
+            res += extension_length;
+        } else if (extension_type == ExtensionType::KEY_SHARE) {
+            auto key_share_result = ByteBuffer::copy(buffer.slice(res, extension_length));
+            if (key_share_result.is_error())
+                return (i8)Error::OutOfMemory;
+            m_context.tls13.server_key_share = key_share_result.release_value();
+            res += extension_length;
+        } else if (extension_type == ExtensionType::PRE_SHARED_KEY) {
+            if (extension_length != 2)
+                return (i8)Error::BrokenPacket;
+            selected_identity = AK::convert_between_host_and_network_endian(ByteReader::load16(buffer.offset_pointer(res)));
+            res += extension_length;
+        } else if (extension_type == ExtensionType::COOKIE) {
+            if (extension_length < 2)
+                return (i8)Error::BrokenPacket;
+            auto cookie_result = ByteBuffer::copy(buffer.slice(res + 2, extension_length - 2));
+            if (cookie_result.is_error())
+                return (i8)Error::OutOfMemory;
+            m_context.tls13.cookie = cookie_result.release_value();
+            res += extension_length;
+        } else if (extension_type == ExtensionType::SESSION_TICKET) {
+            // RFC 5077 section 3.2: An empty extension announces a NewSessionTicket message.
+            res += extension_length;
         } else {
             dbgln("Encountered unknown extension {} with length {}", enum_to_string(extension_type), extension_length);
             res += extension_length;
         }
     }
 
+    if (m_context.negotiated_version == ProtocolVersion::VERSION_1_3) {
+        if (!is_tls13_cipher_suite(cipher) || !session_id_echoed) {
+            dbgln("TLS 1.3 server hello with a TLS 1.2 cipher suite or without our session ID");
+            return (i8)Error::NotSafe;
+        }
+        auto result = handle_tls13_server_hello(buffer, is_hello_retry_request, selected_identity, write_packets);
+        if (result < 0)
+            return result;
+        return res;
+    }
+
+    if (is_hello_retry_request || is_tls13_cipher_suite(cipher)) {
+        dbgln("TLS 1.2 server hello with a TLS 1.3 cipher suite or retry request");
+        return (i8)Error::NotSafe;
+    }
+
+    if (m_context.options.max_version == ProtocolVersion::VERSION_1_3 && memcmp(m_context.remote_random + 24, downgrade_to_tls12_sentinel, sizeof(downgrade_to_tls12_sentinel)) == 0) {
+        dbgln("TLS 1.3 server negotiated TLS 1.2, someone is interfering with the handshake");
+        return (i8)Error::NotSafe;
+    }
+
+    // RFC 5246 section 7.3 and RFC 5077 section 3.4: An echoed session ID means the server resumes the session we offered,
+    // and the handshake continues with its ChangeCipherSpec and Finished right away.
+    auto& offered_session = m_context.offered_session;
+    if (session_id_echoed && offered_session.has_value() && offered_session->version == ProtocolVersion::VERSION_1_2) {
+        if (offered_session->cipher != cipher) {
+            dbgln("Server resumed a session with a different cipher suite");
+            return (i8)Error::NotSafe;
+        }
+        auto master_key_result = ByteBuffer::copy(offered_session->secret);
+        if (master_key_result.is_error())
+            return (i8)Error::OutOfMemory;
+        m_context.master_key = master_key_result.release_value();
+        m_context.resumed_session = true;
+        if (!expand_key())
+            return (i8)Error::UnknownError;
+        m_context.connection_status = ConnectionStatus::KeyExchange;
+        dbgln_if(TLS_DEBUG, "Resuming session");
+    }
+
     return res;
 }
 
@@ -345,18 +440,46 @@ ssize_t TLSv12::handle_ecdhe_rsa_server_key_exchange(ReadonlyBytes buffer)
 
 ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer)
 {
-    auto signature_hash = signature_buffer[0];
-    auto signature_algorithm = static_cast<SignatureAlgorithm>(signature_buffer[1]);
-    if (signature_algorithm != SignatureAlgorithm::RSA) {
-        dbgln("verify_rsa_server_key_exchange failed: Signature algorithm is not RSA, instead {}", enum_to_string(signature_algorithm));
-        return (i8)Error::NotUnderstood;
-    }
+    if (signature_buffer.size() < 4)
+        return (i8)Error::NeedMoreData;
 
+    auto signature_hash = static_cast<HashAlgorithm>(signature_buffer[0]);
+    auto signature_algorithm = static_cast<SignatureAlgorithm>(signature_buffer[1]);
     auto signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(signature_buffer.offset_pointer(2)));
     auto signature = signature_buffer.slice(4, signature_length);
 
+    ByteBuffer message;
+    if (message.try_append(m_context.local_random, 32).is_error()
+        || message.try_append(m_context.remote_random, 32).is_error()
+        || message.try_append(server_key_info_buffer).is_error()) {
+        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        return (i8)Error::OutOfMemory;
+    }
+
+    return verify_rsa_signature(signature_hash, signature_algorithm, message, signature);
+}
+
+template<typename HashType>
+static Crypto::VerificationConsistency verify_pss_signature(ReadonlyBytes message, ReadonlyBytes encoded_message, size_t em_bits)
+{
+    // RFC 8446 section 4.2.3: The salt length of RSASSA-PSS MUST be equal to the length of the digest.
+    Crypto::PK::EMSA_PSS<HashType, HashType::DigestSize> pss;
+    return pss.verify(message, encoded_message, em_bits);
+}
+
+ssize_t TLSv12::verify_rsa_signature(HashAlgorithm signature_hash, SignatureAlgorithm signature_algorithm, ReadonlyBytes message, ReadonlyBytes signature)
+{
+    bool is_pss = signature_hash == HashAlgorithm::INTRINSIC
+        && (signature_algorithm == SignatureAlgorithm::RSA_PSS_RSAE_SHA256
+            || signature_algorithm == SignatureAlgorithm::RSA_PSS_RSAE_SHA384
+            || signature_algorithm == SignatureAlgorithm::RSA_PSS_RSAE_SHA512);
+    if (signature_algorithm != SignatureAlgorithm::RSA && !is_pss) {
+        dbgln("verify_rsa_signature failed: Signature algorithm is not RSA, instead {}", enum_to_string(signature_algorithm));
+        return (i8)Error::NotUnderstood;
+    }
+
     if (m_context.certificates.is_empty()) {
-        dbgln("verify_rsa_server_key_exchange failed: Attempting to verify signature without certificates");
+        dbgln("verify_rsa_signature failed: Attempting to verify signature without certificates");
         return (i8)Error::NotSafe;
     }
     // RFC5246 section 7.4.2: The sender's certificate MUST come first in the list.
@@ -364,49 +487,71 @@ ssize_t TLSv12::verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buf
     Crypto::PK::RSAPrivateKey dummy_private_key;
     auto rsa = Crypto::PK::RSA(certificate_public_key.rsa, dummy_private_key);
 
-    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature_length);
+    auto signature_verify_buffer_result = ByteBuffer::create_uninitialized(signature.size());
     if (signature_verify_buffer_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
+        dbgln("verify_rsa_signature failed: Not enough memory");
         return (i8)Error::OutOfMemory;
     }
     auto signature_verify_buffer = signature_verify_buffer_result.release_value();
     auto signature_verify_bytes = signature_verify_buffer.bytes();
     rsa.verify(signature, signature_verify_bytes);
 
-    auto message_result = ByteBuffer::create_uninitialized(64 + server_key_info_buffer.size());
-    if (message_result.is_error()) {
-        dbgln("verify_rsa_server_key_exchange failed: Not enough memory");
-        return (i8)Error::OutOfMemory;
-    }
-    auto message = message_result.release_value();
-    message.overwrite(0, m_context.local_random, 32);
-    message.overwrite(32, m_context.remote_random, 32);
-    message.overwrite(64, server_key_info_buffer.data(), server_key_info_buffer.size());
-
-    Crypto::Hash::HashKind hash_kind;
-    switch ((HashAlgorithm)signature_hash) {
-    case HashAlgorithm::SHA1:
-        hash_kind = Crypto::Hash::HashKind::SHA1;
-        break;
-    case HashAlgorithm::SHA256:
-        hash_kind = Crypto::Hash::HashKind::SHA256;
-        break;
-    case HashAlgorithm::SHA384:
-        hash_kind = Crypto::Hash::HashKind::SHA384;
-        break;
-    case HashAlgorithm::SHA512:
-        hash_kind = Crypto::Hash::HashKind::SHA512;
-        break;
-    default:
-        dbgln("verify_rsa_server_key_exchange failed: Hash algorithm is not SHA1/256/384/512, instead {}", signature_hash);
-        return (i8)Error::NotUnderstood;
-    }
+    Crypto::VerificationConsistency verification;
+    if (is_pss) {
+        // RFC 8017 section 8.1.2: The encoded message is emLen = ceil((modBits - 1) / 8) octets long, RSA::verify() strips its leading zeros.
+        auto em_bits = certificate_public_key.rsa.modulus().one_based_index_of_highest_set_bit() - 1;
+        auto em_length = (em_bits + 7) / 8;
+        if (signature_verify_bytes.size() > em_length) {
+            dbgln("verify_rsa_signature failed: Encoded message too long");
+            return (i8)Error::NotSafe;
+        }
+        auto encoded_message_result = ByteBuffer::create_zeroed(em_length);
+        if (encoded_message_result.is_error()) {
+            dbgln("verify_rsa_signature failed: Not enough memory");
+            return (i8)Error::OutOfMemory;
+        }
+        auto encoded_message = encoded_message_result.release_value();
+        encoded_message.overwrite(em_length - signature_verify_bytes.size(), signature_verify_bytes.data(), signature_verify_bytes.size());
+
+        switch (signature_algorithm) {
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA256:
+            verification = verify_pss_signature<Crypto::Hash::SHA256>(message, encoded_message, em_bits);
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA384:
+            verification = verify_pss_signature<Crypto::Hash::SHA384>(message, encoded_message, em_bits);
+            break;
+        case SignatureAlgorithm::RSA_PSS_RSAE_SHA512:
+            verification = verify_pss_signature<Crypto::Hash::SHA512>(message, encoded_message, em_bits);
+            break;
+        default:
+            VERIFY_NOT_REACHED();
+        }
+    } else {
+        Crypto::Hash::HashKind hash_kind;
+        switch (signature_hash) {
+        case HashAlgorithm::SHA1:
+            hash_kind = Crypto::Hash::HashKind::SHA1;
+            break;
+        case HashAlgorithm::SHA256:
+            hash_kind = Crypto::Hash::HashKind::SHA256;
+            break;
+        case HashAlgorithm::SHA384:
+            hash_kind = Crypto::Hash::HashKind::SHA384;
+            break;
+        case HashAlgorithm::SHA512:
+            hash_kind = Crypto::Hash::HashKind::SHA512;
+            break;
+        default:
+            dbgln("verify_rsa_signature failed: Hash algorithm is not SHA1/256/384/512, instead {}", (u8)signature_hash);
+            return (i8)Error::NotUnderstood;
+        }
 
-    auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
-    auto verification = pkcs1.verify(message, signature_verify_bytes, signature_length * 8);
+        auto pkcs1 = Crypto::PK::EMSA_PKCS1_V1_5<Crypto::Hash::Manager>(hash_kind);
+        verification = pkcs1.verify(message, signature_verify_bytes, signature.size() * 8);
+    }
 
     if (verification == Crypto::VerificationConsistency::Inconsistent) {
-        dbgln("verify_rsa_server_key_exchange failed: Verification of signature inconsistent");
+        dbgln("verify_rsa_signature failed: Verification of signature inconsistent");
         return (i8)Error::NotSafe;
     }
 
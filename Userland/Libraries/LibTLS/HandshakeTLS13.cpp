@@ -0,0 +1,684 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/Debug.h>
+#include <AK/Endian.h>
+#include <AK/Memory.h>
+#include <LibCrypto/Curves/SECP256r1.h>
+#include <LibCrypto/Curves/X25519.h>
+#include <LibCrypto/Curves/X448.h>
+#include <LibTLS/KeySchedule.h>
+#include <LibTLS/TLSv12.h>
+
+namespace TLS {
+
+using Crypto::Hash::HashKind;
+using namespace KeySchedule;
+
+// RFC 8446 section 4.6.1: Servers MUST NOT use any value greater than 604800 seconds (7 days).
+static constexpr auto max_ticket_lifetime = Duration::from_seconds(604800);
+
+static OwnPtr<Crypto::Curves::EllipticCurve> make_curve(SupportedGroup group)
+{
+    switch (group) {
+    case SupportedGroup::X25519:
+        return make<Crypto::Curves::X25519>();
+    case SupportedGroup::X448:
+        return make<Crypto::Curves::X448>();
+    case SupportedGroup::SECP256R1:
+        return make<Crypto::Curves::SECP256r1>();
+    default:
+        return nullptr;
+    }
+}
+
+ErrorOr<ByteBuffer> TLSv12::tls13_transcript_hash()
+{
+    auto digest = m_context.handshake_hash.peek();
+    return ByteBuffer::copy(digest.bytes());
+}
+
+ErrorOr<ByteBuffer> TLSv12::generate_tls13_key_share()
+{
+    auto& tls13 = m_context.tls13;
+    auto& groups = m_context.options.elliptic_curves;
+
+    if (!groups.contains_slow(tls13.key_share_group) || !make_curve(tls13.key_share_group)) {
+        auto group = groups.first_matching([](auto group) { return make_curve(group) != nullptr; });
+        if (!group.has_value())
+            return AK::Error::from_string_literal("No supported group to generate a key share for");
+        tls13.key_share_group = *group;
+        tls13.key_share_private_key.clear();
+    }
+
+    auto curve = make_curve(tls13.key_share_group);
+    if (tls13.key_share_private_key.is_empty())
+        tls13.key_share_private_key = TRY(curve->generate_private_key());
+    return curve->generate_public_key(tls13.key_share_private_key);
+}
+
+// RFC 8446 section 4.2.11.2: The binder is the Finished MAC of the ClientHello up to the binders, keyed with the PSK.
+void TLSv12::write_tls13_psk_binder(ByteBuffer& client_hello, size_t binders_length)
+{
+    auto& session = *m_context.offered_session;
+    auto hash_kind = get_hash_kind(session.cipher);
+    auto hash_size = Crypto::Hash::Manager { hash_kind }.digest_size();
+
+    auto binder_or_error = [&]() -> ErrorOr<ByteBuffer> {
+        auto early = TRY(early_secret(hash_kind, session.secret.bytes()));
+        auto empty_hash = TRY(hash_of(hash_kind, {}));
+        auto binder_key = TRY(derive_secret(hash_kind, early, "res binder"sv, empty_hash));
+
+        // The transcript skips the record header, and covers the first ClientHello and the HelloRetryRequest after a retry.
+        Crypto::Hash::Manager transcript { hash_kind };
+        transcript.update(m_context.tls13.transcript_prefix);
+        transcript.update(client_hello.bytes().slice(5, client_hello.size() - 5 - binders_length));
+        auto transcript_digest = transcript.digest();
+
+        return finished_verify_data(hash_kind, binder_key, transcript_digest.bytes());
+    }();
+    if (binder_or_error.is_error()) {
+        dbgln("Failed to compute the PSK binder: {}", binder_or_error.error());
+        return;
+    }
+
+    auto binder = binder_or_error.release_value();
+    VERIFY(binder.size() == hash_size);
+    client_hello.overwrite(client_hello.size() - hash_size, binder.data(), hash_size);
+}
+
+ssize_t TLSv12::handle_tls13_server_hello(ReadonlyBytes message, bool is_hello_retry_request, Optional<u16> selected_identity, WritePacketStage& write_packets)
+{
+    auto& tls13 = m_context.tls13;
+    auto& key_share = tls13.server_key_share;
+
+    if (is_hello_retry_request) {
+        // RFC 8446 section 4.1.4: If a client receives a second HelloRetryRequest in the same connection, it MUST abort
+        // the handshake. The selected group has to be one we offered and not the one we already sent a share for.
+        if (tls13.hello_retry_requested || selected_identity.has_value())
+            return (i8)Error::UnexpectedMessage;
+
+        if (!key_share.is_empty()) {
+            if (key_share.size() != 2)
+                return (i8)Error::BrokenPacket;
+            auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.data())));
+            if (group == tls13.key_share_group || !m_context.options.elliptic_curves.contains_slow(group) || !make_curve(group))
+                return (i8)Error::NotSafe;
+            tls13.key_share_group = group;
+            tls13.key_share_private_key.clear();
+            key_share.clear();
+        } else if (tls13.cookie.is_empty()) {
+            // A retry that changes nothing would produce the same ClientHello.
+            return (i8)Error::NotSafe;
+        }
+
+        // The PSK can only be offered again if it goes with the hash of the cipher suite the server picked.
+        if (m_context.offered_session.has_value() && get_hash_kind(m_context.offered_session->cipher) != hmac_hash())
+            m_context.offered_session.clear();
+
+        // RFC 8446 section 4.4.1: The first ClientHello is replaced by a message_hash message with its hash.
+        auto client_hello_hash = hash_of(hmac_hash(), tls13.client_hello);
+        if (client_hello_hash.is_error())
+            return (i8)Error::OutOfMemory;
+        u8 message_hash_header[] { (u8)HandshakeType::MESSAGE_HASH, 0, 0, (u8)client_hello_hash.value().size() };
+
+        m_context.handshake_hash.reset();
+        m_context.handshake_hash.update(message_hash_header, sizeof(message_hash_header));
+        m_context.handshake_hash.update(client_hello_hash.value());
+
+        // The hello retry request itself is added to the transcript by our caller.
+        tls13.transcript_prefix.clear();
+        u8 hello_retry_request_header[] { (u8)HandshakeType::SERVER_HELLO };
+        if (tls13.transcript_prefix.try_append(message_hash_header, sizeof(message_hash_header)).is_error()
+            || tls13.transcript_prefix.try_append(client_hello_hash.value()).is_error()
+            || tls13.transcript_prefix.try_append(hello_retry_request_header, sizeof(hello_retry_request_header)).is_error()
+            || tls13.transcript_prefix.try_append(message).is_error())
+            return (i8)Error::OutOfMemory;
+
+        // A fresh ServerHello follows.
+        m_context.handshake_messages[2] = 0;
+        tls13.hello_retry_requested = true;
+        write_packets = WritePacketStage::ClientHelloRetry;
+        return 0;
+    }
+
+    // KeyShareEntry server_share: NamedGroup group; opaque key_exchange<1..2^16-1>;
+    if (key_share.size() < 4)
+        return (i8)Error::NotSafe;
+    auto group = static_cast<SupportedGroup>(AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.data())));
+    auto key_exchange_length = AK::convert_between_host_and_network_endian(ByteReader::load16(key_share.offset_pointer(2)));
+    if (group != tls13.key_share_group || tls13.key_share_private_key.is_empty())
+        return (i8)Error::NotSafe;
+    if (key_exchange_length + 4u != key_share.size())
+        return (i8)Error::BrokenPacket;
+
+    if (selected_identity.has_value()) {
+        // We only ever offer one identity.
+        if (*selected_identity != 0 || !tls13.offered_psk || !m_context.offered_session.has_value())
+            return (i8)Error::NotSafe;
+        if (get_hash_kind(m_context.offered_session->cipher) != hmac_hash())
+            return (i8)Error::NotSafe;
+        tls13.psk_accepted = true;
+    }
+
+    auto curve = make_curve(group);
+    auto shared_point = curve->compute_coordinate(tls13.key_share_private_key, key_share.bytes().slice(4));
+    if (shared_point.is_error()) {
+        dbgln("Failed to compute the shared point: {}", shared_point.error());
+        return (i8)Error::NotSafe;
+    }
+    auto shared_secret = curve->derive_premaster_key(shared_point.release_value());
+    if (shared_secret.is_error()) {
+        dbgln("Failed to derive the shared secret: {}", shared_secret.error());
+        return (i8)Error::NotSafe;
+    }
+    tls13.shared_secret = shared_secret.release_value();
+
+    // The handshake secrets cover the ServerHello, which our caller has yet to add to the transcript.
+    write_packets = WritePacketStage::TLS13HandshakeSecrets;
+    return 0;
+}
+
+bool TLSv12::install_tls13_traffic_keys(ReadonlyBytes secret, bool local)
+{
+    auto hash_kind = hmac_hash();
+    auto key = hkdf_expand_label(hash_kind, secret, "key"sv, {}, key_length());
+    auto iv = hkdf_expand_label(hash_kind, secret, "iv"sv, {}, 12);
+    if (key.is_error() || iv.is_error())
+        return false;
+
+    auto& cipher = local ? m_cipher_local : m_cipher_remote;
+    switch (get_cipher_algorithm(m_context.cipher)) {
+    case CipherAlgorithm::AES_128_GCM:
+    case CipherAlgorithm::AES_256_GCM:
+        cipher = Crypto::Cipher::AESCipher::GCMMode(key.value(), key_length() * 8, local ? Crypto::Cipher::Intent::Encryption : Crypto::Cipher::Intent::Decryption, Crypto::Cipher::PaddingMode::RFC5246);
+        break;
+    case CipherAlgorithm::CHACHA20_POLY1305:
+        cipher = Crypto::Cipher::ChaCha20Poly1305(key.value());
+        break;
+    default:
+        dbgln("Cipher algorithm of {} is not usable with TLS 1.3", enum_to_string(m_context.cipher));
+        return false;
+    }
+
+    if (local) {
+        memcpy(m_context.crypto.local_aead_iv, iv.value().data(), sizeof(m_context.crypto.local_aead_iv));
+        m_context.local_sequence_number = 0;
+    } else {
+        memcpy(m_context.crypto.remote_aead_iv, iv.value().data(), sizeof(m_context.crypto.remote_aead_iv));
+        m_context.remote_sequence_number = 0;
+    }
+    return true;
+}
+
+// RFC 8446 section 7.1: Everything from the ServerHello on is protected with the handshake traffic secrets.
+bool TLSv12::derive_tls13_handshake_secrets()
+{
+    auto& tls13 = m_context.tls13;
+    auto hash_kind = hmac_hash();
+
+    auto result = [&]() -> ErrorOr<void> {
+        Optional<ReadonlyBytes> pre_shared_key;
+        if (tls13.psk_accepted)
+            pre_shared_key = m_context.offered_session->secret.bytes();
+
+        auto early = TRY(early_secret(hash_kind, pre_shared_key));
+        auto handshake_secret = TRY(hkdf_extract(hash_kind, TRY(derived_secret(hash_kind, early)), tls13.shared_secret));
+        auto transcript_hash = TRY(tls13_transcript_hash());
+        tls13.client_handshake_traffic_secret = TRY(derive_secret(hash_kind, handshake_secret, "c hs traffic"sv, transcript_hash));
+        tls13.server_handshake_traffic_secret = TRY(derive_secret(hash_kind, handshake_secret, "s hs traffic"sv, transcript_hash));
+
+        auto zeros = TRY(ByteBuffer::create_zeroed(transcript_hash.size()));
+        tls13.master_secret = TRY(hkdf_extract(hash_kind, TRY(derived_secret(hash_kind, handshake_secret)), zeros));
+        return {};
+    }();
+    if (result.is_error()) {
+        dbgln("Failed to derive the handshake secrets: {}", result.error());
+        return false;
+    }
+
+    tls13.shared_secret.clear();
+    tls13.key_share_private_key.clear();
+
+    if (!install_tls13_traffic_keys(tls13.client_handshake_traffic_secret, true) || !install_tls13_traffic_keys(tls13.server_handshake_traffic_secret, false))
+        return false;
+
+    m_context.cipher_spec_set = 1;
+    m_context.crypto.created = 1;
+    tls13.state = TLS13HandshakeState::WaitEncryptedExtensions;
+    return true;
+}
+
+ssize_t TLSv12::handle_tls13_handshake_payload(ReadonlyBytes vbuffer)
+{
+    auto& fragment = m_context.tls13.handshake_fragment;
+    if (fragment.try_append(vbuffer).is_error())
+        return (i8)Error::OutOfMemory;
+
+    size_t offset = 0;
+    while (fragment.size() - offset >= 4) {
+        auto type = static_cast<HandshakeType>(fragment[offset]);
+        size_t length = fragment[offset + 1] * 0x10000 + fragment[offset + 2] * 0x100 + fragment[offset + 3];
+        if (fragment.size() - offset - 4 < length)
+            break;
+
+        auto message = fragment.bytes().slice(offset, 4 + length);
+        auto body = message.slice(4);
+        offset += message.size();
+
+        ssize_t result;
+        if (m_context.connection_status == ConnectionStatus::Established) {
+            // Post-handshake messages are not part of the transcript.
+            result = handle_tls13_handshake_message(type, body, {});
+        } else {
+            // CertificateVerify and Finished cover the transcript up to, but not including, themselves.
+            auto transcript_hash = tls13_transcript_hash();
+            if (transcript_hash.is_error()) {
+                result = (i8)Error::OutOfMemory;
+            } else {
+                update_hash(message, 0);
+                result = handle_tls13_handshake_message(type, body, transcript_hash.value());
+            }
+        }
+
+        if (result >= 0 && type == HandshakeType::FINISHED && offset != fragment.size()) {
+            // RFC 8446 section 5.1: Handshake messages MUST NOT span key changes.
+            result = (i8)Error::UnexpectedMessage;
+        }
+
+        if (result < 0) {
+            fragment.clear();
+            send_alert_for_error((Error)result);
+            return result;
+        }
+    }
+
+    if (offset == fragment.size()) {
+        fragment.clear();
+    } else if (offset > 0) {
+        auto remaining = ByteBuffer::copy(fragment.bytes().slice(offset));
+        if (remaining.is_error())
+            return (i8)Error::OutOfMemory;
+        fragment = remaining.release_value();
+    }
+
+    return vbuffer.size();
+}
+
+ssize_t TLSv12::handle_tls13_handshake_message(HandshakeType type, ReadonlyBytes message, ReadonlyBytes transcript_hash)
+{
+    auto& state = m_context.tls13.state;
+    dbgln_if(TLS_DEBUG, "TLS 1.3 handshake message {} in state {}", enum_to_string(type), to_underlying(state));
+
+    switch (type) {
+    case HandshakeType::ENCRYPTED_EXTENSIONS:
+        if (state != TLS13HandshakeState::WaitEncryptedExtensions)
+            break;
+        state = m_context.tls13.psk_accepted ? TLS13HandshakeState::WaitFinished : TLS13HandshakeState::WaitCertificateOrCertificateRequest;
+        return handle_tls13_encrypted_extensions(message);
+    case HandshakeType::CERTIFICATE_REQUEST:
+        if (state != TLS13HandshakeState::WaitCertificateOrCertificateRequest)
+            break;
+        state = TLS13HandshakeState::WaitCertificate;
+        return handle_tls13_certificate_request(message);
+    case HandshakeType::CERTIFICATE:
+        if (state != TLS13HandshakeState::WaitCertificateOrCertificateRequest && state != TLS13HandshakeState::WaitCertificate)
+            break;
+        state = TLS13HandshakeState::WaitCertificateVerify;
+        return handle_tls13_certificate(message);
+    case HandshakeType::CERTIFICATE_VERIFY:
+        if (state != TLS13HandshakeState::WaitCertificateVerify)
+            break;
+        state = TLS13HandshakeState::WaitFinished;
+        return handle_tls13_certificate_verify(message, transcript_hash);
+    case HandshakeType::FINISHED:
+        if (state != TLS13HandshakeState::WaitFinished)
+            break;
+        state = TLS13HandshakeState::Connected;
+        return handle_tls13_finished(message, transcript_hash);
+    case HandshakeType::NEW_SESSION_TICKET:
+        if (state != TLS13HandshakeState::Connected)
+            break;
+        return handle_tls13_new_session_ticket(message);
+    case HandshakeType::KEY_UPDATE:
+        if (state != TLS13HandshakeState::Connected)
+            break;
+        return handle_tls13_key_update(message);
+    default:
+        break;
+    }
+
+    dbgln("unexpected TLS 1.3 handshake message: {}", enum_to_string(type));
+    return (i8)Error::UnexpectedMessage;
+}
+
+// RFC 8446 section 4.3.1: We don't offer anything that needs a response here, so the extensions only get checked for sanity.
+ssize_t TLSv12::handle_tls13_encrypted_extensions(ReadonlyBytes message)
+{
+    if (message.size() < 2)
+        return (i8)Error::BrokenPacket;
+
+    size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.data()));
+    if (extensions_length + 2 != message.size())
+        return (i8)Error::BrokenPacket;
+
+    size_t offset = 2;
+    while (offset < message.size()) {
+        if (message.size() - offset < 4)
+            return (i8)Error::BrokenPacket;
+        auto extension_type = static_cast<ExtensionType>(AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(offset))));
+        size_t extension_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(offset + 2)));
+        offset += 4;
+        if (message.size() - offset < extension_length)
+            return (i8)Error::BrokenPacket;
+        if (extension_type == ExtensionType::EARLY_DATA) {
+            // We never send early data.
+            return (i8)Error::UnexpectedMessage;
+        }
+        dbgln_if(TLS_DEBUG, "encrypted extension {} with length {}", enum_to_string(extension_type), extension_length);
+        offset += extension_length;
+    }
+
+    return message.size();
+}
+
+// RFC 8446 section 4.3.2: We have no client certificates to offer for TLS 1.3, so we only remember the request context
+// to send back an empty Certificate message.
+ssize_t TLSv12::handle_tls13_certificate_request(ReadonlyBytes message)
+{
+    if (message.size() < 1 || message.size() < 1u + message[0])
+        return (i8)Error::BrokenPacket;
+
+    auto context = ByteBuffer::copy(message.slice(1, message[0]));
+    if (context.is_error())
+        return (i8)Error::OutOfMemory;
+    m_context.tls13.certificate_request_context = context.release_value();
+    m_context.tls13.certificate_requested = true;
+
+    return message.size();
+}
+
+// RFC 8446 section 4.4.2: Unlike in TLS 1.2, every certificate is followed by its own extensions.
+ssize_t TLSv12::handle_tls13_certificate(ReadonlyBytes message)
+{
+    if (message.size() < 1)
+        return (i8)Error::BrokenPacket;
+
+    // The request context is empty for the server's certificate.
+    if (message[0] != 0)
+        return (i8)Error::BrokenPacket;
+
+    size_t offset = 1;
+    if (message.size() - offset < 3)
+        return (i8)Error::BrokenPacket;
+    size_t certificate_list_length = message[offset] * 0x10000 + message[offset + 1] * 0x100 + message[offset + 2];
+    offset += 3;
+    if (message.size() - offset != certificate_list_length)
+        return (i8)Error::BrokenPacket;
+
+    m_context.certificates.clear();
+    while (offset < message.size()) {
+        if (message.size() - offset < 3)
+            return (i8)Error::BrokenPacket;
+        size_t certificate_length = message[offset] * 0x10000 + message[offset + 1] * 0x100 + message[offset + 2];
+        offset += 3;
+        if (message.size() - offset < certificate_length + 2)
+            return (i8)Error::BrokenPacket;
+
+        auto certificate = Certificate::parse_certificate(message.slice(offset, certificate_length), false);
+        if (certificate.is_error()) {
+            dbgln("Failed to parse server certificate: {}", certificate.error());
+            return (i8)Error::UnsupportedCertificate;
+        }
+        m_context.certificates.append(certificate.release_value());
+        offset += certificate_length;
+
+        size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(offset)));
+        offset += 2;
+        if (message.size() - offset < extensions_length)
+            return (i8)Error::BrokenPacket;
+        offset += extensions_length;
+    }
+
+    if (m_context.certificates.is_empty())
+        return (i8)Error::BadCertificate;
+
+    if (!m_context.verify_chain(m_context.extensions.SNI)) {
+        dbgln("certificate verification failed :(");
+        return (i8)Error::BadCertificate;
+    }
+
+    return message.size();
+}
+
+// RFC 8446 section 4.4.3: The server signs the transcript up to its Certificate message, which proves it holds the key.
+ssize_t TLSv12::handle_tls13_certificate_verify(ReadonlyBytes message, ReadonlyBytes transcript_hash)
+{
+    if (message.size() < 4)
+        return (i8)Error::BrokenPacket;
+
+    auto hash = static_cast<HashAlgorithm>(message[0]);
+    auto signature_algorithm = static_cast<SignatureAlgorithm>(message[1]);
+    size_t signature_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(2)));
+    if (signature_length + 4 != message.size())
+        return (i8)Error::BrokenPacket;
+
+    // RSASSA-PKCS1-v1_5 is not allowed for CertificateVerify.
+    if (hash != HashAlgorithm::INTRINSIC) {
+        dbgln("TLS 1.3 server signed with {}/{}", to_underlying(hash), enum_to_string(signature_algorithm));
+        return (i8)Error::NotSafe;
+    }
+
+    constexpr auto context_string = "TLS 1.3, server CertificateVerify"sv;
+    u8 padding[64];
+    memset(padding, 0x20, sizeof(padding));
+    ByteBuffer signed_content;
+    if (signed_content.try_append(padding, sizeof(padding)).is_error()
+        || signed_content.try_append(context_string.bytes()).is_error()
+        || signed_content.try_append((u8)0).is_error()
+        || signed_content.try_append(transcript_hash).is_error())
+        return (i8)Error::OutOfMemory;
+
+    auto result = verify_rsa_signature(hash, signature_algorithm, signed_content, message.slice(4));
+    if (result < 0)
+        return result;
+
+    return message.size();
+}
+
+ssize_t TLSv12::handle_tls13_finished(ReadonlyBytes message, ReadonlyBytes transcript_hash)
+{
+    auto& tls13 = m_context.tls13;
+    auto hash_kind = hmac_hash();
+
+    auto expected_verify_data = finished_verify_data(hash_kind, tls13.server_handshake_traffic_secret, transcript_hash);
+    if (expected_verify_data.is_error())
+        return (i8)Error::OutOfMemory;
+    if (message.size() != expected_verify_data.value().size() || !timing_safe_compare(message.data(), expected_verify_data.value().data(), message.size())) {
+        dbgln("server finished message does not match the handshake");
+        return (i8)Error::NotSafe;
+    }
+
+    // The application traffic secrets cover the transcript up to and including the server Finished.
+    auto derive_application_secrets = [&]() -> ErrorOr<void> {
+        auto transcript_hash = TRY(tls13_transcript_hash());
+        tls13.client_application_traffic_secret = TRY(derive_secret(hash_kind, tls13.master_secret, "c ap traffic"sv, transcript_hash));
+        tls13.server_application_traffic_secret = TRY(derive_secret(hash_kind, tls13.master_secret, "s ap traffic"sv, transcript_hash));
+        return {};
+    };
+    if (auto result = derive_application_secrets(); result.is_error()) {
+        dbgln("Failed to derive the application traffic secrets: {}", result.error());
+        return (i8)Error::OutOfMemory;
+    }
+
+    // RFC 8446 appendix D.4: The compatibility ChangeCipherSpec goes out before our first encrypted record.
+    {
+        auto packet = build_change_cipher_spec();
+        write_packet(packet);
+        m_context.local_sequence_number = 0;
+    }
+
+    if (tls13.certificate_requested) {
+        dbgln_if(TLS_DEBUG, "> empty client certificate");
+        PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version };
+        builder.append((u8)HandshakeType::CERTIFICATE);
+        builder.append_u24(1 + tls13.certificate_request_context.size() + 3);
+        builder.append((u8)tls13.certificate_request_context.size());
+        builder.append(tls13.certificate_request_context.bytes());
+        builder.append_u24(0);
+        auto packet = builder.build();
+        update_packet(packet);
+        write_packet(packet);
+    }
+
+    {
+        dbgln_if(TLS_DEBUG, "> client finished");
+        auto packet = build_tls13_handshake_finished();
+        if (packet.is_empty())
+            return (i8)Error::OutOfMemory;
+        write_packet(packet);
+    }
+
+    if (!install_tls13_traffic_keys(tls13.client_application_traffic_secret, true) || !install_tls13_traffic_keys(tls13.server_application_traffic_secret, false))
+        return (i8)Error::UnknownError;
+
+    // The resumption master secret covers the transcript up to and including our Finished.
+    auto resumption_master_secret = [&]() -> ErrorOr<ByteBuffer> {
+        auto transcript_hash = TRY(tls13_transcript_hash());
+        return derive_secret(hash_kind, tls13.master_secret, "res master"sv, transcript_hash);
+    }();
+    if (resumption_master_secret.is_error())
+        return (i8)Error::OutOfMemory;
+    tls13.resumption_master_secret = resumption_master_secret.release_value();
+
+    tls13.client_handshake_traffic_secret.clear();
+    tls13.server_handshake_traffic_secret.clear();
+    tls13.master_secret.clear();
+    tls13.client_hello.clear();
+    tls13.transcript_prefix.clear();
+
+    m_context.resumed_session = tls13.psk_accepted;
+    m_context.connection_status = ConnectionStatus::Established;
+    finish_handshake();
+
+    return message.size();
+}
+
+ByteBuffer TLSv12::build_tls13_handshake_finished()
+{
+    auto hash_kind = hmac_hash();
+    auto verify_data = [&]() -> ErrorOr<ByteBuffer> {
+        auto transcript_hash = TRY(tls13_transcript_hash());
+        return finished_verify_data(hash_kind, m_context.tls13.client_handshake_traffic_secret, transcript_hash);
+    }();
+    if (verify_data.is_error()) {
+        dbgln("Failed to compute the client finished message: {}", verify_data.error());
+        return {};
+    }
+
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version, verify_data.value().size() + 64 };
+    builder.append((u8)HandshakeType::FINISHED);
+    builder.append_u24(verify_data.value().size());
+    builder.append(verify_data.value().bytes());
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+// RFC 8446 section 4.6.1: Tickets can be used for a later connection to the same server, with a PSK derived from the
+// resumption master secret and the ticket nonce.
+ssize_t TLSv12::handle_tls13_new_session_ticket(ReadonlyBytes message)
+{
+    // uint32 ticket_lifetime; uint32 ticket_age_add; opaque ticket_nonce<0..255>; opaque ticket<1..2^16-1>; Extension extensions<0..2^16-2>;
+    if (message.size() < 9)
+        return (i8)Error::BrokenPacket;
+
+    auto ticket_lifetime = AK::convert_between_host_and_network_endian(ByteReader::load32(message.data()));
+    auto ticket_age_add = AK::convert_between_host_and_network_endian(ByteReader::load32(message.offset_pointer(4)));
+    size_t offset = 8;
+
+    size_t nonce_length = message[offset++];
+    if (message.size() - offset < nonce_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto nonce = message.slice(offset, nonce_length);
+    offset += nonce_length;
+
+    size_t ticket_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(offset)));
+    offset += 2;
+    if (ticket_length == 0 || message.size() - offset < ticket_length + 2)
+        return (i8)Error::BrokenPacket;
+    auto ticket = message.slice(offset, ticket_length);
+    offset += ticket_length;
+
+    // The only extension defined for tickets is early_data, which we don't use.
+    size_t extensions_length = AK::convert_between_host_and_network_endian(ByteReader::load16(message.offset_pointer(offset)));
+    offset += 2;
+    if (message.size() - offset != extensions_length)
+        return (i8)Error::BrokenPacket;
+
+    if (!m_context.options.resume_sessions || m_context.extensions.SNI.is_empty() || ticket_lifetime == 0)
+        return message.size();
+
+    auto session = [&]() -> ErrorOr<Session> {
+        Session session;
+        session.version = ProtocolVersion::VERSION_1_3;
+        session.cipher = m_context.cipher;
+        session.secret = TRY(hkdf_expand_label(hmac_hash(), m_context.tls13.resumption_master_secret, "resumption"sv, nonce, mac_length()));
+        session.ticket = TRY(ByteBuffer::copy(ticket));
+        session.ticket_age_add = ticket_age_add;
+        session.lifetime = min(Duration::from_seconds(ticket_lifetime), max_ticket_lifetime);
+        return session;
+    }();
+    if (session.is_error())
+        return (i8)Error::OutOfMemory;
+
+    dbgln_if(TLS_DEBUG, "Storing TLS 1.3 session ticket for {}", m_context.extensions.SNI);
+    SessionCache::the().add(session_cache_key(), session.release_value());
+
+    return message.size();
+}
+
+ByteBuffer TLSv12::build_tls13_key_update(bool request_update)
+{
+    PacketBuilder builder { ContentType::HANDSHAKE, m_context.options.version, 64 };
+    builder.append((u8)HandshakeType::KEY_UPDATE);
+    builder.append_u24(1);
+    builder.append((u8)request_update);
+    auto packet = builder.build();
+    update_packet(packet);
+    return packet;
+}
+
+// RFC 8446 section 4.6.3: The server moves to the next generation of its traffic secret, and may ask us to do the same.
+ssize_t TLSv12::handle_tls13_key_update(ReadonlyBytes message)
+{
+    if (message.size() != 1 || message[0] > 1)
+        return (i8)Error::BrokenPacket;
+    bool update_requested = message[0] == 1;
+
+    auto& tls13 = m_context.tls13;
+    auto next_secret = [&](ByteBuffer& secret) {
+        auto next = hkdf_expand_label(hmac_hash(), secret, "traffic upd"sv, {}, secret.size());
+        if (next.is_error())
+            return false;
+        secret = next.release_value();
+        return true;
+    };
+
+    if (!next_secret(tls13.server_application_traffic_secret) || !install_tls13_traffic_keys(tls13.server_application_traffic_secret, false))
+        return (i8)Error::UnknownError;
+
+    if (update_requested) {
+        auto packet = build_tls13_key_update(false);
+        write_packet(packet);
+        if (!next_secret(tls13.client_application_traffic_secret) || !install_tls13_traffic_keys(tls13.client_application_traffic_secret, true))
+            return (i8)Error::UnknownError;
+    }
+
+    return message.size();
+}
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibCrypto/Authentication/HMAC.h>
+#include <LibTLS/KeySchedule.h>
+
+namespace TLS::KeySchedule {
+
+ErrorOr<ByteBuffer> hash_of(HashKind kind, ReadonlyBytes data)
+{
+    Crypto::Hash::Manager hash { kind };
+    hash.update(data);
+    auto digest = hash.digest();
+    return ByteBuffer::copy(digest.bytes());
+}
+
+ErrorOr<ByteBuffer> hkdf_extract(HashKind kind, ReadonlyBytes salt, ReadonlyBytes input_keying_material)
+{
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(salt, kind);
+    auto digest = hmac.process(input_keying_material);
+    return ByteBuffer::copy(digest.bytes());
+}
+
+ErrorOr<ByteBuffer> hkdf_expand_label(HashKind kind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length)
+{
+    constexpr auto label_prefix = "tls13 "sv;
+    VERIFY(label_prefix.length() + label.length() <= 255);
+    VERIFY(context.size() <= 255);
+    VERIFY(length <= 0xffff);
+
+    // struct {
+    //     uint16 length = Length;
+    //     opaque label<7..255> = "tls13 " + Label;
+    //     opaque context<0..255> = Context;
+    // } HkdfLabel;
+    ByteBuffer hkdf_label;
+    TRY(hkdf_label.try_append((u8)(length / 0x100)));
+    TRY(hkdf_label.try_append((u8)(length % 0x100)));
+    TRY(hkdf_label.try_append((u8)(label_prefix.length() + label.length())));
+    TRY(hkdf_label.try_append(label_prefix.bytes()));
+    TRY(hkdf_label.try_append(label.bytes()));
+    TRY(hkdf_label.try_append((u8)context.size()));
+    TRY(hkdf_label.try_append(context));
+
+    // RFC 5869 section 2.3: T(N) = HMAC-Hash(PRK, T(N-1) | info | N)
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(secret, kind);
+    auto output = TRY(ByteBuffer::create_uninitialized(length));
+    ByteBuffer previous_block;
+    size_t offset = 0;
+    for (u8 counter = 1; offset < length; ++counter) {
+        hmac.update(previous_block.bytes());
+        hmac.update(hkdf_label.bytes());
+        hmac.update(ReadonlyBytes { &counter, 1 });
+        auto block = hmac.digest();
+        auto size = min(block.data_length(), length - offset);
+        output.overwrite(offset, block.immutable_data(), size);
+        offset += size;
+        previous_block = TRY(ByteBuffer::copy(block.bytes()));
+    }
+    return output;
+}
+
+ErrorOr<ByteBuffer> derive_secret(HashKind kind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash)
+{
+    return hkdf_expand_label(kind, secret, label, transcript_hash, transcript_hash.size());
+}
+
+ErrorOr<ByteBuffer> early_secret(HashKind kind, Optional<ReadonlyBytes> pre_shared_key)
+{
+    auto zeros = TRY(ByteBuffer::create_zeroed(Crypto::Hash::Manager { kind }.digest_size()));
+    return hkdf_extract(kind, zeros, pre_shared_key.value_or(zeros.bytes()));
+}
+
+ErrorOr<ByteBuffer> derived_secret(HashKind kind, ReadonlyBytes secret)
+{
+    auto empty_hash = TRY(hash_of(kind, {}));
+    return derive_secret(kind, secret, "derived"sv, empty_hash);
+}
+
+ErrorOr<ByteBuffer> finished_verify_data(HashKind kind, ReadonlyBytes base_key, ReadonlyBytes transcript_hash)
+{
+    auto finished_key = TRY(hkdf_expand_label(kind, base_key, "finished"sv, {}, transcript_hash.size()));
+    Crypto::Authentication::HMAC<Crypto::Hash::Manager> hmac(finished_key.bytes(), kind);
+    auto digest = hmac.process(transcript_hash);
+    return ByteBuffer::copy(digest.bytes());
+}
+
+}
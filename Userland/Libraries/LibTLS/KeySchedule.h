@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/Optional.h>
+#include <AK/StringView.h>
+#include <LibCrypto/Hash/HashManager.h>
+
+// The TLS 1.3 key schedule of RFC 8446 section 7.1, every secret takes the hash of the cipher suite.
+namespace TLS::KeySchedule {
+
+using Crypto::Hash::HashKind;
+
+ErrorOr<ByteBuffer> hash_of(HashKind, ReadonlyBytes data);
+
+// RFC 5869 section 2.2: HKDF-Extract(salt, IKM) = HMAC-Hash(salt, IKM)
+ErrorOr<ByteBuffer> hkdf_extract(HashKind, ReadonlyBytes salt, ReadonlyBytes input_keying_material);
+
+// HKDF-Expand-Label(Secret, Label, Context, Length) = HKDF-Expand(Secret, HkdfLabel, Length)
+ErrorOr<ByteBuffer> hkdf_expand_label(HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes context, size_t length);
+
+// Derive-Secret(Secret, Label, Messages) = HKDF-Expand-Label(Secret, Label, Transcript-Hash(Messages), Hash.length)
+ErrorOr<ByteBuffer> derive_secret(HashKind, ReadonlyBytes secret, StringView label, ReadonlyBytes transcript_hash);
+
+// HKDF-Extract(0, PSK), with a string of zeros in place of the PSK when there is none.
+ErrorOr<ByteBuffer> early_secret(HashKind, Optional<ReadonlyBytes> pre_shared_key);
+
+// The secret that the next stage of the key schedule extracts from, Derive-Secret(Secret, "derived", "").
+ErrorOr<ByteBuffer> derived_secret(HashKind, ReadonlyBytes secret);
+
+// RFC 8446 section 4.4.4: verify_data = HMAC(finished_key, Transcript-Hash(Handshake Context, Certificate*, CertificateVerify*))
+ErrorOr<ByteBuffer> finished_verify_data(HashKind, ReadonlyBytes base_key, ReadonlyBytes transcript_hash);
+
+}
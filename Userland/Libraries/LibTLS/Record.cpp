@@ -14,6 +14,24 @@
 
 namespace TLS {
 
+// AEAD AAD (13)
+// Seq. no (8)
+// content type (1)
+// version (2)
+// length (2)
+static void build_aead_additional_data(Bytes aad, u64 sequence_number, ReadonlyBytes type_and_version, u16 length)
+{
+    FixedMemoryStream aad_stream { aad };
+
+    u64 seq_no = AK::convert_between_host_and_network_endian(sequence_number);
+    u16 len = AK::convert_between_host_and_network_endian(length);
+
+    MUST(aad_stream.write_value(seq_no));                    // sequence number
+    MUST(aad_stream.write_until_depleted(type_and_version)); // content-type + version
+    MUST(aad_stream.write_value(len));                       // length
+    VERIFY(MUST(aad_stream.tell()) == MUST(aad_stream.size()));
+}
+
 ByteBuffer TLSv12::build_alert(bool critical, u8 code)
 {
     PacketBuilder builder(ContentType::ALERT, (u16)m_context.options.version);
@@ -44,13 +62,15 @@ void TLSv12::write_packet(ByteBuffer& packet)
                 dbgln_if(TLS_DEBUG, "Scheduling write of {}", m_context.tls_buffer.size());
                 Core::deferred_invoke([this] { write_into_socket(); });
                 m_has_scheduled_write_flush = true;
-            } else {
+            } else if (immediate) {
                 // multiple packet are available, let's flush some out
                 dbgln_if(TLS_DEBUG, "Flushing scheduled write of {}", m_context.tls_buffer.size());
                 write_into_socket();
                 // the deferred invoke is still in place
                 m_has_scheduled_write_flush = true;
             }
+            // Otherwise the scheduled flush picks this record up as well, so a whole handshake flight goes out at once
+            // instead of stalling on Nagle's algorithm and delayed ACKs.
         }
     };
     // Record size limit is 18432 bytes, leave some headroom and flush at 16K.
@@ -76,7 +96,9 @@ void TLSv12::update_packet(ByteBuffer& packet)
                 update_hash(packet.bytes(), header_size);
             }
         }
-        if (m_context.cipher_spec_set && m_context.crypto.created) {
+        if (m_context.cipher_spec_set && m_context.crypto.created && m_context.negotiated_version == ProtocolVersion::VERSION_1_3) {
+            encrypt_tls13_record(packet);
+        } else if (m_context.cipher_spec_set && m_context.crypto.created) {
             size_t length = packet.size() - header_size;
             size_t block_size = 0;
             size_t padding = 0;
@@ -90,6 +112,11 @@ void TLSv12::update_packet(ByteBuffer& packet)
                     padding = 0;
                     mac_size = 0; // AEAD provides its own authentication scheme.
                 },
+                [&](Crypto::Cipher::ChaCha20Poly1305&) {
+                    VERIFY(is_aead());
+                    padding = 0;
+                    mac_size = 0;
+                },
                 [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                     VERIFY(!is_aead());
                     block_size = cbc.cipher().block_size();
@@ -134,22 +161,9 @@ void TLSv12::update_packet(ByteBuffer& packet)
                         // copy the header over
                         ct.overwrite(0, packet.data(), header_size - 2);
 
-                        // AEAD AAD (13)
-                        // Seq. no (8)
-                        // content type (1)
-                        // version (2)
-                        // length (2)
                         u8 aad[13];
                         Bytes aad_bytes { aad, 13 };
-                        FixedMemoryStream aad_stream { aad_bytes };
-
-                        u64 seq_no = AK::convert_between_host_and_network_endian(m_context.local_sequence_number);
-                        u16 len = AK::convert_between_host_and_network_endian((u16)(packet.size() - header_size));
-
-                        MUST(aad_stream.write_value(seq_no));                              // sequence number
-                        MUST(aad_stream.write_until_depleted(packet.bytes().slice(0, 3))); // content-type + version
-                        MUST(aad_stream.write_value(len));                                 // length
-                        VERIFY(MUST(aad_stream.tell()) == MUST(aad_stream.size()));
+                        build_aead_additional_data(aad_bytes, m_context.local_sequence_number, packet.bytes().slice(0, 3), packet.size() - header_size);
 
                         // AEAD IV (12)
                         // IV (4)
@@ -175,6 +189,33 @@ void TLSv12::update_packet(ByteBuffer& packet)
 
                         VERIFY(header_size + 8 + length + 16 == ct.size());
                     },
+                    [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                        VERIFY(is_aead());
+                        // We need enough space for a header, the data and a tag, there is no explicit nonce.
+                        auto ct_buffer_result = ByteBuffer::create_uninitialized(length + header_size + 16);
+                        if (ct_buffer_result.is_error()) {
+                            dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
+                            VERIFY_NOT_REACHED();
+                        }
+                        ct = ct_buffer_result.release_value();
+
+                        // copy the header over
+                        ct.overwrite(0, packet.data(), header_size - 2);
+
+                        u8 aad[13];
+                        Bytes aad_bytes { aad, 13 };
+                        build_aead_additional_data(aad_bytes, m_context.local_sequence_number, packet.bytes().slice(0, 3), packet.size() - header_size);
+
+                        u8 nonce[12];
+                        compute_aead_nonce({ nonce, sizeof(nonce) }, true);
+
+                        chacha.encrypt(
+                            packet.bytes().slice(header_size, length),
+                            ct.bytes().slice(header_size, length),
+                            { nonce, sizeof(nonce) },
+                            aad_bytes,
+                            ct.bytes().slice(header_size + length, 16));
+                    },
                     [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                         VERIFY(!is_aead());
                         // We need enough space for a header, iv_length bytes of IV and whatever the packet contains
@@ -233,6 +274,115 @@ void TLSv12::update_packet(ByteBuffer& packet)
     ++m_context.local_sequence_number;
 }
 
+// https://datatracker.ietf.org/doc/html/rfc8446#section-5.3
+// https://datatracker.ietf.org/doc/html/rfc7905#section-2
+void TLSv12::compute_aead_nonce(Bytes nonce, bool local) const
+{
+    VERIFY(nonce.size() == 12);
+    ReadonlyBytes { local ? m_context.crypto.local_aead_iv : m_context.crypto.remote_aead_iv, 12 }.copy_to(nonce);
+
+    u64 sequence_number = local ? m_context.local_sequence_number : m_context.remote_sequence_number;
+    for (size_t i = 0; i < 8; ++i)
+        nonce[11 - i] ^= (sequence_number >> (i * 8)) & 0xff;
+}
+
+// https://datatracker.ietf.org/doc/html/rfc8446#section-5.2
+void TLSv12::encrypt_tls13_record(ByteBuffer& packet)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t tag_size = 16;
+
+    // TLSInnerPlaintext: the content, followed by the real content type. We never add padding.
+    auto content = packet.bytes().slice(header_size);
+    auto inner_plaintext_size = content.size() + 1;
+    auto record_size = inner_plaintext_size + tag_size;
+    VERIFY(record_size <= 0xffff);
+
+    auto inner_plaintext_result = ByteBuffer::create_uninitialized(inner_plaintext_size);
+    auto ct_buffer_result = ByteBuffer::create_uninitialized(header_size + record_size);
+    if (inner_plaintext_result.is_error() || ct_buffer_result.is_error()) {
+        dbgln("LibTLS: Failed to allocate enough memory for the ciphertext");
+        VERIFY_NOT_REACHED();
+    }
+    auto inner_plaintext = inner_plaintext_result.release_value();
+    auto ct = ct_buffer_result.release_value();
+
+    inner_plaintext.overwrite(0, content.data(), content.size());
+    inner_plaintext[content.size()] = packet[0];
+
+    // The record header is the additional data, and claims to be TLS 1.2 application data.
+    ct[0] = (u8)ContentType::APPLICATION_DATA;
+    ByteReader::store(ct.offset_pointer(1), AK::convert_between_host_and_network_endian((u16)ProtocolVersion::VERSION_1_2));
+    ByteReader::store(ct.offset_pointer(3), AK::convert_between_host_and_network_endian((u16)record_size));
+    auto aad = ct.bytes().slice(0, header_size);
+
+    u8 nonce[12];
+    compute_aead_nonce({ nonce, sizeof(nonce) }, true);
+
+    auto ciphertext = ct.bytes().slice(header_size, inner_plaintext_size);
+    auto tag = ct.bytes().slice(header_size + inner_plaintext_size, tag_size);
+
+    m_cipher_local.visit(
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            // Our GCM impl takes 16 bytes of IV, the last 4 being the zero counter.
+            u8 iv[16] {};
+            memcpy(iv, nonce, sizeof(nonce));
+            gcm.encrypt(inner_plaintext, ciphertext, { iv, sizeof(iv) }, aad, tag);
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            chacha.encrypt(inner_plaintext, ciphertext, { nonce, sizeof(nonce) }, aad, tag);
+        },
+        [&](auto&) { VERIFY_NOT_REACHED(); });
+
+    packet = move(ct);
+}
+
+Error TLSv12::decrypt_tls13_record(ReadonlyBytes record, ByteBuffer& plaintext, ContentType& type)
+{
+    constexpr size_t header_size = 5;
+    constexpr size_t tag_size = 16;
+
+    if (record.size() < header_size + tag_size + 1)
+        return Error::BrokenPacket;
+
+    auto aad = record.slice(0, header_size);
+    auto ciphertext = record.slice(header_size, record.size() - header_size - tag_size);
+    auto tag = record.slice(record.size() - tag_size);
+
+    auto plaintext_result = ByteBuffer::create_uninitialized(ciphertext.size());
+    if (plaintext_result.is_error())
+        return Error::OutOfMemory;
+    plaintext = plaintext_result.release_value();
+
+    u8 nonce[12];
+    compute_aead_nonce({ nonce, sizeof(nonce) }, false);
+
+    auto consistency = m_cipher_remote.visit(
+        [&](Crypto::Cipher::AESCipher::GCMMode& gcm) {
+            u8 iv[16] {};
+            memcpy(iv, nonce, sizeof(nonce));
+            return gcm.decrypt(ciphertext, plaintext, { iv, sizeof(iv) }, aad, tag);
+        },
+        [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+            return chacha.decrypt(ciphertext, plaintext, { nonce, sizeof(nonce) }, aad, tag);
+        },
+        [&](auto&) -> Crypto::VerificationConsistency { VERIFY_NOT_REACHED(); });
+
+    if (consistency != Crypto::VerificationConsistency::Consistent)
+        return Error::IntegrityCheckFailed;
+
+    // The real content type is the last non-zero byte, anything after it is padding.
+    size_t length = plaintext.size();
+    while (length > 0 && plaintext[length - 1] == 0)
+        --length;
+    if (length == 0)
+        return Error::UnexpectedMessage;
+
+    type = (ContentType)plaintext[length - 1];
+    plaintext.resize(length - 1);
+    return Error::NoError;
+}
+
 void TLSv12::update_hash(ReadonlyBytes message, size_t header_size)
 {
     dbgln_if(TLS_DEBUG, "Update hash with message of size {}", message.size());
@@ -346,7 +496,36 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
     ByteBuffer decrypted;
 
-    if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
+    if (m_context.negotiated_version == ProtocolVersion::VERSION_1_3 && type == ContentType::CHANGE_CIPHER_SPEC) {
+        // RFC 8446 section 5: A change_cipher_spec record is only sent for middlebox compatibility during the handshake,
+        //                     it is not protected and does not count towards the sequence number.
+        if (m_context.connection_status == ConnectionStatus::Established || length != 1 || plain[0] != 1) {
+            dbgln("unexpected change cipher message");
+            auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+        return header_size + length;
+    }
+
+    if (m_context.cipher_spec_set && m_context.negotiated_version == ProtocolVersion::VERSION_1_3) {
+        if (type != ContentType::APPLICATION_DATA) {
+            dbgln("unprotected {} record after the handshake keys were installed", enum_to_string(type));
+            auto packet = build_alert(true, (u8)AlertDescription::UNEXPECTED_MESSAGE);
+            write_packet(packet);
+            return (i8)Error::UnexpectedMessage;
+        }
+
+        auto return_value = decrypt_tls13_record(buffer.slice(0, header_size + length), decrypted, type);
+        if (return_value != Error::NoError) {
+            dbgln("TLS 1.3 record could not be decrypted: {}", (i8)return_value);
+            auto description = return_value == Error::IntegrityCheckFailed ? AlertDescription::BAD_RECORD_MAC : AlertDescription::DECODE_ERROR;
+            auto packet = build_alert(true, (u8)description);
+            write_packet(packet);
+            return (i8)return_value;
+        }
+        plain = decrypted;
+    } else if (m_context.cipher_spec_set && type != ContentType::CHANGE_CIPHER_SPEC) {
         if constexpr (TLS_DEBUG) {
             dbgln("Encrypted: ");
             print_buffer(buffer.slice(header_size, length));
@@ -375,22 +554,9 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
                 }
                 decrypted = decrypted_result.release_value();
 
-                // AEAD AAD (13)
-                // Seq. no (8)
-                // content type (1)
-                // version (2)
-                // length (2)
                 u8 aad[13];
                 Bytes aad_bytes { aad, 13 };
-                FixedMemoryStream aad_stream { aad_bytes };
-
-                u64 seq_no = AK::convert_between_host_and_network_endian(m_context.remote_sequence_number);
-                u16 len = AK::convert_between_host_and_network_endian((u16)packet_length);
-
-                MUST(aad_stream.write_value(seq_no));                                    // sequence number
-                MUST(aad_stream.write_until_depleted(buffer.slice(0, header_size - 2))); // content-type + version
-                MUST(aad_stream.write_value(len));                                       // length
-                VERIFY(MUST(aad_stream.tell()) == MUST(aad_stream.size()));
+                build_aead_additional_data(aad_bytes, m_context.remote_sequence_number, buffer.slice(0, header_size - 2), packet_length);
 
                 auto nonce = payload.slice(0, iv_length());
                 payload = payload.slice(iv_length());
@@ -427,6 +593,50 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
                 plain = decrypted;
             },
+            [&](Crypto::Cipher::ChaCha20Poly1305& chacha) {
+                VERIFY(is_aead());
+                if (length < 16) {
+                    dbgln("Invalid packet length");
+                    auto packet = build_alert(true, (u8)AlertDescription::DECRYPT_ERROR);
+                    write_packet(packet);
+                    return_value = Error::BrokenPacket;
+                    return;
+                }
+
+                auto packet_length = length - 16;
+                auto decrypted_result = ByteBuffer::create_uninitialized(packet_length);
+                if (decrypted_result.is_error()) {
+                    dbgln("Failed to allocate memory for the packet");
+                    return_value = Error::DecryptionFailed;
+                    return;
+                }
+                decrypted = decrypted_result.release_value();
+
+                u8 aad[13];
+                Bytes aad_bytes { aad, 13 };
+                build_aead_additional_data(aad_bytes, m_context.remote_sequence_number, buffer.slice(0, header_size - 2), packet_length);
+
+                u8 nonce[12];
+                compute_aead_nonce({ nonce, sizeof(nonce) }, false);
+
+                auto consistency = chacha.decrypt(
+                    plain.slice(0, packet_length),
+                    decrypted,
+                    { nonce, sizeof(nonce) },
+                    aad_bytes,
+                    plain.slice(packet_length, 16));
+
+                if (consistency != Crypto::VerificationConsistency::Consistent) {
+                    dbgln("integrity check failed");
+                    auto packet = build_alert(true, (u8)AlertDescription::BAD_RECORD_MAC);
+                    write_packet(packet);
+
+                    return_value = Error::IntegrityCheckFailed;
+                    return;
+                }
+
+                plain = decrypted;
+            },
             [&](Crypto::Cipher::AESCipher::CBCMode& cbc) {
                 VERIFY(!is_aead());
                 auto iv_size = iv_length();
@@ -540,7 +750,7 @@ ssize_t TLSv12::handle_message(ReadonlyBytes buffer)
 
             if (code == (u8)AlertDescription::CLOSE_NOTIFY) {
                 res += 2;
-                alert(AlertLevel::FATAL, AlertDescription::CLOSE_NOTIFY);
+                alert(AlertLevel::WARNING, AlertDescription::CLOSE_NOTIFY);
                 if (!m_context.cipher_spec_set) {
                     // AWS CloudFront hits this.
                     dbgln("Server sent a close notify and we haven't agreed on a cipher suite. Treating it as a handshake failure.");
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibTLS/SessionCache.h>
+
+namespace TLS {
+
+SessionCache& SessionCache::the()
+{
+    static SessionCache s_the;
+    return s_the;
+}
+
+Optional<Session> SessionCache::take(StringView key)
+{
+    Threading::MutexLocker locker(m_mutex);
+
+    auto it = m_sessions.find(key);
+    if (it == m_sessions.end())
+        return {};
+
+    auto& sessions = it->value;
+    sessions.remove_all_matching([](auto& session) { return session.has_expired(); });
+
+    Optional<Session> session;
+    if (!sessions.is_empty())
+        session = sessions.take_last();
+    if (sessions.is_empty())
+        m_sessions.remove(it);
+    return session;
+}
+
+void SessionCache::add(StringView key, Session session)
+{
+    if (key.is_empty() || session.secret.is_empty() || session.has_expired())
+        return;
+
+    Threading::MutexLocker locker(m_mutex);
+
+    // Good enough to keep the cache from growing without bounds, a connection to a dropped host does a full handshake.
+    if (m_sessions.size() >= max_hosts && !m_sessions.contains(key))
+        m_sessions.clear();
+
+    auto& sessions = m_sessions.ensure(key);
+    if (sessions.size() >= max_sessions_per_host)
+        sessions.remove(0);
+    sessions.append(move(session));
+}
+
+void SessionCache::clear()
+{
+    Threading::MutexLocker locker(m_mutex);
+    m_sessions.clear();
+}
+
+}
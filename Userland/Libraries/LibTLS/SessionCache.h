@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/ByteBuffer.h>
+#include <AK/DeprecatedString.h>
+#include <AK/HashMap.h>
+#include <AK/Optional.h>
+#include <AK/Time.h>
+#include <AK/Vector.h>
+#include <LibThreading/Mutex.h>
+#include <LibTLS/Extensions.h>
+
+namespace TLS {
+
+// What we need to remember about a finished handshake to resume it in a later connection.
+struct Session {
+    ProtocolVersion version { ProtocolVersion::VERSION_1_2 };
+    CipherSuite cipher { CipherSuite::TLS_NULL_WITH_NULL_NULL };
+
+    // The TLS 1.2 master secret, or the TLS 1.3 pre-shared key derived from the resumption master secret.
+    ByteBuffer secret;
+
+    // The TLS 1.2 session ID, may be empty if the server only handed out a ticket.
+    ByteBuffer session_id;
+
+    // An RFC 5077 session ticket for TLS 1.2, or the PSK identity for TLS 1.3.
+    ByteBuffer ticket;
+    u32 ticket_age_add { 0 };
+
+    MonotonicTime created_at { MonotonicTime::now_coarse() };
+    Duration lifetime;
+
+    bool has_expired() const { return MonotonicTime::now_coarse() - created_at >= lifetime; }
+};
+
+// Sessions of finished handshakes, shared by all connections in the process. They are filed under the server name
+// together with the certificate validation settings, see TLSv12::session_cache_key().
+class SessionCache {
+public:
+    static SessionCache& the();
+
+    // Removes the most recent session for the key that has not expired yet from the cache and returns it.
+    // TLS 1.3 tickets should only be used once, so a session has to be added back to be used again.
+    Optional<Session> take(StringView key);
+
+    void add(StringView key, Session);
+
+    void clear();
+
+private:
+    // Servers tend to hand out a couple of TLS 1.3 tickets per connection, keeping a few around lets parallel
+    // connections to the same server all resume.
+    static constexpr size_t max_sessions_per_host = 4;
+    static constexpr size_t max_hosts = 256;
+
+    Threading::Mutex m_mutex;
+    HashMap<DeprecatedString, Vector<Session>> m_sessions;
+};
+
+}
@@ -317,7 +317,8 @@ ErrorOr<bool> TLSv12::flush()
 
 void TLSv12::close()
 {
-    alert(AlertLevel::FATAL, AlertDescription::CLOSE_NOTIFY);
+    // A fatal alert would make the server throw away our session, see RFC 5246 section 7.2.1.
+    alert(AlertLevel::WARNING, AlertDescription::CLOSE_NOTIFY);
     // bye bye.
     m_context.connection_status = ConnectionStatus::Disconnected;
 }
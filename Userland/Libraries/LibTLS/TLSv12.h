@@ -15,10 +15,12 @@
 #include <LibCrypto/Authentication/HMAC.h>
 #include <LibCrypto/BigInt/UnsignedBigInteger.h>
 #include <LibCrypto/Cipher/AES.h>
+#include <LibCrypto/Cipher/ChaCha20Poly1305.h>
 #include <LibCrypto/Curves/EllipticCurve.h>
 #include <LibCrypto/Hash/HashManager.h>
 #include <LibCrypto/PK/RSA.h>
 #include <LibTLS/CipherSuite.h>
+#include <LibTLS/SessionCache.h>
 #include <LibTLS/TLSPacketBuilder.h>
 
 namespace TLS {
@@ -69,6 +71,18 @@ enum class WritePacketStage {
     ClientHandshake = 1,
     ServerHandshake = 2,
     Finished = 3,
+    ClientHelloRetry = 4,
+    TLS13HandshakeSecrets = 5,
+};
+
+// The client states of RFC 8446 appendix A.1 after the ServerHello.
+enum class TLS13HandshakeState {
+    WaitEncryptedExtensions,
+    WaitCertificateOrCertificateRequest,
+    WaitCertificate,
+    WaitCertificateVerify,
+    WaitFinished,
+    Connected,
 };
 
 enum class ConnectionStatus {
@@ -88,17 +102,24 @@ enum ClientVerificationStaus {
 // 4 bytes of fixed IV, 8 random (nonce) bytes, 4 bytes for counter
 // GCM specifically asks us to transmit only the nonce, the counter is zero
 // and the fixed IV is derived from the premaster key.
-#define ENUMERATE_CIPHERS(C)                                                                                                                                  \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)           \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false)           \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)             \
-    C(true, CipherSuite::TLS_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)             \
-    C(true, CipherSuite::TLS_DHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)     \
-    C(true, CipherSuite::TLS_DHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)     \
-    C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true) \
-    C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)
+// ChaCha20-Poly1305 (RFC 7905) and all TLS 1.3 suites (RFC 8446 section 5.3) transmit no nonce at all,
+// the nonce is the 12 byte fixed IV XORed with the sequence number.
+#define ENUMERATE_CIPHERS(C)                                                                                                                                              \
+    C(true, CipherSuite::TLS_AES_128_GCM_SHA256, KeyExchangeAlgorithm::KEY_SHARE, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 0, true)                            \
+    C(true, CipherSuite::TLS_AES_256_GCM_SHA384, KeyExchangeAlgorithm::KEY_SHARE, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 0, true)                            \
+    C(true, CipherSuite::TLS_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::KEY_SHARE, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true)                \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_128_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_256_CBC_SHA, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA1, 16, false)                            \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_128_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_256_CBC_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_CBC, Crypto::Hash::SHA256, 16, false)                       \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)                         \
+    C(true, CipherSuite::TLS_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)                         \
+    C(true, CipherSuite::TLS_DHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)                 \
+    C(true, CipherSuite::TLS_DHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)                 \
+    C(true, CipherSuite::TLS_DHE_RSA_WITH_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::DHE_RSA, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true)     \
+    C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_128_GCM, Crypto::Hash::SHA256, 8, true)             \
+    C(true, CipherSuite::TLS_ECDHE_RSA_WITH_AES_256_GCM_SHA384, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::AES_256_GCM, Crypto::Hash::SHA384, 8, true)             \
+    C(true, CipherSuite::TLS_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256, KeyExchangeAlgorithm::ECDHE_RSA, CipherAlgorithm::CHACHA20_POLY1305, Crypto::Hash::SHA256, 0, true)
 
 constexpr KeyExchangeAlgorithm get_key_exchange_algorithm(CipherSuite suite)
 {
@@ -126,6 +147,27 @@ constexpr CipherAlgorithm get_cipher_algorithm(CipherSuite suite)
     }
 }
 
+constexpr bool is_tls13_cipher_suite(CipherSuite suite)
+{
+    return get_key_exchange_algorithm(suite) == KeyExchangeAlgorithm::KEY_SHARE;
+}
+
+// The hash of the PRF in TLS 1.2, and of HKDF and the transcript in TLS 1.3.
+constexpr Crypto::Hash::HashKind get_hash_kind(CipherSuite suite)
+{
+    switch (suite) {
+#define C(is_supported, suite, key_exchange, cipher, hash, iv_size, is_aead) \
+    case suite:                                                              \
+        if constexpr (hash ::DigestSize == Crypto::Hash::SHA384::DigestSize) \
+            return Crypto::Hash::HashKind::SHA384;                           \
+        return Crypto::Hash::HashKind::SHA256;
+        ENUMERATE_CIPHERS(C)
+#undef C
+    default:
+        return Crypto::Hash::HashKind::SHA256;
+    }
+}
+
 struct Options {
     static Vector<CipherSuite> default_usable_cipher_suites()
     {
@@ -156,8 +198,13 @@ struct Options {
         return move(*this);                  \
     }
 
+    // The version in the record layer and the legacy version fields, newer versions are negotiated with the supported_versions extension.
     OPTION_WITH_DEFAULTS(ProtocolVersion, version, ProtocolVersion::VERSION_1_2)
+    OPTION_WITH_DEFAULTS(ProtocolVersion, max_version, ProtocolVersion::VERSION_1_3)
     OPTION_WITH_DEFAULTS(Vector<SignatureAndHashAlgorithm>, supported_signature_algorithms,
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA256 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA384 },
+        { HashAlgorithm::INTRINSIC, SignatureAlgorithm::RSA_PSS_RSAE_SHA512 },
         { HashAlgorithm::SHA512, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA384, SignatureAlgorithm::RSA },
         { HashAlgorithm::SHA256, SignatureAlgorithm::RSA },
@@ -172,6 +219,8 @@ struct Options {
     OPTION_WITH_DEFAULTS(bool, use_compression, false)
     OPTION_WITH_DEFAULTS(bool, validate_certificates, true)
     OPTION_WITH_DEFAULTS(bool, allow_self_signed_certificates, false)
+    // Offer sessions of earlier connections to the same host from the SessionCache, and put new ones there.
+    OPTION_WITH_DEFAULTS(bool, resume_sessions, true)
     OPTION_WITH_DEFAULTS(Optional<Vector<Certificate>>, root_certificates, )
     OPTION_WITH_DEFAULTS(Function<void(AlertDescription)>, alert_handler, [](auto) {})
     OPTION_WITH_DEFAULTS(Function<void()>, finish_callback, [] {})
@@ -191,6 +240,9 @@ struct Context {
     u8 session_id[32];
     u8 session_id_size { 0 };
     CipherSuite cipher;
+    ProtocolVersion negotiated_version { ProtocolVersion::VERSION_1_2 };
+    Optional<Session> offered_session;
+    bool resumed_session { false };
     bool is_server { false };
     Vector<Certificate> certificates;
     Certificate private_key;
@@ -204,8 +256,8 @@ struct Context {
         u8 local_mac[32];
         u8 local_iv[16];
         u8 remote_iv[16];
-        u8 local_aead_iv[4];
-        u8 remote_aead_iv[4];
+        u8 local_aead_iv[12];
+        u8 remote_aead_iv[12];
     } crypto;
 
     Crypto::Hash::Manager handshake_hash;
@@ -258,6 +310,44 @@ struct Context {
     } server_diffie_hellman_params;
 
     OwnPtr<Crypto::Curves::EllipticCurve> server_key_exchange_curve;
+
+    // RFC 5077 session ticket handed out in a TLS 1.2 NewSessionTicket message.
+    struct {
+        ByteBuffer ticket;
+        Duration lifetime;
+    } session_ticket;
+
+    struct {
+        TLS13HandshakeState state { TLS13HandshakeState::WaitEncryptedExtensions };
+
+        SupportedGroup key_share_group { SupportedGroup::X25519 };
+        ByteBuffer key_share_private_key;
+        ByteBuffer server_key_share;
+        ByteBuffer shared_secret;
+
+        bool hello_retry_requested { false };
+        ByteBuffer cookie;
+        // The ClientHello we sent, it is replaced by its hash in the transcript when the server asks for a retry.
+        ByteBuffer client_hello;
+        // message_hash(ClientHello1) and the HelloRetryRequest, which the PSK binder of the second ClientHello covers.
+        ByteBuffer transcript_prefix;
+
+        bool offered_psk { false };
+        bool psk_accepted { false };
+
+        ByteBuffer client_handshake_traffic_secret;
+        ByteBuffer server_handshake_traffic_secret;
+        ByteBuffer master_secret;
+        ByteBuffer client_application_traffic_secret;
+        ByteBuffer server_application_traffic_secret;
+        ByteBuffer resumption_master_secret;
+
+        bool certificate_requested { false };
+        ByteBuffer certificate_request_context;
+
+        // Handshake messages may be split over several records.
+        ByteBuffer handshake_fragment;
+    } tls13;
 };
 
 class TLSv12 final : public Core::Socket {
@@ -337,6 +427,8 @@ public:
 
     bool supports_version(ProtocolVersion v) const
     {
+        if (v == ProtocolVersion::VERSION_1_3)
+            return m_context.options.max_version == ProtocolVersion::VERSION_1_3;
         return v == ProtocolVersion::VERSION_1_2;
     }
 
@@ -369,6 +461,8 @@ private:
 
     ByteBuffer build_hello();
     ByteBuffer build_handshake_finished();
+    ByteBuffer build_tls13_handshake_finished();
+    ByteBuffer build_tls13_key_update(bool request_update);
     ByteBuffer build_certificate();
     ByteBuffer build_alert(bool critical, u8 code);
     ByteBuffer build_change_cipher_spec();
@@ -392,11 +486,38 @@ private:
     ssize_t handle_server_hello_done(ReadonlyBytes);
     ssize_t handle_certificate_verify(ReadonlyBytes);
     ssize_t handle_handshake_payload(ReadonlyBytes);
+    ssize_t handle_new_session_ticket(ReadonlyBytes);
     ssize_t handle_message(ReadonlyBytes);
 
+    ssize_t handle_tls13_server_hello(ReadonlyBytes message, bool is_hello_retry_request, Optional<u16> selected_identity, WritePacketStage&);
+    ssize_t handle_tls13_handshake_payload(ReadonlyBytes);
+    ssize_t handle_tls13_handshake_message(HandshakeType, ReadonlyBytes message, ReadonlyBytes transcript_hash);
+    ssize_t handle_tls13_encrypted_extensions(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_request(ReadonlyBytes);
+    ssize_t handle_tls13_certificate(ReadonlyBytes);
+    ssize_t handle_tls13_certificate_verify(ReadonlyBytes, ReadonlyBytes transcript_hash);
+    ssize_t handle_tls13_finished(ReadonlyBytes, ReadonlyBytes transcript_hash);
+    ssize_t handle_tls13_new_session_ticket(ReadonlyBytes);
+    ssize_t handle_tls13_key_update(ReadonlyBytes);
+
+    ErrorOr<ByteBuffer> generate_tls13_key_share();
+    void write_tls13_psk_binder(ByteBuffer& client_hello, size_t binders_length);
+    bool derive_tls13_handshake_secrets();
+    bool install_tls13_traffic_keys(ReadonlyBytes secret, bool local);
+    void encrypt_tls13_record(ByteBuffer& packet);
+    Error decrypt_tls13_record(ReadonlyBytes record, ByteBuffer& plaintext, ContentType& type);
+    ErrorOr<ByteBuffer> tls13_transcript_hash();
+
+    void compute_aead_nonce(Bytes nonce, bool local) const;
+    void send_alert_for_error(Error);
+    void finish_handshake();
+    void store_session();
+    DeprecatedString session_cache_key() const;
+
     void pseudorandom_function(Bytes output, ReadonlyBytes secret, u8 const* label, size_t label_length, ReadonlyBytes seed, ReadonlyBytes seed_b);
 
     ssize_t verify_rsa_server_key_exchange(ReadonlyBytes server_key_info_buffer, ReadonlyBytes signature_buffer);
+    ssize_t verify_rsa_signature(HashAlgorithm, SignatureAlgorithm, ReadonlyBytes message, ReadonlyBytes signature);
 
     size_t key_length() const
     {
@@ -480,7 +601,8 @@ private:
     using CipherVariant = Variant<
         Empty,
         Crypto::Cipher::AESCipher::CBCMode,
-        Crypto::Cipher::AESCipher::GCMMode>;
+        Crypto::Cipher::AESCipher::GCMMode,
+        Crypto::Cipher::ChaCha20Poly1305>;
     CipherVariant m_cipher_local {};
     CipherVariant m_cipher_remote {};
 
@@ -94,6 +94,7 @@ int main(int argc, char** argv)
 #endif
     bool print_json = false;
     bool per_file = false;
+    bool use_jit = false;
     StringView specified_test_root;
     DeprecatedString common_path;
     DeprecatedString test_glob;
@@ -120,6 +121,7 @@ int main(int argc, char** argv)
     args_parser.add_option(g_collect_on_every_allocation, "Collect garbage after every allocation", "collect-often", 'g');
     args_parser.add_option(g_run_bytecode, "Use the bytecode interpreter", "run-bytecode", 'b');
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
+    args_parser.add_option(use_jit, "Compile the bytecode to native code before running it", "jit", 0);
     args_parser.add_option(test_glob, "Only run tests matching the given glob", "filter", 'f', "glob");
     for (auto& entry : g_extra_args)
         args_parser.add_option(*entry.key, entry.value.get<0>().characters(), entry.value.get<1>().characters(), entry.value.get<2>());
@@ -141,6 +143,16 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (use_jit) {
+        if (!g_run_bytecode) {
+            warnln("--jit can only be used when --run-bytecode is specified.");
+            return 1;
+        }
+        // Compile everything right away, so that the tests actually exercise the native code.
+        JS::Bytecode::Interpreter::set_jit_enabled(true);
+        JS::Bytecode::Interpreter::set_jit_threshold(0);
+    }
+
     DeprecatedString test_root;
 
     if (!specified_test_root.is_empty()) {
@@ -7,9 +7,8 @@
 
 #include <AK/Queue.h>
 #include <LibThreading/BackgroundAction.h>
-#include <LibThreading/Mutex.h>
 #include <LibThreading/Thread.h>
-#include <unistd.h>
+#include <LibThreading/ThreadPool.h>
 
 static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t s_condition = PTHREAD_COND_INITIALIZER;
@@ -45,19 +44,16 @@ static void init()
     s_background_thread->start();
 }
 
-Threading::Thread& Threading::BackgroundActionBase::background_thread()
+void Threading::BackgroundActionBase::enqueue_work(Function<void()> work, BackgroundActionExecutor executor)
 {
-    if (s_background_thread == nullptr)
-        init();
-    return *s_background_thread;
-}
+    if (executor == BackgroundActionExecutor::ThreadPool) {
+        MUST(ThreadPool::the().submit(move(work)));
+        return;
+    }
 
-void Threading::BackgroundActionBase::enqueue_work(Function<void()> work)
-{
+    pthread_mutex_lock(&s_mutex);
     if (s_all_actions == nullptr)
         init();
-
-    pthread_mutex_lock(&s_mutex);
     s_all_actions->enqueue(move(work));
     pthread_cond_broadcast(&s_condition);
     pthread_mutex_unlock(&s_mutex);
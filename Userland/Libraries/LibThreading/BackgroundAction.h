@@ -8,10 +8,12 @@
 
 #pragma once
 
+#include <AK/Atomic.h>
 #include <AK/Function.h>
 #include <AK/NonnullRefPtr.h>
 #include <AK/Optional.h>
 #include <AK/Queue.h>
+#include <AK/RefPtr.h>
 #include <LibCore/Event.h>
 #include <LibCore/EventLoop.h>
 #include <LibCore/Object.h>
@@ -23,6 +25,14 @@ namespace Threading {
 template<typename Result>
 class BackgroundAction;
 
+enum class BackgroundActionExecutor {
+    // Actions run one at a time, in the order they were created, on a background thread shared by the process.
+    BackgroundThread,
+    // Actions run in parallel with each other on ThreadPool::the(). Only use this for actions that don't depend on
+    // the ones created before them, and don't share unsynchronized state with other actions.
+    ThreadPool,
+};
+
 class BackgroundActionBase {
     template<typename Result>
     friend class BackgroundAction;
@@ -30,8 +40,7 @@ class BackgroundActionBase {
 private:
     BackgroundActionBase() = default;
 
-    static void enqueue_work(Function<void()>);
-    static Thread& background_thread();
+    static void enqueue_work(Function<void()>, BackgroundActionExecutor);
 };
 
 template<typename Result>
@@ -54,9 +63,8 @@ public:
     bool is_canceled() const { return m_canceled; }
 
 private:
-    BackgroundAction(Function<ErrorOr<Result>(BackgroundAction&)> action, Function<ErrorOr<void>(Result)> on_complete, Optional<Function<void(Error)>> on_error = {})
-        : Core::Object(&background_thread())
-        , m_promise(Promise::try_create().release_value_but_fixme_should_propagate_errors())
+    BackgroundAction(Function<ErrorOr<Result>(BackgroundAction&)> action, Function<ErrorOr<void>(Result)> on_complete, Optional<Function<void(Error)>> on_error = {}, BackgroundActionExecutor executor = BackgroundActionExecutor::BackgroundThread)
+        : m_promise(Promise::try_create().release_value_but_fixme_should_propagate_errors())
         , m_action(move(action))
         , m_on_complete(move(on_complete))
     {
@@ -75,23 +83,23 @@ private:
         if (on_error.has_value())
             m_on_error = on_error.release_value();
 
-        enqueue_work([this, origin_event_loop = &Core::EventLoop::current()] {
-            auto result = m_action(*this);
+        // The work keeps us alive until it, and any callback it schedules, has run. Our reference count isn't atomic,
+        // so the protector is always handed back to the origin event loop instead of being dropped on the worker.
+        // This means that the event loop has to outlive the work. Posting to it from another thread wakes it up.
+        enqueue_work([this, protector = RefPtr<BackgroundAction> { this }, origin_event_loop = &Core::EventLoop::current()]() mutable {
+            // Actions canceled before they got to run don't need to run at all.
+            auto result = m_canceled ? ErrorOr<Result> { Error::from_errno(ECANCELED) } : m_action(*this);
             // The event loop cancels the promise when it exits.
-            m_canceled |= m_promise->is_canceled();
-            auto callback_scheduled = false;
+            if (m_promise->is_canceled())
+                m_canceled = true;
             // All of our work was successful and we weren't cancelled; resolve the event loop's promise.
             if (!m_canceled && !result.is_error()) {
                 m_result = result.release_value();
-                // If there is no completion callback, we don't rely on the user keeping around the event loop.
                 if (m_on_complete) {
-                    callback_scheduled = true;
-                    origin_event_loop->deferred_invoke([this] {
+                    origin_event_loop->deferred_invoke([this, protector = move(protector)] {
                         // Our promise's resolution function will never error.
                         (void)m_promise->resolve(*this);
-                        remove_from_parent();
                     });
-                    origin_event_loop->wake();
                 }
             } else {
                 // We were either unsuccessful or cancelled (in which case there is no error).
@@ -101,20 +109,17 @@ private:
 
                 m_promise->cancel(Error::from_errno(ECANCELED));
                 if (!m_canceled && m_on_error) {
-                    callback_scheduled = true;
-                    origin_event_loop->deferred_invoke([this, error = move(error)]() mutable {
+                    origin_event_loop->deferred_invoke([this, protector = move(protector), error = move(error)]() mutable {
                         m_on_error(move(error));
-                        remove_from_parent();
                     });
-                    origin_event_loop->wake();
                 } else if (m_on_error) {
                     m_on_error(move(error));
                 }
             }
 
-            if (!callback_scheduled)
-                remove_from_parent();
-        });
+            if (protector)
+                origin_event_loop->deferred_invoke([protector = move(protector)] {});
+        }, executor);
     }
 
     NonnullRefPtr<Promise> m_promise;
@@ -124,7 +129,7 @@ private:
         dbgln("Error occurred while running a BackgroundAction: {}", error);
     };
     Optional<Result> m_result;
-    bool m_canceled { false };
+    Atomic<bool> m_canceled { false };
 };
 
 }
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <LibThreading/ThreadPool.h>
+#include <unistd.h>
+
+namespace Threading {
+
+// The pool and worker the current thread belongs to, if any.
+static thread_local ThreadPool* s_current_pool;
+static thread_local size_t s_current_worker_index;
+
+bool ThreadPool::Task::cancel()
+{
+    auto expected = State::Queued;
+    if (!m_state.compare_exchange_strong(expected, State::Canceled))
+        return false;
+    // No worker will touch the function anymore, let go of everything it captured right away.
+    m_function = nullptr;
+    return true;
+}
+
+ErrorOr<void> ThreadPool::TaskQueue::try_append(NonnullRefPtr<Task> task)
+{
+    return m_tasks.try_append(move(task));
+}
+
+RefPtr<ThreadPool::Task> ThreadPool::TaskQueue::take_first()
+{
+    if (is_empty())
+        return nullptr;
+    auto task = move(m_tasks[m_head++]);
+    if (is_empty()) {
+        m_tasks.clear_with_capacity();
+        m_head = 0;
+    }
+    return task;
+}
+
+RefPtr<ThreadPool::Task> ThreadPool::TaskQueue::take_last()
+{
+    if (is_empty())
+        return nullptr;
+    auto task = m_tasks.take_last();
+    if (is_empty()) {
+        m_tasks.clear_with_capacity();
+        m_head = 0;
+    }
+    return task;
+}
+
+ThreadPool& ThreadPool::the()
+{
+    // Leaked on purpose, background work may still be running while the process exits.
+    static ThreadPool* s_the = MUST(try_create(max(1l, sysconf(_SC_NPROCESSORS_ONLN)), "Background Thread"sv)).leak_ptr();
+    return *s_the;
+}
+
+ThreadPool::ThreadPool()
+    : m_task_available(m_mutex)
+    , m_became_idle(m_mutex)
+{
+}
+
+ErrorOr<NonnullOwnPtr<ThreadPool>> ThreadPool::try_create(size_t thread_count, StringView thread_name)
+{
+    VERIFY(thread_count > 0);
+
+    auto pool = TRY(adopt_nonnull_own_or_enomem(new (nothrow) ThreadPool()));
+    TRY(pool->m_workers.try_ensure_capacity(thread_count));
+    for (size_t i = 0; i < thread_count; ++i)
+        pool->m_workers.unchecked_append(TRY(adopt_nonnull_own_or_enomem(new (nothrow) Worker())));
+
+    // Workers look at each other's queues, so they can only start once all of them exist.
+    for (size_t i = 0; i < thread_count; ++i)
+        pool->m_workers[i]->thread = TRY(Thread::try_create([&pool = *pool, i] { return pool.run_worker(i); }, thread_name));
+    for (auto& worker : pool->m_workers)
+        worker->thread->start();
+    return pool;
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        MutexLocker locker(m_mutex);
+        m_stopping = true;
+        m_task_available.broadcast();
+    }
+    for (auto& worker : m_workers) {
+        // Creating the pool may have failed before all threads were started.
+        if (worker->thread && worker->thread->needs_to_be_joined())
+            (void)worker->thread->join();
+    }
+}
+
+ErrorOr<NonnullRefPtr<ThreadPool::Task>> ThreadPool::submit(Function<void()> function, Priority priority)
+{
+    auto task = TRY(adopt_nonnull_ref_or_enomem(new (nothrow) Task(move(function))));
+    auto priority_index = to_underlying(priority);
+
+    // Count the task before anyone can pick it up, so the counters can't drop below zero.
+    ++m_unfinished_task_count;
+    ++m_queued_task_count;
+
+    ErrorOr<void> result;
+    if (s_current_pool == this) {
+        auto& worker = *m_workers[s_current_worker_index];
+        MutexLocker locker(worker.mutex);
+        result = worker.queues[priority_index].try_append(task);
+    } else {
+        MutexLocker locker(m_mutex);
+        result = m_shared_queues[priority_index].try_append(task);
+    }
+    if (result.is_error()) {
+        --m_queued_task_count;
+        --m_unfinished_task_count;
+        return result.release_error();
+    }
+
+    MutexLocker locker(m_mutex);
+    m_task_available.signal();
+    return task;
+}
+
+void ThreadPool::wait_until_idle()
+{
+    VERIFY(s_current_pool != this);
+
+    MutexLocker locker(m_mutex);
+    while (m_unfinished_task_count > 0)
+        m_became_idle.wait();
+}
+
+RefPtr<ThreadPool::Task> ThreadPool::find_task(size_t worker_index)
+{
+    auto take_from = [this](Mutex& mutex, auto take) -> RefPtr<Task> {
+        MutexLocker locker(mutex);
+        auto task = take();
+        if (task)
+            --m_queued_task_count;
+        return task;
+    };
+
+    for (ssize_t priority_index = priority_count - 1; priority_index >= 0; --priority_index) {
+        auto& own_queue = m_workers[worker_index]->queues[priority_index];
+        if (auto task = take_from(m_workers[worker_index]->mutex, [&] { return own_queue.take_last(); }))
+            return task;
+
+        auto& shared_queue = m_shared_queues[priority_index];
+        if (auto task = take_from(m_mutex, [&] { return shared_queue.take_first(); }))
+            return task;
+
+        for (size_t i = 1; i < m_workers.size(); ++i) {
+            auto& victim = *m_workers[(worker_index + i) % m_workers.size()];
+            auto& victim_queue = victim.queues[priority_index];
+            if (auto task = take_from(victim.mutex, [&] { return victim_queue.take_first(); }))
+                return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::run_task(Task& task)
+{
+    auto expected = Task::State::Queued;
+    if (task.m_state.compare_exchange_strong(expected, Task::State::Running)) {
+        task.m_function();
+        task.m_function = nullptr;
+        task.m_state = Task::State::Finished;
+    }
+
+    if (--m_unfinished_task_count == 0) {
+        MutexLocker locker(m_mutex);
+        m_became_idle.broadcast();
+    }
+}
+
+intptr_t ThreadPool::run_worker(size_t worker_index)
+{
+    s_current_pool = this;
+    s_current_worker_index = worker_index;
+
+    while (true) {
+        if (auto task = find_task(worker_index)) {
+            run_task(*task);
+            continue;
+        }
+
+        MutexLocker locker(m_mutex);
+        while (m_queued_task_count == 0 && !m_stopping)
+            m_task_available.wait();
+        if (m_queued_task_count == 0 && m_stopping)
+            return 0;
+    }
+}
+
+}
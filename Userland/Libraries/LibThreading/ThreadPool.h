@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/Array.h>
+#include <AK/Atomic.h>
+#include <AK/AtomicRefCounted.h>
+#include <AK/Function.h>
+#include <AK/NonnullOwnPtr.h>
+#include <AK/Noncopyable.h>
+#include <AK/Vector.h>
+#include <LibThreading/ConditionVariable.h>
+#include <LibThreading/Mutex.h>
+#include <LibThreading/Thread.h>
+
+namespace Threading {
+
+// A fixed set of worker threads that run tasks.
+// Every worker has its own queues. Tasks submitted from outside the pool go to a shared queue, tasks submitted by a
+// running task go to the queue of the worker running it. Workers run their own newest task first, and workers that
+// run out of tasks take the oldest ones from the shared queue and from other workers.
+// Higher priority tasks always start before lower priority ones, as far as the worker picking them can see.
+class ThreadPool {
+    AK_MAKE_NONCOPYABLE(ThreadPool);
+    AK_MAKE_NONMOVABLE(ThreadPool);
+
+public:
+    enum class Priority : u8 {
+        Low,
+        Normal,
+        High,
+    };
+
+    class Task : public AtomicRefCounted<Task> {
+        friend class ThreadPool;
+
+    public:
+        // Prevents the task from starting. Returns false if it already has.
+        bool cancel();
+
+        bool is_canceled() const { return m_state == State::Canceled; }
+        bool is_finished() const { return m_state == State::Finished; }
+
+    private:
+        enum class State : u8 {
+            Queued,
+            Running,
+            Finished,
+            Canceled,
+        };
+
+        explicit Task(Function<void()> function)
+            : m_function(move(function))
+        {
+        }
+
+        Function<void()> m_function;
+        Atomic<State> m_state { State::Queued };
+    };
+
+    // The process-wide pool, with one worker for every online processor.
+    static ThreadPool& the();
+
+    static ErrorOr<NonnullOwnPtr<ThreadPool>> try_create(size_t thread_count, StringView thread_name = "Thread Pool Worker"sv);
+
+    // Waits for all queued tasks to finish.
+    ~ThreadPool();
+
+    ErrorOr<NonnullRefPtr<Task>> submit(Function<void()>, Priority = Priority::Normal);
+
+    // Waits until every submitted task has either finished or been canceled.
+    // Must not be called from a task running on this pool.
+    void wait_until_idle();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+private:
+    static constexpr size_t priority_count = to_underlying(Priority::High) + 1;
+
+    // The thread owning a queue adds and removes tasks at the back, other threads only take them from the front.
+    class TaskQueue {
+    public:
+        bool is_empty() const { return m_head == m_tasks.size(); }
+        ErrorOr<void> try_append(NonnullRefPtr<Task>);
+        RefPtr<Task> take_first();
+        RefPtr<Task> take_last();
+
+    private:
+        Vector<RefPtr<Task>> m_tasks;
+        size_t m_head { 0 };
+    };
+
+    struct Worker {
+        RefPtr<Thread> thread;
+        Mutex mutex;
+        Array<TaskQueue, priority_count> queues;
+    };
+
+    ThreadPool();
+
+    intptr_t run_worker(size_t worker_index);
+    RefPtr<Task> find_task(size_t worker_index);
+    void run_task(Task&);
+
+    Vector<NonnullOwnPtr<Worker>> m_workers;
+
+    // Protects the shared queues and the sleeping and stopping state.
+    Mutex m_mutex;
+    ConditionVariable m_task_available;
+    ConditionVariable m_became_idle;
+    Array<TaskQueue, priority_count> m_shared_queues;
+    bool m_stopping { false };
+
+    // Tasks that are in some queue, and tasks that have been submitted but haven't finished or been dropped yet.
+    Atomic<size_t> m_queued_task_count { 0 };
+    Atomic<size_t> m_unfinished_task_count { 0 };
+};
+
+}
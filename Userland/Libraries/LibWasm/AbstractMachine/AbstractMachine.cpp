@@ -10,9 +10,20 @@
 #include <LibWasm/AbstractMachine/Interpreter.h>
 #include <LibWasm/AbstractMachine/Validator.h>
 #include <LibWasm/Types.h>
+#include <limits.h>
+#include <sys/mman.h>
 
 namespace Wasm {
 
+CompiledFunction const* WasmFunction::compiled_code(Store& store)
+{
+    if (!m_did_try_to_compile) {
+        m_did_try_to_compile = true;
+        m_compiled_code = CompiledFunction::try_compile(store, m_module, m_type, m_code);
+    }
+    return m_compiled_code.ptr();
+}
+
 Optional<FunctionAddress> Store::allocate(ModuleInstance& module, Module::Function const& function)
 {
     FunctionAddress address { m_functions.size() };
@@ -43,7 +54,7 @@ Optional<TableAddress> Store::allocate(TableType const& type)
 Optional<MemoryAddress> Store::allocate(MemoryType const& type)
 {
     MemoryAddress address { m_memories.size() };
-    auto instance = MemoryInstance::create(type);
+    auto instance = MemoryInstance::create(type, m_memory_bounds_checking);
     if (instance.is_error())
         return {};
 
@@ -51,6 +62,78 @@ Optional<MemoryAddress> Store::allocate(MemoryType const& type)
     return address;
 }
 
+MemoryInstance::MemoryInstance(MemoryInstance&& other)
+    : successful_grow_hook(move(other.successful_grow_hook))
+    , m_type(other.m_type)
+    , m_size(exchange(other.m_size, 0))
+    , m_data(move(other.m_data))
+    , m_guarded_region(exchange(other.m_guarded_region, nullptr))
+{
+}
+
+MemoryInstance::~MemoryInstance()
+{
+    if (m_guarded_region)
+        munmap(m_guarded_region, guarded_region_size);
+}
+
+void MemoryInstance::reserve_guarded_region()
+{
+#ifdef AK_ARCH_64_BIT
+    VERIFY(m_size == 0);
+    auto* region = mmap(nullptr, guarded_region_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) {
+        dbgln("LibWasm: Failed to reserve {} bytes for a memory with guard pages, falling back to explicit bounds checks", guarded_region_size);
+        return;
+    }
+    m_guarded_region = static_cast<u8*>(region);
+#endif
+}
+
+bool MemoryInstance::can_skip_bounds_checks() const
+{
+    return has_guard_pages() && m_size % PAGE_SIZE == 0;
+}
+
+bool MemoryInstance::grow(size_t size_to_grow, InhibitGrowCallback inhibit_callback)
+{
+    if (size_to_grow == 0)
+        return true;
+    u64 new_size = m_size + size_to_grow;
+    // Can't grow past 2^16 pages.
+    if (new_size >= Constants::page_size * 65536)
+        return false;
+    if (auto max = m_type.limits().max(); max.has_value()) {
+        if (max.value() * Constants::page_size < new_size)
+            return false;
+    }
+    auto previous_size = m_size;
+    if (has_guard_pages()) {
+        // Only the protection of the reserved pages has to change, and the kernel hands them out zeroed.
+        // NOTE: mprotect() works on host pages, which are usually smaller than wasm pages. Rounding to wasm pages instead
+        //       would make everything up to the next wasm page boundary accessible when instantiation grows a memory to
+        //       fit a data segment.
+        u64 host_page_size = PAGE_SIZE;
+        auto accessible_end = align_up_to(static_cast<u64>(previous_size), host_page_size);
+        auto new_accessible_end = align_up_to(new_size, host_page_size);
+        if (new_accessible_end > accessible_end && mprotect(m_guarded_region + accessible_end, new_accessible_end - accessible_end, PROT_READ | PROT_WRITE) < 0)
+            return false;
+    } else {
+        if (m_data.try_resize(new_size).is_error())
+            return false;
+        // The spec requires that we zero out everything on grow
+        __builtin_memset(m_data.offset_pointer(previous_size), 0, size_to_grow);
+    }
+    m_size = new_size;
+
+    // NOTE: This exists because wasm-js-api wants to execute code after a successful grow,
+    //       See [this issue](https://github.com/WebAssembly/spec/issues/1635) for more details.
+    if (inhibit_callback == InhibitGrowCallback::No && successful_grow_hook)
+        successful_grow_hook();
+
+    return true;
+}
+
 Optional<GlobalAddress> Store::allocate(GlobalType const& type, Value value)
 {
     GlobalAddress address { m_globals.size() };
@@ -355,7 +438,7 @@ InstantiationResult AbstractMachine::instantiate(Module const& module, Vector<Ex
                         }
                         if (instance->size() < data.init.size() + offset)
                             instance->grow(data.init.size() + offset - instance->size());
-                        instance->data().overwrite(offset, data.init.data(), data.init.size());
+                        instance->bytes().overwrite(offset, data.init.data(), data.init.size());
                     }
                 },
                 [&](DataSection::Data::Passive const& passive) {
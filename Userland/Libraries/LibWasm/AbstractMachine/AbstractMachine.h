@@ -12,6 +12,7 @@
 #include <AK/OwnPtr.h>
 #include <AK/Result.h>
 #include <AK/StackInfo.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
 #include <LibWasm/Types.h>
 
 // NOTE: Special case for Wasm::Result.
@@ -326,10 +327,15 @@ public:
     auto& module() const { return m_module; }
     auto& code() const { return m_code; }
 
+    // Compiles the body on first use, returns null if it can't be compiled.
+    CompiledFunction const* compiled_code(Store&);
+
 private:
     FunctionType m_type;
     ModuleInstance const& m_module;
     Module::Function const& m_code;
+    OwnPtr<CompiledFunction> m_compiled_code;
+    bool m_did_try_to_compile { false };
 };
 
 class HostFunction {
@@ -386,52 +392,64 @@ private:
 
 class MemoryInstance {
 public:
-    static ErrorOr<MemoryInstance> create(MemoryType const& type)
+    enum class BoundsChecking {
+        Explicit,
+        // Reserve everything a memory access could possibly reach up front, and leave the part past the current
+        // size inaccessible, so that out-of-bounds accesses fault instead of having to be checked for.
+        // Falls back to explicit checks if the address space can't be reserved.
+        GuardPages,
+    };
+
+    static ErrorOr<MemoryInstance> create(MemoryType const& type, BoundsChecking bounds_checking = BoundsChecking::Explicit)
     {
         MemoryInstance instance { type };
 
+        if (bounds_checking == BoundsChecking::GuardPages)
+            instance.reserve_guarded_region();
+
         if (!instance.grow(type.limits().min() * Constants::page_size))
             return Error::from_string_literal("Failed to grow to requested size");
 
         return { move(instance) };
     }
 
+    MemoryInstance(MemoryInstance&&);
+    ~MemoryInstance();
+
     auto& type() const { return m_type; }
     auto size() const { return m_size; }
-    auto& data() const { return m_data; }
-    auto& data() { return m_data; }
+
+    // The backing buffer of memories without guard pages.
+    ByteBuffer const& data() const
+    {
+        VERIFY(!has_guard_pages());
+        return m_data;
+    }
+    ByteBuffer& data()
+    {
+        VERIFY(!has_guard_pages());
+        return m_data;
+    }
+
+    Bytes bytes() { return has_guard_pages() ? Bytes { m_guarded_region, m_size } : m_data.bytes(); }
+    ReadonlyBytes bytes() const { return has_guard_pages() ? ReadonlyBytes { m_guarded_region, m_size } : m_data.bytes(); }
+
+    // A 32-bit base address plus a 32-bit offset, plus the largest value that can be accessed at once.
+    static constexpr u64 guarded_region_size = 2 * (1ull << 32) + Constants::page_size;
+
+    bool has_guard_pages() const { return m_guarded_region != nullptr; }
+    u8* guarded_region() const { return m_guarded_region; }
+
+    // Accesses past the end only fault if the memory ends on a host page boundary, otherwise the rest of its last
+    // host page is accessible too and accesses still have to be checked explicitly.
+    bool can_skip_bounds_checks() const;
 
     enum class InhibitGrowCallback {
         No,
         Yes,
     };
 
-    bool grow(size_t size_to_grow, InhibitGrowCallback inhibit_callback = InhibitGrowCallback::No)
-    {
-        if (size_to_grow == 0)
-            return true;
-        u64 new_size = m_data.size() + size_to_grow;
-        // Can't grow past 2^16 pages.
-        if (new_size >= Constants::page_size * 65536)
-            return false;
-        if (auto max = m_type.limits().max(); max.has_value()) {
-            if (max.value() * Constants::page_size < new_size)
-                return false;
-        }
-        auto previous_size = m_size;
-        if (m_data.try_resize(new_size).is_error())
-            return false;
-        m_size = new_size;
-        // The spec requires that we zero out everything on grow
-        __builtin_memset(m_data.offset_pointer(previous_size), 0, size_to_grow);
-
-        // NOTE: This exists because wasm-js-api wants to execute code after a successful grow,
-        //       See [this issue](https://github.com/WebAssembly/spec/issues/1635) for more details.
-        if (inhibit_callback == InhibitGrowCallback::No && successful_grow_hook)
-            successful_grow_hook();
-
-        return true;
-    }
+    bool grow(size_t size_to_grow, InhibitGrowCallback inhibit_callback = InhibitGrowCallback::No);
 
     Function<void()> successful_grow_hook;
 
@@ -441,9 +459,12 @@ private:
     {
     }
 
+    void reserve_guarded_region();
+
     MemoryType const& m_type;
     size_t m_size { 0 };
     ByteBuffer m_data;
+    u8* m_guarded_region { nullptr };
 };
 
 class GlobalInstance {
@@ -512,6 +533,8 @@ public:
     Optional<GlobalAddress> allocate(GlobalType const&, Value);
     Optional<ElementAddress> allocate(ValueType const&, Vector<Reference>);
 
+    void set_memory_bounds_checking(MemoryInstance::BoundsChecking bounds_checking) { m_memory_bounds_checking = bounds_checking; }
+
     FunctionInstance* get(FunctionAddress);
     TableInstance* get(TableAddress);
     MemoryInstance* get(MemoryAddress);
@@ -526,6 +549,7 @@ private:
     Vector<GlobalInstance> m_globals;
     Vector<ElementInstance> m_elements;
     Vector<DataInstance> m_datas;
+    MemoryInstance::BoundsChecking m_memory_bounds_checking { MemoryInstance::BoundsChecking::Explicit };
 };
 
 class Label {
@@ -603,6 +627,8 @@ public:
     auto& store() { return m_store; }
 
     void enable_instruction_count_limit() { m_should_limit_instruction_count = true; }
+    // Memories allocated from now on are bounds checked by guard pages (where possible), see MemoryInstance::BoundsChecking.
+    void enable_guard_pages_for_memories() { m_store.set_memory_bounds_checking(MemoryInstance::BoundsChecking::GuardPages); }
 
 private:
     Optional<InstantiationError> allocate_all_initial_phase(Module const&, ModuleInstance&, Vector<ExternValue>&, Vector<Value>& global_values);
@@ -14,6 +14,8 @@
 #include <LibWasm/AbstractMachine/Operators.h>
 #include <LibWasm/Opcode.h>
 #include <LibWasm/Printer/Printer.h>
+#include <setjmp.h>
+#include <signal.h>
 
 namespace Wasm {
 
@@ -106,7 +108,7 @@ void BytecodeInterpreter::load_and_push(Configuration& configuration, Instructio
         return;
     }
     dbgln_if(WASM_TRACE_DEBUG, "load({} : {}) -> stack", instance_address, sizeof(ReadType));
-    auto slice = memory->data().bytes().slice(instance_address, sizeof(ReadType));
+    auto slice = memory->bytes().slice(instance_address, sizeof(ReadType));
     configuration.stack().peek() = Value(static_cast<PushType>(read_value<ReadType>(slice)));
 }
 
@@ -250,7 +252,7 @@ void BytecodeInterpreter::store_to_memory(Configuration& configuration, Instruct
         return;
     }
     dbgln_if(WASM_TRACE_DEBUG, "temporary({}b) -> store({})", data.size(), instance_address);
-    data.copy_to(memory->data().bytes().slice(instance_address, data.size()));
+    data.copy_to(memory->bytes().slice(instance_address, data.size()));
 }
 
 template<typename T>
@@ -526,52 +528,16 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         call_address(configuration, address);
         return;
     }
-    case Instructions::i32_load.value():
-        return load_and_push<i32, i32>(configuration, instruction);
-    case Instructions::i64_load.value():
-        return load_and_push<i64, i64>(configuration, instruction);
-    case Instructions::f32_load.value():
-        return load_and_push<float, float>(configuration, instruction);
-    case Instructions::f64_load.value():
-        return load_and_push<double, double>(configuration, instruction);
-    case Instructions::i32_load8_s.value():
-        return load_and_push<i8, i32>(configuration, instruction);
-    case Instructions::i32_load8_u.value():
-        return load_and_push<u8, i32>(configuration, instruction);
-    case Instructions::i32_load16_s.value():
-        return load_and_push<i16, i32>(configuration, instruction);
-    case Instructions::i32_load16_u.value():
-        return load_and_push<u16, i32>(configuration, instruction);
-    case Instructions::i64_load8_s.value():
-        return load_and_push<i8, i64>(configuration, instruction);
-    case Instructions::i64_load8_u.value():
-        return load_and_push<u8, i64>(configuration, instruction);
-    case Instructions::i64_load16_s.value():
-        return load_and_push<i16, i64>(configuration, instruction);
-    case Instructions::i64_load16_u.value():
-        return load_and_push<u16, i64>(configuration, instruction);
-    case Instructions::i64_load32_s.value():
-        return load_and_push<i32, i64>(configuration, instruction);
-    case Instructions::i64_load32_u.value():
-        return load_and_push<u32, i64>(configuration, instruction);
-    case Instructions::i32_store.value():
-        return pop_and_store<i32, i32>(configuration, instruction);
-    case Instructions::i64_store.value():
-        return pop_and_store<i64, i64>(configuration, instruction);
-    case Instructions::f32_store.value():
-        return pop_and_store<float, float>(configuration, instruction);
-    case Instructions::f64_store.value():
-        return pop_and_store<double, double>(configuration, instruction);
-    case Instructions::i32_store8.value():
-        return pop_and_store<i32, i8>(configuration, instruction);
-    case Instructions::i32_store16.value():
-        return pop_and_store<i32, i16>(configuration, instruction);
-    case Instructions::i64_store8.value():
-        return pop_and_store<i64, i8>(configuration, instruction);
-    case Instructions::i64_store16.value():
-        return pop_and_store<i64, i16>(configuration, instruction);
-    case Instructions::i64_store32.value():
-        return pop_and_store<i64, i32>(configuration, instruction);
+#define M(name, ReadType, PushType) \
+    case Instructions::name.value():  \
+        return load_and_push<ReadType, PushType>(configuration, instruction);
+        ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, PopType, StoreType)  \
+    case Instructions::name.value(): \
+        return pop_and_store<PopType, StoreType>(configuration, instruction);
+        ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
     case Instructions::local_tee.value(): {
         auto& entry = configuration.stack().peek();
         auto value = entry.get<Value>();
@@ -627,7 +593,7 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto value = configuration.stack().pop().get<Value>().to<i32>().value();
         auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
 
-        TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->data().size());
+        TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->size());
 
         if (count == 0)
             return;
@@ -650,8 +616,8 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         auto source_offset = configuration.stack().pop().get<Value>().to<i32>().value();
         auto destination_offset = configuration.stack().pop().get<Value>().to<i32>().value();
 
-        TRAP_IF_NOT(static_cast<size_t>(source_offset + count) <= instance->data().size());
-        TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->data().size());
+        TRAP_IF_NOT(static_cast<size_t>(source_offset + count) <= instance->size());
+        TRAP_IF_NOT(static_cast<size_t>(destination_offset + count) <= instance->size());
 
         if (count == 0)
             return;
@@ -663,12 +629,12 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
 
         if (destination_offset <= source_offset) {
             for (auto i = 0; i < count; ++i) {
-                auto value = instance->data()[source_offset + i];
+                auto value = instance->bytes()[source_offset + i];
                 store_to_memory(configuration, synthetic_store_instruction, { &value, sizeof(value) }, destination_offset + i);
             }
         } else {
             for (auto i = count - 1; i >= 0; --i) {
-                auto value = instance->data()[source_offset + i];
+                auto value = instance->bytes()[source_offset + i];
                 store_to_memory(configuration, synthetic_store_instruction, { &value, sizeof(value) }, destination_offset + i);
             }
         }
@@ -744,278 +710,16 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
         configuration.stack().peek() = value.value() != 0 ? move(lhs) : move(rhs);
         return;
     }
-    case Instructions::i32_eqz.value():
-        return unary_operation<i32, i32, Operators::EqualsZero>(configuration);
-    case Instructions::i32_eq.value():
-        return binary_numeric_operation<i32, i32, Operators::Equals>(configuration);
-    case Instructions::i32_ne.value():
-        return binary_numeric_operation<i32, i32, Operators::NotEquals>(configuration);
-    case Instructions::i32_lts.value():
-        return binary_numeric_operation<i32, i32, Operators::LessThan>(configuration);
-    case Instructions::i32_ltu.value():
-        return binary_numeric_operation<u32, i32, Operators::LessThan>(configuration);
-    case Instructions::i32_gts.value():
-        return binary_numeric_operation<i32, i32, Operators::GreaterThan>(configuration);
-    case Instructions::i32_gtu.value():
-        return binary_numeric_operation<u32, i32, Operators::GreaterThan>(configuration);
-    case Instructions::i32_les.value():
-        return binary_numeric_operation<i32, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::i32_leu.value():
-        return binary_numeric_operation<u32, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::i32_ges.value():
-        return binary_numeric_operation<i32, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::i32_geu.value():
-        return binary_numeric_operation<u32, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::i64_eqz.value():
-        return unary_operation<i64, i32, Operators::EqualsZero>(configuration);
-    case Instructions::i64_eq.value():
-        return binary_numeric_operation<i64, i32, Operators::Equals>(configuration);
-    case Instructions::i64_ne.value():
-        return binary_numeric_operation<i64, i32, Operators::NotEquals>(configuration);
-    case Instructions::i64_lts.value():
-        return binary_numeric_operation<i64, i32, Operators::LessThan>(configuration);
-    case Instructions::i64_ltu.value():
-        return binary_numeric_operation<u64, i32, Operators::LessThan>(configuration);
-    case Instructions::i64_gts.value():
-        return binary_numeric_operation<i64, i32, Operators::GreaterThan>(configuration);
-    case Instructions::i64_gtu.value():
-        return binary_numeric_operation<u64, i32, Operators::GreaterThan>(configuration);
-    case Instructions::i64_les.value():
-        return binary_numeric_operation<i64, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::i64_leu.value():
-        return binary_numeric_operation<u64, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::i64_ges.value():
-        return binary_numeric_operation<i64, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::i64_geu.value():
-        return binary_numeric_operation<u64, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::f32_eq.value():
-        return binary_numeric_operation<float, i32, Operators::Equals>(configuration);
-    case Instructions::f32_ne.value():
-        return binary_numeric_operation<float, i32, Operators::NotEquals>(configuration);
-    case Instructions::f32_lt.value():
-        return binary_numeric_operation<float, i32, Operators::LessThan>(configuration);
-    case Instructions::f32_gt.value():
-        return binary_numeric_operation<float, i32, Operators::GreaterThan>(configuration);
-    case Instructions::f32_le.value():
-        return binary_numeric_operation<float, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::f32_ge.value():
-        return binary_numeric_operation<float, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::f64_eq.value():
-        return binary_numeric_operation<double, i32, Operators::Equals>(configuration);
-    case Instructions::f64_ne.value():
-        return binary_numeric_operation<double, i32, Operators::NotEquals>(configuration);
-    case Instructions::f64_lt.value():
-        return binary_numeric_operation<double, i32, Operators::LessThan>(configuration);
-    case Instructions::f64_gt.value():
-        return binary_numeric_operation<double, i32, Operators::GreaterThan>(configuration);
-    case Instructions::f64_le.value():
-        return binary_numeric_operation<double, i32, Operators::LessThanOrEquals>(configuration);
-    case Instructions::f64_ge.value():
-        return binary_numeric_operation<double, i32, Operators::GreaterThanOrEquals>(configuration);
-    case Instructions::i32_clz.value():
-        return unary_operation<i32, i32, Operators::CountLeadingZeros>(configuration);
-    case Instructions::i32_ctz.value():
-        return unary_operation<i32, i32, Operators::CountTrailingZeros>(configuration);
-    case Instructions::i32_popcnt.value():
-        return unary_operation<i32, i32, Operators::PopCount>(configuration);
-    case Instructions::i32_add.value():
-        return binary_numeric_operation<u32, i32, Operators::Add>(configuration);
-    case Instructions::i32_sub.value():
-        return binary_numeric_operation<u32, i32, Operators::Subtract>(configuration);
-    case Instructions::i32_mul.value():
-        return binary_numeric_operation<u32, i32, Operators::Multiply>(configuration);
-    case Instructions::i32_divs.value():
-        return binary_numeric_operation<i32, i32, Operators::Divide>(configuration);
-    case Instructions::i32_divu.value():
-        return binary_numeric_operation<u32, i32, Operators::Divide>(configuration);
-    case Instructions::i32_rems.value():
-        return binary_numeric_operation<i32, i32, Operators::Modulo>(configuration);
-    case Instructions::i32_remu.value():
-        return binary_numeric_operation<u32, i32, Operators::Modulo>(configuration);
-    case Instructions::i32_and.value():
-        return binary_numeric_operation<i32, i32, Operators::BitAnd>(configuration);
-    case Instructions::i32_or.value():
-        return binary_numeric_operation<i32, i32, Operators::BitOr>(configuration);
-    case Instructions::i32_xor.value():
-        return binary_numeric_operation<i32, i32, Operators::BitXor>(configuration);
-    case Instructions::i32_shl.value():
-        return binary_numeric_operation<u32, i32, Operators::BitShiftLeft>(configuration);
-    case Instructions::i32_shrs.value():
-        return binary_numeric_operation<i32, i32, Operators::BitShiftRight>(configuration);
-    case Instructions::i32_shru.value():
-        return binary_numeric_operation<u32, i32, Operators::BitShiftRight>(configuration);
-    case Instructions::i32_rotl.value():
-        return binary_numeric_operation<u32, i32, Operators::BitRotateLeft>(configuration);
-    case Instructions::i32_rotr.value():
-        return binary_numeric_operation<u32, i32, Operators::BitRotateRight>(configuration);
-    case Instructions::i64_clz.value():
-        return unary_operation<i64, i64, Operators::CountLeadingZeros>(configuration);
-    case Instructions::i64_ctz.value():
-        return unary_operation<i64, i64, Operators::CountTrailingZeros>(configuration);
-    case Instructions::i64_popcnt.value():
-        return unary_operation<i64, i64, Operators::PopCount>(configuration);
-    case Instructions::i64_add.value():
-        return binary_numeric_operation<u64, i64, Operators::Add>(configuration);
-    case Instructions::i64_sub.value():
-        return binary_numeric_operation<u64, i64, Operators::Subtract>(configuration);
-    case Instructions::i64_mul.value():
-        return binary_numeric_operation<u64, i64, Operators::Multiply>(configuration);
-    case Instructions::i64_divs.value():
-        return binary_numeric_operation<i64, i64, Operators::Divide>(configuration);
-    case Instructions::i64_divu.value():
-        return binary_numeric_operation<u64, i64, Operators::Divide>(configuration);
-    case Instructions::i64_rems.value():
-        return binary_numeric_operation<i64, i64, Operators::Modulo>(configuration);
-    case Instructions::i64_remu.value():
-        return binary_numeric_operation<u64, i64, Operators::Modulo>(configuration);
-    case Instructions::i64_and.value():
-        return binary_numeric_operation<i64, i64, Operators::BitAnd>(configuration);
-    case Instructions::i64_or.value():
-        return binary_numeric_operation<i64, i64, Operators::BitOr>(configuration);
-    case Instructions::i64_xor.value():
-        return binary_numeric_operation<i64, i64, Operators::BitXor>(configuration);
-    case Instructions::i64_shl.value():
-        return binary_numeric_operation<u64, i64, Operators::BitShiftLeft>(configuration);
-    case Instructions::i64_shrs.value():
-        return binary_numeric_operation<i64, i64, Operators::BitShiftRight>(configuration);
-    case Instructions::i64_shru.value():
-        return binary_numeric_operation<u64, i64, Operators::BitShiftRight>(configuration);
-    case Instructions::i64_rotl.value():
-        return binary_numeric_operation<u64, i64, Operators::BitRotateLeft>(configuration);
-    case Instructions::i64_rotr.value():
-        return binary_numeric_operation<u64, i64, Operators::BitRotateRight>(configuration);
-    case Instructions::f32_abs.value():
-        return unary_operation<float, float, Operators::Absolute>(configuration);
-    case Instructions::f32_neg.value():
-        return unary_operation<float, float, Operators::Negate>(configuration);
-    case Instructions::f32_ceil.value():
-        return unary_operation<float, float, Operators::Ceil>(configuration);
-    case Instructions::f32_floor.value():
-        return unary_operation<float, float, Operators::Floor>(configuration);
-    case Instructions::f32_trunc.value():
-        return unary_operation<float, float, Operators::Truncate>(configuration);
-    case Instructions::f32_nearest.value():
-        return unary_operation<float, float, Operators::NearbyIntegral>(configuration);
-    case Instructions::f32_sqrt.value():
-        return unary_operation<float, float, Operators::SquareRoot>(configuration);
-    case Instructions::f32_add.value():
-        return binary_numeric_operation<float, float, Operators::Add>(configuration);
-    case Instructions::f32_sub.value():
-        return binary_numeric_operation<float, float, Operators::Subtract>(configuration);
-    case Instructions::f32_mul.value():
-        return binary_numeric_operation<float, float, Operators::Multiply>(configuration);
-    case Instructions::f32_div.value():
-        return binary_numeric_operation<float, float, Operators::Divide>(configuration);
-    case Instructions::f32_min.value():
-        return binary_numeric_operation<float, float, Operators::Minimum>(configuration);
-    case Instructions::f32_max.value():
-        return binary_numeric_operation<float, float, Operators::Maximum>(configuration);
-    case Instructions::f32_copysign.value():
-        return binary_numeric_operation<float, float, Operators::CopySign>(configuration);
-    case Instructions::f64_abs.value():
-        return unary_operation<double, double, Operators::Absolute>(configuration);
-    case Instructions::f64_neg.value():
-        return unary_operation<double, double, Operators::Negate>(configuration);
-    case Instructions::f64_ceil.value():
-        return unary_operation<double, double, Operators::Ceil>(configuration);
-    case Instructions::f64_floor.value():
-        return unary_operation<double, double, Operators::Floor>(configuration);
-    case Instructions::f64_trunc.value():
-        return unary_operation<double, double, Operators::Truncate>(configuration);
-    case Instructions::f64_nearest.value():
-        return unary_operation<double, double, Operators::NearbyIntegral>(configuration);
-    case Instructions::f64_sqrt.value():
-        return unary_operation<double, double, Operators::SquareRoot>(configuration);
-    case Instructions::f64_add.value():
-        return binary_numeric_operation<double, double, Operators::Add>(configuration);
-    case Instructions::f64_sub.value():
-        return binary_numeric_operation<double, double, Operators::Subtract>(configuration);
-    case Instructions::f64_mul.value():
-        return binary_numeric_operation<double, double, Operators::Multiply>(configuration);
-    case Instructions::f64_div.value():
-        return binary_numeric_operation<double, double, Operators::Divide>(configuration);
-    case Instructions::f64_min.value():
-        return binary_numeric_operation<double, double, Operators::Minimum>(configuration);
-    case Instructions::f64_max.value():
-        return binary_numeric_operation<double, double, Operators::Maximum>(configuration);
-    case Instructions::f64_copysign.value():
-        return binary_numeric_operation<double, double, Operators::CopySign>(configuration);
-    case Instructions::i32_wrap_i64.value():
-        return unary_operation<i64, i32, Operators::Wrap<i32>>(configuration);
-    case Instructions::i32_trunc_sf32.value():
-        return unary_operation<float, i32, Operators::CheckedTruncate<i32>>(configuration);
-    case Instructions::i32_trunc_uf32.value():
-        return unary_operation<float, i32, Operators::CheckedTruncate<u32>>(configuration);
-    case Instructions::i32_trunc_sf64.value():
-        return unary_operation<double, i32, Operators::CheckedTruncate<i32>>(configuration);
-    case Instructions::i32_trunc_uf64.value():
-        return unary_operation<double, i32, Operators::CheckedTruncate<u32>>(configuration);
-    case Instructions::i64_trunc_sf32.value():
-        return unary_operation<float, i64, Operators::CheckedTruncate<i64>>(configuration);
-    case Instructions::i64_trunc_uf32.value():
-        return unary_operation<float, i64, Operators::CheckedTruncate<u64>>(configuration);
-    case Instructions::i64_trunc_sf64.value():
-        return unary_operation<double, i64, Operators::CheckedTruncate<i64>>(configuration);
-    case Instructions::i64_trunc_uf64.value():
-        return unary_operation<double, i64, Operators::CheckedTruncate<u64>>(configuration);
-    case Instructions::i64_extend_si32.value():
-        return unary_operation<i32, i64, Operators::Extend<i64>>(configuration);
-    case Instructions::i64_extend_ui32.value():
-        return unary_operation<u32, i64, Operators::Extend<i64>>(configuration);
-    case Instructions::f32_convert_si32.value():
-        return unary_operation<i32, float, Operators::Convert<float>>(configuration);
-    case Instructions::f32_convert_ui32.value():
-        return unary_operation<u32, float, Operators::Convert<float>>(configuration);
-    case Instructions::f32_convert_si64.value():
-        return unary_operation<i64, float, Operators::Convert<float>>(configuration);
-    case Instructions::f32_convert_ui64.value():
-        return unary_operation<u64, float, Operators::Convert<float>>(configuration);
-    case Instructions::f32_demote_f64.value():
-        return unary_operation<double, float, Operators::Demote>(configuration);
-    case Instructions::f64_convert_si32.value():
-        return unary_operation<i32, double, Operators::Convert<double>>(configuration);
-    case Instructions::f64_convert_ui32.value():
-        return unary_operation<u32, double, Operators::Convert<double>>(configuration);
-    case Instructions::f64_convert_si64.value():
-        return unary_operation<i64, double, Operators::Convert<double>>(configuration);
-    case Instructions::f64_convert_ui64.value():
-        return unary_operation<u64, double, Operators::Convert<double>>(configuration);
-    case Instructions::f64_promote_f32.value():
-        return unary_operation<float, double, Operators::Promote>(configuration);
-    case Instructions::i32_reinterpret_f32.value():
-        return unary_operation<float, i32, Operators::Reinterpret<i32>>(configuration);
-    case Instructions::i64_reinterpret_f64.value():
-        return unary_operation<double, i64, Operators::Reinterpret<i64>>(configuration);
-    case Instructions::f32_reinterpret_i32.value():
-        return unary_operation<i32, float, Operators::Reinterpret<float>>(configuration);
-    case Instructions::f64_reinterpret_i64.value():
-        return unary_operation<i64, double, Operators::Reinterpret<double>>(configuration);
-    case Instructions::i32_extend8_s.value():
-        return unary_operation<i32, i32, Operators::SignExtend<i8>>(configuration);
-    case Instructions::i32_extend16_s.value():
-        return unary_operation<i32, i32, Operators::SignExtend<i16>>(configuration);
-    case Instructions::i64_extend8_s.value():
-        return unary_operation<i64, i64, Operators::SignExtend<i8>>(configuration);
-    case Instructions::i64_extend16_s.value():
-        return unary_operation<i64, i64, Operators::SignExtend<i16>>(configuration);
-    case Instructions::i64_extend32_s.value():
-        return unary_operation<i64, i64, Operators::SignExtend<i32>>(configuration);
-    case Instructions::i32_trunc_sat_f32_s.value():
-        return unary_operation<float, i32, Operators::SaturatingTruncate<i32>>(configuration);
-    case Instructions::i32_trunc_sat_f32_u.value():
-        return unary_operation<float, i32, Operators::SaturatingTruncate<u32>>(configuration);
-    case Instructions::i32_trunc_sat_f64_s.value():
-        return unary_operation<double, i32, Operators::SaturatingTruncate<i32>>(configuration);
-    case Instructions::i32_trunc_sat_f64_u.value():
-        return unary_operation<double, i32, Operators::SaturatingTruncate<u32>>(configuration);
-    case Instructions::i64_trunc_sat_f32_s.value():
-        return unary_operation<float, i64, Operators::SaturatingTruncate<i64>>(configuration);
-    case Instructions::i64_trunc_sat_f32_u.value():
-        return unary_operation<float, i64, Operators::SaturatingTruncate<u64>>(configuration);
-    case Instructions::i64_trunc_sat_f64_s.value():
-        return unary_operation<double, i64, Operators::SaturatingTruncate<i64>>(configuration);
-    case Instructions::i64_trunc_sat_f64_u.value():
-        return unary_operation<double, i64, Operators::SaturatingTruncate<u64>>(configuration);
+#define M(name, PopType, PushType, Operator) \
+    case Instructions::name.value():          \
+        return unary_operation<PopType, PushType, Operator>(configuration);
+        ENUMERATE_WASM_UNARY_NUMERIC_OPERATIONS(M)
+#undef M
+#define M(name, PopType, PushType, Operator) \
+    case Instructions::name.value():          \
+        return binary_numeric_operation<PopType, PushType, Operator>(configuration);
+        ENUMERATE_WASM_BINARY_NUMERIC_OPERATIONS(M)
+#undef M
     case Instructions::table_init.value():
     case Instructions::elem_drop.value():
     case Instructions::table_copy.value():
@@ -1030,6 +734,443 @@ void BytecodeInterpreter::interpret(Configuration& configuration, InstructionPoi
     }
 }
 
+template<typename T>
+ALWAYS_INLINE static T from_slot(u64 slot)
+{
+    if constexpr (sizeof(T) == sizeof(u32))
+        return bit_cast<T>(static_cast<u32>(slot));
+    else
+        return bit_cast<T>(slot);
+}
+
+template<typename T>
+ALWAYS_INLINE static u64 to_slot(T value)
+{
+    if constexpr (sizeof(T) == sizeof(u32))
+        return bit_cast<u32>(value);
+    else
+        return bit_cast<u64>(value);
+}
+
+static u64 value_to_slot(Value const& value)
+{
+    return value.value().visit(
+        [](Reference const&) -> u64 { VERIFY_NOT_REACHED(); },
+        [](auto number) { return to_slot(number); });
+}
+
+static Value slot_to_value(u64 slot, ValueType const& type)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+        return Value(from_slot<i32>(slot));
+    case ValueType::I64:
+        return Value(from_slot<i64>(slot));
+    case ValueType::F32:
+        return Value(from_slot<float>(slot));
+    case ValueType::F64:
+        return Value(from_slot<double>(slot));
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+template<size_t size>
+using RawMemoryValue = Conditional<size == 1, u8, Conditional<size == 2, u16, Conditional<size == 4, u32, u64>>>;
+
+// Compiled code doesn't check the accesses to memories with guard pages, it lets them fault instead. The fault handler
+// jumps back out to the outermost compiled frame with such a memory, which then traps. Only compiled frames (which
+// have nothing to clean up) can be on the stack above that point, as anything that re-enters the interpreter through
+// Configuration::call() starts over with its own recovery point.
+static thread_local sigjmp_buf* s_guard_page_fault_recovery_point { nullptr };
+static thread_local u8* s_current_guarded_region { nullptr };
+static struct sigaction s_previous_sigsegv_action;
+static struct sigaction s_previous_sigbus_action;
+
+static void handle_guard_page_fault(int signal, siginfo_t* info, void* context)
+{
+    auto address = bit_cast<FlatPtr>(info->si_addr);
+    auto region = bit_cast<FlatPtr>(s_current_guarded_region);
+    if (s_guard_page_fault_recovery_point && region && address - region < MemoryInstance::guarded_region_size)
+        siglongjmp(*s_guard_page_fault_recovery_point, 1);
+
+    // Not ours, so pass it on to whoever was there before. We stay installed, later guard page faults are still ours.
+    auto const& previous_action = signal == SIGSEGV ? s_previous_sigsegv_action : s_previous_sigbus_action;
+    if (previous_action.sa_flags & SA_SIGINFO) {
+        previous_action.sa_sigaction(signal, info, context);
+        return;
+    }
+    if (previous_action.sa_handler != SIG_DFL && previous_action.sa_handler != SIG_IGN) {
+        previous_action.sa_handler(signal);
+        return;
+    }
+
+    // Nobody handles it (ignoring it would just fault forever), the faulting access will happen again and kill us.
+    ::signal(signal, SIG_DFL);
+}
+
+static void install_guard_page_fault_handler()
+{
+    static bool installed = [] {
+        struct sigaction action {};
+        action.sa_sigaction = handle_guard_page_fault;
+        // The handler never returns for our own faults, so the signal must not stay blocked.
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGSEGV, &action, &s_previous_sigsegv_action);
+        sigaction(SIGBUS, &action, &s_previous_sigbus_action);
+        return true;
+    }();
+    (void)installed;
+}
+
+Optional<Result> BytecodeInterpreter::try_execute_compiled(Configuration& configuration, WasmFunction& function, Vector<Value>& arguments)
+{
+    auto const* compiled = function.compiled_code(configuration.store());
+    if (!compiled || arguments.size() != compiled->parameter_count())
+        return {};
+
+    m_trap = Empty {};
+    auto frame_base = m_compiled_frame_slots.size();
+    m_compiled_frame_slots.resize(frame_base + compiled->frame_size());
+    for (size_t i = 0; i < arguments.size(); ++i)
+        m_compiled_frame_slots[frame_base + i] = value_to_slot(arguments[i]);
+
+    enter_compiled_frame(*compiled, frame_base);
+    auto* previous_recovery_point = exchange(s_guard_page_fault_recovery_point, nullptr);
+    execute_compiled(configuration, function, *compiled, frame_base);
+    s_guard_page_fault_recovery_point = previous_recovery_point;
+
+    Optional<Result> result;
+    if (did_trap()) {
+        result = Result { Trap { trap_reason() } };
+    } else {
+        // Just like Configuration::execute(), this returns the results in reverse order.
+        auto& result_types = function.type().results();
+        Vector<Value> results;
+        results.ensure_capacity(result_types.size());
+        for (size_t i = result_types.size(); i > 0; --i)
+            results.unchecked_append(slot_to_value(m_compiled_frame_slots[frame_base + i - 1], result_types[i - 1]));
+        result = Result { move(results) };
+    }
+    m_compiled_frame_slots.shrink(frame_base, true);
+    return result;
+}
+
+// Expects the arguments to be in place already.
+void BytecodeInterpreter::enter_compiled_frame(CompiledFunction const& compiled, size_t frame_base)
+{
+    auto frame_end = frame_base + compiled.frame_size();
+    if (m_compiled_frame_slots.size() < frame_end)
+        m_compiled_frame_slots.resize(frame_end);
+
+    auto* slots = m_compiled_frame_slots.data() + frame_base;
+    __builtin_memset(slots + compiled.parameter_count(), 0, (compiled.local_count() - compiled.parameter_count()) * sizeof(u64));
+    if (!compiled.constants().is_empty())
+        __builtin_memcpy(slots + compiled.local_count(), compiled.constants().data(), compiled.constants().size() * sizeof(u64));
+}
+
+bool BytecodeInterpreter::call_from_compiled_code(Configuration& configuration, FunctionAddress address, size_t arguments_base)
+{
+    if (m_stack_info.size_free() < Constants::minimum_stack_space_to_keep_free) {
+        m_trap = Trap { "Call stack exhausted" };
+        return false;
+    }
+
+    auto* instance = configuration.store().get(address);
+    if (!instance) {
+        m_trap = Trap { "Call to nonexistent function" };
+        return false;
+    }
+    if (auto* function = instance->get_pointer<WasmFunction>()) {
+        if (auto const* compiled = function->compiled_code(configuration.store())) {
+            enter_compiled_frame(*compiled, arguments_base);
+            execute_compiled(configuration, *function, *compiled, arguments_base);
+            return !did_trap();
+        }
+    }
+
+    // Everything else goes through the stack-based interpreter (or the host).
+    auto type = instance->visit([](auto const& function) { return function.type(); });
+    Vector<Value> arguments;
+    arguments.ensure_capacity(type.parameters().size());
+    for (size_t i = 0; i < type.parameters().size(); ++i)
+        arguments.unchecked_append(slot_to_value(m_compiled_frame_slots[arguments_base + i], type.parameters()[i]));
+
+    Result result { Trap { ""sv } };
+    {
+        CallFrameHandle handle { *this, configuration };
+        result = configuration.call(*this, address, move(arguments));
+    }
+
+    if (result.is_trap()) {
+        m_trap = move(result.trap());
+        return false;
+    }
+    if (result.is_completion()) {
+        m_trap = move(result.completion());
+        return false;
+    }
+
+    auto& values = result.values();
+    if (values.size() != type.results().size()) {
+        m_trap = Trap { "Unexpected number of results from call" };
+        return false;
+    }
+    for (size_t i = 0; i < values.size(); ++i)
+        m_compiled_frame_slots[arguments_base + i] = value_to_slot(values[values.size() - i - 1]);
+    return true;
+}
+
+template<typename PushType, typename T>
+ALWAYS_INLINE bool BytecodeInterpreter::store_compiled_result(u64& destination, T call_result)
+{
+    PushType result;
+    if constexpr (IsSpecializationOf<T, AK::Result>) {
+        if (call_result.is_error()) {
+            m_trap = Trap { call_result.error() };
+            return false;
+        }
+        result = call_result.release_value();
+    } else {
+        result = call_result;
+    }
+    destination = to_slot(result);
+    return true;
+}
+
+template<typename ReadType, typename PushType, bool memory_has_guard_pages>
+ALWAYS_INLINE bool BytecodeInterpreter::load_from_compiled_memory(MemoryInstance const& memory, u8 const* memory_base, u64& destination, u64 base, u64 offset)
+{
+    u64 address = static_cast<u64>(from_slot<u32>(base)) + offset;
+    if (!memory_has_guard_pages && address + sizeof(ReadType) > memory.size()) {
+        m_trap = Trap { "Memory access out of bounds" };
+        return false;
+    }
+    RawMemoryValue<sizeof(ReadType)> raw_value;
+    __builtin_memcpy(&raw_value, memory_base + address, sizeof(raw_value));
+    auto value = bit_cast<ReadType>(AK::convert_between_host_and_little_endian(raw_value));
+    destination = to_slot(static_cast<PushType>(value));
+    return true;
+}
+
+template<typename PopType, typename StoreType, bool memory_has_guard_pages>
+ALWAYS_INLINE bool BytecodeInterpreter::store_to_compiled_memory(MemoryInstance const& memory, u8* memory_base, u64 base, u64 value, u64 offset)
+{
+    u64 address = static_cast<u64>(from_slot<u32>(base)) + offset;
+    if (!memory_has_guard_pages && address + sizeof(StoreType) > memory.size()) {
+        m_trap = Trap { "Memory access out of bounds" };
+        return false;
+    }
+    auto raw_value = AK::convert_between_host_and_little_endian(bit_cast<RawMemoryValue<sizeof(StoreType)>>(static_cast<StoreType>(from_slot<PopType>(value))));
+    __builtin_memcpy(memory_base + address, &raw_value, sizeof(raw_value));
+    return true;
+}
+
+void BytecodeInterpreter::execute_compiled(Configuration& configuration, WasmFunction const& function, CompiledFunction const& compiled, size_t frame_base)
+{
+    auto& module = function.module();
+    auto* memory = module.memories().is_empty() ? nullptr : configuration.store().get(module.memories().first());
+    if (!memory || !memory->can_skip_bounds_checks())
+        return execute_compiled_instructions<false>(configuration, function, compiled, frame_base);
+
+    install_guard_page_fault_handler();
+    auto* previous_guarded_region = exchange(s_current_guarded_region, memory->guarded_region());
+    if (s_guard_page_fault_recovery_point) {
+        execute_compiled_instructions<true>(configuration, function, compiled, frame_base);
+        s_current_guarded_region = previous_guarded_region;
+        return;
+    }
+
+    sigjmp_buf recovery_point;
+    if (sigsetjmp(recovery_point, 0) != 0) {
+        s_guard_page_fault_recovery_point = nullptr;
+        s_current_guarded_region = previous_guarded_region;
+        m_trap = Trap { "Memory access out of bounds" };
+        return;
+    }
+    s_guard_page_fault_recovery_point = &recovery_point;
+    execute_compiled_instructions<true>(configuration, function, compiled, frame_base);
+    s_guard_page_fault_recovery_point = nullptr;
+    s_current_guarded_region = previous_guarded_region;
+}
+
+template<bool memory_has_guard_pages>
+void BytecodeInterpreter::execute_compiled_instructions(Configuration& configuration, WasmFunction const& function, CompiledFunction const& compiled, size_t frame_base)
+{
+    auto& module = function.module();
+    auto const* instructions = compiled.instructions().data();
+    auto* slots = m_compiled_frame_slots.data() + frame_base;
+
+    MemoryInstance* memory = nullptr;
+    u8* memory_base = nullptr;
+    auto find_memory = [&] {
+        if (module.memories().is_empty())
+            return;
+        memory = configuration.store().get(module.memories().first());
+        memory_base = memory->bytes().data();
+    };
+    find_memory();
+
+    auto const should_limit_instruction_count = configuration.should_limit_instruction_count();
+    u64 executed_instructions = 0;
+
+    size_t ip = 0;
+    for (;;) {
+        if (should_limit_instruction_count) {
+            if (executed_instructions++ >= Constants::max_allowed_executed_instructions_per_call) [[unlikely]] {
+                m_trap = Trap { "Exceeded maximum allowed number of instructions" };
+                return;
+            }
+        }
+        auto const& instruction = instructions[ip++];
+        switch (instruction.opcode) {
+        case CompiledOpcode::copy:
+            slots[instruction.destination] = slots[instruction.lhs];
+            break;
+        case CompiledOpcode::jump:
+            ip = instruction.immediate;
+            break;
+        case CompiledOpcode::jump_if_zero:
+            if (from_slot<u32>(slots[instruction.lhs]) == 0)
+                ip = instruction.immediate;
+            break;
+        case CompiledOpcode::jump_if_not_zero:
+            if (from_slot<u32>(slots[instruction.lhs]) != 0)
+                ip = instruction.immediate;
+            break;
+#define M(name, opposite, PopType, Operator)                                                                     \
+    case CompiledOpcode::jump_if_##name:                                                                         \
+        if (Operator {}(from_slot<PopType>(slots[instruction.lhs]), from_slot<PopType>(slots[instruction.rhs]))) \
+            ip = instruction.immediate;                                                                          \
+        break;
+            ENUMERATE_WASM_FUSABLE_COMPARISONS(M)
+#undef M
+        case CompiledOpcode::branch_table: {
+            auto index = min(from_slot<u32>(slots[instruction.lhs]), instruction.rhs);
+            ip = compiled.branch_table_targets()[instruction.immediate + index];
+            break;
+        }
+        case CompiledOpcode::return_:
+            return;
+        case CompiledOpcode::unreachable:
+            m_trap = Trap { "Unreachable" };
+            return;
+        case CompiledOpcode::call:
+        case CompiledOpcode::call_indirect: {
+            FunctionAddress address;
+            if (instruction.opcode == CompiledOpcode::call) {
+                address = module.functions()[instruction.immediate];
+            } else {
+                auto* table = configuration.store().get(module.tables()[instruction.rhs]);
+                auto index = from_slot<u32>(slots[instruction.lhs]);
+                if (!table || index >= table->elements().size()) {
+                    m_trap = Trap { "Indirect call to an element outside of the table" };
+                    return;
+                }
+                auto& element = table->elements()[index];
+                if (!element.has_value() || !element->ref().has<Reference::Func>()) {
+                    m_trap = Trap { "Indirect call to a null element" };
+                    return;
+                }
+                address = element->ref().get<Reference::Func>().address;
+                auto* callee = configuration.store().get(address);
+                if (!callee) {
+                    m_trap = Trap { "Indirect call to nonexistent function" };
+                    return;
+                }
+                auto& expected_type = module.types()[instruction.immediate];
+                auto matches_expected_type = callee->visit([&](auto const& function) {
+                    return function.type().parameters() == expected_type.parameters() && function.type().results() == expected_type.results();
+                });
+                if (!matches_expected_type) {
+                    m_trap = Trap { "Indirect call type mismatch" };
+                    return;
+                }
+            }
+            if (!call_from_compiled_code(configuration, address, frame_base + instruction.destination))
+                return;
+            // The callee may have grown the slots or allocated things in the store.
+            slots = m_compiled_frame_slots.data() + frame_base;
+            find_memory();
+            break;
+        }
+        case CompiledOpcode::select:
+            slots[instruction.destination] = from_slot<u32>(slots[instruction.immediate]) != 0 ? slots[instruction.lhs] : slots[instruction.rhs];
+            break;
+        case CompiledOpcode::global_get: {
+            auto* global = configuration.store().get(module.globals()[instruction.immediate]);
+            slots[instruction.destination] = value_to_slot(global->value());
+            break;
+        }
+        case CompiledOpcode::global_set: {
+            auto* global = configuration.store().get(module.globals()[instruction.immediate]);
+            global->set_value(slot_to_value(slots[instruction.lhs], global->type().type()));
+            break;
+        }
+        case CompiledOpcode::memory_size:
+            slots[instruction.destination] = to_slot(static_cast<i32>(memory->size() / Constants::page_size));
+            break;
+        case CompiledOpcode::memory_grow: {
+            auto old_pages = static_cast<i32>(memory->size() / Constants::page_size);
+            auto new_pages = static_cast<u64>(from_slot<u32>(slots[instruction.lhs]));
+            auto grew = memory->grow(new_pages * Constants::page_size);
+            slots[instruction.destination] = to_slot(grew ? old_pages : -1);
+            memory_base = memory->bytes().data();
+            break;
+        }
+        case CompiledOpcode::memory_fill:
+        case CompiledOpcode::memory_copy: {
+            auto destination = static_cast<u64>(from_slot<u32>(slots[instruction.destination]));
+            auto count = static_cast<u64>(from_slot<u32>(slots[instruction.rhs]));
+            if (destination + count > memory->size()) {
+                m_trap = Trap { "Memory access out of bounds" };
+                return;
+            }
+            if (instruction.opcode == CompiledOpcode::memory_fill) {
+                __builtin_memset(memory_base + destination, static_cast<u8>(slots[instruction.lhs]), count);
+                break;
+            }
+            auto source = static_cast<u64>(from_slot<u32>(slots[instruction.lhs]));
+            if (source + count > memory->size()) {
+                m_trap = Trap { "Memory access out of bounds" };
+                return;
+            }
+            __builtin_memmove(memory_base + destination, memory_base + source, count);
+            break;
+        }
+#define M(name, ReadType, PushType)                                                                                                                                                      \
+    case CompiledOpcode::name:                                                                                                                                                           \
+        if (!load_from_compiled_memory<ReadType, PushType, memory_has_guard_pages>(*memory, memory_base, slots[instruction.destination], slots[instruction.lhs], instruction.immediate)) \
+            return;                                                                                                                                                                      \
+        break;
+            ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, PopType, StoreType)                                                                                                                                             \
+    case CompiledOpcode::name:                                                                                                                                                  \
+        if (!store_to_compiled_memory<PopType, StoreType, memory_has_guard_pages>(*memory, memory_base, slots[instruction.lhs], slots[instruction.rhs], instruction.immediate)) \
+            return;                                                                                                                                                             \
+        break;
+            ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
+#define M(name, PopType, PushType, Operator)                                                                                 \
+    case CompiledOpcode::name:                                                                                               \
+        if (!store_compiled_result<PushType>(slots[instruction.destination], Operator {}(from_slot<PopType>(slots[instruction.lhs])))) \
+            return;                                                                                                          \
+        break;
+            ENUMERATE_WASM_UNARY_NUMERIC_OPERATIONS(M)
+#undef M
+#define M(name, PopType, PushType, Operator)                                                                                      \
+    case CompiledOpcode::name:                                                                                                    \
+        if (!store_compiled_result<PushType>(slots[instruction.destination], Operator {}(from_slot<PopType>(slots[instruction.lhs]), from_slot<PopType>(slots[instruction.rhs])))) \
+            return;                                                                                                               \
+        break;
+            ENUMERATE_WASM_BINARY_NUMERIC_OPERATIONS(M)
+#undef M
+        }
+    }
+}
+
 void DebuggerBytecodeInterpreter::interpret(Configuration& configuration, InstructionPointer& ip, Instruction const& instruction)
 {
     if (pre_interpret_hook) {
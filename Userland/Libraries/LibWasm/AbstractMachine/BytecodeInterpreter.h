@@ -29,6 +29,7 @@ struct BytecodeInterpreter : public Interpreter {
             [](JS::Completion const& completion) { return completion.value()->to_string_without_side_effects().release_value().to_deprecated_string(); });
     }
     virtual void clear_trap() override { m_trap = Empty {}; }
+    virtual Optional<Result> try_execute_compiled(Configuration&, WasmFunction&, Vector<Value>& arguments) override;
 
     struct CallFrameHandle {
         explicit CallFrameHandle(BytecodeInterpreter& interpreter, Configuration& configuration)
@@ -69,6 +70,19 @@ protected:
     T read_value(ReadonlyBytes data);
 
     Vector<Value> pop_values(Configuration& configuration, size_t count);
+
+    void enter_compiled_frame(CompiledFunction const&, size_t frame_base);
+    void execute_compiled(Configuration&, WasmFunction const&, CompiledFunction const&, size_t frame_base);
+    template<bool memory_has_guard_pages>
+    void execute_compiled_instructions(Configuration&, WasmFunction const&, CompiledFunction const&, size_t frame_base);
+    bool call_from_compiled_code(Configuration&, FunctionAddress, size_t arguments_base);
+    template<typename PushType, typename T>
+    bool store_compiled_result(u64& destination, T call_result);
+    template<typename ReadType, typename PushType, bool memory_has_guard_pages>
+    bool load_from_compiled_memory(MemoryInstance const&, u8 const* memory_base, u64& destination, u64 base, u64 offset);
+    template<typename PopType, typename StoreType, bool memory_has_guard_pages>
+    bool store_to_compiled_memory(MemoryInstance const&, u8* memory_base, u64 base, u64 value, u64 offset);
+
     ALWAYS_INLINE bool trap_if_not(bool value, StringView reason)
     {
         if (!value)
@@ -78,6 +92,9 @@ protected:
 
     Variant<Trap, JS::Completion, Empty> m_trap;
     StackInfo const& m_stack_info;
+
+    // The frames of all compiled functions that are currently running, see CompiledFunction.
+    Vector<u64> m_compiled_frame_slots;
 };
 
 struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
@@ -87,6 +104,14 @@ struct DebuggerBytecodeInterpreter : public BytecodeInterpreter {
     }
     virtual ~DebuggerBytecodeInterpreter() override = default;
 
+    // The hooks need to see every instruction, so compiled functions can't be used while they're set.
+    virtual Optional<Result> try_execute_compiled(Configuration& configuration, WasmFunction& function, Vector<Value>& arguments) override
+    {
+        if (pre_interpret_hook || post_interpret_hook)
+            return {};
+        return BytecodeInterpreter::try_execute_compiled(configuration, function, arguments);
+    }
+
     Function<bool(Configuration&, InstructionPointer&, Instruction const&)> pre_interpret_hook;
     Function<bool(Configuration&, InstructionPointer&, Instruction const&, Interpreter const&)> post_interpret_hook;
 
@@ -0,0 +1,688 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include <AK/AllOf.h>
+#include <AK/HashMap.h>
+#include <LibWasm/AbstractMachine/AbstractMachine.h>
+#include <LibWasm/AbstractMachine/CompiledFunction.h>
+#include <LibWasm/Opcode.h>
+
+namespace Wasm {
+
+namespace {
+
+bool is_number_type(ValueType const& type)
+{
+    switch (type.kind()) {
+    case ValueType::I32:
+    case ValueType::I64:
+    case ValueType::F32:
+    case ValueType::F64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool has_only_number_types(FunctionType const& type)
+{
+    return all_of(type.parameters(), is_number_type) && all_of(type.results(), is_number_type);
+}
+
+Optional<u64> constant_bits(Instruction const& instruction)
+{
+    switch (instruction.opcode().value()) {
+    case Instructions::i32_const.value():
+        return bit_cast<u32>(instruction.arguments().get<i32>());
+    case Instructions::i64_const.value():
+        return bit_cast<u64>(instruction.arguments().get<i64>());
+    case Instructions::f32_const.value():
+        return bit_cast<u32>(instruction.arguments().get<float>());
+    case Instructions::f64_const.value():
+        return bit_cast<u64>(instruction.arguments().get<double>());
+    default:
+        return {};
+    }
+}
+
+bool is_fusable_comparison(CompiledOpcode opcode)
+{
+    switch (opcode) {
+    case CompiledOpcode::i32_eqz:
+#define M(name, ...) case CompiledOpcode::name:
+        ENUMERATE_WASM_FUSABLE_COMPARISONS(M)
+#undef M
+        return true;
+    default:
+        return false;
+    }
+}
+
+CompiledOpcode fused_jump_opcode(CompiledOpcode comparison, bool jump_if_true)
+{
+    switch (comparison) {
+#define M(name, opposite, ...) \
+    case CompiledOpcode::name: \
+        return jump_if_true ? CompiledOpcode::jump_if_##name : CompiledOpcode::jump_if_##opposite;
+        ENUMERATE_WASM_FUSABLE_COMPARISONS(M)
+#undef M
+    default:
+        VERIFY_NOT_REACHED();
+    }
+}
+
+class FunctionCompiler {
+public:
+    FunctionCompiler(Store& store, ModuleInstance const& module, FunctionType const& type, Module::Function const& code)
+        : m_store(store)
+        , m_module(module)
+        , m_type(type)
+        , m_code(code)
+    {
+    }
+
+    OwnPtr<CompiledFunction> compile();
+
+private:
+    struct ControlFrame {
+        enum class Kind {
+            Function,
+            Block,
+            Loop,
+            If,
+        };
+
+        Kind kind;
+        size_t height { 0 };
+        size_t parameter_count { 0 };
+        size_t result_count { 0 };
+        size_t loop_start { 0 };
+        Vector<size_t> forward_jumps {};
+        Optional<size_t> else_jump {};
+
+        size_t branch_arity() const { return kind == Kind::Loop ? parameter_count : result_count; }
+    };
+
+    bool compile_instruction(Instruction const&);
+
+    u32 operand_slot(size_t height) const { return m_operand_stack_base + height; }
+
+    void push_operand(u32 slot)
+    {
+        m_operands.append(slot);
+        m_max_height = max(m_max_height, m_operands.size());
+    }
+    u32 push_result()
+    {
+        auto slot = operand_slot(m_operands.size());
+        push_operand(slot);
+        return slot;
+    }
+    u32 pop_operand()
+    {
+        if (m_operands.size() <= m_frames.last().height) {
+            m_failed = true;
+            return 0;
+        }
+        return m_operands.take_last();
+    }
+
+    void emit(CompiledInstruction instruction)
+    {
+        m_instructions.append(instruction);
+        m_last_result_instruction = {};
+    }
+    void emit_result(CompiledInstruction instruction)
+    {
+        emit(instruction);
+        m_last_result_instruction = m_instructions.size() - 1;
+    }
+    size_t emit_jump(CompiledOpcode opcode, u32 condition = 0)
+    {
+        emit({ opcode, 0, condition, 0, 0 });
+        return m_instructions.size() - 1;
+    }
+    void patch_jump(size_t index) { m_instructions[index].immediate = m_instructions.size(); }
+
+    // If the condition that was just popped is the result of the last instruction, and that's a comparison,
+    // takes it back out so that it can be fused with the conditional jump using it.
+    Optional<CompiledInstruction> take_comparison_computing(u32 condition)
+    {
+        if (m_last_result_instruction != m_instructions.size() - 1 || condition != operand_slot(m_operands.size()))
+            return {};
+        auto const& instruction = m_instructions.last();
+        if (instruction.destination != condition || !is_fusable_comparison(instruction.opcode))
+            return {};
+        m_last_result_instruction = {};
+        return m_instructions.take_last();
+    }
+    size_t emit_conditional_jump(Optional<CompiledInstruction> const& comparison, u32 condition, bool jump_if_true, u64 target = 0)
+    {
+        if (!comparison.has_value())
+            emit({ jump_if_true ? CompiledOpcode::jump_if_not_zero : CompiledOpcode::jump_if_zero, 0, condition, 0, target });
+        else if (comparison->opcode == CompiledOpcode::i32_eqz)
+            emit({ jump_if_true ? CompiledOpcode::jump_if_zero : CompiledOpcode::jump_if_not_zero, 0, comparison->lhs, 0, target });
+        else
+            emit({ fused_jump_opcode(comparison->opcode, jump_if_true), 0, comparison->lhs, comparison->rhs, target });
+        return m_instructions.size() - 1;
+    }
+
+    // Something may jump here, so the next instruction can't be changed after the fact.
+    void bind_label() { m_last_result_instruction = {}; }
+
+    void materialize(size_t height)
+    {
+        auto slot = operand_slot(height);
+        if (m_operands[height] == slot)
+            return;
+        emit({ CompiledOpcode::copy, slot, m_operands[height], 0, 0 });
+        m_operands[height] = slot;
+    }
+    void materialize_top(size_t count)
+    {
+        for (size_t height = m_operands.size() - count; height < m_operands.size(); ++height)
+            materialize(height);
+    }
+    // Control flow can only merge with a single stack layout, so all values have to be in their own slots by then.
+    void materialize_all() { materialize_top(m_operands.size()); }
+    // Moving more than one result into place could overwrite a local that a later result is read from.
+    void materialize_results()
+    {
+        if (m_type.results().size() > 1)
+            materialize_top(m_type.results().size());
+    }
+    void materialize_aliases_of(u32 local)
+    {
+        for (size_t height = 0; height < m_operands.size(); ++height) {
+            if (m_operands[height] == local)
+                materialize(height);
+        }
+    }
+
+    bool needs_copies_to_branch_to(ControlFrame const& frame) const
+    {
+        auto arity = frame.branch_arity();
+        for (size_t i = 0; i < arity; ++i) {
+            if (m_operands[m_operands.size() - arity + i] != operand_slot(frame.height + i))
+                return true;
+        }
+        return false;
+    }
+    void emit_branch_to(ControlFrame&);
+    void emit_return();
+    void set_local(u32 local);
+
+    Optional<ControlFrame&> frame_for_label(LabelIndex);
+    Optional<ControlFrame> frame_for_block_type(ControlFrame::Kind, BlockType const&);
+
+    Store& m_store;
+    ModuleInstance const& m_module;
+    FunctionType const& m_type;
+    Module::Function const& m_code;
+
+    Vector<CompiledInstruction> m_instructions;
+    Vector<u32> m_branch_table_targets;
+    Vector<u64> m_constants;
+    HashMap<u64, u32> m_constant_slots;
+    Vector<ControlFrame> m_frames;
+    Vector<u32> m_operands;
+    Optional<size_t> m_last_result_instruction;
+    size_t m_local_count { 0 };
+    size_t m_operand_stack_base { 0 };
+    size_t m_max_height { 0 };
+    size_t m_unreachable_nesting { 0 };
+    bool m_is_unreachable { false };
+    bool m_failed { false };
+};
+
+Optional<FunctionCompiler::ControlFrame&> FunctionCompiler::frame_for_label(LabelIndex label)
+{
+    if (label.value() >= m_frames.size())
+        return {};
+    return m_frames[m_frames.size() - 1 - label.value()];
+}
+
+Optional<FunctionCompiler::ControlFrame> FunctionCompiler::frame_for_block_type(ControlFrame::Kind kind, BlockType const& block_type)
+{
+    ControlFrame frame { kind };
+    switch (block_type.kind()) {
+    case BlockType::Empty:
+        break;
+    case BlockType::Type:
+        if (!is_number_type(block_type.value_type()))
+            return {};
+        frame.result_count = 1;
+        break;
+    case BlockType::Index: {
+        auto index = block_type.type_index().value();
+        if (index >= m_module.types().size() || !has_only_number_types(m_module.types()[index]))
+            return {};
+        frame.parameter_count = m_module.types()[index].parameters().size();
+        frame.result_count = m_module.types()[index].results().size();
+        break;
+    }
+    }
+
+    if (m_operands.size() < m_frames.last().height + frame.parameter_count)
+        return {};
+    frame.height = m_operands.size() - frame.parameter_count;
+    return frame;
+}
+
+// The values carried by the branch are expected on top of the stack.
+void FunctionCompiler::emit_branch_to(ControlFrame& frame)
+{
+    if (frame.kind == ControlFrame::Kind::Function)
+        return emit_return();
+
+    auto arity = frame.branch_arity();
+    auto first_value = m_operands.size() - arity;
+    for (size_t i = 0; i < arity; ++i) {
+        auto destination = operand_slot(frame.height + i);
+        if (m_operands[first_value + i] != destination)
+            emit({ CompiledOpcode::copy, destination, m_operands[first_value + i], 0, 0 });
+    }
+
+    if (frame.kind == ControlFrame::Kind::Loop) {
+        emit({ CompiledOpcode::jump, 0, 0, 0, frame.loop_start });
+        return;
+    }
+    frame.forward_jumps.append(emit_jump(CompiledOpcode::jump));
+}
+
+// The results are expected on top of the stack, see materialize_results().
+void FunctionCompiler::emit_return()
+{
+    auto result_count = m_type.results().size();
+    auto first_result = m_operands.size() - result_count;
+    for (size_t i = 0; i < result_count; ++i) {
+        if (m_operands[first_result + i] != i)
+            emit({ CompiledOpcode::copy, static_cast<u32>(i), m_operands[first_result + i], 0, 0 });
+    }
+    emit({ CompiledOpcode::return_ });
+}
+
+void FunctionCompiler::set_local(u32 local)
+{
+    auto value = pop_operand();
+    if (m_failed)
+        return;
+
+    // If the value was just computed, compute it right into the local instead.
+    if (m_last_result_instruction.has_value()
+        && value == operand_slot(m_operands.size())
+        && m_instructions[*m_last_result_instruction].destination == value
+        && !m_operands.contains_slow(local)) {
+        m_instructions[*m_last_result_instruction].destination = local;
+        m_last_result_instruction = {};
+        return;
+    }
+
+    materialize_aliases_of(local);
+    if (value != local)
+        emit({ CompiledOpcode::copy, local, value, 0, 0 });
+}
+
+OwnPtr<CompiledFunction> FunctionCompiler::compile()
+{
+    if (!has_only_number_types(m_type) || !all_of(m_code.locals(), is_number_type))
+        return nullptr;
+
+    m_local_count = m_type.parameters().size() + m_code.locals().size();
+
+    auto& instructions = m_code.body().instructions();
+    for (auto& instruction : instructions) {
+        auto bits = constant_bits(instruction);
+        if (!bits.has_value() || m_constant_slots.contains(*bits))
+            continue;
+        m_constant_slots.set(*bits, m_local_count + m_constants.size());
+        m_constants.append(*bits);
+    }
+    m_operand_stack_base = m_local_count + m_constants.size();
+
+    m_frames.append({ ControlFrame::Kind::Function, 0, 0, m_type.results().size() });
+
+    for (auto& instruction : instructions) {
+        if (m_is_unreachable) {
+            // Skip over dead code, up to the end of the current block.
+            auto opcode = instruction.opcode();
+            if (opcode == Instructions::block || opcode == Instructions::loop || opcode == Instructions::if_) {
+                ++m_unreachable_nesting;
+                continue;
+            }
+            if (opcode != Instructions::structured_end && opcode != Instructions::structured_else)
+                continue;
+            if (m_unreachable_nesting > 0) {
+                if (opcode == Instructions::structured_end)
+                    --m_unreachable_nesting;
+                continue;
+            }
+        }
+
+        if (!compile_instruction(instruction) || m_failed)
+            return nullptr;
+    }
+
+    if (m_frames.size() != 1)
+        return nullptr;
+
+    if (!m_is_unreachable) {
+        if (m_operands.size() != m_type.results().size())
+            return nullptr;
+        materialize_results();
+        emit_return();
+    }
+
+    auto frame_size = max(m_operand_stack_base + m_max_height, m_type.results().size());
+    if (frame_size > NumericLimits<u32>::max())
+        return nullptr;
+
+    return make<CompiledFunction>(move(m_instructions), move(m_constants), move(m_branch_table_targets), m_type.parameters().size(), m_local_count, frame_size);
+}
+
+bool FunctionCompiler::compile_instruction(Instruction const& instruction)
+{
+    switch (instruction.opcode().value()) {
+    case Instructions::unreachable.value():
+        emit({ CompiledOpcode::unreachable });
+        m_is_unreachable = true;
+        return true;
+    case Instructions::nop.value():
+        return true;
+    case Instructions::block.value():
+    case Instructions::loop.value(): {
+        auto is_loop = instruction.opcode() == Instructions::loop;
+        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+        auto frame = frame_for_block_type(is_loop ? ControlFrame::Kind::Loop : ControlFrame::Kind::Block, args.block_type);
+        if (!frame.has_value())
+            return false;
+        materialize_all();
+        if (is_loop) {
+            bind_label();
+            frame->loop_start = m_instructions.size();
+        }
+        m_frames.append(frame.release_value());
+        return true;
+    }
+    case Instructions::if_.value(): {
+        auto condition = pop_operand();
+        auto comparison = take_comparison_computing(condition);
+        auto& args = instruction.arguments().get<Instruction::StructuredInstructionArgs>();
+        auto frame = frame_for_block_type(ControlFrame::Kind::If, args.block_type);
+        // Both arms would need the parameters, but the first one is free to overwrite them.
+        if (!frame.has_value() || frame->parameter_count != 0)
+            return false;
+        materialize_all();
+        frame->else_jump = emit_conditional_jump(comparison, condition, false);
+        m_frames.append(frame.release_value());
+        return true;
+    }
+    case Instructions::structured_else.value(): {
+        auto& frame = m_frames.last();
+        if (frame.kind != ControlFrame::Kind::If || !frame.else_jump.has_value())
+            return false;
+        if (!m_is_unreachable) {
+            materialize_all();
+            frame.forward_jumps.append(emit_jump(CompiledOpcode::jump));
+        }
+        patch_jump(frame.else_jump.release_value());
+        bind_label();
+        m_operands.shrink(frame.height);
+        m_is_unreachable = false;
+        return true;
+    }
+    case Instructions::structured_end.value(): {
+        if (m_frames.size() <= 1)
+            return false;
+        if (!m_is_unreachable)
+            materialize_all();
+        auto frame = m_frames.take_last();
+        if (frame.else_jump.has_value())
+            patch_jump(*frame.else_jump);
+        for (auto jump : frame.forward_jumps)
+            patch_jump(jump);
+        bind_label();
+        m_operands.shrink(min(m_operands.size(), frame.height));
+        for (size_t i = 0; i < frame.result_count; ++i)
+            push_result();
+        m_is_unreachable = false;
+        return true;
+    }
+    case Instructions::br.value(): {
+        auto frame = frame_for_label(instruction.arguments().get<LabelIndex>());
+        if (!frame.has_value() || m_operands.size() < frame->height + frame->branch_arity())
+            return false;
+        if (frame->kind == ControlFrame::Kind::Function)
+            materialize_results();
+        emit_branch_to(*frame);
+        m_is_unreachable = true;
+        return true;
+    }
+    case Instructions::br_if.value(): {
+        auto condition = pop_operand();
+        auto comparison = take_comparison_computing(condition);
+        auto frame = frame_for_label(instruction.arguments().get<LabelIndex>());
+        if (!frame.has_value() || m_operands.size() < frame->height + frame->branch_arity())
+            return false;
+        if (frame->kind == ControlFrame::Kind::Function)
+            materialize_results();
+
+        if (frame->kind != ControlFrame::Kind::Function && !needs_copies_to_branch_to(*frame)) {
+            if (frame->kind == ControlFrame::Kind::Loop)
+                emit_conditional_jump(comparison, condition, true, frame->loop_start);
+            else
+                frame->forward_jumps.append(emit_conditional_jump(comparison, condition, true));
+            return true;
+        }
+
+        auto skip = emit_conditional_jump(comparison, condition, false);
+        emit_branch_to(*frame);
+        patch_jump(skip);
+        bind_label();
+        return true;
+    }
+    case Instructions::br_table.value(): {
+        auto& args = instruction.arguments().get<Instruction::TableBranchArgs>();
+        auto index = pop_operand();
+
+        Vector<LabelIndex> labels = args.labels;
+        labels.append(args.default_);
+        for (auto label : labels) {
+            auto frame = frame_for_label(label);
+            if (!frame.has_value() || m_operands.size() < frame->height + frame->branch_arity())
+                return false;
+            if (frame->kind == ControlFrame::Kind::Function)
+                materialize_results();
+        }
+
+        emit({ CompiledOpcode::branch_table, 0, index, static_cast<u32>(args.labels.size()), m_branch_table_targets.size() });
+        auto first_target = m_branch_table_targets.size();
+        m_branch_table_targets.resize(first_target + labels.size());
+
+        // Each distinct label gets a small stub that moves the values into place and jumps there.
+        HashMap<u32, u32> stubs;
+        for (size_t i = 0; i < labels.size(); ++i) {
+            auto stub = stubs.get(labels[i].value());
+            if (!stub.has_value()) {
+                stubs.set(labels[i].value(), m_instructions.size());
+                bind_label();
+                emit_branch_to(*frame_for_label(labels[i]));
+            }
+            m_branch_table_targets[first_target + i] = stubs.get(labels[i].value()).value();
+        }
+        m_is_unreachable = true;
+        return true;
+    }
+    case Instructions::return_.value():
+        if (m_operands.size() < m_type.results().size())
+            return false;
+        materialize_results();
+        emit_return();
+        m_is_unreachable = true;
+        return true;
+    case Instructions::call.value(): {
+        auto index = instruction.arguments().get<FunctionIndex>().value();
+        if (index >= m_module.functions().size())
+            return false;
+        auto* function = m_store.get(m_module.functions()[index]);
+        if (!function)
+            return false;
+        auto& type = function->visit([](auto const& function) -> FunctionType const& { return function.type(); });
+        if (!has_only_number_types(type) || m_operands.size() < m_frames.last().height + type.parameters().size())
+            return false;
+        materialize_top(type.parameters().size());
+        auto first_argument = m_operands.size() - type.parameters().size();
+        emit({ CompiledOpcode::call, operand_slot(first_argument), 0, 0, index });
+        m_operands.shrink(first_argument);
+        for (size_t i = 0; i < type.results().size(); ++i)
+            push_result();
+        return true;
+    }
+    case Instructions::call_indirect.value(): {
+        auto& args = instruction.arguments().get<Instruction::IndirectCallArgs>();
+        if (args.type.value() >= m_module.types().size() || args.table.value() >= m_module.tables().size())
+            return false;
+        auto& type = m_module.types()[args.type.value()];
+        auto element_index = pop_operand();
+        if (!has_only_number_types(type) || m_operands.size() < m_frames.last().height + type.parameters().size())
+            return false;
+        materialize_top(type.parameters().size());
+        auto first_argument = m_operands.size() - type.parameters().size();
+        emit({ CompiledOpcode::call_indirect, operand_slot(first_argument), element_index, static_cast<u32>(args.table.value()), args.type.value() });
+        m_operands.shrink(first_argument);
+        for (size_t i = 0; i < type.results().size(); ++i)
+            push_result();
+        return true;
+    }
+    case Instructions::drop.value():
+        pop_operand();
+        return true;
+    case Instructions::select_typed.value():
+        if (!all_of(instruction.arguments().get<Vector<ValueType>>(), is_number_type))
+            return false;
+        [[fallthrough]];
+    case Instructions::select.value(): {
+        auto condition = pop_operand();
+        auto rhs = pop_operand();
+        auto lhs = pop_operand();
+        auto destination = push_result();
+        emit_result({ CompiledOpcode::select, destination, lhs, rhs, condition });
+        return true;
+    }
+    case Instructions::local_get.value(): {
+        auto local = instruction.arguments().get<LocalIndex>().value();
+        if (local >= m_local_count)
+            return false;
+        push_operand(local);
+        return true;
+    }
+    case Instructions::local_set.value():
+    case Instructions::local_tee.value(): {
+        auto local = instruction.arguments().get<LocalIndex>().value();
+        if (local >= m_local_count)
+            return false;
+        set_local(local);
+        if (instruction.opcode() == Instructions::local_tee)
+            push_operand(local);
+        return true;
+    }
+    case Instructions::global_get.value():
+    case Instructions::global_set.value(): {
+        auto index = instruction.arguments().get<GlobalIndex>().value();
+        if (index >= m_module.globals().size())
+            return false;
+        auto* global = m_store.get(m_module.globals()[index]);
+        if (!global || !is_number_type(global->type().type()))
+            return false;
+        if (instruction.opcode() == Instructions::global_set) {
+            emit({ CompiledOpcode::global_set, 0, pop_operand(), 0, index });
+            return true;
+        }
+        emit_result({ CompiledOpcode::global_get, push_result(), 0, 0, index });
+        return true;
+    }
+    case Instructions::i32_const.value():
+    case Instructions::i64_const.value():
+    case Instructions::f32_const.value():
+    case Instructions::f64_const.value():
+        push_operand(m_constant_slots.get(*constant_bits(instruction)).value());
+        return true;
+    case Instructions::memory_size.value():
+        if (m_module.memories().is_empty())
+            return false;
+        emit_result({ CompiledOpcode::memory_size, push_result() });
+        return true;
+    case Instructions::memory_grow.value(): {
+        if (m_module.memories().is_empty())
+            return false;
+        auto pages = pop_operand();
+        emit_result({ CompiledOpcode::memory_grow, push_result(), pages });
+        return true;
+    }
+    case Instructions::memory_fill.value():
+    case Instructions::memory_copy.value(): {
+        if (m_module.memories().is_empty())
+            return false;
+        auto count = pop_operand();
+        auto value_or_source = pop_operand();
+        auto destination = pop_operand();
+        auto opcode = instruction.opcode() == Instructions::memory_fill ? CompiledOpcode::memory_fill : CompiledOpcode::memory_copy;
+        emit({ opcode, destination, value_or_source, count });
+        return true;
+    }
+#define M(name, ...)                                                                                 \
+    case Instructions::name.value(): {                                                               \
+        if (m_module.memories().is_empty())                                                          \
+            return false;                                                                            \
+        auto address = pop_operand();                                                                \
+        auto offset = instruction.arguments().get<Instruction::MemoryArgument>().offset;             \
+        emit_result({ CompiledOpcode::name, push_result(), address, 0, offset });                    \
+        return true;                                                                                 \
+    }
+        ENUMERATE_WASM_LOAD_OPERATIONS(M)
+#undef M
+#define M(name, ...)                                                                                 \
+    case Instructions::name.value(): {                                                               \
+        if (m_module.memories().is_empty())                                                          \
+            return false;                                                                            \
+        auto value = pop_operand();                                                                  \
+        auto address = pop_operand();                                                                \
+        auto offset = instruction.arguments().get<Instruction::MemoryArgument>().offset;             \
+        emit({ CompiledOpcode::name, 0, address, value, offset });                                   \
+        return true;                                                                                 \
+    }
+        ENUMERATE_WASM_STORE_OPERATIONS(M)
+#undef M
+#define M(name, ...)                                                        \
+    case Instructions::name.value(): {                                      \
+        auto value = pop_operand();                                         \
+        emit_result({ CompiledOpcode::name, push_result(), value });        \
+        return true;                                                        \
+    }
+        ENUMERATE_WASM_UNARY_NUMERIC_OPERATIONS(M)
+#undef M
+#define M(name, ...)                                                        \
+    case Instructions::name.value(): {                                      \
+        auto rhs = pop_operand();                                           \
+        auto lhs = pop_operand();                                           \
+        emit_result({ CompiledOpcode::name, push_result(), lhs, rhs });     \
+        return true;                                                        \
+    }
+        ENUMERATE_WASM_BINARY_NUMERIC_OPERATIONS(M)
+#undef M
+    default:
+        return false;
+    }
+}
+
+}
+
+OwnPtr<CompiledFunction> CompiledFunction::try_compile(Store& store, ModuleInstance const& module, FunctionType const& type, Module::Function const& code)
+{
+    return FunctionCompiler { store, module, type, code }.compile();
+}
+
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2023, the SerenityOS developers.
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <AK/OwnPtr.h>
+#include <AK/Vector.h>
+#include <LibWasm/AbstractMachine/Operators.h>
+#include <LibWasm/Types.h>
+
+namespace Wasm {
+
+class ModuleInstance;
+class Store;
+
+// Instruction, type read from memory, type pushed onto the stack.
+#define ENUMERATE_WASM_LOAD_OPERATIONS(O) \
+    O(i32_load, i32, i32)                 \
+    O(i64_load, i64, i64)                 \
+    O(f32_load, float, float)             \
+    O(f64_load, double, double)           \
+    O(i32_load8_s, i8, i32)               \
+    O(i32_load8_u, u8, i32)               \
+    O(i32_load16_s, i16, i32)             \
+    O(i32_load16_u, u16, i32)             \
+    O(i64_load8_s, i8, i64)               \
+    O(i64_load8_u, u8, i64)               \
+    O(i64_load16_s, i16, i64)             \
+    O(i64_load16_u, u16, i64)             \
+    O(i64_load32_s, i32, i64)             \
+    O(i64_load32_u, u32, i64)
+
+// Instruction, type popped off the stack, type written to memory.
+#define ENUMERATE_WASM_STORE_OPERATIONS(O) \
+    O(i32_store, i32, i32)                 \
+    O(i64_store, i64, i64)                 \
+    O(f32_store, float, float)             \
+    O(f64_store, double, double)           \
+    O(i32_store8, i32, i8)                 \
+    O(i32_store16, i32, i16)               \
+    O(i64_store8, i64, i8)                 \
+    O(i64_store16, i64, i16)               \
+    O(i64_store32, i64, i32)
+
+// Comparisons that can be fused with the conditional jump using their result.
+// Instruction, the instruction with the opposite result, type popped off the stack, operator.
+#define ENUMERATE_WASM_FUSABLE_COMPARISONS(O)                \
+    O(i32_eq, i32_ne, i32, Operators::Equals)                \
+    O(i32_ne, i32_eq, i32, Operators::NotEquals)             \
+    O(i32_lts, i32_ges, i32, Operators::LessThan)            \
+    O(i32_ltu, i32_geu, u32, Operators::LessThan)            \
+    O(i32_gts, i32_les, i32, Operators::GreaterThan)         \
+    O(i32_gtu, i32_leu, u32, Operators::GreaterThan)         \
+    O(i32_les, i32_gts, i32, Operators::LessThanOrEquals)    \
+    O(i32_leu, i32_gtu, u32, Operators::LessThanOrEquals)    \
+    O(i32_ges, i32_lts, i32, Operators::GreaterThanOrEquals) \
+    O(i32_geu, i32_ltu, u32, Operators::GreaterThanOrEquals)
+
+enum class CompiledOpcode : u16 {
+    copy,
+    jump,
+    jump_if_zero,
+    jump_if_not_zero,
+    branch_table,
+    return_,
+    unreachable,
+    call,
+    call_indirect,
+    select,
+    global_get,
+    global_set,
+    memory_size,
+    memory_grow,
+    memory_fill,
+    memory_copy,
+#define __ENUMERATE_COMPILED_JUMP_OPCODE(name, ...) jump_if_##name,
+    ENUMERATE_WASM_FUSABLE_COMPARISONS(__ENUMERATE_COMPILED_JUMP_OPCODE)
+#undef __ENUMERATE_COMPILED_JUMP_OPCODE
+#define __ENUMERATE_COMPILED_OPCODE(name, ...) name,
+    ENUMERATE_WASM_LOAD_OPERATIONS(__ENUMERATE_COMPILED_OPCODE)
+        ENUMERATE_WASM_STORE_OPERATIONS(__ENUMERATE_COMPILED_OPCODE)
+            ENUMERATE_WASM_UNARY_NUMERIC_OPERATIONS(__ENUMERATE_COMPILED_OPCODE)
+                ENUMERATE_WASM_BINARY_NUMERIC_OPERATIONS(__ENUMERATE_COMPILED_OPCODE)
+#undef __ENUMERATE_COMPILED_OPCODE
+};
+
+// All operands are slot indices relative to the start of the current frame.
+//     copy:              slot[destination] = slot[lhs]
+//     jump*:             ip = immediate, conditional on slot[lhs] (or on comparing slot[lhs] with slot[rhs])
+//     branch_table:      ip = branch_table_targets[immediate + min(slot[lhs], rhs)]
+//     call:              immediate is the function index, arguments start at slot[destination]
+//     call_indirect:     as call, with the table element index in slot[lhs], the table in rhs and the type in immediate
+//     select:            slot[destination] = slot[immediate] ? slot[lhs] : slot[rhs]
+//     global_*:          immediate is the global index
+//     memory_fill/copy:  destination address in slot[destination], value/source address in slot[lhs], count in slot[rhs]
+//     loads and stores:  address in slot[lhs], the stored value in slot[rhs] and the memory offset in immediate
+//     numeric operators: slot[destination] = slot[lhs] (op slot[rhs])
+struct CompiledInstruction {
+    CompiledOpcode opcode;
+    u32 destination { 0 };
+    u32 lhs { 0 };
+    u32 rhs { 0 };
+    u64 immediate { 0 };
+};
+
+// A function body lowered once into three-address instructions that work on a flat array of untyped 64-bit slots,
+// instead of pushing and popping Values. The slots of a frame are laid out as follows:
+//     [0, local_count)                    the parameters, followed by the declared locals
+//     [local_count, operand_stack_base)   the constants used by the body
+//     [operand_stack_base, frame_size)    the operand stack; the value at height h lives in operand_stack_base + h
+// Most operands are read straight out of the locals and constants instead of being copied onto the stack first.
+// Arguments are passed in place: the frame of a callee starts at the first argument slot of the caller, and the
+// callee leaves its results at the start of its frame.
+class CompiledFunction {
+public:
+    // Returns null if the body uses something the compiled form doesn't support (e.g. references or tables),
+    // such functions are left to the stack-based interpreter.
+    static OwnPtr<CompiledFunction> try_compile(Store&, ModuleInstance const&, FunctionType const&, Module::Function const&);
+
+    CompiledFunction(Vector<CompiledInstruction> instructions, Vector<u64> constants, Vector<u32> branch_table_targets, size_t parameter_count, size_t local_count, size_t frame_size)
+        : m_instructions(move(instructions))
+        , m_constants(move(constants))
+        , m_branch_table_targets(move(branch_table_targets))
+        , m_parameter_count(parameter_count)
+        , m_local_count(local_count)
+        , m_frame_size(frame_size)
+    {
+    }
+
+    auto& instructions() const { return m_instructions; }
+    auto& constants() const { return m_constants; }
+    auto& branch_table_targets() const { return m_branch_table_targets; }
+    auto parameter_count() const { return m_parameter_count; }
+    auto local_count() const { return m_local_count; }
+    auto frame_size() const { return m_frame_size; }
+
+private:
+    Vector<CompiledInstruction> m_instructions;
+    Vector<u64> m_constants;
+    Vector<u32> m_branch_table_targets;
+    size_t m_parameter_count { 0 };
+    size_t m_local_count { 0 };
+    size_t m_frame_size { 0 };
+};
+
+}
@@ -16,6 +16,9 @@ struct Interpreter {
     virtual bool did_trap() const = 0;
     virtual DeprecatedString trap_reason() const = 0;
     virtual void clear_trap() = 0;
+
+    // Gives the interpreter a chance to run the function in its own way, an empty result means it should be interpreted.
+    virtual Optional<Result> try_execute_compiled(Configuration&, WasmFunction&, Vector<Value>&) { return {}; }
 };
 
 }
@@ -454,3 +454,144 @@ struct SaturatingTruncate {
 };
 
 }
+
+// Instruction, type popped off the stack, type pushed onto the stack, operator.
+#define ENUMERATE_WASM_UNARY_NUMERIC_OPERATIONS(O)                          \
+    O(i32_eqz, i32, i32, Operators::EqualsZero)                             \
+    O(i64_eqz, i64, i32, Operators::EqualsZero)                             \
+    O(i32_clz, i32, i32, Operators::CountLeadingZeros)                      \
+    O(i32_ctz, i32, i32, Operators::CountTrailingZeros)                     \
+    O(i32_popcnt, i32, i32, Operators::PopCount)                            \
+    O(i64_clz, i64, i64, Operators::CountLeadingZeros)                      \
+    O(i64_ctz, i64, i64, Operators::CountTrailingZeros)                     \
+    O(i64_popcnt, i64, i64, Operators::PopCount)                            \
+    O(f32_abs, float, float, Operators::Absolute)                           \
+    O(f32_neg, float, float, Operators::Negate)                             \
+    O(f32_ceil, float, float, Operators::Ceil)                              \
+    O(f32_floor, float, float, Operators::Floor)                            \
+    O(f32_trunc, float, float, Operators::Truncate)                         \
+    O(f32_nearest, float, float, Operators::NearbyIntegral)                 \
+    O(f32_sqrt, float, float, Operators::SquareRoot)                        \
+    O(f64_abs, double, double, Operators::Absolute)                         \
+    O(f64_neg, double, double, Operators::Negate)                           \
+    O(f64_ceil, double, double, Operators::Ceil)                            \
+    O(f64_floor, double, double, Operators::Floor)                          \
+    O(f64_trunc, double, double, Operators::Truncate)                       \
+    O(f64_nearest, double, double, Operators::NearbyIntegral)               \
+    O(f64_sqrt, double, double, Operators::SquareRoot)                      \
+    O(i32_wrap_i64, i64, i32, Operators::Wrap<i32>)                         \
+    O(i32_trunc_sf32, float, i32, Operators::CheckedTruncate<i32>)          \
+    O(i32_trunc_uf32, float, i32, Operators::CheckedTruncate<u32>)          \
+    O(i32_trunc_sf64, double, i32, Operators::CheckedTruncate<i32>)         \
+    O(i32_trunc_uf64, double, i32, Operators::CheckedTruncate<u32>)         \
+    O(i64_trunc_sf32, float, i64, Operators::CheckedTruncate<i64>)          \
+    O(i64_trunc_uf32, float, i64, Operators::CheckedTruncate<u64>)          \
+    O(i64_trunc_sf64, double, i64, Operators::CheckedTruncate<i64>)         \
+    O(i64_trunc_uf64, double, i64, Operators::CheckedTruncate<u64>)         \
+    O(i64_extend_si32, i32, i64, Operators::Extend<i64>)                    \
+    O(i64_extend_ui32, u32, i64, Operators::Extend<i64>)                    \
+    O(f32_convert_si32, i32, float, Operators::Convert<float>)              \
+    O(f32_convert_ui32, u32, float, Operators::Convert<float>)              \
+    O(f32_convert_si64, i64, float, Operators::Convert<float>)              \
+    O(f32_convert_ui64, u64, float, Operators::Convert<float>)              \
+    O(f32_demote_f64, double, float, Operators::Demote)                     \
+    O(f64_convert_si32, i32, double, Operators::Convert<double>)            \
+    O(f64_convert_ui32, u32, double, Operators::Convert<double>)            \
+    O(f64_convert_si64, i64, double, Operators::Convert<double>)            \
+    O(f64_convert_ui64, u64, double, Operators::Convert<double>)            \
+    O(f64_promote_f32, float, double, Operators::Promote)                   \
+    O(i32_reinterpret_f32, float, i32, Operators::Reinterpret<i32>)         \
+    O(i64_reinterpret_f64, double, i64, Operators::Reinterpret<i64>)        \
+    O(f32_reinterpret_i32, i32, float, Operators::Reinterpret<float>)       \
+    O(f64_reinterpret_i64, i64, double, Operators::Reinterpret<double>)     \
+    O(i32_extend8_s, i32, i32, Operators::SignExtend<i8>)                   \
+    O(i32_extend16_s, i32, i32, Operators::SignExtend<i16>)                 \
+    O(i64_extend8_s, i64, i64, Operators::SignExtend<i8>)                   \
+    O(i64_extend16_s, i64, i64, Operators::SignExtend<i16>)                 \
+    O(i64_extend32_s, i64, i64, Operators::SignExtend<i32>)                 \
+    O(i32_trunc_sat_f32_s, float, i32, Operators::SaturatingTruncate<i32>)  \
+    O(i32_trunc_sat_f32_u, float, i32, Operators::SaturatingTruncate<u32>)  \
+    O(i32_trunc_sat_f64_s, double, i32, Operators::SaturatingTruncate<i32>) \
+    O(i32_trunc_sat_f64_u, double, i32, Operators::SaturatingTruncate<u32>) \
+    O(i64_trunc_sat_f32_s, float, i64, Operators::SaturatingTruncate<i64>)  \
+    O(i64_trunc_sat_f32_u, float, i64, Operators::SaturatingTruncate<u64>)  \
+    O(i64_trunc_sat_f64_s, double, i64, Operators::SaturatingTruncate<i64>) \
+    O(i64_trunc_sat_f64_u, double, i64, Operators::SaturatingTruncate<u64>)
+
+#define ENUMERATE_WASM_BINARY_NUMERIC_OPERATIONS(O)        \
+    O(i32_eq, i32, i32, Operators::Equals)                 \
+    O(i32_ne, i32, i32, Operators::NotEquals)              \
+    O(i32_lts, i32, i32, Operators::LessThan)              \
+    O(i32_ltu, u32, i32, Operators::LessThan)              \
+    O(i32_gts, i32, i32, Operators::GreaterThan)           \
+    O(i32_gtu, u32, i32, Operators::GreaterThan)           \
+    O(i32_les, i32, i32, Operators::LessThanOrEquals)      \
+    O(i32_leu, u32, i32, Operators::LessThanOrEquals)      \
+    O(i32_ges, i32, i32, Operators::GreaterThanOrEquals)   \
+    O(i32_geu, u32, i32, Operators::GreaterThanOrEquals)   \
+    O(i64_eq, i64, i32, Operators::Equals)                 \
+    O(i64_ne, i64, i32, Operators::NotEquals)              \
+    O(i64_lts, i64, i32, Operators::LessThan)              \
+    O(i64_ltu, u64, i32, Operators::LessThan)              \
+    O(i64_gts, i64, i32, Operators::GreaterThan)           \
+    O(i64_gtu, u64, i32, Operators::GreaterThan)           \
+    O(i64_les, i64, i32, Operators::LessThanOrEquals)      \
+    O(i64_leu, u64, i32, Operators::LessThanOrEquals)      \
+    O(i64_ges, i64, i32, Operators::GreaterThanOrEquals)   \
+    O(i64_geu, u64, i32, Operators::GreaterThanOrEquals)   \
+    O(f32_eq, float, i32, Operators::Equals)               \
+    O(f32_ne, float, i32, Operators::NotEquals)            \
+    O(f32_lt, float, i32, Operators::LessThan)             \
+    O(f32_gt, float, i32, Operators::GreaterThan)          \
+    O(f32_le, float, i32, Operators::LessThanOrEquals)     \
+    O(f32_ge, float, i32, Operators::GreaterThanOrEquals)  \
+    O(f64_eq, double, i32, Operators::Equals)              \
+    O(f64_ne, double, i32, Operators::NotEquals)           \
+    O(f64_lt, double, i32, Operators::LessThan)            \
+    O(f64_gt, double, i32, Operators::GreaterThan)         \
+    O(f64_le, double, i32, Operators::LessThanOrEquals)    \
+    O(f64_ge, double, i32, Operators::GreaterThanOrEquals) \
+    O(i32_add, u32, i32, Operators::Add)                   \
+    O(i32_sub, u32, i32, Operators::Subtract)              \
+    O(i32_mul, u32, i32, Operators::Multiply)              \
+    O(i32_divs, i32, i32, Operators::Divide)               \
+    O(i32_divu, u32, i32, Operators::Divide)               \
+    O(i32_rems, i32, i32, Operators::Modulo)               \
+    O(i32_remu, u32, i32, Operators::Modulo)               \
+    O(i32_and, i32, i32, Operators::BitAnd)                \
+    O(i32_or, i32, i32, Operators::BitOr)                  \
+    O(i32_xor, i32, i32, Operators::BitXor)                \
+    O(i32_shl, u32, i32, Operators::BitShiftLeft)          \
+    O(i32_shrs, i32, i32, Operators::BitShiftRight)        \
+    O(i32_shru, u32, i32, Operators::BitShiftRight)        \
+    O(i32_rotl, u32, i32, Operators::BitRotateLeft)        \
+    O(i32_rotr, u32, i32, Operators::BitRotateRight)       \
+    O(i64_add, u64, i64, Operators::Add)                   \
+    O(i64_sub, u64, i64, Operators::Subtract)              \
+    O(i64_mul, u64, i64, Operators::Multiply)              \
+    O(i64_divs, i64, i64, Operators::Divide)               \
+    O(i64_divu, u64, i64, Operators::Divide)               \
+    O(i64_rems, i64, i64, Operators::Modulo)               \
+    O(i64_remu, u64, i64, Operators::Modulo)               \
+    O(i64_and, i64, i64, Operators::BitAnd)                \
+    O(i64_or, i64, i64, Operators::BitOr)                  \
+    O(i64_xor, i64, i64, Operators::BitXor)                \
+    O(i64_shl, u64, i64, Operators::BitShiftLeft)          \
+    O(i64_shrs, i64, i64, Operators::BitShiftRight)        \
+    O(i64_shru, u64, i64, Operators::BitShiftRight)        \
+    O(i64_rotl, u64, i64, Operators::BitRotateLeft)        \
+    O(i64_rotr, u64, i64, Operators::BitRotateRight)       \
+    O(f32_add, float, float, Operators::Add)               \
+    O(f32_sub, float, float, Operators::Subtract)          \
+    O(f32_mul, float, float, Operators::Multiply)          \
+    O(f32_div, float, float, Operators::Divide)            \
+    O(f32_min, float, float, Operators::Minimum)           \
+    O(f32_max, float, float, Operators::Maximum)           \
+    O(f32_copysign, float, float, Operators::CopySign)     \
+    O(f64_add, double, double, Operators::Add)             \
+    O(f64_sub, double, double, Operators::Subtract)        \
+    O(f64_mul, double, double, Operators::Multiply)        \
+    O(f64_div, double, double, Operators::Divide)          \
+    O(f64_min, double, double, Operators::Minimum)         \
+    O(f64_max, double, double, Operators::Maximum)         \
+    O(f64_copysign, double, double, Operators::CopySign)
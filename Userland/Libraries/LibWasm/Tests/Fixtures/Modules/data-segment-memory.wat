@@ -0,0 +1,24 @@
+;; A memory that instantiation grows to fit a data segment, which leaves it at a size that isn't a whole number of pages.
+;; data-segment-memory.wasm is built from this with `wat2wasm data-segment-memory.wat`.
+(module
+  (type $i32_to_i32 (func (param i32) (result i32)))
+
+  (memory 0)
+
+  (export "load" (func $load))
+  (export "grow" (func $grow))
+
+  (data (i32.const 0) "0123456789")
+
+  (func $load (type $i32_to_i32) (param $address i32) (result i32)
+    local.get $address
+    i32.load8_u)
+
+  ;; Grows the memory by delta pages and returns the new size in bytes.
+  (func $grow (type $i32_to_i32) (param $delta i32) (result i32)
+    local.get $delta
+    memory.grow
+    drop
+    memory.size
+    i32.const 65536
+    i32.mul))
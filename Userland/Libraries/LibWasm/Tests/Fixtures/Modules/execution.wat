@@ -0,0 +1,300 @@
+;; The module used by Interpreter/test-execution.js, execution.wasm is built from this with `wat2wasm execution.wat`.
+(module
+  (type $i32_to_i32 (func (param i32) (result i32)))
+  (type $i64_to_i64 (func (param i64) (result i64)))
+  (type $i32_i32_to_i32 (func (param i32 i32) (result i32)))
+  (type $none_to_i32 (func (result i32)))
+  (type $f64_f64_to_f64 (func (param f64 f64) (result f64)))
+  (type $i32_i32_to_i32_i32 (func (param i32 i32) (result i32 i32)))
+  (type $i32_i32_i32_to_i32 (func (param i32 i32 i32) (result i32)))
+
+  (table 3 funcref)
+  (memory 1)
+  (global $counter (mut i32) (i32.const 41))
+
+  (export "sum" (func $sum))
+  (export "fib" (func $fib))
+  (export "fact64" (func $fact64))
+  (export "classify" (func $classify))
+  (export "storeLoad" (func $storeLoad))
+  (export "divide" (func $divide))
+  (export "counter" (func $counter))
+  (export "indirect" (func $indirect))
+  (export "selectMax" (func $selectMax))
+  (export "mean" (func $mean))
+  (export "subtractSwapped" (func $subtractSwapped))
+  (export "firstMultiple" (func $firstMultiple))
+  (export "aliasing" (func $aliasing))
+  (export "fillAndSum" (func $fillAndSum))
+  (export "copyWithin" (func $copyWithin))
+  (export "blockWithParams" (func $blockWithParams))
+  (export "trap" (func $trap))
+  (export "grow" (func $grow))
+  (export "isqrt" (func $isqrt))
+  (export "brIfWithValue" (func $brIfWithValue))
+  (export "deadCode" (func $deadCode))
+  (export "recurse" (func $recurse))
+
+  (elem (i32.const 0) func $double $square $fact64)
+
+  ;; for (i = 0; i < n; ++i) s += i;
+  (func $sum (type $i32_to_i32) (param $n i32) (result i32)
+    (local $s i32)
+    (local $i i32)
+    block
+      loop
+        local.get $i
+        local.get $n
+        i32.ge_s
+        br_if 1
+        local.get $s
+        local.get $i
+        i32.add
+        local.set $s
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    local.get $s)
+
+  (func $fib (type $i32_to_i32) (param $n i32) (result i32)
+    local.get $n
+    i32.const 2
+    i32.lt_s
+    if (result i32)
+      local.get $n
+    else
+      local.get $n
+      i32.const 1
+      i32.sub
+      call $fib
+      local.get $n
+      i32.const 2
+      i32.sub
+      call $fib
+      i32.add
+    end)
+
+  (func $fact64 (type $i64_to_i64) (param $n i64) (result i64)
+    (local $result i64)
+    i64.const 1
+    local.set $result
+    block
+      loop
+        local.get $n
+        i64.eqz
+        br_if 1
+        local.get $result
+        local.get $n
+        i64.mul
+        local.set $result
+        local.get $n
+        i64.const 1
+        i64.sub
+        local.set $n
+        br 0
+      end
+    end
+    local.get $result)
+
+  (func $classify (type $i32_to_i32) (param $x i32) (result i32)
+    block
+      block
+        block
+          local.get $x
+          br_table 0 1 2 1 2
+        end
+        i32.const 100
+        return
+      end
+      i32.const 200
+      return
+    end
+    i32.const 300)
+
+  ;; Stores value at address and returns the value loaded back plus its lowest byte.
+  (func $storeLoad (type $i32_i32_to_i32) (param $address i32) (param $value i32) (result i32)
+    local.get $address
+    local.get $value
+    i32.store align=1
+    local.get $address
+    i32.load align=1
+    local.get $address
+    i32.load8_u
+    i32.add)
+
+  (func $divide (type $i32_i32_to_i32) (param $a i32) (param $b i32) (result i32)
+    local.get $a
+    local.get $b
+    i32.div_s)
+
+  (func $counter (type $none_to_i32) (result i32)
+    global.get $counter
+    i32.const 1
+    i32.add
+    global.set $counter
+    global.get $counter)
+
+  (func $double (type $i32_to_i32) (param $x i32) (result i32)
+    local.get $x
+    i32.const 1
+    i32.shl)
+
+  (func $square (type $i32_to_i32) (param $x i32) (result i32)
+    local.get $x
+    local.get $x
+    i32.mul)
+
+  ;; Calls the function at the given table index with x.
+  (func $indirect (type $i32_i32_to_i32) (param $index i32) (param $x i32) (result i32)
+    local.get $x
+    local.get $index
+    call_indirect (type $i32_to_i32))
+
+  (func $selectMax (type $i32_i32_to_i32) (param $a i32) (param $b i32) (result i32)
+    local.get $a
+    local.get $b
+    local.get $a
+    local.get $b
+    i32.gt_s
+    select)
+
+  (func $mean (type $f64_f64_to_f64) (param $a f64) (param $b f64) (result f64)
+    local.get $a
+    local.get $b
+    f64.add
+    f64.const 2
+    f64.div)
+
+  (func $swap (type $i32_i32_to_i32_i32) (param $a i32) (param $b i32) (result i32 i32)
+    local.get $b
+    local.get $a)
+
+  (func $subtractSwapped (type $i32_i32_to_i32) (param $a i32) (param $b i32) (result i32)
+    local.get $a
+    local.get $b
+    call $swap
+    i32.sub)
+
+  ;; Returns the first multiple of step that is at least limit.
+  (func $firstMultiple (type $i32_i32_to_i32) (param $limit i32) (param $step i32) (result i32)
+    (local $i i32)
+    (local $multiple i32)
+    i32.const 1
+    local.set $i
+    loop
+      local.get $i
+      local.get $step
+      i32.mul
+      local.tee $multiple
+      local.get $multiple
+      local.get $limit
+      i32.ge_s
+      br_if 1
+      drop
+      local.get $i
+      i32.const 1
+      i32.add
+      local.set $i
+      br 0
+    end
+    i32.const -1)
+
+  ;; Returns x + (x + 1), the first operand is read before x is overwritten.
+  (func $aliasing (type $i32_to_i32) (param $x i32) (result i32)
+    local.get $x
+    local.get $x
+    i32.const 1
+    i32.add
+    local.set $x
+    local.get $x
+    i32.add)
+
+  ;; Fills length bytes at address with value, then sums them up one by one.
+  (func $fillAndSum (type $i32_i32_i32_to_i32) (param $address i32) (param $value i32) (param $length i32) (result i32)
+    (local $i i32)
+    (local $sum i32)
+    local.get $address
+    local.get $value
+    local.get $length
+    memory.fill
+    block
+      loop
+        local.get $i
+        local.get $length
+        i32.ge_s
+        br_if 1
+        local.get $sum
+        local.get $address
+        local.get $i
+        i32.add
+        i32.load8_u
+        i32.add
+        local.set $sum
+        local.get $i
+        i32.const 1
+        i32.add
+        local.set $i
+        br 0
+      end
+    end
+    local.get $sum)
+
+  ;; Copies the 4 bytes at source to destination and loads them from there.
+  (func $copyWithin (type $i32_i32_to_i32) (param $destination i32) (param $source i32) (result i32)
+    local.get $destination
+    local.get $source
+    i32.const 4
+    memory.copy
+    local.get $destination
+    i32.load align=1)
+
+  (func $blockWithParams (type $i32_i32_to_i32) (param $a i32) (param $b i32) (result i32)
+    local.get $a
+    local.get $b
+    block (type $i32_i32_to_i32)
+      i32.sub
+    end)
+
+  (func $trap (type $none_to_i32) (result i32)
+    unreachable)
+
+  ;; Grows the memory by delta pages and returns the new size in pages.
+  (func $grow (type $i32_to_i32) (param $delta i32) (result i32)
+    local.get $delta
+    memory.grow
+    drop
+    memory.size)
+
+  (func $isqrt (type $i32_to_i32) (param $x i32) (result i32)
+    local.get $x
+    f64.convert_i32_s
+    f64.sqrt
+    i32.trunc_f64_s)
+
+  (func $brIfWithValue (type $i32_to_i32) (param $condition i32) (result i32)
+    block (result i32)
+      i32.const 10
+      local.get $condition
+      br_if 0
+      drop
+      i32.const 20
+    end)
+
+  (func $deadCode (type $i32_to_i32) (param $x i32) (result i32)
+    block (result i32)
+      local.get $x
+      br 0
+      i32.const 1
+      i32.add
+      block
+      end
+    end
+    i32.const 1
+    i32.add)
+
+  (func $recurse (type $none_to_i32) (result i32)
+    call $recurse))
@@ -0,0 +1,108 @@
+// Built from Fixtures/Modules/execution.wat, which has the bodies of the exported functions.
+const module = parseWebAssemblyModule(readBinaryWasmFile("Fixtures/Modules/execution.wasm"));
+const call = (name, ...args) => module.invoke(module.getExport(name), ...args);
+
+test("loops and locals", () => {
+    // for (i = 0; i < n; ++i) s += i;
+    expect(call("sum", 0)).toBe(0);
+    expect(call("sum", 10)).toBe(45);
+    expect(call("sum", 100000)).toBe(704982704);
+    // Computes the result into a local that's still on the stack with its old value.
+    expect(call("aliasing", 20)).toBe(41);
+});
+
+test("recursive calls", () => {
+    expect(call("fib", 0)).toBe(0);
+    expect(call("fib", 1)).toBe(1);
+    expect(call("fib", 20)).toBe(6765);
+});
+
+test("64-bit and floating point arithmetic", () => {
+    expect(call("fact64", 20n)).toBe(2432902008176640000n);
+    expect(call("mean", 1.5, 2.5)).toBe(2);
+    expect(call("isqrt", 1000)).toBe(31);
+});
+
+test("branches carrying values", () => {
+    // block { block { block { br_table [0, 1, 2, 1] default=2 } return 100 } return 200 } 300
+    expect(call("classify", 0)).toBe(100);
+    expect(call("classify", 1)).toBe(200);
+    expect(call("classify", 2)).toBe(300);
+    expect(call("classify", 3)).toBe(200);
+    expect(call("classify", -1)).toBe(300);
+    // block (result i32) { 10; br_if 0 (x); drop; 20 }
+    expect(call("brIfWithValue", 1)).toBe(10);
+    expect(call("brIfWithValue", 0)).toBe(20);
+    // block (result i32) { x; br 0; <dead code> } + 1
+    expect(call("deadCode", 5)).toBe(6);
+    // block (param i32 i32) (result i32) { i32.sub }
+    expect(call("blockWithParams", 10, 3)).toBe(7);
+    // Returns from inside a loop with br_if.
+    expect(call("firstMultiple", 100, 7)).toBe(105);
+    expect(call("selectMax", 3, 8)).toBe(8);
+    expect(call("selectMax", 9, -8)).toBe(9);
+});
+
+test("multiple results", () => {
+    // Calls a function returning (b, a) and subtracts them.
+    expect(call("subtractSwapped", 10, 3)).toBe(-7);
+});
+
+test("globals", () => {
+    const first = call("counter");
+    expect(call("counter")).toBe(first + 1);
+});
+
+test("memory", () => {
+    expect(call("storeLoad", 16, 0x1234)).toBe(0x1234 + 0x34);
+    expect(() => call("storeLoad", 65534, 1)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(call("fillAndSum", 100, 3, 10)).toBe(30);
+    expect(() => call("fillAndSum", 65530, 3, 10)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    call("storeLoad", 200, 0x01020304);
+    expect(call("copyWithin", 300, 200)).toBe(0x01020304);
+    expect(call("grow", 1)).toBe(2);
+});
+
+test("accesses past the end of a grown memory", () => {
+    const size = call("grow", 0) * 65536;
+    expect(call("storeLoad", size - 4, 7)).toBe(14);
+    expect(() => call("storeLoad", size - 3, 1)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(() => call("storeLoad", size, 1)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(() => call("storeLoad", -4, 1)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(call("grow", 1) * 65536).toBe(size + 65536);
+    expect(call("storeLoad", size, 7)).toBe(14);
+});
+
+test("accesses past the end of a memory grown to fit a data segment", () => {
+    const dataModule = parseWebAssemblyModule(readBinaryWasmFile("Fixtures/Modules/data-segment-memory.wasm"));
+    const callData = (name, ...args) => dataModule.invoke(dataModule.getExport(name), ...args);
+
+    // The memory is exactly as large as the data segment "0123456789".
+    expect(callData("load", 9)).toBe(0x39);
+    expect(() => callData("load", 10)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(() => callData("load", 4095)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(() => callData("load", 65535)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+
+    const size = callData("grow", 1);
+    expect(size).toBe(65536);
+    expect(callData("load", 9)).toBe(0x39);
+    expect(callData("load", 65535)).toBe(0);
+    expect(callData("load", 65545)).toBe(0);
+    expect(() => callData("load", 65546)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+    expect(() => callData("load", 69631)).toThrowWithMessage(TypeError, "Execution trapped: Memory access out of bounds");
+});
+
+test("indirect calls", () => {
+    // The table holds [double, square, fact64].
+    expect(call("indirect", 0, 21)).toBe(42);
+    expect(call("indirect", 1, 12)).toBe(144);
+    expect(() => call("indirect", 2, 1)).toThrowWithMessage(TypeError, "Execution trapped: Indirect call type mismatch");
+    expect(() => call("indirect", 3, 1)).toThrow(TypeError);
+});
+
+test("traps", () => {
+    expect(call("divide", 7, 2)).toBe(3);
+    expect(() => call("divide", 7, 0)).toThrow(TypeError);
+    expect(() => call("trap")).toThrowWithMessage(TypeError, "Execution trapped: Unreachable");
+    expect(() => call("recurse")).toThrow(TypeError);
+});
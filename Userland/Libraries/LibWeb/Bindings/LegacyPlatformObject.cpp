@@ -14,6 +14,7 @@ namespace Web::Bindings {
 LegacyPlatformObject::LegacyPlatformObject(JS::Realm& realm)
     : PlatformObject(realm)
 {
+    m_may_interfere_with_property_lookup_caching = true;
 }
 
 LegacyPlatformObject::~LegacyPlatformObject() = default;
@@ -17,6 +17,7 @@ AudioTrackList::AudioTrackList(JS::Realm& realm)
     : DOM::EventTarget(realm)
     , m_audio_tracks(realm.heap())
 {
+    m_may_interfere_with_property_lookup_caching = true;
 }
 
 JS::ThrowCompletionOr<void> AudioTrackList::initialize(JS::Realm& realm)
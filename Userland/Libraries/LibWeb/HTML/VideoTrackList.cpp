@@ -17,6 +17,7 @@ VideoTrackList::VideoTrackList(JS::Realm& realm)
     : DOM::EventTarget(realm)
     , m_video_tracks(realm.heap())
 {
+    m_may_interfere_with_property_lookup_caching = true;
 }
 
 JS::ThrowCompletionOr<void> VideoTrackList::initialize(JS::Realm& realm)
@@ -82,19 +82,54 @@ Messages::SQLServer::PrepareStatementResponse ConnectionFromClient::prepare_stat
     return { result.value() };
 }
 
+RefPtr<SQLStatement> ConnectionFromClient::statement_for(SQL::StatementID statement_id) const
+{
+    auto statement = SQLStatement::statement_for(statement_id);
+    if (statement && statement->connection()->client_id() == client_id())
+        return statement;
+
+    dbgln_if(SQLSERVER_DEBUG, "Statement has disappeared");
+    return nullptr;
+}
+
 Messages::SQLServer::ExecuteStatementResponse ConnectionFromClient::execute_statement(SQL::StatementID statement_id, Vector<SQL::Value> const& placeholder_values)
 {
     dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::execute_query_statement(statement_id: {})", statement_id);
 
-    auto statement = SQLStatement::statement_for(statement_id);
-    if (statement && statement->connection()->client_id() == client_id()) {
+    if (auto statement = statement_for(statement_id)) {
         // FIXME: Support taking parameters from IPC requests.
         return statement->execute(move(const_cast<Vector<SQL::Value>&>(placeholder_values)));
     }
 
-    dbgln_if(SQLSERVER_DEBUG, "Statement has disappeared");
     async_execution_error(statement_id, -1, SQL::SQLErrorCode::StatementUnavailable, DeprecatedString::formatted("{}", statement_id));
     return Optional<SQL::ExecutionID> {};
 }
 
+Messages::SQLServer::OpenCursorResponse ConnectionFromClient::open_cursor(SQL::StatementID statement_id, Vector<SQL::Value> const& placeholder_values)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::open_cursor(statement_id: {})", statement_id);
+
+    if (auto statement = statement_for(statement_id))
+        return statement->execute(move(const_cast<Vector<SQL::Value>&>(placeholder_values)), SQLStatement::ResultDelivery::OnRequest);
+
+    async_execution_error(statement_id, -1, SQL::SQLErrorCode::StatementUnavailable, DeprecatedString::formatted("{}", statement_id));
+    return Optional<SQL::ExecutionID> {};
+}
+
+void ConnectionFromClient::fetch_results(SQL::StatementID statement_id, SQL::ExecutionID execution_id, u32 maximum_rows)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::fetch_results(statement_id: {}, execution_id: {})", statement_id, execution_id);
+
+    if (auto statement = statement_for(statement_id))
+        statement->fetch_results(execution_id, maximum_rows);
+}
+
+void ConnectionFromClient::cancel_execution(SQL::StatementID statement_id, SQL::ExecutionID execution_id)
+{
+    dbgln_if(SQLSERVER_DEBUG, "ConnectionFromClient::cancel_execution(statement_id: {}, execution_id: {})", statement_id, execution_id);
+
+    if (auto statement = statement_for(statement_id))
+        statement->cancel_execution(execution_id);
+}
+
 }
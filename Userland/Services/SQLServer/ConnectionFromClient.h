@@ -12,6 +12,7 @@
 #include <AK/Vector.h>
 #include <LibIPC/ConnectionFromClient.h>
 #include <LibSQL/Type.h>
+#include <SQLServer/Forward.h>
 #include <SQLServer/SQLClientEndpoint.h>
 #include <SQLServer/SQLServerEndpoint.h>
 
@@ -37,8 +38,13 @@ private:
     virtual Messages::SQLServer::ConnectResponse connect(DeprecatedString const&) override;
     virtual Messages::SQLServer::PrepareStatementResponse prepare_statement(SQL::ConnectionID, DeprecatedString const&) override;
     virtual Messages::SQLServer::ExecuteStatementResponse execute_statement(SQL::StatementID, Vector<SQL::Value> const& placeholder_values) override;
+    virtual Messages::SQLServer::OpenCursorResponse open_cursor(SQL::StatementID, Vector<SQL::Value> const& placeholder_values) override;
+    virtual void fetch_results(SQL::StatementID, SQL::ExecutionID, u32 maximum_rows) override;
+    virtual void cancel_execution(SQL::StatementID, SQL::ExecutionID) override;
     virtual void disconnect(SQL::ConnectionID) override;
 
+    RefPtr<SQLStatement> statement_for(SQL::StatementID) const;
+
     DeprecatedString m_database_path;
 };
 
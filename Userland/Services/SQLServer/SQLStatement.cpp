@@ -58,7 +58,7 @@ void SQLStatement::report_error(SQL::Result result, SQL::ExecutionID execution_i
         warnln("Cannot return execution error. Client disconnected");
 }
 
-Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_values)
+Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_values, ResultDelivery delivery)
 {
     dbgln_if(SQLSERVER_DEBUG, "SQLStatement::execute(statement_id {}", statement_id());
 
@@ -69,52 +69,87 @@ Optional<SQL::ExecutionID> SQLStatement::execute(Vector<SQL::Value> placeholder_
     }
 
     auto execution_id = m_next_execution_id++;
-    m_ongoing_executions.set(execution_id);
+    m_ongoing_executions.set(execution_id, Execution { delivery, nullptr });
 
-    deferred_invoke([this, placeholder_values = move(placeholder_values), execution_id] {
-        auto execution_result = m_statement->execute(connection()->database(), placeholder_values);
-        m_ongoing_executions.remove(execution_id);
+    deferred_invoke([this, placeholder_values = move(placeholder_values), execution_id]() mutable {
+        // The execution may have been cancelled before it got a chance to start.
+        if (!m_ongoing_executions.contains(execution_id))
+            return;
 
-        if (execution_result.is_error()) {
-            report_error(execution_result.release_error(), execution_id);
+        auto cursor_or_error = SQL::AST::Cursor::open(connection()->database(), m_statement, move(placeholder_values));
+        if (cursor_or_error.is_error()) {
+            m_ongoing_executions.remove(execution_id);
+            report_error(cursor_or_error.release_error(), execution_id);
+            return;
+        }
+        auto cursor = cursor_or_error.release_value();
+
+        auto has_results = [&]() -> SQL::ResultOr<bool> {
+            if (should_send_result_rows(*cursor))
+                return cursor->has_next();
+
+            // Statements that don't send their rows report how many rows they touched instead.
+            while (TRY(cursor->next()).has_value())
+                ;
+            return false;
+        }();
+        if (has_results.is_error()) {
+            m_ongoing_executions.remove(execution_id);
+            report_error(has_results.release_error(), execution_id);
             return;
         }
 
         auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
         if (!client_connection) {
+            m_ongoing_executions.remove(execution_id);
             warnln("Cannot return statement execution results. Client disconnected");
             return;
         }
 
-        auto result = execution_result.release_value();
-
-        if (should_send_result_rows(result)) {
-            client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), true, 0, 0, 0);
-
-            auto result_size = result.size();
-            next(execution_id, move(result), result_size);
-        } else {
-            if (result.command() == SQL::SQLCommand::Insert)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, result.size(), 0, 0);
-            else if (result.command() == SQL::SQLCommand::Update)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, result.size(), 0);
-            else if (result.command() == SQL::SQLCommand::Delete)
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, result.size());
-            else
-                client_connection->async_execution_success(statement_id(), execution_id, result.column_names(), false, 0, 0, 0);
+        if (has_results.value()) {
+            client_connection->async_execution_success(statement_id(), execution_id, cursor->column_names(), true, 0, 0, 0);
+
+            auto& execution = m_ongoing_executions.find(execution_id)->value;
+            execution.cursor = move(cursor);
+            if (execution.delivery == ResultDelivery::Stream)
+                send_results(execution_id, rows_per_batch);
+            return;
         }
+
+        m_ongoing_executions.remove(execution_id);
+
+        if (cursor->command() == SQL::SQLCommand::Insert)
+            client_connection->async_execution_success(statement_id(), execution_id, cursor->column_names(), false, cursor->rows_read(), 0, 0);
+        else if (cursor->command() == SQL::SQLCommand::Update)
+            client_connection->async_execution_success(statement_id(), execution_id, cursor->column_names(), false, 0, cursor->rows_read(), 0);
+        else if (cursor->command() == SQL::SQLCommand::Delete)
+            client_connection->async_execution_success(statement_id(), execution_id, cursor->column_names(), false, 0, 0, cursor->rows_read());
+        else
+            client_connection->async_execution_success(statement_id(), execution_id, cursor->column_names(), false, 0, 0, 0);
     });
 
     return execution_id;
 }
 
-bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
+void SQLStatement::fetch_results(SQL::ExecutionID execution_id, size_t maximum_rows)
 {
-    if (result.is_empty())
-        return false;
+    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::fetch_results(statement_id {}, execution_id {}, maximum_rows {})", statement_id(), execution_id, maximum_rows);
+    send_results(execution_id, max<size_t>(maximum_rows, 1));
+}
+
+void SQLStatement::cancel_execution(SQL::ExecutionID execution_id)
+{
+    dbgln_if(SQLSERVER_DEBUG, "SQLStatement::cancel_execution(statement_id {}, execution_id {})", statement_id(), execution_id);
+
+    // Dropping the cursor stops the statement, without reading any of its remaining rows.
+    m_ongoing_executions.remove(execution_id);
+}
 
-    switch (result.command()) {
+bool SQLStatement::should_send_result_rows(SQL::AST::Cursor const& cursor) const
+{
+    switch (cursor.command()) {
     case SQL::SQLCommand::Describe:
+    case SQL::SQLCommand::Explain:
     case SQL::SQLCommand::Select:
         return true;
     default:
@@ -122,23 +157,45 @@ bool SQLStatement::should_send_result_rows(SQL::ResultSet const& result) const
     }
 }
 
-void SQLStatement::next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t result_size)
+void SQLStatement::send_results(SQL::ExecutionID execution_id, size_t maximum_rows)
 {
+    auto execution = m_ongoing_executions.find(execution_id);
+    if (execution == m_ongoing_executions.end() || !execution->value.cursor)
+        return;
+
     auto client_connection = ConnectionFromClient::client_connection_for(connection()->client_id());
     if (!client_connection) {
+        m_ongoing_executions.remove(execution);
         warnln("Cannot yield next result. Client disconnected");
         return;
     }
 
-    if (!result.is_empty()) {
-        auto result_row = result.take_first();
-        client_connection->async_next_result(statement_id(), execution_id, result_row.row.take_data());
+    auto& cursor = *execution->value.cursor;
+    auto rows = cursor.next_batch(maximum_rows);
+    auto has_next = rows.is_error() ? false : cursor.has_next();
+    if (rows.is_error() || has_next.is_error()) {
+        m_ongoing_executions.remove(execution);
+        report_error(rows.is_error() ? rows.release_error() : has_next.release_error(), execution_id);
+        return;
+    }
+
+    Vector<Vector<SQL::Value>> values;
+    values.ensure_capacity(rows.value().size());
+    for (auto& row : rows.value())
+        values.unchecked_append(row.take_data());
+    if (!values.is_empty())
+        client_connection->async_next_results(statement_id(), execution_id, move(values));
+
+    if (!has_next.value()) {
+        client_connection->async_results_exhausted(statement_id(), execution_id, cursor.rows_read());
+        m_ongoing_executions.remove(execution);
+        return;
+    }
 
-        deferred_invoke([this, execution_id, result = move(result), result_size]() mutable {
-            next(execution_id, move(result), result_size);
+    if (execution->value.delivery == ResultDelivery::Stream) {
+        deferred_invoke([this, execution_id]() {
+            send_results(execution_id, rows_per_batch);
         });
-    } else {
-        client_connection->async_results_exhausted(statement_id(), execution_id, result_size);
     }
 }
 
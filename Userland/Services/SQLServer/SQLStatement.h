@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include <AK/HashMap.h>
 #include <AK/NonnullRefPtr.h>
+#include <AK/OwnPtr.h>
 #include <AK/Vector.h>
 #include <LibCore/Object.h>
 #include <LibSQL/AST/AST.h>
+#include <LibSQL/AST/Cursor.h>
 #include <LibSQL/Result.h>
 #include <LibSQL/ResultSet.h>
 #include <LibSQL/Type.h>
@@ -28,18 +31,35 @@ public:
     static RefPtr<SQLStatement> statement_for(SQL::StatementID statement_id);
     SQL::StatementID statement_id() const { return m_statement_id; }
     DatabaseConnection* connection() { return dynamic_cast<DatabaseConnection*>(parent()); }
-    Optional<SQL::ExecutionID> execute(Vector<SQL::Value> placeholder_values);
+
+    enum class ResultDelivery {
+        // All result rows are sent, a batch per turn of the event loop.
+        Stream,
+        // Result rows are only sent when the client asks for them with fetch_results().
+        OnRequest,
+    };
+
+    Optional<SQL::ExecutionID> execute(Vector<SQL::Value> placeholder_values, ResultDelivery = ResultDelivery::Stream);
+    void fetch_results(SQL::ExecutionID execution_id, size_t maximum_rows);
+    void cancel_execution(SQL::ExecutionID execution_id);
 
 private:
     SQLStatement(DatabaseConnection&, NonnullRefPtr<SQL::AST::Statement> statement);
 
-    bool should_send_result_rows(SQL::ResultSet const& result) const;
-    void next(SQL::ExecutionID execution_id, SQL::ResultSet result, size_t result_size);
+    struct Execution {
+        ResultDelivery delivery { ResultDelivery::Stream };
+        OwnPtr<SQL::AST::Cursor> cursor;
+    };
+
+    bool should_send_result_rows(SQL::AST::Cursor const& cursor) const;
+    void send_results(SQL::ExecutionID execution_id, size_t maximum_rows);
     void report_error(SQL::Result, SQL::ExecutionID execution_id);
 
+    static constexpr size_t rows_per_batch = 64;
+
     SQL::StatementID m_statement_id { 0 };
 
-    HashTable<SQL::ExecutionID> m_ongoing_executions;
+    HashMap<SQL::ExecutionID, Execution> m_ongoing_executions;
     SQL::ExecutionID m_next_execution_id { 0 };
 
     NonnullRefPtr<SQL::AST::Statement> m_statement;
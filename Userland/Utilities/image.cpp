@@ -11,6 +11,7 @@
 #include <LibGfx/ImageFormats/BMPWriter.h>
 #include <LibGfx/ImageFormats/ImageDecoder.h>
 #include <LibGfx/ImageFormats/PNGWriter.h>
+#include <LibGfx/ImageFormats/ParallelDecoding.h>
 #include <LibGfx/ImageFormats/PortableFormatWriter.h>
 #include <LibGfx/ImageFormats/QOIWriter.h>
 
@@ -42,8 +43,17 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     bool strip_color_profile = false;
     args_parser.add_option(strip_color_profile, "Do not write color profile to output", "strip-color-profile", {});
 
+    size_t thread_count = 1;
+    args_parser.add_option(thread_count, "Decode using this many threads", "threads", 'j', "N");
+
     args_parser.parse(arguments);
 
+    if (thread_count == 0) {
+        warnln("The thread count must be at least 1");
+        return 1;
+    }
+    Gfx::set_image_decoding_thread_count(thread_count);
+
     if (out_path.is_empty() ^ no_output) {
         warnln("exactly one of -o or --no-output is required");
         return 1;
@@ -13,6 +13,7 @@
 #include <LibJS/Bytecode/BasicBlock.h>
 #include <LibJS/Bytecode/Generator.h>
 #include <LibJS/Bytecode/Interpreter.h>
+#include <LibJS/Bytecode/PropertyLookupCache.h>
 #include <LibJS/Console.h>
 #include <LibJS/Contrib/Test262/GlobalObject.h>
 #include <LibJS/Interpreter.h>
@@ -73,6 +74,8 @@ private:
 static bool s_dump_ast = false;
 static bool s_run_bytecode = false;
 static bool s_opt_bytecode = false;
+static bool s_dump_property_lookup_cache_statistics = false;
+static bool s_dump_gc_statistics = false;
 static bool s_as_module = false;
 static bool s_print_last_result = false;
 static bool s_strip_ansi = false;
@@ -99,6 +102,13 @@ static ErrorOr<void> print(JS::Value value, PrintTarget target = PrintTarget::St
     return print(value, *stream);
 }
 
+static ErrorOr<void> dump_gc_statistics_if_requested(JS::Heap const& heap)
+{
+    if (s_dump_gc_statistics)
+        outln("{}", TRY(heap.statistics().to_string()));
+    return {};
+}
+
 static ErrorOr<String> prompt_for_level(int level)
 {
     static StringBuilder prompt_builder;
@@ -237,6 +247,12 @@ static ErrorOr<bool> parse_and_run(JS::Interpreter& interpreter, StringView sour
                     result = result_or_error.value.release_error();
                 else
                     result = result_or_error.frame->registers[0];
+
+                if (s_dump_property_lookup_cache_statistics) {
+                    auto const& statistics = JS::Bytecode::g_property_lookup_cache_statistics;
+                    outln("Property lookup cache: {} get hits, {} get misses, {} put hits, {} put misses",
+                        statistics.get_hits, statistics.get_misses, statistics.put_hits, statistics.put_misses);
+                }
             } else {
                 return ReturnEarly::Yes;
             }
@@ -423,6 +439,7 @@ JS_DEFINE_NATIVE_FUNCTION(ReplObject::save_to_file)
 JS_DEFINE_NATIVE_FUNCTION(ReplObject::exit_interpreter)
 {
     s_editor->save_history(s_history_path.to_deprecated_string());
+    TRY_OR_THROW_OOM(vm, dump_gc_statistics_if_requested(vm.heap()));
     if (!vm.argument_count())
         exit(0);
     exit(TRY(vm.argument(0).to_number(vm)).as_double());
@@ -598,6 +615,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     TRY(Core::System::pledge("stdio rpath wpath cpath tty sigaction"));
 
     bool gc_on_every_allocation = false;
+    bool use_jit = false;
     bool disable_syntax_highlight = false;
     bool disable_debug_printing = false;
     bool use_test262_global = false;
@@ -610,11 +628,14 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_option(JS::Bytecode::g_dump_bytecode, "Dump the bytecode", "dump-bytecode", 'd');
     args_parser.add_option(s_run_bytecode, "Run the bytecode", "run-bytecode", 'b');
     args_parser.add_option(s_opt_bytecode, "Optimize the bytecode", "optimize-bytecode", 'p');
+    args_parser.add_option(use_jit, "Compile hot bytecode to native code", "jit", {});
+    args_parser.add_option(s_dump_property_lookup_cache_statistics, "Dump property lookup cache statistics after running the bytecode", "dump-property-cache-statistics", {});
     args_parser.add_option(s_as_module, "Treat as module", "as-module", 'm');
     args_parser.add_option(s_print_last_result, "Print last result", "print-last-result", 'l');
     args_parser.add_option(s_strip_ansi, "Disable ANSI colors", "disable-ansi-colors", 'i');
     args_parser.add_option(s_disable_source_location_hints, "Disable source location hints", "disable-source-location-hints", 'h');
     args_parser.add_option(gc_on_every_allocation, "GC on every allocation", "gc-on-every-allocation", 'g');
+    args_parser.add_option(s_dump_gc_statistics, "Dump garbage collection statistics before exiting", "dump-gc-statistics", {});
     args_parser.add_option(disable_syntax_highlight, "Disable live syntax highlighting", "no-syntax-highlight", 's');
     args_parser.add_option(disable_debug_printing, "Disable debug output", "disable-debug-output", {});
     args_parser.add_option(evaluate_script, "Evaluate argument as a script", "evaluate", 'c', "script");
@@ -622,6 +643,12 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
     args_parser.add_positional_argument(script_paths, "Path to script files", "scripts", Core::ArgsParser::Required::No);
     args_parser.parse(arguments);
 
+    if (use_jit && !s_run_bytecode) {
+        warnln("--jit can only be used together with --run-bytecode");
+        return 1;
+    }
+    JS::Bytecode::Interpreter::set_jit_enabled(use_jit);
+
     bool syntax_highlight = !disable_syntax_highlight;
 
     AK::set_debug_enabled(!disable_debug_printing);
@@ -865,6 +892,7 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
         s_editor->on_tab_complete = move(complete);
         TRY(repl(*interpreter));
         s_editor->save_history(s_history_path.to_deprecated_string());
+        TRY(dump_gc_statistics_if_requested(interpreter->heap()));
     } else {
         if (use_test262_global) {
             interpreter = JS::Interpreter::create<JS::Test262::GlobalObject>(*g_vm);
@@ -912,7 +940,11 @@ ErrorOr<int> serenity_main(Main::Arguments arguments)
 
         // We resolve modules as if it is the first file
 
-        if (!TRY(parse_and_run(*interpreter, builder.string_view(), source_name)))
+        auto success = TRY(parse_and_run(*interpreter, builder.string_view(), source_name));
+
+        TRY(dump_gc_statistics_if_requested(interpreter->heap()));
+
+        if (!success)
             return 1;
     }
 